@@ -194,6 +194,10 @@ usage(char* progname)
 	printf("  --txpkts=X[,Y]*: set TX segment sizes.\n");
 	printf("  --disable-link-check: disable check on link status when "
 	       "starting/stopping ports.\n");
+#ifdef RTE_LIBRTE_PMU
+	printf("  --record-pmu: count hardware events like cycles, "
+	       "instructions and cache misses per packet.\n");
+#endif
 }
 
 #ifdef RTE_LIBRTE_CMDLINE
@@ -558,6 +562,9 @@ launch_args_parse(int argc, char** argv)
 		{ "no-flush-rx",	0, 0, 0 },
 		{ "txpkts",			1, 0, 0 },
 		{ "disable-link-check",		0, 0, 0 },
+#ifdef RTE_LIBRTE_PMU
+		{ "record-pmu",			0, 0, 0 },
+#endif
 		{ 0, 0, 0, 0 },
 	};
 
@@ -973,6 +980,10 @@ launch_args_parse(int argc, char** argv)
 				no_flush_rx = 1;
 			if (!strcmp(lgopts[opt_idx].name, "disable-link-check"))
 				no_link_check = 1;
+#ifdef RTE_LIBRTE_PMU
+			if (!strcmp(lgopts[opt_idx].name, "record-pmu"))
+				record_pmu = 1;
+#endif
 
 			break;
 		case 'h':
@@ -262,6 +262,13 @@ uint8_t no_flush_rx = 0; /* flush by default */
  */
 uint8_t no_link_check = 0; /* check by default */
 
+#ifdef RTE_LIBRTE_PMU
+/*
+ * Sample the hardware performance counters around each forwarding burst.
+ */
+uint8_t record_pmu = 0; /* disabled by default */
+#endif
+
 /*
  * NIC bypass mode configuration options.
  */
@@ -918,6 +925,49 @@ flush_fwd_rx_queues(void)
 	}
 }
 
+#ifdef RTE_LIBRTE_PMU
+/*
+ * Forwarding loop reading the hardware counters of the lcore after each
+ * burst, to account the events to the stream which processed the burst.
+ */
+static int
+run_pkt_fwd_on_lcore_pmu(struct fwd_lcore *fc, packet_fwd_t pkt_fwd)
+{
+	struct rte_pmu_values prev, cur;
+	struct fwd_stream **fsm;
+	struct fwd_stream *fs;
+	streamid_t nb_fs;
+	streamid_t sm_id;
+	unsigned int i;
+	int ret;
+
+	ret = rte_pmu_open(RTE_PMU_ALL_EVENTS);
+	if (ret < 0 && ret != -EBUSY) {
+		printf("lcore %u: cannot open hardware counters: %s\n",
+		       rte_lcore_id(), strerror(-ret));
+		return ret;
+	}
+
+	fsm = &fwd_streams[fc->stream_idx];
+	nb_fs = fc->stream_nb;
+	rte_pmu_read(&prev);
+	do {
+		for (sm_id = 0; sm_id < nb_fs; sm_id++) {
+			fs = fsm[sm_id];
+			(*pkt_fwd)(fs);
+			rte_pmu_read(&cur);
+			for (i = 0; i < RTE_PMU_EVENT_MAX; i++)
+				fs->pmu[i] += cur.val[i] - prev.val[i];
+			prev = cur;
+		}
+	} while (! fc->stopped);
+
+	if (ret >= 0)
+		rte_pmu_close();
+	return 0;
+}
+#endif
+
 static void
 run_pkt_fwd_on_lcore(struct fwd_lcore *fc, packet_fwd_t pkt_fwd)
 {
@@ -925,6 +975,10 @@ run_pkt_fwd_on_lcore(struct fwd_lcore *fc, packet_fwd_t pkt_fwd)
 	streamid_t nb_fs;
 	streamid_t sm_id;
 
+#ifdef RTE_LIBRTE_PMU
+	if (record_pmu && run_pkt_fwd_on_lcore_pmu(fc, pkt_fwd) == 0)
+		return;
+#endif
 	fsm = &fwd_streams[fc->stream_idx];
 	nb_fs = fc->stream_nb;
 	do {
@@ -1077,6 +1131,10 @@ start_packet_forwarding(int with_tx_first)
 #endif
 #ifdef RTE_TEST_PMD_RECORD_CORE_CYCLES
 		fwd_streams[sm_id]->core_cycles = 0;
+#endif
+#ifdef RTE_LIBRTE_PMU
+		memset(fwd_streams[sm_id]->pmu, 0,
+		       sizeof(fwd_streams[sm_id]->pmu));
 #endif
 	}
 	if (with_tx_first) {
@@ -1119,6 +1177,10 @@ stop_packet_forwarding(void)
 	uint64_t rx_bad_l4_csum;
 #ifdef RTE_TEST_PMD_RECORD_CORE_CYCLES
 	uint64_t fwd_cycles;
+#endif
+#ifdef RTE_LIBRTE_PMU
+	uint64_t fwd_pmu[RTE_PMU_EVENT_MAX];
+	unsigned int ev;
 #endif
 	static const char *acc_stats_border = "+++++++++++++++";
 
@@ -1140,6 +1202,9 @@ stop_packet_forwarding(void)
 	}
 #ifdef RTE_TEST_PMD_RECORD_CORE_CYCLES
 	fwd_cycles = 0;
+#endif
+#ifdef RTE_LIBRTE_PMU
+	memset(fwd_pmu, 0, sizeof(fwd_pmu));
 #endif
 	for (sm_id = 0; sm_id < cur_fwd_config.nb_fwd_streams; sm_id++) {
 		if (cur_fwd_config.nb_fwd_streams >
@@ -1175,6 +1240,10 @@ stop_packet_forwarding(void)
 #ifdef RTE_TEST_PMD_RECORD_CORE_CYCLES
 		fwd_cycles = (uint64_t) (fwd_cycles +
 					 fwd_streams[sm_id]->core_cycles);
+#endif
+#ifdef RTE_LIBRTE_PMU
+		for (ev = 0; ev < RTE_PMU_EVENT_MAX; ev++)
+			fwd_pmu[ev] += fwd_streams[sm_id]->pmu[ev];
 #endif
 	}
 	total_recv = 0;
@@ -1230,6 +1299,20 @@ stop_packet_forwarding(void)
 		       "%"PRIu64" / total RX packets=%"PRIu64")\n",
 		       (unsigned int)(fwd_cycles / total_recv),
 		       fwd_cycles, total_recv);
+#endif
+#ifdef RTE_LIBRTE_PMU
+	if (record_pmu && total_recv > 0 && fwd_pmu[RTE_PMU_CYCLES] > 0) {
+		printf("\n  Hardware counters (per RX packet):\n"
+		       "  IPC=%.2f cycles=%.1f instructions=%.1f\n"
+		       "  L1D-misses=%.2f LLC-misses=%.2f branch-misses=%.2f\n",
+		       (double)fwd_pmu[RTE_PMU_INSTRUCTIONS] /
+		       fwd_pmu[RTE_PMU_CYCLES],
+		       (double)fwd_pmu[RTE_PMU_CYCLES] / total_recv,
+		       (double)fwd_pmu[RTE_PMU_INSTRUCTIONS] / total_recv,
+		       (double)fwd_pmu[RTE_PMU_L1D_MISSES] / total_recv,
+		       (double)fwd_pmu[RTE_PMU_LLC_MISSES] / total_recv,
+		       (double)fwd_pmu[RTE_PMU_BRANCH_MISSES] / total_recv);
+	}
 #endif
 	printf("\nDone.\n");
 	test_done = 1;
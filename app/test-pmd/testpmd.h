@@ -34,6 +34,10 @@
 #ifndef _TESTPMD_H_
 #define _TESTPMD_H_
 
+#ifdef RTE_LIBRTE_PMU
+#include <rte_pmu.h>
+#endif
+
 #define RTE_PORT_ALL            (~(portid_t)0x0)
 
 #define RTE_TEST_RX_DESC_MAX    2048
@@ -114,6 +118,10 @@ struct fwd_stream {
 #ifdef RTE_TEST_PMD_RECORD_CORE_CYCLES
 	uint64_t     core_cycles; /**< used for RX and TX processing */
 #endif
+#ifdef RTE_LIBRTE_PMU
+	/** hardware events counted for RX and TX processing */
+	uint64_t     pmu[RTE_PMU_EVENT_MAX];
+#endif
 #ifdef RTE_TEST_PMD_RECORD_BURST_STATS
 	struct pkt_burst_stats rx_burst_stats;
 	struct pkt_burst_stats tx_burst_stats;
@@ -290,6 +298,9 @@ extern uint16_t port_topology; /**< set by "--port-topology" parameter */
 extern uint8_t no_flush_rx; /**<set by "--no-flush-rx" parameter */
 extern uint8_t  mp_anon; /**< set by "--mp-anon" parameter */
 extern uint8_t no_link_check; /**<set by "--disable-link-check" parameter */
+#ifdef RTE_LIBRTE_PMU
+extern uint8_t record_pmu; /**< set by "--record-pmu" parameter */
+#endif
 extern volatile int test_done; /* stop packet forwarding when set to 1. */
 
 #ifdef RTE_NIC_BYPASS
@@ -124,6 +124,12 @@ parallel_test_group_list = [
 		 "Func" :	logs_autotest,
 		 "Report" :	None,
 		},
+		{
+		 "Name" :	"Trace autotest",
+		 "Command" : 	"trace_autotest",
+		 "Func" :	default_autotest,
+		 "Report" :	None,
+		},
 		{
 		 "Name" :	"CPU flags autotest",
 		 "Command" : 	"cpuflags_autotest",
@@ -246,6 +252,24 @@ parallel_test_group_list = [
 		 "Func" :	default_autotest,
 		 "Report" :	None,
 		},
+		{
+		 "Name" :	"RCU QSBR autotest",
+		 "Command" : 	"rcu_qsbr_autotest",
+		 "Func" :	default_autotest,
+		 "Report" :	None,
+		},
+		{
+		 "Name" :	"PMU autotest",
+		 "Command" : 	"pmu_autotest",
+		 "Func" :	default_autotest,
+		 "Report" :	None,
+		},
+		{
+		 "Name" :	"IPsec autotest",
+		 "Command" : 	"ipsec_autotest",
+		 "Func" :	default_autotest,
+		 "Report" :	None,
+		},
 	]
 },
 {
@@ -259,6 +283,24 @@ parallel_test_group_list = [
 		 "Func" :	spinlock_autotest,
 		 "Report" :	None,
 		},
+		{
+		 "Name" :	"Ticketlock autotest",
+		 "Command" : 	"ticketlock_autotest",
+		 "Func" :	default_autotest,
+		 "Report" :	None,
+		},
+		{
+		 "Name" :	"MCS lock autotest",
+		 "Command" : 	"mcslock_autotest",
+		 "Func" :	default_autotest,
+		 "Report" :	None,
+		},
+		{
+		 "Name" :	"Reader-biased rwlock autotest",
+		 "Command" : 	"brwlock_autotest",
+		 "Func" :	default_autotest,
+		 "Report" :	None,
+		},
 		{
 		 "Name" :	"Byte order autotest",
 		 "Command" : 	"byteorder_autotest",
@@ -443,6 +485,45 @@ non_parallel_test_group_list = [
 		},
 	]
 },
+{
+	"Prefix" :      "power_poll",
+	"Memory" :      "16",
+	"Tests" :
+	[
+		{
+		 "Name" :       "Power adaptive polling autotest",
+		 "Command" :    "power_poll_autotest",
+		 "Func" :       default_autotest,
+		 "Report" :     None,
+		},
+	]
+},
+{
+	"Prefix":	"malloc_perf",
+	"Memory" :	per_sockets(256),
+	"Tests" :
+	[
+		{
+		 "Name" :	"Malloc performance autotest",
+		 "Command" : 	"malloc_perf_autotest",
+		 "Func" :	default_autotest,
+		 "Report" :	None,
+		},
+	]
+},
+{
+	"Prefix":	"lock_perf",
+	"Memory" :	"16",
+	"Tests" :
+	[
+		{
+		 "Name" :	"Lock performance autotest",
+		 "Command" : 	"lock_perf_autotest",
+		 "Func" :	default_autotest,
+		 "Report" :	None,
+		},
+	]
+},
 {
 	"Prefix":	"timer_perf",
 	"Memory" :	per_sockets(512),
@@ -0,0 +1,427 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2017 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_lcore.h>
+
+#include "test.h"
+
+#include <bpool/bm_stash.h>
+
+#define FAKE_BM_NB_BUFS		512
+#define FAKE_BM_BATCH		8
+#define FAKE_BM_STASH_SIZE	64
+
+/* DPAA2 commands carry 7 buffers at most */
+#define FAKE_BM_BATCH_DPAA2	7
+
+/*
+ * In-memory BMan buffer pool: a LIFO of buffers, with all-or-nothing
+ * acquires of at most batch buffers per command, as BMan.
+ */
+struct fake_bm {
+	uint64_t bufs[FAKE_BM_NB_BUFS];
+	void *objs[FAKE_BM_NB_BUFS];
+	unsigned int count;
+	unsigned int batch;	/**< Buffers of a command, FAKE_BM_BATCH */
+	unsigned int acquires;
+	unsigned int releases;
+	unsigned int partial;	/**< Commands of less than a batch */
+	unsigned int empty;	/**< Releases of 0 buffers */
+	unsigned int bad;	/**< Acquires of 0 or too many buffers */
+};
+
+static struct fake_bm fake_bm;
+
+static int
+fake_bm_acquire(void *ctx, void **objs, unsigned int num)
+{
+	struct fake_bm *bm = ctx;
+
+	bm->acquires++;
+	if (num == 0 || num > bm->batch) {
+		bm->bad++;
+		return -1;
+	}
+	if (num < bm->batch)
+		bm->partial++;
+	if (bm->count < num)
+		return 0;
+	bm->count -= num;
+	memcpy(objs, &bm->objs[bm->count], num * sizeof(*objs));
+	return num;
+}
+
+static void
+fake_bm_release(void *ctx, void * const *objs, unsigned int num)
+{
+	struct fake_bm *bm = ctx;
+
+	bm->releases++;
+	if (num == 0) {
+		bm->empty++;
+		return;
+	}
+	if (num > bm->batch || bm->count + num > FAKE_BM_NB_BUFS) {
+		bm->bad++;
+		return;
+	}
+	if (num < bm->batch)
+		bm->partial++;
+	memcpy(&bm->objs[bm->count], objs, num * sizeof(*objs));
+	bm->count += num;
+}
+
+static void
+fake_bm_init(unsigned int count)
+{
+	unsigned int i;
+
+	memset(&fake_bm, 0, sizeof(fake_bm));
+	for (i = 0; i < count; i++)
+		fake_bm.objs[i] = &fake_bm.bufs[i];
+	fake_bm.count = count;
+	fake_bm.batch = FAKE_BM_BATCH;
+}
+
+/* Every buffer is either in the pool, in a stash or held by the test */
+static int
+fake_bm_check(struct bm_stash_pool *pool, unsigned int held,
+	      unsigned int total)
+{
+	unsigned int i, j, count = fake_bm.count;
+
+	TEST_ASSERT_EQUAL(count + bm_stash_count(pool) + held, total,
+			  "Buffers lost: %u in pool, %u stashed, %u held",
+			  count, bm_stash_count(pool), held);
+	TEST_ASSERT_EQUAL(fake_bm.empty, 0, "Releases of 0 buffers");
+	TEST_ASSERT_EQUAL(fake_bm.bad, 0, "Bad BMan commands");
+	for (i = 0; i < count; i++)
+		for (j = i + 1; j < count; j++)
+			TEST_ASSERT(fake_bm.objs[i] != fake_bm.objs[j],
+				    "Buffer %p released twice",
+				    fake_bm.objs[i]);
+	return TEST_SUCCESS;
+}
+
+static int
+test_bm_stash_hits(void)
+{
+	struct bm_stash_pool pool;
+	struct bm_stash_stats stats;
+	void *objs[FAKE_BM_STASH_SIZE];
+	unsigned int i;
+
+	fake_bm_init(FAKE_BM_NB_BUFS);
+	TEST_ASSERT_SUCCESS(bm_stash_pool_init(&pool, &fake_bm,
+					       fake_bm_acquire,
+					       fake_bm_release, FAKE_BM_BATCH,
+					       FAKE_BM_STASH_SIZE),
+			    "Stash init failed");
+	TEST_ASSERT(pool.low + pool.batch <= pool.high &&
+		    pool.high <= pool.size, "Bad watermarks %u/%u/%u",
+		    pool.low, pool.high, pool.size);
+
+	/* The first get refills the stash, the following ones are hits */
+	TEST_ASSERT_SUCCESS(bm_stash_get(&pool, &objs[0], 1), "Get failed");
+	TEST_ASSERT(bm_stash_count(&pool) >= pool.low, "Stash not refilled");
+	for (i = 1; i < pool.low; i++)
+		TEST_ASSERT_SUCCESS(bm_stash_get(&pool, &objs[i], 1),
+				    "Get %u failed", i);
+	bm_stash_stats_get(&pool, &stats);
+	TEST_ASSERT_EQUAL(stats.get_misses, 1, "%"PRIu64" misses",
+			  stats.get_misses);
+	TEST_ASSERT_EQUAL(stats.get_hits, pool.low - 1u, "%"PRIu64" hits",
+			  stats.get_hits);
+	TEST_ASSERT_EQUAL(stats.acquires, fake_bm.acquires,
+			  "Acquires not accounted");
+	TEST_ASSERT_EQUAL(fake_bm.partial, 0, "Partial acquires");
+
+	/* Putting them back stays below the high watermark */
+	for (i = 0; i < pool.low; i++)
+		bm_stash_put(&pool, &objs[i], 1);
+	bm_stash_stats_get(&pool, &stats);
+	TEST_ASSERT_EQUAL(stats.put_hits, pool.low, "%"PRIu64" put hits",
+			  stats.put_hits);
+	TEST_ASSERT_EQUAL(fake_bm.releases, 0, "Releases on hits");
+	if (fake_bm_check(&pool, 0, FAKE_BM_NB_BUFS) < 0)
+		return TEST_FAILED;
+
+	bm_stash_pool_fini(&pool);
+	TEST_ASSERT_EQUAL(fake_bm.count, FAKE_BM_NB_BUFS,
+			  "Stash not drained");
+	return fake_bm_check(&pool, 0, FAKE_BM_NB_BUFS);
+}
+
+static int
+test_bm_stash_drain(void)
+{
+	struct bm_stash_pool pool;
+	struct bm_stash_stats stats;
+	void *objs[FAKE_BM_NB_BUFS];
+	unsigned int i, n;
+
+	fake_bm_init(FAKE_BM_NB_BUFS);
+	TEST_ASSERT_SUCCESS(bm_stash_pool_init(&pool, &fake_bm,
+					       fake_bm_acquire,
+					       fake_bm_release, FAKE_BM_BATCH,
+					       FAKE_BM_STASH_SIZE),
+			    "Stash init failed");
+
+	/* Take buffers in bursts larger than the stash */
+	for (n = 0; n < FAKE_BM_NB_BUFS; n += 32)
+		TEST_ASSERT_SUCCESS(bm_stash_get(&pool, &objs[n], 32),
+				    "Get of %u failed", n);
+	TEST_ASSERT_EQUAL(fake_bm.count + bm_stash_count(&pool), 0,
+			  "Pool not empty");
+	TEST_ASSERT_FAIL(bm_stash_get(&pool, objs, 1), "Empty pool got");
+
+	/* Give them back one by one, the stash stays under its high mark */
+	fake_bm.partial = 0;
+	for (i = 0; i < n; i++) {
+		bm_stash_put(&pool, &objs[i], 1);
+		TEST_ASSERT(bm_stash_count(&pool) <= pool.high,
+			    "Stash above high watermark");
+	}
+	TEST_ASSERT_EQUAL(fake_bm.partial, 0, "Partial releases");
+	TEST_ASSERT(bm_stash_count(&pool) >= pool.low,
+		    "Stash drained below low watermark");
+	bm_stash_stats_get(&pool, &stats);
+	TEST_ASSERT_EQUAL(stats.releases, fake_bm.releases,
+			  "Releases not accounted");
+	TEST_ASSERT(stats.put_misses != 0 && stats.put_hits != 0,
+		    "No drain");
+	if (fake_bm_check(&pool, 0, FAKE_BM_NB_BUFS) < 0)
+		return TEST_FAILED;
+
+	/* A burst larger than the stash goes partly straight to BMan */
+	TEST_ASSERT_SUCCESS(bm_stash_get(&pool, objs, 200), "Get failed");
+	bm_stash_put(&pool, objs, 200);
+	TEST_ASSERT(bm_stash_count(&pool) <= pool.size, "Stash overflow");
+	if (fake_bm_check(&pool, 0, FAKE_BM_NB_BUFS) < 0)
+		return TEST_FAILED;
+
+	bm_stash_pool_fini(&pool);
+	return fake_bm_check(&pool, 0, FAKE_BM_NB_BUFS);
+}
+
+static int
+test_bm_stash_empty(void)
+{
+	struct bm_stash_pool pool;
+	struct bm_stash_stats stats;
+	void *objs[FAKE_BM_BATCH];
+
+	/* Fewer buffers than a command */
+	fake_bm_init(FAKE_BM_BATCH - 3);
+	TEST_ASSERT_SUCCESS(bm_stash_pool_init(&pool, &fake_bm,
+					       fake_bm_acquire,
+					       fake_bm_release, FAKE_BM_BATCH,
+					       FAKE_BM_STASH_SIZE),
+			    "Stash init failed");
+
+	TEST_ASSERT_FAIL(bm_stash_get(&pool, objs, FAKE_BM_BATCH),
+			 "Got more buffers than the pool has");
+	if (fake_bm_check(&pool, 0, FAKE_BM_BATCH - 3) < 0)
+		return TEST_FAILED;
+	bm_stash_stats_get(&pool, &stats);
+	TEST_ASSERT_EQUAL(stats.get_fails, 1, "Fail not accounted");
+
+	/* All or nothing, even when BMan has them one by one only */
+	TEST_ASSERT_SUCCESS(bm_stash_get(&pool, objs, FAKE_BM_BATCH - 3),
+			    "Get of the whole pool failed");
+	if (fake_bm_check(&pool, FAKE_BM_BATCH - 3, FAKE_BM_BATCH - 3) < 0)
+		return TEST_FAILED;
+	bm_stash_put(&pool, objs, FAKE_BM_BATCH - 3);
+
+	bm_stash_pool_fini(&pool);
+	return fake_bm_check(&pool, 0, FAKE_BM_BATCH - 3);
+}
+
+static int
+test_bm_stash_disabled(void)
+{
+	struct bm_stash_pool pool;
+	void *objs[32];
+
+	fake_bm_init(FAKE_BM_NB_BUFS);
+	/* Too small for two commands between the watermarks */
+	TEST_ASSERT_SUCCESS(bm_stash_pool_init(&pool, &fake_bm,
+					       fake_bm_acquire,
+					       fake_bm_release, FAKE_BM_BATCH,
+					       FAKE_BM_BATCH),
+			    "Stash init failed");
+	TEST_ASSERT_EQUAL(pool.size, 0, "Stash not disabled");
+
+	TEST_ASSERT_SUCCESS(bm_stash_get(&pool, objs, 20), "Get failed");
+	TEST_ASSERT_EQUAL(fake_bm.acquires, 3, "%u acquires for 20",
+			  fake_bm.acquires);
+	bm_stash_put(&pool, objs, 20);
+	TEST_ASSERT_EQUAL(fake_bm.releases, 3, "%u releases for 20",
+			  fake_bm.releases);
+
+	bm_stash_pool_fini(&pool);
+	return fake_bm_check(&pool, 0, FAKE_BM_NB_BUFS);
+}
+
+/* BMan commands of bursts of RX refills and TX frees */
+static int
+test_bm_stash_commands(void)
+{
+	struct bm_stash_pool pool;
+	struct bm_stash_stats stats;
+	void *objs[32];
+	unsigned int i, direct, stashed;
+
+	fake_bm_init(FAKE_BM_NB_BUFS);
+	TEST_ASSERT_SUCCESS(bm_stash_pool_init(&pool, &fake_bm,
+					       fake_bm_acquire,
+					       fake_bm_release, FAKE_BM_BATCH,
+					       0),
+			    "Stash init failed");
+	for (i = 0; i < 1000; i++) {
+		TEST_ASSERT_SUCCESS(bm_stash_get(&pool, objs, 1 + i % 32),
+				    "Get failed");
+		bm_stash_put(&pool, objs, 1 + i % 32);
+	}
+	direct = fake_bm.acquires + fake_bm.releases;
+	bm_stash_pool_fini(&pool);
+
+	fake_bm_init(FAKE_BM_NB_BUFS);
+	TEST_ASSERT_SUCCESS(bm_stash_pool_init(&pool, &fake_bm,
+					       fake_bm_acquire,
+					       fake_bm_release, FAKE_BM_BATCH,
+					       FAKE_BM_STASH_SIZE),
+			    "Stash init failed");
+	for (i = 0; i < 1000; i++) {
+		TEST_ASSERT_SUCCESS(bm_stash_get(&pool, objs, 1 + i % 32),
+				    "Get failed");
+		bm_stash_put(&pool, objs, 1 + i % 32);
+	}
+	stashed = fake_bm.acquires + fake_bm.releases;
+	bm_stash_stats_get(&pool, &stats);
+	printf("BMan commands for 1000 get/put bursts: %u direct, %u stashed,"
+	       " %"PRIu64" hits, %"PRIu64" misses\n", direct, stashed,
+	       stats.get_hits + stats.put_hits,
+	       stats.get_misses + stats.put_misses);
+	TEST_ASSERT(stashed * 10 < direct, "Stash saves too few commands");
+	TEST_ASSERT_EQUAL(fake_bm.partial, 0, "Partial commands");
+
+	bm_stash_pool_fini(&pool);
+	return fake_bm_check(&pool, 0, FAKE_BM_NB_BUFS);
+}
+
+/*
+ * DPAA2 commands of 7 buffers: bursts of multiples of 7 through the stash,
+ * then bursts of every size split in commands without it, as the driver does
+ */
+static int
+test_bm_stash_dpaa2_batch(void)
+{
+	struct bm_stash_pool pool;
+	void *objs[4 * FAKE_BM_BATCH_DPAA2];
+	unsigned int i, n;
+
+	fake_bm_init(FAKE_BM_NB_BUFS);
+	fake_bm.batch = FAKE_BM_BATCH_DPAA2;
+	TEST_ASSERT_SUCCESS(bm_stash_pool_init(&pool, &fake_bm,
+					       fake_bm_acquire,
+					       fake_bm_release,
+					       FAKE_BM_BATCH_DPAA2,
+					       FAKE_BM_STASH_SIZE),
+			    "Stash init failed");
+	for (i = 0; i < 100; i++) {
+		n = FAKE_BM_BATCH_DPAA2 * (1 + i % 4);
+		TEST_ASSERT_SUCCESS(bm_stash_get(&pool, objs, n),
+				    "Get of %u failed", n);
+		bm_stash_put(&pool, objs, n);
+		if (fake_bm_check(&pool, 0, FAKE_BM_NB_BUFS) < 0)
+			return TEST_FAILED;
+	}
+	TEST_ASSERT_EQUAL(fake_bm.partial, 0, "Partial commands");
+	bm_stash_pool_fini(&pool);
+	if (fake_bm_check(&pool, 0, FAKE_BM_NB_BUFS) < 0)
+		return TEST_FAILED;
+
+	/* Without a stash, every put is split in DPAA2 commands */
+	fake_bm_init(FAKE_BM_NB_BUFS);
+	fake_bm.batch = FAKE_BM_BATCH_DPAA2;
+	TEST_ASSERT_SUCCESS(bm_stash_pool_init(&pool, &fake_bm,
+					       fake_bm_acquire,
+					       fake_bm_release,
+					       FAKE_BM_BATCH_DPAA2, 0),
+			    "Stash init failed");
+	for (n = 1; n <= RTE_DIM(objs); n++) {
+		TEST_ASSERT_SUCCESS(bm_stash_get(&pool, objs, n),
+				    "Get of %u failed", n);
+		fake_bm.releases = 0;
+		bm_stash_put(&pool, objs, n);
+		TEST_ASSERT_EQUAL(fake_bm.releases,
+				  (n + FAKE_BM_BATCH_DPAA2 - 1) /
+				  FAKE_BM_BATCH_DPAA2,
+				  "%u releases for %u", fake_bm.releases, n);
+		if (fake_bm_check(&pool, 0, FAKE_BM_NB_BUFS) < 0)
+			return TEST_FAILED;
+	}
+
+	bm_stash_pool_fini(&pool);
+	return fake_bm_check(&pool, 0, FAKE_BM_NB_BUFS);
+}
+
+static struct unit_test_suite bm_stash_testsuite  = {
+	.suite_name = "BMan Buffer Stash Unit Test Suite",
+	.setup = NULL,
+	.teardown = NULL,
+	.unit_test_cases = {
+		TEST_CASE(test_bm_stash_hits),
+		TEST_CASE(test_bm_stash_drain),
+		TEST_CASE(test_bm_stash_empty),
+		TEST_CASE(test_bm_stash_disabled),
+		TEST_CASE(test_bm_stash_commands),
+		TEST_CASE(test_bm_stash_dpaa2_batch),
+
+		TEST_CASES_END() /**< NULL terminate unit test array */
+	}
+};
+
+static int
+test_bm_stash(void)
+{
+	return unit_test_suite_runner(&bm_stash_testsuite);
+}
+
+REGISTER_TEST_COMMAND(bm_stash_autotest, test_bm_stash);
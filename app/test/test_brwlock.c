@@ -0,0 +1,157 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 Freescale Semiconductor, Inc. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of  Freescale Semiconductor, Inc nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_launch.h>
+#include <rte_eal.h>
+#include <rte_lcore.h>
+#include <rte_cycles.h>
+#include <rte_atomic.h>
+#include <rte_brwlock.h>
+
+#include "test.h"
+
+/*
+ * Reader-biased rwlock test
+ * =========================
+ *
+ * - The slave lcores repeatedly take the read lock and check that the two
+ *   halves of a shared value are equal, while the master lcore takes the
+ *   write lock and updates them one after the other. A reader must never
+ *   see a half-updated value.
+ *
+ * - All slave lcores then take the read lock at the same time and wait
+ *   until all of them are inside the critical section, checking that read
+ *   locks do not exclude each other.
+ */
+
+#define BRWLOCK_ITERATIONS 10000
+
+static rte_brwlock_t brwl;
+static struct {
+	volatile uint64_t a;
+	volatile uint64_t b;
+} shared_val;
+static rte_atomic32_t synchro;
+static rte_atomic32_t readers_in;
+static rte_atomic32_t errors;
+
+static int
+test_brwlock_reader(__attribute__((unused)) void *arg)
+{
+	unsigned int i;
+
+	while (rte_atomic32_read(&synchro) == 0)
+		rte_pause();
+
+	for (i = 0; i < BRWLOCK_ITERATIONS; i++) {
+		rte_brwlock_read_lock(&brwl);
+		if (shared_val.a != shared_val.b)
+			rte_atomic32_inc(&errors);
+		rte_brwlock_read_unlock(&brwl);
+	}
+
+	return 0;
+}
+
+static int
+test_brwlock_concurrent_reader(__attribute__((unused)) void *arg)
+{
+	uint64_t timeout = rte_get_timer_cycles() + rte_get_timer_hz();
+
+	rte_brwlock_read_lock(&brwl);
+	rte_atomic32_inc(&readers_in);
+	while (rte_atomic32_read(&readers_in) != (int)(rte_lcore_count() - 1)) {
+		if (rte_get_timer_cycles() > timeout) {
+			rte_atomic32_inc(&errors);
+			break;
+		}
+		rte_pause();
+	}
+	rte_brwlock_read_unlock(&brwl);
+
+	return 0;
+}
+
+static int
+test_brwlock(void)
+{
+	unsigned int i;
+
+	rte_brwlock_init(&brwl);
+	shared_val.a = 0;
+	shared_val.b = 0;
+	rte_atomic32_set(&errors, 0);
+
+	/* Clear synchro and start the readers */
+	rte_atomic32_set(&synchro, 0);
+	rte_eal_mp_remote_launch(test_brwlock_reader, NULL, SKIP_MASTER);
+	rte_atomic32_set(&synchro, 1);
+
+	for (i = 0; i < BRWLOCK_ITERATIONS; i++) {
+		rte_brwlock_write_lock(&brwl);
+		shared_val.a++;
+		rte_delay_us(1);
+		shared_val.b++;
+		rte_brwlock_write_unlock(&brwl);
+	}
+	rte_eal_mp_wait_lcore();
+
+	if (rte_atomic32_read(&errors) != 0) {
+		printf("brwlock readers saw %d inconsistent values\n",
+		       rte_atomic32_read(&errors));
+		return -1;
+	}
+
+	rte_atomic32_set(&readers_in, 0);
+	rte_eal_mp_remote_launch(test_brwlock_concurrent_reader, NULL,
+				 SKIP_MASTER);
+	rte_eal_mp_wait_lcore();
+
+	if (rte_atomic32_read(&errors) != 0) {
+		printf("brwlock read locks are not shared\n");
+		return -1;
+	}
+
+	/* a writer must still be able to take the lock */
+	rte_brwlock_write_lock(&brwl);
+	rte_brwlock_write_unlock(&brwl);
+
+	return 0;
+}
+
+REGISTER_TEST_COMMAND(brwlock_autotest, test_brwlock);
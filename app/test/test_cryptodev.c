@@ -39,6 +39,7 @@
 #include <rte_crypto.h>
 #include <rte_cryptodev.h>
 #include <rte_cryptodev_pmd.h>
+#include <rte_ip.h>
 
 #include "test.h"
 #include "test_cryptodev.h"
@@ -3703,6 +3704,20 @@ authenticated_decryption_AES128CBC_HMAC_SHA1(void)
 			&aes128cbc_hmac_sha1_test_vector);
 }
 
+static int
+authenticated_encryption_AES128CBC_HMAC_SHA1_sgl(void)
+{
+	return test_authenticated_encryption_sgl(&testsuite_params,
+			&unittest_params, &aes128cbc_hmac_sha1_test_vector);
+}
+
+static int
+authenticated_decryption_AES128CBC_HMAC_SHA1_sgl(void)
+{
+	return test_authenticated_decryption_sgl(&testsuite_params,
+			&unittest_params, &aes128cbc_hmac_sha1_test_vector);
+}
+
 static int
 authenticated_encryption_AES128CBC_HMAC_SHA1_sessionless(void)
 {
@@ -3719,6 +3734,14 @@ authenticated_decryption_AES128CBC_HMAC_SHA1_sessionless(void)
 			&aes128cbc_hmac_sha1_test_vector);
 }
 
+static int
+authenticated_encryption_AES128CBC_HMAC_SHA1_sessionless_cache(void)
+{
+	return test_authenticated_encryption_sessionless_cache(
+			&testsuite_params, &unittest_params,
+			&aes128cbc_hmac_sha1_test_vector);
+}
+
 static int
 authenticated_encryption_AES128CBC_AES128_GMAC(void)
 {
@@ -3733,6 +3756,20 @@ authenticated_decryption_AES128CBC_AES128_GMAC(void)
 			&aes128cbc_aes128_gmac_test_vector);
 }
 
+static int
+authenticated_encryption_AES128CBC_AES128_GMAC_sgl(void)
+{
+	return test_authenticated_encryption_sgl(&testsuite_params,
+			&unittest_params, &aes128cbc_aes128_gmac_test_vector);
+}
+
+static int
+authenticated_decryption_AES128CBC_AES128_GMAC_sgl(void)
+{
+	return test_authenticated_decryption_sgl(&testsuite_params,
+			&unittest_params, &aes128cbc_aes128_gmac_test_vector);
+}
+
 static int
 authenticated_encryption_AES128CBC_AES192_GMAC(void)
 {
@@ -3934,6 +3971,20 @@ authenticated_decryption_3DES128CTR_HMAC_SHA1(void)
 			&triple_des128ctr_hmac_sha1_test_vector);
 }
 
+static int
+authenticated_encryption_3DES128CTR_HMAC_SHA1_sgl(void)
+{
+	return test_authenticated_encryption_sgl(&testsuite_params,
+			&unittest_params, &triple_des128ctr_hmac_sha1_test_vector);
+}
+
+static int
+authenticated_decryption_3DES128CTR_HMAC_SHA1_sgl(void)
+{
+	return test_authenticated_decryption_sgl(&testsuite_params,
+			&unittest_params, &triple_des128ctr_hmac_sha1_test_vector);
+}
+
 static int
 authenticated_encryption_3DES192CTR_SHA1(void)
 {
@@ -4945,8 +4996,460 @@ test_null_burst_operation(void)
 	return TEST_SUCCESS;
 }
 
+#define NULL_TMPL_IV_LENGTH	16
+
+static int
+test_null_op_template_burst_operation(void)
+{
+	struct crypto_testsuite_params *ts_params = &testsuite_params;
+	struct crypto_unittest_params *ut_params = &unittest_params;
+	struct rte_crypto_op_sym_template tmpl;
+	struct rte_mempool *op_mpool;
+	uint16_t iv_offset = sizeof(struct rte_crypto_op) +
+			sizeof(struct rte_crypto_sym_op);
+	int status = TEST_FAILED;
+
+	unsigned i, nb_deq, burst_len = NULL_BURST_LENGTH;
+
+	struct rte_crypto_op *burst[NULL_BURST_LENGTH + 1] = { NULL };
+	struct rte_crypto_op *burst_dequeued[NULL_BURST_LENGTH + 1] = { NULL };
+
+	/* Setup Cipher Parameters */
+	ut_params->cipher_xform.type = RTE_CRYPTO_SYM_XFORM_CIPHER;
+	ut_params->cipher_xform.next = &ut_params->auth_xform;
+
+	ut_params->cipher_xform.cipher.algo = RTE_CRYPTO_CIPHER_NULL;
+	ut_params->cipher_xform.cipher.op = RTE_CRYPTO_CIPHER_OP_ENCRYPT;
+
+	/* Setup HMAC Parameters */
+	ut_params->auth_xform.type = RTE_CRYPTO_SYM_XFORM_AUTH;
+	ut_params->auth_xform.next = NULL;
+
+	ut_params->auth_xform.auth.algo = RTE_CRYPTO_AUTH_NULL;
+	ut_params->auth_xform.auth.op = RTE_CRYPTO_AUTH_OP_GENERATE;
+
+	/* Create Crypto session*/
+	ut_params->sess = rte_cryptodev_sym_session_create(
+			ts_params->valid_devs[0], &ut_params->cipher_xform);
+	TEST_ASSERT_NOT_NULL(ut_params->sess, "Session creation failed");
+
+	/* Op pool with room for the IV and for the PMD per-op data */
+	op_mpool = rte_cryptodev_op_pool_create("CRYPTO_OP_TMPL_POOL",
+			RTE_CRYPTO_OP_TYPE_SYMMETRIC, 2 * NULL_BURST_LENGTH, 0,
+			NULL_TMPL_IV_LENGTH, ts_params->valid_devs[0],
+			rte_socket_id());
+	TEST_ASSERT_NOT_NULL(op_mpool, "Failed to create device op pool");
+
+	rte_crypto_op_sym_template_init(&tmpl, ut_params->sess, iv_offset,
+			NULL_TMPL_IV_LENGTH);
+	tmpl.sym.cipher.data.length = sizeof(unsigned);
+	tmpl.sym.auth.data.length = sizeof(unsigned);
+
+	if (rte_crypto_op_bulk_alloc_from_template(op_mpool, &tmpl, burst,
+			burst_len) != burst_len) {
+		RTE_LOG(ERR, USER1, "failed to generate burst of crypto ops\n");
+		goto out;
+	}
+
+	for (i = 0; i < burst_len; i++) {
+		struct rte_mbuf *m = rte_pktmbuf_alloc(ts_params->mbuf_pool);
+		unsigned *data;
+
+		if (m == NULL) {
+			RTE_LOG(ERR, USER1, "Failed to allocate mbuf\n");
+			goto out;
+		}
+		burst[i]->sym->m_src = m;
+
+		data = (unsigned *)rte_pktmbuf_append(m, sizeof(unsigned));
+		*data = i;
+
+		if (burst[i]->sym->session != ut_params->sess ||
+				burst[i]->sym->cipher.iv.data !=
+				(uint8_t *)burst[i] + iv_offset ||
+				burst[i]->sym->cipher.iv.length !=
+				NULL_TMPL_IV_LENGTH) {
+			RTE_LOG(ERR, USER1, "op %u not filled from template\n",
+					i);
+			goto out;
+		}
+	}
+
+	/* plus one session-less op, whose session lives in the op */
+	burst[burst_len] = rte_crypto_op_alloc(op_mpool,
+			RTE_CRYPTO_OP_TYPE_SYMMETRIC);
+	if (burst[burst_len] == NULL ||
+			__rte_crypto_op_get_drv_priv_data(burst[burst_len],
+			1) == NULL) {
+		RTE_LOG(ERR, USER1, "no op driver private area\n");
+		goto out;
+	}
+	burst[burst_len]->sym->xform = &ut_params->cipher_xform;
+	burst[burst_len]->sym->m_src = rte_pktmbuf_alloc(ts_params->mbuf_pool);
+	if (burst[burst_len]->sym->m_src == NULL) {
+		RTE_LOG(ERR, USER1, "Failed to allocate mbuf\n");
+		goto out;
+	}
+	*(unsigned *)rte_pktmbuf_append(burst[burst_len]->sym->m_src,
+			sizeof(unsigned)) = burst_len;
+
+	if (rte_cryptodev_enqueue_burst(ts_params->valid_devs[0], 0, burst,
+			burst_len + 1) != burst_len + 1) {
+		RTE_LOG(ERR, USER1, "Error enqueuing burst\n");
+		goto out;
+	}
+
+	nb_deq = rte_cryptodev_dequeue_burst(ts_params->valid_devs[0], 0,
+			burst_dequeued, burst_len + 1);
+	if (nb_deq != burst_len + 1) {
+		RTE_LOG(ERR, USER1, "Error dequeuing burst\n");
+		goto out;
+	}
+
+	for (i = 0; i < nb_deq; i++) {
+		if (burst_dequeued[i]->status !=
+				RTE_CRYPTO_OP_STATUS_SUCCESS ||
+				*rte_pktmbuf_mtod(burst_dequeued[i]->sym->m_src,
+				unsigned *) != i) {
+			RTE_LOG(ERR, USER1, "op %u not processed\n", i);
+			goto out;
+		}
+	}
+
+	status = TEST_SUCCESS;
+out:
+	for (i = 0; i <= burst_len; i++) {
+		if (burst[i] == NULL)
+			continue;
+		rte_pktmbuf_free(burst[i]->sym->m_src);
+		rte_crypto_op_free(burst[i]);
+	}
+	rte_mempool_free(op_mpool);
+
+	return status;
+}
+
+static int
+null_xstat_value(struct rte_cryptodev_xstat_name *names,
+		struct rte_cryptodev_xstat *xstats, int nb, const char *name,
+		uint64_t *value)
+{
+	int i;
+
+	for (i = 0; i < nb; i++) {
+		if (strcmp(names[xstats[i].id].name, name) == 0) {
+			*value = xstats[i].value;
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+static int
+test_null_instrumentation(void)
+{
+	struct crypto_testsuite_params *ts_params = &testsuite_params;
+	struct crypto_unittest_params *ut_params = &unittest_params;
+	uint8_t dev_id = ts_params->valid_devs[0];
+	struct rte_cryptodev_xstat_name *names = NULL;
+	struct rte_cryptodev_xstat *xstats = NULL;
+	int nb_plain, nb, status = TEST_FAILED;
+	uint64_t val, hist_sum;
+	char name[RTE_CRYPTODEV_XSTATS_NAME_SIZE];
+
+	unsigned i, burst_len = NULL_BURST_LENGTH;
+
+	struct rte_crypto_op *burst[NULL_BURST_LENGTH] = { NULL };
+	struct rte_crypto_op *burst_dequeued[NULL_BURST_LENGTH] = { NULL };
+
+	ut_params->cipher_xform.type = RTE_CRYPTO_SYM_XFORM_CIPHER;
+	ut_params->cipher_xform.next = NULL;
+	ut_params->cipher_xform.cipher.algo = RTE_CRYPTO_CIPHER_NULL;
+	ut_params->cipher_xform.cipher.op = RTE_CRYPTO_CIPHER_OP_ENCRYPT;
+
+	ut_params->sess = rte_cryptodev_sym_session_create(dev_id,
+			&ut_params->cipher_xform);
+	TEST_ASSERT_NOT_NULL(ut_params->sess, "Session creation failed");
+
+	nb_plain = rte_cryptodev_xstats_get_names(dev_id, NULL, 0);
+	TEST_ASSERT(nb_plain > 0, "no extended statistics");
+
+	if (rte_cryptodev_instrument_enable(dev_id, 1) == -ENOTSUP)
+		return TEST_SUCCESS;
+
+	nb = rte_cryptodev_xstats_get_names(dev_id, NULL, 0);
+	TEST_ASSERT(nb > nb_plain, "no instrumentation statistics");
+
+	names = rte_calloc(NULL, nb, sizeof(*names), 0);
+	xstats = rte_calloc(NULL, nb, sizeof(*xstats), 0);
+	if (names == NULL || xstats == NULL)
+		goto out;
+
+	rte_cryptodev_xstats_reset(dev_id);
+
+	if (rte_crypto_op_bulk_alloc(ts_params->op_mpool,
+			RTE_CRYPTO_OP_TYPE_SYMMETRIC, burst, burst_len) !=
+			burst_len) {
+		RTE_LOG(ERR, USER1, "failed to generate burst of crypto ops\n");
+		goto out;
+	}
+
+	for (i = 0; i < burst_len; i++) {
+		rte_crypto_op_attach_sym_session(burst[i], ut_params->sess);
+		burst[i]->sym->m_src = rte_pktmbuf_alloc(ts_params->mbuf_pool);
+		if (burst[i]->sym->m_src == NULL ||
+				rte_pktmbuf_append(burst[i]->sym->m_src,
+				sizeof(unsigned)) == NULL) {
+			RTE_LOG(ERR, USER1, "Failed to allocate mbuf\n");
+			goto out;
+		}
+	}
+
+	if (rte_cryptodev_enqueue_burst(dev_id, 0, burst, burst_len) !=
+			burst_len) {
+		RTE_LOG(ERR, USER1, "Error enqueuing burst\n");
+		goto out;
+	}
+
+	/* in flight until dequeued */
+	if (rte_cryptodev_xstats_get_names(dev_id, names, nb) != nb ||
+			rte_cryptodev_xstats_get(dev_id, xstats, nb) != nb ||
+			null_xstat_value(names, xstats, nb, "qp0_in_flight",
+			&val) != 0 || val != burst_len) {
+		RTE_LOG(ERR, USER1, "in flight depth not reported\n");
+		goto out;
+	}
+
+	if (rte_cryptodev_dequeue_burst(dev_id, 0, burst_dequeued,
+			burst_len) != burst_len) {
+		RTE_LOG(ERR, USER1, "Error dequeuing burst\n");
+		goto out;
+	}
+
+	if (rte_cryptodev_xstats_get(dev_id, xstats, nb) != nb)
+		goto out;
+
+	hist_sum = 0;
+	for (i = 0; i < RTE_CRYPTODEV_INSTR_LAT_BUCKETS; i++) {
+		snprintf(name, sizeof(name), "qp0_lat_hist_2^%u", i);
+		if (null_xstat_value(names, xstats, nb, name, &val) != 0)
+			goto out;
+		hist_sum += val;
+	}
+
+	if (hist_sum != burst_len ||
+			null_xstat_value(names, xstats, nb, "qp0_in_flight",
+			&val) != 0 || val != 0 ||
+			null_xstat_value(names, xstats, nb, "qp0_max_in_flight",
+			&val) != 0 || val != burst_len ||
+			null_xstat_value(names, xstats, nb, "qp0_deq_ops",
+			&val) != 0 || val != burst_len ||
+			null_xstat_value(names, xstats, nb,
+			"qp0_enq_burst_hist_32_63", &val) != 0 || val != 1 ||
+			null_xstat_value(names, xstats, nb, "qp0_enqueued",
+			&val) != 0 || val != burst_len ||
+			null_xstat_value(names, xstats, nb, "enqueued_count",
+			&val) != 0 || val != burst_len) {
+		RTE_LOG(ERR, USER1, "unexpected instrumentation statistics\n");
+		goto out;
+	}
+
+	status = TEST_SUCCESS;
+out:
+	rte_cryptodev_instrument_enable(dev_id, 0);
+	for (i = 0; i < burst_len; i++) {
+		if (burst[i] == NULL)
+			continue;
+		rte_pktmbuf_free(burst[i]->sym->m_src);
+		rte_crypto_op_free(burst[i]);
+	}
+	rte_free(names);
+	rte_free(xstats);
+
+	if (status == TEST_SUCCESS)
+		TEST_ASSERT_EQUAL(rte_cryptodev_xstats_get_names(dev_id,
+				NULL, 0), nb_plain,
+				"instrumentation statistics not removed");
+
+	return status;
+}
+
+#define IPSEC_TEST_SPI		0x1234
+#define IPSEC_TEST_PAYLOAD_LEN	64
+
+static struct rte_mbuf *
+ipsec_test_copy_pkt(struct rte_mempool *mpool, struct rte_mbuf *m)
+{
+	struct rte_mbuf *c = rte_pktmbuf_alloc(mpool);
+	char *dst;
+
+	if (c == NULL)
+		return NULL;
+	dst = rte_pktmbuf_append(c, rte_pktmbuf_data_len(m));
+	if (dst == NULL) {
+		rte_pktmbuf_free(c);
+		return NULL;
+	}
+	rte_memcpy(dst, rte_pktmbuf_mtod(m, void *), rte_pktmbuf_data_len(m));
+
+	return c;
+}
+
+static int
+ipsec_test_process(uint8_t dev_id, struct rte_mempool *op_mpool,
+		struct rte_cryptodev_sym_session *sess, struct rte_mbuf *m)
+{
+	struct rte_crypto_op *op;
+	int status;
+
+	op = rte_crypto_op_alloc(op_mpool, RTE_CRYPTO_OP_TYPE_SYMMETRIC);
+	if (op == NULL)
+		return -1;
+
+	rte_crypto_op_attach_sym_session(op, sess);
+	op->sym->m_src = m;
+
+	if (process_crypto_request(dev_id, op) == NULL) {
+		rte_crypto_op_free(op);
+		return -1;
+	}
 
+	status = op->status;
+	rte_crypto_op_free(op);
 
+	return status;
+}
+
+static int
+test_ipsec_esp_tunnel_AES128CBC_HMAC_SHA1(void)
+{
+	struct crypto_testsuite_params *ts_params = &testsuite_params;
+	struct crypto_unittest_params *ut_params = &unittest_params;
+	struct rte_crypto_sym_xform ipsec_xform = { 0 };
+	struct rte_cryptodev_sym_session *in_sess;
+	struct rte_cryptodev_info info;
+	struct rte_mbuf *tampered, *replayed;
+	struct ipv4_hdr *ip, *outer;
+	uint8_t plain[sizeof(struct ipv4_hdr) + IPSEC_TEST_PAYLOAD_LEN];
+	uint8_t *esp;
+	uint16_t pkt_len = sizeof(plain);
+
+	rte_cryptodev_info_get(ts_params->valid_devs[0], &info);
+	if (!(info.feature_flags & RTE_CRYPTODEV_FF_IPSEC_PROTO_OFFLOAD))
+		return TEST_SUCCESS;
+
+	/* Inner IPv4 packet */
+	memset(plain, 0, sizeof(plain));
+	ip = (struct ipv4_hdr *)plain;
+	ip->version_ihl = 0x45;
+	ip->total_length = rte_cpu_to_be_16(pkt_len);
+	ip->time_to_live = 64;
+	ip->next_proto_id = IPPROTO_UDP;
+	ip->src_addr = rte_cpu_to_be_32(IPv4(192, 168, 1, 1));
+	ip->dst_addr = rte_cpu_to_be_32(IPv4(192, 168, 2, 1));
+	ip->hdr_checksum = rte_ipv4_cksum(ip);
+	memcpy(plain + sizeof(*ip), catch_22_quote, IPSEC_TEST_PAYLOAD_LEN);
+
+	ut_params->ibuf = setup_test_string(ts_params->mbuf_pool,
+			(const char *)plain, pkt_len, 0);
+	TEST_ASSERT_NOT_NULL(ut_params->ibuf, "Failed to allocate mbuf");
+
+	/* Egress SA: ipsec -> cipher -> auth */
+	ipsec_xform.type = RTE_CRYPTO_SYM_XFORM_IPSEC;
+	ipsec_xform.next = &ut_params->cipher_xform;
+	ipsec_xform.ipsec.proto = RTE_CRYPTO_IPSEC_PROTO_ESP;
+	ipsec_xform.ipsec.mode = RTE_CRYPTO_IPSEC_MODE_TUNNEL;
+	ipsec_xform.ipsec.direction = RTE_CRYPTO_IPSEC_DIR_EGRESS;
+	ipsec_xform.ipsec.spi = IPSEC_TEST_SPI;
+	ipsec_xform.ipsec.tunnel.type = RTE_CRYPTO_IPSEC_TUNNEL_IPV4;
+	ipsec_xform.ipsec.tunnel.ipv4.src_addr =
+			rte_cpu_to_be_32(IPv4(172, 16, 1, 5));
+	ipsec_xform.ipsec.tunnel.ipv4.dst_addr =
+			rte_cpu_to_be_32(IPv4(172, 16, 2, 5));
+
+	ut_params->cipher_xform.type = RTE_CRYPTO_SYM_XFORM_CIPHER;
+	ut_params->cipher_xform.next = &ut_params->auth_xform;
+	ut_params->cipher_xform.cipher.algo = RTE_CRYPTO_CIPHER_AES_CBC;
+	ut_params->cipher_xform.cipher.op = RTE_CRYPTO_CIPHER_OP_ENCRYPT;
+	ut_params->cipher_xform.cipher.key.data = aes_cbc_key;
+	ut_params->cipher_xform.cipher.key.length = CIPHER_KEY_LENGTH_AES_CBC;
+
+	ut_params->auth_xform.type = RTE_CRYPTO_SYM_XFORM_AUTH;
+	ut_params->auth_xform.next = NULL;
+	ut_params->auth_xform.auth.op = RTE_CRYPTO_AUTH_OP_GENERATE;
+	ut_params->auth_xform.auth.algo = RTE_CRYPTO_AUTH_SHA1_HMAC;
+	ut_params->auth_xform.auth.key.length = HMAC_KEY_LENGTH_SHA1;
+	ut_params->auth_xform.auth.key.data = hmac_sha1_key;
+	ut_params->auth_xform.auth.digest_length =
+			TRUNCATED_DIGEST_BYTE_LENGTH_SHA1;
+
+	ut_params->sess = rte_cryptodev_sym_session_create(
+			ts_params->valid_devs[0], &ipsec_xform);
+	TEST_ASSERT_NOT_NULL(ut_params->sess, "Session creation failed");
+
+	TEST_ASSERT_EQUAL(ipsec_test_process(ts_params->valid_devs[0],
+			ts_params->op_mpool, ut_params->sess, ut_params->ibuf),
+			RTE_CRYPTO_OP_STATUS_SUCCESS, "ESP egress failed");
+
+	outer = rte_pktmbuf_mtod(ut_params->ibuf, struct ipv4_hdr *);
+	TEST_ASSERT_EQUAL(outer->next_proto_id, IPPROTO_ESP,
+			"outer header does not carry ESP");
+	TEST_ASSERT_EQUAL(rte_be_to_cpu_16(outer->total_length),
+			rte_pktmbuf_data_len(ut_params->ibuf),
+			"outer length not as expected");
+	esp = (uint8_t *)(outer + 1);
+	TEST_ASSERT_EQUAL(rte_be_to_cpu_32(*(uint32_t *)esp), IPSEC_TEST_SPI,
+			"SPI not as expected");
+	TEST_ASSERT_EQUAL(rte_be_to_cpu_32(*(uint32_t *)(esp + 4)), 1,
+			"sequence number not as expected");
+
+	tampered = ipsec_test_copy_pkt(ts_params->mbuf_pool, ut_params->ibuf);
+	TEST_ASSERT_NOT_NULL(tampered, "Failed to copy packet");
+	replayed = ipsec_test_copy_pkt(ts_params->mbuf_pool, ut_params->ibuf);
+	TEST_ASSERT_NOT_NULL(replayed, "Failed to copy packet");
+
+	/* Ingress SA: ipsec -> auth -> cipher */
+	ipsec_xform.next = &ut_params->auth_xform;
+	ipsec_xform.ipsec.direction = RTE_CRYPTO_IPSEC_DIR_INGRESS;
+	ipsec_xform.ipsec.replay_win_sz = RTE_CRYPTO_IPSEC_MAX_REPLAY_WIN_SZ;
+	ut_params->auth_xform.next = &ut_params->cipher_xform;
+	ut_params->auth_xform.auth.op = RTE_CRYPTO_AUTH_OP_VERIFY;
+	ut_params->cipher_xform.next = NULL;
+	ut_params->cipher_xform.cipher.op = RTE_CRYPTO_CIPHER_OP_DECRYPT;
+
+	in_sess = rte_cryptodev_sym_session_create(ts_params->valid_devs[0],
+			&ipsec_xform);
+	TEST_ASSERT_NOT_NULL(in_sess, "Session creation failed");
+
+	/* A corrupted ICV must be rejected before touching the window */
+	*rte_pktmbuf_mtod_offset(tampered, uint8_t *,
+			rte_pktmbuf_data_len(tampered) - 1) ^= 0x1;
+	TEST_ASSERT_EQUAL(ipsec_test_process(ts_params->valid_devs[0],
+			ts_params->op_mpool, in_sess, tampered),
+			RTE_CRYPTO_OP_STATUS_AUTH_FAILED,
+			"tampered packet not rejected");
+
+	TEST_ASSERT_EQUAL(ipsec_test_process(ts_params->valid_devs[0],
+			ts_params->op_mpool, in_sess, ut_params->ibuf),
+			RTE_CRYPTO_OP_STATUS_SUCCESS, "ESP ingress failed");
+
+	TEST_ASSERT_EQUAL(rte_pktmbuf_data_len(ut_params->ibuf), pkt_len,
+			"decapsulated length not as expected");
+	TEST_ASSERT_BUFFERS_ARE_EQUAL(rte_pktmbuf_mtod(ut_params->ibuf,
+			uint8_t *), plain, pkt_len,
+			"decapsulated packet not as expected");
+
+	TEST_ASSERT_EQUAL(ipsec_test_process(ts_params->valid_devs[0],
+			ts_params->op_mpool, in_sess, replayed),
+			RTE_CRYPTO_OP_STATUS_ERROR, "replayed packet accepted");
+
+	rte_pktmbuf_free(tampered);
+	rte_pktmbuf_free(replayed);
+	rte_cryptodev_sym_session_free(ts_params->valid_devs[0], in_sess);
+
+	return TEST_SUCCESS;
+}
 
 static struct unit_test_suite cryptodev_qat_testsuite  = {
 	.suite_name = "Crypto QAT Unit Test Suite",
@@ -5085,6 +5588,44 @@ static struct unit_test_suite cryptodev_armce_testsuite  = {
 				authenticated_encryption_3DES192CBC_HMAC_SHA1),
 			TEST_CASE_ST(ut_setup, ut_teardown,
 				authenticated_decryption_3DES192CBC_HMAC_SHA1),
+			TEST_CASE_ST(ut_setup, ut_teardown, encryption_AES128CTR),
+			TEST_CASE_ST(ut_setup, ut_teardown, decryption_AES128CTR),
+			TEST_CASE_ST(ut_setup, ut_teardown, encryption_AES192CTR),
+			TEST_CASE_ST(ut_setup, ut_teardown, decryption_AES192CTR),
+			TEST_CASE_ST(ut_setup, ut_teardown, encryption_AES256CTR),
+			TEST_CASE_ST(ut_setup, ut_teardown, decryption_AES256CTR),
+
+			/** AES GCM Authenticated Encryption */
+			TEST_CASE_ST(ut_setup, ut_teardown,
+				test_mb_AES_GCM_authenticated_encryption_test_case_1),
+			TEST_CASE_ST(ut_setup, ut_teardown,
+				test_mb_AES_GCM_authenticated_encryption_test_case_2),
+			TEST_CASE_ST(ut_setup, ut_teardown,
+				test_mb_AES_GCM_authenticated_encryption_test_case_3),
+			TEST_CASE_ST(ut_setup, ut_teardown,
+				test_mb_AES_GCM_authenticated_encryption_test_case_4),
+			TEST_CASE_ST(ut_setup, ut_teardown,
+				test_mb_AES_GCM_authenticated_encryption_test_case_5),
+			TEST_CASE_ST(ut_setup, ut_teardown,
+				test_mb_AES_GCM_authenticated_encryption_test_case_6),
+			TEST_CASE_ST(ut_setup, ut_teardown,
+				test_mb_AES_GCM_authenticated_encryption_test_case_7),
+
+			/** AES GCM Authenticated Decryption */
+			TEST_CASE_ST(ut_setup, ut_teardown,
+				test_mb_AES_GCM_authenticated_decryption_test_case_1),
+			TEST_CASE_ST(ut_setup, ut_teardown,
+				test_mb_AES_GCM_authenticated_decryption_test_case_2),
+			TEST_CASE_ST(ut_setup, ut_teardown,
+				test_mb_AES_GCM_authenticated_decryption_test_case_3),
+			TEST_CASE_ST(ut_setup, ut_teardown,
+				test_mb_AES_GCM_authenticated_decryption_test_case_4),
+			TEST_CASE_ST(ut_setup, ut_teardown,
+				test_mb_AES_GCM_authenticated_decryption_test_case_5),
+			TEST_CASE_ST(ut_setup, ut_teardown,
+				test_mb_AES_GCM_authenticated_decryption_test_case_6),
+			TEST_CASE_ST(ut_setup, ut_teardown,
+				test_mb_AES_GCM_authenticated_decryption_test_case_7),
 
 		TEST_CASES_END() /**< NULL terminate unit test array */
 	}
@@ -5122,6 +5663,10 @@ static struct unit_test_suite cryptodev_dpaa2_sec_testsuite  = {
 				authenticated_encryption_AES128CBC_HMAC_SHA1),
 			TEST_CASE_ST(ut_setup, ut_teardown,
 				authenticated_decryption_AES128CBC_HMAC_SHA1),
+			TEST_CASE_ST(ut_setup, ut_teardown,
+				authenticated_encryption_AES128CBC_HMAC_SHA1_sgl),
+			TEST_CASE_ST(ut_setup, ut_teardown,
+				authenticated_decryption_AES128CBC_HMAC_SHA1_sgl),
 			TEST_CASE_ST(ut_setup, ut_teardown,
 				authenticated_encryption_3DES128CBC_HMAC_SHA1),
 			TEST_CASE_ST(ut_setup, ut_teardown,
@@ -5130,6 +5675,12 @@ static struct unit_test_suite cryptodev_dpaa2_sec_testsuite  = {
 				authenticated_encryption_3DES192CBC_HMAC_SHA1),
 			TEST_CASE_ST(ut_setup, ut_teardown,
 				authenticated_decryption_3DES192CBC_HMAC_SHA1),
+			TEST_CASE_ST(ut_setup, ut_teardown,
+			authenticated_encryption_AES128CBC_HMAC_SHA1_sessionless),
+			TEST_CASE_ST(ut_setup, ut_teardown,
+			authenticated_decryption_AES128CBC_HMAC_SHA1_sessionless),
+			TEST_CASE_ST(ut_setup, ut_teardown,
+			authenticated_encryption_AES128CBC_HMAC_SHA1_sessionless_cache),
 		TEST_CASES_END() /**< NULL terminate unit test array */
 	}
 };
@@ -5254,10 +5805,18 @@ static struct unit_test_suite cryptodev_openssl_testsuite  = {
 			authenticated_encryption_AES128CBC_HMAC_SHA1),
 		TEST_CASE_ST(ut_setup, ut_teardown,
 			authenticated_decryption_AES128CBC_HMAC_SHA1),
+		TEST_CASE_ST(ut_setup, ut_teardown,
+			authenticated_encryption_AES128CBC_HMAC_SHA1_sgl),
+		TEST_CASE_ST(ut_setup, ut_teardown,
+			authenticated_decryption_AES128CBC_HMAC_SHA1_sgl),
 		TEST_CASE_ST(ut_setup, ut_teardown,
 			authenticated_encryption_AES128CBC_AES128_GMAC),
 		TEST_CASE_ST(ut_setup, ut_teardown,
 			authenticated_decryption_AES128CBC_AES128_GMAC),
+		TEST_CASE_ST(ut_setup, ut_teardown,
+			authenticated_encryption_AES128CBC_AES128_GMAC_sgl),
+		TEST_CASE_ST(ut_setup, ut_teardown,
+			authenticated_decryption_AES128CBC_AES128_GMAC_sgl),
 		TEST_CASE_ST(ut_setup, ut_teardown,
 			authenticated_encryption_AES128CBC_AES192_GMAC),
 		TEST_CASE_ST(ut_setup, ut_teardown,
@@ -5294,6 +5853,10 @@ static struct unit_test_suite cryptodev_openssl_testsuite  = {
 			authenticated_encryption_3DES128CTR_HMAC_SHA1),
 		TEST_CASE_ST(ut_setup, ut_teardown,
 			authenticated_decryption_3DES128CTR_HMAC_SHA1),
+		TEST_CASE_ST(ut_setup, ut_teardown,
+			authenticated_encryption_3DES128CTR_HMAC_SHA1_sgl),
+		TEST_CASE_ST(ut_setup, ut_teardown,
+			authenticated_decryption_3DES128CTR_HMAC_SHA1_sgl),
 		TEST_CASE_ST(ut_setup, ut_teardown,
 			authenticated_encryption_3DES192CTR_SHA1),
 		TEST_CASE_ST(ut_setup, ut_teardown,
@@ -5306,6 +5869,8 @@ static struct unit_test_suite cryptodev_openssl_testsuite  = {
 			authenticated_encryption_AES128CBC_HMAC_SHA1_sessionless),
 		TEST_CASE_ST(ut_setup, ut_teardown,
 			authenticated_decryption_AES128CBC_HMAC_SHA1_sessionless),
+		TEST_CASE_ST(ut_setup, ut_teardown,
+			authenticated_encryption_AES128CBC_HMAC_SHA1_sessionless_cache),
 		TEST_CASE_ST(ut_setup, ut_teardown,
 			authenticated_encryption_3DES128CBC_HMAC_SHA1_sessionless),
 		TEST_CASE_ST(ut_setup, ut_teardown,
@@ -5314,6 +5879,8 @@ static struct unit_test_suite cryptodev_openssl_testsuite  = {
 			authenticated_encryption_3DES128CBC_HMAC_SHA1_out_of_place),
 		TEST_CASE_ST(ut_setup, ut_teardown,
 			authenticated_decryption_3DES128CBC_HMAC_SHA1_out_of_place),
+		TEST_CASE_ST(ut_setup, ut_teardown,
+			test_ipsec_esp_tunnel_AES128CBC_HMAC_SHA1),
 
 		TEST_CASES_END() /**< NULL terminate unit test array */
 	}
@@ -5506,6 +6073,10 @@ static struct unit_test_suite cryptodev_null_testsuite  = {
 			test_null_invalid_operation),
 		TEST_CASE_ST(ut_setup, ut_teardown,
 			test_null_burst_operation),
+		TEST_CASE_ST(ut_setup, ut_teardown,
+			test_null_op_template_burst_operation),
+		TEST_CASE_ST(ut_setup, ut_teardown,
+			test_null_instrumentation),
 
 		TEST_CASES_END() /**< NULL terminate unit test array */
 	}
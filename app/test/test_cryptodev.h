@@ -64,6 +64,7 @@
 #define DIGEST_BYTE_LENGTH_KASUMI_F9		(BYTE_LENGTH(32))
 #define AES_XCBC_MAC_KEY_SZ			(16)
 #define DIGEST_BYTE_LENGTH_AES_GMAC		(BYTE_LENGTH(128))
+#define DIGEST_BYTE_LENGTH_AES_GCM		(BYTE_LENGTH(128))
 
 #define TRUNCATED_DIGEST_BYTE_LENGTH_SHA1		(12)
 #define TRUNCATED_DIGEST_BYTE_LENGTH_SHA224		(16)
@@ -91,7 +91,8 @@ static const struct aes_test_case aes_test_cases[] = {
 		.op_mask = AES_TEST_OP_ENC_AUTH_GEN,
 		.pmd_mask = AES_TEST_TARGET_PMD_MB |
 			AES_TEST_TARGET_PMD_OPENSSL |
-			AES_TEST_TARGET_PMD_QAT
+			AES_TEST_TARGET_PMD_QAT |
+			AES_TEST_TARGET_PMD_ARMCE
 	},
 	{
 		.test_descr = "AES-128-CTR HMAC-SHA1 Decryption Digest "
@@ -100,7 +101,8 @@ static const struct aes_test_case aes_test_cases[] = {
 		.op_mask = AES_TEST_OP_AUTH_VERIFY_DEC,
 		.pmd_mask = AES_TEST_TARGET_PMD_MB |
 			AES_TEST_TARGET_PMD_OPENSSL |
-			AES_TEST_TARGET_PMD_QAT
+			AES_TEST_TARGET_PMD_QAT |
+			AES_TEST_TARGET_PMD_ARMCE
 	},
 	{
 		.test_descr = "AES-192-CTR XCBC Encryption Digest",
@@ -122,7 +124,8 @@ static const struct aes_test_case aes_test_cases[] = {
 		.op_mask = AES_TEST_OP_ENC_AUTH_GEN,
 		.pmd_mask = AES_TEST_TARGET_PMD_MB |
 			AES_TEST_TARGET_PMD_OPENSSL |
-			AES_TEST_TARGET_PMD_QAT
+			AES_TEST_TARGET_PMD_QAT |
+			AES_TEST_TARGET_PMD_ARMCE
 	},
 	{
 		.test_descr = "AES-256-CTR HMAC-SHA1 Decryption Digest "
@@ -131,7 +134,8 @@ static const struct aes_test_case aes_test_cases[] = {
 		.op_mask = AES_TEST_OP_AUTH_VERIFY_DEC,
 		.pmd_mask = AES_TEST_TARGET_PMD_MB |
 			AES_TEST_TARGET_PMD_OPENSSL |
-			AES_TEST_TARGET_PMD_QAT
+			AES_TEST_TARGET_PMD_QAT |
+			AES_TEST_TARGET_PMD_ARMCE
 	},
 	{
 		.test_descr = "AES-128-CBC HMAC-SHA1 Encryption Digest",
@@ -197,7 +201,8 @@ static const struct aes_test_case aes_test_cases[] = {
 		.op_mask = AES_TEST_OP_ENC_AUTH_GEN,
 		.feature_mask = AES_TEST_FEATURE_SESSIONLESS,
 		.pmd_mask = AES_TEST_TARGET_PMD_MB |
-			AES_TEST_TARGET_PMD_OPENSSL
+			AES_TEST_TARGET_PMD_OPENSSL |
+			AES_TEST_TARGET_PMD_ARMCE
 	},
 	{
 		.test_descr = "AES-128-CBC HMAC-SHA512 Decryption Digest "
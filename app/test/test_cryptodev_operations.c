@@ -43,6 +43,76 @@
 #include "test_cryptodev.h"
 #include "test_cryptodev_operations.h"
 
+/* Not a multiple of any block size, so that blocks straddle segments */
+#define SGL_SEGMENT_LENGTH	37
+
+/* Append data to a chain of mbufs holding SGL_SEGMENT_LENGTH bytes each */
+static struct rte_mbuf *
+create_segmented_mbuf(struct rte_mempool *mpool, const uint8_t *data,
+		unsigned int len)
+{
+	struct rte_mbuf *m = NULL, *seg;
+	unsigned int seg_len;
+	uint8_t *dst;
+
+	while (len > 0) {
+		seg = rte_pktmbuf_alloc(mpool);
+		if (seg == NULL)
+			goto error;
+
+		seg_len = RTE_MIN(len, (unsigned int)SGL_SEGMENT_LENGTH);
+		dst = (uint8_t *)rte_pktmbuf_append(seg, seg_len);
+		if (dst == NULL) {
+			rte_pktmbuf_free(seg);
+			goto error;
+		}
+		memcpy(dst, data, seg_len);
+
+		if (m == NULL)
+			m = seg;
+		else if (rte_pktmbuf_chain(m, seg) != 0) {
+			rte_pktmbuf_free(seg);
+			goto error;
+		}
+
+		data += seg_len;
+		len -= seg_len;
+	}
+
+	return m;
+
+error:
+	if (m != NULL)
+		rte_pktmbuf_free(m);
+	return NULL;
+}
+
+/* Gather len bytes from offset of a chain of mbufs */
+static int
+read_segmented_mbuf(const struct rte_mbuf *m, unsigned int offset,
+		uint8_t *buf, unsigned int len)
+{
+	unsigned int seg_len;
+
+	while (m != NULL && offset >= rte_pktmbuf_data_len(m)) {
+		offset -= rte_pktmbuf_data_len(m);
+		m = m->next;
+	}
+
+	for (; len > 0; m = m->next, offset = 0) {
+		if (m == NULL)
+			return -1;
+
+		seg_len = RTE_MIN(len, rte_pktmbuf_data_len(m) - offset);
+		memcpy(buf, rte_pktmbuf_mtod_offset(m, const uint8_t *, offset),
+				seg_len);
+		buf += seg_len;
+		len -= seg_len;
+	}
+
+	return 0;
+}
+
 static int
 create_auth_session(struct crypto_unittest_params *ut_params,
 		uint8_t dev_id,
@@ -1103,11 +1173,12 @@ test_authenticated_decryption(struct crypto_testsuite_params *ts_params,
 	return 0;
 }
 
-int
-test_authenticated_encryption_sessionless(
+static int
+authenticated_encryption_sessionless(
 		struct crypto_testsuite_params *ts_params,
 		struct crypto_unittest_params *ut_params,
-		const struct test_crypto_vector *reference)
+		const struct test_crypto_vector *reference,
+		unsigned int digest_matches)
 {
 	int retval;
 
@@ -1175,11 +1246,72 @@ test_authenticated_encryption_sessionless(
 
 	TEST_HEXDUMP(stdout, "digest:", digest, reference->digest.len);
 
-	TEST_ASSERT_BUFFERS_ARE_EQUAL(
-		digest,
-		reference->digest.data,
-		reference->digest.len,
-		"Generated auth tag not as expected");
+	if (digest_matches)
+		TEST_ASSERT_BUFFERS_ARE_EQUAL(
+			digest,
+			reference->digest.data,
+			reference->digest.len,
+			"Generated auth tag not as expected");
+	else
+		TEST_ASSERT(memcmp(digest, reference->digest.data,
+				reference->digest.len) != 0,
+			"Auth tag generated with a stale session");
+
+	return 0;
+}
+
+int
+test_authenticated_encryption_sessionless(
+		struct crypto_testsuite_params *ts_params,
+		struct crypto_unittest_params *ut_params,
+		const struct test_crypto_vector *reference)
+{
+	return authenticated_encryption_sessionless(ts_params, ut_params,
+			reference, 1);
+}
+
+static void
+release_sessionless_operation(struct crypto_unittest_params *ut_params)
+{
+	rte_crypto_op_free(ut_params->op);
+	ut_params->op = NULL;
+
+	rte_pktmbuf_free(ut_params->ibuf);
+	ut_params->ibuf = NULL;
+	ut_params->obuf = NULL;
+}
+
+int
+test_authenticated_encryption_sessionless_cache(
+		struct crypto_testsuite_params *ts_params,
+		struct crypto_unittest_params *ut_params,
+		const struct test_crypto_vector *reference)
+{
+	struct test_crypto_vector other = *reference;
+	unsigned int i;
+	int retval;
+
+	/*
+	 * Interleave the reference xforms with enough others, only differing
+	 * by their auth key, to evict sessions from the PMD session cache.
+	 * The reference must always hit a session with its own keys and
+	 * the others must never reuse it.
+	 */
+	for (i = 0; i < SESSIONLESS_CACHE_TEST_KEYS; i++) {
+		retval = authenticated_encryption_sessionless(ts_params,
+				ut_params, reference, 1);
+		if (retval < 0)
+			return retval;
+		release_sessionless_operation(ut_params);
+
+		other.auth_key.data[0] = reference->auth_key.data[0] ^ (i + 1);
+		retval = authenticated_encryption_sessionless(ts_params,
+				ut_params, &other, 0);
+		if (retval < 0)
+			return retval;
+		if (i < SESSIONLESS_CACHE_TEST_KEYS - 1)
+			release_sessionless_operation(ut_params);
+	}
 
 	return 0;
 }
@@ -1431,6 +1563,141 @@ test_authenticated_decryption_out_of_place(
 	return 0;
 }
 
+int
+test_authenticated_encryption_sgl(struct crypto_testsuite_params *ts_params,
+		struct crypto_unittest_params *ut_params,
+		const struct test_crypto_vector *reference)
+{
+	int retval;
+
+	uint8_t ciphertext[reference->ciphertext.len];
+	uint8_t *digest;
+	uint8_t cipher_key[reference->cipher_key.len + 1];
+	uint8_t auth_key[reference->auth_key.len + 1];
+
+	/* Create session */
+	retval = create_cipher_auth_session(ut_params,
+			ts_params->valid_devs[0],
+			reference,
+			RTE_CRYPTO_CIPHER_OP_ENCRYPT,
+			RTE_CRYPTO_AUTH_OP_GENERATE,
+			cipher_key,
+			auth_key);
+	if (retval < 0)
+		return retval;
+
+	ut_params->ibuf = create_segmented_mbuf(ts_params->mbuf_pool,
+			reference->plaintext.data, reference->plaintext.len);
+	TEST_ASSERT_NOT_NULL(ut_params->ibuf,
+			"Failed to create segmented input buffer");
+
+	/* Create operation */
+	retval = create_cipher_auth_generate_operation(ts_params,
+			ut_params,
+			reference);
+
+	if (retval < 0)
+		return retval;
+
+	digest = ut_params->op->sym->auth.digest.data;
+
+	ut_params->op = process_crypto_request(ts_params->valid_devs[0],
+			ut_params->op);
+	TEST_ASSERT_NOT_NULL(ut_params->op, "failed crypto process");
+	TEST_ASSERT_EQUAL(ut_params->op->status, RTE_CRYPTO_OP_STATUS_SUCCESS,
+			"crypto op status not success");
+
+	ut_params->obuf = ut_params->op->sym->m_src;
+	TEST_ASSERT_NOT_NULL(ut_params->obuf, "failed to retrieve obuf");
+
+	TEST_ASSERT_SUCCESS(read_segmented_mbuf(ut_params->obuf,
+			reference->iv.len, ciphertext,
+			reference->ciphertext.len),
+			"segmented output buffer too short");
+
+	TEST_HEXDUMP(stdout, "ciphertext:", ciphertext, reference->ciphertext.len);
+
+	TEST_ASSERT_BUFFERS_ARE_EQUAL(
+		ciphertext,
+		reference->ciphertext.data,
+		reference->ciphertext.len,
+		"Ciphertext data not as expected");
+
+	TEST_HEXDUMP(stdout, "digest:", digest, reference->digest.len);
+
+	TEST_ASSERT_BUFFERS_ARE_EQUAL(
+		digest,
+		reference->digest.data,
+		reference->digest.len,
+		"Generated auth tag not as expected");
+
+	return 0;
+}
+
+int
+test_authenticated_decryption_sgl(struct crypto_testsuite_params *ts_params,
+		struct crypto_unittest_params *ut_params,
+		const struct test_crypto_vector *reference)
+{
+	int retval;
+
+	uint8_t plaintext[reference->plaintext.len];
+	uint8_t auth_key[reference->auth_key.len + 1];
+	uint8_t cipher_key[reference->cipher_key.len + 1];
+
+	/* Create session */
+	retval = create_auth_cipher_session(ut_params,
+			ts_params->valid_devs[0],
+			reference,
+			RTE_CRYPTO_AUTH_OP_VERIFY,
+			RTE_CRYPTO_CIPHER_OP_DECRYPT,
+			auth_key,
+			cipher_key);
+	if (retval < 0)
+		return retval;
+
+	ut_params->ibuf = create_segmented_mbuf(ts_params->mbuf_pool,
+			reference->ciphertext.data, reference->ciphertext.len);
+	TEST_ASSERT_NOT_NULL(ut_params->ibuf,
+			"Failed to create segmented input buffer");
+
+	/* Create operation */
+	retval = create_cipher_auth_verify_operation(ts_params,
+			ut_params,
+			reference);
+
+	if (retval < 0)
+		return retval;
+
+	ut_params->op = process_crypto_request(ts_params->valid_devs[0],
+			ut_params->op);
+	TEST_ASSERT_NOT_NULL(ut_params->op, "failed crypto process");
+	TEST_ASSERT_NOT_EQUAL(ut_params->op->status,
+			RTE_CRYPTO_OP_STATUS_AUTH_FAILED,
+			"authentication failed");
+	TEST_ASSERT_EQUAL(ut_params->op->status,
+			RTE_CRYPTO_OP_STATUS_SUCCESS,
+			"crypto op status not success");
+
+	ut_params->obuf = ut_params->op->sym->m_src;
+	TEST_ASSERT_NOT_NULL(ut_params->obuf, "failed to retrieve obuf");
+
+	TEST_ASSERT_SUCCESS(read_segmented_mbuf(ut_params->obuf,
+			reference->iv.len, plaintext,
+			reference->plaintext.len),
+			"segmented output buffer too short");
+
+	TEST_HEXDUMP(stdout, "plaintext:", plaintext, reference->plaintext.len);
+
+	TEST_ASSERT_BUFFERS_ARE_EQUAL(
+		plaintext,
+		reference->plaintext.data,
+		reference->plaintext.len,
+		"Plaintext data not as expected");
+
+	return 0;
+}
+
 int
 test_authentication_GMAC(struct crypto_testsuite_params *ts_params,
 		struct crypto_unittest_params *ut_params,
@@ -116,6 +116,15 @@ test_authenticated_decryption_sessionless(
 		struct crypto_unittest_params *ut_params,
 		const struct test_crypto_vector *reference);
 
+/* Number of distinct xforms used to churn the session-less session cache */
+#define SESSIONLESS_CACHE_TEST_KEYS	160
+
+int
+test_authenticated_encryption_sessionless_cache(
+		struct crypto_testsuite_params *ts_params,
+		struct crypto_unittest_params *ut_params,
+		const struct test_crypto_vector *reference);
+
 int
 test_authenticated_encryption_out_of_place(
 		struct crypto_testsuite_params *ts_params,
@@ -128,6 +137,16 @@ test_authenticated_decryption_out_of_place(
 		struct crypto_unittest_params *ut_params,
 		const struct test_crypto_vector *reference);
 
+int
+test_authenticated_encryption_sgl(struct crypto_testsuite_params *ts_params,
+		struct crypto_unittest_params *ut_params,
+		const struct test_crypto_vector *reference);
+
+int
+test_authenticated_decryption_sgl(struct crypto_testsuite_params *ts_params,
+		struct crypto_unittest_params *ut_params,
+		const struct test_crypto_vector *reference);
+
 int
 test_authentication_GMAC(struct crypto_testsuite_params *ts_params,
 		struct crypto_unittest_params *ut_params,
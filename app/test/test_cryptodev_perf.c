@@ -38,6 +38,9 @@
 #include <rte_crypto.h>
 #include <rte_cryptodev.h>
 #include <rte_cycles.h>
+#ifdef RTE_LIBRTE_PMD_CRYPTO_SCHEDULER
+#include <rte_cryptodev_scheduler.h>
+#endif
 
 #include "test.h"
 #include "test_cryptodev.h"
@@ -117,6 +120,10 @@ static inline struct rte_crypto_op *
 test_perf_set_crypto_op_3des(struct rte_crypto_op *op, struct rte_mbuf *m,
 		struct rte_cryptodev_sym_session *sess, unsigned int data_len,
 		unsigned int digest_len);
+static inline struct rte_crypto_op *
+test_perf_set_crypto_op_aes_gcm(struct rte_crypto_op *op, struct rte_mbuf *m,
+		struct rte_cryptodev_sym_session *sess, unsigned int data_len,
+		unsigned int digest_len);
 
 static uint32_t get_auth_digest_length(enum rte_crypto_auth_algorithm algo);
 
@@ -150,6 +157,10 @@ static const char *pmd_name(enum rte_cryptodev_type pmd)
 		return RTE_STR(CRYPTODEV_NAME_DPAA_SEC_PMD);
 	case RTE_CRYPTODEV_ARMCE_PMD:
 		return RTE_STR(CRYPTODEV_NAME_ARMCE_PMD);
+	case RTE_CRYPTODEV_OPENSSL_PMD:
+		return RTE_STR(CRYPTODEV_NAME_OPENSSL_PMD);
+	case RTE_CRYPTODEV_SCHEDULER_PMD:
+		return RTE_STR(CRYPTODEV_NAME_SCHEDULER_PMD);
 	default:
 		return "";
 	}
@@ -230,6 +241,101 @@ static struct crypto_perf_testsuite_params testsuite_params = { NULL };
 static struct crypto_perf_unittest_params unittest_params;
 static enum rte_cryptodev_type gbl_cryptodev_perftest_devtype;
 
+#ifdef RTE_LIBRTE_PMD_CRYPTO_SCHEDULER
+#define SCHEDULER_NB_SLAVES	2
+
+static enum rte_cryptodev_type gbl_cryptodev_scheduler_slave_type;
+
+/*
+ * Create a scheduler and attach it 2 slaves, configured with the queue pairs
+ * the scheduler is configured with below.
+ */
+static int
+test_perf_scheduler_setup(void)
+{
+	enum rte_cryptodev_type slave_type = gbl_cryptodev_scheduler_slave_type;
+	struct rte_cryptodev_config conf;
+	struct rte_cryptodev_qp_conf qp_conf;
+	struct rte_cryptodev_info info;
+	uint8_t slaves[SCHEDULER_NB_SLAVES];
+	unsigned i, nb_devs, nb_slaves = 0;
+	int ret, scheduler_id = -1;
+	uint16_t qp_id;
+
+	nb_devs = rte_cryptodev_count_devtype(slave_type);
+	for (i = nb_devs; i < SCHEDULER_NB_SLAVES; i++) {
+		ret = rte_eal_vdev_init(pmd_name(slave_type), NULL);
+
+		TEST_ASSERT(ret == 0, "Failed to create instance %u of pmd : %s",
+				i, pmd_name(slave_type));
+	}
+
+	if (rte_cryptodev_count_devtype(RTE_CRYPTODEV_SCHEDULER_PMD) == 0) {
+		ret = rte_eal_vdev_init(
+				RTE_STR(CRYPTODEV_NAME_SCHEDULER_PMD), NULL);
+
+		TEST_ASSERT(ret == 0, "Failed to create instance of pmd : %s",
+				RTE_STR(CRYPTODEV_NAME_SCHEDULER_PMD));
+	}
+
+	nb_devs = rte_cryptodev_count();
+	for (i = 0; i < nb_devs; i++) {
+		rte_cryptodev_info_get(i, &info);
+		if (info.dev_type == RTE_CRYPTODEV_SCHEDULER_PMD &&
+				scheduler_id < 0)
+			scheduler_id = i;
+		else if (info.dev_type == slave_type &&
+				nb_slaves < SCHEDULER_NB_SLAVES)
+			slaves[nb_slaves++] = i;
+	}
+
+	TEST_ASSERT(scheduler_id >= 0, "Failed to find scheduler");
+
+	/* deeper than the scheduler queue pairs, so slaves never overflow */
+	qp_conf.nb_descriptors = 2 * PERF_NUM_OPS_INFLIGHT;
+
+	for (i = 0; i < nb_slaves; i++) {
+		rte_cryptodev_info_get(slaves[i], &info);
+
+		conf.nb_queue_pairs = info.max_nb_queue_pairs;
+		conf.socket_id = SOCKET_ID_ANY;
+		conf.session_mp.nb_objs = info.sym.max_nb_sessions;
+		conf.session_mp.cache_size = 0;
+
+		TEST_ASSERT_SUCCESS(rte_cryptodev_configure(slaves[i], &conf),
+				"Failed to configure cryptodev %u", slaves[i]);
+
+		for (qp_id = 0; qp_id < conf.nb_queue_pairs; qp_id++)
+			TEST_ASSERT_SUCCESS(rte_cryptodev_queue_pair_setup(
+					slaves[i], qp_id, &qp_conf,
+					rte_cryptodev_socket_id(slaves[i])),
+					"Failed to setup queue pair %u on "
+					"cryptodev %u", qp_id, slaves[i]);
+
+		TEST_ASSERT_SUCCESS(rte_cryptodev_scheduler_slave_attach(
+				scheduler_id, slaves[i]),
+				"Failed to attach slave %u", slaves[i]);
+	}
+
+	return TEST_SUCCESS;
+}
+
+/* Detach the slaves, so that the scheduler can get other ones */
+static void
+test_perf_scheduler_teardown(void)
+{
+	struct crypto_perf_testsuite_params *ts_params = &testsuite_params;
+	uint8_t slaves[RTE_CRYPTODEV_SCHEDULER_MAX_NB_SLAVES];
+	int i, nb_slaves;
+
+	nb_slaves = rte_cryptodev_scheduler_slaves_get(ts_params->dev_id,
+			slaves);
+	for (i = 0; i < nb_slaves; i++)
+		rte_cryptodev_scheduler_slave_detach(ts_params->dev_id,
+				slaves[i]);
+}
+#endif
+
 static int
 testsuite_setup(void)
 {
@@ -308,6 +414,15 @@ testsuite_setup(void)
 		}
 	}
 
+#ifdef RTE_LIBRTE_PMD_CRYPTO_SCHEDULER
+	/* Create a scheduler and its slaves if required */
+	if (gbl_cryptodev_perftest_devtype == RTE_CRYPTODEV_SCHEDULER_PMD) {
+		ret = test_perf_scheduler_setup();
+		if (ret != TEST_SUCCESS)
+			return ret;
+	}
+#endif
+
 	/* Create 2 ARMCE devices if required */
 	if (gbl_cryptodev_perftest_devtype == RTE_CRYPTODEV_ARMCE_PMD) {
 		nb_devs = rte_cryptodev_count_devtype(RTE_CRYPTODEV_ARMCE_PMD);
@@ -397,6 +512,11 @@ testsuite_teardown(void)
 	if (ts_params->op_mpool != NULL)
 		RTE_LOG(DEBUG, USER1, "CRYPTO_PERF_OP POOL count %u\n",
 		rte_mempool_avail_count(ts_params->op_mpool));
+
+#ifdef RTE_LIBRTE_PMD_CRYPTO_SCHEDULER
+	if (gbl_cryptodev_perftest_devtype == RTE_CRYPTODEV_SCHEDULER_PMD)
+		test_perf_scheduler_teardown();
+#endif
 }
 
 static int
@@ -2386,11 +2506,15 @@ static uint32_t get_auth_digest_length(enum rte_crypto_auth_algorithm algo)
 		return TRUNCATED_DIGEST_BYTE_LENGTH_SHA512;
 	case RTE_CRYPTO_AUTH_AES_GMAC:
 		return DIGEST_BYTE_LENGTH_AES_GMAC;
+	case RTE_CRYPTO_AUTH_AES_GCM:
+		return DIGEST_BYTE_LENGTH_AES_GCM;
 	default:
 		return 0;
 	}
 }
 
+#define GCM_AAD_LENGTH 8
+
 static uint8_t aes_key[] = {
 		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
@@ -2568,6 +2692,7 @@ test_perf_create_openssl_session(uint8_t dev_id, enum chain_mode chain,
 		break;
 	case RTE_CRYPTO_CIPHER_AES_CBC:
 	case RTE_CRYPTO_CIPHER_AES_CTR:
+	case RTE_CRYPTO_CIPHER_AES_GCM:
 		cipher_xform.cipher.key.data = aes_key;
 		break;
 	default:
@@ -2583,11 +2708,17 @@ test_perf_create_openssl_session(uint8_t dev_id, enum chain_mode chain,
 
 	switch (auth_algo) {
 	case RTE_CRYPTO_AUTH_SHA1_HMAC:
+	case RTE_CRYPTO_AUTH_SHA256_HMAC:
 		auth_xform.auth.key.data = hmac_sha_key;
 		break;
 	case RTE_CRYPTO_AUTH_AES_GMAC:
 		auth_xform.auth.key.data = gmac_key;
 		break;
+	case RTE_CRYPTO_AUTH_AES_GCM:
+		/* The GCM tag uses the cipher key */
+		auth_xform.auth.key.data = NULL;
+		auth_xform.auth.add_auth_data_length = GCM_AAD_LENGTH;
+		break;
 	default:
 		return NULL;
 	}
@@ -2740,6 +2871,45 @@ test_perf_set_crypto_op_3des(struct rte_crypto_op *op, struct rte_mbuf *m,
 	return op;
 }
 
+static inline struct rte_crypto_op *
+test_perf_set_crypto_op_aes_gcm(struct rte_crypto_op *op, struct rte_mbuf *m,
+		struct rte_cryptodev_sym_session *sess, unsigned int data_len,
+		unsigned int digest_len)
+{
+	if (rte_crypto_op_attach_sym_session(op, sess) != 0) {
+		rte_crypto_op_free(op);
+		return NULL;
+	}
+
+	/* Authentication Parameters */
+	op->sym->auth.digest.data = (uint8_t *)m->buf_addr +
+					(m->data_off + data_len);
+	op->sym->auth.digest.phys_addr = rte_pktmbuf_mtophys_offset(m, data_len);
+	op->sym->auth.digest.length = digest_len;
+	op->sym->auth.aad.data = aes_iv;
+	op->sym->auth.aad.length = GCM_AAD_LENGTH;
+
+	/* Cipher Parameters, a 96 bit IV given as pre-counter block J0 */
+	op->sym->cipher.iv.data = (uint8_t *)m->buf_addr + m->data_off;
+	op->sym->cipher.iv.phys_addr = rte_pktmbuf_mtophys(m);
+	op->sym->cipher.iv.length = AES_CIPHER_IV_LENGTH;
+
+	rte_memcpy(op->sym->cipher.iv.data, aes_iv,
+		   AES_CIPHER_IV_LENGTH);
+	op->sym->cipher.iv.data[AES_CIPHER_IV_LENGTH - 1] = 1;
+
+	/* Data lengths/offsets Parameters */
+	op->sym->auth.data.offset = AES_BLOCK_SIZE;
+	op->sym->auth.data.length = data_len - AES_BLOCK_SIZE;
+
+	op->sym->cipher.data.offset = AES_BLOCK_SIZE;
+	op->sym->cipher.data.length = data_len - AES_BLOCK_SIZE;
+
+	op->sym->m_src = m;
+
+	return op;
+}
+
 /* An mbuf set is used in each burst. An mbuf can be used by multiple bursts at
  * same time, i.e. as they're not dereferenced there's no need to wait until
  * finished with to re-use */
@@ -3063,6 +3233,9 @@ test_perf_openssl(uint8_t dev_id, uint16_t queue_id,
 	case RTE_CRYPTO_CIPHER_AES_CTR:
 		test_perf_set_crypto_op = test_perf_set_crypto_op_aes;
 		break;
+	case RTE_CRYPTO_CIPHER_AES_GCM:
+		test_perf_set_crypto_op = test_perf_set_crypto_op_aes_gcm;
+		break;
 	default:
 		return TEST_FAILED;
 	}
@@ -3073,7 +3246,7 @@ test_perf_openssl(uint8_t dev_id, uint16_t queue_id,
 	}
 
 	/* Create Crypto session*/
-	sess = test_perf_create_openssl_session(ts_params->dev_id,
+	sess = test_perf_create_openssl_session(dev_id,
 			pparams->chain, pparams->cipher_algo,
 			pparams->cipher_key_length, pparams->auth_algo);
 	TEST_ASSERT_NOT_NULL(sess, "Session creation failed");
@@ -3399,6 +3572,183 @@ test_perf_openssl_vary_pkt_size(void)
 	return 0;
 }
 
+/*
+ * AES-CTR/CBC with HMAC-SHA256 at the packet sizes of
+ * test_perf_openssl_vary_pkt_size, to compare the ARMv8 Crypto Extensions
+ * PMD with the OpenSSL one. AES-GCM is only measured on ARMCE, the OpenSSL
+ * PMD not supporting the GCM cipher and auth chain.
+ */
+static int
+test_perf_aes_sha256_gcm_vary_pkt_size(void)
+{
+	unsigned int total_operations = 1000000;
+	unsigned int burst_size = { 64 };
+	unsigned int buf_lengths[] = { 64, 128, 256, 512, 768, 1024, 1280, 1536,
+			1792, 2048 };
+	uint8_t i, j;
+
+	struct perf_test_params params_set[] = {
+		{
+			.chain = CIPHER_HASH,
+
+			.cipher_algo  = RTE_CRYPTO_CIPHER_AES_CTR,
+			.cipher_key_length = 16,
+			.auth_algo = RTE_CRYPTO_AUTH_SHA256_HMAC
+		},
+		{
+			.chain = CIPHER_HASH,
+
+			.cipher_algo  = RTE_CRYPTO_CIPHER_AES_CTR,
+			.cipher_key_length = 32,
+			.auth_algo = RTE_CRYPTO_AUTH_SHA256_HMAC
+		},
+		{
+			.chain = CIPHER_HASH,
+
+			.cipher_algo  = RTE_CRYPTO_CIPHER_AES_CBC,
+			.cipher_key_length = 16,
+			.auth_algo = RTE_CRYPTO_AUTH_SHA256_HMAC
+		},
+		{
+			.chain = CIPHER_HASH,
+
+			.cipher_algo  = RTE_CRYPTO_CIPHER_AES_GCM,
+			.cipher_key_length = 16,
+			.auth_algo = RTE_CRYPTO_AUTH_AES_GCM
+		},
+		{
+			.chain = CIPHER_HASH,
+
+			.cipher_algo  = RTE_CRYPTO_CIPHER_AES_GCM,
+			.cipher_key_length = 32,
+			.auth_algo = RTE_CRYPTO_AUTH_AES_GCM
+		},
+	};
+
+	for (i = 0; i < RTE_DIM(params_set); i++) {
+		if (params_set[i].cipher_algo == RTE_CRYPTO_CIPHER_AES_GCM &&
+				gbl_cryptodev_perftest_devtype !=
+				RTE_CRYPTODEV_ARMCE_PMD)
+			continue;
+
+		params_set[i].total_operations = total_operations;
+		params_set[i].burst_size = burst_size;
+		printf("\nOn %s, %s. cipher algo: %s auth algo: %s cipher key "
+				"size=%u. burst_size: %d ops\n",
+				pmd_name(gbl_cryptodev_perftest_devtype),
+				chain_mode_name(params_set[i].chain),
+				cipher_algo_name(params_set[i].cipher_algo),
+				auth_algo_name(params_set[i].auth_algo),
+				params_set[i].cipher_key_length,
+				burst_size);
+		printf("\nBuffer Size(B)\tOPS(M)\tThroughput(Gbps)\tRetries\t"
+				"EmptyPolls\n");
+		for (j = 0; j < RTE_DIM(buf_lengths); j++) {
+			params_set[i].buf_size = buf_lengths[j];
+			test_perf_openssl(testsuite_params.dev_id, 0, &params_set[i]);
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Compare processing on the enqueueing lcore with processing on a worker
+ * lcore, for the packet sizes of test_perf_openssl_vary_pkt_size.
+ */
+static int
+test_perf_openssl_worker_vary_pkt_size(void)
+{
+	struct crypto_perf_testsuite_params *ts_params = &testsuite_params;
+	static int worker_dev_id = -1;
+	struct rte_cryptodev_config conf;
+	struct rte_cryptodev_qp_conf qp_conf;
+	struct rte_cryptodev_info info;
+	unsigned int total_operations = 1000000;
+	unsigned int burst_size = { 64 };
+	unsigned int buf_lengths[] = { 64, 128, 256, 512, 1024, 1536, 2048 };
+	unsigned int lcore;
+	char args[32];
+	uint8_t i, j;
+
+	struct perf_test_params params_set[] = {
+		{
+			.chain = CIPHER_HASH,
+
+			.cipher_algo  = RTE_CRYPTO_CIPHER_AES_CBC,
+			.cipher_key_length = 16,
+			.auth_algo = RTE_CRYPTO_AUTH_SHA1_HMAC
+		},
+		{
+			.chain = CIPHER_HASH,
+
+			.cipher_algo  = RTE_CRYPTO_CIPHER_AES_CTR,
+			.cipher_key_length = 16,
+			.auth_algo = RTE_CRYPTO_AUTH_SHA1_HMAC
+		},
+	};
+
+	if (worker_dev_id < 0) {
+		lcore = rte_get_next_lcore(-1, 1, 0);
+		if (lcore >= RTE_MAX_LCORE) {
+			printf("\nNo slave lcore for the OPENSSL worker, "
+					"skipping\n");
+			return TEST_SUCCESS;
+		}
+
+		snprintf(args, sizeof(args), "worker_lcore=%u", lcore);
+		TEST_ASSERT_SUCCESS(rte_eal_vdev_init(
+				RTE_STR(CRYPTODEV_NAME_OPENSSL_PMD), args),
+				"Failed to create pmd : %s with %s",
+				RTE_STR(CRYPTODEV_NAME_OPENSSL_PMD), args);
+		worker_dev_id = rte_cryptodev_count() - 1;
+
+		rte_cryptodev_info_get(worker_dev_id, &info);
+		conf.nb_queue_pairs = 1;
+		conf.socket_id = SOCKET_ID_ANY;
+		conf.session_mp.nb_objs = info.sym.max_nb_sessions;
+		conf.session_mp.cache_size = 0;
+		TEST_ASSERT_SUCCESS(rte_cryptodev_configure(worker_dev_id,
+				&conf), "Failed to configure cryptodev %d",
+				worker_dev_id);
+
+		qp_conf.nb_descriptors = PERF_NUM_OPS_INFLIGHT;
+		TEST_ASSERT_SUCCESS(rte_cryptodev_queue_pair_setup(
+				worker_dev_id, 0, &qp_conf,
+				rte_cryptodev_socket_id(worker_dev_id)),
+				"Failed to setup queue pair on cryptodev %d",
+				worker_dev_id);
+	}
+
+	TEST_ASSERT_SUCCESS(rte_cryptodev_start(worker_dev_id),
+			"Failed to start cryptodev %d", worker_dev_id);
+
+	for (i = 0; i < RTE_DIM(params_set); i++) {
+		params_set[i].total_operations = total_operations;
+		params_set[i].burst_size = burst_size;
+		printf("\n%s. cipher algo: %s auth algo: %s cipher key size=%u."
+				" burst_size: %d ops\n",
+				chain_mode_name(params_set[i].chain),
+				cipher_algo_name(params_set[i].cipher_algo),
+				auth_algo_name(params_set[i].auth_algo),
+				params_set[i].cipher_key_length,
+				burst_size);
+		printf("\nMode\tBuffer Size(B)\tOPS(M)\tThroughput(Gbps)\t"
+				"Retries\tEmptyPolls\n");
+		for (j = 0; j < RTE_DIM(buf_lengths); j++) {
+			params_set[i].buf_size = buf_lengths[j];
+			printf("inline");
+			test_perf_openssl(ts_params->dev_id, 0, &params_set[i]);
+			printf("worker");
+			test_perf_openssl(worker_dev_id, 0, &params_set[i]);
+		}
+	}
+
+	rte_cryptodev_stop(worker_dev_id);
+
+	return 0;
+}
+
 static int
 test_perf_openssl_vary_burst_size(void)
 {
@@ -3483,7 +3833,434 @@ test_perf_aes_cbc_vary_burst_size(void)
 	return test_perf_crypto_qp_vary_burst_size(testsuite_params.dev_id);
 }
 
+enum session_churn_mode {
+	SESSION_CHURN_PERSISTENT,
+	SESSION_CHURN_CREATE_FREE,
+	SESSION_CHURN_SESSIONLESS
+};
+
+static const char *session_churn_mode_name(enum session_churn_mode mode)
+{
+	switch (mode) {
+	case SESSION_CHURN_PERSISTENT: return "persistent session";
+	case SESSION_CHURN_CREATE_FREE: return "session per op";
+	case SESSION_CHURN_SESSIONLESS: return "session-less";
+	default: return "";
+	}
+}
+
+#define SESSION_CHURN_BURST_SIZE	32
+#define SESSION_CHURN_BUF_SIZE		64
+
+/* Fill the AES-CBC and HMAC-SHA1 xforms of the key_id-th key pair */
+static void
+test_perf_session_churn_xforms(struct rte_crypto_sym_xform *cipher_xform,
+		struct rte_crypto_sym_xform *auth_xform, uint8_t *cipher_key,
+		uint8_t *auth_key, unsigned int key_id)
+{
+	memcpy(cipher_key, aes_key, 16);
+	memcpy(auth_key, hmac_sha_key, DIGEST_BYTE_LENGTH_SHA1);
+	cipher_key[0] ^= key_id & 0xff;
+	cipher_key[1] ^= key_id >> 8;
+
+	cipher_xform->type = RTE_CRYPTO_SYM_XFORM_CIPHER;
+	cipher_xform->next = auth_xform;
+	cipher_xform->cipher.algo = RTE_CRYPTO_CIPHER_AES_CBC;
+	cipher_xform->cipher.op = RTE_CRYPTO_CIPHER_OP_ENCRYPT;
+	cipher_xform->cipher.key.data = cipher_key;
+	cipher_xform->cipher.key.length = 16;
+
+	auth_xform->type = RTE_CRYPTO_SYM_XFORM_AUTH;
+	auth_xform->next = NULL;
+	auth_xform->auth.algo = RTE_CRYPTO_AUTH_SHA1_HMAC;
+	auth_xform->auth.op = RTE_CRYPTO_AUTH_OP_GENERATE;
+	auth_xform->auth.key.data = auth_key;
+	auth_xform->auth.key.length = DIGEST_BYTE_LENGTH_SHA1;
+	auth_xform->auth.digest_length = DIGEST_BYTE_LENGTH_SHA1;
+	auth_xform->auth.add_auth_data_length = 0;
+}
+
+/*
+ * Average cycles per operation of AES-CBC/HMAC-SHA1 bursts whose operations
+ * cycle through nb_keys key pairs, either on sessions set up in advance,
+ * on a session created and freed around each operation or session-less.
+ */
+static int
+test_perf_session_churn(uint8_t dev_id, uint16_t queue_id,
+		enum session_churn_mode mode, unsigned int nb_keys,
+		unsigned int total_operations, double *cycles_per_op)
+{
+	struct crypto_perf_testsuite_params *ts_params = &testsuite_params;
+	struct rte_crypto_op *ops[SESSION_CHURN_BURST_SIZE];
+	struct rte_mbuf *mbufs[SESSION_CHURN_BURST_SIZE];
+	struct rte_cryptodev_sym_session *sessions[nb_keys];
+	struct rte_cryptodev_sym_session *op_sess[SESSION_CHURN_BURST_SIZE];
+	struct rte_crypto_sym_xform cipher_xform, auth_xform;
+	uint8_t cipher_keys[nb_keys][16];
+	uint8_t auth_keys[nb_keys][DIGEST_BYTE_LENGTH_SHA1];
+	struct rte_crypto_sym_xform *xform;
+	unsigned int i, key_id = 0, processed = 0;
+	uint16_t nb_deq;
+	uint64_t tsc_start, tsc_end;
+	int ret = TEST_FAILED;
+
+	memset(sessions, 0, sizeof(sessions));
+	memset(mbufs, 0, sizeof(mbufs));
+
+	for (i = 0; i < SESSION_CHURN_BURST_SIZE; i++) {
+		mbufs[i] = test_perf_create_pktmbuf(ts_params->mbuf_mp,
+				SESSION_CHURN_BUF_SIZE);
+		if (mbufs[i] == NULL)
+			goto out;
+	}
+
+	if (mode == SESSION_CHURN_PERSISTENT) {
+		for (i = 0; i < nb_keys; i++) {
+			test_perf_session_churn_xforms(&cipher_xform,
+					&auth_xform, cipher_keys[i],
+					auth_keys[i], i);
+			sessions[i] = rte_cryptodev_sym_session_create(dev_id,
+					&cipher_xform);
+			if (sessions[i] == NULL)
+				goto out;
+		}
+	} else {
+		/* session-less xforms point at the keys, fill them once */
+		for (i = 0; i < nb_keys; i++)
+			test_perf_session_churn_xforms(&cipher_xform,
+					&auth_xform, cipher_keys[i],
+					auth_keys[i], i);
+	}
+
+	tsc_start = rte_rdtsc_precise();
+
+	while (processed < total_operations) {
+		if (rte_crypto_op_bulk_alloc(ts_params->op_mpool,
+				RTE_CRYPTO_OP_TYPE_SYMMETRIC, ops,
+				SESSION_CHURN_BURST_SIZE) !=
+				SESSION_CHURN_BURST_SIZE)
+			goto out;
+
+		for (i = 0; i < SESSION_CHURN_BURST_SIZE; i++) {
+			key_id = (key_id + 1) % nb_keys;
+			op_sess[i] = NULL;
+
+			if (mode == SESSION_CHURN_PERSISTENT)
+				op_sess[i] = sessions[key_id];
+			else if (mode == SESSION_CHURN_CREATE_FREE) {
+				test_perf_session_churn_xforms(&cipher_xform,
+						&auth_xform,
+						cipher_keys[key_id],
+						auth_keys[key_id], key_id);
+				op_sess[i] = rte_cryptodev_sym_session_create(
+						dev_id, &cipher_xform);
+				if (op_sess[i] == NULL)
+					goto out;
+			}
+
+			test_perf_set_crypto_op_aes(ops[i], mbufs[i],
+					op_sess[i], SESSION_CHURN_BUF_SIZE,
+					DIGEST_BYTE_LENGTH_SHA1);
+
+			/* turn the op session-less, the xforms replacing the
+			 * NULL session attached above
+			 */
+			if (mode == SESSION_CHURN_SESSIONLESS) {
+				xform = rte_crypto_op_sym_xforms_alloc(ops[i],
+						2);
+				ops[i]->sym->sess_type =
+						RTE_CRYPTO_SYM_OP_SESSIONLESS;
+				test_perf_session_churn_xforms(xform,
+						xform->next,
+						cipher_keys[key_id],
+						auth_keys[key_id], key_id);
+			}
+		}
+
+		if (rte_cryptodev_enqueue_burst(dev_id, queue_id, ops,
+				SESSION_CHURN_BURST_SIZE) !=
+				SESSION_CHURN_BURST_SIZE)
+			goto out;
+
+		for (nb_deq = 0; nb_deq < SESSION_CHURN_BURST_SIZE; )
+			nb_deq += rte_cryptodev_dequeue_burst(dev_id, queue_id,
+					ops + nb_deq,
+					SESSION_CHURN_BURST_SIZE - nb_deq);
+
+		for (i = 0; i < SESSION_CHURN_BURST_SIZE; i++) {
+			if (ops[i]->status != RTE_CRYPTO_OP_STATUS_SUCCESS)
+				goto out;
+			rte_crypto_op_free(ops[i]);
+			if (mode == SESSION_CHURN_CREATE_FREE)
+				rte_cryptodev_sym_session_free(dev_id,
+						op_sess[i]);
+		}
+		processed += SESSION_CHURN_BURST_SIZE;
+	}
+
+	tsc_end = rte_rdtsc_precise();
+	*cycles_per_op = (double)(tsc_end - tsc_start) / processed;
+	ret = TEST_SUCCESS;
+
+out:
+	for (i = 0; i < nb_keys; i++)
+		if (sessions[i] != NULL)
+			rte_cryptodev_sym_session_free(dev_id, sessions[i]);
+	for (i = 0; i < SESSION_CHURN_BURST_SIZE; i++)
+		rte_pktmbuf_free(mbufs[i]);
+
+	return ret;
+}
+
+static int
+test_perf_session_churn_vary_nb_keys(void)
+{
+	unsigned int total_operations = 100000;
+	unsigned int nb_keys[] = { 1, 16, 64, 256 };
+	enum session_churn_mode modes[] = {
+		SESSION_CHURN_PERSISTENT,
+		SESSION_CHURN_CREATE_FREE,
+		SESSION_CHURN_SESSIONLESS
+	};
+	double cycles;
+	unsigned int i, j;
+
+	printf("\n\nStart %s.", __func__);
+	printf("\nThis Test measures the average IA cycle cost of %u B "
+			"AES128-CBC/HMAC-SHA1 operations, in bursts of %u, "
+			"using a varying number of keys.\n",
+			SESSION_CHURN_BUF_SIZE, SESSION_CHURN_BURST_SIZE);
+	printf("\nSession mode\t\tKeys\tCycles/op\n");
+
+	for (i = 0; i < RTE_DIM(modes); i++) {
+		for (j = 0; j < RTE_DIM(nb_keys); j++) {
+			TEST_ASSERT_SUCCESS(test_perf_session_churn(
+					testsuite_params.dev_id, 0, modes[i],
+					nb_keys[j], total_operations, &cycles),
+					"%s with %u keys failed",
+					session_churn_mode_name(modes[i]),
+					nb_keys[j]);
+			printf("%-20s\t%u\t%10.2f\n",
+					session_churn_mode_name(modes[i]),
+					nb_keys[j], cycles);
+		}
+	}
+
+	return 0;
+}
+
 #if 1
+#ifdef RTE_LIBRTE_PMD_CRYPTO_SCHEDULER
+static const char *scheduler_mode_name(enum rte_cryptodev_scheduler_mode mode)
+{
+	switch (mode) {
+	case RTE_CRYPTODEV_SCHEDULER_MODE_ROUND_ROBIN: return "round-robin";
+	case RTE_CRYPTODEV_SCHEDULER_MODE_FILL_LEVEL: return "fill-level";
+	case RTE_CRYPTODEV_SCHEDULER_MODE_PKT_SIZE: return "packet-size";
+	default: return "";
+	}
+}
+
+static struct rte_cryptodev_sym_session *
+test_perf_create_scheduler_session(uint8_t dev_id,
+		struct perf_test_params *pparams)
+{
+	struct rte_crypto_sym_xform cipher_xform = { 0 };
+	struct rte_crypto_sym_xform auth_xform = { 0 };
+
+	if (pparams->cipher_algo != RTE_CRYPTO_CIPHER_NULL)
+		return test_perf_create_openssl_session(dev_id, pparams->chain,
+				pparams->cipher_algo,
+				pparams->cipher_key_length,
+				pparams->auth_algo);
+
+	cipher_xform.type = RTE_CRYPTO_SYM_XFORM_CIPHER;
+	cipher_xform.cipher.algo = RTE_CRYPTO_CIPHER_NULL;
+	cipher_xform.cipher.op = RTE_CRYPTO_CIPHER_OP_ENCRYPT;
+	cipher_xform.next = &auth_xform;
+
+	auth_xform.type = RTE_CRYPTO_SYM_XFORM_AUTH;
+	auth_xform.auth.algo = RTE_CRYPTO_AUTH_NULL;
+	auth_xform.auth.op = RTE_CRYPTO_AUTH_OP_GENERATE;
+	auth_xform.next = NULL;
+
+	return rte_cryptodev_sym_session_create(dev_id, &cipher_xform);
+}
+
+/*
+ * Send packets alternating between a short and a long size through the
+ * scheduler, check they come back in order and report how they were spread
+ * across the slaves.
+ */
+static int
+test_perf_scheduler_optimise_cyclecount(struct perf_test_params *pparams,
+		enum rte_cryptodev_scheduler_mode mode)
+{
+	uint32_t num_to_submit = pparams->total_operations;
+	struct rte_crypto_op *c_ops[num_to_submit];
+	struct rte_crypto_op *proc_ops[num_to_submit];
+	uint64_t failed_polls, retries, start_cycles, end_cycles, total_cycles = 0;
+	uint32_t burst_sent = 0, burst_received = 0;
+	uint32_t i, j, burst_size, num_sent, num_ops_received, buf_size;
+	struct crypto_perf_testsuite_params *ts_params = &testsuite_params;
+	uint8_t slaves[RTE_CRYPTODEV_SCHEDULER_MAX_NB_SLAVES];
+	struct rte_cryptodev_stats stats;
+	struct rte_cryptodev_sym_session *sess;
+	unsigned digest_length = get_auth_digest_length(pparams->auth_algo);
+	int k, nb_slaves;
+
+	rte_cryptodev_stop(ts_params->dev_id);
+	TEST_ASSERT_SUCCESS(rte_cryptodev_scheduler_mode_set(ts_params->dev_id,
+			mode), "Failed to set scheduling mode");
+	TEST_ASSERT_SUCCESS(rte_cryptodev_start(ts_params->dev_id),
+			"Failed to start cryptodev %u", ts_params->dev_id);
+
+	nb_slaves = rte_cryptodev_scheduler_slaves_get(ts_params->dev_id,
+			slaves);
+	TEST_ASSERT(nb_slaves > 0, "No slave attached");
+
+	/* Create Crypto session*/
+	sess = test_perf_create_scheduler_session(ts_params->dev_id, pparams);
+	TEST_ASSERT_NOT_NULL(sess, "Session creation failed");
+
+	/* Generate Crypto op data structure(s)*/
+	for (i = 0; i < num_to_submit ; i++) {
+		buf_size = (i & 1) ? pparams->buf_size : 64;
+
+		struct rte_mbuf *m = test_perf_create_pktmbuf(
+						ts_params->mbuf_mp, buf_size);
+		TEST_ASSERT_NOT_NULL(m, "Failed to allocate tx_buf");
+
+		struct rte_crypto_op *op =
+				rte_crypto_op_alloc(ts_params->op_mpool,
+						RTE_CRYPTO_OP_TYPE_SYMMETRIC);
+		TEST_ASSERT_NOT_NULL(op, "Failed to allocate op");
+
+		op = test_perf_set_crypto_op_aes(op, m, sess, buf_size,
+				digest_length);
+		TEST_ASSERT_NOT_NULL(op, "Failed to attach op to session");
+
+		c_ops[i] = op;
+	}
+
+	printf("\nOn %s dev%u qp%u, %s mode, %u %s slaves, cipher algo:%s, "
+			"auth_algo:%s, Packet Size 64/%u bytes",
+			pmd_name(gbl_cryptodev_perftest_devtype),
+			ts_params->dev_id, 0, scheduler_mode_name(mode),
+			nb_slaves, pmd_name(gbl_cryptodev_scheduler_slave_type),
+			cipher_algo_name(pparams->cipher_algo),
+			auth_algo_name(pparams->auth_algo),
+			pparams->buf_size);
+	printf("\nOps Tx\tOps Rx\tOps/burst  ");
+	printf("Retries  EmptyPolls\tIACycles/CyOp\tOps per slave");
+
+	for (burst_size = 8; burst_size <= 128; burst_size *= 4) {
+		num_sent = 0;
+		num_ops_received = 0;
+		retries = 0;
+		failed_polls = 0;
+		total_cycles = 0;
+
+		for (k = 0; k < nb_slaves; k++)
+			rte_cryptodev_stats_reset(slaves[k]);
+
+		while (num_ops_received < num_to_submit) {
+			start_cycles = rte_rdtsc_precise();
+			burst_sent = 0;
+			if (num_sent < num_to_submit)
+				burst_sent = rte_cryptodev_enqueue_burst(
+						ts_params->dev_id, 0,
+						&c_ops[num_sent],
+						RTE_MIN(num_to_submit - num_sent,
+							burst_size));
+			burst_received = rte_cryptodev_dequeue_burst(
+					ts_params->dev_id, 0,
+					&proc_ops[num_ops_received],
+					burst_size);
+			end_cycles = rte_rdtsc_precise();
+			total_cycles += end_cycles - start_cycles;
+
+			if (num_sent < num_to_submit && burst_sent == 0)
+				retries++;
+			if (burst_received == 0)
+				failed_polls++;
+
+			for (j = num_ops_received;
+					j < num_ops_received + burst_received;
+					j++) {
+				TEST_ASSERT_EQUAL(proc_ops[j], c_ops[j],
+						"Op %u dequeued out of order", j);
+				TEST_ASSERT_EQUAL(proc_ops[j]->status,
+						RTE_CRYPTO_OP_STATUS_SUCCESS,
+						"Op %u failed", j);
+				TEST_ASSERT_EQUAL(proc_ops[j]->sym->session,
+						sess,
+						"Op %u session not restored", j);
+			}
+
+			num_sent += burst_sent;
+			num_ops_received += burst_received;
+		}
+
+		printf("\n%u\t%u\t%u", num_sent, num_ops_received, burst_size);
+		printf("\t\t%"PRIu64, retries);
+		printf("\t%"PRIu64, failed_polls);
+		printf("\t\t%"PRIu64"\t", total_cycles/num_ops_received);
+		for (k = 0; k < nb_slaves; k++) {
+			rte_cryptodev_stats_get(slaves[k], &stats);
+			printf("\t%"PRIu64, stats.enqueued_count);
+		}
+	}
+	printf("\n");
+
+	for (i = 0; i < num_to_submit ; i++) {
+		rte_pktmbuf_free(c_ops[i]->sym->m_src);
+		rte_crypto_op_free(c_ops[i]);
+	}
+
+	rte_cryptodev_sym_session_free(ts_params->dev_id, sess);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_perf_scheduler_vary_mode(void)
+{
+	enum rte_cryptodev_scheduler_mode modes[] = {
+		RTE_CRYPTODEV_SCHEDULER_MODE_ROUND_ROBIN,
+		RTE_CRYPTODEV_SCHEDULER_MODE_FILL_LEVEL,
+		RTE_CRYPTODEV_SCHEDULER_MODE_PKT_SIZE,
+	};
+	struct perf_test_params params = {
+		.total_operations = 4096,
+		.buf_size = 1024,
+		.chain = CIPHER_HASH,
+		.cipher_algo = RTE_CRYPTO_CIPHER_NULL,
+		.auth_algo = RTE_CRYPTO_AUTH_NULL,
+	};
+	unsigned i;
+
+	if (gbl_cryptodev_scheduler_slave_type == RTE_CRYPTODEV_OPENSSL_PMD) {
+		params.cipher_algo = RTE_CRYPTO_CIPHER_AES_CBC;
+		params.cipher_key_length = 16;
+		params.auth_algo = RTE_CRYPTO_AUTH_SHA1_HMAC;
+	}
+
+	printf("\n\nStart %s.", __func__);
+	printf("\nThis Test measures the average IA cycle cost of the "
+			"scheduler for each scheduling mode, packets alternating "
+			"between a short and a long size.");
+
+	for (i = 0; i < RTE_DIM(modes); i++)
+		TEST_ASSERT_SUCCESS(test_perf_scheduler_optimise_cyclecount(
+				&params, modes[i]),
+				"Scheduler %s mode test failed",
+				scheduler_mode_name(modes[i]));
+
+	return 0;
+}
+#endif
+
 static struct unit_test_suite cryptodev_testsuite  = {
 	.suite_name = "Crypto Device Unit Test Suite",
 	.setup = testsuite_setup,
@@ -3528,12 +4305,46 @@ static struct unit_test_suite cryptodev_openssl_testsuite  = {
 	.unit_test_cases = {
 		TEST_CASE_ST(ut_setup, ut_teardown,
 				test_perf_openssl_vary_pkt_size),
+		TEST_CASE_ST(ut_setup, ut_teardown,
+				test_perf_openssl_worker_vary_pkt_size),
 		TEST_CASE_ST(ut_setup, ut_teardown,
 				test_perf_openssl_vary_burst_size),
+		TEST_CASE_ST(ut_setup, ut_teardown,
+				test_perf_aes_sha256_gcm_vary_pkt_size),
+		TEST_CASE_ST(ut_setup, ut_teardown,
+				test_perf_session_churn_vary_nb_keys),
 		TEST_CASES_END() /**< NULL terminate unit test array */
 	}
 };
 
+static struct unit_test_suite cryptodev_armce_testsuite  = {
+	.suite_name = "Crypto Device ARMCE Unit Test Suite",
+	.setup = testsuite_setup,
+	.teardown = testsuite_teardown,
+	.unit_test_cases = {
+		TEST_CASE_ST(ut_setup, ut_teardown,
+				test_perf_aes_cbc_encrypt_digest_vary_pkt_size),
+		TEST_CASE_ST(ut_setup, ut_teardown,
+				test_perf_aes_cbc_vary_burst_size),
+		TEST_CASE_ST(ut_setup, ut_teardown,
+				test_perf_aes_sha256_gcm_vary_pkt_size),
+		TEST_CASES_END() /**< NULL terminate unit test array */
+	}
+};
+
+#ifdef RTE_LIBRTE_PMD_CRYPTO_SCHEDULER
+static struct unit_test_suite cryptodev_scheduler_testsuite  = {
+	.suite_name = "Crypto Device Scheduler Unit Test Suite",
+	.setup = testsuite_setup,
+	.teardown = testsuite_teardown,
+	.unit_test_cases = {
+		TEST_CASE_ST(ut_setup, ut_teardown,
+				test_perf_scheduler_vary_mode),
+		TEST_CASES_END() /**< NULL terminate unit test array */
+	}
+};
+#endif
+
 static int
 perftest_aesni_mb_cryptodev(void /*argv __rte_unused, int argc __rte_unused*/)
 {
@@ -3587,7 +4398,7 @@ perftest_armce_cryptodev(void /*argv __rte_unused, int argc __rte_unused*/)
 {
 	gbl_cryptodev_perftest_devtype = RTE_CRYPTODEV_ARMCE_PMD;
 
-	return unit_test_suite_runner(&cryptodev_testsuite);
+	return unit_test_suite_runner(&cryptodev_armce_testsuite);
 }
 
 static int
@@ -3598,6 +4409,26 @@ perftest_openssl_cryptodev(void /*argv __rte_unused, int argc __rte_unused*/)
 	return unit_test_suite_runner(&cryptodev_openssl_testsuite);
 }
 
+#ifdef RTE_LIBRTE_PMD_CRYPTO_SCHEDULER
+static int
+perftest_scheduler_null_cryptodev(void)
+{
+	gbl_cryptodev_perftest_devtype = RTE_CRYPTODEV_SCHEDULER_PMD;
+	gbl_cryptodev_scheduler_slave_type = RTE_CRYPTODEV_NULL_PMD;
+
+	return unit_test_suite_runner(&cryptodev_scheduler_testsuite);
+}
+
+static int
+perftest_scheduler_openssl_cryptodev(void)
+{
+	gbl_cryptodev_perftest_devtype = RTE_CRYPTODEV_SCHEDULER_PMD;
+	gbl_cryptodev_scheduler_slave_type = RTE_CRYPTODEV_OPENSSL_PMD;
+
+	return unit_test_suite_runner(&cryptodev_scheduler_testsuite);
+}
+#endif
+
 REGISTER_TEST_COMMAND(cryptodev_aesni_mb_perftest, perftest_aesni_mb_cryptodev);
 REGISTER_TEST_COMMAND(cryptodev_qat_perftest, perftest_qat_cryptodev);
 REGISTER_TEST_COMMAND(cryptodev_sw_snow3g_perftest, perftest_sw_snow3g_cryptodev);
@@ -3606,3 +4437,9 @@ REGISTER_TEST_COMMAND(cryptodev_armce_perftest, perftest_armce_cryptodev);
 REGISTER_TEST_COMMAND(cryptodev_dpaa2_sec_perftest, perftest_dpaa2_sec_cryptodev);
 REGISTER_TEST_COMMAND(cryptodev_dpaa_sec_perftest, perftest_dpaa_sec_cryptodev);
 REGISTER_TEST_COMMAND(cryptodev_openssl_perftest, perftest_openssl_cryptodev);
+#ifdef RTE_LIBRTE_PMD_CRYPTO_SCHEDULER
+REGISTER_TEST_COMMAND(cryptodev_scheduler_null_perftest,
+		perftest_scheduler_null_cryptodev);
+REGISTER_TEST_COMMAND(cryptodev_scheduler_openssl_perftest,
+		perftest_scheduler_openssl_cryptodev);
+#endif
@@ -0,0 +1,392 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2017 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_byteorder.h>
+#include <rte_mbuf.h>
+
+#include "test.h"
+
+/* Kernel types of the annotation header, not defined out of the driver */
+typedef uint16_t __le16;
+typedef uint32_t __le32;
+#ifndef __packed
+#define __packed __attribute__((__packed__))
+#endif
+
+#include <dpaa_ptype.h>
+#include <dpaa2_hw_dpni_ptype.h>
+
+/* Both PMDs define the table, the tests build their own */
+static struct dpaa_ptype_tbl dpaa_tbl;
+static struct dpaa2_ptype_tbl dpaa2_tbl;
+
+#define L4R(type)	((type) << 5)
+
+/* A parsed frame, the offsets as set by the parser */
+struct ptype_case {
+	const char *name;
+	uint16_t l2r;		/**< DPAA L2R */
+	uint16_t l3r;		/**< DPAA L3R */
+	uint8_t l4r;		/**< DPAA L4R */
+	uint64_t word3;		/**< DPAA2 L2 flags */
+	uint64_t word4;		/**< DPAA2 L3/L4 flags */
+	uint64_t word8;		/**< DPAA2 checksum errors */
+	uint8_t ip_off[2];
+	uint8_t gre_off;
+	uint8_t l4_off;
+	uint16_t udp_dport;
+	/* Expected */
+	uint32_t packet_type;
+	uint64_t ol_flags;
+	uint8_t l2_len;
+	uint8_t l3_len;
+};
+
+static uint8_t frame[256];
+static struct rte_mbuf mbuf;
+
+static void
+ptype_case_frame(const struct ptype_case *c)
+{
+	memset(frame, 0, sizeof(frame));
+	frame[c->l4_off + 2] = c->udp_dport >> 8;
+	frame[c->l4_off + 3] = c->udp_dport & 0xff;
+	memset(&mbuf, 0, sizeof(mbuf));
+}
+
+static int
+ptype_case_check(const struct ptype_case *c, const char *pmd)
+{
+	TEST_ASSERT_EQUAL(mbuf.packet_type, c->packet_type,
+			  "%s %s: packet type %#x, expected %#x", pmd, c->name,
+			  mbuf.packet_type, c->packet_type);
+	TEST_ASSERT_EQUAL(mbuf.ol_flags, c->ol_flags,
+			  "%s %s: flags %#"PRIx64", expected %#"PRIx64,
+			  pmd, c->name, mbuf.ol_flags, c->ol_flags);
+	TEST_ASSERT_EQUAL(mbuf.l2_len, c->l2_len, "%s %s: L2 length %u",
+			  pmd, c->name, (unsigned int)mbuf.l2_len);
+	TEST_ASSERT_EQUAL(mbuf.l3_len, c->l3_len, "%s %s: L3 length %u",
+			  pmd, c->name, (unsigned int)mbuf.l3_len);
+	return TEST_SUCCESS;
+}
+
+static const struct ptype_case dpaa_cases[] = {
+	{ .name = "IPv4 TCP",
+	  .l2r = DPAA_PRS_L2R_ETH, .l3r = DPAA_PRS_L3R_IPV4,
+	  .l4r = L4R(DPAA_PRS_L4R_TCP), .ip_off = { 14 }, .l4_off = 34,
+	  .packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4 |
+			 RTE_PTYPE_L4_TCP,
+	  .l2_len = 14, .l3_len = 20 },
+	{ .name = "VLAN IPv6 UDP",
+	  .l2r = DPAA_PRS_L2R_ETH | DPAA_PRS_L2R_VLAN,
+	  .l3r = DPAA_PRS_L3R_IPV6, .l4r = L4R(DPAA_PRS_L4R_UDP),
+	  .ip_off = { 18 }, .l4_off = 58, .udp_dport = 53,
+	  .packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV6 |
+			 RTE_PTYPE_L4_UDP,
+	  .ol_flags = PKT_RX_VLAN_PKT, .l2_len = 18, .l3_len = 40 },
+	{ .name = "QinQ IPv4 options SCTP",
+	  .l2r = DPAA_PRS_L2R_ETH | DPAA_PRS_L2R_VLAN | DPAA_PRS_L2R_QINQ,
+	  .l3r = DPAA_PRS_L3R_IPV4 | DPAA_PRS_L3R_OPT,
+	  .l4r = L4R(DPAA_PRS_L4R_SCTP), .ip_off = { 22 }, .l4_off = 46,
+	  .packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4_EXT |
+			 RTE_PTYPE_L4_SCTP,
+	  .ol_flags = PKT_RX_VLAN_PKT, .l2_len = 22, .l3_len = 24 },
+	{ .name = "IPv4 first fragment",
+	  .l2r = DPAA_PRS_L2R_ETH, .l3r = DPAA_PRS_L3R_IPV4 | DPAA_PRS_L3R_FRAG,
+	  .l4r = L4R(DPAA_PRS_L4R_UDP), .ip_off = { 14 }, .l4_off = 34,
+	  .udp_dport = DPAA_VXLAN_UDP_PORT,
+	  .packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4 |
+			 RTE_PTYPE_L4_FRAG,
+	  .l2_len = 14, .l3_len = 20 },
+	{ .name = "IPv6 last fragment",
+	  .l2r = DPAA_PRS_L2R_ETH,
+	  .l3r = DPAA_PRS_L3R_IPV6 | DPAA_PRS_L3R_LAST_FRAG,
+	  .ip_off = { 14 }, .l4_off = 62,
+	  .packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV6 |
+			 RTE_PTYPE_L4_FRAG,
+	  .l2_len = 14, .l3_len = 48 },
+	{ .name = "IPv4 ICMP",
+	  .l2r = DPAA_PRS_L2R_ETH, .l3r = DPAA_PRS_L3R_IPV4,
+	  .ip_off = { 14 }, .l4_off = 34,
+	  .packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4 |
+			 RTE_PTYPE_L4_NONFRAG,
+	  .l2_len = 14, .l3_len = 20 },
+	{ .name = "Checksum errors",
+	  .l2r = DPAA_PRS_L2R_ETH, .l3r = DPAA_PRS_L3R_IPV4 | DPAA_PRS_L3R_ERR,
+	  .l4r = L4R(DPAA_PRS_L4R_TCP) | DPAA_PRS_L4R_ERR,
+	  .ip_off = { 14 }, .l4_off = 34,
+	  .packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4 |
+			 RTE_PTYPE_L4_TCP,
+	  .ol_flags = PKT_RX_IP_CKSUM_BAD | PKT_RX_L4_CKSUM_BAD,
+	  .l2_len = 14, .l3_len = 20 },
+	{ .name = "L4 error without L4",
+	  .l2r = DPAA_PRS_L2R_ETH, .l3r = DPAA_PRS_L3R_IPV4,
+	  .l4r = DPAA_PRS_L4R_ERR, .ip_off = { 14 }, .l4_off = 34,
+	  .packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4 |
+			 RTE_PTYPE_L4_NONFRAG,
+	  .l2_len = 14, .l3_len = 20 },
+	{ .name = "GRE IPv4 UDP",
+	  .l2r = DPAA_PRS_L2R_ETH,
+	  .l3r = DPAA_PRS_L3R_IPV4 | DPAA_PRS_L3R_GRE |
+		 DPAA_PRS_L3R_LAST_IPV4,
+	  .l4r = L4R(DPAA_PRS_L4R_UDP), .ip_off = { 14, 38 }, .gre_off = 34,
+	  .l4_off = 58, .udp_dport = DPAA_VXLAN_UDP_PORT,
+	  .packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4 |
+			 RTE_PTYPE_TUNNEL_GRE | RTE_PTYPE_INNER_L3_IPV4 |
+			 RTE_PTYPE_INNER_L4_UDP,
+	  .l2_len = 14, .l3_len = 20 },
+	{ .name = "IPv4 in IPv6 TCP",
+	  .l2r = DPAA_PRS_L2R_ETH,
+	  .l3r = DPAA_PRS_L3R_IPV6 | DPAA_PRS_L3R_LAST_IPV4,
+	  .l4r = L4R(DPAA_PRS_L4R_TCP), .ip_off = { 14, 54 }, .l4_off = 74,
+	  .packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV6 |
+			 RTE_PTYPE_TUNNEL_IP | RTE_PTYPE_INNER_L3_IPV4 |
+			 RTE_PTYPE_INNER_L4_TCP,
+	  .l2_len = 14, .l3_len = 40 },
+	{ .name = "VXLAN",
+	  .l2r = DPAA_PRS_L2R_ETH, .l3r = DPAA_PRS_L3R_IPV4,
+	  .l4r = L4R(DPAA_PRS_L4R_UDP), .ip_off = { 14 }, .l4_off = 34,
+	  .udp_dport = DPAA_VXLAN_UDP_PORT,
+	  .packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4 |
+			 RTE_PTYPE_L4_UDP | RTE_PTYPE_TUNNEL_VXLAN |
+			 RTE_PTYPE_INNER_L2_ETHER,
+	  .l2_len = 14, .l3_len = 20 },
+	{ .name = "Ethernet only",
+	  .l2r = DPAA_PRS_L2R_ETH,
+	  .packet_type = RTE_PTYPE_L2_ETHER },
+	{ .name = "Not parsed",
+	  .l3r = DPAA_PRS_L3R_IPV4, .l4r = L4R(DPAA_PRS_L4R_TCP),
+	  .packet_type = RTE_PTYPE_UNKNOWN },
+};
+
+static int
+test_dpaa_ptype_dpaa(void)
+{
+	struct dpaa_eth_parse_results_t prs;
+	const struct ptype_case *c;
+	unsigned int i;
+
+	dpaa_ptype_tbl_init(&dpaa_tbl);
+	for (i = 0; i < RTE_DIM(dpaa_cases); i++) {
+		c = &dpaa_cases[i];
+		ptype_case_frame(c);
+		memset(&prs, 0, sizeof(prs));
+		prs.l2r = rte_cpu_to_be_16(c->l2r);
+		prs.l3r = rte_cpu_to_be_16(c->l3r);
+		prs.l4r = c->l4r;
+		prs.ip_off[0] = c->ip_off[0];
+		prs.ip_off[1] = c->ip_off[1];
+		prs.gre_off = c->gre_off;
+		prs.l4_off = c->l4_off;
+
+		dpaa_ptype_lookup(&dpaa_tbl, &prs, frame, &mbuf);
+		if (ptype_case_check(c, "DPAA") != TEST_SUCCESS)
+			return TEST_FAILED;
+	}
+	return TEST_SUCCESS;
+}
+
+static const struct ptype_case dpaa2_cases[] = {
+	{ .name = "IPv4 TCP",
+	  .word3 = L2_ETH_MAC_PRESENT,
+	  .word4 = L3_IPV4_1_PRESENT | L3_PROTO_TCP_PRESENT,
+	  .ip_off = { 14 }, .l4_off = 34,
+	  .packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4 |
+			 RTE_PTYPE_L4_TCP,
+	  .l2_len = 14, .l3_len = 20 },
+	{ .name = "VLAN IPv6 UDP",
+	  .word3 = L2_ETH_MAC_PRESENT | L2_VLAN_1_PRESENT,
+	  .word4 = L3_IPV6_1_PRESENT | L3_PROTO_UDP_PRESENT,
+	  .ip_off = { 18 }, .l4_off = 58, .udp_dport = 53,
+	  .packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV6 |
+			 RTE_PTYPE_L4_UDP,
+	  .ol_flags = PKT_RX_VLAN_PKT, .l2_len = 18, .l3_len = 40 },
+	{ .name = "QinQ IPv4 options SCTP",
+	  .word3 = L2_ETH_MAC_PRESENT | L2_VLAN_1_PRESENT |
+		   L2_VLAN_N_PRESENT,
+	  .word4 = L3_IPV4_1_PRESENT | L3_IP_1_OPT_PRESENT |
+		   L3_PROTO_SCTP_PRESENT,
+	  .ip_off = { 22 }, .l4_off = 46,
+	  .packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4_EXT |
+			 RTE_PTYPE_L4_SCTP,
+	  .ol_flags = PKT_RX_VLAN_PKT, .l2_len = 22, .l3_len = 24 },
+	{ .name = "IPv4 first fragment",
+	  .word3 = L2_ETH_MAC_PRESENT,
+	  .word4 = L3_IPV4_1_PRESENT | L3_IP_1_FIRST_FRAGMENT |
+		   L3_IP_1_MORE_FRAGMENT | L3_PROTO_UDP_PRESENT,
+	  .ip_off = { 14 }, .l4_off = 34, .udp_dport = DPAA2_VXLAN_UDP_PORT,
+	  .packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4 |
+			 RTE_PTYPE_L4_FRAG,
+	  .l2_len = 14, .l3_len = 20 },
+	{ .name = "IPv4 ICMP",
+	  .word3 = L2_ETH_MAC_PRESENT,
+	  .word4 = L3_IPV4_1_PRESENT | L3_PROTO_ICMP_PRESENT,
+	  .ip_off = { 14 }, .l4_off = 34,
+	  .packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4 |
+			 RTE_PTYPE_L4_ICMP,
+	  .l2_len = 14, .l3_len = 20 },
+	{ .name = "Checksum errors",
+	  .word3 = L2_ETH_MAC_PRESENT,
+	  .word4 = L3_IPV4_1_PRESENT | L3_PROTO_TCP_PRESENT,
+	  .word8 = DPAA2_ETH_FAS_L3CE | DPAA2_ETH_FAS_L4CE,
+	  .ip_off = { 14 }, .l4_off = 34,
+	  .packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4 |
+			 RTE_PTYPE_L4_TCP,
+	  .ol_flags = PKT_RX_IP_CKSUM_BAD | PKT_RX_L4_CKSUM_BAD,
+	  .l2_len = 14, .l3_len = 20 },
+	{ .name = "GRE IPv4 UDP",
+	  .word3 = L2_ETH_MAC_PRESENT,
+	  .word4 = L3_IPV4_1_PRESENT | L3_PROTO_GRE_PRESENT |
+		   L3_IPV4_N_PRESENT | L3_PROTO_UDP_PRESENT,
+	  .ip_off = { 14, 38 }, .gre_off = 34, .l4_off = 58,
+	  .udp_dport = DPAA2_VXLAN_UDP_PORT,
+	  .packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4 |
+			 RTE_PTYPE_TUNNEL_GRE | RTE_PTYPE_INNER_L3_IPV4 |
+			 RTE_PTYPE_INNER_L4_UDP,
+	  .l2_len = 14, .l3_len = 20 },
+	{ .name = "IPv4 in IPv6 TCP",
+	  .word3 = L2_ETH_MAC_PRESENT,
+	  .word4 = L3_IPV6_1_PRESENT | L3_IPV4_N_PRESENT |
+		   L3_PROTO_TCP_PRESENT,
+	  .ip_off = { 14, 54 }, .l4_off = 74,
+	  .packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV6 |
+			 RTE_PTYPE_TUNNEL_IP | RTE_PTYPE_INNER_L3_IPV4 |
+			 RTE_PTYPE_INNER_L4_TCP,
+	  .l2_len = 14, .l3_len = 40 },
+	{ .name = "VXLAN",
+	  .word3 = L2_ETH_MAC_PRESENT,
+	  .word4 = L3_IPV4_1_PRESENT | L3_PROTO_UDP_PRESENT,
+	  .ip_off = { 14 }, .l4_off = 34, .udp_dport = DPAA2_VXLAN_UDP_PORT,
+	  .packet_type = RTE_PTYPE_L2_ETHER | RTE_PTYPE_L3_IPV4 |
+			 RTE_PTYPE_L4_UDP | RTE_PTYPE_TUNNEL_VXLAN |
+			 RTE_PTYPE_INNER_L2_ETHER,
+	  .l2_len = 14, .l3_len = 20 },
+	{ .name = "ARP",
+	  .word3 = L2_ETH_MAC_PRESENT | L2_ARP_PRESENT,
+	  .packet_type = RTE_PTYPE_L2_ETHER_ARP },
+	{ .name = "Not parsed",
+	  .word4 = L3_IPV4_1_PRESENT | L3_PROTO_TCP_PRESENT,
+	  .packet_type = RTE_PTYPE_UNKNOWN },
+};
+
+static int
+test_dpaa_ptype_dpaa2(void)
+{
+	struct dpaa2_annot_hdr annot;
+	const struct ptype_case *c;
+	unsigned int i;
+
+	dpaa2_ptype_tbl_init(&dpaa2_tbl);
+	for (i = 0; i < RTE_DIM(dpaa2_cases); i++) {
+		c = &dpaa2_cases[i];
+		ptype_case_frame(c);
+		memset(&annot, 0, sizeof(annot));
+		annot.word3 = c->word3;
+		annot.word4 = c->word4;
+		annot.word6 = ((uint64_t)c->ip_off[0] << 32) |
+			      ((uint64_t)c->ip_off[1] << 24) |
+			      ((uint64_t)c->gre_off << 16) |
+			      ((uint64_t)c->l4_off << 8);
+		annot.word8 = c->word8;
+
+		dpaa2_ptype_lookup(&dpaa2_tbl, &annot, frame, &mbuf);
+		if (ptype_case_check(c, "DPAA2") != TEST_SUCCESS)
+			return TEST_FAILED;
+	}
+	return TEST_SUCCESS;
+}
+
+/* Every entry the parsers can select must stay consistent */
+static int
+test_dpaa_ptype_tables(void)
+{
+	const struct dpaa_ptype_l3 *l3;
+	const struct dpaa2_ptype_l3 *l3_2;
+	unsigned int i;
+
+	dpaa_ptype_tbl_init(&dpaa_tbl);
+	for (i = 0; i < DPAA_PTYPE_L3_NB; i++) {
+		l3 = &dpaa_tbl.l3[i];
+		TEST_ASSERT((l3->l4_row == DPAA_PTYPE_L4_NONE) ==
+			    (l3->l3_end == 0),
+			    "DPAA entry %#x: L4 row %u, L3 end %u", i,
+			    l3->l4_row, l3->l3_end);
+		TEST_ASSERT((l3->l4_row == DPAA_PTYPE_L4_INNER) ==
+			    !!(l3->packet_type & RTE_PTYPE_INNER_L3_MASK),
+			    "DPAA entry %#x: inner L4 row without inner L3",
+			    i);
+	}
+	for (i = 0; i < DPAA_PTYPE_L4_NB; i++)
+		TEST_ASSERT(dpaa_tbl.l4[DPAA_PTYPE_L4_NONE][i].packet_type == 0 &&
+			    dpaa_tbl.l4[DPAA_PTYPE_L4_NONE][i].ol_flags == 0,
+			    "DPAA L4 entry %#x set without IP", i);
+
+	dpaa2_ptype_tbl_init(&dpaa2_tbl);
+	for (i = 0; i < DPAA2_PTYPE_L3_NB; i++) {
+		l3_2 = &dpaa2_tbl.l3[i];
+		TEST_ASSERT((l3_2->l4_row == DPAA2_PTYPE_L4_NONE) ==
+			    (l3_2->l3_end == 0),
+			    "DPAA2 entry %#x: L4 row %u, L3 end %u", i,
+			    l3_2->l4_row, l3_2->l3_end);
+		TEST_ASSERT((l3_2->l4_row == DPAA2_PTYPE_L4_INNER) ==
+			    !!(l3_2->packet_type & RTE_PTYPE_INNER_L3_MASK),
+			    "DPAA2 entry %#x: inner L4 row without inner L3",
+			    i);
+	}
+	return TEST_SUCCESS;
+}
+
+static struct unit_test_suite dpaa_ptype_testsuite  = {
+	.suite_name = "DPAA Packet Type Unit Test Suite",
+	.setup = NULL,
+	.teardown = NULL,
+	.unit_test_cases = {
+		TEST_CASE(test_dpaa_ptype_dpaa),
+		TEST_CASE(test_dpaa_ptype_dpaa2),
+		TEST_CASE(test_dpaa_ptype_tables),
+
+		TEST_CASES_END() /**< NULL terminate unit test array */
+	}
+};
+
+static int
+test_dpaa_ptype(void)
+{
+	return unit_test_suite_runner(&dpaa_ptype_testsuite);
+}
+
+REGISTER_TEST_COMMAND(dpaa_ptype_autotest, test_dpaa_ptype);
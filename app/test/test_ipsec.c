@@ -0,0 +1,737 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 Freescale Semiconductor, Inc. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of  Freescale Semiconductor, Inc nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <netinet/in.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_byteorder.h>
+#include <rte_mbuf.h>
+#include <rte_ip.h>
+#include <rte_udp.h>
+#include <rte_crypto.h>
+#include <rte_cryptodev.h>
+#include <rte_ipsec.h>
+
+#include "test.h"
+
+/*
+ * IPsec library test
+ * ==================
+ *
+ * - Encapsulate a burst with an egress SA and decapsulate it with the
+ *   matching ingress SA, in tunnel and transport mode, on the NULL crypto
+ *   device, and check the packets are restored.
+ *
+ * - Deliver packets out of order to an ingress SA and check the
+ *   anti-replay window drops the duplicated and too old ones, also for
+ *   windows smaller than or not a multiple of a 64 bit bucket sliding
+ *   across a bucket boundary.
+ *
+ * - Check the grouping of a burst by SA.
+ *
+ * - With the OpenSSL crypto device, check that the lookaside
+ *   encapsulation of the library and the IPsec protocol offload of the
+ *   device interoperate, and that a corrupted ICV is detected.
+ *
+ * The performance test measures the cycles per packet of an egress and an
+ * ingress tunnel SA, from prepare to process, with the NULL device, and
+ * with the OpenSSL device in lookaside and protocol offload modes.
+ */
+
+#define IPSEC_TEST_NB_MBUFS	1023
+#define IPSEC_TEST_NB_OPS	1023
+#define IPSEC_TEST_NB_DESC	2048
+#define IPSEC_TEST_BURST	32
+#define IPSEC_TEST_PAYLOAD	100
+#define IPSEC_TEST_SPI		0x100
+#define IPSEC_TEST_REPLAY_PKTS	200
+#define IPSEC_TEST_REPLAY_WIN	64
+#define IPSEC_PERF_ITER		10000
+
+static struct rte_mempool *mbuf_pool;
+static struct rte_mempool *op_pool;
+
+static uint32_t replay_win = IPSEC_TEST_REPLAY_WIN;
+
+static uint8_t cipher_key[16] = "sixteenbytes key";
+static uint8_t auth_key[20] = "twentybytes hash ke";
+
+static int
+ipsec_test_pools(void)
+{
+	mbuf_pool = rte_mempool_lookup("IPSEC_TEST_MBUF");
+	if (mbuf_pool == NULL)
+		mbuf_pool = rte_pktmbuf_pool_create("IPSEC_TEST_MBUF",
+				IPSEC_TEST_NB_MBUFS, 32, 0,
+				RTE_MBUF_DEFAULT_BUF_SIZE, SOCKET_ID_ANY);
+	op_pool = rte_mempool_lookup("IPSEC_TEST_OP");
+	if (op_pool == NULL)
+		op_pool = rte_crypto_op_pool_create("IPSEC_TEST_OP",
+				RTE_CRYPTO_OP_TYPE_SYMMETRIC,
+				IPSEC_TEST_NB_OPS, 32, 0, SOCKET_ID_ANY);
+
+	return (mbuf_pool == NULL || op_pool == NULL) ? -1 : 0;
+}
+
+/* find or create a device of the given type and start its first qp */
+static int
+ipsec_test_dev(enum rte_cryptodev_type type, const char *name)
+{
+	struct rte_cryptodev_config conf;
+	struct rte_cryptodev_qp_conf qp_conf;
+	struct rte_cryptodev_info info;
+	uint8_t dev_id, qp_id, nb_devs;
+	int ret;
+
+	if (rte_cryptodev_count_devtype(type) == 0 &&
+			rte_eal_vdev_init(name, NULL) < 0)
+		return -1;
+
+	nb_devs = rte_cryptodev_count();
+	for (dev_id = 0; dev_id < nb_devs; dev_id++) {
+		rte_cryptodev_info_get(dev_id, &info);
+		if (info.dev_type == type)
+			break;
+	}
+	if (dev_id == nb_devs)
+		return -1;
+
+	rte_cryptodev_stop(dev_id);
+
+	memset(&conf, 0, sizeof(conf));
+	conf.socket_id = SOCKET_ID_ANY;
+	conf.nb_queue_pairs = info.max_nb_queue_pairs;
+	conf.session_mp.nb_objs = info.sym.max_nb_sessions;
+	ret = rte_cryptodev_configure(dev_id, &conf);
+	if (ret < 0)
+		return ret;
+
+	qp_conf.nb_descriptors = IPSEC_TEST_NB_DESC;
+	for (qp_id = 0; qp_id < info.max_nb_queue_pairs; qp_id++) {
+		ret = rte_cryptodev_queue_pair_setup(dev_id, qp_id, &qp_conf,
+				rte_cryptodev_socket_id(dev_id));
+		if (ret < 0)
+			return ret;
+	}
+
+	ret = rte_cryptodev_start(dev_id);
+	if (ret < 0)
+		return ret;
+
+	return dev_id;
+}
+
+static struct rte_ipsec_sa *
+ipsec_test_sa(uint8_t dev_id, enum rte_crypto_ipsec_direction dir,
+		enum rte_crypto_ipsec_mode mode,
+		enum rte_crypto_cipher_algorithm cipher_algo,
+		enum rte_crypto_auth_algorithm auth_algo,
+		uint32_t seq, uint32_t flags)
+{
+	struct rte_crypto_sym_xform xf[3];
+	struct rte_crypto_sym_xform *cipher, *auth;
+
+	memset(xf, 0, sizeof(xf));
+
+	xf[0].type = RTE_CRYPTO_SYM_XFORM_IPSEC;
+	xf[0].next = &xf[1];
+	xf[0].ipsec.proto = RTE_CRYPTO_IPSEC_PROTO_ESP;
+	xf[0].ipsec.mode = mode;
+	xf[0].ipsec.direction = dir;
+	xf[0].ipsec.spi = IPSEC_TEST_SPI;
+	xf[0].ipsec.seq = seq;
+	xf[0].ipsec.tunnel.type = RTE_CRYPTO_IPSEC_TUNNEL_IPV4;
+	xf[0].ipsec.tunnel.ipv4.src_addr =
+			rte_cpu_to_be_32(IPv4(172, 16, 1, 5));
+	xf[0].ipsec.tunnel.ipv4.dst_addr =
+			rte_cpu_to_be_32(IPv4(172, 16, 2, 5));
+
+	if (dir == RTE_CRYPTO_IPSEC_DIR_EGRESS) {
+		cipher = &xf[1];
+		auth = &xf[2];
+		cipher->next = auth;
+		cipher->cipher.op = RTE_CRYPTO_CIPHER_OP_ENCRYPT;
+		auth->auth.op = RTE_CRYPTO_AUTH_OP_GENERATE;
+	} else {
+		xf[0].ipsec.replay_win_sz = replay_win;
+		auth = &xf[1];
+		cipher = &xf[2];
+		auth->next = cipher;
+		cipher->cipher.op = RTE_CRYPTO_CIPHER_OP_DECRYPT;
+		auth->auth.op = RTE_CRYPTO_AUTH_OP_VERIFY;
+	}
+
+	cipher->type = RTE_CRYPTO_SYM_XFORM_CIPHER;
+	cipher->cipher.algo = cipher_algo;
+	if (cipher_algo != RTE_CRYPTO_CIPHER_NULL) {
+		cipher->cipher.key.data = cipher_key;
+		cipher->cipher.key.length = sizeof(cipher_key);
+	}
+
+	auth->type = RTE_CRYPTO_SYM_XFORM_AUTH;
+	auth->auth.algo = auth_algo;
+	if (auth_algo != RTE_CRYPTO_AUTH_NULL) {
+		auth->auth.key.data = auth_key;
+		auth->auth.key.length = sizeof(auth_key);
+		auth->auth.digest_length = 12;
+	}
+
+	return rte_ipsec_sa_create(xf, dev_id, 0, flags, SOCKET_ID_ANY);
+}
+
+/* IPv4/UDP packet whose payload is derived from id */
+static struct rte_mbuf *
+ipsec_test_pkt(uint32_t id, uint16_t payload_len)
+{
+	struct rte_mbuf *m;
+	struct ipv4_hdr *ip;
+	struct udp_hdr *udp;
+	uint8_t *payload;
+	uint16_t len = sizeof(*ip) + sizeof(*udp) + payload_len;
+	uint32_t i;
+
+	m = rte_pktmbuf_alloc(mbuf_pool);
+	if (m == NULL)
+		return NULL;
+
+	ip = (struct ipv4_hdr *)rte_pktmbuf_append(m, len);
+	if (ip == NULL) {
+		rte_pktmbuf_free(m);
+		return NULL;
+	}
+	memset(ip, 0, len);
+	ip->version_ihl = 0x45;
+	ip->total_length = rte_cpu_to_be_16(len);
+	ip->packet_id = rte_cpu_to_be_16(id);
+	ip->time_to_live = 64;
+	ip->next_proto_id = IPPROTO_UDP;
+	ip->src_addr = rte_cpu_to_be_32(IPv4(192, 168, 1, 1));
+	ip->dst_addr = rte_cpu_to_be_32(IPv4(192, 168, 2, 1));
+	ip->hdr_checksum = rte_ipv4_cksum(ip);
+
+	udp = (struct udp_hdr *)(ip + 1);
+	udp->src_port = rte_cpu_to_be_16(1024);
+	udp->dst_port = rte_cpu_to_be_16(1024);
+	udp->dgram_len = rte_cpu_to_be_16(sizeof(*udp) + payload_len);
+
+	payload = (uint8_t *)(udp + 1);
+	for (i = 0; i != payload_len; i++)
+		payload[i] = id + i;
+
+	return m;
+}
+
+static struct rte_mbuf *
+ipsec_test_copy(struct rte_mbuf *m)
+{
+	struct rte_mbuf *c;
+	char *data;
+
+	c = rte_pktmbuf_alloc(mbuf_pool);
+	if (c == NULL)
+		return NULL;
+
+	data = rte_pktmbuf_append(c, m->data_len);
+	if (data == NULL) {
+		rte_pktmbuf_free(c);
+		return NULL;
+	}
+	memcpy(data, rte_pktmbuf_mtod(m, void *), m->data_len);
+
+	return c;
+}
+
+static void
+ipsec_test_free(struct rte_mbuf *mb[], uint16_t num)
+{
+	uint16_t i;
+
+	for (i = 0; i != num; i++)
+		rte_pktmbuf_free(mb[i]);
+}
+
+/*
+ * Run a burst of packets of one SA through the library and the device.
+ * The successful packets are returned first in mb[].
+ */
+static int
+ipsec_test_run(struct rte_ipsec_sa *sa, struct rte_mbuf *mb[], uint16_t num)
+{
+	struct rte_crypto_op *cop[num], *deq[num];
+	struct rte_ipsec_group grp[num];
+	uint16_t e, k, n, ng;
+
+	if (rte_crypto_op_bulk_alloc(op_pool, RTE_CRYPTO_OP_TYPE_SYMMETRIC,
+			cop, num) != num)
+		return -1;
+
+	k = rte_ipsec_crypto_prepare(sa, mb, cop, num);
+	e = rte_ipsec_crypto_enqueue(sa, cop, k);
+
+	for (n = 0; n != e; )
+		n += rte_cryptodev_dequeue_burst(sa->dev_id, sa->qp_id,
+				deq + n, e - n);
+
+	/* synchronous devices may refuse the operations they failed */
+	for (; n != k; n++) {
+		if (cop[n]->status == RTE_CRYPTO_OP_STATUS_NOT_PROCESSED)
+			return -1;
+		deq[n] = cop[n];
+	}
+
+	ng = rte_ipsec_crypto_group(deq, mb, grp, k);
+	if (k != 0 && (ng != 1 || grp[0].sa != sa || grp[0].cnt != k))
+		return -1;
+
+	n = (k == 0) ? 0 : rte_ipsec_process(sa, grp[0].cop, grp[0].mb, k);
+
+	for (k = 0; k != num; k++)
+		rte_crypto_op_free(cop[k]);
+
+	return n;
+}
+
+static int
+test_ipsec_roundtrip(uint8_t dev_id, enum rte_crypto_ipsec_mode mode,
+		enum rte_crypto_cipher_algorithm cipher_algo,
+		enum rte_crypto_auth_algorithm auth_algo,
+		uint32_t out_flags, uint32_t in_flags)
+{
+	struct rte_ipsec_sa *out, *in;
+	struct rte_mbuf *mb[IPSEC_TEST_BURST], *ref[IPSEC_TEST_BURST];
+	struct ipv4_hdr *ip;
+	uint32_t *esp;
+	uint32_t i;
+	int n;
+
+	out = ipsec_test_sa(dev_id, RTE_CRYPTO_IPSEC_DIR_EGRESS, mode,
+			cipher_algo, auth_algo, 0, out_flags);
+	in = ipsec_test_sa(dev_id, RTE_CRYPTO_IPSEC_DIR_INGRESS, mode,
+			cipher_algo, auth_algo, 0, in_flags);
+	TEST_ASSERT(out != NULL && in != NULL, "Cannot create SAs");
+
+	for (i = 0; i != IPSEC_TEST_BURST; i++) {
+		mb[i] = ipsec_test_pkt(i, IPSEC_TEST_PAYLOAD);
+		TEST_ASSERT_NOT_NULL(mb[i], "Cannot allocate packet");
+		ref[i] = ipsec_test_copy(mb[i]);
+		TEST_ASSERT_NOT_NULL(ref[i], "Cannot allocate packet");
+	}
+
+	n = ipsec_test_run(out, mb, IPSEC_TEST_BURST);
+	TEST_ASSERT_EQUAL(n, IPSEC_TEST_BURST, "Egress failed: %d", n);
+
+	for (i = 0; i != IPSEC_TEST_BURST; i++) {
+		ip = rte_pktmbuf_mtod(mb[i], struct ipv4_hdr *);
+		TEST_ASSERT_EQUAL(ip->next_proto_id, IPPROTO_ESP,
+				"Packet %u is not ESP", i);
+		TEST_ASSERT_EQUAL(rte_be_to_cpu_16(ip->total_length),
+				mb[i]->data_len, "Bad length of packet %u", i);
+		if (mode == RTE_CRYPTO_IPSEC_MODE_TUNNEL)
+			TEST_ASSERT_EQUAL(ip->dst_addr,
+				rte_cpu_to_be_32(IPv4(172, 16, 2, 5)),
+				"Bad outer header of packet %u", i);
+		esp = (uint32_t *)(ip + 1);
+		TEST_ASSERT_EQUAL(rte_be_to_cpu_32(esp[0]), IPSEC_TEST_SPI,
+				"Bad SPI in packet %u", i);
+		TEST_ASSERT_EQUAL(rte_be_to_cpu_32(esp[1]), i + 1,
+				"Bad sequence number in packet %u", i);
+	}
+
+	n = ipsec_test_run(in, mb, IPSEC_TEST_BURST);
+	TEST_ASSERT_EQUAL(n, IPSEC_TEST_BURST, "Ingress failed: %d", n);
+
+	for (i = 0; i != IPSEC_TEST_BURST; i++) {
+		TEST_ASSERT_EQUAL(mb[i]->data_len, ref[i]->data_len,
+				"Bad length of decapsulated packet %u", i);
+		TEST_ASSERT_BUFFERS_ARE_EQUAL(rte_pktmbuf_mtod(mb[i], void *),
+				rte_pktmbuf_mtod(ref[i], void *),
+				ref[i]->data_len,
+				"Packet %u not restored", i);
+	}
+
+	TEST_ASSERT_EQUAL(out->stats.pkts, IPSEC_TEST_BURST,
+			"Bad egress statistics");
+	TEST_ASSERT_EQUAL(in->stats.pkts, IPSEC_TEST_BURST,
+			"Bad ingress statistics");
+
+	ipsec_test_free(mb, IPSEC_TEST_BURST);
+	ipsec_test_free(ref, IPSEC_TEST_BURST);
+	rte_ipsec_sa_free(out);
+	rte_ipsec_sa_free(in);
+
+	return TEST_SUCCESS;
+}
+
+/* deliver the packet of sequence number seq, return 1 if accepted */
+static int
+ipsec_test_deliver(struct rte_ipsec_sa *in, struct rte_mbuf *esp[],
+		uint32_t seq)
+{
+	struct rte_mbuf *m;
+	int n;
+
+	m = ipsec_test_copy(esp[seq - 1]);
+	if (m == NULL)
+		return -1;
+	n = ipsec_test_run(in, &m, 1);
+	rte_pktmbuf_free(m);
+
+	return n;
+}
+
+/* encapsulate the packets of sequence numbers 1 to IPSEC_TEST_REPLAY_PKTS */
+static int
+ipsec_test_replay_pkts(uint8_t dev_id, struct rte_mbuf *esp[])
+{
+	struct rte_ipsec_sa *out;
+	uint32_t i, n;
+
+	out = ipsec_test_sa(dev_id, RTE_CRYPTO_IPSEC_DIR_EGRESS,
+			RTE_CRYPTO_IPSEC_MODE_TUNNEL, RTE_CRYPTO_CIPHER_NULL,
+			RTE_CRYPTO_AUTH_NULL, 0, 0);
+	TEST_ASSERT_NOT_NULL(out, "Cannot create egress SA");
+
+	for (i = 0; i != IPSEC_TEST_REPLAY_PKTS; i++) {
+		esp[i] = ipsec_test_pkt(i, IPSEC_TEST_PAYLOAD);
+		TEST_ASSERT_NOT_NULL(esp[i], "Cannot allocate packet");
+	}
+	for (i = 0; i != IPSEC_TEST_REPLAY_PKTS; i += n) {
+		n = RTE_MIN((uint32_t)IPSEC_TEST_BURST,
+				IPSEC_TEST_REPLAY_PKTS - i);
+		TEST_ASSERT_EQUAL(ipsec_test_run(out, esp + i, n), (int)n,
+				"Egress failed");
+	}
+
+	rte_ipsec_sa_free(out);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_ipsec_replay(uint8_t dev_id)
+{
+	struct rte_ipsec_sa *in;
+	struct rte_mbuf *esp[IPSEC_TEST_REPLAY_PKTS];
+	uint32_t i;
+
+	TEST_ASSERT_SUCCESS(ipsec_test_replay_pkts(dev_id, esp),
+			"Cannot build the ESP packets");
+	in = ipsec_test_sa(dev_id, RTE_CRYPTO_IPSEC_DIR_INGRESS,
+			RTE_CRYPTO_IPSEC_MODE_TUNNEL, RTE_CRYPTO_CIPHER_NULL,
+			RTE_CRYPTO_AUTH_NULL, 0, 0);
+	TEST_ASSERT_NOT_NULL(in, "Cannot create ingress SA");
+
+	/* 1 to 50 but 40, then 40 and a duplicate of 40 */
+	for (i = 1; i <= 50; i++)
+		if (i != 40)
+			TEST_ASSERT_EQUAL(ipsec_test_deliver(in, esp, i), 1,
+					"Packet %u dropped", i);
+	TEST_ASSERT_EQUAL(ipsec_test_deliver(in, esp, 40), 1,
+			"Late packet inside the window dropped");
+	TEST_ASSERT_EQUAL(ipsec_test_deliver(in, esp, 40), 0,
+			"Duplicate packet accepted");
+
+	/* jump ahead: 100 gets out of the window, 150 is still inside */
+	TEST_ASSERT_EQUAL(ipsec_test_deliver(in, esp, 200), 1,
+			"Packet 200 dropped");
+	TEST_ASSERT_EQUAL(ipsec_test_deliver(in, esp, 100), 0,
+			"Packet older than the window accepted");
+	TEST_ASSERT_EQUAL(ipsec_test_deliver(in, esp, 150), 1,
+			"Packet 150 dropped");
+	TEST_ASSERT_EQUAL(ipsec_test_deliver(in, esp, 150), 0,
+			"Duplicate packet accepted");
+
+	TEST_ASSERT_EQUAL(in->stats.replayed, 3, "Bad replay statistics");
+
+	ipsec_test_free(esp, IPSEC_TEST_REPLAY_PKTS);
+	rte_ipsec_sa_free(in);
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * With a window of win, receive 1 to last then next, which moves the window
+ * to another bucket: replay, received before and still inside the window,
+ * must be dropped.
+ */
+static int
+test_ipsec_replay_bucket(uint8_t dev_id, uint32_t win, uint32_t last,
+		uint32_t next, uint32_t replay)
+{
+	struct rte_ipsec_sa *in;
+	struct rte_mbuf *esp[IPSEC_TEST_REPLAY_PKTS];
+	uint32_t i;
+
+	TEST_ASSERT_SUCCESS(ipsec_test_replay_pkts(dev_id, esp),
+			"Cannot build the ESP packets");
+	replay_win = win;
+	in = ipsec_test_sa(dev_id, RTE_CRYPTO_IPSEC_DIR_INGRESS,
+			RTE_CRYPTO_IPSEC_MODE_TUNNEL, RTE_CRYPTO_CIPHER_NULL,
+			RTE_CRYPTO_AUTH_NULL, 0, 0);
+	replay_win = IPSEC_TEST_REPLAY_WIN;
+	TEST_ASSERT_NOT_NULL(in, "Cannot create ingress SA");
+
+	for (i = 1; i <= last; i++)
+		TEST_ASSERT_EQUAL(ipsec_test_deliver(in, esp, i), 1,
+				"Window %u: packet %u dropped", win, i);
+	TEST_ASSERT_EQUAL(ipsec_test_deliver(in, esp, next), 1,
+			"Window %u: packet %u dropped", win, next);
+	TEST_ASSERT_EQUAL(ipsec_test_deliver(in, esp, replay), 0,
+			"Window %u: replayed packet %u accepted", win, replay);
+	TEST_ASSERT_EQUAL(in->stats.replayed, 1,
+			"Window %u: bad replay statistics", win);
+
+	ipsec_test_free(esp, IPSEC_TEST_REPLAY_PKTS);
+	rte_ipsec_sa_free(in);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_ipsec_group(void)
+{
+	struct rte_ipsec_sa sa[2];
+	struct rte_ipsec_sa *psa[5] = {
+		&sa[0], &sa[0], &sa[1], &sa[1], &sa[0],
+	};
+	struct rte_mbuf *mb[5];
+	struct rte_ipsec_group grp[5];
+	uint16_t n;
+
+	memset(mb, 0, sizeof(mb));
+	n = rte_ipsec_sa_group(psa, mb, grp, RTE_DIM(psa));
+
+	TEST_ASSERT_EQUAL(n, 3, "Bad number of groups");
+	TEST_ASSERT(grp[0].sa == &sa[0] && grp[0].mb == mb &&
+			grp[0].cnt == 2, "Bad first group");
+	TEST_ASSERT(grp[1].sa == &sa[1] && grp[1].mb == mb + 2 &&
+			grp[1].cnt == 2, "Bad second group");
+	TEST_ASSERT(grp[2].sa == &sa[0] && grp[2].mb == mb + 4 &&
+			grp[2].cnt == 1, "Bad third group");
+
+	return TEST_SUCCESS;
+}
+
+#ifdef RTE_LIBRTE_PMD_OPENSSL
+static int
+test_ipsec_auth_failure(uint8_t dev_id)
+{
+	struct rte_ipsec_sa *out, *in;
+	struct rte_mbuf *m;
+
+	out = ipsec_test_sa(dev_id, RTE_CRYPTO_IPSEC_DIR_EGRESS,
+			RTE_CRYPTO_IPSEC_MODE_TUNNEL, RTE_CRYPTO_CIPHER_AES_CBC,
+			RTE_CRYPTO_AUTH_SHA1_HMAC, 0, RTE_IPSEC_SA_F_LOOKASIDE);
+	in = ipsec_test_sa(dev_id, RTE_CRYPTO_IPSEC_DIR_INGRESS,
+			RTE_CRYPTO_IPSEC_MODE_TUNNEL, RTE_CRYPTO_CIPHER_AES_CBC,
+			RTE_CRYPTO_AUTH_SHA1_HMAC, 0, RTE_IPSEC_SA_F_LOOKASIDE);
+	TEST_ASSERT(out != NULL && in != NULL, "Cannot create SAs");
+
+	m = ipsec_test_pkt(0, IPSEC_TEST_PAYLOAD);
+	TEST_ASSERT_NOT_NULL(m, "Cannot allocate packet");
+	TEST_ASSERT_EQUAL(ipsec_test_run(out, &m, 1), 1, "Egress failed");
+
+	*rte_pktmbuf_mtod_offset(m, uint8_t *, m->data_len - 1) ^= 1;
+	TEST_ASSERT_EQUAL(ipsec_test_run(in, &m, 1), 0,
+			"Corrupted packet accepted");
+	TEST_ASSERT_EQUAL(in->stats.auth_failed, 1,
+			"Bad authentication statistics");
+
+	rte_pktmbuf_free(m);
+	rte_ipsec_sa_free(out);
+	rte_ipsec_sa_free(in);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_ipsec_openssl(void)
+{
+	int dev_id;
+
+	dev_id = ipsec_test_dev(RTE_CRYPTODEV_OPENSSL_PMD,
+			RTE_STR(CRYPTODEV_NAME_OPENSSL_PMD));
+	if (dev_id < 0) {
+		printf("OpenSSL crypto device not available, skipping\n");
+		return TEST_SUCCESS;
+	}
+
+	/* library encapsulation, device protocol offload decapsulation */
+	if (test_ipsec_roundtrip(dev_id, RTE_CRYPTO_IPSEC_MODE_TUNNEL,
+			RTE_CRYPTO_CIPHER_AES_CBC, RTE_CRYPTO_AUTH_SHA1_HMAC,
+			RTE_IPSEC_SA_F_LOOKASIDE, 0) < 0)
+		return -1;
+	/* and the other way around */
+	if (test_ipsec_roundtrip(dev_id, RTE_CRYPTO_IPSEC_MODE_TRANSPORT,
+			RTE_CRYPTO_CIPHER_3DES_CBC, RTE_CRYPTO_AUTH_SHA1_HMAC,
+			0, RTE_IPSEC_SA_F_LOOKASIDE) < 0)
+		return -1;
+
+	return test_ipsec_auth_failure(dev_id);
+}
+#endif
+
+static int
+test_ipsec(void)
+{
+	int dev_id;
+
+	TEST_ASSERT_SUCCESS(ipsec_test_pools(), "Cannot create pools");
+
+	if (test_ipsec_group() < 0)
+		return -1;
+
+	dev_id = ipsec_test_dev(RTE_CRYPTODEV_NULL_PMD,
+			RTE_STR(CRYPTODEV_NAME_NULL_PMD));
+	TEST_ASSERT(dev_id >= 0, "Cannot set up the NULL crypto device");
+
+	if (test_ipsec_roundtrip(dev_id, RTE_CRYPTO_IPSEC_MODE_TUNNEL,
+			RTE_CRYPTO_CIPHER_NULL, RTE_CRYPTO_AUTH_NULL, 0, 0) < 0)
+		return -1;
+	if (test_ipsec_roundtrip(dev_id, RTE_CRYPTO_IPSEC_MODE_TRANSPORT,
+			RTE_CRYPTO_CIPHER_NULL, RTE_CRYPTO_AUTH_NULL, 0, 0) < 0)
+		return -1;
+	if (test_ipsec_replay(dev_id) < 0)
+		return -1;
+	if (test_ipsec_replay_bucket(dev_id, 32, 60, 70, 40) < 0)
+		return -1;
+	if (test_ipsec_replay_bucket(dev_id, 100, 120, 150, 60) < 0)
+		return -1;
+
+#ifdef RTE_LIBRTE_PMD_OPENSSL
+	if (test_ipsec_openssl() < 0)
+		return -1;
+#endif
+
+	return 0;
+}
+
+static int
+test_ipsec_perf_sa(uint8_t dev_id, const char *name,
+		enum rte_crypto_cipher_algorithm cipher_algo,
+		enum rte_crypto_auth_algorithm auth_algo, uint32_t flags)
+{
+	static const uint16_t sizes[] = { 64, 512, 1400 };
+	struct rte_ipsec_sa *out, *in;
+	struct rte_mbuf *mb[IPSEC_TEST_BURST];
+	uint64_t t0, t1, t2, t_out, t_in;
+	uint32_t i, j, it;
+
+	out = ipsec_test_sa(dev_id, RTE_CRYPTO_IPSEC_DIR_EGRESS,
+			RTE_CRYPTO_IPSEC_MODE_TUNNEL, cipher_algo, auth_algo,
+			0, flags);
+	in = ipsec_test_sa(dev_id, RTE_CRYPTO_IPSEC_DIR_INGRESS,
+			RTE_CRYPTO_IPSEC_MODE_TUNNEL, cipher_algo, auth_algo,
+			0, flags);
+	TEST_ASSERT(out != NULL && in != NULL, "Cannot create SAs");
+
+	for (i = 0; i != RTE_DIM(sizes); i++) {
+		for (j = 0; j != IPSEC_TEST_BURST; j++) {
+			mb[j] = ipsec_test_pkt(j, sizes[i]);
+			TEST_ASSERT_NOT_NULL(mb[j], "Cannot allocate packet");
+		}
+
+		t_out = 0;
+		t_in = 0;
+		for (it = 0; it != IPSEC_PERF_ITER; it++) {
+			/* decapsulation restores the packets of the burst */
+			t0 = rte_rdtsc();
+			if (ipsec_test_run(out, mb, IPSEC_TEST_BURST) !=
+					IPSEC_TEST_BURST)
+				break;
+			t1 = rte_rdtsc();
+			if (ipsec_test_run(in, mb, IPSEC_TEST_BURST) !=
+					IPSEC_TEST_BURST)
+				break;
+			t2 = rte_rdtsc();
+			t_out += t1 - t0;
+			t_in += t2 - t1;
+		}
+		ipsec_test_free(mb, IPSEC_TEST_BURST);
+		TEST_ASSERT_EQUAL(it, IPSEC_PERF_ITER, "Burst %u failed", it);
+
+		printf("%-24s %-8s %8u %14.1f %14.1f\n", name,
+				out->proto_offload ? "offload" : "library",
+				sizes[i],
+				(double)t_out / (IPSEC_PERF_ITER *
+					IPSEC_TEST_BURST),
+				(double)t_in / (IPSEC_PERF_ITER *
+					IPSEC_TEST_BURST));
+	}
+
+	rte_ipsec_sa_free(out);
+	rte_ipsec_sa_free(in);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_ipsec_perf(void)
+{
+	int dev_id;
+
+	TEST_ASSERT_SUCCESS(ipsec_test_pools(), "Cannot create pools");
+
+	printf("\n%-24s %-8s %8s %14s %14s\n", "Algorithms", "ESP",
+			"Payload", "Egress cyc/pkt", "Ingress cyc/pkt");
+
+	dev_id = ipsec_test_dev(RTE_CRYPTODEV_NULL_PMD,
+			RTE_STR(CRYPTODEV_NAME_NULL_PMD));
+	TEST_ASSERT(dev_id >= 0, "Cannot set up the NULL crypto device");
+	if (test_ipsec_perf_sa(dev_id, "NULL", RTE_CRYPTO_CIPHER_NULL,
+			RTE_CRYPTO_AUTH_NULL, 0) < 0)
+		return -1;
+
+#ifdef RTE_LIBRTE_PMD_OPENSSL
+	dev_id = ipsec_test_dev(RTE_CRYPTODEV_OPENSSL_PMD,
+			RTE_STR(CRYPTODEV_NAME_OPENSSL_PMD));
+	if (dev_id < 0)
+		return 0;
+	if (test_ipsec_perf_sa(dev_id, "AES128-CBC HMAC-SHA1",
+			RTE_CRYPTO_CIPHER_AES_CBC, RTE_CRYPTO_AUTH_SHA1_HMAC,
+			RTE_IPSEC_SA_F_LOOKASIDE) < 0)
+		return -1;
+	if (test_ipsec_perf_sa(dev_id, "AES128-CBC HMAC-SHA1",
+			RTE_CRYPTO_CIPHER_AES_CBC, RTE_CRYPTO_AUTH_SHA1_HMAC,
+			0) < 0)
+		return -1;
+#endif
+
+	return 0;
+}
+
+REGISTER_TEST_COMMAND(ipsec_autotest, test_ipsec);
+REGISTER_TEST_COMMAND(ipsec_perftest, test_ipsec_perf);
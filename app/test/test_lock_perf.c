@@ -0,0 +1,223 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 Freescale Semiconductor, Inc. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of  Freescale Semiconductor, Inc nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_launch.h>
+#include <rte_eal.h>
+#include <rte_lcore.h>
+#include <rte_cycles.h>
+#include <rte_atomic.h>
+#include <rte_spinlock.h>
+#include <rte_rwlock.h>
+#include <rte_ticketlock.h>
+#include <rte_mcslock.h>
+#include <rte_brwlock.h>
+
+#include "test.h"
+
+/*
+ * Lock performance test
+ * =====================
+ *
+ * For each lock type and for 2, 4, 8 and 16 contending lcores (as far as
+ * the coremask allows), every lcore takes and releases the same lock in a
+ * tight loop during a fixed time.
+ *
+ * - The throughput is the total number of lock/unlock pairs per ms.
+ * - The fairness is the ratio between the lcores with the fewest and the
+ *   most acquisitions: 1.0 means every lcore got the same share.
+ *
+ * The read-mostly test compares rte_rwlock_t and rte_brwlock_t when every
+ * lcore takes the read lock, and the master lcore takes the write lock
+ * once every READ_WRITE_RATIO iterations.
+ */
+
+#define TIME_MS 100
+#define READ_WRITE_RATIO 1000
+
+struct lock_perf_ops {
+	const char *name;
+	void (*lock)(void);
+	void (*unlock)(void);
+	void (*write_lock)(void); /**< optional, for read-mostly tests */
+	void (*write_unlock)(void);
+};
+
+static rte_spinlock_t sl = RTE_SPINLOCK_INITIALIZER;
+static rte_ticketlock_t tl = RTE_TICKETLOCK_INITIALIZER;
+static rte_mcslock_t *ml;
+static RTE_DEFINE_PER_LCORE(rte_mcslock_t, ml_node);
+static rte_rwlock_t rwl = RTE_RWLOCK_INITIALIZER;
+static rte_brwlock_t brwl;
+
+static void spinlock_lock(void) { rte_spinlock_lock(&sl); }
+static void spinlock_unlock(void) { rte_spinlock_unlock(&sl); }
+static void ticketlock_lock(void) { rte_ticketlock_lock(&tl); }
+static void ticketlock_unlock(void) { rte_ticketlock_unlock(&tl); }
+static void mcslock_lock(void) { rte_mcslock_lock(&ml, &RTE_PER_LCORE(ml_node)); }
+static void mcslock_unlock(void) { rte_mcslock_unlock(&ml, &RTE_PER_LCORE(ml_node)); }
+static void rwlock_read_lock(void) { rte_rwlock_read_lock(&rwl); }
+static void rwlock_read_unlock(void) { rte_rwlock_read_unlock(&rwl); }
+static void rwlock_write_lock(void) { rte_rwlock_write_lock(&rwl); }
+static void rwlock_write_unlock(void) { rte_rwlock_write_unlock(&rwl); }
+static void brwlock_read_lock(void) { rte_brwlock_read_lock(&brwl); }
+static void brwlock_read_unlock(void) { rte_brwlock_read_unlock(&brwl); }
+static void brwlock_write_lock(void) { rte_brwlock_write_lock(&brwl); }
+static void brwlock_write_unlock(void) { rte_brwlock_write_unlock(&brwl); }
+
+static const struct lock_perf_ops exclusive_ops[] = {
+	{ "spinlock", spinlock_lock, spinlock_unlock, NULL, NULL },
+	{ "ticketlock", ticketlock_lock, ticketlock_unlock, NULL, NULL },
+	{ "mcslock", mcslock_lock, mcslock_unlock, NULL, NULL },
+	{ "rwlock (write)", rwlock_write_lock, rwlock_write_unlock, NULL, NULL },
+	{ "brwlock (write)", brwlock_write_lock, brwlock_write_unlock,
+		NULL, NULL },
+};
+
+static const struct lock_perf_ops read_mostly_ops[] = {
+	{ "rwlock", rwlock_read_lock, rwlock_read_unlock,
+		rwlock_write_lock, rwlock_write_unlock },
+	{ "brwlock", brwlock_read_lock, brwlock_read_unlock,
+		brwlock_write_lock, brwlock_write_unlock },
+};
+
+static const struct lock_perf_ops *cur_ops;
+static uint64_t lock_count[RTE_MAX_LCORE];
+static volatile uint64_t shared_data;
+static rte_atomic32_t synchro;
+
+static int
+load_loop_fn(__attribute__((unused)) void *arg)
+{
+	const struct lock_perf_ops *ops = cur_ops;
+	const unsigned int lcore = rte_lcore_id();
+	const int writer = (lcore == rte_get_master_lcore() &&
+			    ops->write_lock != NULL);
+	uint64_t hz = rte_get_timer_hz();
+	uint64_t time_diff = 0, begin;
+	uint64_t lcount = 0;
+
+	/* wait synchro for slaves */
+	if (lcore != rte_get_master_lcore())
+		while (rte_atomic32_read(&synchro) == 0)
+			rte_pause();
+
+	begin = rte_get_timer_cycles();
+	while (time_diff < hz * TIME_MS / 1000) {
+		if (writer && (lcount % READ_WRITE_RATIO) == 0) {
+			ops->write_lock();
+			shared_data++;
+			ops->write_unlock();
+		} else {
+			ops->lock();
+			shared_data++;
+			ops->unlock();
+		}
+		lcount++;
+		time_diff = rte_get_timer_cycles() - begin;
+	}
+	lock_count[lcore] = lcount;
+	return 0;
+}
+
+/* Run the load loop on the master and the first (n - 1) slave lcores. */
+static void
+run_on_lcores(const struct lock_perf_ops *ops, unsigned int n)
+{
+	uint64_t total = 0, min = UINT64_MAX, max = 0;
+	unsigned int i, launched = 1;
+
+	cur_ops = ops;
+	memset(lock_count, 0, sizeof(lock_count));
+	rte_atomic32_set(&synchro, 0);
+
+	RTE_LCORE_FOREACH_SLAVE(i) {
+		if (launched == n)
+			break;
+		rte_eal_remote_launch(load_loop_fn, NULL, i);
+		launched++;
+	}
+
+	rte_atomic32_set(&synchro, 1);
+	load_loop_fn(NULL);
+	rte_eal_mp_wait_lcore();
+
+	RTE_LCORE_FOREACH(i) {
+		if (lock_count[i] == 0)
+			continue;
+		total += lock_count[i];
+		min = RTE_MIN(min, lock_count[i]);
+		max = RTE_MAX(max, lock_count[i]);
+	}
+
+	printf("%-16s %2u lcores: %10"PRIu64" ops/ms, "
+	       "min %10"PRIu64" max %10"PRIu64" fairness %.3f\n",
+	       ops->name, n, total / TIME_MS, min, max,
+	       max ? (double)min / max : 0.0);
+}
+
+static int
+test_lock_perf(void)
+{
+	static const unsigned int nb_lcores[] = { 2, 4, 8, 16 };
+	unsigned int i, j;
+
+	rte_brwlock_init(&brwl);
+	ml = NULL;
+
+	if (rte_lcore_count() < 2) {
+		printf("Not enough lcores, need at least 2\n");
+		return -1;
+	}
+
+	printf("\n### Exclusive lock contention ###\n");
+	for (i = 0; i < RTE_DIM(exclusive_ops); i++)
+		for (j = 0; j < RTE_DIM(nb_lcores) &&
+			    nb_lcores[j] <= rte_lcore_count(); j++)
+			run_on_lcores(&exclusive_ops[i], nb_lcores[j]);
+
+	printf("\n### Read-mostly contention (1 write every %u ops) ###\n",
+	       READ_WRITE_RATIO);
+	for (i = 0; i < RTE_DIM(read_mostly_ops); i++)
+		for (j = 0; j < RTE_DIM(nb_lcores) &&
+			    nb_lcores[j] <= rte_lcore_count(); j++)
+			run_on_lcores(&read_mostly_ops[i], nb_lcores[j]);
+
+	return 0;
+}
+
+REGISTER_TEST_COMMAND(lock_perf_autotest, test_lock_perf);
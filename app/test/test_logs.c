@@ -33,6 +33,7 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <stdarg.h>
 #include <sys/queue.h>
 
@@ -56,8 +57,72 @@
  * - Enable log types.
  * - Set log level.
  * - Send logs with different types and levels, some should not be displayed.
+ * - Send logs from a rate-limited site, only the first ones of the burst
+ *   should be displayed.
+ * - Send logs asynchronously, they should all be written or dropped after
+ *   a flush.
  */
 
+#define LOG_RATELIMIT_BURST 3
+#define LOG_RATELIMIT_NUM   10
+#define LOG_ASYNC_NUM       32
+
+static int
+test_logs_ratelimit(void)
+{
+	struct rte_log_stats before, after;
+	unsigned i;
+
+	rte_log_get_stats(&before);
+	for (i = 0; i < LOG_RATELIMIT_NUM; i++)
+		RTE_LOG_RATELIMIT(ERR, TESTAPP1, 60 * 1000, LOG_RATELIMIT_BURST,
+			"rate-limited message %u\n", i);
+	rte_log_get_stats(&after);
+
+	if (after.ratelimited - before.ratelimited !=
+			LOG_RATELIMIT_NUM - LOG_RATELIMIT_BURST) {
+		printf("%"PRIu64" logs suppressed instead of %u\n",
+			after.ratelimited - before.ratelimited,
+			LOG_RATELIMIT_NUM - LOG_RATELIMIT_BURST);
+		return -1;
+	}
+
+	return 0;
+}
+
+static int
+test_logs_async(void)
+{
+	struct rte_log_stats before, after;
+	uint64_t count;
+	unsigned i;
+
+	if (rte_log_async_start() < 0) {
+		printf("Cannot start asynchronous logs\n");
+		return -1;
+	}
+
+	/* don't count the logs already pending */
+	rte_log_async_flush();
+	rte_log_get_stats(&before);
+	for (i = 0; i < LOG_ASYNC_NUM; i++)
+		RTE_LOG(ERR, TESTAPP1, "asynchronous message %u\n", i);
+	rte_log_async_flush();
+	rte_log_get_stats(&after);
+
+	rte_log_async_stop();
+
+	count = (after.async_written - before.async_written) +
+		(after.async_dropped - before.async_dropped);
+	if (count != LOG_ASYNC_NUM) {
+		printf("%"PRIu64" logs written or dropped instead of %u\n",
+			count, LOG_ASYNC_NUM);
+		return -1;
+	}
+
+	return 0;
+}
+
 static int
 test_logs(void)
 {
@@ -83,7 +148,7 @@ test_logs(void)
 	RTE_LOG(ERR, TESTAPP1, "error message\n");
 	RTE_LOG(ERR, TESTAPP2, "error message (not displayed)\n");
 
-	return 0;
+	return test_logs_ratelimit() || test_logs_async();
 }
 
 REGISTER_TEST_COMMAND(logs_autotest, test_logs);
@@ -33,6 +33,7 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <string.h>
 #include <stdarg.h>
 #include <errno.h>
@@ -50,6 +51,7 @@
 #include <rte_malloc.h>
 #include <rte_cycles.h>
 #include <rte_random.h>
+#include <rte_atomic.h>
 #include <rte_string_fns.h>
 
 #include "test.h"
@@ -849,6 +851,76 @@ test_alloc_socket(void)
 	return 0;
 }
 
+/*
+ * Check that small blocks are recycled through the lcore cache, and that
+ * they are still handed out cleared.
+ */
+static int
+test_malloc_cache(void)
+{
+	struct rte_malloc_class_stats pre_stats, post_stats;
+	const size_t size = 200;
+	const unsigned class_id = size <= RTE_CACHE_LINE_SIZE ? 0 :
+		(sizeof(long) * 8 - __builtin_clzl(size - 1)) -
+		RTE_CACHE_LINE_SIZE_LOG2;
+	unsigned char *p1, *p2;
+	size_t i;
+
+	if (rte_malloc_get_class_stats(RTE_MALLOC_CACHE_NUM_CLASSES,
+				&pre_stats) == 0) {
+		printf("Stats returned for an invalid size class\n");
+		return -1;
+	}
+	if (rte_malloc_get_class_stats(class_id, &pre_stats) < 0) {
+		printf("Malloc caches disabled, skipping\n");
+		return 0;
+	}
+	if (pre_stats.size < size || pre_stats.size / 2 >= size) {
+		printf("Wrong size class %zu for %zu bytes\n",
+				pre_stats.size, size);
+		return -1;
+	}
+
+	p1 = rte_malloc(NULL, size, 0);
+	if (p1 == NULL)
+		return -1;
+	memset(p1, 0xa5, size);
+	rte_free(p1);
+
+	/* the block is the most recent of its class, reused first */
+	p2 = rte_zmalloc(NULL, size, 0);
+	if (p2 == NULL)
+		return -1;
+	if (p2 != p1)
+		printf("Cached block not reused\n");
+	for (i = 0; i < size; i++) {
+		if (p2[i] != 0) {
+			printf("Cached block not cleared\n");
+			rte_free(p2);
+			return -1;
+		}
+	}
+	rte_free(p2);
+
+	rte_malloc_get_class_stats(class_id, &post_stats);
+	if (post_stats.alloc_hits + post_stats.alloc_refills !=
+			pre_stats.alloc_hits + pre_stats.alloc_refills + 2 ||
+			post_stats.free_hits + post_stats.free_flushes !=
+			pre_stats.free_hits + pre_stats.free_flushes + 2) {
+		printf("Incorrect cache statistics\n");
+		return -1;
+	}
+
+	rte_malloc_cache_flush();
+	rte_malloc_get_class_stats(class_id, &post_stats);
+	if (post_stats.cached_count > pre_stats.cached_count) {
+		printf("Cache not flushed\n");
+		return -1;
+	}
+
+	return 0;
+}
+
 static int
 test_malloc(void)
 {
@@ -956,7 +1028,146 @@ test_malloc(void)
 	else
 		printf("test_multi_alloc_statistics() passed\n");
 
+	ret = test_malloc_cache();
+	if (ret < 0) {
+		printf("test_malloc_cache() failed\n");
+		return ret;
+	}
+	else
+		printf("test_malloc_cache() passed\n");
+
 	return 0;
 }
 
 REGISTER_TEST_COMMAND(malloc_autotest, test_malloc);
+
+/*
+ * Malloc scalability
+ * ==================
+ *
+ * Each lcore allocates bursts of blocks and frees them, for an increasing
+ * number of lcores. Blocks up to RTE_MALLOC_CACHE_MAX_OBJ_SIZE are served by
+ * the lcore caches, larger ones always go through the locked heap and give
+ * the reference.
+ */
+
+#define MALLOC_PERF_BURST 32
+#define MALLOC_PERF_ITER 2000
+
+static rte_atomic32_t malloc_perf_synchro;
+static uint64_t malloc_perf_cycles[RTE_MAX_LCORE];
+static size_t malloc_perf_min_size, malloc_perf_max_size;
+
+static int
+malloc_perf_per_lcore(__attribute__((unused)) void *arg)
+{
+	const unsigned lcore_id = rte_lcore_id();
+	size_t sizes[MALLOC_PERF_BURST];
+	void *objs[MALLOC_PERF_BURST];
+	uint64_t start;
+	unsigned i, j;
+
+	for (i = 0; i < MALLOC_PERF_BURST; i++)
+		sizes[i] = malloc_perf_min_size + rte_rand() %
+			(malloc_perf_max_size - malloc_perf_min_size + 1);
+
+	if (lcore_id != rte_get_master_lcore())
+		while (rte_atomic32_read(&malloc_perf_synchro) == 0)
+			;
+
+	start = rte_rdtsc();
+	for (i = 0; i < MALLOC_PERF_ITER; i++) {
+		for (j = 0; j < MALLOC_PERF_BURST; j++) {
+			objs[j] = rte_malloc(NULL, sizes[j], 0);
+			if (objs[j] == NULL)
+				break;
+		}
+		while (j-- > 0)
+			rte_free(objs[j]);
+	}
+	malloc_perf_cycles[lcore_id] = rte_rdtsc() - start;
+
+	return 0;
+}
+
+static int
+malloc_perf_launch(unsigned cores)
+{
+	unsigned lcore_id, n;
+	uint64_t cycles = 0;
+	int ret;
+
+	rte_atomic32_set(&malloc_perf_synchro, 0);
+	memset(malloc_perf_cycles, 0, sizeof(malloc_perf_cycles));
+
+	n = cores;
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		if (n == 1)
+			break;
+		n--;
+		rte_eal_remote_launch(malloc_perf_per_lcore, NULL, lcore_id);
+	}
+
+	rte_atomic32_set(&malloc_perf_synchro, 1);
+	ret = malloc_perf_per_lcore(NULL);
+
+	n = cores;
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		if (n == 1)
+			break;
+		n--;
+		if (rte_eal_wait_lcore(lcore_id) < 0)
+			ret = -1;
+	}
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
+		cycles += malloc_perf_cycles[lcore_id];
+
+	printf("sizes=%zu-%zu cores=%u cycles_per_alloc_free=%"PRIu64"\n",
+	       malloc_perf_min_size, malloc_perf_max_size, cores,
+	       cycles / ((uint64_t)cores * MALLOC_PERF_ITER *
+		       MALLOC_PERF_BURST));
+
+	return ret;
+}
+
+static int
+test_malloc_perf(void)
+{
+	const size_t size_tab[][2] = {
+		{ 1, RTE_CACHE_LINE_SIZE },
+		{ 1, 512 },
+		{ 1, RTE_MALLOC_CACHE_MAX_OBJ_SIZE },
+		{ 2 * RTE_MALLOC_CACHE_MAX_OBJ_SIZE,
+			4 * RTE_MALLOC_CACHE_MAX_OBJ_SIZE },
+	};
+	struct rte_malloc_class_stats stats;
+	unsigned cores, class_id, i;
+
+	rte_atomic32_init(&malloc_perf_synchro);
+
+	for (i = 0; i < RTE_DIM(size_tab); i++) {
+		malloc_perf_min_size = size_tab[i][0];
+		malloc_perf_max_size = size_tab[i][1];
+		for (cores = 1; cores <= rte_lcore_count(); cores *= 2) {
+			if (malloc_perf_launch(cores) < 0)
+				return -1;
+		}
+	}
+
+	for (class_id = 0; class_id < RTE_MALLOC_CACHE_NUM_CLASSES;
+			class_id++) {
+		if (rte_malloc_get_class_stats(class_id, &stats) < 0)
+			break;
+		printf("class=%zu cached=%u alloc_hits=%"PRIu64
+		       " alloc_refills=%"PRIu64" free_hits=%"PRIu64
+		       " free_flushes=%"PRIu64"\n", stats.size,
+		       stats.cached_count, stats.alloc_hits,
+		       stats.alloc_refills, stats.free_hits,
+		       stats.free_flushes);
+	}
+
+	return 0;
+}
+
+REGISTER_TEST_COMMAND(malloc_perf_autotest, test_malloc_perf);
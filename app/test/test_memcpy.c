@@ -51,8 +51,8 @@
 /* List of buffer sizes to test */
 #if TEST_VALUE_RANGE == 0
 static size_t buf_sizes[] = {
-	0, 1, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65, 127, 128, 129, 255,
-	256, 257, 320, 384, 511, 512, 513, 1023, 1024, 1025, 1518, 1522, 1600,
+	0, 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 32, 33, 47, 48, 49, 63, 64,
+	65, 127, 128, 129, 255, 256, 257, 320, 384, 511, 512, 513, 1023, 1024, 1025, 1518, 1522, 1600,
 	2048, 3072, 4096, 5120, 6144, 7168, 8192
 };
 /* MUST be as large as largest packet size above */
@@ -148,12 +148,70 @@ func_test(void)
 	return 0;
 }
 
+/*
+ * Check a copy whose size is a compile-time constant, as rte_memcpy() may
+ * use a dedicated code path for it. This is a macro to ensure that "size"
+ * is not converted to a variable.
+ */
+#define SINGLE_CONST_TEST(off_src, off_dst, size)                       \
+do {                                                                    \
+	uint8_t dest[(size) + 2 * ALIGNMENT_UNIT];                      \
+	uint8_t src[(size) + ALIGNMENT_UNIT];                           \
+	unsigned int j;                                                 \
+	memset(dest, 0, sizeof(dest));                                  \
+	for (j = 0; j < sizeof(src); j++)                               \
+		src[j] = (uint8_t) rte_rand();                          \
+	if (rte_memcpy(dest + (off_dst), src + (off_src), size) !=     \
+	    dest + (off_dst) ||                                         \
+	    memcmp(dest + (off_dst), src + (off_src), size) != 0) {    \
+		printf("rte_memcpy() failed for constant %u bytes "     \
+		       "(offsets=%u,%u)\n", (unsigned)(size),           \
+		       (unsigned)(off_src), (unsigned)(off_dst));       \
+		return -1;                                              \
+	}                                                               \
+	for (j = 0; j < (off_dst); j++)                                 \
+		if (dest[j] != 0)                                       \
+			return -1;                                      \
+	for (j = (off_dst) + (size); j < sizeof(dest); j++)             \
+		if (dest[j] != 0)                                       \
+			return -1;                                      \
+} while (0)
+
+#define ALL_CONST_TESTS(off_src, off_dst)                               \
+do {                                                                    \
+	SINGLE_CONST_TEST(off_src, off_dst, 6U);                        \
+	SINGLE_CONST_TEST(off_src, off_dst, 16U);                       \
+	SINGLE_CONST_TEST(off_src, off_dst, 32U);                       \
+	SINGLE_CONST_TEST(off_src, off_dst, 48U);                       \
+	SINGLE_CONST_TEST(off_src, off_dst, 64U);                       \
+	SINGLE_CONST_TEST(off_src, off_dst, 128U);                      \
+	SINGLE_CONST_TEST(off_src, off_dst, 256U);                      \
+	SINGLE_CONST_TEST(off_src, off_dst, 1518U);                     \
+} while (0)
+
+/*
+ * Check functionality for compile-time constant sizes, aligned and not.
+ */
+static int
+func_test_const(void)
+{
+	unsigned int off_src, off_dst;
+
+	for (off_src = 0; off_src < ALIGNMENT_UNIT; off_src++)
+		for (off_dst = 0; off_dst < ALIGNMENT_UNIT; off_dst++)
+			ALL_CONST_TESTS(off_src, off_dst);
+	return 0;
+}
+
 static int
 test_memcpy(void)
 {
 	int ret;
 
 	ret = func_test();
+	if (ret != 0)
+		return -1;
+	ret = func_test_const();
 	if (ret != 0)
 		return -1;
 	return 0;
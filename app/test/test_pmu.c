@@ -0,0 +1,195 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 Freescale Semiconductor, Inc. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of  Freescale Semiconductor, Inc nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_jobstats.h>
+#include <rte_pmu.h>
+
+#include "test.h"
+
+/*
+ * PMU test
+ * ========
+ *
+ * - Check the API without open counters: event names, reads and masks.
+ *
+ * - Open all the counters of the lcore and check that a busy loop makes
+ *   the cycles and instructions counters progress. It is skipped when the
+ *   kernel or the CPU does not provide hardware counters, like in most
+ *   virtual machines.
+ *
+ * - Check that the job statistics library accounts the events to a job.
+ */
+
+#define PMU_LOOPS 100000
+
+static volatile uint64_t pmu_sink;
+
+static void
+pmu_busy_loop(void)
+{
+	unsigned i;
+
+	for (i = 0; i < PMU_LOOPS; i++)
+		pmu_sink += i;
+}
+
+static int
+test_pmu_closed(void)
+{
+	struct rte_pmu_values v;
+	unsigned i;
+
+	for (i = 0; i < RTE_PMU_EVENT_MAX; i++)
+		TEST_ASSERT(rte_pmu_event_name(i) != NULL,
+			"No name for event %u", i);
+	TEST_ASSERT(rte_pmu_event_name(RTE_PMU_EVENT_MAX) == NULL,
+		"Name for an invalid event");
+
+	TEST_ASSERT_EQUAL(rte_pmu_events(), 0, "Counters open at start");
+	TEST_ASSERT_EQUAL(rte_pmu_open(0), -ENOENT,
+		"Opening no event did not fail");
+
+	memset(&v, 0xff, sizeof(v));
+	rte_pmu_read(&v);
+	for (i = 0; i < RTE_PMU_EVENT_MAX; i++)
+		TEST_ASSERT_EQUAL(v.val[i], 0, "Closed counter %u not 0", i);
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_pmu_counting(void)
+{
+	struct rte_pmu_values before, after;
+	uint64_t events;
+	unsigned i;
+
+	events = rte_pmu_events();
+	printf("Counting %d events:", __builtin_popcountll(events));
+	for (i = 0; i < RTE_PMU_EVENT_MAX; i++)
+		if (events & RTE_PMU_EVENT_MASK(i))
+			printf(" %s", rte_pmu_event_name(i));
+	printf("\n");
+
+	TEST_ASSERT_EQUAL(rte_pmu_open(RTE_PMU_ALL_EVENTS), -EBUSY,
+		"Counters opened twice");
+
+	rte_pmu_read(&before);
+	pmu_busy_loop();
+	rte_pmu_read(&after);
+
+	for (i = 0; i < RTE_PMU_EVENT_MAX; i++) {
+		printf("%-14s %" PRIu64 "\n", rte_pmu_event_name(i),
+			after.val[i] - before.val[i]);
+		TEST_ASSERT(after.val[i] >= before.val[i],
+			"Counter %s went backwards", rte_pmu_event_name(i));
+	}
+
+	if (events & RTE_PMU_EVENT_MASK(RTE_PMU_INSTRUCTIONS))
+		TEST_ASSERT(after.val[RTE_PMU_INSTRUCTIONS] -
+			before.val[RTE_PMU_INSTRUCTIONS] >= PMU_LOOPS,
+			"Too few instructions counted");
+	if (events & RTE_PMU_EVENT_MASK(RTE_PMU_CYCLES))
+		TEST_ASSERT(after.val[RTE_PMU_CYCLES] >
+			before.val[RTE_PMU_CYCLES], "No cycle counted");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_pmu_jobstats(void)
+{
+	struct rte_jobstats_context ctx;
+	struct rte_jobstats job;
+
+	TEST_ASSERT_EQUAL(rte_jobstats_context_init(&ctx), 0,
+		"Cannot init context");
+	TEST_ASSERT_EQUAL(rte_jobstats_init(&job, "pmu", 0, 0, 0, 0), 0,
+		"Cannot init job");
+	TEST_ASSERT_EQUAL(rte_jobstats_context_pmu_enable(&ctx,
+		RTE_PMU_ALL_EVENTS), 0, "Cannot enable counters");
+
+	rte_jobstats_context_start(&ctx);
+	TEST_ASSERT_EQUAL(rte_jobstats_start(&ctx, &job), 0,
+		"Cannot start job");
+	pmu_busy_loop();
+	rte_jobstats_finish(&job, 0);
+	rte_jobstats_context_finish(&ctx);
+
+	if (rte_pmu_events() & RTE_PMU_EVENT_MASK(RTE_PMU_INSTRUCTIONS)) {
+		TEST_ASSERT(job.pmu_exec[RTE_PMU_INSTRUCTIONS] >= PMU_LOOPS,
+			"Too few instructions accounted to the job");
+		TEST_ASSERT_EQUAL(job.pmu_exec[RTE_PMU_INSTRUCTIONS],
+			ctx.pmu_exec[RTE_PMU_INSTRUCTIONS],
+			"Job and context events differ");
+	}
+
+	rte_jobstats_reset(&job);
+	TEST_ASSERT_EQUAL(job.pmu_exec[RTE_PMU_INSTRUCTIONS], 0,
+		"Job events not reset");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_pmu(void)
+{
+	int ret;
+
+	if (test_pmu_closed() < 0)
+		return -1;
+
+	ret = rte_pmu_open(RTE_PMU_ALL_EVENTS);
+	if (ret < 0) {
+		printf("Hardware counters not available (%s), skipping\n",
+			strerror(-ret));
+		return 0;
+	}
+
+	ret = test_pmu_counting();
+	if (ret == 0)
+		ret = test_pmu_jobstats();
+	rte_pmu_close();
+
+	TEST_ASSERT_EQUAL(rte_pmu_events(), 0, "Counters still open");
+	return ret;
+}
+
+REGISTER_TEST_COMMAND(pmu_autotest, test_pmu);
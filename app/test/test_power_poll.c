@@ -0,0 +1,285 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 Freescale Semiconductor, Inc. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of  Freescale Semiconductor, Inc nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_lcore.h>
+#include <rte_launch.h>
+#include <rte_ring.h>
+#include <rte_mbuf.h>
+#include <rte_ethdev.h>
+#include <rte_eth_ring.h>
+#include <rte_power_poll.h>
+
+#include "test.h"
+
+/*
+ * Adaptive polling test
+ * =====================
+ *
+ * Two ring ports share a ring: the TX queue of the first port feeds the RX
+ * queue of the second one, which is configured with RX interrupts.
+ *
+ * - A slave lcore polls the RX queue with the adaptive polling library,
+ *   while the master lcore sends timestamped packets with long gaps. The
+ *   slave must sleep between the packets, be woken up by RX interrupts
+ *   and receive all of them. The wake up latency and the CPU use of the
+ *   slave are reported.
+ *
+ * - A queue without RX interrupts falls back to timed sleeps.
+ */
+
+#define POLL_NB_PKTS     16
+#define POLL_GAP_US      20000
+#define POLL_TIMEOUT_S   10
+
+static int poll_port_tx = -1, poll_port_rx = -1;
+static struct rte_mempool *poll_pool;
+
+static volatile int poll_ready;
+static struct rte_power_poll poll_state;
+static unsigned poll_received;
+static uint64_t poll_latency_sum, poll_latency_max, poll_elapsed;
+
+static int
+poll_port_start(int port, int rx_intr)
+{
+	struct rte_eth_conf conf;
+
+	memset(&conf, 0, sizeof(conf));
+	conf.intr_conf.rxq = rx_intr;
+
+	if (rte_eth_dev_configure(port, 1, 1, &conf) < 0 ||
+	    rte_eth_tx_queue_setup(port, 0, 64, SOCKET_ID_ANY, NULL) < 0 ||
+	    rte_eth_rx_queue_setup(port, 0, 64, SOCKET_ID_ANY, NULL,
+			poll_pool) < 0 ||
+	    rte_eth_dev_start(port) < 0) {
+		printf("Cannot start port %d\n", port);
+		return -1;
+	}
+	return 0;
+}
+
+static int
+poll_ports_create(void)
+{
+	struct rte_ring *shared, *rx_a, *tx_b;
+
+	if (poll_port_tx >= 0)
+		return 0;
+
+	poll_pool = rte_pktmbuf_pool_create("test_poll_pool", 63, 0, 0,
+			RTE_MBUF_DEFAULT_BUF_SIZE, SOCKET_ID_ANY);
+	if (poll_pool == NULL) {
+		printf("Cannot create mbuf pool\n");
+		return -1;
+	}
+
+	shared = rte_ring_create("test_poll_shared", 256, SOCKET_ID_ANY, 0);
+	rx_a = rte_ring_create("test_poll_rx_a", 256, SOCKET_ID_ANY, 0);
+	tx_b = rte_ring_create("test_poll_tx_b", 256, SOCKET_ID_ANY, 0);
+	if (shared == NULL || rx_a == NULL || tx_b == NULL) {
+		printf("Cannot create rings\n");
+		return -1;
+	}
+
+	poll_port_tx = rte_eth_from_rings("net_poll_tx", &rx_a, 1, &shared, 1,
+			SOCKET_ID_ANY);
+	poll_port_rx = rte_eth_from_rings("net_poll_rx", &shared, 1, &tx_b, 1,
+			SOCKET_ID_ANY);
+	if (poll_port_tx < 0 || poll_port_rx < 0) {
+		printf("Cannot create ring ports\n");
+		return -1;
+	}
+	return 0;
+}
+
+static int
+poll_slave(__attribute__((unused)) void *arg)
+{
+	struct rte_power_poll_conf conf = {
+		.idle_polls = 64,
+		.max_sleep_ms = 1000,
+		.fallback_sleep_us = 100,
+	};
+	struct rte_mbuf *pkts[POLL_NB_PKTS];
+	uint64_t start, now, lat;
+	uint16_t nb_rx, i;
+
+	rte_power_poll_init(&poll_state, &conf);
+	if (rte_power_poll_queue_add(&poll_state, poll_port_rx, 0) != 0) {
+		printf("RX interrupt not available on the ring port\n");
+		poll_ready = -1;
+		return -1;
+	}
+	poll_ready = 1;
+
+	start = rte_rdtsc();
+	now = start;
+	while (poll_received < POLL_NB_PKTS &&
+	       now - start < POLL_TIMEOUT_S * rte_get_tsc_hz()) {
+		nb_rx = rte_eth_rx_burst(poll_port_rx, 0, pkts, POLL_NB_PKTS);
+		now = rte_rdtsc();
+		for (i = 0; i < nb_rx; i++) {
+			lat = now - pkts[i]->udata64;
+			poll_latency_sum += lat;
+			if (lat > poll_latency_max)
+				poll_latency_max = lat;
+			rte_pktmbuf_free(pkts[i]);
+		}
+		poll_received += nb_rx;
+		rte_power_poll_update(&poll_state, nb_rx);
+	}
+	poll_elapsed = rte_rdtsc() - start;
+
+	rte_power_poll_release(&poll_state);
+	return 0;
+}
+
+static int
+test_power_poll_wakeup(void)
+{
+	struct rte_power_poll_stats *stats = &poll_state.stats;
+	struct rte_mbuf *m;
+	unsigned slave, i;
+	double us = 1E6 / rte_get_tsc_hz();
+
+	slave = rte_get_next_lcore(rte_lcore_id(), 1, 0);
+	if (slave >= RTE_MAX_LCORE) {
+		printf("Not enough lcores, skipping the wake up test\n");
+		return 0;
+	}
+
+	poll_ready = 0;
+	poll_received = 0;
+	poll_latency_sum = 0;
+	poll_latency_max = 0;
+	rte_eal_remote_launch(poll_slave, NULL, slave);
+	while (poll_ready == 0)
+		rte_pause();
+	if (poll_ready < 0) {
+		rte_eal_wait_lcore(slave);
+		return -1;
+	}
+
+	for (i = 0; i < POLL_NB_PKTS; i++) {
+		usleep(POLL_GAP_US);
+		m = rte_pktmbuf_alloc(poll_pool);
+		if (m == NULL) {
+			printf("Cannot allocate packet %u\n", i);
+			break;
+		}
+		m->udata64 = rte_rdtsc();
+		if (rte_eth_tx_burst(poll_port_tx, 0, &m, 1) != 1) {
+			printf("Cannot send packet %u\n", i);
+			rte_pktmbuf_free(m);
+			break;
+		}
+	}
+
+	rte_eal_wait_lcore(slave);
+
+	printf("Received %u packets, %" PRIu64 " polls (%" PRIu64 " empty), "
+		"%" PRIu64 " sleeps, %" PRIu64 " woken up by interrupts\n",
+		poll_received, stats->polls, stats->empty_polls,
+		stats->sleeps, stats->intr_wakeups);
+	if (poll_received != 0)
+		printf("Latency: average %.1f us, max %.1f us\n",
+			poll_latency_sum * us / poll_received,
+			poll_latency_max * us);
+	printf("CPU use: %.1f%%\n",
+		100.0 - 100.0 * stats->sleep_cycles / poll_elapsed);
+
+	TEST_ASSERT_EQUAL(poll_received, POLL_NB_PKTS,
+		"Received %u packets out of %u", poll_received, POLL_NB_PKTS);
+	TEST_ASSERT(stats->sleeps > 0, "The slave never slept");
+	TEST_ASSERT(stats->intr_wakeups > 0,
+		"The slave was never woken up by an interrupt");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_power_poll_fallback(void)
+{
+	struct rte_power_poll_conf conf = {
+		.idle_polls = 2,
+		.max_sleep_ms = 1000,
+		.fallback_sleep_us = 10,
+	};
+	struct rte_power_poll pp;
+
+	TEST_ASSERT_EQUAL(rte_power_poll_init(&pp, &conf), 0,
+		"Cannot init adaptive polling");
+	TEST_ASSERT_EQUAL(rte_power_poll_queue_add(&pp, poll_port_tx, 0), 1,
+		"Queue without interrupt not detected");
+	TEST_ASSERT_EQUAL(rte_power_poll_queue_add(&pp, RTE_MAX_ETHPORTS,
+		0), -EINVAL, "Invalid port accepted");
+
+	TEST_ASSERT_EQUAL(rte_power_poll_update(&pp, 0), 0, "Slept too early");
+	TEST_ASSERT_EQUAL(rte_power_poll_update(&pp, 0), 1, "Did not sleep");
+	TEST_ASSERT_EQUAL(rte_power_poll_update(&pp, 1), 0, "Slept on traffic");
+	TEST_ASSERT_EQUAL(rte_power_poll_update(&pp, 0), 0, "Slept too early");
+	TEST_ASSERT_EQUAL(pp.stats.sleeps, 1, "Wrong number of sleeps");
+	TEST_ASSERT_EQUAL(pp.stats.polls, 4, "Wrong number of polls");
+
+	rte_power_poll_release(&pp);
+	return TEST_SUCCESS;
+}
+
+static int
+test_power_poll(void)
+{
+	int ret;
+
+	if (poll_ports_create() < 0)
+		return -1;
+	if (poll_port_start(poll_port_tx, 0) < 0 ||
+	    poll_port_start(poll_port_rx, 1) < 0)
+		return -1;
+
+	ret = test_power_poll_fallback();
+	if (ret == 0)
+		ret = test_power_poll_wakeup();
+
+	rte_eth_dev_stop(poll_port_rx);
+	rte_eth_dev_stop(poll_port_tx);
+	return ret;
+}
+
+REGISTER_TEST_COMMAND(power_poll_autotest, test_power_poll);
@@ -0,0 +1,371 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2017 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+
+#include "test.h"
+
+/* The QBMan portal headers come with the platform DMA address type */
+typedef uint64_t dma_addr_t;
+
+#include <fsl_qbman_portal.h>
+#include <fsl_qbman_sw.h>
+#include <portal/pull_ring.h>
+
+#define PULL_FQID	0x100
+#define PULL_NB_QUEUES	16
+#define PULL_BPID	5
+
+/* Frame address, from the queue and the rank of the frame in it */
+#define PULL_ADDR(q, n)	(0x10000000ULL + ((uint64_t)(q) << 16) + (n) * 64)
+
+static struct qbman_swp *swp;
+static struct pull_ring ring;
+static unsigned int queue_id[PULL_NB_QUEUES];
+static uint64_t deadline;
+/* Let the emulator thread run when it has no CPU of its own */
+static int test_yield;
+
+static inline int
+test_expired(void)
+{
+	if (test_yield)
+		sched_yield();
+	return rte_get_timer_cycles() > deadline;
+}
+
+static void
+test_enqueue(unsigned int q, unsigned int first, unsigned int num)
+{
+	struct qbman_fd fd;
+	uint64_t addr;
+	unsigned int i;
+
+	for (i = first; i < first + num; i++) {
+		addr = PULL_ADDR(q, i);
+		memset(&fd, 0, sizeof(fd));
+		fd.simple.addr_lo = (uint32_t)addr;
+		fd.simple.addr_hi = (uint32_t)(addr >> 32);
+		fd.simple.len = 64;
+		fd.simple.bpid_offset = PULL_BPID;
+		qbman_sw_fq_enqueue(PULL_FQID + q, &fd, 1);
+	}
+}
+
+/*
+ * Poll the ring as a receive would, until @num frames are received or
+ * nothing came for a while. Checks the frames of each queue come in order.
+ */
+static int
+test_receive(unsigned int *count, unsigned int num, unsigned int *max_depth)
+{
+	const struct qbman_result *dq;
+	const struct qbman_fd *fd;
+	unsigned int total = 0, q;
+	void *queue;
+	uint64_t addr;
+
+	deadline = rte_get_timer_cycles() + rte_get_timer_hz() / 10;
+	while (total < num && !test_expired()) {
+		pull_ring_issue(&ring);
+		if (max_depth && pull_ring_count(&ring) > *max_depth)
+			*max_depth = pull_ring_count(&ring);
+		while ((dq = pull_ring_next(&ring, &queue)) != NULL) {
+			TEST_ASSERT_NOT_NULL(queue, "Frame of no queue");
+			q = *(unsigned int *)queue;
+			TEST_ASSERT_EQUAL(qbman_result_DQ_fqid(dq),
+					  PULL_FQID + q, "Frame of another FQ");
+			fd = qbman_result_DQ_fd(dq);
+			addr = ((uint64_t)fd->simple.addr_hi << 32) |
+				fd->simple.addr_lo;
+			TEST_ASSERT_EQUAL(addr, PULL_ADDR(q, count[q]),
+					  "Frame %u of queue %u out of order",
+					  count[q], q);
+			count[q]++;
+			total++;
+		}
+	}
+	return TEST_SUCCESS;
+}
+
+static int
+test_pull_ring_setup(void)
+{
+	struct qbman_swp_desc desc;
+	unsigned int q;
+
+	test_yield = sysconf(_SC_NPROCESSORS_ONLN) < 2;
+	memset(&desc, 0, sizeof(desc));
+	desc.idx = 0;
+	desc.qman_version = QMAN_REV_4100;
+	desc.eqcr_mode = qman_eqcr_vb_ring;
+	swp = qbman_swp_init(&desc);
+	TEST_ASSERT_NOT_NULL(swp, "Software portal not created");
+	qbman_sw_reset();
+	pull_ring_init(&ring, swp, (uint64_t)(uintptr_t)ring.storage);
+	for (q = 0; q < PULL_NB_QUEUES; q++) {
+		queue_id[q] = q;
+		TEST_ASSERT_SUCCESS(qbman_sw_fq_config(PULL_FQID + q, 0, q),
+				    "FQ not configured");
+	}
+	return TEST_SUCCESS;
+}
+
+static void
+test_pull_ring_teardown(void)
+{
+	unsigned int count[PULL_NB_QUEUES];
+
+	/* Read the outstanding pulls, before the portal goes */
+	memset(count, 0, sizeof(count));
+	ring.nb_queues = 0;
+	test_receive(count, UINT32_MAX, NULL);
+	qbman_swp_finish(swp);
+	qbman_sw_reset();
+}
+
+/* Frames of all the queues come from one ring, each queue in order */
+static int
+test_pull_ring_queues(void)
+{
+	unsigned int count[PULL_NB_QUEUES], total = 0, depth = 0, q;
+
+	for (q = 0; q < PULL_NB_QUEUES; q++) {
+		test_enqueue(q, 0, q * 5 + 1);
+		total += q * 5 + 1;
+		TEST_ASSERT_SUCCESS(pull_ring_add_queue(&ring, PULL_FQID + q,
+							&queue_id[q]),
+				    "Queue not added");
+	}
+	memset(count, 0, sizeof(count));
+	TEST_ASSERT_SUCCESS(test_receive(count, total, &depth),
+			    "Receive failed");
+	for (q = 0; q < PULL_NB_QUEUES; q++)
+		TEST_ASSERT_EQUAL(count[q], q * 5 + 1,
+				  "Queue %u: %u frames received", q, count[q]);
+	TEST_ASSERT(depth > 1, "Pulls not pipelined");
+	TEST_ASSERT(depth <= PULL_RING_SIZE, "%u pulls outstanding", depth);
+
+	/* Frames arriving on a queue after its pulls came back empty */
+	test_enqueue(3, count[3], 40);
+	TEST_ASSERT_SUCCESS(test_receive(count, 40, NULL), "Receive failed");
+	TEST_ASSERT_EQUAL(count[3], 3 * 5 + 1 + 40, "Late frames lost");
+
+	return TEST_SUCCESS;
+}
+
+/* Idle queues: one pull outstanding per queue at most, all empty */
+static int
+test_pull_ring_idle(void)
+{
+	unsigned int count[PULL_NB_QUEUES], depth = 0, q;
+
+	for (q = 0; q < 3; q++)
+		TEST_ASSERT_SUCCESS(pull_ring_add_queue(&ring, PULL_FQID + q,
+							&queue_id[q]),
+				    "Queue not added");
+	memset(count, 0, sizeof(count));
+	TEST_ASSERT_SUCCESS(test_receive(count, 1, &depth), "Receive failed");
+	TEST_ASSERT_EQUAL(count[0] + count[1] + count[2], 0,
+			  "Frames from empty queues");
+	TEST_ASSERT(depth <= 3, "%u pulls outstanding on 3 queues", depth);
+	TEST_ASSERT(ring.stats.pulls > 3, "Pulls not issued again");
+	TEST_ASSERT(ring.stats.empty + pull_ring_count(&ring) ==
+		    ring.stats.pulls, "Empty pulls not counted");
+
+	for (q = 3; q < PULL_RING_MAX_QUEUES; q++)
+		TEST_ASSERT_SUCCESS(pull_ring_add_queue(&ring, PULL_FQID + q,
+							&queue_id[0]),
+				    "Queue not added");
+	TEST_ASSERT_EQUAL(pull_ring_add_queue(&ring, PULL_FQID, &queue_id[0]),
+			  -ENOSPC, "Queue added to a full ring");
+
+	return TEST_SUCCESS;
+}
+
+/* A deleted queue is no longer pulled, its outstanding frames come back */
+static int
+test_pull_ring_del(void)
+{
+	const struct qbman_result *dq;
+	unsigned int count[PULL_NB_QUEUES], orphans = 0;
+	void *queue;
+
+	test_enqueue(0, 0, PULL_RING_NUM_DQ + 4);
+	test_enqueue(1, 0, 8);
+	TEST_ASSERT_SUCCESS(pull_ring_add_queue(&ring, PULL_FQID,
+						&queue_id[0]),
+			    "Queue not added");
+	TEST_ASSERT_EQUAL(pull_ring_issue(&ring), 1, "Pull not issued");
+	TEST_ASSERT_SUCCESS(pull_ring_add_queue(&ring, PULL_FQID + 1,
+						&queue_id[1]),
+			    "Queue not added");
+	pull_ring_del_queue(&ring, &queue_id[0]);
+	TEST_ASSERT_EQUAL(ring.nb_queues, 1, "Queue not deleted");
+
+	deadline = rte_get_timer_cycles() + rte_get_timer_hz();
+	while (orphans < PULL_RING_NUM_DQ) {
+		dq = pull_ring_next(&ring, &queue);
+		if (!dq) {
+			TEST_ASSERT(!test_expired(), "Frames of queue 0 lost");
+			continue;
+		}
+		TEST_ASSERT_NULL(queue, "Frame of a deleted queue");
+		orphans++;
+	}
+
+	memset(count, 0, sizeof(count));
+	TEST_ASSERT_SUCCESS(test_receive(count, 8, NULL), "Receive failed");
+	TEST_ASSERT_EQUAL(count[1], 8, "Queue 1: %u frames", count[1]);
+	TEST_ASSERT_EQUAL(qbman_sw_fq_count(PULL_FQID), 4,
+			  "Deleted queue pulled again");
+
+	return TEST_SUCCESS;
+}
+
+/* A stopped queue is no longer pulled, its pending frames keep its queue */
+static int
+test_pull_ring_stop(void)
+{
+	const struct qbman_result *dq;
+	unsigned int count[PULL_NB_QUEUES], drained = 0;
+	void *queue;
+
+	test_enqueue(0, 0, PULL_RING_NUM_DQ + 4);
+	TEST_ASSERT_SUCCESS(pull_ring_add_queue(&ring, PULL_FQID,
+						&queue_id[0]),
+			    "Queue not added");
+	TEST_ASSERT_SUCCESS(pull_ring_add_queue(&ring, PULL_FQID + 1,
+						&queue_id[1]),
+			    "Queue not added");
+	TEST_ASSERT_EQUAL(pull_ring_issue(&ring), 1, "Pull not issued");
+	pull_ring_stop_queue(&ring, &queue_id[0]);
+	TEST_ASSERT_EQUAL(ring.nb_queues, 1, "Queue not stopped");
+	TEST_ASSERT_EQUAL(pull_ring_queue_pending(&ring, &queue_id[0]), 1,
+			  "Pull of the stopped queue not pending");
+	TEST_ASSERT_EQUAL(pull_ring_queue_pending(&ring, &queue_id[1]), 0,
+			  "Pull of another queue pending");
+
+	deadline = rte_get_timer_cycles() + rte_get_timer_hz();
+	while (pull_ring_queue_pending(&ring, &queue_id[0])) {
+		dq = pull_ring_next(&ring, &queue);
+		if (!dq) {
+			TEST_ASSERT(!test_expired(), "Frames of queue 0 lost");
+			continue;
+		}
+		TEST_ASSERT(queue == &queue_id[0], "Frame of another queue");
+		drained++;
+	}
+	TEST_ASSERT_EQUAL(drained, PULL_RING_NUM_DQ, "%u frames drained",
+			  drained);
+
+	memset(count, 0, sizeof(count));
+	TEST_ASSERT_SUCCESS(test_receive(count, 1, NULL), "Receive failed");
+	TEST_ASSERT_EQUAL(qbman_sw_fq_count(PULL_FQID), 4,
+			  "Stopped queue pulled again");
+
+	return TEST_SUCCESS;
+}
+
+/* A pull of another user holds the portal until it is seen fetched */
+static int
+test_pull_ring_busy(void)
+{
+	static struct qbman_result other[PULL_RING_NUM_DQ] __rte_aligned(64);
+	struct qbman_pull_desc pulldesc;
+	unsigned int count[PULL_NB_QUEUES];
+
+	TEST_ASSERT_SUCCESS(pull_ring_add_queue(&ring, PULL_FQID + 1,
+						&queue_id[1]),
+			    "Queue not added");
+	test_enqueue(1, 0, 4);
+
+	memset(other, 0, sizeof(other));
+	qbman_pull_desc_clear(&pulldesc);
+	qbman_pull_desc_set_numframes(&pulldesc, 1);
+	qbman_pull_desc_set_fq(&pulldesc, PULL_FQID);
+	qbman_pull_desc_set_storage(&pulldesc, other, (dma_addr_t)other, 1);
+	TEST_ASSERT_SUCCESS(qbman_swp_pull(swp, &pulldesc), "Pull failed");
+
+	TEST_ASSERT_EQUAL(pull_ring_issue(&ring), 0, "Pull issued on a busy "
+			  "portal");
+	TEST_ASSERT_EQUAL(ring.stats.busy, 1, "Busy portal not counted");
+	TEST_ASSERT_NULL(pull_ring_pending(&ring), "Pull pending");
+
+	deadline = rte_get_timer_cycles() + rte_get_timer_hz();
+	while (!qbman_check_command_complete(swp, other))
+		TEST_ASSERT(!test_expired(), "Pull not fetched");
+	while (!qbman_result_has_new_result(swp, other))
+		TEST_ASSERT(!test_expired(), "No pull result");
+
+	memset(count, 0, sizeof(count));
+	TEST_ASSERT_SUCCESS(test_receive(count, 4, NULL), "Receive failed");
+	TEST_ASSERT_EQUAL(count[1], 4, "Queue 1: %u frames", count[1]);
+
+	return TEST_SUCCESS;
+}
+
+static struct unit_test_suite pull_ring_testsuite  = {
+	.suite_name = "QBMan Pull Ring Unit Test Suite",
+	.setup = NULL,
+	.teardown = NULL,
+	.unit_test_cases = {
+		TEST_CASE_ST(test_pull_ring_setup, test_pull_ring_teardown,
+			     test_pull_ring_queues),
+		TEST_CASE_ST(test_pull_ring_setup, test_pull_ring_teardown,
+			     test_pull_ring_idle),
+		TEST_CASE_ST(test_pull_ring_setup, test_pull_ring_teardown,
+			     test_pull_ring_del),
+		TEST_CASE_ST(test_pull_ring_setup, test_pull_ring_teardown,
+			     test_pull_ring_stop),
+		TEST_CASE_ST(test_pull_ring_setup, test_pull_ring_teardown,
+			     test_pull_ring_busy),
+
+		TEST_CASES_END() /**< NULL terminate unit test array */
+	}
+};
+
+static int
+test_pull_ring(void)
+{
+	return unit_test_suite_runner(&pull_ring_testsuite);
+}
+
+REGISTER_TEST_COMMAND(pull_ring_autotest, test_pull_ring);
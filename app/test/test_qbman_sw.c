@@ -0,0 +1,374 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2017 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+
+#include "test.h"
+
+/* The QBMan portal headers come with the platform DMA address type */
+typedef uint64_t dma_addr_t;
+
+#include <fsl_qbman_portal.h>
+#include <fsl_qbman_sw.h>
+
+#define TEST_FQID	0x40
+#define TEST_BPID	3
+#define TEST_QDID	7
+#define TEST_CTX	0x1122334455667788ULL
+#define TEST_PERF_ITER	10000
+
+static struct qbman_swp *swp;
+static struct qbman_result storage[16] __rte_aligned(64);
+static uint64_t deadline;
+/* Let the emulator thread run when it has no CPU of its own */
+static int test_yield;
+
+static inline int
+test_expired(void)
+{
+	if (test_yield)
+		sched_yield();
+	return rte_get_timer_cycles() > deadline;
+}
+
+#define TEST_POLL(cond, msg, ...) do {					\
+	deadline = rte_get_timer_cycles() + rte_get_timer_hz();	\
+	while (!(cond))							\
+		TEST_ASSERT(!test_expired(), msg, ##__VA_ARGS__);	\
+} while (0)
+
+static void
+test_fd(struct qbman_fd *fd, uint64_t addr, uint32_t len, uint32_t bpid)
+{
+	memset(fd, 0, sizeof(*fd));
+	fd->simple.addr_lo = (uint32_t)addr;
+	fd->simple.addr_hi = (uint32_t)(addr >> 32);
+	fd->simple.len = len;
+	fd->simple.bpid_offset = bpid;
+}
+
+static int
+test_send(const struct qbman_eq_desc *eqdesc, const struct qbman_fd *fd,
+	  int num)
+{
+	int sent = 0;
+
+	deadline = rte_get_timer_cycles() + rte_get_timer_hz();
+	while (sent < num) {
+		sent += qbman_swp_send_multiple(swp, eqdesc, &fd[sent],
+						num - sent);
+		TEST_ASSERT(!test_expired(), "Enqueue ring stuck");
+	}
+	return TEST_SUCCESS;
+}
+
+/* Volatile dequeue to storage, as done by the DPAA2 PMDs. Returns the number
+ * of frames, or -1.
+ */
+static int
+test_pull(uint32_t fqid, uint8_t num, struct qbman_fd *fd, uint8_t *flags)
+{
+	struct qbman_pull_desc pulldesc;
+	struct qbman_result *dq = storage;
+	int n = 0;
+
+	qbman_pull_desc_clear(&pulldesc);
+	qbman_pull_desc_set_numframes(&pulldesc, num);
+	qbman_pull_desc_set_fq(&pulldesc, fqid);
+	qbman_pull_desc_set_storage(&pulldesc, dq, (dma_addr_t)dq, 1);
+	if (qbman_swp_pull(swp, &pulldesc))
+		return -1;
+
+	deadline = rte_get_timer_cycles() + rte_get_timer_hz();
+	while (!qbman_check_command_complete(swp, dq))
+		if (test_expired())
+			return -1;
+	while (1) {
+		while (!qbman_result_has_new_result(swp, dq))
+			if (test_expired())
+				return -1;
+		*flags = qbman_result_DQ_flags(dq);
+		if (*flags & QBMAN_DQ_STAT_VALIDFRAME) {
+			if (qbman_result_DQ_fqid(dq) != fqid ||
+			    qbman_result_DQ_fqd_ctx(dq) != TEST_CTX)
+				return -1;
+			fd[n++] = *qbman_result_DQ_fd(dq);
+		}
+		if (qbman_result_DQ_is_pull_complete(dq))
+			return n;
+		dq++;
+	}
+}
+
+static int
+test_qbman_sw_setup(void)
+{
+	struct qbman_swp_desc desc;
+
+	test_yield = sysconf(_SC_NPROCESSORS_ONLN) < 2;
+	memset(&desc, 0, sizeof(desc));
+	desc.idx = 0;
+	desc.qman_version = QMAN_REV_4100;
+	desc.eqcr_mode = qman_eqcr_vb_ring;
+	swp = qbman_swp_init(&desc);
+	TEST_ASSERT_NOT_NULL(swp, "Software portal not created");
+	qbman_sw_reset();
+	TEST_ASSERT_SUCCESS(qbman_sw_fq_config(TEST_FQID, 0, TEST_CTX),
+			    "FQ not configured");
+	return TEST_SUCCESS;
+}
+
+static void
+test_qbman_sw_teardown(void)
+{
+	qbman_swp_finish(swp);
+	qbman_sw_reset();
+}
+
+static int
+test_qbman_sw_release_acquire(void)
+{
+	struct qbman_release_desc releasedesc;
+	uint64_t bufs[7], got[7];
+	int i, j, ret;
+
+	qbman_release_desc_clear(&releasedesc);
+	qbman_release_desc_set_bpid(&releasedesc, TEST_BPID);
+	for (i = 0; i < 3; i++) {
+		for (j = 0; j < 7; j++)
+			bufs[j] = 0x1000 * (i * 7 + j + 1);
+		TEST_POLL(!qbman_swp_release(swp, &releasedesc, bufs, 7),
+			  "Release ring stuck");
+	}
+	TEST_POLL(qbman_sw_bp_count(TEST_BPID) == 21, "Buffers not released");
+
+	/* Last released, first acquired */
+	for (i = 2; i >= 0; i--) {
+		ret = qbman_swp_acquire(swp, TEST_BPID, got, 7);
+		TEST_ASSERT_EQUAL(ret, 7, "Acquired %d buffers", ret);
+		for (j = 0; j < 7; j++)
+			TEST_ASSERT_EQUAL(got[j],
+					  (uint64_t)0x1000 * (i * 7 + 6 - j + 1),
+					  "Wrong buffer acquired");
+	}
+	ret = qbman_swp_acquire(swp, TEST_BPID, got, 7);
+	TEST_ASSERT_EQUAL(ret, 0, "Acquired from an empty pool");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_qbman_sw_enqueue_pull(void)
+{
+	struct qbman_eq_desc eqdesc;
+	struct qbman_fd fd[20], rx[16];
+	uint8_t flags;
+	int i, ret;
+
+	for (i = 0; i < 20; i++)
+		test_fd(&fd[i], 0x100000 + i * 0x800, 64 + i, TEST_BPID);
+	qbman_eq_desc_clear(&eqdesc);
+	qbman_eq_desc_set_no_orp(&eqdesc, 0);
+	qbman_eq_desc_set_fq(&eqdesc, TEST_FQID);
+	TEST_ASSERT_SUCCESS(test_send(&eqdesc, fd, 20), "Enqueue failed");
+	TEST_POLL(qbman_sw_fq_count(TEST_FQID) == 20, "Frames not enqueued");
+
+	ret = test_pull(TEST_FQID, 16, rx, &flags);
+	TEST_ASSERT_EQUAL(ret, 16, "Dequeued %d frames", ret);
+	TEST_ASSERT(!(flags & QBMAN_DQ_STAT_FQEMPTY), "FQ empty too early");
+	for (i = 0; i < 16; i++)
+		TEST_ASSERT_BUFFERS_ARE_EQUAL(&rx[i], &fd[i], sizeof(rx[i]),
+					      "Frame %d corrupted", i);
+
+	/* The dequeue expires as the FQ gets empty */
+	ret = test_pull(TEST_FQID, 16, rx, &flags);
+	TEST_ASSERT_EQUAL(ret, 4, "Dequeued %d frames", ret);
+	TEST_ASSERT(flags & QBMAN_DQ_STAT_FQEMPTY, "FQ not reported empty");
+	TEST_ASSERT_BUFFERS_ARE_EQUAL(rx, &fd[16], 4 * sizeof(rx[0]),
+				      "Frames corrupted");
+
+	/* Nothing left, a single result without frame */
+	ret = test_pull(TEST_FQID, 16, rx, &flags);
+	TEST_ASSERT_EQUAL(ret, 0, "Dequeued %d frames", ret);
+	TEST_ASSERT_EQUAL((flags & QBMAN_DQ_STAT_EXPIRED),
+			  QBMAN_DQ_STAT_EXPIRED, "Dequeue not expired");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_qbman_sw_dqrr(void)
+{
+	struct qbman_eq_desc eqdesc;
+	struct qbman_pull_desc pulldesc;
+	const struct qbman_result *dq;
+	struct qbman_fd fd;
+	int i = 0;
+
+	qbman_eq_desc_clear(&eqdesc);
+	qbman_eq_desc_set_no_orp(&eqdesc, 0);
+	qbman_eq_desc_set_fq(&eqdesc, TEST_FQID);
+	for (i = 0; i < 12; i++) {
+		test_fd(&fd, 0x200000 + i * 0x800, 128, TEST_BPID);
+		TEST_POLL(!qbman_swp_enqueue(swp, &eqdesc, &fd),
+			  "Enqueue ring stuck");
+	}
+	TEST_POLL(qbman_sw_fq_count(TEST_FQID) == 12, "Frames not enqueued");
+
+	/* More frames than DQRR entries, which are recycled once consumed */
+	qbman_pull_desc_clear(&pulldesc);
+	qbman_pull_desc_set_numframes(&pulldesc, 12);
+	qbman_pull_desc_set_fq(&pulldesc, TEST_FQID);
+	qbman_pull_desc_set_storage(&pulldesc, NULL, 0, 0);
+	TEST_ASSERT_SUCCESS(qbman_swp_pull(swp, &pulldesc), "Pull failed");
+	for (i = 0; i < 12; i++) {
+		TEST_POLL((dq = qbman_swp_dqrr_next(swp)) != NULL,
+			  "No DQRR entry %d", i);
+		TEST_ASSERT(qbman_result_is_DQ(dq), "Not a dequeue result");
+		TEST_ASSERT_EQUAL(qbman_result_DQ_fqid(dq), TEST_FQID,
+				  "Wrong FQID");
+		TEST_ASSERT_EQUAL(qbman_result_DQ_fd(dq)->simple.addr_lo,
+				  0x200000U + i * 0x800, "Wrong frame");
+		TEST_ASSERT_EQUAL(!!qbman_result_DQ_is_pull_complete(dq),
+				  (i == 11), "Wrong dequeue expiry");
+		qbman_swp_dqrr_consume(swp, dq);
+	}
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_qbman_sw_qd(void)
+{
+	struct qbman_eq_desc eqdesc;
+	struct qbman_fd fd[8];
+	int i;
+
+	/* Transmit, the buffers go back to their pool, but for IVP frames */
+	for (i = 0; i < 8; i++) {
+		test_fd(&fd[i], 0x300000 + i * 0x800, 60, TEST_BPID);
+		if (i & 1)
+			fd[i].simple.bpid_offset |= 0x4000;
+	}
+	TEST_ASSERT_SUCCESS(qbman_sw_qd_config(TEST_QDID, 0, 0),
+			    "QD not configured");
+	qbman_eq_desc_clear(&eqdesc);
+	qbman_eq_desc_set_no_orp(&eqdesc, 0);
+	qbman_eq_desc_set_qd(&eqdesc, TEST_QDID, 0, 0);
+	TEST_ASSERT_SUCCESS(test_send(&eqdesc, fd, 8), "Enqueue failed");
+	TEST_POLL(qbman_sw_qd_tx_count(TEST_QDID) == 8,
+		  "Frames not transmitted");
+	TEST_ASSERT_EQUAL(qbman_sw_bp_count(TEST_BPID), 4,
+			  "Buffers not freed on transmit");
+
+	/* Bins and priorities of a QD mapped to FQs */
+	TEST_ASSERT_SUCCESS(qbman_sw_qd_config(TEST_QDID, TEST_FQID, 4),
+			    "QD not configured");
+	qbman_eq_desc_set_qd(&eqdesc, TEST_QDID, 1, 2);
+	TEST_ASSERT_SUCCESS(test_send(&eqdesc, fd, 8), "Enqueue failed");
+	TEST_POLL(qbman_sw_fq_count(TEST_FQID + 2 * 4 + 1) == 8,
+		  "Frames not sent to the FQ of the bin");
+
+	return TEST_SUCCESS;
+}
+
+/* Cycles of a burst enqueue and dequeue through the portal, per frame */
+static int
+test_qbman_sw_perf(void)
+{
+	struct qbman_eq_desc eqdesc;
+	struct qbman_fd fd[16], rx[16];
+	uint64_t start, cycles = 0;
+	unsigned int burst, i;
+	uint8_t flags;
+
+	for (i = 0; i < 16; i++)
+		test_fd(&fd[i], 0x400000 + i * 0x800, 64, TEST_BPID);
+	qbman_eq_desc_clear(&eqdesc);
+	qbman_eq_desc_set_no_orp(&eqdesc, 0);
+	qbman_eq_desc_set_fq(&eqdesc, TEST_FQID);
+
+	for (burst = 1; burst <= 16; burst *= 4) {
+		cycles = 0;
+		for (i = 0; i < TEST_PERF_ITER; i++) {
+			start = rte_rdtsc_precise();
+			TEST_ASSERT_SUCCESS(test_send(&eqdesc, fd, burst),
+					    "Enqueue failed");
+			TEST_POLL(qbman_sw_fq_count(TEST_FQID) == burst,
+				  "Frames not enqueued");
+			TEST_ASSERT_EQUAL(test_pull(TEST_FQID, burst, rx,
+						    &flags), (int)burst,
+					  "Dequeue failed");
+			cycles += rte_rdtsc_precise() - start;
+		}
+		printf("Burst of %2u: %"PRIu64" cycles per frame\n",
+		       burst, cycles / ((uint64_t)TEST_PERF_ITER * burst));
+	}
+
+	return TEST_SUCCESS;
+}
+
+static struct unit_test_suite qbman_sw_testsuite  = {
+	.suite_name = "Software QBMan Portal Unit Test Suite",
+	.setup = NULL,
+	.teardown = NULL,
+	.unit_test_cases = {
+		TEST_CASE_ST(test_qbman_sw_setup, test_qbman_sw_teardown,
+			     test_qbman_sw_release_acquire),
+		TEST_CASE_ST(test_qbman_sw_setup, test_qbman_sw_teardown,
+			     test_qbman_sw_enqueue_pull),
+		TEST_CASE_ST(test_qbman_sw_setup, test_qbman_sw_teardown,
+			     test_qbman_sw_dqrr),
+		TEST_CASE_ST(test_qbman_sw_setup, test_qbman_sw_teardown,
+			     test_qbman_sw_qd),
+		TEST_CASE_ST(test_qbman_sw_setup, test_qbman_sw_teardown,
+			     test_qbman_sw_perf),
+
+		TEST_CASES_END() /**< NULL terminate unit test array */
+	}
+};
+
+static int
+test_qbman_sw(void)
+{
+	return unit_test_suite_runner(&qbman_sw_testsuite);
+}
+
+REGISTER_TEST_COMMAND(qbman_sw_autotest, test_qbman_sw);
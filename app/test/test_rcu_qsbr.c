@@ -0,0 +1,333 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 Freescale Semiconductor, Inc. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of  Freescale Semiconductor, Inc nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_launch.h>
+#include <rte_eal.h>
+#include <rte_lcore.h>
+#include <rte_cycles.h>
+#include <rte_atomic.h>
+#include <rte_malloc.h>
+#include <rte_rcu_qsbr.h>
+
+#include "test.h"
+
+/*
+ * RCU QSBR test
+ * =============
+ *
+ * - Functional tests check the API on a single lcore: thread
+ *   registration, online/offline state, tokens and the defer queue.
+ *
+ * - The stress test runs readers on all the slave lcores. They keep
+ *   dereferencing a shared element and check that it was not freed,
+ *   while the master lcore keeps replacing it and freeing the old copies
+ *   through a defer queue, both with blocking and non-blocking reclaim.
+ */
+
+#define TEST_RCU_MAX_THREADS RTE_MAX_LCORE
+#define TEST_RCU_DQ_SIZE 64
+#define TEST_RCU_STRESS_UPDATES 20000
+
+#define ELEM_ALIVE 0xa11fe5a1
+#define ELEM_DEAD 0xdeadbeef
+
+struct test_elem {
+	volatile uint32_t magic;
+	uint64_t seq;
+};
+
+static struct rte_rcu_qsbr *qsv;
+static struct test_elem *volatile cur_elem;
+static rte_atomic32_t stop_readers;
+static rte_atomic32_t reader_errors;
+static rte_atomic32_t freed_count;
+
+static void
+test_elem_free(__attribute__((unused)) void *p, void *e)
+{
+	struct test_elem *elem = e;
+
+	elem->magic = ELEM_DEAD;
+	rte_atomic32_inc(&freed_count);
+	rte_free(elem);
+}
+
+static struct rte_rcu_qsbr *
+test_rcu_qsbr_alloc(void)
+{
+	struct rte_rcu_qsbr *v;
+	size_t sz;
+
+	sz = rte_rcu_qsbr_get_memsize(TEST_RCU_MAX_THREADS);
+	v = rte_zmalloc("test_rcu", sz, RTE_CACHE_LINE_SIZE);
+	if (v == NULL)
+		return NULL;
+	if (rte_rcu_qsbr_init(v, TEST_RCU_MAX_THREADS) != 0) {
+		rte_free(v);
+		return NULL;
+	}
+	return v;
+}
+
+static int
+test_rcu_qsbr_functional(void)
+{
+	struct rte_rcu_qsbr_dq_parameters params;
+	struct rte_rcu_qsbr_dq *dq;
+	struct test_elem *elem;
+	unsigned int pending;
+	uint64_t token;
+	int i;
+
+	TEST_ASSERT(rte_rcu_qsbr_get_memsize(0) == 1,
+		    "memsize accepted 0 threads");
+	TEST_ASSERT(rte_rcu_qsbr_init(NULL, 1) == 1,
+		    "init accepted a NULL variable");
+
+	qsv = test_rcu_qsbr_alloc();
+	TEST_ASSERT_NOT_NULL(qsv, "cannot allocate QS variable");
+
+	TEST_ASSERT(rte_rcu_qsbr_thread_register(qsv,
+				TEST_RCU_MAX_THREADS) == 1,
+		    "registered an out of range thread id");
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_thread_register(qsv, 0),
+			    "cannot register thread 0");
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_thread_register(qsv, 0),
+			    "cannot register thread 0 twice");
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_thread_register(qsv,
+				TEST_RCU_MAX_THREADS - 1),
+			    "cannot register last thread");
+	TEST_ASSERT_EQUAL(qsv->num_threads, 2, "wrong number of threads");
+
+	/* Registered but offline threads do not block the writer */
+	token = rte_rcu_qsbr_start(qsv);
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_check(qsv, token, 0), 1,
+			  "offline threads block the writer");
+
+	/* An online thread blocks the writer until it reports */
+	rte_rcu_qsbr_thread_online(qsv, 0);
+	token = rte_rcu_qsbr_start(qsv);
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_check(qsv, token, 0), 0,
+			  "online thread did not block the writer");
+	rte_rcu_qsbr_quiescent(qsv, 0);
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_check(qsv, token, 0), 1,
+			  "quiescent state not seen by the writer");
+
+	/* Going offline releases the writer as well */
+	token = rte_rcu_qsbr_start(qsv);
+	rte_rcu_qsbr_thread_offline(qsv, 0);
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_check(qsv, token, 0), 1,
+			  "offline thread blocks the writer");
+
+	/* The caller reports for itself while synchronizing */
+	rte_rcu_qsbr_thread_online(qsv, 0);
+	rte_rcu_qsbr_synchronize(qsv, 0);
+	rte_rcu_qsbr_thread_offline(qsv, 0);
+
+	/* Defer queue: elements are freed once the reader reported */
+	memset(&params, 0, sizeof(params));
+	params.name = "test_rcu_dq";
+	params.size = TEST_RCU_DQ_SIZE;
+	params.v = qsv;
+	params.free_fn = test_elem_free;
+	params.socket_id = SOCKET_ID_ANY;
+	dq = rte_rcu_qsbr_dq_create(&params);
+	TEST_ASSERT_NOT_NULL(dq, "cannot create defer queue");
+
+	rte_atomic32_set(&freed_count, 0);
+	rte_rcu_qsbr_thread_online(qsv, 0);
+	for (i = 0; i < TEST_RCU_DQ_SIZE; i++) {
+		elem = rte_zmalloc(NULL, sizeof(*elem), 0);
+		TEST_ASSERT_NOT_NULL(elem, "cannot allocate element");
+		TEST_ASSERT_SUCCESS(rte_rcu_qsbr_dq_enqueue(dq, elem),
+				    "cannot enqueue element %d", i);
+	}
+	elem = rte_zmalloc(NULL, sizeof(*elem), 0);
+	TEST_ASSERT_NOT_NULL(elem, "cannot allocate element");
+	TEST_ASSERT(rte_rcu_qsbr_dq_enqueue(dq, elem) == -ENOSPC,
+		    "enqueued in a full queue with a blocking reader");
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_dq_reclaim(dq, UINT32_MAX, 0,
+				&pending), 0,
+			  "reclaimed elements still referenced");
+	TEST_ASSERT_EQUAL(pending, TEST_RCU_DQ_SIZE, "wrong pending count");
+
+	rte_rcu_qsbr_quiescent(qsv, 0);
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_dq_enqueue(dq, elem),
+			    "cannot enqueue after quiescent state");
+	TEST_ASSERT_EQUAL(rte_atomic32_read(&freed_count), TEST_RCU_DQ_SIZE,
+			  "expired elements not freed");
+	rte_rcu_qsbr_thread_offline(qsv, 0);
+
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_dq_delete(dq),
+			    "cannot delete defer queue");
+	TEST_ASSERT_EQUAL(rte_atomic32_read(&freed_count),
+			  TEST_RCU_DQ_SIZE + 1, "elements leaked");
+
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_thread_unregister(qsv, 0),
+			    "cannot unregister thread 0");
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_thread_unregister(qsv,
+				TEST_RCU_MAX_THREADS - 1),
+			    "cannot unregister last thread");
+	TEST_ASSERT_EQUAL(qsv->num_threads, 0, "wrong number of threads");
+
+	rte_rcu_qsbr_dump(stdout, qsv);
+	rte_free(qsv);
+
+	return 0;
+}
+
+static int
+test_rcu_qsbr_reader(__attribute__((unused)) void *arg)
+{
+	const unsigned int lcore_id = rte_lcore_id();
+	struct test_elem *elem;
+	uint64_t last_seq = 0;
+
+	rte_rcu_qsbr_thread_register(qsv, lcore_id);
+	rte_rcu_qsbr_thread_online(qsv, lcore_id);
+
+	while (rte_atomic32_read(&stop_readers) == 0) {
+		elem = cur_elem;
+		if (elem->magic != ELEM_ALIVE || elem->seq < last_seq)
+			rte_atomic32_inc(&reader_errors);
+		last_seq = elem->seq;
+
+		/* Done with the element for this iteration */
+		rte_rcu_qsbr_quiescent(qsv, lcore_id);
+	}
+
+	rte_rcu_qsbr_thread_offline(qsv, lcore_id);
+	rte_rcu_qsbr_thread_unregister(qsv, lcore_id);
+
+	return 0;
+}
+
+static int
+test_rcu_qsbr_stress(void)
+{
+	struct rte_rcu_qsbr_dq_parameters params;
+	struct rte_rcu_qsbr_dq *dq;
+	struct test_elem *elem, *old;
+	uint64_t i, begin, sync_cycles = 0;
+	unsigned int nb_sync = 0;
+
+	if (rte_lcore_count() < 2) {
+		printf("Not enough lcores, need at least 2\n");
+		return -1;
+	}
+
+	qsv = test_rcu_qsbr_alloc();
+	TEST_ASSERT_NOT_NULL(qsv, "cannot allocate QS variable");
+
+	memset(&params, 0, sizeof(params));
+	params.name = "test_rcu_stress_dq";
+	params.size = TEST_RCU_DQ_SIZE;
+	params.v = qsv;
+	params.free_fn = test_elem_free;
+	params.socket_id = SOCKET_ID_ANY;
+	dq = rte_rcu_qsbr_dq_create(&params);
+	TEST_ASSERT_NOT_NULL(dq, "cannot create defer queue");
+
+	elem = rte_zmalloc(NULL, sizeof(*elem), 0);
+	TEST_ASSERT_NOT_NULL(elem, "cannot allocate element");
+	elem->magic = ELEM_ALIVE;
+	cur_elem = elem;
+
+	rte_atomic32_set(&stop_readers, 0);
+	rte_atomic32_set(&reader_errors, 0);
+	rte_atomic32_set(&freed_count, 0);
+	rte_eal_mp_remote_launch(test_rcu_qsbr_reader, NULL, SKIP_MASTER);
+
+	for (i = 1; i <= TEST_RCU_STRESS_UPDATES; i++) {
+		elem = rte_zmalloc(NULL, sizeof(*elem), 0);
+		if (elem == NULL) {
+			rte_rcu_qsbr_dq_reclaim(dq, UINT32_MAX, 1, NULL);
+			elem = rte_zmalloc(NULL, sizeof(*elem), 0);
+		}
+		TEST_ASSERT_NOT_NULL(elem, "cannot allocate element");
+		elem->magic = ELEM_ALIVE;
+		elem->seq = i;
+
+		old = cur_elem;
+		cur_elem = elem;
+
+		if ((i & 0xff) == 0) {
+			/* Blocking form: wait for a grace period */
+			begin = rte_rdtsc();
+			rte_rcu_qsbr_synchronize(qsv, RTE_QSBR_THRID_INVALID);
+			sync_cycles += rte_rdtsc() - begin;
+			nb_sync++;
+			test_elem_free(NULL, old);
+		} else {
+			/* Non-blocking form: defer the free */
+			while (rte_rcu_qsbr_dq_enqueue(dq, old) != 0)
+				rte_pause();
+		}
+	}
+
+	rte_atomic32_set(&stop_readers, 1);
+	rte_eal_mp_wait_lcore();
+
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_dq_delete(dq),
+			    "cannot delete defer queue");
+	rte_free(cur_elem);
+	rte_free(qsv);
+
+	printf("%u elements freed, average synchronize %"PRIu64" cycles\n",
+	       rte_atomic32_read(&freed_count),
+	       nb_sync ? sync_cycles / nb_sync : 0);
+
+	TEST_ASSERT_EQUAL(rte_atomic32_read(&freed_count),
+			  TEST_RCU_STRESS_UPDATES, "elements leaked");
+	TEST_ASSERT_EQUAL(rte_atomic32_read(&reader_errors), 0,
+			  "readers accessed freed elements");
+
+	return 0;
+}
+
+static int
+test_rcu_qsbr(void)
+{
+	if (test_rcu_qsbr_functional() < 0)
+		return -1;
+	if (test_rcu_qsbr_stress() < 0)
+		return -1;
+	return 0;
+}
+
+REGISTER_TEST_COMMAND(rcu_qsbr_autotest, test_rcu_qsbr);
@@ -389,6 +389,12 @@ test_ring_perf(void)
 	if (r == NULL && (r = rte_ring_lookup(RING_NAME)) == NULL)
 		return -1;
 
+#ifdef RTE_RING_USE_C11_MEM_MODEL
+	printf("### Ring memory model: C11 acquire/release ###\n");
+#else
+	printf("### Ring memory model: generic barriers ###\n");
+#endif
+
 	printf("### Testing single element and burst enq/deq ###\n");
 	test_single_enqueue_dequeue();
 	test_burst_enqueue_dequeue();
@@ -0,0 +1,349 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2017 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_lcore.h>
+#include <rte_mbuf.h>
+#include <rte_mempool.h>
+
+#include "test.h"
+
+#include <rx_demux.h>
+
+#define DEMUX_NB_QUEUES		8
+#define DEMUX_NB_MBUFS		2047
+#define DEMUX_DQRR_SIZE		1024
+#define DEMUX_BURST		32
+
+/*
+ * Software portal model: the frames of all the queues scheduled to the
+ * channel of the portal, in the order the portal dequeues them.
+ */
+struct demux_portal {
+	struct {
+		unsigned int queue;
+		struct rte_mbuf *m;
+	} dqrr[DEMUX_DQRR_SIZE];
+	unsigned int head;
+	unsigned int tail;
+	unsigned int polls;
+};
+
+static struct demux_portal portal;
+static struct rx_demux_queue demux_queues[DEMUX_NB_QUEUES];
+/* Receive in progress, per lcore in the PMDs */
+static struct rx_demux_burst demux_burst;
+static struct rte_mempool *demux_pool;
+
+/* Frames are tagged with their queue and sequence number on it */
+#define DEMUX_TAG(q, seq)	(((uint64_t)(q) << 32) | (seq))
+
+static int
+demux_enqueue(unsigned int q, uint32_t seq)
+{
+	struct rte_mbuf *m = rte_pktmbuf_alloc(demux_pool);
+
+	if (m == NULL || portal.tail - portal.head == DEMUX_DQRR_SIZE) {
+		rte_pktmbuf_free(m);
+		return -1;
+	}
+	m->udata64 = DEMUX_TAG(q, seq);
+	portal.dqrr[portal.tail % DEMUX_DQRR_SIZE].queue = q;
+	portal.dqrr[portal.tail % DEMUX_DQRR_SIZE].m = m;
+	portal.tail++;
+	return 0;
+}
+
+/* One poll of the portal, as the DQRR callback of the PMDs */
+static void
+demux_poll(struct rx_demux_burst *burst, unsigned int limit)
+{
+	unsigned int i;
+
+	portal.polls++;
+	for (i = 0; i < limit && portal.head != portal.tail; i++, portal.head++)
+		rx_demux_frame(burst,
+			&demux_queues[portal.dqrr[portal.head %
+						  DEMUX_DQRR_SIZE].queue],
+			portal.dqrr[portal.head % DEMUX_DQRR_SIZE].m);
+}
+
+/* A receive of the PMDs */
+static uint16_t
+demux_rx(unsigned int q, struct rte_mbuf **bufs, uint16_t nb_bufs)
+{
+	if (rx_demux_queue_claim(&demux_queues[q]) < 0)
+		return 0;
+	if (rx_demux_burst_start(&demux_burst, &demux_queues[q], bufs,
+				 nb_bufs))
+		return nb_bufs;
+	demux_poll(&demux_burst, rx_demux_burst_room(&demux_burst));
+	return rx_demux_burst_end(&demux_burst);
+}
+
+static int
+test_rx_demux_setup(void)
+{
+	unsigned int q;
+
+	if (demux_pool == NULL)
+		demux_pool = rte_pktmbuf_pool_create("rx_demux_pool",
+						     DEMUX_NB_MBUFS, 0, 0,
+						     RTE_MBUF_DEFAULT_BUF_SIZE,
+						     SOCKET_ID_ANY);
+	TEST_ASSERT_NOT_NULL(demux_pool, "Cannot create mbuf pool");
+	memset(&portal, 0, sizeof(portal));
+	for (q = 0; q < DEMUX_NB_QUEUES; q++)
+		rx_demux_queue_init(&demux_queues[q]);
+	return TEST_SUCCESS;
+}
+
+static void
+test_rx_demux_teardown(void)
+{
+	unsigned int q;
+
+	for (q = 0; q < DEMUX_NB_QUEUES; q++)
+		rx_demux_queue_flush(&demux_queues[q]);
+	while (portal.head != portal.tail)
+		rte_pktmbuf_free(portal.dqrr[portal.head++ %
+					     DEMUX_DQRR_SIZE].m);
+}
+
+/* Check that the frames received are the next ones of the queue, in order */
+static int
+demux_check(unsigned int q, struct rte_mbuf **bufs, uint16_t n,
+	    uint32_t *next_seq)
+{
+	uint16_t i;
+
+	for (i = 0; i < n; i++) {
+		TEST_ASSERT_EQUAL(bufs[i]->udata64, DEMUX_TAG(q, *next_seq),
+				  "Queue %u: frame %#"PRIx64", expected seq %u",
+				  q, bufs[i]->udata64, *next_seq);
+		(*next_seq)++;
+		rte_pktmbuf_free(bufs[i]);
+	}
+	return TEST_SUCCESS;
+}
+
+static int
+test_rx_demux_interleaved(void)
+{
+	uint32_t seq[DEMUX_NB_QUEUES] = { 0 }, next[DEMUX_NB_QUEUES] = { 0 };
+	struct rte_mbuf *bufs[DEMUX_BURST];
+	unsigned int i, q, loops;
+	uint16_t n;
+
+	/* Uneven traffic: queue q gets q + 1 frames out of 36 */
+	for (i = 0; i < 900; i++) {
+		q = 0;
+		while ((i % 36) >= (q + 1) * (q + 2) / 2)
+			q++;
+		TEST_ASSERT_SUCCESS(demux_enqueue(q, seq[q]++), "Enqueue failed");
+	}
+
+	for (loops = 0; loops < 100; loops++)
+		for (q = 0; q < DEMUX_NB_QUEUES; q++) {
+			n = demux_rx(q, bufs, DEMUX_BURST);
+			if (demux_check(q, bufs, n, &next[q]) != TEST_SUCCESS)
+				return TEST_FAILED;
+		}
+
+	for (q = 0; q < DEMUX_NB_QUEUES; q++) {
+		TEST_ASSERT_EQUAL(next[q], seq[q], "Queue %u: %u frames of %u",
+				  q, next[q], seq[q]);
+		TEST_ASSERT_EQUAL(demux_queues[q].stats.drops, 0,
+				  "Queue %u: frames dropped", q);
+	}
+	TEST_ASSERT_EQUAL(portal.head, portal.tail, "Frames left");
+	return TEST_SUCCESS;
+}
+
+static int
+test_rx_demux_backlog_first(void)
+{
+	struct rte_mbuf *bufs[DEMUX_BURST];
+	uint32_t next = 0;
+	unsigned int i;
+	uint16_t n;
+
+	/* Frames of queue 1 polled by a receive on queue 0 */
+	for (i = 0; i < 40; i++)
+		TEST_ASSERT_SUCCESS(demux_enqueue(1, i), "Enqueue failed");
+	TEST_ASSERT_EQUAL(demux_rx(0, bufs, DEMUX_BURST), 0,
+			  "Frames of queue 1 received on queue 0");
+	TEST_ASSERT_EQUAL(rx_demux_queue_count(&demux_queues[1]), DEMUX_BURST,
+			  "Backlog of %u frames",
+			  rx_demux_queue_count(&demux_queues[1]));
+	TEST_ASSERT_EQUAL(demux_queues[1].stats.backlogged, DEMUX_BURST,
+			  "Backlogged frames not counted");
+
+	/* A backlog filling the receive doesn't poll the portal */
+	i = portal.polls;
+	n = demux_rx(1, bufs, 16);
+	TEST_ASSERT_EQUAL(n, 16, "Received %u of the backlog", n);
+	TEST_ASSERT_EQUAL(portal.polls, i, "Portal polled");
+	if (demux_check(1, bufs, n, &next) != TEST_SUCCESS)
+		return TEST_FAILED;
+
+	/* The rest of the backlog comes before the frames polled */
+	n = demux_rx(1, bufs, DEMUX_BURST);
+	TEST_ASSERT_EQUAL(n, 24, "Received %u frames", n);
+	TEST_ASSERT_EQUAL(portal.polls, i + 1, "Portal not polled");
+	if (demux_check(1, bufs, n, &next) != TEST_SUCCESS)
+		return TEST_FAILED;
+	TEST_ASSERT_EQUAL(rx_demux_queue_count(&demux_queues[1]), 0,
+			  "Backlog not empty");
+	return TEST_SUCCESS;
+}
+
+static int
+test_rx_demux_backlog_full(void)
+{
+	struct rte_mbuf *bufs[DEMUX_BURST];
+	unsigned int avail, i;
+	uint32_t next = 0;
+	uint16_t n;
+
+	avail = rte_mempool_avail_count(demux_pool);
+	for (i = 0; i < RX_DEMUX_BACKLOG_SIZE + 10; i++)
+		TEST_ASSERT_SUCCESS(demux_enqueue(2, i), "Enqueue failed");
+
+	/* Queue 3 alone is polled, queue 2 overflows */
+	while (portal.head != portal.tail)
+		TEST_ASSERT_EQUAL(demux_rx(3, bufs, DEMUX_BURST), 0,
+				  "Frames received on queue 3");
+	TEST_ASSERT_EQUAL(demux_queues[2].stats.drops, 10,
+			  "%"PRIu64" frames dropped",
+			  demux_queues[2].stats.drops);
+	TEST_ASSERT_EQUAL(rte_mempool_avail_count(demux_pool),
+			  avail - RX_DEMUX_BACKLOG_SIZE,
+			  "Dropped frames not freed");
+
+	/* The oldest frames are kept */
+	while ((n = demux_rx(2, bufs, DEMUX_BURST)) != 0)
+		if (demux_check(2, bufs, n, &next) != TEST_SUCCESS)
+			return TEST_FAILED;
+	TEST_ASSERT_EQUAL(next, RX_DEMUX_BACKLOG_SIZE, "%u frames received",
+			  next);
+	TEST_ASSERT_EQUAL(rte_mempool_avail_count(demux_pool), avail,
+			  "Frames leaked");
+	return TEST_SUCCESS;
+}
+
+static int
+test_rx_demux_claim(void)
+{
+	struct rx_demux_queue *rxq = &demux_queues[0];
+	struct rte_mbuf *bufs[DEMUX_BURST];
+
+	TEST_ASSERT_EQUAL(rx_demux_queue_claim(rxq), 1, "First claim");
+	TEST_ASSERT_EQUAL(rx_demux_queue_claim(rxq), 0, "Claim by the owner");
+
+	TEST_ASSERT_EQUAL(rx_demux_queue_owner(rxq), rte_lcore_id(),
+			  "Owner not set");
+
+	/* Owned by another lcore: no receive, the frames are left alone */
+	rxq->owner = rte_lcore_id() + 2;
+	TEST_ASSERT_EQUAL(rx_demux_queue_claim(rxq), -EBUSY,
+			  "Claim of a queue of another lcore");
+	TEST_ASSERT_SUCCESS(demux_enqueue(0, 0), "Enqueue failed");
+	TEST_ASSERT_EQUAL(demux_rx(0, bufs, DEMUX_BURST), 0,
+			  "Received on a queue of another lcore");
+	TEST_ASSERT_EQUAL(portal.polls, 0, "Portal polled");
+
+	rx_demux_queue_unclaim(rxq);
+	TEST_ASSERT_EQUAL(rx_demux_queue_claim(rxq), 1, "Claim after unclaim");
+	TEST_ASSERT_EQUAL(demux_rx(0, bufs, DEMUX_BURST), 1, "Not received");
+	rte_pktmbuf_free(bufs[0]);
+	return TEST_SUCCESS;
+}
+
+static int
+test_rx_demux_poll_outside(void)
+{
+	struct rte_mbuf *bufs[DEMUX_BURST];
+	uint32_t next = 0;
+	unsigned int i;
+	uint16_t n;
+
+	/* A receive on queue 0 ends before the portal is polled again */
+	TEST_ASSERT_SUCCESS(demux_enqueue(0, 0), "Enqueue failed");
+	n = demux_rx(0, bufs, DEMUX_BURST);
+	TEST_ASSERT_EQUAL(n, 1, "Received %u frames", n);
+	if (demux_check(0, bufs, n, &next) != TEST_SUCCESS)
+		return TEST_FAILED;
+
+	/* Polled for another purpose, the portal backlogs all the frames */
+	for (i = 1; i < 10; i++)
+		TEST_ASSERT_SUCCESS(demux_enqueue(0, i), "Enqueue failed");
+	demux_poll(&demux_burst, DEMUX_BURST);
+	TEST_ASSERT_EQUAL(rx_demux_queue_count(&demux_queues[0]), 9,
+			  "Frames polled outside of a receive not backlogged");
+
+	n = demux_rx(0, bufs, DEMUX_BURST);
+	TEST_ASSERT_EQUAL(n, 9, "Received %u frames", n);
+	return demux_check(0, bufs, n, &next);
+}
+
+static struct unit_test_suite rx_demux_testsuite  = {
+	.suite_name = "Portal Rx Demux Unit Test Suite",
+	.setup = NULL,
+	.teardown = NULL,
+	.unit_test_cases = {
+		TEST_CASE_ST(test_rx_demux_setup, test_rx_demux_teardown,
+			     test_rx_demux_interleaved),
+		TEST_CASE_ST(test_rx_demux_setup, test_rx_demux_teardown,
+			     test_rx_demux_backlog_first),
+		TEST_CASE_ST(test_rx_demux_setup, test_rx_demux_teardown,
+			     test_rx_demux_backlog_full),
+		TEST_CASE_ST(test_rx_demux_setup, test_rx_demux_teardown,
+			     test_rx_demux_claim),
+		TEST_CASE_ST(test_rx_demux_setup, test_rx_demux_teardown,
+			     test_rx_demux_poll_outside),
+
+		TEST_CASES_END() /**< NULL terminate unit test array */
+	}
+};
+
+static int
+test_rx_demux(void)
+{
+	return unit_test_suite_runner(&rx_demux_testsuite);
+}
+
+REGISTER_TEST_COMMAND(rx_demux_autotest, test_rx_demux);
@@ -0,0 +1,314 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2017 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_random.h>
+
+#include "test.h"
+
+/*
+ * The SEC descriptor library is built for the SEC PMDs only, it needs the
+ * DMA address type of their platform headers.
+ */
+typedef uint64_t dma_addr_t;
+
+#include <flib/desc/sd_tmpl.h>
+
+/* Descriptors built for each configuration, with different keys */
+#define SD_TMPL_TEST_ROUNDS	4
+
+struct sd_tmpl_test_alg {
+	uint32_t algtype;
+	uint16_t algmode;
+	uint32_t keylen;
+	uint32_t ivlen;		/* cipher */
+	uint8_t trunc_len;	/* authentication */
+};
+
+static const struct sd_tmpl_test_alg cipher_algs[] = {
+	{ OP_ALG_ALGSEL_AES, OP_ALG_AAI_CBC, 16, 16, 0 },
+	{ OP_ALG_ALGSEL_AES, OP_ALG_AAI_CBC, 24, 16, 0 },
+	{ OP_ALG_ALGSEL_AES, OP_ALG_AAI_CBC, 32, 16, 0 },
+	{ OP_ALG_ALGSEL_3DES, OP_ALG_AAI_CBC, 24, 8, 0 },
+};
+
+static const struct sd_tmpl_test_alg auth_algs[] = {
+	{ OP_ALG_ALGSEL_MD5, OP_ALG_AAI_HMAC, 16, 0, 12 },
+	{ OP_ALG_ALGSEL_SHA1, OP_ALG_AAI_HMAC, 20, 0, 12 },
+	{ OP_ALG_ALGSEL_SHA1, OP_ALG_AAI_HMAC, 13, 0, 20 },
+	{ OP_ALG_ALGSEL_SHA224, OP_ALG_AAI_HMAC, 28, 0, 28 },
+	{ OP_ALG_ALGSEL_SHA256, OP_ALG_AAI_HMAC, 32, 0, 16 },
+	{ OP_ALG_ALGSEL_SHA384, OP_ALG_AAI_HMAC, 48, 0, 24 },
+	{ OP_ALG_ALGSEL_SHA512, OP_ALG_AAI_HMAC, 64, 0, 32 },
+};
+
+static struct sd_tmpl_cache test_cache;
+
+static uint8_t c_key[MAX_CAAM_DESCSIZE * 4];
+static uint8_t a_key[MAX_CAAM_DESCSIZE * 4];
+
+static void
+sd_tmpl_test_alginfo(struct alginfo *alginfo,
+		     const struct sd_tmpl_test_alg *alg,
+		     enum rta_data_type key_type, uint8_t *key)
+{
+	unsigned i;
+
+	memset(alginfo, 0, sizeof(*alginfo));
+	alginfo->algtype = alg->algtype;
+	alginfo->algmode = alg->algmode;
+	alginfo->keylen = alg->keylen;
+	alginfo->key_enc_flags = 0;
+	alginfo->key_type = key_type;
+
+	if (key_type == RTA_DATA_IMM) {
+		for (i = 0; i < alg->keylen; i++)
+			key[i] = (uint8_t)rte_rand();
+		alginfo->key = (uint64_t)(uintptr_t)key;
+	} else {
+		alginfo->key = rte_rand();
+	}
+}
+
+/*
+ * Build a descriptor through the template cache and by its constructor, with
+ * the same keys, and compare them.
+ */
+static int
+sd_tmpl_test_compare(const struct sd_tmpl_key *key,
+		     struct alginfo *cipherdata, struct alginfo *authdata)
+{
+	uint32_t desc[MAX_CAAM_DESCSIZE], ref[MAX_CAAM_DESCSIZE];
+	int len, ref_len;
+
+	memset(desc, 0, sizeof(desc));
+	memset(ref, 0, sizeof(ref));
+
+	len = sd_tmpl_get(&test_cache, key, desc, cipherdata, authdata);
+	ref_len = sd_tmpl_cnstr(key, ref, cipherdata, authdata);
+
+	TEST_ASSERT(ref_len > 0, "Descriptor constructor %u failed: %d",
+		    key->cnstr, ref_len);
+	TEST_ASSERT_EQUAL(len, ref_len,
+			  "Descriptor length %d, expected %d", len, ref_len);
+	TEST_ASSERT_BUFFERS_ARE_EQUAL(desc, ref, sizeof(desc),
+				      "Descriptor %u (ps %u, swap %u, dir %u) "
+				      "differs from its constructor's",
+				      key->cnstr, key->ps, key->swap,
+				      key->dir);
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Build each descriptor of a configuration several times, checking the
+ * first one makes the template and the next ones are copied from it.
+ */
+static int
+sd_tmpl_test_rounds(uint32_t cnstr, bool ps, bool swap, uint8_t dir,
+		    const struct sd_tmpl_test_alg *c_alg,
+		    const struct sd_tmpl_test_alg *a_alg,
+		    enum rta_data_type c_type, enum rta_data_type a_type)
+{
+	struct alginfo cipherdata, authdata;
+	struct sd_tmpl_key key;
+	uint64_t hits, misses;
+	unsigned i;
+
+	/* Start from an empty cache, a template could be evicted otherwise */
+	memset(&test_cache, 0, sizeof(test_cache));
+
+	for (i = 0; i < SD_TMPL_TEST_ROUNDS; i++) {
+		if (c_alg)
+			sd_tmpl_test_alginfo(&cipherdata, c_alg, c_type,
+					     c_key);
+		if (a_alg)
+			sd_tmpl_test_alginfo(&authdata, a_alg, a_type, a_key);
+
+		sd_tmpl_key_init(&key, cnstr, ps, swap,
+				 c_alg ? &cipherdata : NULL,
+				 a_alg ? &authdata : NULL);
+		key.ivlen = c_alg ? c_alg->ivlen : 0;
+		key.trunc_len = a_alg ? a_alg->trunc_len : 0;
+		key.dir = dir;
+
+		hits = test_cache.hits;
+		misses = test_cache.misses;
+		if (sd_tmpl_test_compare(&key, c_alg ? &cipherdata : NULL,
+					 a_alg ? &authdata : NULL) < 0)
+			return TEST_FAILED;
+
+		TEST_ASSERT_EQUAL(test_cache.hits - hits, (i ? 1ULL : 0ULL),
+				  "Descriptor %u not copied from its template",
+				  i);
+		TEST_ASSERT_EQUAL(test_cache.misses - misses,
+				  (i ? 0ULL : 1ULL),
+				  "Descriptor %u made a template", i);
+	}
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_sd_tmpl_blkcipher(void)
+{
+	unsigned c, ps, swap, dir;
+
+	for (c = 0; c < RTE_DIM(cipher_algs); c++)
+	for (ps = 0; ps < 2; ps++)
+	for (swap = 0; swap < 2; swap++)
+	for (dir = DIR_DEC; dir <= DIR_ENC; dir++) {
+		if (sd_tmpl_test_rounds(SD_TMPL_BLKCIPHER, ps, swap, dir,
+					&cipher_algs[c], NULL,
+					RTA_DATA_IMM, RTA_DATA_IMM) < 0) {
+			printf("Cipher %#x, keylen %u\n",
+			       cipher_algs[c].algtype, cipher_algs[c].keylen);
+			return TEST_FAILED;
+		}
+	}
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_sd_tmpl_hmac(void)
+{
+	unsigned a, ps, swap, do_icv;
+
+	for (a = 0; a < RTE_DIM(auth_algs); a++)
+	for (ps = 0; ps < 2; ps++)
+	for (swap = 0; swap < 2; swap++)
+	for (do_icv = 0; do_icv < 2; do_icv++) {
+		if (sd_tmpl_test_rounds(SD_TMPL_HMAC, ps, swap, do_icv,
+					NULL, &auth_algs[a],
+					RTA_DATA_IMM, RTA_DATA_IMM) < 0) {
+			printf("Auth %#x, keylen %u\n",
+			       auth_algs[a].algtype, auth_algs[a].keylen);
+			return TEST_FAILED;
+		}
+	}
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_sd_tmpl_authenc(void)
+{
+	unsigned c, a, ps, swap, dir, key_types;
+
+	for (c = 0; c < RTE_DIM(cipher_algs); c++)
+	for (a = 0; a < RTE_DIM(auth_algs); a++)
+	for (ps = 0; ps < 2; ps++)
+	for (swap = 0; swap < 2; swap++)
+	for (dir = DIR_DEC; dir <= DIR_ENC; dir++)
+	for (key_types = 0; key_types < 4; key_types++) {
+		if (sd_tmpl_test_rounds(SD_TMPL_AUTHENC, ps, swap, dir,
+				&cipher_algs[c], &auth_algs[a],
+				(key_types & 1) ? RTA_DATA_PTR : RTA_DATA_IMM,
+				(key_types & 2) ? RTA_DATA_PTR : RTA_DATA_IMM)
+				< 0) {
+			printf("Cipher %#x keylen %u, auth %#x keylen %u, "
+			       "key types %u\n",
+			       cipher_algs[c].algtype, cipher_algs[c].keylen,
+			       auth_algs[a].algtype, auth_algs[a].keylen,
+			       key_types);
+			return TEST_FAILED;
+		}
+	}
+
+	return TEST_SUCCESS;
+}
+
+/*
+ * Alternate between configurations sharing the cache: each keeps its own
+ * template, or has it rebuilt when another one took its place.
+ */
+static int
+test_sd_tmpl_shared_cache(void)
+{
+	struct alginfo cipherdata, authdata;
+	struct sd_tmpl_key key;
+	unsigned i, c, a;
+
+	memset(&test_cache, 0, sizeof(test_cache));
+
+	for (i = 0; i < 8 * SD_TMPL_CACHE_SIZE; i++) {
+		c = rte_rand() % RTE_DIM(cipher_algs);
+		a = rte_rand() % RTE_DIM(auth_algs);
+
+		sd_tmpl_test_alginfo(&cipherdata, &cipher_algs[c],
+				     RTA_DATA_IMM, c_key);
+		sd_tmpl_test_alginfo(&authdata, &auth_algs[a],
+				     RTA_DATA_IMM, a_key);
+		sd_tmpl_key_init(&key, SD_TMPL_AUTHENC, true, i & 1,
+				 &cipherdata, &authdata);
+		key.ivlen = cipher_algs[c].ivlen;
+		key.trunc_len = auth_algs[a].trunc_len;
+		key.dir = (i & 2) ? DIR_ENC : DIR_DEC;
+
+		if (sd_tmpl_test_compare(&key, &cipherdata, &authdata) < 0)
+			return TEST_FAILED;
+	}
+
+	TEST_ASSERT_EQUAL(test_cache.hits + test_cache.misses,
+			  (uint64_t)8 * SD_TMPL_CACHE_SIZE,
+			  "Descriptors not all accounted for");
+	TEST_ASSERT(test_cache.hits != 0, "No descriptor copied");
+
+	return TEST_SUCCESS;
+}
+
+static struct unit_test_suite sd_tmpl_testsuite  = {
+	.suite_name = "SEC Shared Descriptor Templates Unit Test Suite",
+	.setup = NULL,
+	.teardown = NULL,
+	.unit_test_cases = {
+		TEST_CASE(test_sd_tmpl_blkcipher),
+		TEST_CASE(test_sd_tmpl_hmac),
+		TEST_CASE(test_sd_tmpl_authenc),
+		TEST_CASE(test_sd_tmpl_shared_cache),
+
+		TEST_CASES_END() /**< NULL terminate unit test array */
+	}
+};
+
+static int
+test_sec_desc_tmpl(void)
+{
+	return unit_test_suite_runner(&sd_tmpl_testsuite);
+}
+
+REGISTER_TEST_COMMAND(sec_desc_tmpl_autotest, test_sec_desc_tmpl);
@@ -0,0 +1,147 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 Freescale Semiconductor, Inc. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of  Freescale Semiconductor, Inc nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_launch.h>
+#include <rte_eal.h>
+#include <rte_lcore.h>
+#include <rte_cycles.h>
+#include <rte_atomic.h>
+#include <rte_ticketlock.h>
+
+#include "test.h"
+
+/*
+ * Ticketlock test
+ * ===============
+ *
+ * - All lcores increment a shared, non-atomic counter a fixed number of
+ *   times, each increment being protected by a single ticketlock. The
+ *   final value of the counter must be exact.
+ *
+ * - The master lcore takes the lock, then all slave lcores try to take it
+ *   with rte_ticketlock_trylock(), which must fail.
+ *
+ * - The lock must be reported unlocked once everything is released.
+ */
+
+#define TICKETLOCK_ITERATIONS 10000
+
+static rte_ticketlock_t tl;
+static uint64_t shared_count;
+static rte_atomic32_t synchro;
+static rte_atomic32_t try_failed;
+
+static int
+test_ticketlock_per_core(__attribute__((unused)) void *arg)
+{
+	unsigned int i;
+
+	/* wait synchro for slaves */
+	if (rte_lcore_id() != rte_get_master_lcore())
+		while (rte_atomic32_read(&synchro) == 0)
+			rte_pause();
+
+	for (i = 0; i < TICKETLOCK_ITERATIONS; i++) {
+		rte_ticketlock_lock(&tl);
+		shared_count++;
+		rte_ticketlock_unlock(&tl);
+	}
+
+	return 0;
+}
+
+static int
+test_ticketlock_try(__attribute__((unused)) void *arg)
+{
+	if (rte_ticketlock_trylock(&tl) == 0)
+		rte_atomic32_inc(&try_failed);
+	else
+		rte_ticketlock_unlock(&tl);
+
+	return 0;
+}
+
+static int
+test_ticketlock(void)
+{
+	uint64_t expected;
+
+	rte_ticketlock_init(&tl);
+	shared_count = 0;
+
+	/* Clear synchro and start slaves */
+	rte_atomic32_set(&synchro, 0);
+	rte_eal_mp_remote_launch(test_ticketlock_per_core, NULL, SKIP_MASTER);
+	rte_atomic32_set(&synchro, 1);
+	test_ticketlock_per_core(NULL);
+	rte_eal_mp_wait_lcore();
+
+	expected = (uint64_t)TICKETLOCK_ITERATIONS * rte_lcore_count();
+	if (shared_count != expected) {
+		printf("ticketlock count %"PRIu64", expected %"PRIu64"\n",
+		       shared_count, expected);
+		return -1;
+	}
+
+	if (rte_ticketlock_trylock(&tl) == 0) {
+		printf("ticketlock_trylock failed on a free lock\n");
+		return -1;
+	}
+	if (!rte_ticketlock_is_locked(&tl)) {
+		printf("ticketlock is not locked but it should be\n");
+		return -1;
+	}
+
+	rte_atomic32_set(&try_failed, 0);
+	rte_eal_mp_remote_launch(test_ticketlock_try, NULL, SKIP_MASTER);
+	rte_eal_mp_wait_lcore();
+	rte_ticketlock_unlock(&tl);
+
+	if (rte_atomic32_read(&try_failed) != (int)(rte_lcore_count() - 1)) {
+		printf("ticketlock_trylock succeeded on a locked lock\n");
+		return -1;
+	}
+	if (rte_ticketlock_is_locked(&tl)) {
+		printf("ticketlock is locked but it should not be\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+REGISTER_TEST_COMMAND(ticketlock_autotest, test_ticketlock);
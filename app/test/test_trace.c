@@ -0,0 +1,203 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 Freescale Semiconductor, Inc. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of  Freescale Semiconductor, Inc nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <rte_common.h>
+#include <rte_ring.h>
+#include <rte_trace.h>
+
+#include "test.h"
+
+/*
+ * Trace points
+ * ============
+ *
+ * - Enable and disable trace points by pattern, look them up by name.
+ * - Emit a trace point while disabled: no record is written.
+ * - Emit it while enabled, dump the buffers in CTF and check the size of
+ *   the stream written by this lcore.
+ * - Enable the ring trace points and check that the enqueue and dequeue
+ *   operations are recorded.
+ */
+
+#define TRACE_TEST_NUM 100
+
+RTE_TRACE_POINT_DEFINE(test_trace_point, "app.test.trace",
+	"seq", "value", NULL, NULL)
+
+/* remove the files dumped in a directory, and the directory */
+static void
+test_trace_cleanup(const char *dir)
+{
+	char cmd[PATH_MAX + 16];
+
+	snprintf(cmd, sizeof(cmd), "rm -rf %s", dir);
+	if (system(cmd) != 0)
+		printf("Cannot remove %s\n", dir);
+}
+
+static int
+test_trace_dump(unsigned expected)
+{
+	char dir[] = "/tmp/dpdk_trace_XXXXXX";
+	char path[PATH_MAX];
+	struct stat st;
+	int ret;
+
+	if (mkdtemp(dir) == NULL) {
+		printf("Cannot create a temporary directory\n");
+		return -1;
+	}
+
+	ret = rte_trace_dump(dir);
+	if (ret != (int)expected) {
+		printf("%d records dumped instead of %u\n", ret, expected);
+		goto fail;
+	}
+
+	snprintf(path, sizeof(path), "%s/metadata", dir);
+	if (stat(path, &st) < 0 || st.st_size == 0) {
+		printf("No metadata in %s\n", dir);
+		goto fail;
+	}
+	if (expected == 0)
+		goto out;
+
+	/* stream of this lcore: 32 bytes of headers, then 16 bytes of
+	 * event header and 2 arguments per record */
+	snprintf(path, sizeof(path), "%s/channel0_%u", dir,
+		RTE_PER_LCORE(_trace_buffer)->thread_idx);
+	if (stat(path, &st) < 0 ||
+			st.st_size != (off_t)(32 + expected * (16 + 2 * 8))) {
+		printf("Invalid stream in %s\n", dir);
+		goto fail;
+	}
+
+out:
+	test_trace_cleanup(dir);
+	return 0;
+
+fail:
+	test_trace_cleanup(dir);
+	return -1;
+}
+
+static int
+test_trace_points(void)
+{
+	struct rte_trace_point *tp;
+	unsigned i;
+
+	tp = rte_trace_point_lookup("app.test.trace");
+	if (tp != &test_trace_point) {
+		printf("Cannot look up the test trace point\n");
+		return -1;
+	}
+	if (rte_trace_point_lookup("app.test.none") != NULL) {
+		printf("Found an unknown trace point\n");
+		return -1;
+	}
+
+	if (rte_trace_point_enable("app.test.*") != 1 || !tp->enabled) {
+		printf("Cannot enable the test trace point\n");
+		return -1;
+	}
+	if (rte_trace_point_disable("app.*") != 1 || tp->enabled) {
+		printf("Cannot disable the test trace point\n");
+		return -1;
+	}
+
+	/* nothing must be recorded while disabled */
+	rte_trace_reset();
+	for (i = 0; i < TRACE_TEST_NUM; i++)
+		rte_trace_point_emit(tp, i, 0, 0, 0);
+	if (test_trace_dump(0) < 0) {
+		printf("Records written by a disabled trace point\n");
+		return -1;
+	}
+
+	rte_trace_point_enable("app.test.trace");
+	for (i = 0; i < TRACE_TEST_NUM; i++)
+		rte_trace_point_emit(tp, i, i * 2, 0, 0);
+	rte_trace_point_disable("app.test.trace");
+
+	return test_trace_dump(TRACE_TEST_NUM);
+}
+
+static int
+test_trace_ring(void)
+{
+	struct rte_ring *r;
+	void *objs[8];
+	int ret = 0;
+
+	memset(objs, 0, sizeof(objs));
+	r = rte_ring_create("test_trace", 64, SOCKET_ID_ANY, 0);
+	if (r == NULL) {
+		printf("Cannot create ring\n");
+		return -1;
+	}
+
+	rte_trace_reset();
+	rte_trace_point_enable("lib.ring.*");
+	if (rte_ring_enqueue_bulk(r, objs, RTE_DIM(objs)) != 0 ||
+			rte_ring_dequeue_bulk(r, objs, RTE_DIM(objs)) != 0)
+		ret = -1;
+	rte_trace_point_disable("lib.ring.*");
+
+	if (ret == 0)
+		ret = test_trace_dump(2);
+
+	rte_ring_free(r);
+	return ret;
+}
+
+static int
+test_trace(void)
+{
+	int ret;
+
+	ret = test_trace_points();
+	if (ret == 0)
+		ret = test_trace_ring();
+
+	rte_trace_reset();
+	return ret;
+}
+
+REGISTER_TEST_COMMAND(trace_autotest, test_trace);
@@ -0,0 +1,354 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2017 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _BM_STASH_H_
+#define _BM_STASH_H_
+
+/**
+ * @file
+ *
+ * Per lcore stash of buffers in front of a BMan buffer pool.
+ *
+ * Each acquire or release command to BMan is a round trip through the
+ * software portal, whatever the number of buffers. The stash serves the
+ * mempool gets and puts of an lcore from a small array of objects, and only
+ * goes to BMan to refill or drain it, in commands of the largest size BMan
+ * takes.
+ *
+ * A get finding too few objects refills the stash, so that 'low' objects are
+ * left once served. A put taking the stash above 'high' objects drains it
+ * back to about 'low' objects. Buffers held by the stashes are out of reach
+ * of the hardware, the watermarks bound them to 'high' per lcore.
+ *
+ * The BMan commands are the platform's, given as callbacks which convert
+ * between the mempool objects and the BMan buffers.
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_branch_prediction.h>
+#include <rte_lcore.h>
+#include <rte_malloc.h>
+
+/** Largest capacity of a stash, in objects */
+#define BM_STASH_MAX_SIZE	128
+
+/**
+ * Acquire exactly 'num' objects from BMan, in a single command.
+ * Returns 'num', or 0 or a negative value when not done.
+ */
+typedef int (*bm_stash_acquire_t)(void *ctx, void **objs, unsigned int num);
+
+/** Release 'num' objects to BMan, in a single command */
+typedef void (*bm_stash_release_t)(void *ctx, void * const *objs,
+				   unsigned int num);
+
+/** Stash statistics, summed over the lcores */
+struct bm_stash_stats {
+	uint64_t get_hits;	/**< Gets served by the stash alone */
+	uint64_t get_misses;	/**< Gets which acquired from BMan */
+	uint64_t get_fails;	/**< Gets failed, the pool being empty */
+	uint64_t put_hits;	/**< Puts kept by the stash alone */
+	uint64_t put_misses;	/**< Puts which released to BMan */
+	uint64_t acquires;	/**< Acquire commands */
+	uint64_t releases;	/**< Release commands */
+};
+
+struct bm_stash {
+	uint32_t len;
+	struct bm_stash_stats stats;
+	void *objs[BM_STASH_MAX_SIZE];
+} __rte_cache_aligned;
+
+struct bm_stash_pool {
+	void *ctx;
+	bm_stash_acquire_t acquire;
+	bm_stash_release_t release;
+	uint16_t batch;		/**< Objects per BMan command */
+	uint16_t size;		/**< Capacity of the stashes, 0 if disabled */
+	uint16_t low;		/**< Refill up to, drain down to */
+	uint16_t high;		/**< Drain above */
+	struct bm_stash *stash;	/**< One per lcore */
+};
+
+/**
+ * Set up the stashes of a pool.
+ *
+ * @param size
+ *   Capacity of the stash of each lcore, 0 to go to BMan every time. Sizes
+ *   too small for the watermarks to be two commands apart disable the stash.
+ * @return
+ *   0, or -ENOMEM.
+ */
+static inline int
+bm_stash_pool_init(struct bm_stash_pool *pool, void *ctx,
+		   bm_stash_acquire_t acquire, bm_stash_release_t release,
+		   unsigned int batch, unsigned int size)
+{
+	memset(pool, 0, sizeof(*pool));
+	pool->ctx = ctx;
+	pool->acquire = acquire;
+	pool->release = release;
+	pool->batch = batch;
+
+	size = RTE_MIN(size, (unsigned int)BM_STASH_MAX_SIZE);
+	if (size < 3 * batch)
+		return 0;
+	pool->stash = rte_zmalloc(NULL, RTE_MAX_LCORE * sizeof(*pool->stash),
+				  RTE_CACHE_LINE_SIZE);
+	if (!pool->stash)
+		return -ENOMEM;
+	pool->size = size;
+	pool->low = size / 4;
+	pool->high = RTE_MAX(size - size / 4, pool->low + batch);
+	return 0;
+}
+
+/** Acquire 'n' objects from BMan, all or nothing */
+static inline int
+bm_stash_acquire_bulk(struct bm_stash_pool *pool, struct bm_stash_stats *st,
+		      void **objs, unsigned int n)
+{
+	unsigned int got = 0, num;
+
+	while (got < n) {
+		num = RTE_MIN(n - got, (unsigned int)pool->batch);
+		st->acquires++;
+		if (pool->acquire(pool->ctx, &objs[got], num) > 0) {
+			got += num;
+			continue;
+		}
+		/* Less than 'num' left in BMan, take them one by one */
+		if (num > 1) {
+			st->acquires++;
+			if (pool->acquire(pool->ctx, &objs[got], 1) > 0) {
+				got++;
+				continue;
+			}
+		}
+		st->get_fails++;
+		while (got) {
+			num = RTE_MIN(got, (unsigned int)pool->batch);
+			got -= num;
+			st->releases++;
+			pool->release(pool->ctx, &objs[got], num);
+		}
+		return -1;
+	}
+	return 0;
+}
+
+/** Release 'n' objects to BMan */
+static inline void
+bm_stash_release_bulk(struct bm_stash_pool *pool, struct bm_stash_stats *st,
+		      void * const *objs, unsigned int n)
+{
+	unsigned int num;
+
+	while (n) {
+		num = RTE_MIN(n, (unsigned int)pool->batch);
+		st->releases++;
+		pool->release(pool->ctx, objs, num);
+		objs += num;
+		n -= num;
+	}
+}
+
+static inline struct bm_stash *
+bm_stash_get_stash(struct bm_stash_pool *pool, unsigned int n)
+{
+	unsigned int lcore_id = rte_lcore_id();
+
+	if (unlikely(!pool->size || n > pool->size ||
+		     lcore_id >= RTE_MAX_LCORE))
+		return NULL;
+	return &pool->stash[lcore_id];
+}
+
+static inline int
+bm_stash_refill(struct bm_stash_pool *pool, struct bm_stash *s,
+		void **objs, unsigned int n)
+{
+	unsigned int want = RTE_MIN(n + pool->low, (unsigned int)pool->size);
+
+	s->stats.get_misses++;
+	/* Full commands first, then the exact number still missing */
+	while (s->len < want && s->len + pool->batch <= pool->size) {
+		s->stats.acquires++;
+		if (pool->acquire(pool->ctx, &s->objs[s->len],
+				  pool->batch) <= 0)
+			break;
+		s->len += pool->batch;
+	}
+	if (s->len < n && bm_stash_acquire_bulk(pool, &s->stats,
+						&s->objs[s->len],
+						n - s->len) < 0)
+		return -1;
+	if (s->len < n)
+		s->len = n;
+	s->len -= n;
+	memcpy(objs, &s->objs[s->len], n * sizeof(*objs));
+	return 0;
+}
+
+/**
+ * Get 'n' objects, all or nothing.
+ *
+ * @return
+ *   0, or -1 if the pool doesn't have 'n' objects.
+ */
+static inline int
+bm_stash_get(struct bm_stash_pool *pool, void **objs, unsigned int n)
+{
+	struct bm_stash *s = bm_stash_get_stash(pool, n);
+
+	if (unlikely(!s)) {
+		struct bm_stash_stats st = { 0 };
+
+		return bm_stash_acquire_bulk(pool, &st, objs, n);
+	}
+	if (likely(s->len >= n)) {
+		s->stats.get_hits++;
+		s->len -= n;
+		memcpy(objs, &s->objs[s->len], n * sizeof(*objs));
+		return 0;
+	}
+	return bm_stash_refill(pool, s, objs, n);
+}
+
+static inline void
+bm_stash_drain(struct bm_stash_pool *pool, struct bm_stash *s,
+	       void * const *objs, unsigned int n)
+{
+	unsigned int num;
+
+	s->stats.put_misses++;
+	/* What the stash can't hold goes straight to BMan */
+	if (s->len + n > pool->size) {
+		num = s->len + n - pool->size;
+		bm_stash_release_bulk(pool, &s->stats, objs, num);
+		objs += num;
+		n -= num;
+	}
+	memcpy(&s->objs[s->len], objs, n * sizeof(*objs));
+	s->len += n;
+	/* Back to the low watermark, in full commands */
+	while (s->len >= pool->low + pool->batch) {
+		s->len -= pool->batch;
+		s->stats.releases++;
+		pool->release(pool->ctx, &s->objs[s->len], pool->batch);
+	}
+}
+
+/** Put 'n' objects */
+static inline void
+bm_stash_put(struct bm_stash_pool *pool, void * const *objs, unsigned int n)
+{
+	struct bm_stash *s = bm_stash_get_stash(pool, n);
+
+	if (unlikely(!s)) {
+		struct bm_stash_stats st = { 0 };
+
+		bm_stash_release_bulk(pool, &st, objs, n);
+		return;
+	}
+	if (likely(s->len + n <= pool->high)) {
+		s->stats.put_hits++;
+		memcpy(&s->objs[s->len], objs, n * sizeof(*objs));
+		s->len += n;
+		return;
+	}
+	bm_stash_drain(pool, s, objs, n);
+}
+
+/** Sum the statistics of the stashes of a pool */
+static inline void
+bm_stash_stats_get(const struct bm_stash_pool *pool,
+		   struct bm_stash_stats *stats)
+{
+	const struct bm_stash_stats *st;
+	unsigned int i;
+
+	memset(stats, 0, sizeof(*stats));
+	if (!pool->stash)
+		return;
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		st = &pool->stash[i].stats;
+		stats->get_hits += st->get_hits;
+		stats->get_misses += st->get_misses;
+		stats->get_fails += st->get_fails;
+		stats->put_hits += st->put_hits;
+		stats->put_misses += st->put_misses;
+		stats->acquires += st->acquires;
+		stats->releases += st->releases;
+	}
+}
+
+/** Objects held by the stashes of a pool */
+static inline unsigned int
+bm_stash_count(const struct bm_stash_pool *pool)
+{
+	unsigned int i, count = 0;
+
+	if (!pool->stash)
+		return 0;
+	for (i = 0; i < RTE_MAX_LCORE; i++)
+		count += pool->stash[i].len;
+	return count;
+}
+
+/**
+ * Release the objects of all the stashes to BMan, and free them. The lcores
+ * must not use the pool anymore.
+ */
+static inline void
+bm_stash_pool_fini(struct bm_stash_pool *pool)
+{
+	struct bm_stash *s;
+	unsigned int i;
+
+	if (!pool->stash)
+		return;
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		s = &pool->stash[i];
+		bm_stash_release_bulk(pool, &s->stats, s->objs, s->len);
+		s->len = 0;
+	}
+	rte_free(pool->stash);
+	pool->stash = NULL;
+	pool->size = 0;
+}
+
+#endif /* _BM_STASH_H_ */
@@ -0,0 +1,455 @@
+/*
+ * Copyright 2017 NXP.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause or GPL-2.0+
+ */
+
+#ifndef __DESC_SD_TMPL_H__
+#define __DESC_SD_TMPL_H__
+
+#include "flib/rta.h"
+#include "common.h"
+#include "algo.h"
+#include "ipsec.h"
+
+/**
+ * DOC: Shared Descriptor Templates
+ *
+ * Sessions using the same algorithms, key lengths, ICV length and direction
+ * get shared descriptors which only differ by their keys. The first of them is
+ * built by its constructor with different keys, which shows where the keys
+ * land in the descriptor; it is then kept as a template. The following
+ * descriptors are copies of the template with their own keys written in,
+ * instead of being assembled again command by command.
+ *
+ * Keys are written in as the constructor does: inlined keys are copied byte
+ * for byte, referenced keys are written as pointers with the pointer size and
+ * byte order of the descriptor. A descriptor whose copies would not match its
+ * constructor's output is never cached, it is built by its constructor every
+ * time.
+ */
+
+/* Number of templates of a cache, must be a power of 2 */
+#define SD_TMPL_CACHE_SIZE	32
+
+/* Number of places where keys are written in a template */
+#define SD_TMPL_MAX_PATCHES	4
+
+enum sd_tmpl_cnstr {
+	SD_TMPL_BLKCIPHER = 1,
+	SD_TMPL_HMAC,
+	SD_TMPL_AUTHENC
+};
+
+/**
+ * struct sd_tmpl_key - Everything a shared descriptor depends on, but keys
+ * @cnstr: constructor of the descriptor, enum sd_tmpl_cnstr
+ * @c_algtype: cipher algorithm selector
+ * @a_algtype: authentication algorithm selector
+ * @c_keylen: cipher key length, in bytes
+ * @a_keylen: authentication key length, in bytes
+ * @c_key_type: cipher key type, enum rta_data_type
+ * @a_key_type: authentication key type, enum rta_data_type
+ * @c_key_enc_flags: cipher key encryption flags
+ * @a_key_enc_flags: authentication key encryption flags
+ * @c_algmode: cipher algorithm mode selector
+ * @a_algmode: authentication algorithm mode selector
+ * @ivlen: IV length
+ * @auth_only_len: length of the data only authenticated
+ * @trunc_len: ICV length
+ * @dir: DIR_ENC/DIR_DEC, or the ICV check flag for HMAC descriptors
+ * @ps: 36/40bit addressing
+ * @swap: byte swapping
+ */
+struct sd_tmpl_key {
+	uint32_t cnstr;
+	uint32_t c_algtype;
+	uint32_t a_algtype;
+	uint32_t c_keylen;
+	uint32_t a_keylen;
+	uint32_t c_key_type;
+	uint32_t a_key_type;
+	uint32_t c_key_enc_flags;
+	uint32_t a_key_enc_flags;
+	uint16_t c_algmode;
+	uint16_t a_algmode;
+	uint32_t ivlen;
+	uint32_t auth_only_len;
+	uint8_t trunc_len;
+	uint8_t dir;
+	uint8_t ps;
+	uint8_t swap;
+};
+
+/**
+ * struct sd_tmpl_patch - Place where a key is written in a template
+ * @offset: offset of the key in the descriptor, in words
+ * @len: bytes copied from an inlined key, which may not be its length
+ * @auth: 0 for the cipher key, 1 for the authentication key
+ */
+struct sd_tmpl_patch {
+	uint8_t offset;
+	uint8_t len;
+	uint8_t auth;
+};
+
+/**
+ * struct sd_tmpl - Shared descriptor template
+ * @key: what the descriptor was built for
+ * @len: length of the descriptor in words, 0 if the template is unused
+ * @cacheable: 0 if the keys of the descriptor could not be located
+ * @nb_patches: number of places where keys are written
+ * @patches: places where keys are written
+ * @desc: descriptor, built with all zero keys
+ */
+struct sd_tmpl {
+	struct sd_tmpl_key key;
+	int len;
+	uint8_t cacheable;
+	uint8_t nb_patches;
+	struct sd_tmpl_patch patches[SD_TMPL_MAX_PATCHES];
+	uint32_t desc[MAX_CAAM_DESCSIZE];
+};
+
+/**
+ * struct sd_tmpl_cache - Direct mapped cache of shared descriptor templates,
+ * its users must serialize their accesses to it
+ * @hits: descriptors copied from a template already in the cache
+ * @misses: descriptors needing a new template, or built by their constructor
+ * @tmpl: templates
+ */
+struct sd_tmpl_cache {
+	uint64_t hits;
+	uint64_t misses;
+	struct sd_tmpl tmpl[SD_TMPL_CACHE_SIZE];
+};
+
+static inline void sd_tmpl_key_init(struct sd_tmpl_key *key, uint32_t cnstr,
+				    bool ps, bool swap,
+				    const struct alginfo *cipherdata,
+				    const struct alginfo *authdata)
+{
+	memset(key, 0, sizeof(*key));
+	key->cnstr = cnstr;
+	key->ps = ps;
+	key->swap = swap;
+
+	if (cipherdata) {
+		key->c_algtype = cipherdata->algtype;
+		key->c_keylen = cipherdata->keylen;
+		key->c_key_type = cipherdata->key_type;
+		key->c_key_enc_flags = cipherdata->key_enc_flags;
+		key->c_algmode = cipherdata->algmode;
+	}
+	if (authdata) {
+		key->a_algtype = authdata->algtype;
+		key->a_keylen = authdata->keylen;
+		key->a_key_type = authdata->key_type;
+		key->a_key_enc_flags = authdata->key_enc_flags;
+		key->a_algmode = authdata->algmode;
+	}
+}
+
+static inline uint32_t sd_tmpl_key_hash(const struct sd_tmpl_key *key)
+{
+	const uint32_t *w = (const uint32_t *)key;
+	uint32_t hash = 2166136261u;
+	unsigned i;
+
+	for (i = 0; i < sizeof(*key) / sizeof(uint32_t); i++)
+		hash = (hash ^ w[i]) * 16777619u;
+
+	return hash ^ (hash >> 16);
+}
+
+static inline int sd_tmpl_cnstr(const struct sd_tmpl_key *key,
+				uint32_t *descbuf,
+				struct alginfo *cipherdata,
+				struct alginfo *authdata)
+{
+	switch (key->cnstr) {
+	case SD_TMPL_BLKCIPHER:
+		return cnstr_shdsc_blkcipher(descbuf, key->ps, key->swap,
+					     cipherdata, NULL, key->ivlen,
+					     key->dir);
+	case SD_TMPL_HMAC:
+		return cnstr_shdsc_hmac(descbuf, key->ps, key->swap, authdata,
+					key->dir, key->trunc_len);
+	case SD_TMPL_AUTHENC:
+		return cnstr_shdsc_authenc(descbuf, key->ps, key->swap,
+					   cipherdata, authdata, key->ivlen,
+					   key->auth_only_len, key->trunc_len,
+					   key->dir);
+	default:
+		return -EINVAL;
+	}
+}
+
+/*
+ * Record where a descriptor built with another key differs from the template.
+ * An inlined key takes the bytes which differ, a referenced key takes a whole
+ * pointer.
+ */
+static inline int sd_tmpl_find_patches(struct sd_tmpl *tmpl,
+				       const uint32_t *desc, uint8_t auth)
+{
+	uint32_t key_type = auth ? tmpl->key.a_key_type : tmpl->key.c_key_type;
+	const uint8_t *a, *b;
+	int i = 0, start, len;
+
+	while (i < tmpl->len) {
+		if (desc[i] == tmpl->desc[i]) {
+			i++;
+			continue;
+		}
+
+		start = i;
+		while (i < tmpl->len && desc[i] != tmpl->desc[i])
+			i++;
+
+		if (tmpl->nb_patches == SD_TMPL_MAX_PATCHES)
+			return -1;
+
+		if (key_type == RTA_DATA_IMM) {
+			a = (const uint8_t *)&desc[start];
+			b = (const uint8_t *)&tmpl->desc[start];
+			len = (i - start) * 4;
+			while (a[len - 1] == b[len - 1])
+				len--;
+			if (len > UINT8_MAX)
+				return -1;
+		} else if (key_type == RTA_DATA_PTR &&
+			   i - start <= (tmpl->key.ps ? 2 : 1)) {
+			len = 0;
+			i = start + (tmpl->key.ps ? 2 : 1);
+		} else {
+			return -1;
+		}
+
+		tmpl->patches[tmpl->nb_patches].offset = (uint8_t)start;
+		tmpl->patches[tmpl->nb_patches].len = (uint8_t)len;
+		tmpl->patches[tmpl->nb_patches].auth = auth;
+		tmpl->nb_patches++;
+	}
+
+	return 0;
+}
+
+/* Key of all 0 or all 1 bits, or of some pattern, as data or pointer */
+static inline void sd_tmpl_fill_key(struct alginfo *alginfo, uint8_t *buf,
+				    unsigned size, uint8_t fill)
+{
+	unsigned i;
+
+	for (i = 0; i < size; i++)
+		buf[i] = (fill == 0 || fill == 0xff) ? fill : (uint8_t)(fill + i);
+
+	if (alginfo->key_type == RTA_DATA_IMM)
+		alginfo->key = (uint64_t)(uintptr_t)buf;
+	else
+		memcpy(&alginfo->key, buf, sizeof(alginfo->key));
+}
+
+/* Copy a template, writing in the keys, as its constructor would have */
+static inline int sd_tmpl_clone(const struct sd_tmpl *tmpl, uint32_t *descbuf,
+				const struct alginfo *cipherdata,
+				const struct alginfo *authdata)
+{
+	const struct alginfo *alginfo;
+	struct program prg;
+	unsigned i;
+
+	memcpy(descbuf, tmpl->desc, tmpl->len * sizeof(uint32_t));
+
+	for (i = 0; i < tmpl->nb_patches; i++) {
+		alginfo = tmpl->patches[i].auth ? authdata : cipherdata;
+
+		if (alginfo->key_type == RTA_DATA_IMM) {
+			memcpy(&descbuf[tmpl->patches[i].offset],
+			       (const void *)(uintptr_t)alginfo->key,
+			       tmpl->patches[i].len);
+		} else {
+			PROGRAM_CNTXT_INIT(&prg, descbuf, 0);
+			prg.current_pc = tmpl->patches[i].offset;
+			if (tmpl->key.ps)
+				PROGRAM_SET_36BIT_ADDR(&prg);
+			if (tmpl->key.swap)
+				PROGRAM_SET_BSWAP(&prg);
+			__rta_out64(&prg, prg.ps, alginfo->key);
+		}
+	}
+
+	return tmpl->len;
+}
+
+/*
+ * Build the template of a descriptor and locate its keys, changing one key at
+ * a time. The template is then checked against its constructor with keys of
+ * yet another value.
+ */
+static inline void sd_tmpl_compile(struct sd_tmpl *tmpl,
+				   const struct sd_tmpl_key *key,
+				   const struct alginfo *cipherdata,
+				   const struct alginfo *authdata)
+{
+	uint32_t desc[MAX_CAAM_DESCSIZE], ref[MAX_CAAM_DESCSIZE];
+	uint8_t c_buf[MAX_CAAM_DESCSIZE * 4], a_buf[MAX_CAAM_DESCSIZE * 4];
+	struct alginfo c, a;
+	uint8_t auth;
+
+	memset(tmpl, 0, sizeof(*tmpl));
+	tmpl->key = *key;
+
+	memset(&c, 0, sizeof(c));
+	memset(&a, 0, sizeof(a));
+	if (cipherdata)
+		c = *cipherdata;
+	if (authdata)
+		a = *authdata;
+	if (c.keylen > sizeof(c_buf) || a.keylen > sizeof(a_buf))
+		return;
+
+	sd_tmpl_fill_key(&c, c_buf, sizeof(c_buf), 0);
+	sd_tmpl_fill_key(&a, a_buf, sizeof(a_buf), 0);
+	tmpl->len = sd_tmpl_cnstr(key, tmpl->desc, &c, &a);
+	if (tmpl->len <= 0 || tmpl->len > MAX_CAAM_DESCSIZE) {
+		tmpl->len = 0;
+		return;
+	}
+
+	for (auth = 0; auth < 2; auth++) {
+		if ((auth ? authdata : cipherdata) == NULL)
+			continue;
+
+		memset(desc, 0, sizeof(desc));
+		sd_tmpl_fill_key(auth ? &a : &c, auth ? a_buf : c_buf,
+				 sizeof(c_buf), 0xff);
+		if (sd_tmpl_cnstr(key, desc, &c, &a) != tmpl->len ||
+		    sd_tmpl_find_patches(tmpl, desc, auth) < 0)
+			return;
+		sd_tmpl_fill_key(auth ? &a : &c, auth ? a_buf : c_buf,
+				 sizeof(c_buf), 0);
+	}
+
+	sd_tmpl_fill_key(&c, c_buf, sizeof(c_buf), 0x11);
+	sd_tmpl_fill_key(&a, a_buf, sizeof(a_buf), 0x5a);
+	memset(desc, 0, sizeof(desc));
+	memset(ref, 0, sizeof(ref));
+	if (sd_tmpl_cnstr(key, ref, &c, &a) != tmpl->len ||
+	    sd_tmpl_clone(tmpl, desc, &c, &a) != tmpl->len ||
+	    memcmp(desc, ref, sizeof(ref)) != 0)
+		return;
+
+	tmpl->cacheable = 1;
+}
+
+/**
+ * sd_tmpl_get - build a shared descriptor from a template of the cache
+ * @cache: template cache, NULL to always use the constructor
+ * @key: what the descriptor is built for, see sd_tmpl_key_init()
+ * @descbuf: pointer to descriptor-under-construction buffer
+ * @cipherdata: pointer to block cipher transform definitions, or NULL
+ * @authdata: pointer to authentication transform definitions, or NULL
+ *
+ * Return: size of descriptor written in words or negative number on error
+ */
+static inline int sd_tmpl_get(struct sd_tmpl_cache *cache,
+			      const struct sd_tmpl_key *key, uint32_t *descbuf,
+			      struct alginfo *cipherdata,
+			      struct alginfo *authdata)
+{
+	struct sd_tmpl *tmpl;
+
+	if (cache == NULL)
+		return sd_tmpl_cnstr(key, descbuf, cipherdata, authdata);
+
+	tmpl = &cache->tmpl[sd_tmpl_key_hash(key) & (SD_TMPL_CACHE_SIZE - 1)];
+	if (tmpl->len != 0 && memcmp(&tmpl->key, key, sizeof(*key)) == 0) {
+		if (!tmpl->cacheable) {
+			cache->misses++;
+			return sd_tmpl_cnstr(key, descbuf, cipherdata,
+					     authdata);
+		}
+		cache->hits++;
+		return sd_tmpl_clone(tmpl, descbuf, cipherdata, authdata);
+	}
+
+	cache->misses++;
+	sd_tmpl_compile(tmpl, key, cipherdata, authdata);
+	if (!tmpl->cacheable)
+		return sd_tmpl_cnstr(key, descbuf, cipherdata, authdata);
+
+	return sd_tmpl_clone(tmpl, descbuf, cipherdata, authdata);
+}
+
+/**
+ * sd_tmpl_blkcipher - cnstr_shdsc_blkcipher(), IV taken from the input frame
+ * @cache: template cache, NULL to always use the constructor
+ *
+ * See cnstr_shdsc_blkcipher() for the other parameters.
+ *
+ * Return: size of descriptor written in words or negative number on error
+ */
+static inline int sd_tmpl_blkcipher(struct sd_tmpl_cache *cache,
+				    uint32_t *descbuf, bool ps, bool swap,
+				    struct alginfo *cipherdata, uint32_t ivlen,
+				    uint8_t dir)
+{
+	struct sd_tmpl_key key;
+
+	sd_tmpl_key_init(&key, SD_TMPL_BLKCIPHER, ps, swap, cipherdata, NULL);
+	key.ivlen = ivlen;
+	key.dir = dir;
+
+	return sd_tmpl_get(cache, &key, descbuf, cipherdata, NULL);
+}
+
+/**
+ * sd_tmpl_hmac - cnstr_shdsc_hmac() through a template cache
+ * @cache: template cache, NULL to always use the constructor
+ *
+ * See cnstr_shdsc_hmac() for the other parameters.
+ *
+ * Return: size of descriptor written in words or negative number on error
+ */
+static inline int sd_tmpl_hmac(struct sd_tmpl_cache *cache, uint32_t *descbuf,
+			       bool ps, bool swap, struct alginfo *authdata,
+			       uint8_t do_icv, uint8_t trunc_len)
+{
+	struct sd_tmpl_key key;
+
+	sd_tmpl_key_init(&key, SD_TMPL_HMAC, ps, swap, NULL, authdata);
+	key.dir = do_icv;
+	key.trunc_len = trunc_len;
+
+	return sd_tmpl_get(cache, &key, descbuf, NULL, authdata);
+}
+
+/**
+ * sd_tmpl_authenc - cnstr_shdsc_authenc() through a template cache
+ * @cache: template cache, NULL to always use the constructor
+ *
+ * See cnstr_shdsc_authenc() for the other parameters.
+ *
+ * Return: size of descriptor written in words or negative number on error
+ */
+static inline int sd_tmpl_authenc(struct sd_tmpl_cache *cache,
+				  uint32_t *descbuf, bool ps, bool swap,
+				  struct alginfo *cipherdata,
+				  struct alginfo *authdata, uint16_t ivlen,
+				  uint16_t auth_only_len, uint8_t trunc_len,
+				  uint8_t dir)
+{
+	struct sd_tmpl_key key;
+
+	sd_tmpl_key_init(&key, SD_TMPL_AUTHENC, ps, swap, cipherdata,
+			 authdata);
+	key.ivlen = ivlen;
+	key.auth_only_len = auth_only_len;
+	key.trunc_len = trunc_len;
+	key.dir = dir;
+
+	return sd_tmpl_get(cache, &key, descbuf, cipherdata, authdata);
+}
+
+#endif /* __DESC_SD_TMPL_H__ */
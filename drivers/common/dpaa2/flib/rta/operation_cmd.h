@@ -27,7 +27,7 @@ static inline int __rta_alg_aai_aes(uint16_t aai)
 	case OP_ALG_AAI_CTR_CMAC:
 		if (rta_sec_era < RTA_SEC_ERA_2)
 			return -EINVAL;
-		/* no break */
+		/* fall through */
 	case OP_ALG_AAI_CTR:
 	case OP_ALG_AAI_CBC:
 	case OP_ALG_AAI_ECB:
@@ -67,7 +67,7 @@ static inline int __rta_alg_aai_md5(uint16_t aai)
 	case OP_ALG_AAI_HMAC:
 		if (rta_sec_era < RTA_SEC_ERA_2)
 			return -EINVAL;
-		/* no break */
+		/* fall through */
 	case OP_ALG_AAI_SMAC:
 	case OP_ALG_AAI_HASH:
 	case OP_ALG_AAI_HMAC_PRECOMP:
@@ -83,7 +83,7 @@ static inline int __rta_alg_aai_sha(uint16_t aai)
 	case OP_ALG_AAI_HMAC:
 		if (rta_sec_era < RTA_SEC_ERA_2)
 			return -EINVAL;
-		/* no break */
+		/* fall through */
 	case OP_ALG_AAI_HASH:
 	case OP_ALG_AAI_HMAC_PRECOMP:
 		return 0;
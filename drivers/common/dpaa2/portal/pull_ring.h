@@ -0,0 +1,317 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2017 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef _PULL_RING_H_
+#define _PULL_RING_H_
+
+/**
+ * @file
+ *
+ * Pipelined volatile dequeues over the frame queues served by a portal.
+ *
+ * A portal takes one volatile dequeue command at a time, and takes the next
+ * one as soon as QBMan has fetched the previous one, which is seen from the
+ * token of its first result. The ring keeps a pull outstanding on each of
+ * up to PULL_RING_SIZE frame queues, taken in turn from those added to it,
+ * each with its own dequeue storage. The results are read in the order of
+ * the pulls, without waiting for QBMan: a pull whose results are not written
+ * yet is left for the next poll, and a pull whose results have been read is
+ * issued again on the next queue.
+ *
+ * One poll thus returns frames of all the queues of the portal, see
+ * rx_demux.h to hand them to their receive queue, and an lcore serving many
+ * queues does not wait for the round trip of a pull per queue.
+ *
+ * The ring belongs to the portal it is set up with and is not thread safe,
+ * another thread releasing a queue has to be serialized with the polls.
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_branch_prediction.h>
+#include <rte_memory.h>
+#include <rte_prefetch.h>
+
+#include <fsl_qbman_portal.h>
+
+/** Pulls outstanding at most, a power of 2 */
+#define PULL_RING_SIZE		8
+/** Frames dequeued by a pull */
+#define PULL_RING_NUM_DQ	16
+/** Frame queues served by a ring */
+#define PULL_RING_MAX_QUEUES	64
+
+/** Statistics of a ring */
+struct pull_ring_stats {
+	uint64_t pulls;		/**< Volatile dequeue commands issued */
+	uint64_t empty;		/**< Pulls which returned no frame */
+	uint64_t busy;		/**< Pulls deferred, the portal being busy */
+};
+
+struct pull_ring_slot {
+	void *queue;		/**< Queue pulled, NULL once deleted */
+	uint16_t next;		/**< Next result to read */
+	uint16_t fetched;	/**< Command taken by QBMan */
+};
+
+struct pull_ring {
+	/** Dequeue storage of the pulls */
+	struct qbman_result storage[PULL_RING_SIZE][PULL_RING_NUM_DQ]
+		__rte_cache_aligned;
+	struct qbman_swp *swp;
+	uint64_t storage_iova;	/**< IO address of the storage */
+	uint16_t head;		/**< Oldest outstanding pull */
+	uint16_t tail;		/**< Next pull to issue */
+	uint16_t nb_queues;
+	uint16_t next_queue;	/**< Next queue to pull */
+	struct pull_ring_slot slot[PULL_RING_SIZE];
+	uint32_t fqid[PULL_RING_MAX_QUEUES];
+	void *queue[PULL_RING_MAX_QUEUES];
+	struct pull_ring_stats stats;
+} __rte_cache_aligned;
+
+/**
+ * Set up a ring on a portal.
+ *
+ * @param storage_iova
+ *   IO address of ring->storage, as seen by QBMan.
+ */
+static inline void
+pull_ring_init(struct pull_ring *ring, struct qbman_swp *swp,
+	       uint64_t storage_iova)
+{
+	memset(ring, 0, sizeof(*ring));
+	ring->swp = swp;
+	ring->storage_iova = storage_iova;
+}
+
+/** Number of pulls outstanding, or not read to the end */
+static inline unsigned int
+pull_ring_count(const struct pull_ring *ring)
+{
+	return (uint16_t)(ring->tail - ring->head);
+}
+
+/**
+ * Add a frame queue to the queues pulled in turn.
+ *
+ * @param queue
+ *   Returned with the frames of the queue.
+ * @return
+ *   0 for success, -ENOSPC if the ring serves PULL_RING_MAX_QUEUES already.
+ */
+static inline int
+pull_ring_add_queue(struct pull_ring *ring, uint32_t fqid, void *queue)
+{
+	if (ring->nb_queues == PULL_RING_MAX_QUEUES)
+		return -ENOSPC;
+	ring->fqid[ring->nb_queues] = fqid;
+	ring->queue[ring->nb_queues] = queue;
+	ring->nb_queues++;
+	return 0;
+}
+
+/**
+ * Issue no more pulls on a queue. The frames of its outstanding pulls are
+ * still returned with the queue.
+ */
+static inline void
+pull_ring_stop_queue(struct pull_ring *ring, void *queue)
+{
+	uint16_t i, j;
+
+	for (i = 0, j = 0; i < ring->nb_queues; i++) {
+		if (ring->queue[i] == queue)
+			continue;
+		ring->fqid[j] = ring->fqid[i];
+		ring->queue[j] = ring->queue[i];
+		j++;
+	}
+	ring->nb_queues = j;
+	if (ring->next_queue >= j)
+		ring->next_queue = 0;
+}
+
+/** Number of pulls of a queue outstanding, or not read to the end */
+static inline unsigned int
+pull_ring_queue_pending(const struct pull_ring *ring, const void *queue)
+{
+	unsigned int n = 0;
+	uint16_t i;
+
+	for (i = ring->head; i != ring->tail; i++)
+		if (ring->slot[i & (PULL_RING_SIZE - 1)].queue == queue)
+			n++;
+	return n;
+}
+
+/**
+ * Stop pulling a queue. The frames of its outstanding pulls are still
+ * returned, with a NULL queue.
+ */
+static inline void
+pull_ring_del_queue(struct pull_ring *ring, void *queue)
+{
+	uint16_t i;
+
+	pull_ring_stop_queue(ring, queue);
+	for (i = 0; i < PULL_RING_SIZE; i++)
+		if (ring->slot[i].queue == queue)
+			ring->slot[i].queue = NULL;
+}
+
+/** Whether a dequeue storage is one of the ring */
+static inline int
+pull_ring_owns(const struct pull_ring *ring, const struct qbman_result *dq)
+{
+	return dq >= &ring->storage[0][0] &&
+	       dq < &ring->storage[PULL_RING_SIZE][0];
+}
+
+/**
+ * Storage of the last pull issued, when QBMan has not fetched it yet, and
+ * the portal takes no other pull. NULL otherwise.
+ */
+static inline struct qbman_result *
+pull_ring_pending(struct pull_ring *ring)
+{
+	uint16_t last = (ring->tail - 1) & (PULL_RING_SIZE - 1);
+
+	if (ring->head == ring->tail || ring->slot[last].fetched)
+		return NULL;
+	return ring->storage[last];
+}
+
+/**
+ * Issue pulls on the next queues, one per queue at most, until the ring is
+ * full or the portal is busy with a pull not fetched yet.
+ *
+ * @return
+ *   Number of pulls issued.
+ */
+static inline unsigned int
+pull_ring_issue(struct pull_ring *ring)
+{
+	unsigned int depth = RTE_MIN(ring->nb_queues, PULL_RING_SIZE);
+	struct qbman_pull_desc pulldesc;
+	struct pull_ring_slot *slot;
+	struct qbman_result *dq;
+	unsigned int n = 0;
+	uint16_t idx;
+
+	while (pull_ring_count(ring) < depth) {
+		dq = pull_ring_pending(ring);
+		if (dq) {
+			if (!qbman_check_command_complete(ring->swp, dq))
+				break;
+			ring->slot[(ring->tail - 1) &
+				   (PULL_RING_SIZE - 1)].fetched = 1;
+		}
+		idx = ring->tail & (PULL_RING_SIZE - 1);
+		dq = ring->storage[idx];
+		qbman_pull_desc_clear(&pulldesc);
+		qbman_pull_desc_set_numframes(&pulldesc, PULL_RING_NUM_DQ);
+		qbman_pull_desc_set_fq(&pulldesc,
+				       ring->fqid[ring->next_queue]);
+		qbman_pull_desc_set_storage(&pulldesc, dq,
+			(dma_addr_t)(ring->storage_iova +
+				     (uintptr_t)dq -
+				     (uintptr_t)ring->storage), 1);
+		if (qbman_swp_pull(ring->swp, &pulldesc)) {
+			/* Pull of another user of the portal */
+			ring->stats.busy++;
+			break;
+		}
+		slot = &ring->slot[idx];
+		slot->queue = ring->queue[ring->next_queue];
+		slot->next = 0;
+		slot->fetched = 0;
+		if (++ring->next_queue == ring->nb_queues)
+			ring->next_queue = 0;
+		ring->tail++;
+		ring->stats.pulls++;
+		n++;
+	}
+	return n;
+}
+
+/**
+ * Next frame dequeued by the pulls of the ring, in the order of the pulls.
+ *
+ * The result stays valid until the next pull_ring_issue().
+ *
+ * @param queue
+ *   Set to the queue of the frame.
+ * @return
+ *   The dequeue result of the frame, or NULL if QBMan has not written the
+ *   next one yet, or no pull is outstanding.
+ */
+static inline const struct qbman_result *
+pull_ring_next(struct pull_ring *ring, void **queue)
+{
+	struct pull_ring_slot *slot;
+	const struct qbman_result *dq;
+	uint16_t idx;
+
+	while (ring->head != ring->tail) {
+		idx = ring->head & (PULL_RING_SIZE - 1);
+		slot = &ring->slot[idx];
+		dq = &ring->storage[idx][slot->next];
+		if (!slot->fetched) {
+			if (!qbman_check_command_complete(ring->swp, dq))
+				return NULL;
+			slot->fetched = 1;
+		}
+		if (!qbman_result_has_new_result(ring->swp, dq))
+			return NULL;
+		rte_prefetch0(dq + 1);
+		slot->next++;
+		if (qbman_result_DQ_is_pull_complete(dq)) {
+			ring->head++;
+			if (unlikely(!(qbman_result_DQ_flags(dq) &
+				       QBMAN_DQ_STAT_VALIDFRAME))) {
+				if (slot->next == 1)
+					ring->stats.empty++;
+				continue;
+			}
+		}
+		*queue = slot->queue;
+		return dq;
+	}
+	return NULL;
+}
+
+#endif /* _PULL_RING_H_ */
@@ -0,0 +1,822 @@
+/* Copyright 2017 NXP.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of NXP nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NXP BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/* Software QBMan, see fsl_qbman_sw.h.
+ *
+ * The emulator thread polls the EQCR, RCR, CR and VDQCR of every portal in
+ * their CENA areas, which are plain memory, exactly as the portal code
+ * expects QBMan to pick them up, and it writes back the EQCR consumer index,
+ * the command responses and the dequeue results. The few CINH registers the
+ * portal code relies on (EQAR, RAR, DCAP, ...) are serviced in the caller's
+ * context by qbman_sw_cinh_read()/qbman_sw_cinh_write().
+ *
+ * Frame queues, queuing destinations and buffer pools live in tables guarded
+ * by a single spinlock, held by the emulator for each pass over the portals.
+ */
+
+#include "qbman_portal.h"
+#include <drivers/fsl_qbman_sw.h>
+
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#error "Software QBMan only supports little endian hosts"
+#endif
+
+/* Same register offsets as in qbman_portal.c */
+#define QBMAN_CINH_SWP_EQCR_PI 0x800
+#define QBMAN_CINH_SWP_EQCR_CI 0x840
+#define QBMAN_CINH_SWP_EQAR    0x8c0
+#define QBMAN_CINH_SWP_DQPI    0xa00
+#define QBMAN_CINH_SWP_DCAP    0xac0
+#define QBMAN_CINH_SWP_RAR     0xcc0
+
+#define QBMAN_CENA_SWP_EQCR(n) (0x000 + ((uint32_t)(n) << 6))
+#define QBMAN_CENA_SWP_DQRR(n) (0x200 + ((uint32_t)(n) << 6))
+#define QBMAN_CENA_SWP_RCR(n)  (0x400 + ((uint32_t)(n) << 6))
+#define QBMAN_CENA_SWP_CR      0x600
+#define QBMAN_CENA_SWP_RR(vb)  (0x700 + ((uint32_t)(vb) >> 1))
+#define QBMAN_CENA_SWP_VDQCR   0x780
+#define QBMAN_CENA_SWP_EQCR_CI 0x840
+
+#define QBMAN_MC_ACQUIRE       0x30
+#define QBMAN_RESULT_DQ        0x60
+
+/* EQCR and RCR have 8 entries, their indexes run modulo 16, the upper bit
+ * standing for the valid-bit polarity of the lap.
+ */
+#define QBMAN_SW_RING_SIZE     8
+#define QBMAN_SW_RING_MASK     0xf
+#define QBMAN_SW_RING_VB(i)    (((i) & QBMAN_SW_RING_SIZE) ? 0 : QB_VALID_BIT)
+
+#define QBMAN_SW_MAX_PORTALS   64
+#define QBMAN_SW_MAX_FQS       4096
+#define QBMAN_SW_MAX_QDS       256
+#define QBMAN_SW_MAX_BPS       0x4000
+#define QBMAN_SW_FQ_INIT_DEPTH 64
+#define QBMAN_SW_BP_INIT_DEPTH 256
+
+/* FD fields the emulator looks at */
+#define QBMAN_SW_FD_BPID(fd)   ((fd)->simple.bpid_offset & 0x3fff)
+#define QBMAN_SW_FD_IVP(fd)    ((fd)->simple.bpid_offset & 0x4000)
+
+struct qbman_sw_fq {
+	uint32_t fqid;
+	uint32_t chid;
+	uint64_t ctx;
+	struct qbman_fd *ring;
+	uint32_t size; /* power of 2 */
+	uint32_t head;
+	uint32_t tail;
+	uint32_t bytes;
+};
+
+struct qbman_sw_qd {
+	uint32_t qdid;
+	uint32_t fqid;
+	uint16_t nb_bins;
+	uint64_t tx;
+};
+
+struct qbman_sw_bp {
+	uint64_t *bufs;
+	uint32_t count;
+	uint32_t size;
+};
+
+/* Volatile dequeue command being serviced */
+struct qbman_sw_vdq {
+	int active;
+	uint8_t dt;
+	uint8_t rls;
+	uint8_t token;
+	uint8_t delivered;
+	uint8_t remaining;
+	uint32_t src;
+	uint8_t *storage;
+};
+
+struct qbman_sw_portal {
+	uint8_t *cena;
+	int idx;
+	uint8_t dqrr_size;
+	enum qbman_eqcr_mode eqcr_mode;
+	uint32_t regs[0x1000 / 4];
+	/* Shared with the portal owner */
+	uint32_t eqcr_ci;
+	uint32_t rcr_ci;
+	uint32_t dqrr_pi;
+	uint32_t dqrr_busy;
+	/* Owned by the portal owner */
+	uint32_t eqar_pi;
+	uint32_t rar_pi;
+	/* Owned by the emulator */
+	uint32_t cr_vb;
+	uint32_t vdqcr_vb;
+	uint32_t dqrr_vb;
+	uint32_t ch_cursor;
+	struct qbman_sw_vdq vdq;
+};
+
+static struct {
+	pthread_spinlock_t lock;
+	pthread_mutex_t portal_lock;
+	pthread_t thread;
+	int running;
+	int nb_portals;
+	struct qbman_sw_portal *portals[QBMAN_SW_MAX_PORTALS];
+	/* Frame queues are kept in 'fqs' in creation order, indexed by fqid
+	 * through the open addressing table 'fq_hash' (0 is an empty slot,
+	 * otherwise the index in 'fqs' plus 1).
+	 */
+	uint32_t nb_fqs;
+	struct qbman_sw_fq fqs[QBMAN_SW_MAX_FQS];
+	uint16_t fq_hash[QBMAN_SW_MAX_FQS * 2];
+	uint32_t nb_qds;
+	struct qbman_sw_qd qds[QBMAN_SW_MAX_QDS];
+	struct qbman_sw_bp bps[QBMAN_SW_MAX_BPS];
+} qbman_sw = {
+	.portal_lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+static pthread_once_t qbman_sw_once = PTHREAD_ONCE_INIT;
+
+static void qbman_sw_init_once(void)
+{
+	pthread_spin_init(&qbman_sw.lock, PTHREAD_PROCESS_PRIVATE);
+}
+
+static inline void qbman_sw_lock(void)
+{
+	pthread_once(&qbman_sw_once, qbman_sw_init_once);
+	pthread_spin_lock(&qbman_sw.lock);
+}
+
+static inline void qbman_sw_unlock(void)
+{
+	pthread_spin_unlock(&qbman_sw.lock);
+}
+
+	/****************/
+	/* Frame queues */
+	/****************/
+
+static inline uint32_t qbman_sw_fq_hash(uint32_t fqid)
+{
+	return (fqid * 2654435761u) & (QBMAN_SW_MAX_FQS * 2 - 1);
+}
+
+/* Lookup 'fqid', creating the frame queue if 'create' is set. Lock held. */
+static struct qbman_sw_fq *qbman_sw_fq_get(uint32_t fqid, int create)
+{
+	uint32_t h = qbman_sw_fq_hash(fqid);
+	struct qbman_sw_fq *fq;
+
+	while (qbman_sw.fq_hash[h]) {
+		fq = &qbman_sw.fqs[qbman_sw.fq_hash[h] - 1];
+		if (fq->fqid == fqid)
+			return fq;
+		h = (h + 1) & (QBMAN_SW_MAX_FQS * 2 - 1);
+	}
+	if (!create || qbman_sw.nb_fqs == QBMAN_SW_MAX_FQS)
+		return NULL;
+	fq = &qbman_sw.fqs[qbman_sw.nb_fqs++];
+	memset(fq, 0, sizeof(*fq));
+	fq->fqid = fqid;
+	qbman_sw.fq_hash[h] = (uint16_t)qbman_sw.nb_fqs;
+	return fq;
+}
+
+static inline uint32_t qbman_sw_fq_len(const struct qbman_sw_fq *fq)
+{
+	return fq->tail - fq->head;
+}
+
+static int qbman_sw_fq_push(struct qbman_sw_fq *fq, const struct qbman_fd *fd)
+{
+	if (qbman_sw_fq_len(fq) == fq->size) {
+		uint32_t size = fq->size ? fq->size * 2 : QBMAN_SW_FQ_INIT_DEPTH;
+		struct qbman_fd *ring = malloc(size * sizeof(*ring));
+		uint32_t i;
+
+		if (!ring)
+			return -ENOMEM;
+		for (i = 0; i < fq->size; i++)
+			ring[i] = fq->ring[(fq->head + i) & (fq->size - 1)];
+		free(fq->ring);
+		fq->ring = ring;
+		fq->tail -= fq->head;
+		fq->head = 0;
+		fq->size = size;
+	}
+	fq->ring[fq->tail++ & (fq->size - 1)] = *fd;
+	fq->bytes += fd->simple.len;
+	return 0;
+}
+
+static int qbman_sw_fq_pop(struct qbman_sw_fq *fq, struct qbman_fd *fd)
+{
+	if (fq->head == fq->tail)
+		return -ENOENT;
+	*fd = fq->ring[fq->head++ & (fq->size - 1)];
+	fq->bytes -= fd->simple.len;
+	return 0;
+}
+
+	/****************/
+	/* Buffer pools */
+	/****************/
+
+static void qbman_sw_bp_put(uint32_t bpid, uint64_t buf)
+{
+	struct qbman_sw_bp *bp = &qbman_sw.bps[bpid & (QBMAN_SW_MAX_BPS - 1)];
+
+	if (bp->count == bp->size) {
+		uint32_t size = bp->size ? bp->size * 2 : QBMAN_SW_BP_INIT_DEPTH;
+		uint64_t *bufs = realloc(bp->bufs, size * sizeof(*bufs));
+
+		if (!bufs) {
+			pr_err("Software BMan: buffer leaked from BPID %u\n",
+			       bpid);
+			return;
+		}
+		bp->bufs = bufs;
+		bp->size = size;
+	}
+	bp->bufs[bp->count++] = buf;
+}
+
+static unsigned int qbman_sw_bp_get(uint32_t bpid, uint64_t *bufs,
+				    unsigned int num)
+{
+	struct qbman_sw_bp *bp = &qbman_sw.bps[bpid & (QBMAN_SW_MAX_BPS - 1)];
+	unsigned int i;
+
+	if (num > bp->count)
+		num = bp->count;
+	for (i = 0; i < num; i++)
+		bufs[i] = bp->bufs[--bp->count];
+	return num;
+}
+
+	/*************************/
+	/* Queuing destinations */
+	/*************************/
+
+static struct qbman_sw_qd *qbman_sw_qd_get(uint32_t qdid, int create)
+{
+	struct qbman_sw_qd *qd;
+	uint32_t i;
+
+	for (i = 0; i < qbman_sw.nb_qds; i++)
+		if (qbman_sw.qds[i].qdid == qdid)
+			return &qbman_sw.qds[i];
+	if (!create || qbman_sw.nb_qds == QBMAN_SW_MAX_QDS)
+		return NULL;
+	qd = &qbman_sw.qds[qbman_sw.nb_qds++];
+	memset(qd, 0, sizeof(*qd));
+	qd->qdid = qdid;
+	return qd;
+}
+
+/* Send a frame to a frame queue, or transmit it, ie. free its buffer */
+static void qbman_sw_route(uint32_t fqid, struct qbman_sw_qd *qd,
+			   const struct qbman_fd *fd)
+{
+	struct qbman_sw_fq *fq;
+
+	if (fqid) {
+		fq = qbman_sw_fq_get(fqid, 1);
+		if (fq && !qbman_sw_fq_push(fq, fd))
+			return;
+		pr_err("Software QMan: frame dropped on FQID %u\n", fqid);
+	} else if (qd) {
+		qd->tx++;
+	}
+	if (!QBMAN_SW_FD_IVP(fd))
+		qbman_sw_bp_put(QBMAN_SW_FD_BPID(fd),
+				((uint64_t)fd->simple.addr_hi << 32) |
+				fd->simple.addr_lo);
+}
+
+	/*************************/
+	/* Portal command service */
+	/*************************/
+
+static inline uint32_t qbman_sw_load_verb(const uint8_t *addr)
+{
+	return __atomic_load_n((const uint32_t *)addr, __ATOMIC_ACQUIRE);
+}
+
+static inline void qbman_sw_store(uint8_t *addr, uint32_t val)
+{
+	__atomic_store_n((uint32_t *)addr, val, __ATOMIC_RELEASE);
+}
+
+static int qbman_sw_service_eqcr(struct qbman_sw_portal *p)
+{
+	uint32_t ci = p->eqcr_ci;
+	int n;
+
+	for (n = 0; n < QBMAN_SW_RING_SIZE; n++) {
+		const uint32_t *e = (const uint32_t *)
+			(p->cena + QBMAN_CENA_SWP_EQCR(ci & 7));
+		uint32_t verb = qbman_sw_load_verb((const uint8_t *)e);
+		const struct qbman_fd *fd = (const struct qbman_fd *)&e[8];
+
+		if ((verb & QB_VALID_BIT) != QBMAN_SW_RING_VB(ci))
+			break;
+		if (verb & (1 << 15)) {
+			/* Discrete consumption acknowledgment of DQRR */
+			uint32_t idx = (verb >> 8) & (p->dqrr_size - 1);
+
+			__atomic_fetch_and(&p->dqrr_busy, ~(1u << idx),
+					   __ATOMIC_RELEASE);
+		}
+		if (verb & 0x3) {
+			uint32_t tgt = e[2] & 0xffffff;
+
+			if (verb & (1 << 4)) {
+				struct qbman_sw_qd *qd = qbman_sw_qd_get(tgt, 1);
+				uint32_t fqid = 0;
+
+				if (qd && qd->fqid)
+					fqid = qd->fqid + (e[4] & 0xffff) +
+					       ((e[4] >> 16) & 0xf) *
+					       qd->nb_bins;
+				qbman_sw_route(fqid, qd, fd);
+			} else {
+				qbman_sw_route(tgt, NULL, fd);
+			}
+		}
+		ci = (ci + 1) & QBMAN_SW_RING_MASK;
+		__atomic_store_n(&p->eqcr_ci, ci, __ATOMIC_RELEASE);
+		qbman_sw_store(p->cena + QBMAN_CENA_SWP_EQCR_CI, ci);
+	}
+	return n;
+}
+
+static int qbman_sw_service_rcr(struct qbman_sw_portal *p)
+{
+	uint32_t ci = p->rcr_ci;
+	int n;
+
+	for (n = 0; n < QBMAN_SW_RING_SIZE; n++) {
+		const uint8_t *e = p->cena + QBMAN_CENA_SWP_RCR(ci & 7);
+		uint32_t verb = qbman_sw_load_verb(e);
+		unsigned int i, num = verb & 0x7;
+		uint64_t buf;
+
+		if ((verb & QB_VALID_BIT) != QBMAN_SW_RING_VB(ci))
+			break;
+		for (i = 0; i < num; i++) {
+			memcpy(&buf, e + 8 + i * 8, sizeof(buf));
+			qbman_sw_bp_put(verb >> 16, buf);
+		}
+		ci = (ci + 1) & QBMAN_SW_RING_MASK;
+		__atomic_store_n(&p->rcr_ci, ci, __ATOMIC_RELEASE);
+	}
+	return n;
+}
+
+static int qbman_sw_service_cr(struct qbman_sw_portal *p)
+{
+	const uint32_t *cmd = (const uint32_t *)(p->cena + QBMAN_CENA_SWP_CR);
+	uint32_t verb = qbman_sw_load_verb((const uint8_t *)cmd);
+	uint32_t *rr = (uint32_t *)(p->cena + QBMAN_CENA_SWP_RR(p->cr_vb));
+	uint32_t *next_rr = (uint32_t *)(p->cena +
+				QBMAN_CENA_SWP_RR(p->cr_vb ^ QB_VALID_BIT));
+	uint64_t bufs[7];
+	unsigned int num;
+
+	if ((verb & QB_VALID_BIT) != p->cr_vb)
+		return 0;
+	verb &= 0x7f;
+	/* The response to the next command goes to the other RR, which holds
+	 * an old response until then.
+	 */
+	next_rr[0] = 0;
+	memset(&rr[1], 0, 60);
+	if (verb == QBMAN_MC_ACQUIRE) {
+		num = qbman_sw_bp_get(cmd[0] >> 16, bufs, cmd[1] & 0x7);
+		rr[1] = num;
+		memcpy(&rr[2], bufs, num * sizeof(bufs[0]));
+	}
+	/* Anything else, FQ state changes and CDAN settings, is only acked */
+	qbman_sw_store((uint8_t *)rr, verb | (QBMAN_MC_RSLT_OK << 8));
+	p->cr_vb ^= QB_VALID_BIT;
+	return 1;
+}
+
+/* Pick the frame queue the volatile dequeue takes its next frame from */
+static struct qbman_sw_fq *qbman_sw_vdq_source(struct qbman_sw_portal *p)
+{
+	struct qbman_sw_vdq *vdq = &p->vdq;
+	struct qbman_sw_fq *fq;
+	uint32_t chid, i;
+
+	if (vdq->dt == 2)
+		return qbman_sw_fq_get(vdq->src, 0);
+	/* Channel, or work queue of a channel: round robin over its FQs */
+	chid = vdq->dt == 1 ? vdq->src >> 3 : vdq->src;
+	for (i = 0; i < qbman_sw.nb_fqs; i++) {
+		fq = &qbman_sw.fqs[(p->ch_cursor + i) % qbman_sw.nb_fqs];
+		if (fq->chid == chid && qbman_sw_fq_len(fq)) {
+			p->ch_cursor = (uint32_t)(fq - qbman_sw.fqs) + 1;
+			return fq;
+		}
+	}
+	return NULL;
+}
+
+/* Write a dequeue result, with its valid-bit or token last */
+static void qbman_sw_write_dq(struct qbman_sw_portal *p, uint8_t *dst,
+			      uint32_t vb, uint32_t stat, uint32_t fqid,
+			      const struct qbman_sw_fq *fq,
+			      const struct qbman_fd *fd)
+{
+	uint32_t *r = (uint32_t *)dst;
+	uint32_t verb = QBMAN_RESULT_DQ | vb | (stat << 8);
+
+	r[2] = fqid;
+	r[3] = 0;
+	r[4] = fq ? fq->bytes : 0;
+	r[5] = fq ? qbman_sw_fq_len(fq) : 0;
+	if (fq)
+		memcpy(&r[6], &fq->ctx, sizeof(fq->ctx));
+	else
+		memset(&r[6], 0, 8);
+	if (fd)
+		memcpy(&r[8], fd, sizeof(*fd));
+	else
+		memset(&r[8], 0, sizeof(*fd));
+	if (p->vdq.rls) {
+		r[0] = verb;
+		qbman_sw_store((uint8_t *)&r[1],
+			       (uint32_t)p->vdq.token << 24);
+	} else {
+		r[1] = (uint32_t)p->vdq.token << 24;
+		qbman_sw_store(dst, verb);
+	}
+}
+
+static int qbman_sw_service_vdq(struct qbman_sw_portal *p)
+{
+	struct qbman_sw_vdq *vdq = &p->vdq;
+	const uint32_t *cmd;
+	uint32_t verb, stat;
+	struct qbman_sw_fq *fq;
+	struct qbman_fd fd;
+	uint8_t *dst;
+	int n = 0;
+
+	if (!vdq->active) {
+		cmd = (const uint32_t *)(p->cena + QBMAN_CENA_SWP_VDQCR);
+		verb = qbman_sw_load_verb((const uint8_t *)cmd);
+		if ((verb & QB_VALID_BIT) != p->vdqcr_vb)
+			return 0;
+		p->vdqcr_vb ^= QB_VALID_BIT;
+		vdq->active = 1;
+		vdq->dt = (verb >> 2) & 0x3;
+		vdq->rls = (verb >> 4) & 0x1;
+		vdq->remaining = ((verb >> 8) & 0xf) + 1;
+		vdq->token = (uint8_t)(verb >> 16);
+		vdq->delivered = 0;
+		vdq->src = cmd[1] & 0xffffff;
+		vdq->storage = (uint8_t *)(uintptr_t)
+			(((uint64_t)cmd[3] << 32) | cmd[2]);
+	}
+
+	while (vdq->active) {
+		if (vdq->rls) {
+			dst = vdq->storage + vdq->delivered * 64;
+		} else {
+			uint32_t pi = p->dqrr_pi;
+
+			if (__atomic_load_n(&p->dqrr_busy, __ATOMIC_ACQUIRE) &
+			    (1u << pi))
+				break;
+			dst = p->cena + QBMAN_CENA_SWP_DQRR(pi);
+		}
+		stat = QBMAN_DQ_STAT_VOLATILE;
+		fq = qbman_sw_vdq_source(p);
+		if (fq && !qbman_sw_fq_pop(fq, &fd)) {
+			stat |= QBMAN_DQ_STAT_VALIDFRAME;
+			vdq->remaining--;
+			if (!qbman_sw_fq_len(fq))
+				stat |= QBMAN_DQ_STAT_FQEMPTY;
+			/* A channel dequeue carries on with the other FQs */
+			if (!vdq->remaining ||
+			    (vdq->dt == 2 && !qbman_sw_fq_len(fq)) ||
+			    (vdq->dt != 2 && !qbman_sw_vdq_source(p)))
+				stat |= QBMAN_DQ_STAT_EXPIRED;
+		} else {
+			/* Nothing to dequeue, expire with an empty result */
+			stat |= QBMAN_DQ_STAT_EXPIRED | QBMAN_DQ_STAT_FQEMPTY;
+		}
+		qbman_sw_write_dq(p, dst, vdq->rls ? 0 : p->dqrr_vb, stat,
+				  fq ? fq->fqid : vdq->src, fq,
+				  (stat & QBMAN_DQ_STAT_VALIDFRAME) ? &fd : NULL);
+		vdq->delivered++;
+		n++;
+		if (!vdq->rls) {
+			__atomic_fetch_or(&p->dqrr_busy, 1u << p->dqrr_pi,
+					  __ATOMIC_RELAXED);
+			if (++p->dqrr_pi == p->dqrr_size) {
+				p->dqrr_pi = 0;
+				p->dqrr_vb ^= QB_VALID_BIT;
+			}
+		}
+		if (stat & QBMAN_DQ_STAT_EXPIRED)
+			vdq->active = 0;
+	}
+	return n;
+}
+
+static void *qbman_sw_thread(void *arg __always_unused)
+{
+	struct qbman_sw_portal *p;
+	int i, work;
+
+	while (__atomic_load_n(&qbman_sw.running, __ATOMIC_ACQUIRE)) {
+		work = 0;
+		qbman_sw_lock();
+		for (i = 0; i < QBMAN_SW_MAX_PORTALS; i++) {
+			p = qbman_sw.portals[i];
+			if (!p)
+				continue;
+			work += qbman_sw_service_eqcr(p);
+			work += qbman_sw_service_rcr(p);
+			work += qbman_sw_service_cr(p);
+			work += qbman_sw_service_vdq(p);
+		}
+		qbman_sw_unlock();
+		if (!work)
+			sched_yield();
+	}
+	return NULL;
+}
+
+	/*****************/
+	/* Portal access */
+	/*****************/
+
+struct qbman_sw_portal *qbman_sw_portal_create(int idx, uint8_t dqrr_size,
+					       enum qbman_eqcr_mode eqcr_mode)
+{
+	struct qbman_sw_portal *p;
+	void *cena;
+	int ret;
+
+	if (idx < 0 || idx >= QBMAN_SW_MAX_PORTALS)
+		return NULL;
+	p = calloc(1, sizeof(*p));
+	if (!p)
+		return NULL;
+	if (posix_memalign(&cena, QBMAN_SW_CENA_SIZE, QBMAN_SW_CENA_SIZE)) {
+		free(p);
+		return NULL;
+	}
+	memset(cena, 0, QBMAN_SW_CENA_SIZE);
+	p->cena = cena;
+	p->idx = idx;
+	p->dqrr_size = dqrr_size;
+	p->eqcr_mode = eqcr_mode;
+	p->cr_vb = QB_VALID_BIT;
+	p->vdqcr_vb = QB_VALID_BIT;
+	p->dqrr_vb = QB_VALID_BIT;
+
+	pthread_mutex_lock(&qbman_sw.portal_lock);
+	qbman_sw_lock();
+	if (qbman_sw.portals[idx]) {
+		qbman_sw_unlock();
+		pthread_mutex_unlock(&qbman_sw.portal_lock);
+		pr_err("Software portal %d already exists\n", idx);
+		free(cena);
+		free(p);
+		return NULL;
+	}
+	qbman_sw.portals[idx] = p;
+	qbman_sw_unlock();
+	if (!qbman_sw.nb_portals++) {
+		__atomic_store_n(&qbman_sw.running, 1, __ATOMIC_RELEASE);
+		ret = pthread_create(&qbman_sw.thread, NULL,
+				     qbman_sw_thread, NULL);
+		if (ret) {
+			pr_err("Could not start software QBMan: %d\n", ret);
+			qbman_sw.nb_portals--;
+			qbman_sw.running = 0;
+			qbman_sw_lock();
+			qbman_sw.portals[idx] = NULL;
+			qbman_sw_unlock();
+			pthread_mutex_unlock(&qbman_sw.portal_lock);
+			free(cena);
+			free(p);
+			return NULL;
+		}
+	}
+	pthread_mutex_unlock(&qbman_sw.portal_lock);
+	return p;
+}
+
+void qbman_sw_portal_destroy(struct qbman_sw_portal *p)
+{
+	if (!p)
+		return;
+	pthread_mutex_lock(&qbman_sw.portal_lock);
+	qbman_sw_lock();
+	qbman_sw.portals[p->idx] = NULL;
+	qbman_sw_unlock();
+	if (!--qbman_sw.nb_portals) {
+		__atomic_store_n(&qbman_sw.running, 0, __ATOMIC_RELEASE);
+		pthread_join(qbman_sw.thread, NULL);
+	}
+	pthread_mutex_unlock(&qbman_sw.portal_lock);
+	free(p->cena);
+	free(p);
+}
+
+uint8_t *qbman_sw_portal_cena(struct qbman_sw_portal *p)
+{
+	return p->cena;
+}
+
+/* Allocate the next entry of an 8 entry ring (EQAR and RAR) */
+static uint32_t qbman_sw_ring_alloc(uint32_t *pi, const uint32_t *ci)
+{
+	uint32_t used = (*pi - __atomic_load_n(ci, __ATOMIC_ACQUIRE)) &
+			QBMAN_SW_RING_MASK;
+	uint32_t ret;
+
+	if (used >= QBMAN_SW_RING_SIZE)
+		return 0;
+	ret = 0x100 | QBMAN_SW_RING_VB(*pi) | (*pi & 7);
+	*pi = (*pi + 1) & QBMAN_SW_RING_MASK;
+	return ret;
+}
+
+uint32_t qbman_sw_cinh_read(struct qbman_sw_portal *p, uint32_t offset)
+{
+	switch (offset) {
+	case QBMAN_CINH_SWP_EQCR_PI:
+		/* EQCR_PI in the power-on state */
+		return QB_VALID_BIT;
+	case QBMAN_CINH_SWP_EQCR_CI:
+		return __atomic_load_n(&p->eqcr_ci, __ATOMIC_ACQUIRE);
+	case QBMAN_CINH_SWP_EQAR:
+		return qbman_sw_ring_alloc(&p->eqar_pi, &p->eqcr_ci);
+	case QBMAN_CINH_SWP_RAR:
+		return qbman_sw_ring_alloc(&p->rar_pi, &p->rcr_ci);
+	case QBMAN_CINH_SWP_DQPI:
+		return __atomic_load_n(&p->dqrr_pi, __ATOMIC_ACQUIRE);
+	default:
+		return p->regs[(offset & 0xfff) >> 2];
+	}
+}
+
+void qbman_sw_cinh_write(struct qbman_sw_portal *p, uint32_t offset,
+			 uint32_t val)
+{
+	if (offset == QBMAN_CINH_SWP_DCAP) {
+		__atomic_fetch_and(&p->dqrr_busy, ~(1u << (val & 0x7)),
+				   __ATOMIC_RELEASE);
+		return;
+	}
+	p->regs[(offset & 0xfff) >> 2] = val;
+}
+
+	/*****************************/
+	/* Objects, tests and benches */
+	/*****************************/
+
+int qbman_sw_fq_config(uint32_t fqid, uint32_t chid, uint64_t ctx)
+{
+	struct qbman_sw_fq *fq;
+
+	qbman_sw_lock();
+	fq = qbman_sw_fq_get(fqid, 1);
+	if (fq) {
+		fq->chid = chid;
+		fq->ctx = ctx;
+	}
+	qbman_sw_unlock();
+	return fq ? 0 : -ENOMEM;
+}
+
+int qbman_sw_fq_enqueue(uint32_t fqid, const struct qbman_fd *fd,
+			unsigned int num)
+{
+	struct qbman_sw_fq *fq;
+	unsigned int i = 0;
+
+	qbman_sw_lock();
+	fq = qbman_sw_fq_get(fqid, 1);
+	if (fq)
+		for (; i < num; i++)
+			if (qbman_sw_fq_push(fq, &fd[i]))
+				break;
+	qbman_sw_unlock();
+	return (int)i;
+}
+
+int qbman_sw_fq_dequeue(uint32_t fqid, struct qbman_fd *fd, unsigned int num)
+{
+	struct qbman_sw_fq *fq;
+	unsigned int i = 0;
+
+	qbman_sw_lock();
+	fq = qbman_sw_fq_get(fqid, 0);
+	if (fq)
+		for (; i < num; i++)
+			if (qbman_sw_fq_pop(fq, &fd[i]))
+				break;
+	qbman_sw_unlock();
+	return (int)i;
+}
+
+uint32_t qbman_sw_fq_count(uint32_t fqid)
+{
+	struct qbman_sw_fq *fq;
+	uint32_t count = 0;
+
+	qbman_sw_lock();
+	fq = qbman_sw_fq_get(fqid, 0);
+	if (fq)
+		count = qbman_sw_fq_len(fq);
+	qbman_sw_unlock();
+	return count;
+}
+
+int qbman_sw_qd_config(uint32_t qdid, uint32_t fqid, uint16_t nb_bins)
+{
+	struct qbman_sw_qd *qd;
+
+	qbman_sw_lock();
+	qd = qbman_sw_qd_get(qdid, 1);
+	if (qd) {
+		qd->fqid = fqid;
+		qd->nb_bins = nb_bins;
+	}
+	qbman_sw_unlock();
+	return qd ? 0 : -ENOMEM;
+}
+
+uint64_t qbman_sw_qd_tx_count(uint32_t qdid)
+{
+	struct qbman_sw_qd *qd;
+	uint64_t tx = 0;
+
+	qbman_sw_lock();
+	qd = qbman_sw_qd_get(qdid, 0);
+	if (qd)
+		tx = qd->tx;
+	qbman_sw_unlock();
+	return tx;
+}
+
+uint32_t qbman_sw_bp_count(uint32_t bpid)
+{
+	uint32_t count;
+
+	qbman_sw_lock();
+	count = qbman_sw.bps[bpid & (QBMAN_SW_MAX_BPS - 1)].count;
+	qbman_sw_unlock();
+	return count;
+}
+
+void qbman_sw_reset(void)
+{
+	uint32_t i;
+
+	qbman_sw_lock();
+	for (i = 0; i < qbman_sw.nb_fqs; i++)
+		free(qbman_sw.fqs[i].ring);
+	qbman_sw.nb_fqs = 0;
+	memset(qbman_sw.fq_hash, 0, sizeof(qbman_sw.fq_hash));
+	qbman_sw.nb_qds = 0;
+	for (i = 0; i < QBMAN_SW_MAX_BPS; i++) {
+		free(qbman_sw.bps[i].bufs);
+		memset(&qbman_sw.bps[i], 0, sizeof(qbman_sw.bps[i]));
+	}
+	qbman_sw_unlock();
+}
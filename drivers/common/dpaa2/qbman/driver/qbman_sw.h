@@ -0,0 +1,53 @@
+/* Copyright 2017 NXP.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of NXP nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NXP BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/* Software portals, see fsl_qbman_sw.h. Only used by qbman_sys.h, in place of
+ * the portal registers, when the driver is built for software QBMan.
+ */
+#ifndef _QBMAN_SW_H
+#define _QBMAN_SW_H
+
+struct qbman_sw_portal;
+
+/* Size of the CENA area of a portal */
+#define QBMAN_SW_CENA_SIZE 0x1000
+
+/* Create the emulated portal 'idx' and start the emulator if it isn't running
+ * yet. Returns NULL on failure.
+ */
+struct qbman_sw_portal *qbman_sw_portal_create(int idx, uint8_t dqrr_size,
+					       enum qbman_eqcr_mode eqcr_mode);
+
+/* Remove a portal from the emulator, stopped with the last portal. */
+void qbman_sw_portal_destroy(struct qbman_sw_portal *p);
+
+/* CENA area of a portal, written and polled by the portal code as usual */
+uint8_t *qbman_sw_portal_cena(struct qbman_sw_portal *p);
+
+/* CINH register accesses, which the emulator services synchronously */
+uint32_t qbman_sw_cinh_read(struct qbman_sw_portal *p, uint32_t offset);
+void qbman_sw_cinh_write(struct qbman_sw_portal *p, uint32_t offset,
+			 uint32_t val);
+
+#endif /* _QBMAN_SW_H */
@@ -43,6 +43,10 @@
 #undef QBMAN_CINH_TRACE
 #undef QBMAN_CENA_TRACE
 
+#ifdef RTE_LIBRTE_DPAA2_QBMAN_SW
+#include "qbman_sw.h"
+#endif
+
 static inline void word_copy(void *d, const void *s, unsigned int cnt)
 {
 	uint32_t *dd = d;
@@ -138,6 +142,10 @@ struct qbman_swp_sys {
 	uint8_t __iomem *addr_cinh;
 	uint32_t idx;
 	enum qbman_eqcr_mode eqcr_mode;
+#ifdef RTE_LIBRTE_DPAA2_QBMAN_SW
+	/* Software portal standing for the registers */
+	struct qbman_sw_portal *sw;
+#endif
 };
 
 /* P_OFFSET is (ACCESS_CMD,0,12) - offset within the portal
@@ -151,7 +159,11 @@ struct qbman_swp_sys {
 static inline void qbman_cinh_write(struct qbman_swp_sys *s, uint32_t offset,
 				    uint32_t val)
 {
+#ifdef RTE_LIBRTE_DPAA2_QBMAN_SW
+	qbman_sw_cinh_write(s->sw, offset, val);
+#else
 	__raw_writel(val, s->addr_cinh + offset);
+#endif
 #ifdef QBMAN_CINH_TRACE
 	pr_info("qbman_cinh_write(%p:%d:0x%03x) 0x%08x\n",
 		s->addr_cinh, s->idx, offset, val);
@@ -160,7 +172,11 @@ static inline void qbman_cinh_write(struct qbman_swp_sys *s, uint32_t offset,
 
 static inline uint32_t qbman_cinh_read(struct qbman_swp_sys *s, uint32_t offset)
 {
+#ifdef RTE_LIBRTE_DPAA2_QBMAN_SW
+	uint32_t reg = qbman_sw_cinh_read(s->sw, offset);
+#else
 	uint32_t reg = __raw_readl(s->addr_cinh + offset);
+#endif
 #ifdef QBMAN_CINH_TRACE
 	pr_info("qbman_cinh_read(%p:%d:0x%03x) 0x%08x\n",
 		s->addr_cinh, s->idx, offset, reg);
@@ -323,12 +339,25 @@ static inline int qbman_swp_sys_init(struct qbman_swp_sys *s,
 {
 	uint32_t reg;
 
+#ifdef RTE_LIBRTE_DPAA2_QBMAN_SW
+	s->sw = qbman_sw_portal_create(d->idx, dqrr_size, d->eqcr_mode);
+	if (!s->sw) {
+		pr_err("Could not create software portal %d\n", d->idx);
+		return -1;
+	}
+	s->addr_cena = qbman_sw_portal_cena(s->sw);
+	s->addr_cinh = NULL;
+#else
 	s->addr_cena = d->cena_bar;
 	s->addr_cinh = d->cinh_bar;
+#endif
 	s->idx = (uint32_t)d->idx;
 	s->cena = (void *)get_zeroed_page(GFP_KERNEL);
 	if (!s->cena) {
 		pr_err("Could not allocate page for cena shadow\n");
+#ifdef RTE_LIBRTE_DPAA2_QBMAN_SW
+		qbman_sw_portal_destroy(s->sw);
+#endif
 		return -1;
 	}
 	s->eqcr_mode = d->eqcr_mode;
@@ -352,6 +381,9 @@ static inline int qbman_swp_sys_init(struct qbman_swp_sys *s,
 	if (!reg) {
 		pr_err("The portal %d is not enabled!\n", s->idx);
 		kfree(s->cena);
+#ifdef RTE_LIBRTE_DPAA2_QBMAN_SW
+		qbman_sw_portal_destroy(s->sw);
+#endif
 		return -1;
 	}
 	return 0;
@@ -360,6 +392,9 @@ static inline int qbman_swp_sys_init(struct qbman_swp_sys *s,
 static inline void qbman_swp_sys_finish(struct qbman_swp_sys *s)
 {
 	free_page((unsigned long)s->cena);
+#ifdef RTE_LIBRTE_DPAA2_QBMAN_SW
+	qbman_sw_portal_destroy(s->sw);
+#endif
 }
 
 static inline void *
@@ -54,6 +54,7 @@
 	/****************/
 	/* arch assists */
 	/****************/
+#ifdef __aarch64__
 #define dcbz(p) { asm volatile("dc zva, %0" : : "r" (p) : "memory"); }
 #define lwsync() { asm volatile("dmb st" : : : "memory"); }
 #define dcbf(p) { asm volatile("dc cvac, %0" : : "r"(p) : "memory"); }
@@ -67,3 +68,19 @@ static inline void prefetch_for_store(void *p)
 {
 	asm volatile("prfm pstl1keep, [%0, #64]" : : "r" (p));
 }
+#else
+/* The software portals are plain coherent memory */
+#define dcbz(p) { memset((void *)(p), 0, 64); }
+#define lwsync() { __atomic_thread_fence(__ATOMIC_RELEASE); }
+#define dcbf(p) { (void)(p); __atomic_thread_fence(__ATOMIC_RELEASE); }
+#define dccivac(p) { (void)(p); __atomic_thread_fence(__ATOMIC_ACQUIRE); }
+static inline void prefetch_for_load(void *p)
+{
+	__builtin_prefetch((uint8_t *)p + 64, 0);
+}
+
+static inline void prefetch_for_store(void *p)
+{
+	__builtin_prefetch((uint8_t *)p + 64, 1);
+}
+#endif
@@ -464,8 +464,12 @@ static inline u64 div64_u64(u64 n, u64 d)
  * Guarantees that the LOAD and STORE operations generated before the
  * barrier occur before the LOAD and STORE operations generated after.
  */
+#ifdef __aarch64__
 #define dmb(opt) { asm volatile("dmb " #opt : : : "memory"); }
 #define smp_mb() dmb(ish)
+#else
+#define smp_mb() __sync_synchronize()
+#endif
 
 /* Atomic stuff */
 typedef struct {
@@ -474,6 +478,7 @@ typedef struct {
 
 #define atomic_read(v)  (*(volatile int *)&(v)->counter)
 #define atomic_set(v, i) (((v)->counter) = (i))
+#ifdef __aarch64__
 static inline void atomic_add(int i, atomic_t *v)
 {
 	unsigned long tmp;
@@ -537,6 +542,27 @@ static inline int atomic_sub_return(int i, atomic_t *v)
 	smp_mb();
 	return result;
 }
+#else
+static inline void atomic_add(int i, atomic_t *v)
+{
+	__atomic_add_fetch(&v->counter, i, __ATOMIC_RELAXED);
+}
+
+static inline int atomic_add_return(int i, atomic_t *v)
+{
+	return __atomic_add_fetch(&v->counter, i, __ATOMIC_SEQ_CST);
+}
+
+static inline void atomic_sub(int i, atomic_t *v)
+{
+	__atomic_sub_fetch(&v->counter, i, __ATOMIC_RELAXED);
+}
+
+static inline int atomic_sub_return(int i, atomic_t *v)
+{
+	return __atomic_sub_fetch(&v->counter, i, __ATOMIC_SEQ_CST);
+}
+#endif /* __aarch64__ */
 
 #define atomic_inc(v)           atomic_add(1, v)
 #define atomic_dec(v)           atomic_sub(1, v)
@@ -0,0 +1,122 @@
+/* Copyright 2017 NXP.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of NXP nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NXP ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL NXP BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef _FSL_QBMAN_SW_H
+#define _FSL_QBMAN_SW_H
+
+#include <drivers/fsl_qbman_base.h>
+
+/**
+ * DOC - Software QBMan, built with CONFIG_RTE_LIBRTE_DPAA2_QBMAN_SW.
+ *
+ * The software portals are backed by memory instead of QBMan registers, and
+ * an emulator thread plays the part of QBMan: it takes the enqueue, release,
+ * volatile dequeue and management commands written to the portals, and writes
+ * back the dequeue results and command responses, as QBMan would. The portal
+ * code of qbman_portal.c is used unchanged.
+ *
+ * The emulator holds frame queues, which are created on first use, buffer
+ * pools and queuing destinations. Frames enqueued to a queuing destination
+ * are sent to the frame queues it is mapped to, or are transmitted: their
+ * buffer is released to its pool, unless the FD has its invalid pool bit set.
+ * The buffers of scatter/gather frames are not walked, only the buffer of the
+ * table is released.
+ *
+ * Addresses in commands (storage of dequeue results) must be virtual
+ * addresses, ie. IOVA must be VA. Static dequeues (SDQCR), enqueue responses
+ * and order restoration are not emulated.
+ *
+ * The functions below stand for the wire and for the MC configuration of the
+ * objects, they are meant for tests and benchmarks.
+ */
+
+/**
+ * qbman_sw_fq_config() - Set the attributes of a frame queue
+ * @fqid: the frame queue, created if need be.
+ * @chid: the channel the frame queue is scheduled to, 0 for none.
+ * @ctx: the context returned in the dequeue results of the frame queue.
+ *
+ * Return 0 for success, or -ENOMEM.
+ */
+int qbman_sw_fq_config(uint32_t fqid, uint32_t chid, uint64_t ctx);
+
+/**
+ * qbman_sw_fq_enqueue() - Put frames on a frame queue, as received frames
+ * @fqid: the frame queue, created if need be.
+ * @fd: the frames.
+ * @num: the number of frames.
+ *
+ * Return the number of frames enqueued.
+ */
+int qbman_sw_fq_enqueue(uint32_t fqid, const struct qbman_fd *fd,
+			unsigned int num);
+
+/**
+ * qbman_sw_fq_dequeue() - Take frames from a frame queue
+ * @fqid: the frame queue.
+ * @fd: the frames.
+ * @num: the maximum number of frames.
+ *
+ * Return the number of frames dequeued.
+ */
+int qbman_sw_fq_dequeue(uint32_t fqid, struct qbman_fd *fd, unsigned int num);
+
+/**
+ * qbman_sw_fq_count() - Number of frames on a frame queue
+ * @fqid: the frame queue.
+ */
+uint32_t qbman_sw_fq_count(uint32_t fqid);
+
+/**
+ * qbman_sw_qd_config() - Map a queuing destination to frame queues
+ * @qdid: the queuing destination.
+ * @fqid: the frame queue of bin 0 and priority 0, 0 to transmit the frames
+ * enqueued to the queuing destination.
+ * @nb_bins: the number of bins of each priority, whose frame queues follow
+ * each other from @fqid on.
+ *
+ * Return 0 for success, or -ENOMEM.
+ */
+int qbman_sw_qd_config(uint32_t qdid, uint32_t fqid, uint16_t nb_bins);
+
+/**
+ * qbman_sw_qd_tx_count() - Number of frames transmitted by a queuing
+ * destination
+ * @qdid: the queuing destination.
+ */
+uint64_t qbman_sw_qd_tx_count(uint32_t qdid);
+
+/**
+ * qbman_sw_bp_count() - Number of buffers in a buffer pool
+ * @bpid: the buffer pool.
+ */
+uint32_t qbman_sw_bp_count(uint32_t bpid);
+
+/**
+ * qbman_sw_reset() - Drop all the frame queues, buffer pools and queuing
+ * destinations
+ */
+void qbman_sw_reset(void);
+
+#endif /* !_FSL_QBMAN_SW_H */
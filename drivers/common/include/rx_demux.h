@@ -0,0 +1,227 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2017 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RX_DEMUX_H_
+#define _RX_DEMUX_H_
+
+/**
+ * @file
+ *
+ * Demultiplexing of the frames dequeued by a portal to their receive queues.
+ *
+ * When the frame queues of several receive queues are dequeued together by
+ * the portal of an lcore, scheduled to its channel or with pulls outstanding
+ * on each, one poll of the portal returns frames of any of them. The frames
+ * of the queue being received are returned to the caller, those of the
+ * other queues are held in the backlog of their queue, which the next
+ * receive on it hands out before polling the portal again.
+ *
+ * A queue and its backlog belong to the lcore which received from it first,
+ * as the frames of the queue are dequeued by the portal of that lcore.
+ * Frames the portal dequeues outside of a receive, when the lcore polls it
+ * for another purpose, all go to the backlog of their queue.
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_atomic.h>
+#include <rte_branch_prediction.h>
+#include <rte_lcore.h>
+#include <rte_mbuf.h>
+
+/** Capacity of the backlog of a queue, a power of 2 */
+#define RX_DEMUX_BACKLOG_SIZE	256
+
+/** Statistics of a receive queue */
+struct rx_demux_stats {
+	uint64_t polls;		/**< Portal polls by receives on the queue */
+	uint64_t backlogged;	/**< Frames held for a later receive */
+	uint64_t drops;		/**< Frames dropped, the backlog being full */
+};
+
+struct rx_demux_queue {
+	uint16_t head;		/**< Next frame to hand out */
+	uint16_t tail;		/**< Next free slot */
+	volatile uint32_t owner; /**< Owner lcore + 1, 0 when unclaimed */
+	struct rx_demux_stats stats;
+	struct rte_mbuf *bufs[RX_DEMUX_BACKLOG_SIZE];
+} __rte_cache_aligned;
+
+/** A receive in progress on an lcore, no queue outside of a receive */
+struct rx_demux_burst {
+	struct rx_demux_queue *rxq;	/**< Queue being received */
+	struct rte_mbuf **bufs;
+	uint16_t nb_bufs;
+	uint16_t num_rx;
+};
+
+static inline void
+rx_demux_queue_init(struct rx_demux_queue *rxq)
+{
+	memset(rxq, 0, sizeof(*rxq));
+}
+
+/** Number of frames in the backlog of a queue */
+static inline unsigned int
+rx_demux_queue_count(const struct rx_demux_queue *rxq)
+{
+	return (uint16_t)(rxq->tail - rxq->head);
+}
+
+/** Owner lcore of a queue, LCORE_ID_ANY if it has none */
+static inline unsigned int
+rx_demux_queue_owner(const struct rx_demux_queue *rxq)
+{
+	uint32_t owner = rxq->owner;
+
+	return owner ? owner - 1 : LCORE_ID_ANY;
+}
+
+/**
+ * Make the calling lcore the owner of a queue, if it has none yet. Of
+ * lcores making their first receive at once, a single one gets the queue.
+ *
+ * @return
+ *   1 on the first receive, 0 on the next ones of the owner, -EBUSY if the
+ *   queue belongs to another lcore.
+ */
+static inline int
+rx_demux_queue_claim(struct rx_demux_queue *rxq)
+{
+	uint32_t self = rte_lcore_id() + 1;
+	uint32_t owner = rxq->owner;
+
+	if (likely(owner != 0))
+		return owner == self ? 0 : -EBUSY;
+	if (!rte_atomic32_cmpset(&rxq->owner, 0, self))
+		return rxq->owner == self ? 0 : -EBUSY;
+	return 1;
+}
+
+/**
+ * Give up a queue, claimed by a first receive which failed, or released
+ * once its lcore no longer receives.
+ */
+static inline void
+rx_demux_queue_unclaim(struct rx_demux_queue *rxq)
+{
+	rte_smp_wmb();
+	rxq->owner = 0;
+}
+
+/** Free the frames in the backlog of a queue */
+static inline void
+rx_demux_queue_flush(struct rx_demux_queue *rxq)
+{
+	while (rxq->head != rxq->tail)
+		rte_pktmbuf_free(rxq->bufs[rxq->head++ &
+					   (RX_DEMUX_BACKLOG_SIZE - 1)]);
+}
+
+/**
+ * Start a receive: hand out the backlog of the queue first. When the portal
+ * is to be polled, the receive must then be ended by rx_demux_burst_end().
+ *
+ * @return
+ *   Nonzero if the backlog filled the burst, and the portal is not to be
+ *   polled.
+ */
+static inline int
+rx_demux_burst_start(struct rx_demux_burst *burst,
+		     struct rx_demux_queue *rxq,
+		     struct rte_mbuf **bufs, uint16_t nb_bufs)
+{
+	uint16_t n = RTE_MIN(rx_demux_queue_count(rxq), nb_bufs);
+	uint16_t i;
+
+	for (i = 0; i < n; i++)
+		bufs[i] = rxq->bufs[rxq->head++ & (RX_DEMUX_BACKLOG_SIZE - 1)];
+	if (n == nb_bufs)
+		return 1;
+	burst->rxq = rxq;
+	burst->bufs = bufs;
+	burst->nb_bufs = nb_bufs;
+	burst->num_rx = n;
+	rxq->stats.polls++;
+	return 0;
+}
+
+/**
+ * End a receive, frames dequeued until the next one go to the backlogs.
+ *
+ * @return
+ *   Number of frames received.
+ */
+static inline uint16_t
+rx_demux_burst_end(struct rx_demux_burst *burst)
+{
+	uint16_t num_rx = burst->num_rx;
+
+	burst->rxq = NULL;
+	burst->bufs = NULL;
+	burst->nb_bufs = 0;
+	burst->num_rx = 0;
+	return num_rx;
+}
+
+/** Room left in the receive */
+static inline uint16_t
+rx_demux_burst_room(const struct rx_demux_burst *burst)
+{
+	return burst->nb_bufs - burst->num_rx;
+}
+
+/**
+ * Hand a frame dequeued by the portal to the receive, or to the backlog of
+ * its queue.
+ */
+static inline void
+rx_demux_frame(struct rx_demux_burst *burst, struct rx_demux_queue *rxq,
+	       struct rte_mbuf *m)
+{
+	if (rxq == burst->rxq && burst->num_rx < burst->nb_bufs) {
+		burst->bufs[burst->num_rx++] = m;
+		return;
+	}
+	if (unlikely(rx_demux_queue_count(rxq) == RX_DEMUX_BACKLOG_SIZE)) {
+		rxq->stats.drops++;
+		rte_pktmbuf_free(m);
+		return;
+	}
+	rxq->stats.backlogged++;
+	rxq->bufs[rxq->tail++ & (RX_DEMUX_BACKLOG_SIZE - 1)] = m;
+}
+
+#endif /* _RX_DEMUX_H_ */
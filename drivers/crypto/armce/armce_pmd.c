@@ -40,6 +40,7 @@
 #include <rte_dev.h>
 #include <rte_malloc.h>
 #include <rte_cpuflags.h>
+#include <rte_prefetch.h>
 
 #include "armce_pmd_private.h"
 
@@ -96,6 +97,19 @@ xform_get_evp_cipher(const struct rte_crypto_sym_xform *xform)
 				      "key cipher config");
 			return NULL;
 		}
+	case RTE_CRYPTO_CIPHER_AES_GCM:
+		switch (key_len_bits) {
+		case 128:
+			return EVP_aes_128_gcm();
+		case 192:
+			return EVP_aes_192_gcm();
+		case 256:
+			return EVP_aes_256_gcm();
+		default:
+			ARMCE_LOG_ERR("Could not find a valid "
+				      "key cipher config");
+			return NULL;
+		}
 	case RTE_CRYPTO_CIPHER_3DES_CBC:
 		switch (key_len_bits) {
 		case 128:
@@ -145,17 +159,21 @@ armce_set_cipher_session_parameters(struct armce_session *sess,
 	 * other AEAD algorithms this is not ok, as the cipher->init()
 	 * primitive is forcefully called although the key is NULL
 	 */
-	if (dir == RTE_CRYPTO_CIPHER_OP_ENCRYPT) {
+	if (dir == RTE_CRYPTO_CIPHER_OP_ENCRYPT)
 		rv = EVP_EncryptInit_ex(ctx, cipher, NULL, key, NULL);
-	} else {
+	else
 		rv = EVP_DecryptInit_ex(ctx, cipher, NULL, key, NULL);
-		EVP_CIPHER_CTX_set_padding(ctx, 0);
-	}
 	if (rv != 1) {
 		ERR_print_errors_fp(stderr);
 		ARMCE_LOG_ERR("Cipher: OpenSSL EVP ctx initialization failed");
+		EVP_CIPHER_CTX_free(ctx);
 		return -1;
 	}
+	/*
+	 * Data lengths are block multiples, the final call must not add or
+	 * strip a padding block past the end of the data in either direction
+	 */
+	EVP_CIPHER_CTX_set_padding(ctx, 0);
 	sess->data.cipher.ctx = ctx;
 
 	return 0;
@@ -196,6 +214,11 @@ armce_set_auth_session_parameters(struct armce_session *sess,
 	int rv;
 
 	sess->algo.auth = xform->auth.algo;
+	sess->data.auth.op = op;
+
+	/* The GCM tag is computed by the cipher ctx in the same pass */
+	if (xform->auth.algo == RTE_CRYPTO_AUTH_AES_GCM)
+		return 0;
 
 	auth = xform_get_evp_auth(xform);
 	if (unlikely(auth == NULL)) {
@@ -203,8 +226,6 @@ armce_set_auth_session_parameters(struct armce_session *sess,
 		return -1;
 	}
 
-	sess->data.auth.op = op;
-	HMAC_CTX_init(ctx);
 	rv = HMAC_Init_ex(ctx, key, key_len, auth, NULL);
 	if (unlikely(rv != 1)) {
 		ERR_print_errors_fp(stderr);
@@ -215,6 +236,25 @@ armce_set_auth_session_parameters(struct armce_session *sess,
 	return 0;
 }
 
+/**
+ * Turn a GCM cipher and auth chain into a single AEAD pass. Like for the
+ * other GCM PMDs the cipher direction selects generating or verifying the
+ * tag, whatever the chain order.
+ */
+static int
+armce_set_gcm_session_parameters(struct armce_session *sess)
+{
+	if (sess->algo.cipher != RTE_CRYPTO_CIPHER_AES_GCM ||
+			sess->algo.auth != RTE_CRYPTO_AUTH_AES_GCM) {
+		ARMCE_LOG_ERR("AES GCM cipher and auth must be chained");
+		return -1;
+	}
+
+	sess->algo.chaining = AEAD_GCM;
+
+	return 0;
+}
+
 /** verify and set session parameters */
 int
 armce_set_session_parameters(
@@ -223,6 +263,11 @@ armce_set_session_parameters(
 {
 	int rv_auth = 0, rv_cipher = 0;
 
+	sess->algo.cipher = RTE_CRYPTO_CIPHER_NULL;
+	sess->algo.auth = RTE_CRYPTO_AUTH_NULL;
+	sess->data.cipher.ctx = NULL;
+	HMAC_CTX_init(&sess->data.auth.ctx);
+
 	if (unlikely(xform == NULL)) {
 		ARMCE_LOG_ERR("xform request is NULL");
 		return -1;
@@ -256,6 +301,10 @@ armce_set_session_parameters(
 		return -1;
 	}
 
+	if (sess->algo.cipher == RTE_CRYPTO_CIPHER_AES_GCM ||
+			sess->algo.auth == RTE_CRYPTO_AUTH_AES_GCM)
+		return armce_set_gcm_session_parameters(sess);
+
 	return 0;
 }
 
@@ -333,7 +382,8 @@ process_cipher_op(struct rte_crypto_sym_op *op, struct armce_session *sess)
 
 	if (op->m_dst != NULL)
 		dst = (unsigned char *)op->m_dst->buf_addr +
-		      op->m_dst->data_off;
+		      op->m_dst->data_off +
+		      op->cipher.data.offset;
 	else
 		dst = src;
 
@@ -432,43 +482,168 @@ process_auth_op(struct rte_crypto_sym_op *op, struct armce_session *sess)
 	return rv;
 }
 
-/** Process crypto operation for mbuf */
+#define GCM_IV_LENGTH 12
+#define GCM_J0_LENGTH 16
+
+/** Encrypt and generate, or decrypt and verify, AES GCM in one pass */
 static int
-process_op(const struct armce_qp *qp, struct rte_crypto_op *op,
-	   struct armce_session *sess)
+process_gcm_op(struct rte_crypto_sym_op *op, struct armce_session *sess)
 {
-	int rv_auth = 0, rv_cipher = 0;
+	unsigned char *src = (unsigned char *)op->m_src->buf_addr +
+			     op->m_src->data_off +
+			     op->cipher.data.offset;
+	EVP_CIPHER_CTX *ctx = sess->data.cipher.ctx;
+	int length = op->cipher.data.length;
+	unsigned char *dst, *digest;
+	int len, rv;
 
-	op->status = RTE_CRYPTO_OP_STATUS_SUCCESS;
+	/*
+	 * Only 96 bit IVs are supported, also when given as the 16 byte
+	 * pre-counter block J0 whose first 12 bytes are the IV.
+	 */
+	if (unlikely(op->cipher.iv.length != GCM_IV_LENGTH &&
+		     op->cipher.iv.length != GCM_J0_LENGTH)) {
+		ARMCE_LOG_ERR("Unsupported GCM IV length");
+		return -EINVAL;
+	}
+	if (unlikely(op->auth.digest.length == 0 ||
+		     op->auth.digest.length > GCM_J0_LENGTH)) {
+		ARMCE_LOG_ERR("Unsupported GCM tag length");
+		return -EINVAL;
+	}
+
+	if (op->m_dst != NULL)
+		dst = (unsigned char *)op->m_dst->buf_addr +
+		      op->m_dst->data_off +
+		      op->cipher.data.offset;
+	else
+		dst = src;
+
+	if (op->auth.digest.data != NULL)
+		digest = op->auth.digest.data;
+	else if (sess->data.cipher.dir == RTE_CRYPTO_CIPHER_OP_ENCRYPT)
+		digest = dst + length;
+	else
+		digest = src + length;
+
+	/* Key schedule and GHASH key are kept from the session setup */
+	rv = EVP_CipherInit_ex(ctx, NULL, NULL, NULL, op->cipher.iv.data, -1);
+	if (unlikely(rv != 1))
+		goto process_gcm_err;
+
+	if (op->auth.aad.length != 0) {
+		rv = EVP_CipherUpdate(ctx, NULL, &len, op->auth.aad.data,
+				      op->auth.aad.length);
+		if (unlikely(rv != 1))
+			goto process_gcm_err;
+	}
+
+	rv = EVP_CipherUpdate(ctx, dst, &len, src, length);
+	if (unlikely(rv != 1))
+		goto process_gcm_err;
+
+	if (sess->data.cipher.dir == RTE_CRYPTO_CIPHER_OP_DECRYPT) {
+		rv = EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG,
+					 op->auth.digest.length, digest);
+		if (unlikely(rv != 1))
+			goto process_gcm_err;
+		/* Final only fails on a tag mismatch once the tag is set */
+		if (EVP_CipherFinal_ex(ctx, dst + len, &len) != 1)
+			return -EPROTO;
+		return 0;
+	}
+
+	rv = EVP_CipherFinal_ex(ctx, dst + len, &len);
+	if (unlikely(rv != 1))
+		goto process_gcm_err;
+	rv = EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG,
+				 op->auth.digest.length, digest);
+	if (unlikely(rv != 1))
+		goto process_gcm_err;
+
+	return 0;
+
+process_gcm_err:
+	ERR_print_errors_fp(stderr);
+	ARMCE_LOG_ERR("AES GCM operation failed");
+	return -EINVAL;
+}
 
+/**
+ * Run the first (stage 0) or second (stage 1) transform of an op's chain.
+ * Running one stage across a whole burst before the next keeps the AES and
+ * SHA code and round keys hot instead of alternating between them per op.
+ */
+static inline int
+process_op_stage(struct rte_crypto_sym_op *op, struct armce_session *sess,
+		 int stage)
+{
 	switch (sess->algo.chaining) {
 	case HASH_ONLY:
-		rv_auth = process_auth_op(op->sym, sess);
-		break;
+		return stage == 0 ? process_auth_op(op, sess) : 0;
 	case CIPHER_ONLY:
-		rv_cipher = process_cipher_op(op->sym, sess);
-		break;
+		return stage == 0 ? process_cipher_op(op, sess) : 0;
 	case HASH_CIPHER:
-		rv_auth = process_auth_op(op->sym, sess);
-		rv_cipher = process_cipher_op(op->sym, sess);
-		break;
+		return stage == 0 ? process_auth_op(op, sess) :
+				    process_cipher_op(op, sess);
 	case CIPHER_HASH:
-		rv_cipher = process_cipher_op(op->sym, sess);
-		rv_auth = process_auth_op(op->sym, sess);
-		break;
+		return stage == 0 ? process_cipher_op(op, sess) :
+				    process_auth_op(op, sess);
+	case AEAD_GCM:
+		return stage == 0 ? process_gcm_op(op, sess) : 0;
 	default:
 		ARMCE_LOG_ERR("Unsupported algorithm type");
-		break;
+		return -EINVAL;
 	}
+}
 
-	if (unlikely(rv_auth < 0 || rv_cipher < 0)) {
-		if (rv_auth == -EPROTO)
-			op->status = RTE_CRYPTO_OP_STATUS_AUTH_FAILED;
-		else
-			op->status = RTE_CRYPTO_OP_STATUS_ERROR;
+/** Process a burst of ops whose sessions are resolved */
+static void
+process_ops(struct rte_crypto_op **ops, struct armce_session **sess,
+	    uint16_t nb_ops)
+{
+	uint16_t i;
+	int stage, rv;
+
+	for (i = 0; i < nb_ops; i++)
+		ops[i]->status = RTE_CRYPTO_OP_STATUS_SUCCESS;
+
+	for (stage = 0; stage < 2; stage++) {
+		for (i = 0; i < nb_ops; i++) {
+			if (i + 1 < nb_ops)
+				rte_prefetch0(rte_pktmbuf_mtod(
+						ops[i + 1]->sym->m_src, void *));
+
+			/* A failed first transform skips the second */
+			if (unlikely(ops[i]->status !=
+				     RTE_CRYPTO_OP_STATUS_SUCCESS))
+				continue;
+
+			rv = process_op_stage(ops[i]->sym, sess[i], stage);
+			if (unlikely(rv < 0)) {
+				if (rv == -EPROTO)
+					ops[i]->status =
+						RTE_CRYPTO_OP_STATUS_AUTH_FAILED;
+				else
+					ops[i]->status =
+						RTE_CRYPTO_OP_STATUS_ERROR;
+			}
+		}
 	}
+}
+
+/** Release a temporary session of a sessionless op */
+static void
+put_session(struct armce_qp *qp, struct rte_cryptodev_sym_session *c_sess)
+{
+	struct armce_session *sess =
+			(struct armce_session *)c_sess->_private;
 
-	return rte_ring_enqueue(qp->processed_pkts, (void *)op);
+	EVP_CIPHER_CTX_free(sess->data.cipher.ctx);
+	HMAC_CTX_cleanup(&sess->data.auth.ctx);
+	memset(sess, 0, sizeof(*sess));
+
+	rte_mempool_put(qp->sess_mp, c_sess);
 }
 
 static struct armce_session *
@@ -486,7 +661,7 @@ get_session(struct armce_qp *qp, struct rte_crypto_sym_op *op)
 
 		sess = (struct armce_session *)op->session->_private;
 	} else  {
-		struct rte_cryptodev_session *c_sess = NULL;
+		struct rte_cryptodev_sym_session *c_sess = NULL;
 
 		if (rte_mempool_get(qp->sess_mp, (void **)&c_sess)) {
 			ARMCE_LOG_ERR("Could not allocate temporary session "
@@ -499,8 +674,10 @@ get_session(struct armce_qp *qp, struct rte_crypto_sym_op *op)
 		if (armce_set_session_parameters(sess, op->xform) != 0) {
 			ARMCE_LOG_ERR("Failed to set parameteres for "
 				      "sessionless request");
+			put_session(qp, c_sess);
 			return NULL;
 		}
+		op->session = c_sess;
 	}
 
 	return sess;
@@ -512,33 +689,49 @@ armce_pmd_enqueue_burst(void *queue_pair, struct rte_crypto_op **ops,
 			uint16_t nb_ops)
 {
 	struct armce_qp *qp = queue_pair;
-	struct armce_session *sess;
+	struct armce_session *sess[ARMCE_MAX_BURST];
+	unsigned int nb_free;
+	uint16_t i, j, n, nb_enq = 0;
+
+	/* Only take ops whose completion fits in the processed ring */
+	nb_free = rte_ring_free_count(qp->processed_pkts);
+	if (nb_ops > nb_free)
+		nb_ops = nb_free;
+
+	while (nb_enq < nb_ops) {
+		n = RTE_MIN(nb_ops - nb_enq, ARMCE_MAX_BURST);
+
+		for (i = 0; i < n; i++) {
+			sess[i] = get_session(qp, ops[nb_enq + i]->sym);
+			if (unlikely(sess[i] == NULL))
+				break;
+		}
 
-	int i, retval;
+		process_ops(&ops[nb_enq], sess, i);
 
-	for (i = 0; i < nb_ops; i++) {
-		sess = get_session(qp, ops[i]->sym);
-		if (unlikely(sess == NULL)) {
-			ARMCE_LOG_ERR("failed to get session");
-			goto enqueue_err;
-		}
+		for (j = 0; j < i; j++) {
+			struct rte_crypto_sym_op *sym = ops[nb_enq + j]->sym;
 
-		retval = process_op(qp, ops[i], sess);
-		if (unlikely(retval < 0)) {
-			ARMCE_LOG_ERR("failed to process operation");
-			goto enqueue_err;
+			if (sym->sess_type == RTE_CRYPTO_SYM_OP_SESSIONLESS) {
+				put_session(qp, sym->session);
+				sym->session = NULL;
+			}
 		}
-	}
 
-	qp->qp_stats.enqueued_count += i;
-	return i;
+		rte_ring_enqueue_bulk(qp->processed_pkts,
+				      (void **)&ops[nb_enq], i);
+		nb_enq += i;
 
-enqueue_err:
-	if (ops[i])
-		ops[i]->status = RTE_CRYPTO_OP_STATUS_INVALID_ARGS;
+		if (unlikely(i < n)) {
+			ARMCE_LOG_ERR("failed to get session");
+			ops[nb_enq]->status = RTE_CRYPTO_OP_STATUS_INVALID_ARGS;
+			qp->qp_stats.enqueue_err_count++;
+			break;
+		}
+	}
 
-	qp->qp_stats.enqueue_err_count++;
-	return i;
+	qp->qp_stats.enqueued_count += nb_enq;
+	return nb_enq;
 }
 
 /** Dequeue burst */
@@ -123,6 +123,51 @@ static const struct rte_cryptodev_capabilities armce_pmd_capabilities[] = {
 			}, }
 		}, }
 	},
+	{	/* AES GCM (AUTH) */
+		.op = RTE_CRYPTO_OP_TYPE_SYMMETRIC,
+		{.sym = {
+			.xform_type = RTE_CRYPTO_SYM_XFORM_AUTH,
+			{.auth = {
+				.algo = RTE_CRYPTO_AUTH_AES_GCM,
+				.block_size = 16,
+				.key_size = {
+					.min = 16,
+					.max = 32,
+					.increment = 8
+				},
+				.digest_size = {
+					.min = 8,
+					.max = 16,
+					.increment = 4
+				},
+				.aad_size = {
+					.min = 0,
+					.max = 65535,
+					.increment = 1
+				}
+			}, }
+		}, }
+	},
+	{	/* AES GCM (CIPHER) */
+		.op = RTE_CRYPTO_OP_TYPE_SYMMETRIC,
+		{.sym = {
+			.xform_type = RTE_CRYPTO_SYM_XFORM_CIPHER,
+			{.cipher = {
+				.algo = RTE_CRYPTO_CIPHER_AES_GCM,
+				.block_size = 16,
+				.key_size = {
+					.min = 16,
+					.max = 32,
+					.increment = 8
+				},
+				.iv_size = {
+					.min = 12,
+					.max = 16,
+					.increment = 4
+				}
+			}, }
+		}, }
+	},
 	{	/* AES CBC */
 		.op = RTE_CRYPTO_OP_TYPE_SYMMETRIC,
 		{.sym = {
@@ -409,9 +454,8 @@ armce_pmd_session_clear(struct rte_cryptodev *dev __rte_unused,
 	struct armce_session *armce_sess = sess;
 
 	if (armce_sess) {
-		/* if the session does some cipher */
-		if (armce_sess->algo.chaining != HASH_ONLY)
-			EVP_CIPHER_CTX_free(armce_sess->data.cipher.ctx);
+		EVP_CIPHER_CTX_free(armce_sess->data.cipher.ctx);
+		HMAC_CTX_cleanup(&armce_sess->data.auth.ctx);
 		memset(sess, 0, sizeof(struct armce_session));
 	}
 }
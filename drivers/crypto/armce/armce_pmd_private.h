@@ -62,9 +62,13 @@ enum armce_chain_order {
 	HASH_ONLY,
 	CIPHER_ONLY,
 	HASH_CIPHER,
-	CIPHER_HASH
+	CIPHER_HASH,
+	AEAD_GCM
 };
 
+/** Number of ops whose transforms are processed stage by stage */
+#define ARMCE_MAX_BURST		32
+
 /** private data structure for each ARMCE device */
 struct armce_private {
 	unsigned max_nb_qpairs;		/**< Max number of queue pairs */
@@ -97,6 +101,7 @@ struct armce_session {
 	struct {
 		struct {
 			EVP_CIPHER_CTX *ctx;
+			/**< Cipher ctx, also computing the tag for AEAD_GCM */
 			enum rte_crypto_cipher_operation dir;
 		} cipher;
 		struct {
@@ -43,6 +43,7 @@
 #include <rte_dev.h>
 #include <rte_cryptodev_pmd.h>
 #include <rte_common.h>
+#include <rte_spinlock.h>
 
 /* MC header files */
 #include <fsl_dpseci.h>
@@ -51,13 +52,14 @@
 #include <dpaa2_hw_dpbp.h>
 #include <dpaa2_hw_dpio.h>
 
-#include "dpaa2_sec_priv.h"
-#include "dpaa2_sec_logs.h"
-
 /* RTA header files */
 #include <flib/desc/ipsec.h>
 #include <flib/desc/pdcp.h>
 #include <flib/desc/algo.h>
+#include <flib/desc/sd_tmpl.h>
+
+#include "dpaa2_sec_priv.h"
+#include "dpaa2_sec_logs.h"
 
 /* Minimum job descriptor consists of a oneword job descriptor HEADER and
    a pointer to the shared descriptor*/
@@ -65,7 +67,6 @@
 #define NO_PREFETCH 0
 #define TDES_CBC_IV_LEN 8
 #define AES_CBC_IV_LEN 16
-enum rta_sec_era rta_sec_era = RTA_SEC_ERA_8;
 extern struct dpaa2_bp_info bpid_info[MAX_BPID];
 
 static inline void print_fd(const struct qbman_fd *fd)
@@ -90,6 +91,63 @@ static inline void print_fle(const struct qbman_fle *fle)
 	printf("frc:              %u\n", fle->frc);
 }
 
+/* The FLE table of an op lives in the op private area when the op pool
+ * reserved one for this device, else it is malloc'ed.
+ */
+static inline struct qbman_fle *
+dpaa2_sec_alloc_fle(struct rte_crypto_op *op, uint32_t mem_len)
+{
+	struct qbman_fle *fle;
+
+	fle = __rte_crypto_op_get_drv_priv_data(op, mem_len);
+	if (fle) {
+		memset(fle, 0, mem_len);
+		return fle;
+	}
+
+	return rte_zmalloc(NULL, mem_len, RTE_CACHE_LINE_SIZE);
+}
+
+static inline void
+dpaa2_sec_free_fle(struct rte_crypto_op *op, struct qbman_fle *fle)
+{
+	if ((void *)fle != __rte_crypto_op_get_drv_priv_data(op, 0))
+		rte_free(fle);
+}
+
+/* Describe len bytes of a chained mbuf, from offset, with consecutive SG
+ * entries. Returns the number of entries used, or -1 if the chain is too
+ * short.
+ */
+static inline int
+dpaa2_sec_fill_sg(struct qbman_fle *sge, struct rte_mbuf *m,
+		  uint32_t offset, uint32_t len, uint16_t bpid)
+{
+	uint32_t seg_len;
+	int nb_sge = 0;
+
+	while (m != NULL && offset >= m->data_len) {
+		offset -= m->data_len;
+		m = m->next;
+	}
+
+	for (; len > 0; m = m->next, offset = 0, sge++, nb_sge++) {
+		if (m == NULL)
+			return -1;
+		seg_len = RTE_MIN(m->data_len - offset, len);
+		DPAA2_SET_FLE_ADDR(sge, DPAA2_MBUF_VADDR_TO_IOVA(m));
+		DPAA2_SET_FLE_OFFSET(sge, m->data_off + offset);
+		sge->length = seg_len;
+		if (likely(bpid < MAX_BPID))
+			DPAA2_SET_FLE_BPID(sge, bpid);
+		else
+			DPAA2_SET_FLE_IVP(sge);
+		len -= seg_len;
+	}
+
+	return nb_sge;
+}
+
 static inline int build_authenc_fd(dpaa2_sec_session *sess,
 				   struct rte_crypto_op *op,
 		struct qbman_fd *fd, uint16_t bpid)
@@ -111,8 +169,7 @@ static inline int build_authenc_fd(dpaa2_sec_session *sess,
 	   So while retreiving we can go back 1 FLE from the FD -ADDR
 	   to get the MBUF Addr from the previous FLE.
 	   We can have a better approach to use the inline Mbuf*/
-	/* todo - we can use some mempool to avoid malloc here */
-	fle = rte_zmalloc(NULL, mem_len, RTE_CACHE_LINE_SIZE);
+	fle = dpaa2_sec_alloc_fle(op, mem_len);
 	if (!fle) {
 		RTE_LOG(ERR, PMD, "Memory alloc failed for SGE\n");
 		return -1;
@@ -215,6 +272,116 @@ static inline int build_authenc_fd(dpaa2_sec_session *sess,
 	return 0;
 }
 
+/* Same frame layout as build_authenc_fd(), with one SG entry per segment of
+ * the source mbuf in both the output and the input frame lists.
+ */
+static inline int build_authenc_sg_fd(dpaa2_sec_session *sess,
+				      struct rte_crypto_op *op,
+				      struct qbman_fd *fd, uint16_t bpid)
+{
+	struct rte_crypto_sym_op *sym_op = op->sym;
+	struct ctxt_priv *priv = sess->ctxt;
+	struct qbman_fle *fle_base, *fle, *sge;
+	struct sec_flow_context *flc;
+	uint32_t auth_only_len = sym_op->auth.data.length -
+				sym_op->cipher.data.length;
+	int icv_len = sym_op->auth.digest.length;
+	uint32_t nb_fle = 2 * sym_op->m_src->nb_segs + 6;
+	uint32_t mem_len = nb_fle * sizeof(struct qbman_fle) + icv_len;
+	uint8_t *old_icv;
+	int nb_sge;
+
+	PMD_INIT_FUNC_TRACE();
+
+	fle_base = dpaa2_sec_alloc_fle(op, mem_len);
+	if (!fle_base) {
+		RTE_LOG(ERR, PMD, "Memory alloc failed for SGE\n");
+		return -1;
+	}
+	old_icv = (uint8_t *)(fle_base + nb_fle);
+	DPAA2_SET_FLE_ADDR(fle_base, DPAA2_OP_VADDR_TO_IOVA(op));
+	fle = fle_base + 1;
+	sge = fle + 2;
+	if (likely(bpid < MAX_BPID)) {
+		DPAA2_SET_FD_BPID(fd, bpid);
+		DPAA2_SET_FLE_BPID(fle, bpid);
+		DPAA2_SET_FLE_BPID(fle + 1, bpid);
+	} else {
+		DPAA2_SET_FD_IVP(fd);
+		DPAA2_SET_FLE_IVP(fle);
+		DPAA2_SET_FLE_IVP((fle + 1));
+	}
+
+	flc = &priv->flc_desc[0].flc;
+	DPAA2_SET_FD_ADDR(fd, DPAA2_VADDR_TO_IOVA(fle));
+	DPAA2_SET_FD_COMPOUND_FMT(fd);
+	DPAA2_SET_FD_FLC(fd, DPAA2_VADDR_TO_IOVA(flc));
+
+	/* Configure Output FLE with Scatter/Gather Entries */
+	DPAA2_SET_FLE_ADDR(fle, DPAA2_VADDR_TO_IOVA(sge));
+	if (auth_only_len)
+		DPAA2_SET_FLE_INTERNAL_JD(fle, auth_only_len);
+	fle->length = (sess->dir == DIR_ENC) ?
+		(sym_op->cipher.data.length + icv_len) : sym_op->cipher.data.length;
+	DPAA2_SET_FLE_SG_EXT(fle);
+
+	nb_sge = dpaa2_sec_fill_sg(sge, sym_op->m_src, sym_op->cipher.data.offset,
+				   sym_op->cipher.data.length, bpid);
+	if (nb_sge <= 0)
+		goto sg_err;
+	sge += nb_sge;
+
+	if (sess->dir == DIR_ENC) {
+		DPAA2_SET_FLE_ADDR(sge, DPAA2_VADDR_TO_IOVA(sym_op->auth.digest.data));
+		sge->length = sym_op->auth.digest.length;
+		DPAA2_SET_FD_LEN(fd, (sym_op->auth.data.length + sym_op->cipher.iv.length));
+		sge++;
+	}
+	DPAA2_SET_FLE_FIN(sge - 1);
+
+	fle++;
+
+	/* Configure Input FLE with Scatter/Gather Entries */
+	DPAA2_SET_FLE_ADDR(fle, DPAA2_VADDR_TO_IOVA(sge));
+	DPAA2_SET_FLE_SG_EXT(fle);
+	DPAA2_SET_FLE_FIN(fle);
+	fle->length = (sess->dir == DIR_ENC) ?
+			(sym_op->auth.data.length + sym_op->cipher.iv.length) :
+			(sym_op->auth.data.length + sym_op->cipher.iv.length +
+			 sym_op->auth.digest.length);
+
+	DPAA2_SET_FLE_ADDR(sge, DPAA2_VADDR_TO_IOVA(sym_op->cipher.iv.data));
+	sge->length = sym_op->cipher.iv.length;
+	sge++;
+
+	nb_sge = dpaa2_sec_fill_sg(sge, sym_op->m_src, sym_op->auth.data.offset,
+				   sym_op->auth.data.length, bpid);
+	if (nb_sge < 0)
+		goto sg_err;
+	sge += nb_sge;
+
+	if (sess->dir == DIR_DEC) {
+		memcpy(old_icv,	sym_op->auth.digest.data, sym_op->auth.digest.length);
+		memset(sym_op->auth.digest.data, 0, sym_op->auth.digest.length);
+		DPAA2_SET_FLE_ADDR(sge, DPAA2_VADDR_TO_IOVA(old_icv));
+		sge->length = sym_op->auth.digest.length;
+		DPAA2_SET_FD_LEN(fd, (sym_op->auth.data.length +
+			sym_op->auth.digest.length + sym_op->cipher.iv.length));
+		sge++;
+	}
+	DPAA2_SET_FLE_FIN(sge - 1);
+	if (auth_only_len) {
+		DPAA2_SET_FLE_INTERNAL_JD(fle, auth_only_len);
+		DPAA2_SET_FD_INTERNAL_JD(fd, auth_only_len);
+	}
+	return 0;
+
+sg_err:
+	RTE_LOG(ERR, PMD, "mbuf chain shorter than the crypto data\n");
+	dpaa2_sec_free_fle(op, fle_base);
+	return -1;
+}
+
 static inline int build_auth_fd(
 		dpaa2_sec_session *sess,
 		struct rte_crypto_op *op,
@@ -231,7 +398,7 @@ static inline int build_auth_fd(
 
 	PMD_INIT_FUNC_TRACE();
 
-	fle = rte_zmalloc(NULL, mem_len, RTE_CACHE_LINE_SIZE);
+	fle = dpaa2_sec_alloc_fle(op, mem_len);
 	if (!fle) {
 		RTE_LOG(ERR, PMD, "Memory alloc failed for FLE\n");
 		return -1;
@@ -303,6 +470,89 @@ static inline int build_auth_fd(
 	return 0;
 }
 
+/* Same frame layout as build_auth_fd(), the input frame list always being
+ * a SG table with one entry per segment of the source mbuf.
+ */
+static inline int build_auth_sg_fd(
+		dpaa2_sec_session *sess,
+		struct rte_crypto_op *op,
+		struct qbman_fd *fd,
+		uint16_t bpid)
+{
+	struct rte_crypto_sym_op *sym_op = op->sym;
+	struct qbman_fle *fle_base, *fle, *sge;
+	uint32_t nb_fle = sym_op->m_src->nb_segs + 4;
+	uint32_t mem_len = nb_fle * sizeof(struct qbman_fle) +
+			sym_op->auth.digest.length;
+	struct sec_flow_context *flc;
+	struct ctxt_priv *priv = sess->ctxt;
+	uint8_t *old_digest;
+	int nb_sge;
+
+	PMD_INIT_FUNC_TRACE();
+
+	fle_base = dpaa2_sec_alloc_fle(op, mem_len);
+	if (!fle_base) {
+		RTE_LOG(ERR, PMD, "Memory alloc failed for FLE\n");
+		return -1;
+	}
+	old_digest = (uint8_t *)(fle_base + nb_fle);
+	DPAA2_SET_FLE_ADDR(fle_base, DPAA2_OP_VADDR_TO_IOVA(op));
+	fle = fle_base + 1;
+	sge = fle + 2;
+
+	if (likely(bpid < MAX_BPID)) {
+		DPAA2_SET_FD_BPID(fd, bpid);
+		DPAA2_SET_FLE_BPID(fle, bpid);
+		DPAA2_SET_FLE_BPID(fle + 1, bpid);
+	} else {
+		DPAA2_SET_FD_IVP(fd);
+		DPAA2_SET_FLE_IVP(fle);
+		DPAA2_SET_FLE_IVP((fle + 1));
+	}
+	flc = &priv->flc_desc[DESC_INITFINAL].flc;
+	DPAA2_SET_FD_FLC(fd, DPAA2_VADDR_TO_IOVA(flc));
+
+	DPAA2_SET_FLE_ADDR(fle, DPAA2_VADDR_TO_IOVA(sym_op->auth.digest.data));
+	fle->length = sym_op->auth.digest.length;
+
+	DPAA2_SET_FD_ADDR(fd, DPAA2_VADDR_TO_IOVA(fle));
+	DPAA2_SET_FD_COMPOUND_FMT(fd);
+	fle++;
+
+	DPAA2_SET_FLE_SG_EXT(fle);
+	DPAA2_SET_FLE_ADDR(fle, DPAA2_VADDR_TO_IOVA(sge));
+
+	nb_sge = dpaa2_sec_fill_sg(sge, sym_op->m_src, sym_op->auth.data.offset,
+				   sym_op->auth.data.length, bpid);
+	if (nb_sge <= 0) {
+		RTE_LOG(ERR, PMD, "mbuf chain shorter than the crypto data\n");
+		dpaa2_sec_free_fle(op, fle_base);
+		return -1;
+	}
+	sge += nb_sge;
+
+	if (sess->dir == DIR_ENC) {
+		DPAA2_SET_FD_LEN(fd, sym_op->auth.data.length);
+		fle->length = sym_op->auth.data.length;
+	} else {
+		rte_memcpy(old_digest, sym_op->auth.digest.data,
+			   sym_op->auth.digest.length);
+		memset(sym_op->auth.digest.data, 0, sym_op->auth.digest.length);
+		DPAA2_SET_FLE_ADDR(sge, DPAA2_VADDR_TO_IOVA(old_digest));
+		sge->length = sym_op->auth.digest.length;
+		DPAA2_SET_FD_LEN(fd, sym_op->auth.data.length +
+				 sym_op->auth.digest.length);
+		fle->length = sym_op->auth.data.length +
+				sym_op->auth.digest.length;
+		sge++;
+	}
+	DPAA2_SET_FLE_FIN(sge - 1);
+	DPAA2_SET_FLE_FIN(fle);
+
+	return 0;
+}
+
 static int build_cipher_fd(dpaa2_sec_session *sess, struct rte_crypto_op *op,
 			   struct qbman_fd *fd, uint16_t bpid)
 {
@@ -314,8 +564,7 @@ static int build_cipher_fd(dpaa2_sec_session *sess, struct rte_crypto_op *op,
 
 	PMD_INIT_FUNC_TRACE();
 
-	/* todo - we can use some mempool to avoid malloc here */
-	fle = rte_zmalloc(NULL, mem_len, RTE_CACHE_LINE_SIZE);
+	fle = dpaa2_sec_alloc_fle(op, mem_len);
 	if (!fle) {
 		RTE_LOG(ERR, PMD, "Memory alloc failed for SGE\n");
 		return -1;
@@ -392,6 +641,87 @@ static int build_cipher_fd(dpaa2_sec_session *sess, struct rte_crypto_op *op,
 	return 0;
 }
 
+/* Same frame layout as build_cipher_fd(), with SG tables describing the
+ * segments of the source mbuf instead of single frame entries.
+ */
+static int build_cipher_sg_fd(dpaa2_sec_session *sess,
+			      struct rte_crypto_op *op,
+			      struct qbman_fd *fd, uint16_t bpid)
+{
+	struct rte_crypto_sym_op *sym_op = op->sym;
+	struct qbman_fle *fle_base, *fle, *sge;
+	uint32_t mem_len = (2 * sym_op->m_src->nb_segs + 4) *
+			sizeof(struct qbman_fle);
+	struct sec_flow_context *flc;
+	struct ctxt_priv *priv = sess->ctxt;
+	int nb_sge;
+
+	PMD_INIT_FUNC_TRACE();
+
+	fle_base = dpaa2_sec_alloc_fle(op, mem_len);
+	if (!fle_base) {
+		RTE_LOG(ERR, PMD, "Memory alloc failed for SGE\n");
+		return -1;
+	}
+	DPAA2_SET_FLE_ADDR(fle_base, DPAA2_OP_VADDR_TO_IOVA(op));
+	fle = fle_base + 1;
+	sge = fle + 2;
+
+	if (likely(bpid < MAX_BPID)) {
+		DPAA2_SET_FD_BPID(fd, bpid);
+		DPAA2_SET_FLE_BPID(fle, bpid);
+		DPAA2_SET_FLE_BPID(fle + 1, bpid);
+	} else {
+		DPAA2_SET_FD_IVP(fd);
+		DPAA2_SET_FLE_IVP(fle);
+		DPAA2_SET_FLE_IVP((fle + 1));
+	}
+
+	flc = &priv->flc_desc[0].flc;
+	DPAA2_SET_FD_ADDR(fd, DPAA2_VADDR_TO_IOVA(fle));
+	DPAA2_SET_FD_LEN(fd, sym_op->cipher.data.length + sym_op->cipher.iv.length);
+	DPAA2_SET_FD_COMPOUND_FMT(fd);
+	DPAA2_SET_FD_FLC(fd, DPAA2_VADDR_TO_IOVA(flc));
+
+	/* Output SG table, the cipher data only */
+	DPAA2_SET_FLE_ADDR(fle, DPAA2_VADDR_TO_IOVA(sge));
+	DPAA2_SET_FLE_SG_EXT(fle);
+	fle->length = sym_op->cipher.data.length;
+
+	nb_sge = dpaa2_sec_fill_sg(sge, sym_op->m_src, sym_op->cipher.data.offset,
+				   sym_op->cipher.data.length, bpid);
+	if (nb_sge <= 0)
+		goto sg_err;
+	sge += nb_sge;
+	DPAA2_SET_FLE_FIN(sge - 1);
+
+	fle++;
+
+	/* Input SG table, the IV then the cipher data */
+	DPAA2_SET_FLE_ADDR(fle, DPAA2_VADDR_TO_IOVA(sge));
+	DPAA2_SET_FLE_SG_EXT(fle);
+	fle->length = sym_op->cipher.data.length + sym_op->cipher.iv.length;
+
+	DPAA2_SET_FLE_ADDR(sge, DPAA2_VADDR_TO_IOVA(sym_op->cipher.iv.data));
+	sge->length = sym_op->cipher.iv.length;
+	sge++;
+
+	nb_sge = dpaa2_sec_fill_sg(sge, sym_op->m_src, sym_op->cipher.data.offset,
+				   sym_op->cipher.data.length, bpid);
+	if (nb_sge <= 0)
+		goto sg_err;
+	sge += nb_sge;
+	DPAA2_SET_FLE_FIN(sge - 1);
+	DPAA2_SET_FLE_FIN(fle);
+
+	return 0;
+
+sg_err:
+	RTE_LOG(ERR, PMD, "mbuf chain shorter than the crypto data\n");
+	dpaa2_sec_free_fle(op, fle_base);
+	return -1;
+}
+
 static inline int
 build_sec_fd(dpaa2_sec_session *sess, struct rte_crypto_op *op,
 	     struct qbman_fd *fd, uint16_t bpid)
@@ -402,13 +732,22 @@ build_sec_fd(dpaa2_sec_session *sess, struct rte_crypto_op *op,
 
 	switch (sess->ctxt_type) {
 	case DPAA2_SEC_CIPHER:
-		ret = build_cipher_fd(sess, op, fd, bpid);
+		if (likely(rte_pktmbuf_is_contiguous(op->sym->m_src)))
+			ret = build_cipher_fd(sess, op, fd, bpid);
+		else
+			ret = build_cipher_sg_fd(sess, op, fd, bpid);
 		break;
 	case DPAA2_SEC_AUTH:
-		ret = build_auth_fd(sess, op, fd, bpid);
+		if (likely(rte_pktmbuf_is_contiguous(op->sym->m_src)))
+			ret = build_auth_fd(sess, op, fd, bpid);
+		else
+			ret = build_auth_sg_fd(sess, op, fd, bpid);
 		break;
 	case DPAA2_SEC_CIPHER_HASH:
-		ret = build_authenc_fd(sess, op, fd, bpid);
+		if (likely(rte_pktmbuf_is_contiguous(op->sym->m_src)))
+			ret = build_authenc_fd(sess, op, fd, bpid);
+		else
+			ret = build_authenc_sg_fd(sess, op, fd, bpid);
 		break;
 	case DPAA2_SEC_HASH_CIPHER:
 	default:
@@ -417,6 +756,60 @@ build_sec_fd(dpaa2_sec_session *sess, struct rte_crypto_op *op,
 	return ret;
 }
 
+/* Resolve the session of an op. Session-less ops take a session from the
+ * queue pair cache, whose slot is kept in the first FLE until dequeue so
+ * that the session cannot be evicted while SEC is using it.
+ */
+static inline dpaa2_sec_session *
+dpaa2_sec_get_session(struct dpaa2_sec_qp *qp, struct rte_crypto_op *op,
+		      uint32_t *cache_slot)
+{
+	struct rte_cryptodev_sym_session *sess;
+
+	if (likely(op->sym->sess_type == RTE_CRYPTO_SYM_OP_WITH_SESSION))
+		return (dpaa2_sec_session *)op->sym->session->_private;
+
+	if (qp->sess_cache == NULL)
+		return NULL;
+	sess = rte_cryptodev_sym_session_cache_get(qp->sess_cache,
+						   op->sym->xform, cache_slot);
+	if (sess == NULL)
+		return NULL;
+	op->sym->session = sess;
+	return (dpaa2_sec_session *)sess->_private;
+}
+
+static inline int
+dpaa2_sec_prepare_fd(struct dpaa2_sec_qp *qp, struct rte_crypto_op *op,
+		     struct qbman_fd *fd)
+{
+	dpaa2_sec_session *sess;
+	struct qbman_fle *fle;
+	uint32_t cache_slot = UINT32_MAX;
+	uint16_t bpid;
+	int ret;
+
+	sess = dpaa2_sec_get_session(qp, op, &cache_slot);
+	if (unlikely(sess == NULL)) {
+		op->status = RTE_CRYPTO_OP_STATUS_INVALID_SESSION;
+		return -1;
+	}
+	bpid = mempool_to_bpid(op->sym->m_src->pool);
+	ret = build_sec_fd(sess, op, fd, bpid);
+	if (op->sym->sess_type == RTE_CRYPTO_SYM_OP_WITH_SESSION)
+		return ret;
+
+	if (unlikely(ret)) {
+		rte_cryptodev_sym_session_cache_put(qp->sess_cache,
+						    cache_slot);
+		op->sym->session = NULL;
+		return ret;
+	}
+	fle = (struct qbman_fle *)DPAA2_IOVA_TO_VADDR(DPAA2_GET_FD_ADDR(fd));
+	(fle - 1)->reserved[0] = cache_slot;
+	return 0;
+}
+
 static uint16_t
 dpaa2_sec_enqueue_burst(void *qp, struct rte_crypto_op **ops,
 			uint16_t nb_ops)
@@ -434,18 +827,10 @@ dpaa2_sec_enqueue_burst(void *qp, struct rte_crypto_op **ops,
 	struct dpaa2_sec_qp *dpaa2_qp = (struct dpaa2_sec_qp *)qp;
 	struct qbman_swp *swp;
 	uint16_t num_tx = 0;
-	/*todo - need to support multiple buffer pools */
-	uint16_t bpid;
-	struct rte_mempool *mb_pool;
-	dpaa2_sec_session *sess;
 
 	if (unlikely(nb_ops == 0))
 		return 0;
 
-	if (ops[0]->sym->sess_type != RTE_CRYPTO_SYM_OP_WITH_SESSION) {
-		RTE_LOG(ERR, PMD, "sessionless crypto op not supported\n");
-		return 0;
-	}
 	/*Prepare enqueue descriptor*/
 	qbman_eq_desc_clear(&eqdesc);
 	qbman_eq_desc_set_no_orp(&eqdesc, DPAA2_EQ_RESP_ERR_FQ);
@@ -468,10 +853,8 @@ dpaa2_sec_enqueue_burst(void *qp, struct rte_crypto_op **ops,
 		for (loop = 0; loop < frames_to_send; loop++) {
 			/*Clear the unused FD fields before sending*/
 			memset(&fd_arr[loop], 0, sizeof(struct qbman_fd));
-			sess = (dpaa2_sec_session *)(*ops)->sym->session->_private;
-			mb_pool = (*ops)->sym->m_src->pool;
-			bpid = mempool_to_bpid(mb_pool);
-			ret = build_sec_fd(sess, *ops, &fd_arr[loop], bpid);
+			ret = dpaa2_sec_prepare_fd(dpaa2_qp, *ops,
+						   &fd_arr[loop]);
 			if (ret) {
 				PMD_DRV_LOG(ERR, "error: Improper packet"
 					    " contents for crypto operation\n");
@@ -493,10 +876,7 @@ dpaa2_sec_enqueue_burst(void *qp, struct rte_crypto_op **ops,
 	/*Prepare each packet which is to be sent*/
 	for (loop = 0; nb_ops; loop++, nb_ops--) {
 		memset(&fd, 0, sizeof(struct qbman_fd));
-		sess = (dpaa2_sec_session *)ops[loop]->sym->session->_private;
-		mb_pool = ops[loop]->sym->m_src->pool;
-		bpid = mempool_to_bpid(mb_pool);
-		ret = build_sec_fd(sess, ops[loop], &fd, bpid);
+		ret = dpaa2_sec_prepare_fd(dpaa2_qp, ops[loop], &fd);
 		if (ret) {
 			PMD_TX_LOG(ERR, "error: Improper packet contents"
 				   " for crypto operation\n");
@@ -521,7 +901,7 @@ skip_tx:
 }
 
 static inline
-struct rte_crypto_op *sec_fd_to_mbuf(
+struct rte_crypto_op *sec_fd_to_mbuf(struct dpaa2_sec_qp *qp,
 	const struct qbman_fd *fd)
 {
 	struct qbman_fle *fle;
@@ -559,8 +939,15 @@ struct rte_crypto_op *sec_fd_to_mbuf(
 		   DPAA2_GET_FD_OFFSET(fd),
 		   DPAA2_GET_FD_LEN(fd));
 
-	/* free the fle memory */
-	rte_free(fle - 1);
+	/* release the cached session of a session-less op */
+	if (op->sym->sess_type == RTE_CRYPTO_SYM_OP_SESSIONLESS) {
+		rte_cryptodev_sym_session_cache_put(qp->sess_cache,
+						    (fle - 1)->reserved[0]);
+		op->sym->session = NULL;
+	}
+
+	/* free the fle memory, unless it is part of the op */
+	dpaa2_sec_free_fle(op, fle - 1);
 
 	return op;
 }
@@ -636,12 +1023,13 @@ dpaa2_sec_dequeue_burst(void *qp, struct rte_crypto_op **ops,
 		}
 
 		fd = qbman_result_DQ_fd(dq_storage);
-		ops[num_rx] = sec_fd_to_mbuf(fd);
+		ops[num_rx] = sec_fd_to_mbuf(dpaa2_qp, fd);
 
 		if (unlikely(fd->simple.frc)) {
 			/* TODO Parse SEC errors */
 			RTE_LOG(ERR, PMD, "SEC returned Error - %x\n", fd->simple.frc);
 			ops[num_rx]->status = RTE_CRYPTO_OP_STATUS_ERROR;
+			dpaa2_qp->rx_vq.err_pkts++;
 		} else {
 			ops[num_rx]->status = RTE_CRYPTO_OP_STATUS_SUCCESS;
 		}
@@ -738,12 +1126,13 @@ dpaa2_sec_dequeue_prefetch_burst(void *qp, struct rte_crypto_op **ops,
 		}
 		fd[num_rx] = qbman_result_DQ_fd(dq_storage);
 
-		ops[num_rx] = sec_fd_to_mbuf(fd[num_rx]);
+		ops[num_rx] = sec_fd_to_mbuf(dpaa2_qp, fd[num_rx]);
 		if (unlikely(fd[num_rx]->simple.frc)) {
 			/* TODO Parse SEC errors */
 			RTE_LOG(ERR, PMD, "SEC returned Error - %x\n",
 				fd[num_rx]->simple.frc);
 			ops[num_rx]->status = RTE_CRYPTO_OP_STATUS_ERROR;
+			dpaa2_qp->rx_vq.err_pkts++;
 		} else {
 			ops[num_rx]->status = RTE_CRYPTO_OP_STATUS_SUCCESS;
 		}
@@ -798,6 +1187,7 @@ dpaa2_sec_queue_pair_release(struct rte_cryptodev *dev, uint16_t queue_pair_id)
 		dpaa2_free_dq_storage(qp->rx_vq.q_storage);
 		rte_free(qp->rx_vq.q_storage);
 	}
+	rte_cryptodev_sym_session_cache_free(qp->sess_cache);
 	rte_free(qp);
 
 	dev->data->queue_pairs[queue_pair_id] = NULL;
@@ -844,15 +1234,27 @@ dpaa2_sec_queue_pair_setup(struct rte_cryptodev *dev, uint16_t qp_id,
 		RTE_CACHE_LINE_SIZE);
 	if (!qp->rx_vq.q_storage) {
 		RTE_LOG(ERR, PMD, "malloc failed for q_storage\n");
-		return -1;
+		goto qp_setup_free_qp;
 	}
 	memset(qp->rx_vq.q_storage, 0, sizeof(struct queue_storage_info_t));
 
 	if (dpaa2_alloc_dq_storage(qp->rx_vq.q_storage)) {
 		RTE_LOG(ERR, PMD, "dpaa2_alloc_dq_storage failed\n");
-		return -1;
+		goto qp_setup_free_storage;
 	}
 
+	qp->sess_cache = NULL;
+#if RTE_CRYPTODEV_SYM_SESSION_CACHE_SIZE > 0
+	qp->sess_cache = rte_cryptodev_sym_session_cache_create(
+			dev->data->dev_id, RTE_CRYPTODEV_SYM_SESSION_CACHE_SIZE,
+			socket_id);
+	if (!qp->sess_cache) {
+		RTE_LOG(ERR, PMD, "session cache creation failed\n");
+		dpaa2_free_dq_storage(qp->rx_vq.q_storage);
+		goto qp_setup_free_storage;
+	}
+#endif
+
 	dev->data->queue_pairs[qp_id] = qp;
 
 	cfg.options = cfg.options | DPSECI_QUEUE_OPT_USER_CTX;
@@ -860,6 +1262,12 @@ dpaa2_sec_queue_pair_setup(struct rte_cryptodev *dev, uint16_t qp_id,
 	retcode = dpseci_set_rx_queue(dpseci, CMD_PRI_LOW, priv->token,
 				      qp_id, &cfg);
 	return retcode;
+
+qp_setup_free_storage:
+	rte_free(qp->rx_vq.q_storage);
+qp_setup_free_qp:
+	rte_free(qp);
+	return -1;
 }
 
 /** Start queue pair */
@@ -891,6 +1299,13 @@ dpaa2_sec_queue_pair_count(struct rte_cryptodev *dev)
 	return dev->data->nb_queue_pairs;
 }
 
+/** Returns the size of the FLE table reserved in each op */
+static unsigned
+dpaa2_sec_op_priv_get_size(struct rte_cryptodev *dev __rte_unused)
+{
+	return DPAA2_SEC_OP_PRIV_SIZE;
+}
+
 /** Returns the size of the aesni gcm session structure */
 static unsigned
 dpaa2_sec_session_get_size(struct rte_cryptodev *dev __rte_unused)
@@ -911,6 +1326,7 @@ static int dpaa2_sec_cipher_init(struct rte_cryptodev *dev,
 				 struct rte_crypto_sym_xform *xform,
 		dpaa2_sec_session *session)
 {
+	struct dpaa2_sec_dev_private *dev_priv = dev->data->dev_private;
 	struct dpaa2_sec_cipher_ctxt *ctxt = &session->ext_params.cipher_ctxt;
 	struct alginfo cipherdata;
 	unsigned int bufsize, i;
@@ -981,9 +1397,12 @@ static int dpaa2_sec_cipher_init(struct rte_cryptodev *dev,
 	session->dir = (xform->cipher.op == RTE_CRYPTO_CIPHER_OP_ENCRYPT) ?
 				DIR_ENC : DIR_DEC;
 
-	bufsize = cnstr_shdsc_blkcipher(priv->flc_desc[0].desc, 1, 0,
-					&cipherdata, NULL, ctxt->iv.length,
-			session->dir);
+	rte_spinlock_lock(&dev_priv->sd_tmpl_lock);
+	bufsize = sd_tmpl_blkcipher(&dev_priv->sd_tmpl,
+				    priv->flc_desc[0].desc, 1, 0,
+				    &cipherdata, ctxt->iv.length,
+				    session->dir);
+	rte_spinlock_unlock(&dev_priv->sd_tmpl_lock);
 	flc->dhr = 0;
 	flc->bpv0 = 0x1;
 	flc->mode_bits = 0x8000;
@@ -1012,6 +1431,7 @@ static int dpaa2_sec_auth_init(struct rte_cryptodev *dev,
 			       struct rte_crypto_sym_xform *xform,
 		dpaa2_sec_session *session)
 {
+	struct dpaa2_sec_dev_private *dev_priv = dev->data->dev_private;
 	struct dpaa2_sec_auth_ctxt *ctxt = &session->ext_params.auth_ctxt;
 	struct alginfo authdata;
 	unsigned int bufsize;
@@ -1101,8 +1521,11 @@ static int dpaa2_sec_auth_init(struct rte_cryptodev *dev,
 	session->dir = (xform->auth.op == RTE_CRYPTO_AUTH_OP_GENERATE) ?
 				DIR_ENC : DIR_DEC;
 
-	bufsize = cnstr_shdsc_hmac(priv->flc_desc[DESC_INITFINAL].desc,
-				   1, 0, &authdata, !session->dir, ctxt->trunc_len);
+	rte_spinlock_lock(&dev_priv->sd_tmpl_lock);
+	bufsize = sd_tmpl_hmac(&dev_priv->sd_tmpl,
+			       priv->flc_desc[DESC_INITFINAL].desc,
+			       1, 0, &authdata, !session->dir, ctxt->trunc_len);
+	rte_spinlock_unlock(&dev_priv->sd_tmpl_lock);
 
 	flc->word1_sdl = (uint8_t)bufsize;
 	flc->word2_rflc_31_0 = lower_32_bits(
@@ -1124,6 +1547,7 @@ static int dpaa2_sec_aead_init(struct rte_cryptodev *dev,
 			       struct rte_crypto_sym_xform *xform,
 		dpaa2_sec_session *session)
 {
+	struct dpaa2_sec_dev_private *dev_priv = dev->data->dev_private;
 	struct dpaa2_sec_aead_ctxt *ctxt = &session->ext_params.aead_ctxt;
 	struct alginfo authdata, cipherdata;
 	unsigned int bufsize;
@@ -1303,10 +1727,13 @@ static int dpaa2_sec_aead_init(struct rte_cryptodev *dev,
 	priv->flc_desc[0].desc[2] = 0;
 
 	if (session->ctxt_type == DPAA2_SEC_CIPHER_HASH) {
-		bufsize = cnstr_shdsc_authenc(priv->flc_desc[0].desc, 1,
-					      0, &cipherdata, &authdata, ctxt->iv.length,
-					      ctxt->auth_only_len, ctxt->trunc_len,
-					      session->dir);
+		rte_spinlock_lock(&dev_priv->sd_tmpl_lock);
+		bufsize = sd_tmpl_authenc(&dev_priv->sd_tmpl,
+					  priv->flc_desc[0].desc, 1,
+					  0, &cipherdata, &authdata, ctxt->iv.length,
+					  ctxt->auth_only_len, ctxt->trunc_len,
+					  session->dir);
+		rte_spinlock_unlock(&dev_priv->sd_tmpl_lock);
 	} else {
 		RTE_LOG(ERR, PMD, "Hash before cipher not supported");
 		goto error_out;
@@ -1503,7 +1930,13 @@ dpaa2_sec_dev_infos_get(struct rte_cryptodev *dev, struct rte_cryptodev_info *in
 		info->max_nb_queue_pairs = internals->max_nb_queue_pairs;
 		info->feature_flags = dev->feature_flags;
 		info->capabilities = dpaa2_sec_capabilities;
-		info->sym.max_nb_sessions = internals->max_nb_sessions;
+		/* Leave out the sessions the queue pairs may keep cached
+		 * for session-less operations, they use the same pool
+		 */
+		info->sym.max_nb_sessions = internals->max_nb_sessions -
+			RTE_MIN(internals->max_nb_sessions,
+				(unsigned)dev->data->nb_queue_pairs *
+				RTE_CRYPTODEV_SYM_SESSION_CACHE_SIZE);
 		info->dev_type = RTE_CRYPTODEV_DPAA2_SEC_PMD;
 	}
 }
@@ -1581,6 +2014,106 @@ void dpaa2_sec_stats_reset(struct rte_cryptodev *dev)
 	return;
 }
 
+/* SEC accelerator counters of the DPSECI object */
+static const struct {
+	const char *name;
+	unsigned offset;
+} dpaa2_sec_hw_xstats[] = {
+	{"sec_dequeued_requests",
+		offsetof(struct dpseci_sec_counters, dequeued_requests)},
+	{"sec_ob_enc_requests",
+		offsetof(struct dpseci_sec_counters, ob_enc_requests)},
+	{"sec_ib_dec_requests",
+		offsetof(struct dpseci_sec_counters, ib_dec_requests)},
+	{"sec_ob_enc_bytes", offsetof(struct dpseci_sec_counters, ob_enc_bytes)},
+	{"sec_ob_prot_bytes",
+		offsetof(struct dpseci_sec_counters, ob_prot_bytes)},
+	{"sec_ib_dec_bytes", offsetof(struct dpseci_sec_counters, ib_dec_bytes)},
+	{"sec_ib_valid_bytes",
+		offsetof(struct dpseci_sec_counters, ib_valid_bytes)},
+};
+
+/* per queue pair counters, then the ops still owned by SEC */
+static const char * const dpaa2_sec_qp_xstats[] = {
+	"enqueued", "dequeued", "enqueue_errors", "dequeue_errors", "in_flight",
+};
+
+static unsigned
+dpaa2_sec_xstats_count(struct rte_cryptodev *dev)
+{
+	return RTE_DIM(dpaa2_sec_hw_xstats) +
+		dev->data->nb_queue_pairs * RTE_DIM(dpaa2_sec_qp_xstats);
+}
+
+static int
+dpaa2_sec_xstats_get_names(struct rte_cryptodev *dev,
+			   struct rte_cryptodev_xstat_name *xstats_names,
+			   unsigned size)
+{
+	unsigned count = dpaa2_sec_xstats_count(dev);
+	unsigned i, j, n = 0;
+
+	if (xstats_names == NULL || size < count)
+		return count;
+
+	for (i = 0; i < RTE_DIM(dpaa2_sec_hw_xstats); i++)
+		snprintf(xstats_names[n++].name, sizeof(xstats_names[0].name),
+			 "%s", dpaa2_sec_hw_xstats[i].name);
+
+	for (i = 0; i < dev->data->nb_queue_pairs; i++)
+		for (j = 0; j < RTE_DIM(dpaa2_sec_qp_xstats); j++)
+			snprintf(xstats_names[n++].name,
+				 sizeof(xstats_names[0].name), "qp%u_%s",
+				 i, dpaa2_sec_qp_xstats[j]);
+
+	return count;
+}
+
+static int
+dpaa2_sec_xstats_get(struct rte_cryptodev *dev,
+		     struct rte_cryptodev_xstat *xstats, unsigned n)
+{
+	struct dpaa2_sec_dev_private *priv = dev->data->dev_private;
+	struct fsl_mc_io *dpseci = (struct fsl_mc_io *)priv->hw;
+	struct dpseci_sec_counters counters = {0};
+	struct dpaa2_sec_qp **qp = (struct dpaa2_sec_qp **)
+					dev->data->queue_pairs;
+	unsigned count = dpaa2_sec_xstats_count(dev);
+	unsigned i, idx = 0;
+	int ret;
+
+	if (xstats == NULL || n < count)
+		return count;
+
+	ret = dpseci_get_sec_counters(dpseci, CMD_PRI_LOW, priv->token,
+				      &counters);
+	if (ret) {
+		PMD_DRV_LOG(ERR, "dpseci_get_sec_counters failed\n");
+		return -EIO;
+	}
+
+	for (i = 0; i < RTE_DIM(dpaa2_sec_hw_xstats); i++)
+		xstats[idx++].value = *(uint64_t *)RTE_PTR_ADD(&counters,
+					dpaa2_sec_hw_xstats[i].offset);
+
+	for (i = 0; i < dev->data->nb_queue_pairs; i++) {
+		if (qp[i] == NULL) {
+			memset(&xstats[idx], 0, RTE_DIM(dpaa2_sec_qp_xstats) *
+			       sizeof(*xstats));
+			idx += RTE_DIM(dpaa2_sec_qp_xstats);
+			continue;
+		}
+		xstats[idx++].value = qp[i]->tx_vq.tx_pkts;
+		xstats[idx++].value = qp[i]->rx_vq.rx_pkts;
+		xstats[idx++].value = qp[i]->tx_vq.err_pkts;
+		xstats[idx++].value = qp[i]->rx_vq.err_pkts;
+		xstats[idx++].value = qp[i]->tx_vq.tx_pkts -
+				      qp[i]->rx_vq.rx_pkts;
+	}
+
+	return count;
+}
+
 static struct rte_cryptodev_ops crypto_ops = {
 	.dev_configure	      = dpaa2_sec_dev_configure,
 	.dev_start	      = dpaa2_sec_dev_start,
@@ -1589,6 +2122,8 @@ static struct rte_cryptodev_ops crypto_ops = {
 	.dev_infos_get        = dpaa2_sec_dev_infos_get,
 	.stats_get	      = dpaa2_sec_stats_get,
 	.stats_reset	      = dpaa2_sec_stats_reset,
+	.xstats_get	      = dpaa2_sec_xstats_get,
+	.xstats_get_names     = dpaa2_sec_xstats_get_names,
 	.queue_pair_setup     = dpaa2_sec_queue_pair_setup,
 	.queue_pair_release   = dpaa2_sec_queue_pair_release,
 	.queue_pair_start     = dpaa2_sec_queue_pair_start,
@@ -1598,6 +2133,7 @@ static struct rte_cryptodev_ops crypto_ops = {
 	.session_initialize   = dpaa2_sec_session_initialize,
 	.session_configure    = dpaa2_sec_session_configure,
 	.session_clear        = dpaa2_sec_session_clear,
+	.op_priv_get_size     = dpaa2_sec_op_priv_get_size,
 };
 
 static int
@@ -1640,7 +2176,8 @@ dpaa2_sec_dev_init(__attribute__((unused)) struct rte_cryptodev_driver *crypto_d
 #endif
 	dev->feature_flags = RTE_CRYPTODEV_FF_SYMMETRIC_CRYPTO |
 			RTE_CRYPTODEV_FF_HW_ACCELERATED |
-			RTE_CRYPTODEV_FF_SYM_OPERATION_CHAINING;
+			RTE_CRYPTODEV_FF_SYM_OPERATION_CHAINING |
+			RTE_CRYPTODEV_FF_MBUF_SCATTER_GATHER;
 
 	internals = dev->data->dev_private;
 	internals->max_nb_sessions = RTE_DPAA2_SEC_PMD_MAX_NB_SESSIONS;
@@ -1680,6 +2217,7 @@ dpaa2_sec_dev_init(__attribute__((unused)) struct rte_cryptodev_driver *crypto_d
 
 	internals->max_nb_queue_pairs = attr.num_tx_queues;
 	dev->data->nb_queue_pairs = internals->max_nb_queue_pairs;
+	rte_spinlock_init(&internals->sd_tmpl_lock);
 	internals->hw = dpseci;
 	internals->token = token;
 
@@ -35,6 +35,9 @@
 
 #define MAX_QUEUES		64
 #define MAX_DESC_SIZE		64
+#define MAX_ICV_SIZE		64
+/** Per op FLE table: op pointer, up to 6 FLE/SGEs and a copy of the ICV */
+#define DPAA2_SEC_OP_PRIV_SIZE	(7 * sizeof(struct qbman_fle) + MAX_ICV_SIZE)
 /** private data structure for each DPAA2_SEC device */
 struct dpaa2_sec_dev_private {
 	void *mc_portal; /**< MC Portal for configuring this device */
@@ -46,11 +49,17 @@ struct dpaa2_sec_dev_private {
 
 	unsigned max_nb_sessions;
 	/**< Max number of sessions supported by device */
+	rte_spinlock_t sd_tmpl_lock;
+	/**< Serializes the sessions using the templates */
+	struct sd_tmpl_cache sd_tmpl;
+	/**< Shared descriptor templates of the sessions */
 };
 
 struct dpaa2_sec_qp {
 	struct dpaa2_queue rx_vq;
 	struct dpaa2_queue tx_vq;
+	struct rte_cryptodev_sym_session_cache *sess_cache;
+	/**< Sessions of session-less operations */
 };
 
 enum shr_desc_type {
@@ -46,6 +46,7 @@
 #include <rte_dev.h>
 #include <rte_common.h>
 #include <rte_byteorder.h>
+#include <rte_spinlock.h>
 #include <rte_cryptodev_pmd.h>
 
 #include <usdpaa/fsl_usd.h>
@@ -54,6 +55,7 @@
 #include <flib/desc/common.h>
 #include <flib/desc/algo.h>
 #include <flib/desc/ipsec.h>
+#include <flib/desc/sd_tmpl.h>
 #include <flib/rta.h>
 
 #include "dpaa_sec.h"
@@ -79,8 +81,6 @@
    a pointer to the shared descriptor*/
 #define MIN_JOB_DESC_SIZE	(CAAM_CMD_SZ + CAAM_PTR_SZ)
 
-enum rta_sec_era rta_sec_era;
-
 static __thread struct rte_crypto_op **dpaa_sec_ops;
 static __thread int dpaa_sec_op_nb;
 
@@ -99,13 +99,22 @@ static inline void dpaa_sec_op_ending(struct dpaa_sec_op_ctx *ctx)
 	}
 
 	/* report op status to sym->op and then free the ctx memeory  */
-	rte_free(ctx);
+	if (!ctx->in_op)
+		rte_free(ctx);
 }
 
-static inline struct dpaa_sec_job *dpaa_sec_alloc_job(void)
+static inline struct dpaa_sec_job *dpaa_sec_alloc_job(struct rte_crypto_op *op)
 {
 	struct dpaa_sec_op_ctx *ctx;
 
+	/* use the area reserved in the op by the op pool when there is one */
+	ctx = __rte_crypto_op_get_drv_priv_data(op, sizeof(*ctx));
+	if (ctx) {
+		memset(ctx, 0, sizeof(*ctx));
+		ctx->in_op = 1;
+		return &ctx->job;
+	}
+
 	ctx = rte_zmalloc(NULL, sizeof(*ctx), RTE_CACHE_LINE_SIZE);
 	if (!ctx) {
 		printf("Alloc sec descriptor failed!\n");
@@ -400,14 +409,20 @@ static int dpaa_sec_prep_cdb(struct dpaa_sec_ses *ses)
 	alginfo_a.algmode = OP_ALG_AAI_HMAC;
 
 	if (is_cipher_only(ses)) {
-		shared_desc_len = cnstr_shdsc_blkcipher(cdb->sh_desc, true,
+		rte_spinlock_lock(&qi->sd_tmpl_lock);
+		shared_desc_len = sd_tmpl_blkcipher(&qi->sd_tmpl,
+					cdb->sh_desc, true,
 					swap, &alginfo_c,
-					NULL, ses->cipher.iv_len,
+					ses->cipher.iv_len,
 					ses->dir);
+		rte_spinlock_unlock(&qi->sd_tmpl_lock);
 	} else if (is_auth_only(ses)) {
-		shared_desc_len = cnstr_shdsc_hmac(cdb->sh_desc, true,
+		rte_spinlock_lock(&qi->sd_tmpl_lock);
+		shared_desc_len = sd_tmpl_hmac(&qi->sd_tmpl,
+					cdb->sh_desc, true,
 					swap, &alginfo_a,
 					!ses->dir, ses->auth_trunc_len);
+		rte_spinlock_unlock(&qi->sd_tmpl_lock);
 	} else {
 		cdb->sh_desc[0] = alginfo_c.keylen;
 		cdb->sh_desc[1] = alginfo_a.keylen;
@@ -437,10 +452,13 @@ static int dpaa_sec_prep_cdb(struct dpaa_sec_ses *ses)
 
 		/* Auth_only_len is set as 0 here and it will be overwritten
 		   in fd for each packet.*/
-		shared_desc_len = cnstr_shdsc_authenc(cdb->sh_desc, true,
+		rte_spinlock_lock(&qi->sd_tmpl_lock);
+		shared_desc_len = sd_tmpl_authenc(&qi->sd_tmpl,
+					cdb->sh_desc, true,
 					swap, &alginfo_c, &alginfo_a,
 					ses->cipher.iv_len, 0,
 					ses->auth_trunc_len, ses->dir);
+		rte_spinlock_unlock(&qi->sd_tmpl_lock);
 	}
 	cdb->sh_hdr.hi.field.idlen = shared_desc_len;
 	cdb->sh_hdr.hi.word = rte_cpu_to_be_32(cdb->sh_hdr.hi.word);
@@ -518,7 +536,7 @@ static inline struct dpaa_sec_job *build_auth_only(struct rte_crypto_op *op)
 	phys_addr_t start_addr;
 	uint8_t *old_digest;
 
-	cf = dpaa_sec_alloc_job();
+	cf = dpaa_sec_alloc_job(op);
 	if (!cf)
 		return NULL;
 
@@ -579,7 +597,7 @@ static inline struct dpaa_sec_job *build_cipher_only(struct rte_crypto_op *op)
 	struct qm_sg_entry *sg;
 	phys_addr_t start_addr;
 
-	cf = dpaa_sec_alloc_job();
+	cf = dpaa_sec_alloc_job(op);
 	if (!cf)
 		return NULL;
 
@@ -630,7 +648,7 @@ static inline struct dpaa_sec_job *build_cipher_auth(struct rte_crypto_op *op)
 
 	start_addr = mbuf->buf_physaddr + mbuf->data_off;
 
-	cf = dpaa_sec_alloc_job();
+	cf = dpaa_sec_alloc_job(op);
 	if (!cf)
 		return NULL;
 
@@ -782,13 +800,15 @@ static uint16_t
 dpaa_sec_dequeue_burst(void *qp, struct rte_crypto_op **ops,
 		       uint16_t nb_ops)
 {
-	uint16_t num_rx;
+	uint16_t num_rx, i;
 	struct dpaa_sec_qp *dpaa_qp = (struct dpaa_sec_qp *)qp;
 
 	num_rx = dpaa_sec_deq(dpaa_qp, ops, nb_ops);
 
 	dpaa_qp->rx_pkts += num_rx;
-	dpaa_qp->rx_errs += nb_ops - num_rx;
+	for (i = 0; i < num_rx; i++)
+		if (ops[i]->status != RTE_CRYPTO_OP_STATUS_SUCCESS)
+			dpaa_qp->rx_errs++;
 
 	PMD_DRV_LOG(DEBUG, "SEC Received %d Packets\n", num_rx);
 
@@ -857,6 +877,12 @@ dpaa_sec_session_get_size(struct rte_cryptodev *dev __rte_unused)
 	return sizeof(struct dpaa_sec_ses);
 }
 
+static unsigned
+dpaa_sec_op_priv_get_size(struct rte_cryptodev *dev __rte_unused)
+{
+	return sizeof(struct dpaa_sec_op_ctx);
+}
+
 static void
 dpaa_sec_session_initialize(struct rte_mempool *mp __rte_unused,
 						    void *ses __rte_unused)
@@ -1034,16 +1060,94 @@ dpaa_sec_dev_infos_get(struct rte_cryptodev *dev,
 }
 
 static
-void dpaa_sec_stats_get(struct rte_cryptodev *dev __rte_unused,
-			struct rte_cryptodev_stats *stats __rte_unused)
+void dpaa_sec_stats_get(struct rte_cryptodev *dev,
+			struct rte_cryptodev_stats *stats)
 {
-	/* -ENOTSUP; */
+	struct dpaa_sec_qp **qp = (struct dpaa_sec_qp **)
+					dev->data->queue_pairs;
+	int i;
+
+	for (i = 0; i < dev->data->nb_queue_pairs; i++) {
+		if (qp[i] == NULL)
+			continue;
+
+		stats->enqueued_count += qp[i]->tx_pkts;
+		stats->dequeued_count += qp[i]->rx_pkts;
+		stats->enqueue_err_count += qp[i]->tx_errs;
+		stats->dequeue_err_count += qp[i]->rx_errs;
+	}
 }
 
 static
-void dpaa_sec_stats_reset(struct rte_cryptodev *dev __rte_unused)
+void dpaa_sec_stats_reset(struct rte_cryptodev *dev)
 {
-	/* -ENOTSUP; */
+	struct dpaa_sec_qp **qp = (struct dpaa_sec_qp **)
+					dev->data->queue_pairs;
+	int i;
+
+	for (i = 0; i < dev->data->nb_queue_pairs; i++) {
+		if (qp[i] == NULL)
+			continue;
+
+		qp[i]->rx_pkts = 0;
+		qp[i]->rx_errs = 0;
+		qp[i]->tx_pkts = 0;
+		qp[i]->tx_errs = 0;
+	}
+}
+
+/* per queue pair counters, then the ops still owned by SEC */
+static const char * const dpaa_sec_qp_xstats[] = {
+	"enqueued", "dequeued", "enqueue_errors", "dequeue_errors", "in_flight",
+};
+
+static int
+dpaa_sec_xstats_get_names(struct rte_cryptodev *dev,
+			  struct rte_cryptodev_xstat_name *xstats_names,
+			  unsigned size)
+{
+	unsigned count = dev->data->nb_queue_pairs * RTE_DIM(dpaa_sec_qp_xstats);
+	unsigned i, j, n = 0;
+
+	if (xstats_names == NULL || size < count)
+		return count;
+
+	for (i = 0; i < dev->data->nb_queue_pairs; i++)
+		for (j = 0; j < RTE_DIM(dpaa_sec_qp_xstats); j++)
+			snprintf(xstats_names[n++].name,
+				 sizeof(xstats_names[0].name), "qp%u_%s",
+				 i, dpaa_sec_qp_xstats[j]);
+
+	return count;
+}
+
+static int
+dpaa_sec_xstats_get(struct rte_cryptodev *dev,
+		    struct rte_cryptodev_xstat *xstats, unsigned n)
+{
+	struct dpaa_sec_qp **qp = (struct dpaa_sec_qp **)
+					dev->data->queue_pairs;
+	unsigned count = dev->data->nb_queue_pairs * RTE_DIM(dpaa_sec_qp_xstats);
+	unsigned i, idx = 0;
+
+	if (xstats == NULL || n < count)
+		return count;
+
+	for (i = 0; i < dev->data->nb_queue_pairs; i++) {
+		if (qp[i] == NULL) {
+			memset(&xstats[idx], 0, RTE_DIM(dpaa_sec_qp_xstats) *
+			       sizeof(*xstats));
+			idx += RTE_DIM(dpaa_sec_qp_xstats);
+			continue;
+		}
+		xstats[idx++].value = qp[i]->tx_pkts;
+		xstats[idx++].value = qp[i]->rx_pkts;
+		xstats[idx++].value = qp[i]->tx_errs;
+		xstats[idx++].value = qp[i]->rx_errs;
+		xstats[idx++].value = qp[i]->tx_pkts - qp[i]->rx_pkts;
+	}
+
+	return count;
 }
 
 static int
@@ -1067,6 +1171,8 @@ static struct rte_cryptodev_ops crypto_ops = {
 	.dev_infos_get        = dpaa_sec_dev_infos_get,
 	.stats_get	      = dpaa_sec_stats_get,
 	.stats_reset	      = dpaa_sec_stats_reset,
+	.xstats_get	      = dpaa_sec_xstats_get,
+	.xstats_get_names     = dpaa_sec_xstats_get_names,
 	.queue_pair_setup     = dpaa_sec_queue_pair_setup,
 	.queue_pair_release   = dpaa_sec_queue_pair_release,
 	.queue_pair_start     = dpaa_sec_queue_pair_start,
@@ -1076,6 +1182,7 @@ static struct rte_cryptodev_ops crypto_ops = {
 	.session_initialize   = dpaa_sec_session_initialize,
 	.session_configure    = dpaa_sec_session_configure,
 	.session_clear        = dpaa_sec_session_clear,
+	.op_priv_get_size     = dpaa_sec_op_priv_get_size,
 };
 
 static int
@@ -1109,6 +1216,7 @@ dpaa_sec_dev_init(__attribute__((unused))
 	}
 	qi->max_nb_queue_pairs = RTE_MAX_NB_SEC_QPS;
 	qi->max_nb_sessions = RTE_MAX_NB_SEC_SES;
+	rte_spinlock_init(&qi->sd_tmpl_lock);
 	dev->data->dev_private = qi;
 
 	dpaa_sec_dev_configure(dev);
@@ -69,10 +69,10 @@ struct dpaa_sec_qp {
 	struct dpaa_sec_qi *qi;
 	struct qman_fq inq;
 	struct qman_fq outq;
-	int rx_pkts;
-	int rx_errs;
-	int tx_pkts;
-	int tx_errs;
+	uint64_t rx_pkts;
+	uint64_t rx_errs;
+	uint64_t tx_pkts;
+	uint64_t tx_errs;
 };
 
 #define DPAA_SEC_MAX_DESC_SIZE  64
@@ -141,6 +141,8 @@ struct dpaa_sec_qi {
 	unsigned max_nb_sessions;
 	struct dpaa_sec_ses *ses; /* session associated with the sec */
 	struct sec_cdb cdb; /* code block for sec session */
+	rte_spinlock_t sd_tmpl_lock; /* serializes the template users */
+	struct sd_tmpl_cache sd_tmpl; /* shared descriptor templates */
 };
 
 struct dpaa_sec_job {
@@ -154,6 +156,7 @@ struct dpaa_sec_op_ctx {
 	struct rte_crypto_op *op;
 	uint32_t fd_status;
 	uint32_t auth_only_len;
+	uint8_t in_op; /* ctx lives in the op private area, not malloc'ed */
 	uint8_t digest[DPAA_MAX_NB_MAX_DIGEST];
 };
 
@@ -110,25 +110,41 @@ process_op(const struct null_crypto_qp *qp, struct rte_crypto_op *op,
 }
 
 static struct null_crypto_session *
-get_session(struct null_crypto_qp *qp, struct rte_crypto_sym_op *op)
+get_session(struct null_crypto_qp *qp, struct rte_crypto_op *op,
+		uint32_t *cache_slot)
 {
+	struct rte_crypto_sym_op *sym_op = op->sym;
 	struct null_crypto_session *sess;
 
-	if (op->sess_type == RTE_CRYPTO_SYM_OP_WITH_SESSION) {
-		if (unlikely(op->session == NULL ||
-			     op->session->dev_type != RTE_CRYPTODEV_NULL_PMD))
+	if (sym_op->sess_type == RTE_CRYPTO_SYM_OP_WITH_SESSION) {
+		if (unlikely(sym_op->session == NULL ||
+			     sym_op->session->dev_type != RTE_CRYPTODEV_NULL_PMD))
 			return NULL;
 
-		sess = (struct null_crypto_session *)op->session->_private;
+		sess = (struct null_crypto_session *)sym_op->session->_private;
 	} else  {
-		struct rte_cryptodev_session *c_sess = NULL;
+		struct rte_cryptodev_sym_session *cached = NULL;
 
-		if (rte_mempool_get(qp->sess_mp, (void **)&c_sess))
-			return NULL;
+		/* reuse the session of an earlier op with the same xforms */
+		if (qp->sess_cache != NULL)
+			cached = rte_cryptodev_sym_session_cache_get(
+					qp->sess_cache, sym_op->xform,
+					cache_slot);
+		if (cached != NULL)
+			return (struct null_crypto_session *)cached->_private;
+
+		/* build the session in the op when the pool reserved room */
+		sess = __rte_crypto_op_get_drv_priv_data(op, sizeof(*sess));
+		if (sess == NULL) {
+			struct rte_cryptodev_session *c_sess = NULL;
 
-		sess = (struct null_crypto_session *)c_sess->_private;
+			if (rte_mempool_get(qp->sess_mp, (void **)&c_sess))
+				return NULL;
 
-		if (null_crypto_set_session_parameters(sess, op->xform)	!= 0)
+			sess = (struct null_crypto_session *)c_sess->_private;
+		}
+
+		if (null_crypto_set_session_parameters(sess, sym_op->xform) != 0)
 			return NULL;
 	}
 
@@ -142,15 +158,22 @@ null_crypto_pmd_enqueue_burst(void *queue_pair, struct rte_crypto_op **ops,
 {
 	struct null_crypto_session *sess;
 	struct null_crypto_qp *qp = queue_pair;
+	uint32_t cache_slot;
 
 	int i, retval;
 
 	for (i = 0; i < nb_ops; i++) {
-		sess = get_session(qp, ops[i]->sym);
+		cache_slot = UINT32_MAX;
+		sess = get_session(qp, ops[i], &cache_slot);
 		if (unlikely(sess == NULL))
 			goto enqueue_err;
 
 		retval = process_op(qp, ops[i], sess);
+
+		/* processing completed, the cached session can be replaced */
+		if (cache_slot != UINT32_MAX)
+			rte_cryptodev_sym_session_cache_put(qp->sess_cache,
+					cache_slot);
 		if (unlikely(retval < 0))
 			goto enqueue_err;
 	}
@@ -216,7 +239,8 @@ cryptodev_null_create(const char *name,
 	dev->enqueue_burst = null_crypto_pmd_enqueue_burst;
 
 	dev->feature_flags = RTE_CRYPTODEV_FF_SYMMETRIC_CRYPTO |
-			RTE_CRYPTODEV_FF_SYM_OPERATION_CHAINING;
+			RTE_CRYPTODEV_FF_SYM_OPERATION_CHAINING |
+			RTE_CRYPTODEV_FF_MBUF_SCATTER_GATHER;
 
 	internals = dev->data->dev_private;
 
@@ -141,6 +141,68 @@ null_crypto_pmd_stats_reset(struct rte_cryptodev *dev)
 	}
 }
 
+/** Per queue pair statistics reported as extended statistics */
+static const struct {
+	const char *name;
+	unsigned offset;
+} null_crypto_qp_xstats[] = {
+	{"enqueued", offsetof(struct rte_cryptodev_stats, enqueued_count)},
+	{"dequeued", offsetof(struct rte_cryptodev_stats, dequeued_count)},
+	{"enqueue_errors", offsetof(struct rte_cryptodev_stats,
+		enqueue_err_count)},
+	{"dequeue_errors", offsetof(struct rte_cryptodev_stats,
+		dequeue_err_count)},
+};
+
+/* per queue pair counters, then the processed ring occupancy */
+#define NULL_CRYPTO_NB_QP_XSTATS (RTE_DIM(null_crypto_qp_xstats) + 1)
+
+/** Get names of device extended statistics */
+static int
+null_crypto_pmd_xstats_get_names(struct rte_cryptodev *dev,
+		struct rte_cryptodev_xstat_name *xstats_names, unsigned size)
+{
+	unsigned count = dev->data->nb_queue_pairs * NULL_CRYPTO_NB_QP_XSTATS;
+	unsigned qp_id, i, n = 0;
+
+	if (xstats_names == NULL || size < count)
+		return count;
+
+	for (qp_id = 0; qp_id < dev->data->nb_queue_pairs; qp_id++) {
+		for (i = 0; i < RTE_DIM(null_crypto_qp_xstats); i++)
+			snprintf(xstats_names[n++].name,
+				sizeof(xstats_names[0].name), "qp%u_%s",
+				qp_id, null_crypto_qp_xstats[i].name);
+		snprintf(xstats_names[n++].name, sizeof(xstats_names[0].name),
+			"qp%u_ring_occupancy", qp_id);
+	}
+
+	return count;
+}
+
+/** Get device extended statistics */
+static int
+null_crypto_pmd_xstats_get(struct rte_cryptodev *dev,
+		struct rte_cryptodev_xstat *xstats, unsigned n)
+{
+	unsigned count = dev->data->nb_queue_pairs * NULL_CRYPTO_NB_QP_XSTATS;
+	unsigned qp_id, i, idx = 0;
+
+	if (xstats == NULL || n < count)
+		return count;
+
+	for (qp_id = 0; qp_id < dev->data->nb_queue_pairs; qp_id++) {
+		struct null_crypto_qp *qp = dev->data->queue_pairs[qp_id];
+
+		for (i = 0; i < RTE_DIM(null_crypto_qp_xstats); i++)
+			xstats[idx++].value = *(uint64_t *)RTE_PTR_ADD(
+					&qp->qp_stats,
+					null_crypto_qp_xstats[i].offset);
+		xstats[idx++].value = rte_ring_count(qp->processed_pkts);
+	}
+
+	return count;
+}
 
 /** Get device info */
 static void
@@ -162,8 +224,11 @@ null_crypto_pmd_info_get(struct rte_cryptodev *dev,
 static int
 null_crypto_pmd_qp_release(struct rte_cryptodev *dev, uint16_t qp_id)
 {
-	if (dev->data->queue_pairs[qp_id] != NULL) {
-		rte_free(dev->data->queue_pairs[qp_id]);
+	struct null_crypto_qp *qp = dev->data->queue_pairs[qp_id];
+
+	if (qp != NULL) {
+		rte_cryptodev_sym_session_cache_free(qp->sess_cache);
+		rte_free(qp);
 		dev->data->queue_pairs[qp_id] = NULL;
 	}
 	return 0;
@@ -259,13 +324,25 @@ null_crypto_pmd_qp_setup(struct rte_cryptodev *dev, uint16_t qp_id,
 
 	qp->sess_mp = dev->data->session_pool;
 
+#if RTE_CRYPTODEV_SYM_SESSION_CACHE_SIZE > 0
+	qp->sess_cache = rte_cryptodev_sym_session_cache_create(
+			dev->data->dev_id, RTE_CRYPTODEV_SYM_SESSION_CACHE_SIZE,
+			socket_id);
+	if (qp->sess_cache == NULL) {
+		NULL_CRYPTO_LOG_ERR("Failed to create session cache");
+		goto qp_setup_cleanup;
+	}
+#endif
+
 	memset(&qp->qp_stats, 0, sizeof(qp->qp_stats));
 
 	return 0;
 
 qp_setup_cleanup:
-	if (qp)
+	if (qp) {
+		dev->data->queue_pairs[qp_id] = NULL;
 		rte_free(qp);
+	}
 
 	return -1;
 }
@@ -300,6 +377,13 @@ null_crypto_pmd_session_get_size(struct rte_cryptodev *dev __rte_unused)
 	return sizeof(struct null_crypto_session);
 }
 
+/** Return the size of the session-less session kept in each op */
+static unsigned
+null_crypto_pmd_op_priv_get_size(struct rte_cryptodev *dev __rte_unused)
+{
+	return sizeof(struct null_crypto_session);
+}
+
 /** Configure a null crypto session from a crypto xform chain */
 static void *
 null_crypto_pmd_session_configure(struct rte_cryptodev *dev __rte_unused,
@@ -338,6 +422,8 @@ struct rte_cryptodev_ops pmd_ops = {
 
 		.stats_get		= null_crypto_pmd_stats_get,
 		.stats_reset		= null_crypto_pmd_stats_reset,
+		.xstats_get		= null_crypto_pmd_xstats_get,
+		.xstats_get_names	= null_crypto_pmd_xstats_get_names,
 
 		.dev_infos_get		= null_crypto_pmd_info_get,
 
@@ -349,7 +435,8 @@ struct rte_cryptodev_ops pmd_ops = {
 
 		.session_get_size	= null_crypto_pmd_session_get_size,
 		.session_configure	= null_crypto_pmd_session_configure,
-		.session_clear		= null_crypto_pmd_session_clear
+		.session_clear		= null_crypto_pmd_session_clear,
+		.op_priv_get_size	= null_crypto_pmd_op_priv_get_size
 };
 
 struct rte_cryptodev_ops *null_crypto_pmd_ops = &pmd_ops;
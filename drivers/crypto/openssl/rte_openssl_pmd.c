@@ -37,11 +37,38 @@
 #include <rte_dev.h>
 #include <rte_malloc.h>
 #include <rte_cpuflags.h>
+#include <rte_kvargs.h>
+#include <rte_lcore.h>
+#include <rte_ip.h>
+#include <rte_random.h>
 
+#include <netinet/in.h>
 #include <openssl/evp.h>
+#include <openssl/crypto.h>
 
 #include "rte_openssl_pmd_private.h"
 
+#define OPENSSL_MAX_NB_QP_ARG		("max_nb_queue_pairs")
+#define OPENSSL_MAX_NB_SESS_ARG		("max_nb_sessions")
+#define OPENSSL_SOCKET_ID_ARG		("socket_id")
+#define OPENSSL_WORKER_LCORE_ARG	("worker_lcore")
+
+static const char *openssl_valid_params[] = {
+	OPENSSL_MAX_NB_QP_ARG,
+	OPENSSL_MAX_NB_SESS_ARG,
+	OPENSSL_SOCKET_ID_ARG,
+	OPENSSL_WORKER_LCORE_ARG,
+	NULL
+};
+
+/** OPENSSL device creation parameters */
+struct openssl_init_params {
+	struct rte_crypto_vdev_init_params def_p;
+	/**< Parameters common to all virtual crypto devices */
+	int worker_lcore;
+	/**< lcore processing the operations, -1 if none */
+};
+
 static int cryptodev_openssl_uninit(const char *name);
 
 /*----------------------------------------------------------------------------*/
@@ -289,6 +316,21 @@ openssl_set_session_cipher_parameters(struct openssl_session *sess,
 				&sess->cipher.evp_algo) != 0)
 			return -EINVAL;
 
+		/* Expand the key once, operations only load their IV */
+		if (sess->cipher.direction == RTE_CRYPTO_CIPHER_OP_ENCRYPT) {
+			if (EVP_EncryptInit_ex(sess->cipher.ctx,
+					sess->cipher.evp_algo, NULL,
+					sess->cipher.key.data, NULL) <= 0)
+				return -EINVAL;
+		} else {
+			if (EVP_DecryptInit_ex(sess->cipher.ctx,
+					sess->cipher.evp_algo, NULL,
+					sess->cipher.key.data, NULL) <= 0)
+				return -EINVAL;
+		}
+
+		if (EVP_CIPHER_CTX_set_padding(sess->cipher.ctx, 0) <= 0)
+			return -EINVAL;
 		break;
 
 	case RTE_CRYPTO_CIPHER_3DES_CTR:
@@ -298,6 +340,13 @@ openssl_set_session_cipher_parameters(struct openssl_session *sess,
 		if (get_cipher_key_ede(sess->cipher.key.data,
 				sess->cipher.key.length, sess->cipher.key_ede) != 0)
 			return -EINVAL;
+
+		/* We use 3DES encryption also for decryption.
+		 * IV is not important for 3DES ecb
+		 */
+		if (EVP_EncryptInit_ex(sess->cipher.ctx, EVP_des_ede3_ecb(),
+				NULL, sess->cipher.key_ede, NULL) <= 0)
+			return -EINVAL;
 		break;
 
 	default:
@@ -326,6 +375,11 @@ openssl_set_session_auth_parameters(struct openssl_session *sess,
 		sess->auth.cipher.key.data = xform->auth.key.data;
 		sess->auth.cipher.key.length = xform->auth.key.length;
 		sess->auth.cipher.ctx = EVP_CIPHER_CTX_new();
+
+		if (EVP_EncryptInit_ex(sess->auth.cipher.ctx,
+				sess->auth.cipher.evp_algo, NULL,
+				sess->auth.cipher.key.data, NULL) <= 0)
+			return -EINVAL;
 		break;
 
 	case RTE_CRYPTO_AUTH_MD5:
@@ -352,6 +406,15 @@ openssl_set_session_auth_parameters(struct openssl_session *sess,
 			return -EINVAL;
 		sess->auth.hmac.pkey = EVP_PKEY_new_mac_key(EVP_PKEY_HMAC, NULL,
 				xform->auth.key.data, xform->auth.key.length);
+		if (sess->auth.hmac.pkey == NULL)
+			return -EINVAL;
+
+		/* Keep the inner and outer pads hashed in a template */
+		sess->auth.hmac.ctx_init = EVP_MD_CTX_create();
+		if (EVP_DigestSignInit(sess->auth.hmac.ctx_init, NULL,
+				sess->auth.hmac.evp_algo, NULL,
+				sess->auth.hmac.pkey) <= 0)
+			return -EINVAL;
 		break;
 
 	default:
@@ -362,6 +425,102 @@ openssl_set_session_auth_parameters(struct openssl_session *sess,
 	return 0;
 }
 
+/** Set session IPsec parameters, once cipher and auth ones are set */
+static int
+openssl_set_session_ipsec_parameters(struct openssl_session *sess,
+		const struct rte_crypto_sym_xform *xform,
+		const struct rte_crypto_sym_xform *auth_xform)
+{
+	const struct rte_crypto_ipsec_xform *ipsec = &xform->ipsec;
+	struct ipv4_hdr *ip4;
+	struct ipv6_hdr *ip6;
+
+	if (ipsec->proto != RTE_CRYPTO_IPSEC_PROTO_ESP ||
+			ipsec->replay_win_sz > RTE_CRYPTO_IPSEC_MAX_REPLAY_WIN_SZ)
+		return -EINVAL;
+
+	/* ESP encrypts then authenticates, the chain has to match */
+	if (ipsec->direction == RTE_CRYPTO_IPSEC_DIR_EGRESS) {
+		if (sess->chain_order != OPENSSL_CHAIN_CIPHER_AUTH ||
+				sess->cipher.direction !=
+					RTE_CRYPTO_CIPHER_OP_ENCRYPT ||
+				sess->auth.operation !=
+					RTE_CRYPTO_AUTH_OP_GENERATE)
+			return -EINVAL;
+	} else {
+		if (sess->chain_order != OPENSSL_CHAIN_AUTH_CIPHER ||
+				sess->cipher.direction !=
+					RTE_CRYPTO_CIPHER_OP_DECRYPT ||
+				sess->auth.operation !=
+					RTE_CRYPTO_AUTH_OP_VERIFY)
+			return -EINVAL;
+	}
+
+	if (sess->cipher.mode != OPENSSL_CIPHER_LIB ||
+			sess->auth.mode != OPENSSL_AUTH_AS_HMAC)
+		return -EINVAL;
+
+	switch (sess->cipher.algo) {
+	case RTE_CRYPTO_CIPHER_AES_CBC:
+		sess->ipsec.iv_len = 16;
+		sess->ipsec.block_size = 16;
+		break;
+	case RTE_CRYPTO_CIPHER_3DES_CBC:
+		sess->ipsec.iv_len = 8;
+		sess->ipsec.block_size = 8;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	sess->ipsec.digest_len = auth_xform->auth.digest_length;
+	if (sess->ipsec.digest_len == 0 || sess->ipsec.digest_len >
+			EVP_MD_size(sess->auth.hmac.evp_algo))
+		return -EINVAL;
+
+	sess->ipsec.mode = ipsec->mode;
+	sess->ipsec.direction = ipsec->direction;
+	sess->ipsec.spi = ipsec->spi;
+	sess->ipsec.seq = ipsec->seq;
+	sess->ipsec.replay_win_sz = ipsec->replay_win_sz;
+	sess->ipsec.replay_bitmap = ipsec->seq != 0;
+	sess->ipsec.hdr_len = 0;
+
+	/* Build the outer header, only lengths change per packet */
+	if (ipsec->mode == RTE_CRYPTO_IPSEC_MODE_TUNNEL &&
+			ipsec->direction == RTE_CRYPTO_IPSEC_DIR_EGRESS) {
+		memset(sess->ipsec.hdr, 0, sizeof(sess->ipsec.hdr));
+
+		switch (ipsec->tunnel.type) {
+		case RTE_CRYPTO_IPSEC_TUNNEL_IPV4:
+			ip4 = (struct ipv4_hdr *)sess->ipsec.hdr;
+			ip4->version_ihl = 0x45;
+			ip4->time_to_live = ipsec->tunnel.ipv4.ttl ?
+					ipsec->tunnel.ipv4.ttl : OPENSSL_IPSEC_DEF_TTL;
+			ip4->next_proto_id = IPPROTO_ESP;
+			ip4->src_addr = ipsec->tunnel.ipv4.src_addr;
+			ip4->dst_addr = ipsec->tunnel.ipv4.dst_addr;
+			sess->ipsec.hdr_len = sizeof(struct ipv4_hdr);
+			break;
+		case RTE_CRYPTO_IPSEC_TUNNEL_IPV6:
+			ip6 = (struct ipv6_hdr *)sess->ipsec.hdr;
+			ip6->proto = IPPROTO_ESP;
+			ip6->hop_limits = ipsec->tunnel.ipv6.hlimit ?
+					ipsec->tunnel.ipv6.hlimit : OPENSSL_IPSEC_DEF_TTL;
+			memcpy(ip6->src_addr, ipsec->tunnel.ipv6.src_addr, 16);
+			memcpy(ip6->dst_addr, ipsec->tunnel.ipv6.dst_addr, 16);
+			sess->ipsec.hdr_len = sizeof(struct ipv6_hdr);
+			break;
+		default:
+			return -EINVAL;
+		}
+	}
+
+	sess->chain_order = OPENSSL_CHAIN_IPSEC_ESP;
+
+	return 0;
+}
+
 /** Parse crypto xform chain and set private session parameters */
 int
 openssl_set_session_parameters(struct openssl_session *sess,
@@ -369,6 +528,13 @@ openssl_set_session_parameters(struct openssl_session *sess,
 {
 	const struct rte_crypto_sym_xform *cipher_xform = NULL;
 	const struct rte_crypto_sym_xform *auth_xform = NULL;
+	const struct rte_crypto_sym_xform *ipsec_xform = NULL;
+
+	/* An IPsec xform heads the chain of the SA algorithms */
+	if (xform != NULL && xform->type == RTE_CRYPTO_SYM_XFORM_IPSEC) {
+		ipsec_xform = xform;
+		xform = xform->next;
+	}
 
 	sess->chain_order = openssl_get_chain_order(xform);
 	switch (sess->chain_order) {
@@ -406,6 +572,15 @@ openssl_set_session_parameters(struct openssl_session *sess,
 		}
 	}
 
+	if (ipsec_xform) {
+		if (openssl_set_session_ipsec_parameters(sess, ipsec_xform,
+				auth_xform)) {
+			OPENSSL_LOG_ERR(
+				"Invalid/unsupported IPsec parameters");
+			return -EINVAL;
+		}
+	}
+
 	return 0;
 }
 
@@ -421,6 +596,8 @@ openssl_reset_session(struct openssl_session *sess)
 		break;
 	case OPENSSL_AUTH_AS_HMAC:
 		EVP_MD_CTX_destroy(sess->auth.hmac.ctx);
+		EVP_MD_CTX_destroy(sess->auth.hmac.ctx_init);
+		EVP_PKEY_free(sess->auth.hmac.pkey);
 		break;
 	case OPENSSL_AUTH_AS_CIPHER:
 		EVP_CIPHER_CTX_free(sess->auth.cipher.ctx);
@@ -431,8 +608,19 @@ openssl_reset_session(struct openssl_session *sess)
 }
 
 /** Provide session for operation */
+/** Release a session-less session unless it lives in the op itself */
+static inline void
+openssl_put_sessionless(const struct openssl_qp *qp, struct rte_crypto_op *op,
+		void *_sess)
+{
+	if (_sess != __rte_crypto_op_get_drv_priv_data(op,
+			OPENSSL_OP_PRIV_SIZE))
+		rte_mempool_put(qp->sess_mp, _sess);
+}
+
 static struct openssl_session *
-get_session(struct openssl_qp *qp, struct rte_crypto_op *op)
+get_session(struct openssl_qp *qp, struct rte_crypto_op *op,
+		uint32_t *cache_slot)
 {
 	struct openssl_session *sess = NULL;
 
@@ -444,17 +632,31 @@ get_session(struct openssl_qp *qp, struct rte_crypto_op *op)
 			sess = (struct openssl_session *)
 				op->sym->session->_private;
 	} else  {
-		/* provide internal session */
-		void *_sess = NULL;
+		struct rte_cryptodev_sym_session *cached = NULL;
+		void *_sess;
+
+		/* reuse the session of an earlier op with the same xforms */
+		if (qp->sess_cache != NULL)
+			cached = rte_cryptodev_sym_session_cache_get(
+					qp->sess_cache, op->sym->xform,
+					cache_slot);
+		if (cached != NULL) {
+			op->sym->session = cached;
+			return (struct openssl_session *)cached->_private;
+		}
+
+		/* provide internal session, in the op if the pool made room */
+		_sess = __rte_crypto_op_get_drv_priv_data(op,
+				OPENSSL_OP_PRIV_SIZE);
 
-		if (!rte_mempool_get(qp->sess_mp, (void **)&_sess)) {
+		if (_sess != NULL || !rte_mempool_get(qp->sess_mp, &_sess)) {
 			sess = (struct openssl_session *)
 				((struct rte_cryptodev_sym_session *)_sess)
 				->_private;
 
 			if (unlikely(openssl_set_session_parameters(
 					sess, op->sym->xform) != 0)) {
-				rte_mempool_put(qp->sess_mp, _sess);
+				openssl_put_sessionless(qp, op, _sess);
 				sess = NULL;
 			} else
 				op->sym->session = _sess;
@@ -473,15 +675,82 @@ get_session(struct openssl_qp *qp, struct rte_crypto_op *op)
  *------------------------------------------------------------------------------
  */
 
+/** Position within the data of a possibly chained mbuf */
+struct openssl_sgl_pos {
+	struct rte_mbuf *m;
+	uint32_t off;
+};
+
+/**
+ * Move to the segment holding an offset, or to the last segment when the
+ * offset is past the data so that its tailroom can still be written
+ */
+static inline void
+openssl_sgl_seek(struct openssl_sgl_pos *pos, struct rte_mbuf *m,
+		uint32_t off)
+{
+	while (m->next != NULL && off >= rte_pktmbuf_data_len(m)) {
+		off -= rte_pktmbuf_data_len(m);
+		m = m->next;
+	}
+
+	pos->m = m;
+	pos->off = off;
+}
+
+/**
+ * Address of the data at a position and the contiguous length left, 0 past
+ * the end. The tailroom of the last segment counts when writing.
+ */
+static inline uint8_t *
+openssl_sgl_run(const struct openssl_sgl_pos *pos, uint32_t *len,
+		int to_mbuf)
+{
+	uint32_t end = rte_pktmbuf_data_len(pos->m);
+
+	if (to_mbuf && pos->m->next == NULL)
+		end += rte_pktmbuf_tailroom(pos->m);
+
+	*len = pos->off < end ? end - pos->off : 0;
+	return rte_pktmbuf_mtod_offset(pos->m, uint8_t *, pos->off);
+}
+
+/** Copy between a flat buffer and the data at a position, moving it */
+static inline int
+openssl_sgl_copy(struct openssl_sgl_pos *pos, uint8_t *buf, uint32_t len,
+		int to_mbuf)
+{
+	uint8_t *data;
+	uint32_t run;
+
+	while (len > 0) {
+		data = openssl_sgl_run(pos, &run, to_mbuf);
+		if (run == 0)
+			return -1;
+
+		run = RTE_MIN(run, len);
+		if (to_mbuf)
+			memcpy(data, buf, run);
+		else
+			memcpy(buf, data, run);
+
+		buf += run;
+		len -= run;
+		openssl_sgl_seek(pos, pos->m, pos->off + run);
+	}
+
+	return 0;
+}
+
 /** Process standard openssl cipher encryption */
 static int
 process_openssl_cipher_encrypt(uint8_t *src, uint8_t *dst,
-		uint8_t *iv, uint8_t *key, int srclen,
-		EVP_CIPHER_CTX *ctx, const EVP_CIPHER *algo)
+		uint8_t *iv, int srclen, EVP_CIPHER_CTX *ctx)
 {
 	int dstlen, totlen;
 
-	if (EVP_EncryptInit_ex(ctx, algo, NULL, key, iv) <= 0)
+	/* Key is already set up in the session context */
+	if (EVP_EncryptInit_ex(ctx, NULL, NULL, NULL, iv) <= 0)
 		goto process_cipher_encrypt_err;
 
 	if (EVP_EncryptUpdate(ctx, dst, &dstlen, src, srclen) <= 0)
@@ -500,15 +769,12 @@ process_cipher_encrypt_err:
 /** Process standard openssl cipher decryption */
 static int
 process_openssl_cipher_decrypt(uint8_t *src, uint8_t *dst,
-		uint8_t *iv, uint8_t *key, int srclen,
-		EVP_CIPHER_CTX *ctx, const EVP_CIPHER *algo)
+		uint8_t *iv, int srclen, EVP_CIPHER_CTX *ctx)
 {
 	int dstlen, totlen;
 
-	if (EVP_DecryptInit_ex(ctx, algo, NULL, key, iv) <= 0)
-		goto process_cipher_decrypt_err;
-
-	if (EVP_CIPHER_CTX_set_padding(ctx, 0) <= 0)
+	/* Key is already set up in the session context */
+	if (EVP_DecryptInit_ex(ctx, NULL, NULL, NULL, iv) <= 0)
 		goto process_cipher_decrypt_err;
 
 	if (EVP_DecryptUpdate(ctx, dst, &dstlen, src, srclen) <= 0)
@@ -524,32 +790,109 @@ process_cipher_decrypt_err:
 	return -EINVAL;
 }
 
+/**
+ * Process standard openssl cipher over chained mbufs. Runs of whole blocks
+ * are processed in place in the segments, the blocks straddling segment
+ * boundaries go through a bounce buffer.
+ */
+static int
+process_openssl_cipher_sgl(struct rte_mbuf *mbuf_src,
+		struct rte_mbuf *mbuf_dst, int offset, uint8_t *iv,
+		int srclen, EVP_CIPHER_CTX *ctx)
+{
+	struct openssl_sgl_pos spos, dpos;
+	uint8_t sbuf[EVP_MAX_BLOCK_LENGTH], dbuf[EVP_MAX_BLOCK_LENGTH];
+	uint8_t *src, *dst;
+	uint32_t block, srun, drun, len = srclen, n;
+	int dstlen;
+
+	/* Key and direction are already set up in the session context */
+	if (EVP_CipherInit_ex(ctx, NULL, NULL, NULL, iv, -1) <= 0)
+		goto process_cipher_sgl_err;
+
+	block = EVP_CIPHER_CTX_block_size(ctx);
+	openssl_sgl_seek(&spos, mbuf_src, offset);
+	openssl_sgl_seek(&dpos, mbuf_dst, offset);
+
+	while (len > 0) {
+		src = openssl_sgl_run(&spos, &srun, 0);
+		dst = openssl_sgl_run(&dpos, &drun, 0);
+		if (srun == 0 || drun == 0)
+			goto process_cipher_sgl_err;
+
+		n = RTE_MIN(RTE_MIN(srun, drun), len);
+		n -= n % block;
+
+		if (n > 0) {
+			if (EVP_CipherUpdate(ctx, dst, &dstlen, src, n) <= 0 ||
+					(uint32_t)dstlen != n)
+				goto process_cipher_sgl_err;
+			openssl_sgl_seek(&spos, spos.m, spos.off + n);
+			openssl_sgl_seek(&dpos, dpos.m, dpos.off + n);
+		} else {
+			n = RTE_MIN(block, len);
+			if (openssl_sgl_copy(&spos, sbuf, n, 0) != 0)
+				goto process_cipher_sgl_err;
+			if (EVP_CipherUpdate(ctx, dbuf, &dstlen, sbuf, n) <= 0 ||
+					(uint32_t)dstlen != n)
+				goto process_cipher_sgl_err;
+			if (openssl_sgl_copy(&dpos, dbuf, n, 1) != 0)
+				goto process_cipher_sgl_err;
+		}
+
+		len -= n;
+	}
+
+	if (EVP_CipherFinal_ex(ctx, dbuf, &dstlen) <= 0)
+		goto process_cipher_sgl_err;
+
+	return 0;
+
+process_cipher_sgl_err:
+	OPENSSL_LOG_ERR("Process openssl cipher over segments failed");
+	return -EINVAL;
+}
+
 /** Process cipher des 3 ctr encryption, decryption algorithm */
 static int
-process_openssl_cipher_des3ctr(uint8_t *src, uint8_t *dst,
-		uint8_t *iv, uint8_t *key, int srclen, EVP_CIPHER_CTX *ctx)
+process_openssl_cipher_des3ctr(struct rte_mbuf *mbuf_src,
+		struct rte_mbuf *mbuf_dst, int offset, uint8_t *iv,
+		int srclen, EVP_CIPHER_CTX *ctx)
 {
+	struct openssl_sgl_pos spos, dpos;
 	uint8_t ebuf[8], ctr[8];
+	uint8_t *src, *dst;
+	uint32_t srun, drun, i;
 	int unused, n;
 
-	/* We use 3DES encryption also for decryption.
-	 * IV is not important for 3DES ecb
-	 */
-	if (EVP_EncryptInit_ex(ctx, EVP_des_ede3_ecb(), NULL, key, NULL) <= 0)
-		goto process_cipher_des3ctr_err;
-
 	memcpy(ctr, iv, 8);
 	n = 0;
 
+	openssl_sgl_seek(&spos, mbuf_src, offset);
+	openssl_sgl_seek(&dpos, mbuf_dst, offset);
+
 	while (n < srclen) {
-		if (n % 8 == 0) {
-			if (EVP_EncryptUpdate(ctx, (unsigned char *)&ebuf, &unused,
-					(const unsigned char *)&ctr, 8) <= 0)
-				goto process_cipher_des3ctr_err;
-			ctr_inc(ctr);
+		src = openssl_sgl_run(&spos, &srun, 0);
+		dst = openssl_sgl_run(&dpos, &drun, 0);
+		if (srun == 0 || drun == 0)
+			goto process_cipher_des3ctr_err;
+
+		srun = RTE_MIN(RTE_MIN(srun, drun), (uint32_t)(srclen - n));
+
+		for (i = 0; i < srun; i++, n++) {
+			if (n % 8 == 0) {
+				if (EVP_EncryptUpdate(ctx,
+						(unsigned char *)&ebuf, &unused,
+						(const unsigned char *)&ctr,
+						8) <= 0)
+					goto process_cipher_des3ctr_err;
+				ctr_inc(ctr);
+			}
+			dst[i] = src[i] ^ ebuf[n % 8];
 		}
-		dst[n] = src[n] ^ ebuf[n % 8];
-		n++;
+
+		openssl_sgl_seek(&spos, spos.m, spos.off + srun);
+		openssl_sgl_seek(&dpos, dpos.m, dpos.off + srun);
 	}
 
 	return 0;
@@ -561,23 +904,33 @@ process_cipher_des3ctr_err:
 
 /** Process auth gmac algorithm */
 static int
-process_openssl_auth_gmac(uint8_t *src, uint8_t *dst,
-		uint8_t *iv, uint8_t *key, int srclen, int ivlen,
-		EVP_CIPHER_CTX *ctx, const EVP_CIPHER *algo)
+process_openssl_auth_gmac(struct rte_mbuf *mbuf_src, uint8_t *dst,
+		int offset, uint8_t *iv, int srclen, int ivlen,
+		EVP_CIPHER_CTX *ctx)
 {
+	struct openssl_sgl_pos pos;
+	uint8_t *src;
+	uint32_t run;
 	int unused;
 
-	if (EVP_EncryptInit_ex(ctx, algo, NULL, NULL, NULL) <= 0)
-		goto process_auth_gmac_err;
-
 	if (EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_IVLEN, ivlen, NULL) <= 0)
 		goto process_auth_gmac_err;
 
-	if (EVP_EncryptInit_ex(ctx, NULL, NULL, key, iv) <= 0)
+	/* Key schedule and hash subkey are kept from the session setup */
+	if (EVP_EncryptInit_ex(ctx, NULL, NULL, NULL, iv) <= 0)
 		goto process_auth_gmac_err;
 
-	if (EVP_EncryptUpdate(ctx, NULL, &unused, src, srclen) <= 0)
-		goto process_auth_gmac_err;
+	for (openssl_sgl_seek(&pos, mbuf_src, offset); srclen > 0;
+			srclen -= run) {
+		src = openssl_sgl_run(&pos, &run, 0);
+		if (run == 0)
+			goto process_auth_gmac_err;
+		run = RTE_MIN(run, (uint32_t)srclen);
+
+		if (EVP_EncryptUpdate(ctx, NULL, &unused, src, run) <= 0)
+			goto process_auth_gmac_err;
+		openssl_sgl_seek(&pos, pos.m, pos.off + run);
+	}
 
 	if (EVP_EncryptFinal_ex(ctx, NULL, &unused) <= 0)
 		goto process_auth_gmac_err;
@@ -594,17 +947,29 @@ process_auth_gmac_err:
 
 /** Process standard openssl auth algorithms */
 static int
-process_openssl_auth(uint8_t *src, uint8_t *dst,
+process_openssl_auth(struct rte_mbuf *mbuf_src, uint8_t *dst, int offset,
 		__rte_unused uint8_t *iv, __rte_unused EVP_PKEY * pkey,
 		int srclen, EVP_MD_CTX *ctx, const EVP_MD *algo)
 {
+	struct openssl_sgl_pos pos;
 	size_t dstlen;
+	uint8_t *src;
+	uint32_t run;
 
 	if (EVP_DigestInit_ex(ctx, algo, NULL) <= 0)
 		goto process_auth_err;
 
-	if (EVP_DigestUpdate(ctx, (char *)src, srclen) <= 0)
-		goto process_auth_err;
+	for (openssl_sgl_seek(&pos, mbuf_src, offset); srclen > 0;
+			srclen -= run) {
+		src = openssl_sgl_run(&pos, &run, 0);
+		if (run == 0)
+			goto process_auth_err;
+		run = RTE_MIN(run, (uint32_t)srclen);
+
+		if (EVP_DigestUpdate(ctx, (char *)src, run) <= 0)
+			goto process_auth_err;
+		openssl_sgl_seek(&pos, pos.m, pos.off + run);
+	}
 
 	if (EVP_DigestFinal_ex(ctx, dst, (unsigned int *)&dstlen) <= 0)
 		goto process_auth_err;
@@ -618,17 +983,30 @@ process_auth_err:
 
 /** Process standard openssl auth algorithms with hmac */
 static int
-process_openssl_auth_hmac(uint8_t *src, uint8_t *dst,
-		__rte_unused uint8_t *iv, EVP_PKEY *pkey,
+process_openssl_auth_hmac(struct rte_mbuf *mbuf_src, uint8_t *dst,
+		int offset, EVP_MD_CTX *ctx_init,
 		int srclen,	EVP_MD_CTX *ctx, const EVP_MD *algo)
 {
-	size_t dstlen;
+	struct openssl_sgl_pos pos;
+	size_t dstlen = EVP_MD_size(algo);
+	uint8_t *src;
+	uint32_t run;
 
-	if (EVP_DigestSignInit(ctx, NULL, algo, NULL, pkey) <= 0)
+	/* Start from the keyed state instead of hashing the pads again */
+	if (EVP_MD_CTX_copy_ex(ctx, ctx_init) <= 0)
 		goto process_auth_err;
 
-	if (EVP_DigestSignUpdate(ctx, (char *)src, srclen) <= 0)
-		goto process_auth_err;
+	for (openssl_sgl_seek(&pos, mbuf_src, offset); srclen > 0;
+			srclen -= run) {
+		src = openssl_sgl_run(&pos, &run, 0);
+		if (run == 0)
+			goto process_auth_err;
+		run = RTE_MIN(run, (uint32_t)srclen);
+
+		if (EVP_DigestSignUpdate(ctx, (char *)src, run) <= 0)
+			goto process_auth_err;
+		openssl_sgl_seek(&pos, pos.m, pos.off + run);
+	}
 
 	if (EVP_DigestSignFinal(ctx, dst, &dstlen) <= 0)
 		goto process_auth_err;
@@ -649,28 +1027,29 @@ process_openssl_cipher_op
 		struct rte_mbuf *mbuf_src, struct rte_mbuf *mbuf_dst)
 {
 	uint8_t *src, *dst, *iv;
-	int srclen, status;
+	int srclen, offset, status;
 
 	srclen = op->sym->cipher.data.length;
-	src = rte_pktmbuf_mtod_offset(mbuf_src, uint8_t *,
-			op->sym->cipher.data.offset);
-	dst = rte_pktmbuf_mtod_offset(mbuf_dst, uint8_t *,
-			op->sym->cipher.data.offset);
-
+	offset = op->sym->cipher.data.offset;
 	iv = op->sym->cipher.iv.data;
 
-	if (sess->cipher.mode == OPENSSL_CIPHER_LIB)
+	if (sess->cipher.mode == OPENSSL_CIPHER_DES3CTR)
+		status = process_openssl_cipher_des3ctr(mbuf_src, mbuf_dst,
+				offset, iv, srclen, sess->cipher.ctx);
+	else if (unlikely(mbuf_src->nb_segs > 1 || mbuf_dst->nb_segs > 1))
+		status = process_openssl_cipher_sgl(mbuf_src, mbuf_dst,
+				offset, iv, srclen, sess->cipher.ctx);
+	else {
+		src = rte_pktmbuf_mtod_offset(mbuf_src, uint8_t *, offset);
+		dst = rte_pktmbuf_mtod_offset(mbuf_dst, uint8_t *, offset);
+
 		if (sess->cipher.direction == RTE_CRYPTO_CIPHER_OP_ENCRYPT)
 			status = process_openssl_cipher_encrypt(src, dst, iv,
-					sess->cipher.key.data, srclen,
-					sess->cipher.ctx, sess->cipher.evp_algo);
+					srclen, sess->cipher.ctx);
 		else
 			status = process_openssl_cipher_decrypt(src, dst, iv,
-					sess->cipher.key.data, srclen,
-					sess->cipher.ctx, sess->cipher.evp_algo);
-	else
-		status = process_openssl_cipher_des3ctr(src, dst, iv,
-				sess->cipher.key_ede, srclen, sess->cipher.ctx);
+					srclen, sess->cipher.ctx);
+	}
 
 	if (status == 0)
 		op->status = RTE_CRYPTO_OP_STATUS_SUCCESS;
@@ -686,40 +1065,36 @@ process_openssl_auth_op
 		(struct rte_crypto_op *op, struct openssl_session *sess,
 		struct rte_mbuf *mbuf_src, struct rte_mbuf *mbuf_dst)
 {
-	uint8_t *src, *dst, *iv;
-	int srclen, ivlen, status = -1;
+	struct openssl_sgl_pos pos;
+	uint8_t digest[EVP_MAX_MD_SIZE];
+	uint8_t *iv;
+	int srclen, offset, ivlen, status = -1;
 
 	srclen = op->sym->auth.data.length;
-	src = rte_pktmbuf_mtod_offset(mbuf_src, uint8_t *,
-			op->sym->auth.data.offset);
+	offset = op->sym->auth.data.offset;
 
-	if (sess->auth.operation == RTE_CRYPTO_AUTH_OP_GENERATE) {
-		dst = rte_pktmbuf_mtod_offset(mbuf_dst, uint8_t *,
-				op->sym->auth.data.offset +
-				op->sym->auth.data.length);
-	} else {
-		dst = (uint8_t *)rte_pktmbuf_append(mbuf_src,
-				op->sym->auth.digest.length);
+	if (unlikely(op->sym->auth.digest.length > sizeof(digest))) {
+		op->status = RTE_CRYPTO_OP_STATUS_INVALID_ARGS;
+		return -EINVAL;
 	}
 
 	switch (sess->auth.mode) {
 	case OPENSSL_AUTH_AS_AUTH:
-		status = process_openssl_auth(src, dst,
-				NULL, NULL,	srclen,
+		status = process_openssl_auth(mbuf_src, digest, offset,
+				NULL, NULL, srclen,
 				sess->auth.auth.ctx, sess->auth.auth.evp_algo);
 		break;
 	case OPENSSL_AUTH_AS_HMAC:
-		status = process_openssl_auth_hmac(src, dst,
-				NULL, sess->auth.hmac.pkey, srclen,
+		status = process_openssl_auth_hmac(mbuf_src, digest, offset,
+				sess->auth.hmac.ctx_init, srclen,
 				sess->auth.hmac.ctx, sess->auth.hmac.evp_algo);
 		break;
 	case OPENSSL_AUTH_AS_CIPHER:
 		iv = op->sym->cipher.iv.data;
 		ivlen = op->sym->cipher.iv.length;
 
-		status = process_openssl_auth_gmac(src, dst,
-				iv, sess->auth.cipher.key.data,	srclen, ivlen,
-				sess->auth.cipher.ctx, sess->auth.cipher.evp_algo);
+		status = process_openssl_auth_gmac(mbuf_src, digest, offset,
+				iv, srclen, ivlen, sess->auth.cipher.ctx);
 		break;
 	default:
 		break;
@@ -729,11 +1104,21 @@ process_openssl_auth_op
 		op->status = RTE_CRYPTO_OP_STATUS_SUCCESS;
 
 		if (sess->auth.operation == RTE_CRYPTO_AUTH_OP_VERIFY) {
-			if (memcmp(dst, op->sym->auth.digest.data,
+			if (memcmp(digest, op->sym->auth.digest.data,
 					op->sym->auth.digest.length) != 0) {
 				op->status = RTE_CRYPTO_OP_STATUS_AUTH_FAILED;
 				status = -EINVAL;
 			}
+		} else {
+			/* The digest follows the authenticated data, possibly
+			 * in the tailroom of the last segment
+			 */
+			openssl_sgl_seek(&pos, mbuf_dst, offset + srclen);
+			if (openssl_sgl_copy(&pos, digest,
+					op->sym->auth.digest.length, 1) != 0) {
+				op->status = RTE_CRYPTO_OP_STATUS_ERROR;
+				status = -EINVAL;
+			}
 		}
 	} else
 		op->status = RTE_CRYPTO_OP_STATUS_ERROR;
@@ -741,10 +1126,330 @@ process_openssl_auth_op
 	return status;
 }
 
+/** Fill an ESP IV with random data, its length is a multiple of 8 */
+static inline void
+esp_random_iv(uint8_t *iv, uint16_t iv_len)
+{
+	uint64_t rnd;
+	uint16_t i;
+
+	for (i = 0; i < iv_len; i += sizeof(rnd)) {
+		rnd = rte_rand();
+		memcpy(iv + i, &rnd, sizeof(rnd));
+	}
+}
+
+/** Check a sequence number against the anti-replay window, RFC4303 3.4.3 */
+static inline int
+esp_replay_check(const struct openssl_session *sess, uint32_t seq)
+{
+	uint32_t diff;
+
+	if (sess->ipsec.replay_win_sz == 0)
+		return 0;
+
+	if (seq == 0)
+		return -1;
+
+	if (seq > sess->ipsec.seq)
+		return 0;
+
+	diff = sess->ipsec.seq - seq;
+	if (diff >= sess->ipsec.replay_win_sz ||
+			(sess->ipsec.replay_bitmap & (1ULL << diff)))
+		return -1;
+
+	return 0;
+}
+
+/** Slide the anti-replay window once a packet has been authenticated */
+static inline void
+esp_replay_update(struct openssl_session *sess, uint32_t seq)
+{
+	uint32_t diff;
+
+	if (sess->ipsec.replay_win_sz == 0)
+		return;
+
+	if (seq > sess->ipsec.seq) {
+		diff = seq - sess->ipsec.seq;
+		if (diff < 64)
+			sess->ipsec.replay_bitmap =
+				(sess->ipsec.replay_bitmap << diff) | 1;
+		else
+			sess->ipsec.replay_bitmap = 1;
+		sess->ipsec.seq = seq;
+	} else {
+		diff = sess->ipsec.seq - seq;
+		/* Out of the bitmap, only accepted by a wider window */
+		if (diff < 64)
+			sess->ipsec.replay_bitmap |= 1ULL << diff;
+	}
+}
+
+/** Encapsulate the IP packet of an operation into ESP */
+static int
+process_openssl_esp_egress(struct rte_crypto_op *op,
+		struct openssl_session *sess)
+{
+	struct rte_mbuf *m = op->sym->m_src;
+	struct openssl_esp_hdr *esp;
+	struct ipv4_hdr *ip4;
+	struct ipv6_hdr *ip6;
+	uint8_t digest[EVP_MAX_MD_SIZE];
+	uint8_t *ip, *new_ip, *padding, *iv, *payload;
+	uint32_t payload_len, pad_len, esp_len, enc_len, esp_off, ip_hdr_len;
+	uint8_t version, nlp, tos;
+	uint32_t i;
+
+	if (unlikely(m->nb_segs > 1))
+		return -EINVAL;
+
+	/* No extended sequence numbers, the SA has to be renewed */
+	if (unlikely(sess->ipsec.seq == UINT32_MAX))
+		return -ERANGE;
+
+	ip = rte_pktmbuf_mtod(m, uint8_t *);
+	version = ip[0] >> 4;
+	if (version == 4) {
+		ip4 = (struct ipv4_hdr *)ip;
+		ip_hdr_len = (ip4->version_ihl & IPV4_HDR_IHL_MASK) *
+				IPV4_IHL_MULTIPLIER;
+		nlp = ip4->next_proto_id;
+		tos = ip4->type_of_service;
+	} else if (version == 6) {
+		/* No extension headers supported */
+		ip6 = (struct ipv6_hdr *)ip;
+		ip_hdr_len = sizeof(struct ipv6_hdr);
+		nlp = ip6->proto;
+		tos = rte_be_to_cpu_32(ip6->vtc_flow) >> 20;
+	} else
+		return -EINVAL;
+
+	/* In tunnel mode the whole packet is the payload */
+	if (sess->ipsec.mode == RTE_CRYPTO_IPSEC_MODE_TUNNEL) {
+		nlp = version == 4 ? IPPROTO_IPIP : IPPROTO_IPV6;
+		ip_hdr_len = 0;
+		esp_off = sess->ipsec.hdr_len;
+	} else
+		esp_off = ip_hdr_len;
+
+	payload_len = rte_pktmbuf_pkt_len(m) - ip_hdr_len;
+	pad_len = RTE_ALIGN_CEIL(payload_len + 2, sess->ipsec.block_size) -
+			payload_len;
+	esp_len = sizeof(*esp) + sess->ipsec.iv_len;
+	enc_len = payload_len + pad_len;
+
+	if (unlikely(esp_off + esp_len + enc_len + sess->ipsec.digest_len >
+			UINT16_MAX))
+		return -EMSGSIZE;
+
+	padding = (uint8_t *)rte_pktmbuf_append(m,
+			pad_len + sess->ipsec.digest_len);
+	if (unlikely(padding == NULL))
+		return -ENOSPC;
+
+	new_ip = (uint8_t *)rte_pktmbuf_prepend(m,
+			esp_off - ip_hdr_len + esp_len);
+	if (unlikely(new_ip == NULL)) {
+		rte_pktmbuf_trim(m, pad_len + sess->ipsec.digest_len);
+		return -ENOSPC;
+	}
+
+	/* Default sequential padding, then pad length and next header */
+	for (i = 0; i < pad_len - 2; i++)
+		padding[i] = i + 1;
+	padding[pad_len - 2] = pad_len - 2;
+	padding[pad_len - 1] = nlp;
+
+	if (sess->ipsec.mode == RTE_CRYPTO_IPSEC_MODE_TUNNEL) {
+		memcpy(new_ip, sess->ipsec.hdr, sess->ipsec.hdr_len);
+		if (sess->ipsec.hdr_len == sizeof(struct ipv4_hdr)) {
+			ip4 = (struct ipv4_hdr *)new_ip;
+			ip4->type_of_service = tos;
+			ip4->total_length =
+				rte_cpu_to_be_16(rte_pktmbuf_pkt_len(m));
+			ip4->hdr_checksum = rte_ipv4_cksum(ip4);
+		} else {
+			ip6 = (struct ipv6_hdr *)new_ip;
+			ip6->vtc_flow = rte_cpu_to_be_32(6 << 28 | tos << 20);
+			ip6->payload_len = rte_cpu_to_be_16(
+				rte_pktmbuf_pkt_len(m) -
+				sizeof(struct ipv6_hdr));
+		}
+	} else {
+		memmove(new_ip, ip, ip_hdr_len);
+		if (version == 4) {
+			ip4 = (struct ipv4_hdr *)new_ip;
+			ip4->next_proto_id = IPPROTO_ESP;
+			ip4->total_length =
+				rte_cpu_to_be_16(rte_pktmbuf_pkt_len(m));
+			ip4->hdr_checksum = 0;
+			ip4->hdr_checksum = rte_ipv4_cksum(ip4);
+		} else {
+			ip6 = (struct ipv6_hdr *)new_ip;
+			ip6->proto = IPPROTO_ESP;
+			ip6->payload_len = rte_cpu_to_be_16(
+				rte_pktmbuf_pkt_len(m) -
+				sizeof(struct ipv6_hdr));
+		}
+	}
+
+	esp = (struct openssl_esp_hdr *)(new_ip + esp_off);
+	esp->spi = rte_cpu_to_be_32(sess->ipsec.spi);
+	esp->seq = rte_cpu_to_be_32(++sess->ipsec.seq);
+
+	iv = (uint8_t *)(esp + 1);
+	esp_random_iv(iv, sess->ipsec.iv_len);
+
+	payload = iv + sess->ipsec.iv_len;
+	if (process_openssl_cipher_encrypt(payload, payload, iv, enc_len,
+			sess->cipher.ctx))
+		return -EINVAL;
+
+	if (process_openssl_auth_hmac(m, digest, esp_off,
+			sess->auth.hmac.ctx_init, esp_len + enc_len,
+			sess->auth.hmac.ctx, sess->auth.hmac.evp_algo))
+		return -EINVAL;
+
+	memcpy(payload + enc_len, digest, sess->ipsec.digest_len);
+
+	return 0;
+}
+
+/** Check and decapsulate the ESP packet of an operation */
+static int
+process_openssl_esp_ingress(struct rte_crypto_op *op,
+		struct openssl_session *sess)
+{
+	struct rte_mbuf *m = op->sym->m_src;
+	struct openssl_esp_hdr *esp;
+	struct ipv4_hdr *ip4;
+	struct ipv6_hdr *ip6;
+	uint8_t digest[EVP_MAX_MD_SIZE];
+	uint8_t *ip, *new_ip, *iv, *payload;
+	uint32_t esp_len, enc_len, ip_hdr_len, seq;
+	uint8_t version, proto, nlp, pad_len;
+	uint32_t i;
+
+	if (unlikely(m->nb_segs > 1))
+		return -EINVAL;
+
+	ip = rte_pktmbuf_mtod(m, uint8_t *);
+	version = ip[0] >> 4;
+	if (version == 4) {
+		ip4 = (struct ipv4_hdr *)ip;
+		ip_hdr_len = (ip4->version_ihl & IPV4_HDR_IHL_MASK) *
+				IPV4_IHL_MULTIPLIER;
+		proto = ip4->next_proto_id;
+	} else if (version == 6) {
+		/* No extension headers supported */
+		ip6 = (struct ipv6_hdr *)ip;
+		ip_hdr_len = sizeof(struct ipv6_hdr);
+		proto = ip6->proto;
+	} else
+		return -EINVAL;
+
+	esp_len = sizeof(*esp) + sess->ipsec.iv_len;
+	if (unlikely(proto != IPPROTO_ESP || rte_pktmbuf_pkt_len(m) <=
+			ip_hdr_len + esp_len + sess->ipsec.digest_len))
+		return -EINVAL;
+
+	enc_len = rte_pktmbuf_pkt_len(m) - ip_hdr_len - esp_len -
+			sess->ipsec.digest_len;
+	if (unlikely(enc_len & (sess->ipsec.block_size - 1)))
+		return -EINVAL;
+
+	esp = (struct openssl_esp_hdr *)(ip + ip_hdr_len);
+	seq = rte_be_to_cpu_32(esp->seq);
+	if (unlikely(rte_be_to_cpu_32(esp->spi) != sess->ipsec.spi ||
+			esp_replay_check(sess, seq) != 0))
+		return -EINVAL;
+
+	iv = (uint8_t *)(esp + 1);
+	payload = iv + sess->ipsec.iv_len;
+
+	/* Integrity first, the window only moves for genuine packets */
+	if (process_openssl_auth_hmac(m, digest, ip_hdr_len,
+			sess->auth.hmac.ctx_init, esp_len + enc_len,
+			sess->auth.hmac.ctx, sess->auth.hmac.evp_algo))
+		return -EINVAL;
+
+	if (CRYPTO_memcmp(digest, payload + enc_len,
+			sess->ipsec.digest_len) != 0)
+		return -EBADMSG;
+
+	if (process_openssl_cipher_decrypt(payload, payload, iv, enc_len,
+			sess->cipher.ctx))
+		return -EINVAL;
+
+	nlp = payload[enc_len - 1];
+	pad_len = payload[enc_len - 2];
+	if (unlikely(pad_len + 2U > enc_len))
+		return -EINVAL;
+
+	for (i = 0; i < pad_len; i++)
+		if (unlikely(payload[enc_len - 2 - pad_len + i] != i + 1))
+			return -EINVAL;
+
+	esp_replay_update(sess, seq);
+
+	rte_pktmbuf_trim(m, pad_len + 2 + sess->ipsec.digest_len);
+
+	if (sess->ipsec.mode == RTE_CRYPTO_IPSEC_MODE_TUNNEL) {
+		if (unlikely(nlp != IPPROTO_IPIP && nlp != IPPROTO_IPV6))
+			return -EINVAL;
+		rte_pktmbuf_adj(m, ip_hdr_len + esp_len);
+		return 0;
+	}
+
+	new_ip = (uint8_t *)rte_pktmbuf_adj(m, esp_len);
+	memmove(new_ip, ip, ip_hdr_len);
+	if (version == 4) {
+		ip4 = (struct ipv4_hdr *)new_ip;
+		ip4->next_proto_id = nlp;
+		ip4->total_length = rte_cpu_to_be_16(rte_pktmbuf_pkt_len(m));
+		ip4->hdr_checksum = 0;
+		ip4->hdr_checksum = rte_ipv4_cksum(ip4);
+	} else {
+		ip6 = (struct ipv6_hdr *)new_ip;
+		ip6->proto = nlp;
+		ip6->payload_len = rte_cpu_to_be_16(rte_pktmbuf_pkt_len(m) -
+				sizeof(struct ipv6_hdr));
+	}
+
+	return 0;
+}
+
+/**
+ * Process an IPsec protocol operation. The operation always completes,
+ * with its status telling whether the packet has to be dropped.
+ */
+static int
+process_openssl_esp_op(struct rte_crypto_op *op,
+		struct openssl_session *sess)
+{
+	int status;
+
+	if (sess->ipsec.direction == RTE_CRYPTO_IPSEC_DIR_EGRESS)
+		status = process_openssl_esp_egress(op, sess);
+	else
+		status = process_openssl_esp_ingress(op, sess);
+
+	if (likely(status == 0))
+		op->status = RTE_CRYPTO_OP_STATUS_SUCCESS;
+	else if (status == -EBADMSG)
+		op->status = RTE_CRYPTO_OP_STATUS_AUTH_FAILED;
+	else
+		op->status = RTE_CRYPTO_OP_STATUS_ERROR;
+
+	return 0;
+}
+
 /** Process crypto operation for mbuf */
 static int
 process_op(const struct openssl_qp *qp, struct rte_crypto_op *op,
-		struct openssl_session *sess)
+		struct openssl_session *sess, uint32_t cache_slot)
 {
 	struct rte_mbuf *msrc, *mdst;
 	int status;
@@ -769,23 +1474,94 @@ process_op(const struct openssl_qp *qp, struct rte_crypto_op *op,
 		if (status == 0)
 			status = process_openssl_cipher_op(op, sess, msrc, mdst);
 		break;
+	case OPENSSL_CHAIN_IPSEC_ESP:
+		status = process_openssl_esp_op(op, sess);
+		break;
 	default:
 		status = -1;
 		break;
 	}
 
-	/* Free session if a session-less crypto op */
+	/* Free session if a session-less crypto op, unless it is cached */
 	if (op->sym->sess_type == RTE_CRYPTO_SYM_OP_SESSIONLESS) {
-		openssl_reset_session(sess);
-		memset(sess, 0, sizeof(struct openssl_session));
-		rte_mempool_put(qp->sess_mp, op->sym->session);
+		if (cache_slot != UINT32_MAX)
+			rte_cryptodev_sym_session_cache_put(qp->sess_cache,
+					cache_slot);
+		else {
+			openssl_reset_session(sess);
+			memset(sess, 0, sizeof(struct openssl_session));
+			openssl_put_sessionless(qp, op, op->sym->session);
+		}
 		op->sym->session = NULL;
 	}
 
-	if (status != 0)
-		return -1;
+	return status;
+}
+
+/**
+ * Process a burst of operations, stopping at the first failing one unless
+ * all operations have to be handed back, as the worker lcore does.
+ * Returns the number of operations processed successfully.
+ */
+static uint16_t
+process_ops(struct openssl_qp *qp, struct rte_crypto_op **ops,
+		uint16_t nb_ops, int stop_on_error)
+{
+	struct openssl_session *sess;
+	uint32_t cache_slot;
+	uint16_t i, nb_ok = 0;
+	int status;
 
-	return rte_ring_enqueue(qp->processed_ops, (void *)op);
+	for (i = 0; i < nb_ops; i++) {
+		cache_slot = UINT32_MAX;
+		sess = get_session(qp, ops[i], &cache_slot);
+		if (unlikely(sess == NULL))
+			status = -1;
+		else
+			status = process_op(qp, ops[i], sess, cache_slot);
+
+		if (likely(status == 0))
+			nb_ok++;
+		else if (stop_on_error)
+			break;
+	}
+
+	return nb_ok;
+}
+
+/** Worker lcore loop, serving the queue pairs of one device */
+int
+openssl_pmd_worker(void *arg)
+{
+	struct rte_cryptodev *dev = arg;
+	struct openssl_private *internals = dev->data->dev_private;
+	struct rte_crypto_op *ops[OPENSSL_WORKER_BURST_SIZE];
+	struct openssl_qp *qp;
+	unsigned int nb_ops;
+	uint16_t qp_id;
+
+	while (!internals->worker_stop) {
+		for (qp_id = 0; qp_id < dev->data->nb_queue_pairs; qp_id++) {
+			qp = dev->data->queue_pairs[qp_id];
+			if (qp == NULL || qp->pending_ops == NULL)
+				continue;
+
+			/* Only take what can be handed back at once */
+			nb_ops = RTE_MIN(rte_ring_free_count(qp->processed_ops),
+					(unsigned int)OPENSSL_WORKER_BURST_SIZE);
+			nb_ops = rte_ring_dequeue_burst(qp->pending_ops,
+					(void **)ops, nb_ops);
+			if (nb_ops == 0)
+				continue;
+
+			/* Failed operations carry their status back */
+			process_ops(qp, ops, nb_ops, 0);
+			rte_ring_enqueue_burst(qp->processed_ops,
+					(void **)ops, nb_ops);
+		}
+	}
+
+	return 0;
 }
 
 /*
@@ -799,26 +1575,30 @@ static uint16_t
 openssl_pmd_enqueue_burst(void *queue_pair, struct rte_crypto_op **ops,
 		uint16_t nb_ops)
 {
-	struct openssl_session *sess;
 	struct openssl_qp *qp = queue_pair;
-	int i, retval;
-
-	for (i = 0; i < nb_ops; i++) {
-		sess = get_session(qp, ops[i]);
-		if (unlikely(sess == NULL))
-			goto enqueue_err;
-
-		retval = process_op(qp, ops[i], sess);
-		if (unlikely(retval < 0))
-			goto enqueue_err;
+	unsigned int nb_free;
+	uint16_t nb_enqd;
+
+	/* Hand the burst over to the worker lcore */
+	if (qp->pending_ops != NULL) {
+		nb_enqd = rte_ring_enqueue_burst(qp->pending_ops,
+				(void **)ops, nb_ops);
+		goto enqueue_done;
 	}
 
-	qp->stats.enqueued_count += i;
-	return i;
+	/* Never process more than the processed ring can take */
+	nb_free = rte_ring_free_count(qp->processed_ops);
+	if (unlikely(nb_ops > nb_free))
+		nb_ops = nb_free;
 
-enqueue_err:
-	qp->stats.enqueue_err_count++;
-	return i;
+	nb_enqd = process_ops(qp, ops, nb_ops, 1);
+	rte_ring_enqueue_burst(qp->processed_ops, (void **)ops, nb_enqd);
+
+enqueue_done:
+	qp->stats.enqueued_count += nb_enqd;
+	if (unlikely(nb_enqd < nb_ops))
+		qp->stats.enqueue_err_count++;
+	return nb_enqd;
 }
 
 /** Dequeue burst */
@@ -837,10 +1617,99 @@ openssl_pmd_dequeue_burst(void *queue_pair, struct rte_crypto_op **ops,
 	return nb_dequeued;
 }
 
+/** Parse integer from integer argument */
+static int
+parse_integer_arg(const char *key __rte_unused,
+		const char *value, void *extra_args)
+{
+	int *i = (int *) extra_args;
+
+	*i = atoi(value);
+	if (*i < 0) {
+		OPENSSL_LOG_ERR("Argument has to be positive.");
+		return -1;
+	}
+
+	return 0;
+}
+
+/** Parse socket identifier argument */
+static int
+parse_socket_id_arg(const char *key __rte_unused,
+		const char *value, void *extra_args)
+{
+	uint8_t *socket_id = extra_args;
+	int i = atoi(value);
+
+	if (i < 0 || i >= RTE_MAX_NUMA_NODES) {
+		OPENSSL_LOG_ERR("Invalid socket id %s", value);
+		return -1;
+	}
+
+	*socket_id = (uint8_t)i;
+	return 0;
+}
+
+/** Parse worker lcore argument, it has to be an enabled slave lcore */
+static int
+parse_worker_lcore_arg(const char *key __rte_unused,
+		const char *value, void *extra_args)
+{
+	int *lcore = extra_args;
+	int i = atoi(value);
+
+	if (i < 0 || i >= RTE_MAX_LCORE || !rte_lcore_is_enabled(i) ||
+			(unsigned int)i == rte_get_master_lcore()) {
+		OPENSSL_LOG_ERR("Invalid worker lcore %s", value);
+		return -1;
+	}
+
+	*lcore = i;
+	return 0;
+}
+
+/** Parse OPENSSL device arguments */
+static int
+openssl_parse_init_params(struct openssl_init_params *params,
+		const char *input_args)
+{
+	struct rte_kvargs *kvlist;
+	int ret;
+
+	if (input_args == NULL)
+		return 0;
+
+	kvlist = rte_kvargs_parse(input_args, openssl_valid_params);
+	if (kvlist == NULL)
+		return -1;
+
+	ret = rte_kvargs_process(kvlist, OPENSSL_MAX_NB_QP_ARG,
+			&parse_integer_arg, &params->def_p.max_nb_queue_pairs);
+	if (ret < 0)
+		goto free_kvlist;
+
+	ret = rte_kvargs_process(kvlist, OPENSSL_MAX_NB_SESS_ARG,
+			&parse_integer_arg, &params->def_p.max_nb_sessions);
+	if (ret < 0)
+		goto free_kvlist;
+
+	ret = rte_kvargs_process(kvlist, OPENSSL_SOCKET_ID_ARG,
+			&parse_socket_id_arg, &params->def_p.socket_id);
+	if (ret < 0)
+		goto free_kvlist;
+
+	ret = rte_kvargs_process(kvlist, OPENSSL_WORKER_LCORE_ARG,
+			&parse_worker_lcore_arg, &params->worker_lcore);
+
+free_kvlist:
+	rte_kvargs_free(kvlist);
+	return ret;
+}
+
 /** Create OPENSSL crypto device */
 static int
 cryptodev_openssl_create(const char *name,
-		struct rte_crypto_vdev_init_params *init_params)
+		struct openssl_init_params *init_params)
 {
 	struct rte_cryptodev *dev;
 	char crypto_dev_name[RTE_CRYPTODEV_NAME_MAX_LEN];
@@ -854,7 +1723,8 @@ cryptodev_openssl_create(const char *name,
 	}
 
 	dev = rte_cryptodev_pmd_virtual_dev_init(crypto_dev_name,
-			sizeof(struct openssl_private), init_params->socket_id);
+			sizeof(struct openssl_private),
+			init_params->def_p.socket_id);
 	if (dev == NULL) {
 		OPENSSL_LOG_ERR("failed to create cryptodev vdev");
 		goto init_error;
@@ -869,13 +1739,16 @@ cryptodev_openssl_create(const char *name,
 
 	dev->feature_flags = RTE_CRYPTODEV_FF_SYMMETRIC_CRYPTO |
 			RTE_CRYPTODEV_FF_SYM_OPERATION_CHAINING |
-			RTE_CRYPTODEV_FF_CPU_AESNI;
+			RTE_CRYPTODEV_FF_CPU_AESNI |
+			RTE_CRYPTODEV_FF_IPSEC_PROTO_OFFLOAD |
+			RTE_CRYPTODEV_FF_MBUF_SCATTER_GATHER;
 
 	/* Set vector instructions mode supported */
 	internals = dev->data->dev_private;
 
-	internals->max_nb_qpairs = init_params->max_nb_queue_pairs;
-	internals->max_nb_sessions = init_params->max_nb_sessions;
+	internals->max_nb_qpairs = init_params->def_p.max_nb_queue_pairs;
+	internals->max_nb_sessions = init_params->def_p.max_nb_sessions;
+	internals->worker_lcore = init_params->worker_lcore;
 
 	return 0;
 
@@ -891,20 +1764,30 @@ static int
 cryptodev_openssl_init(const char *name,
 		const char *input_args)
 {
-	struct rte_crypto_vdev_init_params init_params = {
-		RTE_CRYPTODEV_VDEV_DEFAULT_MAX_NB_QUEUE_PAIRS,
-		RTE_CRYPTODEV_VDEV_DEFAULT_MAX_NB_SESSIONS,
-		rte_socket_id()
+	struct openssl_init_params init_params = {
+		.def_p = {
+			RTE_CRYPTODEV_VDEV_DEFAULT_MAX_NB_QUEUE_PAIRS,
+			RTE_CRYPTODEV_VDEV_DEFAULT_MAX_NB_SESSIONS,
+			rte_socket_id()
+		},
+		.worker_lcore = -1
 	};
 
-	rte_cryptodev_parse_vdev_init_params(&init_params, input_args);
+	if (openssl_parse_init_params(&init_params, input_args) < 0) {
+		OPENSSL_LOG_ERR("failed to parse device arguments %s",
+				input_args);
+		return -EINVAL;
+	}
 
 	RTE_LOG(INFO, PMD, "Initialising %s on NUMA node %d\n", name,
-			init_params.socket_id);
+			init_params.def_p.socket_id);
 	RTE_LOG(INFO, PMD, "  Max number of queue pairs = %d\n",
-			init_params.max_nb_queue_pairs);
+			init_params.def_p.max_nb_queue_pairs);
 	RTE_LOG(INFO, PMD, "  Max number of sessions = %d\n",
-			init_params.max_nb_sessions);
+			init_params.def_p.max_nb_sessions);
+	if (init_params.worker_lcore >= 0)
+		RTE_LOG(INFO, PMD, "  Worker lcore = %d\n",
+				init_params.worker_lcore);
 
 	return cryptodev_openssl_create(name, &init_params);
 }
@@ -933,4 +1816,5 @@ PMD_REGISTER_DRIVER(cryptodev_openssl_pmd_drv, CRYPTODEV_NAME_OPENSSL_PMD);
 DRIVER_REGISTER_PARAM_STRING(CRYPTODEV_NAME_OPENSSL_PMD,
 	"max_nb_queue_pairs=<int> "
 	"max_nb_sessions=<int> "
-	"socket_id=<int>");
+	"socket_id=<int> "
+	"worker_lcore=<int>");
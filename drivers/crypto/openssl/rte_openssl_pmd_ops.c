@@ -34,6 +34,8 @@
 
 #include <rte_common.h>
 #include <rte_malloc.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
 #include <rte_cryptodev_pmd.h>
 
 #include "rte_openssl_pmd_private.h"
@@ -386,15 +388,34 @@ openssl_pmd_config(__rte_unused struct rte_cryptodev *dev)
 
 /** Start device */
 static int
-openssl_pmd_start(__rte_unused struct rte_cryptodev *dev)
+openssl_pmd_start(struct rte_cryptodev *dev)
 {
+	struct openssl_private *internals = dev->data->dev_private;
+	unsigned int lcore = internals->worker_lcore;
+
+	if (internals->worker_lcore < 0)
+		return 0;
+
+	internals->worker_stop = 0;
+	if (rte_eal_remote_launch(openssl_pmd_worker, dev, lcore) != 0) {
+		OPENSSL_LOG_ERR("worker lcore %u is busy", lcore);
+		return -EBUSY;
+	}
+
 	return 0;
 }
 
 /** Stop device */
 static void
-openssl_pmd_stop(__rte_unused struct rte_cryptodev *dev)
+openssl_pmd_stop(struct rte_cryptodev *dev)
 {
+	struct openssl_private *internals = dev->data->dev_private;
+
+	if (internals->worker_lcore < 0)
+		return;
+
+	internals->worker_stop = 1;
+	rte_eal_wait_lcore(internals->worker_lcore);
 }
 
 /** Close device */
@@ -436,6 +457,73 @@ openssl_pmd_stats_reset(struct rte_cryptodev *dev)
 	}
 }
 
+/** Per queue pair statistics reported as extended statistics */
+static const struct {
+	const char *name;
+	unsigned offset;
+} openssl_qp_xstats[] = {
+	{"enqueued", offsetof(struct rte_cryptodev_stats, enqueued_count)},
+	{"dequeued", offsetof(struct rte_cryptodev_stats, dequeued_count)},
+	{"enqueue_errors", offsetof(struct rte_cryptodev_stats,
+		enqueue_err_count)},
+	{"dequeue_errors", offsetof(struct rte_cryptodev_stats,
+		dequeue_err_count)},
+};
+
+/* per queue pair counters, then the pending and processed occupancies */
+#define OPENSSL_NB_QP_XSTATS (RTE_DIM(openssl_qp_xstats) + 2)
+
+/** Get names of device extended statistics */
+static int
+openssl_pmd_xstats_get_names(struct rte_cryptodev *dev,
+		struct rte_cryptodev_xstat_name *xstats_names, unsigned size)
+{
+	unsigned count = dev->data->nb_queue_pairs * OPENSSL_NB_QP_XSTATS;
+	unsigned qp_id, i, n = 0;
+
+	if (xstats_names == NULL || size < count)
+		return count;
+
+	for (qp_id = 0; qp_id < dev->data->nb_queue_pairs; qp_id++) {
+		for (i = 0; i < RTE_DIM(openssl_qp_xstats); i++)
+			snprintf(xstats_names[n++].name,
+				sizeof(xstats_names[0].name), "qp%u_%s",
+				qp_id, openssl_qp_xstats[i].name);
+		snprintf(xstats_names[n++].name, sizeof(xstats_names[0].name),
+			"qp%u_pending_occupancy", qp_id);
+		snprintf(xstats_names[n++].name, sizeof(xstats_names[0].name),
+			"qp%u_ring_occupancy", qp_id);
+	}
+
+	return count;
+}
+
+/** Get device extended statistics */
+static int
+openssl_pmd_xstats_get(struct rte_cryptodev *dev,
+		struct rte_cryptodev_xstat *xstats, unsigned n)
+{
+	unsigned count = dev->data->nb_queue_pairs * OPENSSL_NB_QP_XSTATS;
+	unsigned qp_id, i, idx = 0;
+
+	if (xstats == NULL || n < count)
+		return count;
+
+	for (qp_id = 0; qp_id < dev->data->nb_queue_pairs; qp_id++) {
+		struct openssl_qp *qp = dev->data->queue_pairs[qp_id];
+
+		for (i = 0; i < RTE_DIM(openssl_qp_xstats); i++)
+			xstats[idx++].value = *(uint64_t *)RTE_PTR_ADD(
+					&qp->stats, openssl_qp_xstats[i].offset);
+		/* ops waiting for the worker lcore, if there is one */
+		xstats[idx++].value = qp->pending_ops != NULL ?
+				rte_ring_count(qp->pending_ops) : 0;
+		xstats[idx++].value = rte_ring_count(qp->processed_ops);
+	}
+
+	return count;
+}
+
 
 /** Get device info */
 static void
@@ -457,8 +545,11 @@ openssl_pmd_info_get(struct rte_cryptodev *dev,
 static int
 openssl_pmd_qp_release(struct rte_cryptodev *dev, uint16_t qp_id)
 {
-	if (dev->data->queue_pairs[qp_id] != NULL) {
-		rte_free(dev->data->queue_pairs[qp_id]);
+	struct openssl_qp *qp = dev->data->queue_pairs[qp_id];
+
+	if (qp != NULL) {
+		rte_cryptodev_sym_session_cache_free(qp->sess_cache);
+		rte_free(qp);
 		dev->data->queue_pairs[qp_id] = NULL;
 	}
 	return 0;
@@ -480,29 +571,27 @@ openssl_pmd_qp_set_unique_name(struct rte_cryptodev *dev,
 }
 
 
-/** Create a ring to place processed operations on */
+/** Create a ring to place processed or pending operations on */
 static struct rte_ring *
-openssl_pmd_qp_create_processed_ops_ring(struct openssl_qp *qp,
+openssl_pmd_qp_create_ops_ring(const char *name,
 		unsigned int ring_size, int socket_id)
 {
 	struct rte_ring *r;
 
-	r = rte_ring_lookup(qp->name);
+	r = rte_ring_lookup(name);
 	if (r) {
 		if (r->prod.size >= ring_size) {
 			OPENSSL_LOG_INFO(
-				"Reusing existing ring %s for processed ops",
-				 qp->name);
+				"Reusing existing ring %s for ops", name);
 			return r;
 		}
 
 		OPENSSL_LOG_ERR(
-			"Unable to reuse existing ring %s for processed ops",
-			 qp->name);
+			"Unable to reuse existing ring %s for ops", name);
 		return NULL;
 	}
 
-	return rte_ring_create(qp->name, ring_size, socket_id,
+	return rte_ring_create(name, ring_size, socket_id,
 			RING_F_SP_ENQ | RING_F_SC_DEQ);
 }
 
@@ -513,7 +602,9 @@ openssl_pmd_qp_setup(struct rte_cryptodev *dev, uint16_t qp_id,
 		const struct rte_cryptodev_qp_conf *qp_conf,
 		 int socket_id)
 {
+	struct openssl_private *internals = dev->data->dev_private;
 	struct openssl_qp *qp = NULL;
+	char ring_name[RTE_RING_NAMESIZE];
 
 	/* Free memory prior to re-allocation if needed. */
 	if (dev->data->queue_pairs[qp_id] != NULL)
@@ -531,20 +622,41 @@ openssl_pmd_qp_setup(struct rte_cryptodev *dev, uint16_t qp_id,
 	if (openssl_pmd_qp_set_unique_name(dev, qp))
 		goto qp_setup_cleanup;
 
-	qp->processed_ops = openssl_pmd_qp_create_processed_ops_ring(qp,
+	qp->processed_ops = openssl_pmd_qp_create_ops_ring(qp->name,
 			qp_conf->nb_descriptors, socket_id);
 	if (qp->processed_ops == NULL)
 		goto qp_setup_cleanup;
 
+	/* Operations wait here for the worker lcore, if there is one */
+	if (internals->worker_lcore >= 0) {
+		if (snprintf(ring_name, sizeof(ring_name), "%s_w", qp->name)
+				>= (int)sizeof(ring_name))
+			goto qp_setup_cleanup;
+		qp->pending_ops = openssl_pmd_qp_create_ops_ring(ring_name,
+				qp_conf->nb_descriptors, socket_id);
+		if (qp->pending_ops == NULL)
+			goto qp_setup_cleanup;
+	}
+
 	qp->sess_mp = dev->data->session_pool;
 
+#if RTE_CRYPTODEV_SYM_SESSION_CACHE_SIZE > 0
+	qp->sess_cache = rte_cryptodev_sym_session_cache_create(
+			dev->data->dev_id, RTE_CRYPTODEV_SYM_SESSION_CACHE_SIZE,
+			socket_id);
+	if (qp->sess_cache == NULL)
+		goto qp_setup_cleanup;
+#endif
+
 	memset(&qp->stats, 0, sizeof(qp->stats));
 
 	return 0;
 
 qp_setup_cleanup:
-	if (qp)
+	if (qp) {
+		dev->data->queue_pairs[qp_id] = NULL;
 		rte_free(qp);
+	}
 
 	return -1;
 }
@@ -579,6 +691,13 @@ openssl_pmd_session_get_size(struct rte_cryptodev *dev __rte_unused)
 	return sizeof(struct openssl_session);
 }
 
+/** Returns the size of the session-less session kept in each op */
+static unsigned
+openssl_pmd_op_priv_get_size(struct rte_cryptodev *dev __rte_unused)
+{
+	return OPENSSL_OP_PRIV_SIZE;
+}
+
 /** Configure the session from a crypto xform chain */
 static void *
 openssl_pmd_session_configure(struct rte_cryptodev *dev __rte_unused,
@@ -621,6 +740,8 @@ struct rte_cryptodev_ops openssl_pmd_ops = {
 
 		.stats_get		= openssl_pmd_stats_get,
 		.stats_reset		= openssl_pmd_stats_reset,
+		.xstats_get		= openssl_pmd_xstats_get,
+		.xstats_get_names	= openssl_pmd_xstats_get_names,
 
 		.dev_infos_get		= openssl_pmd_info_get,
 
@@ -632,7 +753,8 @@ struct rte_cryptodev_ops openssl_pmd_ops = {
 
 		.session_get_size	= openssl_pmd_session_get_size,
 		.session_configure	= openssl_pmd_session_configure,
-		.session_clear		= openssl_pmd_session_clear
+		.session_clear		= openssl_pmd_session_clear,
+		.op_priv_get_size	= openssl_pmd_op_priv_get_size
 };
 
 struct rte_cryptodev_ops *rte_openssl_pmd_ops = &openssl_pmd_ops;
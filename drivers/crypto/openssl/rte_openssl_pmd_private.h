@@ -64,6 +64,7 @@ enum openssl_chain_order {
 	OPENSSL_CHAIN_ONLY_AUTH,
 	OPENSSL_CHAIN_CIPHER_AUTH,
 	OPENSSL_CHAIN_AUTH_CIPHER,
+	OPENSSL_CHAIN_IPSEC_ESP,
 	OPENSSL_CHAIN_NOT_SUPPORTED
 };
 
@@ -81,12 +82,19 @@ enum openssl_auth_mode {
 	OPENSSL_AUTH_NULL
 };
 
+/** Max number of operations the worker lcore takes from a queue pair */
+#define OPENSSL_WORKER_BURST_SIZE	32
+
 /** private data structure for each OPENSSL crypto device */
 struct openssl_private {
 	unsigned int max_nb_qpairs;
 	/**< Max number of queue pairs */
 	unsigned int max_nb_sessions;
 	/**< Max number of sessions */
+	int worker_lcore;
+	/**< lcore processing the queue pairs, -1 to process on enqueue */
+	volatile int worker_stop;
+	/**< Set to request the worker lcore to return */
 };
 
 /** OPENSSL crypto queue pair */
@@ -97,12 +105,30 @@ struct openssl_qp {
 	/**< Unique Queue Pair Name */
 	struct rte_ring *processed_ops;
 	/**< Ring for placing process packets */
+	struct rte_ring *pending_ops;
+	/**< Ring of operations waiting for the worker lcore, if any */
 	struct rte_mempool *sess_mp;
 	/**< Session Mempool */
+	struct rte_cryptodev_sym_session_cache *sess_cache;
+	/**< Sessions of session-less operations */
 	struct rte_cryptodev_stats stats;
 	/**< Queue pair statistics */
 } __rte_cache_aligned;
 
+/** ESP header, RFC4303 */
+struct openssl_esp_hdr {
+	uint32_t spi;
+	/**< Security Parameters Index, big endian */
+	uint32_t seq;
+	/**< Sequence number, big endian */
+} __attribute__((__packed__));
+
+/** Largest outer header of an ESP tunnel, an IPv6 header */
+#define OPENSSL_IPSEC_MAX_HDR_LEN	40
+
+/** TTL or hop limit of the outer header when the xform gives none */
+#define OPENSSL_IPSEC_DEF_TTL		64
+
 /** OPENSSL crypto private session structure */
 struct openssl_session {
 	enum openssl_chain_order chain_order;
@@ -155,6 +181,8 @@ struct openssl_session {
 				/**< pointer to EVP algorithm function */
 				EVP_MD_CTX *ctx;
 				/**< pointer to EVP context structure */
+				EVP_MD_CTX *ctx_init;
+				/**< context keyed once, copied into ctx per op */
 			} hmac;
 
 			struct {
@@ -172,8 +200,41 @@ struct openssl_session {
 		};
 	} auth;
 
+	/**
+	 * IPsec Parameters, for sessions headed by an IPsec xform, which
+	 * have the OPENSSL_CHAIN_IPSEC_ESP chain order.
+	 */
+	struct {
+		enum rte_crypto_ipsec_mode mode;
+		/**< Transport or tunnel mode */
+		enum rte_crypto_ipsec_direction direction;
+		/**< Egress or ingress SA */
+		uint32_t spi;
+		/**< Security Parameters Index */
+		uint32_t seq;
+		/**< Last sequence number sent or highest one received */
+		uint64_t replay_bitmap;
+		/**< Bit n set once seq - n has been received */
+		uint32_t replay_win_sz;
+		/**< Anti-replay window size, 0 if disabled */
+		uint16_t iv_len;
+		/**< IV length in bytes */
+		uint16_t block_size;
+		/**< Cipher block size the payload is padded to */
+		uint16_t digest_len;
+		/**< ICV length in bytes */
+		uint16_t hdr_len;
+		/**< Length of the outer tunnel header, 0 in transport mode */
+		uint8_t hdr[OPENSSL_IPSEC_MAX_HDR_LEN];
+		/**< Outer tunnel header template */
+	} ipsec;
+
 } __rte_cache_aligned;
 
+/** Size of the session-less session a crypto op can carry for the PMD */
+#define OPENSSL_OP_PRIV_SIZE	(sizeof(struct rte_cryptodev_sym_session) + \
+		sizeof(struct openssl_session))
+
 /** Set and validate OPENSSL crypto session parameters */
 extern int
 openssl_set_session_parameters(struct openssl_session *sess,
@@ -183,6 +244,10 @@ openssl_set_session_parameters(struct openssl_session *sess,
 extern void
 openssl_reset_session(struct openssl_session *sess);
 
+/** Process the operations queued on a device's queue pairs */
+extern int
+openssl_pmd_worker(void *arg);
+
 /** device specific operations function pointer structure */
 extern struct rte_cryptodev_ops *rte_openssl_pmd_ops;
 
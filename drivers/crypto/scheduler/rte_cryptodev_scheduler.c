@@ -0,0 +1,248 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 Freescale Semiconductor, Inc. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of  Freescale Semiconductor, Inc nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_cryptodev_pmd.h>
+
+#include "rte_cryptodev_scheduler.h"
+#include "scheduler_pmd_private.h"
+
+/** Get a scheduler device, NULL if the identifier is not a scheduler */
+static struct rte_cryptodev *
+scheduler_get_dev(uint8_t scheduler_id)
+{
+	struct rte_cryptodev *dev;
+
+	if (!rte_cryptodev_pmd_is_valid_dev(scheduler_id)) {
+		SCHEDULER_LOG_ERR("Invalid dev_id=%u", scheduler_id);
+		return NULL;
+	}
+
+	dev = rte_cryptodev_pmd_get_dev(scheduler_id);
+	if (dev->dev_type != RTE_CRYPTODEV_SCHEDULER_PMD) {
+		SCHEDULER_LOG_ERR("dev_id=%u is not a scheduler", scheduler_id);
+		return NULL;
+	}
+
+	return dev;
+}
+
+/**
+ * Check that the slaves of a scheduler can be changed: the sessions hold a
+ * session per slave, so none must be in use.
+ */
+static int
+scheduler_slaves_check_busy(struct rte_cryptodev *dev)
+{
+	if (dev->data->dev_started) {
+		SCHEDULER_LOG_ERR("dev_id=%u must be stopped",
+				dev->data->dev_id);
+		return -EBUSY;
+	}
+
+	if (dev->data->session_pool != NULL &&
+			!rte_mempool_full(dev->data->session_pool)) {
+		SCHEDULER_LOG_ERR("dev_id=%u has sessions in use",
+				dev->data->dev_id);
+		return -EBUSY;
+	}
+
+	return 0;
+}
+
+int
+rte_cryptodev_scheduler_slave_attach(uint8_t scheduler_id, uint8_t slave_id)
+{
+	struct rte_cryptodev *dev = scheduler_get_dev(scheduler_id);
+	struct scheduler_private *internals;
+	unsigned i;
+	int ret;
+
+	if (dev == NULL)
+		return -EINVAL;
+
+	if (!rte_cryptodev_pmd_is_valid_dev(slave_id) ||
+			slave_id == scheduler_id) {
+		SCHEDULER_LOG_ERR("Invalid slave dev_id=%u", slave_id);
+		return -EINVAL;
+	}
+
+	ret = scheduler_slaves_check_busy(dev);
+	if (ret < 0)
+		return ret;
+
+	internals = dev->data->dev_private;
+
+	for (i = 0; i < internals->nb_slaves; i++) {
+		if (internals->slaves[i] == slave_id) {
+			SCHEDULER_LOG_ERR("Slave dev_id=%u already attached",
+					slave_id);
+			return -EINVAL;
+		}
+	}
+
+	if (internals->nb_slaves == RTE_CRYPTODEV_SCHEDULER_MAX_NB_SLAVES) {
+		SCHEDULER_LOG_ERR("Too many slaves, %u at most",
+				RTE_CRYPTODEV_SCHEDULER_MAX_NB_SLAVES);
+		return -ENOSPC;
+	}
+
+	internals->slaves[internals->nb_slaves++] = slave_id;
+
+	ret = scheduler_update_capabilities(dev);
+	if (ret < 0) {
+		internals->nb_slaves--;
+		return ret;
+	}
+
+	return 0;
+}
+
+int
+rte_cryptodev_scheduler_slave_detach(uint8_t scheduler_id, uint8_t slave_id)
+{
+	struct rte_cryptodev *dev = scheduler_get_dev(scheduler_id);
+	struct scheduler_private *internals;
+	unsigned i;
+	int ret;
+
+	if (dev == NULL)
+		return -EINVAL;
+
+	ret = scheduler_slaves_check_busy(dev);
+	if (ret < 0)
+		return ret;
+
+	internals = dev->data->dev_private;
+
+	for (i = 0; i < internals->nb_slaves; i++)
+		if (internals->slaves[i] == slave_id)
+			break;
+
+	if (i == internals->nb_slaves) {
+		SCHEDULER_LOG_ERR("Slave dev_id=%u not attached", slave_id);
+		return -EINVAL;
+	}
+
+	memmove(&internals->slaves[i], &internals->slaves[i + 1],
+			(internals->nb_slaves - i - 1) *
+			sizeof(internals->slaves[0]));
+	internals->nb_slaves--;
+
+	return scheduler_update_capabilities(dev);
+}
+
+int
+rte_cryptodev_scheduler_slaves_get(uint8_t scheduler_id, uint8_t *slaves)
+{
+	struct rte_cryptodev *dev = scheduler_get_dev(scheduler_id);
+	struct scheduler_private *internals;
+
+	if (dev == NULL)
+		return -EINVAL;
+
+	internals = dev->data->dev_private;
+
+	if (slaves != NULL)
+		memcpy(slaves, internals->slaves,
+				internals->nb_slaves * sizeof(slaves[0]));
+
+	return internals->nb_slaves;
+}
+
+int
+rte_cryptodev_scheduler_mode_set(uint8_t scheduler_id,
+		enum rte_cryptodev_scheduler_mode mode)
+{
+	struct rte_cryptodev *dev = scheduler_get_dev(scheduler_id);
+	struct scheduler_private *internals;
+
+	if (dev == NULL)
+		return -EINVAL;
+
+	if (dev->data->dev_started) {
+		SCHEDULER_LOG_ERR("dev_id=%u must be stopped", scheduler_id);
+		return -EBUSY;
+	}
+
+	switch (mode) {
+	case RTE_CRYPTODEV_SCHEDULER_MODE_ROUND_ROBIN:
+	case RTE_CRYPTODEV_SCHEDULER_MODE_FILL_LEVEL:
+	case RTE_CRYPTODEV_SCHEDULER_MODE_PKT_SIZE:
+		break;
+	default:
+		SCHEDULER_LOG_ERR("Invalid scheduling mode %d", mode);
+		return -EINVAL;
+	}
+
+	internals = dev->data->dev_private;
+	internals->mode = mode;
+
+	return 0;
+}
+
+int
+rte_cryptodev_scheduler_mode_get(uint8_t scheduler_id)
+{
+	struct rte_cryptodev *dev = scheduler_get_dev(scheduler_id);
+	struct scheduler_private *internals;
+
+	if (dev == NULL)
+		return -EINVAL;
+
+	internals = dev->data->dev_private;
+
+	return internals->mode;
+}
+
+int
+rte_cryptodev_scheduler_pkt_size_threshold_set(uint8_t scheduler_id,
+		uint32_t threshold)
+{
+	struct rte_cryptodev *dev = scheduler_get_dev(scheduler_id);
+	struct scheduler_private *internals;
+
+	if (dev == NULL)
+		return -EINVAL;
+
+	if (dev->data->dev_started) {
+		SCHEDULER_LOG_ERR("dev_id=%u must be stopped", scheduler_id);
+		return -EBUSY;
+	}
+
+	internals = dev->data->dev_private;
+	internals->pkt_size_threshold = threshold;
+
+	return 0;
+}
@@ -0,0 +1,174 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 Freescale Semiconductor, Inc. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of  Freescale Semiconductor, Inc nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_CRYPTODEV_SCHEDULER_H_
+#define _RTE_CRYPTODEV_SCHEDULER_H_
+
+/**
+ * @file
+ * RTE Cryptodev Scheduler
+ *
+ * The scheduler is a virtual crypto device which attaches a set of (slave)
+ * crypto devices and distributes the crypto operations enqueued on each of
+ * its queue pairs across the same queue pair of its slaves, according to the
+ * mode of operation specified. Operations are dequeued from a scheduler
+ * queue pair in the order they were enqueued on it, whichever slave
+ * processed them.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/** Maximum number of slaves attached to a scheduler */
+#define RTE_CRYPTODEV_SCHEDULER_MAX_NB_SLAVES		(8)
+
+/** Default packet size threshold of the packet size mode, in bytes */
+#define RTE_CRYPTODEV_SCHEDULER_DEFAULT_PKT_SIZE_THRESHOLD	(512)
+
+/** Scheduling modes */
+enum rte_cryptodev_scheduler_mode {
+	RTE_CRYPTODEV_SCHEDULER_MODE_ROUND_ROBIN = 0,
+	/**< Round Robin.
+	 * Each burst of operations is enqueued on the next slave, in the
+	 * order the slaves were attached. */
+	RTE_CRYPTODEV_SCHEDULER_MODE_FILL_LEVEL,
+	/**< Fill Level.
+	 * Each burst of operations is enqueued on the slave with the least
+	 * operations in flight on the queue pair. */
+	RTE_CRYPTODEV_SCHEDULER_MODE_PKT_SIZE,
+	/**< Packet Size.
+	 * Operations on packets shorter than the packet size threshold are
+	 * enqueued on the first slave attached, the others on the second one.
+	 * Typically the first slave is a software device and the second a
+	 * hardware accelerator. Exactly two slaves must be attached. */
+};
+
+/**
+ * Attach a crypto device as a slave of a scheduler.
+ *
+ * The scheduler must be stopped and have no session in use. The slave must
+ * be configured, and its queue pairs set up, before sessions are created on
+ * the scheduler. It is started and stopped along with the scheduler and must
+ * not be used directly by the application in the meantime.
+ *
+ * @param	scheduler_id	The scheduler device identifier.
+ * @param	slave_id	The slave device identifier.
+ *
+ * @return
+ *   - 0 on success.
+ *   - -EINVAL if a device is invalid or the slave is already attached.
+ *   - -EBUSY if the scheduler is started or has sessions in use.
+ *   - -ENOSPC if the maximum number of slaves is reached.
+ */
+int
+rte_cryptodev_scheduler_slave_attach(uint8_t scheduler_id, uint8_t slave_id);
+
+/**
+ * Detach a slave from a scheduler.
+ *
+ * The scheduler must be stopped and have no session in use.
+ *
+ * @param	scheduler_id	The scheduler device identifier.
+ * @param	slave_id	The slave device identifier.
+ *
+ * @return
+ *   - 0 on success.
+ *   - -EINVAL if a device is invalid or the slave is not attached.
+ *   - -EBUSY if the scheduler is started or has sessions in use.
+ */
+int
+rte_cryptodev_scheduler_slave_detach(uint8_t scheduler_id, uint8_t slave_id);
+
+/**
+ * Get the slaves attached to a scheduler.
+ *
+ * @param	scheduler_id	The scheduler device identifier.
+ * @param	slaves		Array of RTE_CRYPTODEV_SCHEDULER_MAX_NB_SLAVES
+ *				entries filled with the slave identifiers, in
+ *				attachment order. May be NULL.
+ *
+ * @return
+ *   The number of slaves attached on success, negative value otherwise.
+ */
+int
+rte_cryptodev_scheduler_slaves_get(uint8_t scheduler_id, uint8_t *slaves);
+
+/**
+ * Set the scheduling mode of a scheduler.
+ *
+ * @param	scheduler_id	The scheduler device identifier.
+ * @param	mode		The scheduling mode.
+ *
+ * @return
+ *   - 0 on success.
+ *   - -EINVAL if the scheduler or the mode is invalid.
+ *   - -EBUSY if the scheduler is started.
+ */
+int
+rte_cryptodev_scheduler_mode_set(uint8_t scheduler_id,
+		enum rte_cryptodev_scheduler_mode mode);
+
+/**
+ * Get the scheduling mode of a scheduler.
+ *
+ * @param	scheduler_id	The scheduler device identifier.
+ *
+ * @return
+ *   The scheduling mode on success, negative value otherwise.
+ */
+int
+rte_cryptodev_scheduler_mode_get(uint8_t scheduler_id);
+
+/**
+ * Set the packet size threshold of the packet size mode.
+ *
+ * @param	scheduler_id	The scheduler device identifier.
+ * @param	threshold	Packet length, in bytes, from which operations
+ *				are enqueued on the second slave.
+ *
+ * @return
+ *   - 0 on success.
+ *   - -EINVAL if the scheduler is invalid.
+ *   - -EBUSY if the scheduler is started.
+ */
+int
+rte_cryptodev_scheduler_pkt_size_threshold_set(uint8_t scheduler_id,
+		uint32_t threshold);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_CRYPTODEV_SCHEDULER_H_ */
@@ -0,0 +1,560 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 Freescale Semiconductor, Inc. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of  Freescale Semiconductor, Inc nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_config.h>
+#include <rte_cryptodev_pmd.h>
+#include <rte_dev.h>
+#include <rte_kvargs.h>
+#include <rte_malloc.h>
+
+#include "rte_cryptodev_scheduler.h"
+#include "scheduler_pmd_private.h"
+
+#define SCHEDULER_MAX_NB_QP_ARG		("max_nb_queue_pairs")
+#define SCHEDULER_MAX_NB_SESS_ARG	("max_nb_sessions")
+#define SCHEDULER_SOCKET_ID_ARG		("socket_id")
+#define SCHEDULER_SLAVE_ARG		("slave")
+#define SCHEDULER_MODE_ARG		("mode")
+#define SCHEDULER_PKT_SIZE_THRESHOLD_ARG	("pkt_size_threshold")
+
+static const char *scheduler_valid_params[] = {
+	SCHEDULER_MAX_NB_QP_ARG,
+	SCHEDULER_MAX_NB_SESS_ARG,
+	SCHEDULER_SOCKET_ID_ARG,
+	SCHEDULER_SLAVE_ARG,
+	SCHEDULER_MODE_ARG,
+	SCHEDULER_PKT_SIZE_THRESHOLD_ARG,
+	NULL
+};
+
+/** Scheduling mode names, as accepted by the mode argument */
+static const char * const scheduler_mode_names[] = {
+	[RTE_CRYPTODEV_SCHEDULER_MODE_ROUND_ROBIN] = "round-robin",
+	[RTE_CRYPTODEV_SCHEDULER_MODE_FILL_LEVEL] = "fill-level",
+	[RTE_CRYPTODEV_SCHEDULER_MODE_PKT_SIZE] = "packet-size",
+};
+
+/** Scheduler device initialisation parameters */
+struct scheduler_init_params {
+	struct rte_crypto_vdev_init_params def_p;
+	/**< Generic virtual device parameters */
+	char slave_names[RTE_CRYPTODEV_SCHEDULER_MAX_NB_SLAVES]
+			[RTE_CRYPTODEV_NAME_MAX_LEN];
+	/**< Names of the slaves to attach */
+	unsigned nb_slaves;
+	/**< Number of slaves to attach */
+	enum rte_cryptodev_scheduler_mode mode;
+	/**< Scheduling mode */
+	uint32_t pkt_size_threshold;
+	/**< Packet size mode threshold */
+};
+
+/**
+ * Global static parameter used to create a unique name for each crypto device.
+ */
+static unsigned unique_name_id;
+
+static inline int
+create_unique_device_name(char *name, size_t size)
+{
+	int ret;
+
+	if (name == NULL)
+		return -EINVAL;
+
+	ret = snprintf(name, size, "%s_%u",
+			RTE_STR(CRYPTODEV_NAME_SCHEDULER_PMD),
+			unique_name_id++);
+	if (ret < 0)
+		return ret;
+	return 0;
+}
+
+/**
+ * Enqueue a burst of operations on a slave and record the ones it accepted,
+ * in order. The scheduler sessions of the operations are swapped for the
+ * sessions created on the slave; the enqueue stops at the first operation
+ * with an invalid session.
+ */
+static inline uint16_t
+scheduler_enqueue_slave(struct scheduler_qp *qp, unsigned slave,
+		struct rte_crypto_op **ops, uint16_t nb_ops)
+{
+	struct scheduler_order_entry *entry;
+	struct scheduler_session *sess;
+	struct rte_crypto_sym_op *sym;
+	uint32_t tail = qp->order_tail;
+	uint16_t i, nb_enqd;
+
+	for (i = 0; i < nb_ops; i++) {
+		entry = &qp->order[(tail + i) & qp->order_mask];
+		entry->op = ops[i];
+		entry->sess = NULL;
+		entry->slave = slave;
+
+		sym = ops[i]->sym;
+		if (sym->sess_type != RTE_CRYPTO_SYM_OP_WITH_SESSION)
+			continue;
+
+		if (unlikely(sym->session == NULL ||
+				sym->session->dev_type !=
+				RTE_CRYPTODEV_SCHEDULER_PMD)) {
+			ops[i]->status = RTE_CRYPTO_OP_STATUS_INVALID_SESSION;
+			qp->qp_stats.enqueue_err_count++;
+			break;
+		}
+
+		entry->sess = sym->session;
+		sess = (struct scheduler_session *)sym->session->_private;
+		sym->session = sess->sessions[slave];
+	}
+
+	nb_enqd = rte_cryptodev_enqueue_burst(qp->slaves[slave], qp->id,
+			ops, i);
+
+	/* give back their session to the operations the slave refused */
+	while (i > nb_enqd) {
+		i--;
+		entry = &qp->order[(tail + i) & qp->order_mask];
+		if (entry->sess != NULL)
+			ops[i]->sym->session = entry->sess;
+	}
+
+	qp->order_tail = tail + nb_enqd;
+	qp->inflight[slave] += nb_enqd;
+
+	return nb_enqd;
+}
+
+/** Select the slave with the least operations in flight */
+static inline unsigned
+scheduler_least_filled_slave(const struct scheduler_qp *qp)
+{
+	unsigned i, slave = 0;
+
+	for (i = 1; i < qp->nb_slaves; i++)
+		if (qp->inflight[i] < qp->inflight[slave])
+			slave = i;
+
+	return slave;
+}
+
+/** Select the slave of an operation in packet size mode */
+static inline unsigned
+scheduler_pkt_size_slave(const struct scheduler_qp *qp,
+		const struct rte_crypto_op *op)
+{
+	return rte_pktmbuf_pkt_len(op->sym->m_src) < qp->pkt_size_threshold ?
+			0 : 1;
+}
+
+/**
+ * Enqueue in packet size mode. Consecutive operations going to the same
+ * slave are enqueued together, until a slave does not accept all of them so
+ * that the operations enqueued are always the first ones of the burst.
+ */
+static inline uint16_t
+scheduler_enqueue_pkt_size(struct scheduler_qp *qp,
+		struct rte_crypto_op **ops, uint16_t nb_ops)
+{
+	uint16_t i = 0, j, nb_enqd;
+	unsigned slave;
+
+	while (i < nb_ops) {
+		slave = scheduler_pkt_size_slave(qp, ops[i]);
+		for (j = i + 1; j < nb_ops &&
+				scheduler_pkt_size_slave(qp, ops[j]) == slave;
+				j++)
+			;
+
+		nb_enqd = scheduler_enqueue_slave(qp, slave, &ops[i], j - i);
+		if (nb_enqd < j - i)
+			return i + nb_enqd;
+		i = j;
+	}
+
+	return i;
+}
+
+/** Enqueue burst */
+static uint16_t
+scheduler_pmd_enqueue_burst(void *queue_pair, struct rte_crypto_op **ops,
+		uint16_t nb_ops)
+{
+	struct scheduler_qp *qp = queue_pair;
+	uint32_t nb_free;
+	uint16_t nb_enqd;
+	unsigned slave;
+
+	/* operations are tracked until dequeued, no more than the qp size */
+	nb_free = qp->order_mask + 1 - (qp->order_tail - qp->order_head);
+	if (nb_ops > nb_free)
+		nb_ops = nb_free;
+	if (unlikely(nb_ops == 0))
+		return 0;
+
+	switch (qp->mode) {
+	case RTE_CRYPTODEV_SCHEDULER_MODE_FILL_LEVEL:
+		slave = scheduler_least_filled_slave(qp);
+		nb_enqd = scheduler_enqueue_slave(qp, slave, ops, nb_ops);
+		break;
+	case RTE_CRYPTODEV_SCHEDULER_MODE_PKT_SIZE:
+		nb_enqd = scheduler_enqueue_pkt_size(qp, ops, nb_ops);
+		break;
+	case RTE_CRYPTODEV_SCHEDULER_MODE_ROUND_ROBIN:
+	default:
+		slave = qp->next_slave;
+		if (++qp->next_slave == qp->nb_slaves)
+			qp->next_slave = 0;
+		nb_enqd = scheduler_enqueue_slave(qp, slave, ops, nb_ops);
+		break;
+	}
+
+	qp->qp_stats.enqueued_count += nb_enqd;
+	return nb_enqd;
+}
+
+/**
+ * Dequeue burst. The operations processed by the slaves are collected
+ * first, then returned in enqueue order from the oldest one, up to the first
+ * operation still being processed. Each slave completes the operations of a
+ * queue pair in order, so the oldest operations enqueued on a slave are the
+ * ones it returned.
+ */
+static uint16_t
+scheduler_pmd_dequeue_burst(void *queue_pair, struct rte_crypto_op **ops,
+		uint16_t nb_ops)
+{
+	struct scheduler_qp *qp = queue_pair;
+	struct scheduler_order_entry *entry;
+	uint32_t head = qp->order_head;
+	uint16_t nb_deqd;
+	unsigned i;
+
+	/* ops is only used as scratch space here */
+	for (i = 0; i < qp->nb_slaves; i++) {
+		if (qp->inflight[i] == 0)
+			continue;
+
+		nb_deqd = rte_cryptodev_dequeue_burst(qp->slaves[i], qp->id,
+				ops, nb_ops);
+		qp->inflight[i] -= nb_deqd;
+		qp->completed[i] += nb_deqd;
+	}
+
+	nb_deqd = 0;
+	while (nb_deqd < nb_ops && head != qp->order_tail) {
+		entry = &qp->order[head & qp->order_mask];
+		if (qp->completed[entry->slave] == 0)
+			break;
+
+		qp->completed[entry->slave]--;
+		if (entry->sess != NULL)
+			entry->op->sym->session = entry->sess;
+		ops[nb_deqd++] = entry->op;
+		head++;
+	}
+
+	qp->order_head = head;
+	qp->qp_stats.dequeued_count += nb_deqd;
+
+	return nb_deqd;
+}
+
+/** Parse integer from integer argument */
+static int
+parse_integer_arg(const char *key __rte_unused,
+		const char *value, void *extra_args)
+{
+	int *i = (int *) extra_args;
+
+	*i = atoi(value);
+	if (*i < 0) {
+		SCHEDULER_LOG_ERR("Argument has to be positive.");
+		return -1;
+	}
+
+	return 0;
+}
+
+/** Parse socket identifier argument */
+static int
+parse_socket_id_arg(const char *key __rte_unused,
+		const char *value, void *extra_args)
+{
+	uint8_t *socket_id = extra_args;
+	int i = atoi(value);
+
+	if (i < 0 || i >= RTE_MAX_NUMA_NODES) {
+		SCHEDULER_LOG_ERR("Invalid socket id %s", value);
+		return -1;
+	}
+
+	*socket_id = (uint8_t)i;
+	return 0;
+}
+
+/** Parse slave name argument, it can be given several times */
+static int
+parse_slave_arg(const char *key __rte_unused,
+		const char *value, void *extra_args)
+{
+	struct scheduler_init_params *params = extra_args;
+
+	if (params->nb_slaves >= RTE_CRYPTODEV_SCHEDULER_MAX_NB_SLAVES) {
+		SCHEDULER_LOG_ERR("Too many slaves, %u at most",
+				RTE_CRYPTODEV_SCHEDULER_MAX_NB_SLAVES);
+		return -1;
+	}
+
+	snprintf(params->slave_names[params->nb_slaves++],
+			RTE_CRYPTODEV_NAME_MAX_LEN, "%s", value);
+	return 0;
+}
+
+/** Parse scheduling mode argument */
+static int
+parse_mode_arg(const char *key __rte_unused,
+		const char *value, void *extra_args)
+{
+	enum rte_cryptodev_scheduler_mode *mode = extra_args;
+	unsigned i;
+
+	for (i = 0; i < RTE_DIM(scheduler_mode_names); i++) {
+		if (strcmp(value, scheduler_mode_names[i]) == 0) {
+			*mode = (enum rte_cryptodev_scheduler_mode)i;
+			return 0;
+		}
+	}
+
+	SCHEDULER_LOG_ERR("Invalid scheduling mode %s", value);
+	return -1;
+}
+
+/** Parse scheduler device arguments */
+static int
+scheduler_parse_init_params(struct scheduler_init_params *params,
+		const char *input_args)
+{
+	struct rte_kvargs *kvlist;
+	int threshold = params->pkt_size_threshold;
+	int ret;
+
+	if (input_args == NULL)
+		return 0;
+
+	kvlist = rte_kvargs_parse(input_args, scheduler_valid_params);
+	if (kvlist == NULL)
+		return -1;
+
+	ret = rte_kvargs_process(kvlist, SCHEDULER_MAX_NB_QP_ARG,
+			&parse_integer_arg, &params->def_p.max_nb_queue_pairs);
+	if (ret < 0)
+		goto free_kvlist;
+
+	ret = rte_kvargs_process(kvlist, SCHEDULER_MAX_NB_SESS_ARG,
+			&parse_integer_arg, &params->def_p.max_nb_sessions);
+	if (ret < 0)
+		goto free_kvlist;
+
+	ret = rte_kvargs_process(kvlist, SCHEDULER_SOCKET_ID_ARG,
+			&parse_socket_id_arg, &params->def_p.socket_id);
+	if (ret < 0)
+		goto free_kvlist;
+
+	ret = rte_kvargs_process(kvlist, SCHEDULER_SLAVE_ARG,
+			&parse_slave_arg, params);
+	if (ret < 0)
+		goto free_kvlist;
+
+	ret = rte_kvargs_process(kvlist, SCHEDULER_MODE_ARG,
+			&parse_mode_arg, &params->mode);
+	if (ret < 0)
+		goto free_kvlist;
+
+	ret = rte_kvargs_process(kvlist, SCHEDULER_PKT_SIZE_THRESHOLD_ARG,
+			&parse_integer_arg, &threshold);
+	if (ret < 0)
+		goto free_kvlist;
+	params->pkt_size_threshold = threshold;
+
+free_kvlist:
+	rte_kvargs_free(kvlist);
+	return ret;
+}
+
+static int cryptodev_scheduler_uninit(const char *name);
+
+/** Create crypto device */
+static int
+cryptodev_scheduler_create(const char *name,
+		struct scheduler_init_params *init_params)
+{
+	struct rte_cryptodev *dev;
+	char crypto_dev_name[RTE_CRYPTODEV_NAME_MAX_LEN];
+	struct scheduler_private *internals;
+	int slave_id;
+	unsigned i;
+
+	/* create a unique device name */
+	if (create_unique_device_name(crypto_dev_name,
+			RTE_CRYPTODEV_NAME_MAX_LEN) != 0) {
+		SCHEDULER_LOG_ERR("failed to create unique cryptodev name");
+		return -EINVAL;
+	}
+
+	dev = rte_cryptodev_pmd_virtual_dev_init(crypto_dev_name,
+			sizeof(struct scheduler_private),
+			init_params->def_p.socket_id);
+	if (dev == NULL) {
+		SCHEDULER_LOG_ERR("failed to create cryptodev vdev");
+		goto init_error;
+	}
+
+	dev->dev_type = RTE_CRYPTODEV_SCHEDULER_PMD;
+	dev->dev_ops = scheduler_pmd_ops;
+
+	/* register rx/tx burst functions for data path */
+	dev->dequeue_burst = scheduler_pmd_dequeue_burst;
+	dev->enqueue_burst = scheduler_pmd_enqueue_burst;
+
+	internals = dev->data->dev_private;
+
+	internals->init_nb_qpairs = init_params->def_p.max_nb_queue_pairs;
+	internals->max_nb_qpairs = init_params->def_p.max_nb_queue_pairs;
+	internals->max_nb_sessions = init_params->def_p.max_nb_sessions;
+	internals->mode = init_params->mode;
+	internals->pkt_size_threshold = init_params->pkt_size_threshold;
+
+	if (scheduler_update_capabilities(dev) < 0) {
+		SCHEDULER_LOG_ERR("failed to allocate capabilities");
+		goto init_error;
+	}
+
+	for (i = 0; i < init_params->nb_slaves; i++) {
+		slave_id = rte_cryptodev_get_dev_id(
+				init_params->slave_names[i]);
+		if (slave_id < 0) {
+			SCHEDULER_LOG_ERR("unknown slave %s",
+					init_params->slave_names[i]);
+			goto init_error;
+		}
+
+		if (rte_cryptodev_scheduler_slave_attach(dev->data->dev_id,
+				(uint8_t)slave_id) < 0) {
+			SCHEDULER_LOG_ERR("failed to attach slave %s",
+					init_params->slave_names[i]);
+			goto init_error;
+		}
+	}
+
+	return 0;
+
+init_error:
+	SCHEDULER_LOG_ERR("driver %s: cryptodev_scheduler_create failed",
+			name);
+	if (dev != NULL) {
+		internals = dev->data->dev_private;
+		rte_free(internals->capabilities);
+		rte_cryptodev_pmd_release_device(dev);
+	}
+	cryptodev_scheduler_uninit(crypto_dev_name);
+
+	return -EFAULT;
+}
+
+/** Initialise scheduler crypto device */
+static int
+cryptodev_scheduler_init(const char *name,
+		const char *input_args)
+{
+	struct scheduler_init_params init_params = {
+		.def_p = {
+			RTE_CRYPTODEV_VDEV_DEFAULT_MAX_NB_QUEUE_PAIRS,
+			RTE_CRYPTODEV_VDEV_DEFAULT_MAX_NB_SESSIONS,
+			rte_socket_id()
+		},
+		.nb_slaves = 0,
+		.mode = RTE_CRYPTODEV_SCHEDULER_MODE_ROUND_ROBIN,
+		.pkt_size_threshold =
+			RTE_CRYPTODEV_SCHEDULER_DEFAULT_PKT_SIZE_THRESHOLD,
+	};
+
+	if (scheduler_parse_init_params(&init_params, input_args) < 0) {
+		SCHEDULER_LOG_ERR("invalid parameters %s", input_args);
+		return -EINVAL;
+	}
+
+	RTE_LOG(INFO, PMD, "Initialising %s on NUMA node %d\n", name,
+			init_params.def_p.socket_id);
+	RTE_LOG(INFO, PMD, "  Max number of queue pairs = %d\n",
+			init_params.def_p.max_nb_queue_pairs);
+	RTE_LOG(INFO, PMD, "  Max number of sessions = %d\n",
+			init_params.def_p.max_nb_sessions);
+	RTE_LOG(INFO, PMD, "  Scheduling mode = %s\n",
+			scheduler_mode_names[init_params.mode]);
+
+	return cryptodev_scheduler_create(name, &init_params);
+}
+
+/** Uninitialise scheduler crypto device */
+static int
+cryptodev_scheduler_uninit(const char *name)
+{
+	if (name == NULL)
+		return -EINVAL;
+
+	RTE_LOG(INFO, PMD, "Closing scheduler crypto device %s on numa "
+			"socket %u\n", name, rte_socket_id());
+
+	return 0;
+}
+
+static struct rte_driver cryptodev_scheduler_pmd_drv = {
+	.type = PMD_VDEV,
+	.init = cryptodev_scheduler_init,
+	.uninit = cryptodev_scheduler_uninit
+};
+
+PMD_REGISTER_DRIVER(cryptodev_scheduler_pmd_drv,
+		CRYPTODEV_NAME_SCHEDULER_PMD);
+DRIVER_REGISTER_PARAM_STRING(CRYPTODEV_NAME_SCHEDULER_PMD,
+	"max_nb_queue_pairs=<int> "
+	"max_nb_sessions=<int> "
+	"socket_id=<int> "
+	"slave=<name> "
+	"mode=round-robin|fill-level|packet-size "
+	"pkt_size_threshold=<int>");
@@ -0,0 +1,520 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 Freescale Semiconductor, Inc. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of  Freescale Semiconductor, Inc nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_malloc.h>
+#include <rte_cryptodev_pmd.h>
+
+#include "scheduler_pmd_private.h"
+
+/**
+ * Restrict a size range of a capability to the sizes also supported by the
+ * same range of another capability. Returns -1 when no size is left.
+ */
+static int
+scheduler_sync_range(uint16_t *min, uint16_t *max, uint16_t *increment,
+		uint16_t o_min, uint16_t o_max, uint16_t o_increment)
+{
+	if (o_min > *min)
+		*min = o_min;
+	if (o_max < *max)
+		*max = o_max;
+	if (*min > *max)
+		return -1;
+
+	if (*increment == 0 || o_increment == 0) {
+		/* one of them supports a single size */
+		if (*min != *max)
+			return -1;
+		*increment = 0;
+	} else if (o_increment > *increment)
+		*increment = o_increment;
+
+	return 0;
+}
+
+#define SCHEDULER_SYNC_RANGE(range, o_range) \
+	scheduler_sync_range(&(range).min, &(range).max, &(range).increment, \
+			(o_range).min, (o_range).max, (o_range).increment)
+
+/**
+ * Restrict a capability to what is also supported by one of the capabilities
+ * of a list. Returns -1 when the capability is not in the list.
+ */
+static int
+scheduler_sync_capability(struct rte_cryptodev_capabilities *cap,
+		const struct rte_cryptodev_capabilities *o_caps)
+{
+	const struct rte_cryptodev_capabilities *o_cap;
+	struct rte_cryptodev_symmetric_capability *sym = &cap->sym;
+	const struct rte_cryptodev_symmetric_capability *o_sym;
+
+	for (o_cap = o_caps; o_cap->op != RTE_CRYPTO_OP_TYPE_UNDEFINED;
+			o_cap++) {
+		o_sym = &o_cap->sym;
+		if (o_cap->op != cap->op || o_sym->xform_type != sym->xform_type)
+			continue;
+
+		if (sym->xform_type == RTE_CRYPTO_SYM_XFORM_AUTH) {
+			if (o_sym->auth.algo != sym->auth.algo)
+				continue;
+			if (SCHEDULER_SYNC_RANGE(sym->auth.key_size,
+					o_sym->auth.key_size) < 0 ||
+					SCHEDULER_SYNC_RANGE(sym->auth.digest_size,
+					o_sym->auth.digest_size) < 0 ||
+					SCHEDULER_SYNC_RANGE(sym->auth.aad_size,
+					o_sym->auth.aad_size) < 0)
+				return -1;
+			return 0;
+		}
+
+		if (sym->xform_type == RTE_CRYPTO_SYM_XFORM_CIPHER) {
+			if (o_sym->cipher.algo != sym->cipher.algo)
+				continue;
+			if (SCHEDULER_SYNC_RANGE(sym->cipher.key_size,
+					o_sym->cipher.key_size) < 0 ||
+					SCHEDULER_SYNC_RANGE(sym->cipher.iv_size,
+					o_sym->cipher.iv_size) < 0)
+				return -1;
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+/** Set the capabilities, features and limits common to all the slaves */
+int
+scheduler_update_capabilities(struct rte_cryptodev *dev)
+{
+	struct scheduler_private *internals = dev->data->dev_private;
+	const struct rte_cryptodev_capabilities *cap;
+	struct rte_cryptodev_capabilities *caps;
+	struct rte_cryptodev_info slave_info, info;
+	uint64_t feature_flags = RTE_CRYPTODEV_FF_SYMMETRIC_CRYPTO |
+			RTE_CRYPTODEV_FF_SYM_OPERATION_CHAINING |
+			RTE_CRYPTODEV_FF_MBUF_SCATTER_GATHER;
+	unsigned max_nb_qpairs = internals->init_nb_qpairs;
+	unsigned i, nb_caps = 0;
+
+	if (internals->nb_slaves > 0) {
+		rte_cryptodev_info_get(internals->slaves[0], &info);
+		for (cap = info.capabilities;
+				cap->op != RTE_CRYPTO_OP_TYPE_UNDEFINED; cap++)
+			nb_caps++;
+	}
+
+	/* zeroed, the extra entry ends the list */
+	caps = rte_zmalloc_socket("Scheduler Crypto PMD Capabilities",
+			sizeof(*caps) * (nb_caps + 1), 0, dev->data->socket_id);
+	if (caps == NULL)
+		return -ENOMEM;
+
+	nb_caps = 0;
+	if (internals->nb_slaves > 0) {
+		for (cap = info.capabilities;
+				cap->op != RTE_CRYPTO_OP_TYPE_UNDEFINED; cap++) {
+			caps[nb_caps] = *cap;
+
+			for (i = 1; i < internals->nb_slaves; i++) {
+				rte_cryptodev_info_get(internals->slaves[i],
+						&slave_info);
+				if (scheduler_sync_capability(&caps[nb_caps],
+						slave_info.capabilities) < 0)
+					break;
+			}
+
+			if (i == internals->nb_slaves)
+				nb_caps++;
+		}
+		memset(&caps[nb_caps], 0, sizeof(caps[nb_caps]));
+	}
+
+	for (i = 0; i < internals->nb_slaves; i++) {
+		rte_cryptodev_info_get(internals->slaves[i], &slave_info);
+		feature_flags &= slave_info.feature_flags;
+		max_nb_qpairs = RTE_MIN(max_nb_qpairs,
+				slave_info.max_nb_queue_pairs);
+	}
+
+	rte_free(internals->capabilities);
+	internals->capabilities = caps;
+	internals->max_nb_qpairs = max_nb_qpairs;
+	dev->feature_flags = feature_flags;
+
+	return 0;
+}
+
+/** Configure device */
+static int
+scheduler_pmd_config(__rte_unused struct rte_cryptodev *dev)
+{
+	return 0;
+}
+
+/** Start device, along with its slaves */
+static int
+scheduler_pmd_start(struct rte_cryptodev *dev)
+{
+	struct scheduler_private *internals = dev->data->dev_private;
+	struct rte_cryptodev *slave;
+	struct scheduler_qp *qp;
+	uint16_t qp_id;
+	unsigned i;
+	int ret;
+
+	if (internals->nb_slaves == 0) {
+		SCHEDULER_LOG_ERR("No slave attached");
+		return -EINVAL;
+	}
+
+	if (internals->mode == RTE_CRYPTODEV_SCHEDULER_MODE_PKT_SIZE &&
+			internals->nb_slaves != 2) {
+		SCHEDULER_LOG_ERR("Packet size mode needs 2 slaves, %u "
+				"attached", internals->nb_slaves);
+		return -EINVAL;
+	}
+
+	for (i = 0; i < internals->nb_slaves; i++) {
+		slave = rte_cryptodev_pmd_get_dev(internals->slaves[i]);
+		if (slave->data->nb_queue_pairs < dev->data->nb_queue_pairs) {
+			SCHEDULER_LOG_ERR("Slave %u has %u queue pairs, %u "
+					"needed", internals->slaves[i],
+					slave->data->nb_queue_pairs,
+					dev->data->nb_queue_pairs);
+			ret = -EINVAL;
+			goto start_error;
+		}
+
+		ret = rte_cryptodev_start(internals->slaves[i]);
+		if (ret < 0) {
+			SCHEDULER_LOG_ERR("Failed to start slave %u",
+					internals->slaves[i]);
+			goto start_error;
+		}
+	}
+
+	for (qp_id = 0; qp_id < dev->data->nb_queue_pairs; qp_id++) {
+		qp = dev->data->queue_pairs[qp_id];
+		if (qp == NULL)
+			continue;
+
+		qp->mode = internals->mode;
+		qp->pkt_size_threshold = internals->pkt_size_threshold;
+		memcpy(qp->slaves, internals->slaves, sizeof(qp->slaves));
+		qp->nb_slaves = internals->nb_slaves;
+		qp->next_slave = 0;
+	}
+
+	return 0;
+
+start_error:
+	while (i-- > 0)
+		rte_cryptodev_stop(internals->slaves[i]);
+
+	return ret;
+}
+
+/** Stop device, along with its slaves */
+static void
+scheduler_pmd_stop(struct rte_cryptodev *dev)
+{
+	struct scheduler_private *internals = dev->data->dev_private;
+	struct rte_cryptodev *slave;
+	unsigned i;
+
+	for (i = 0; i < internals->nb_slaves; i++) {
+		slave = rte_cryptodev_pmd_get_dev(internals->slaves[i]);
+		if (slave->data->dev_started)
+			rte_cryptodev_stop(internals->slaves[i]);
+	}
+}
+
+/** Close device */
+static int
+scheduler_pmd_close(__rte_unused struct rte_cryptodev *dev)
+{
+	return 0;
+}
+
+/** Get device statistics */
+static void
+scheduler_pmd_stats_get(struct rte_cryptodev *dev,
+		struct rte_cryptodev_stats *stats)
+{
+	int qp_id;
+
+	for (qp_id = 0; qp_id < dev->data->nb_queue_pairs; qp_id++) {
+		struct scheduler_qp *qp = dev->data->queue_pairs[qp_id];
+
+		stats->enqueued_count += qp->qp_stats.enqueued_count;
+		stats->dequeued_count += qp->qp_stats.dequeued_count;
+
+		stats->enqueue_err_count += qp->qp_stats.enqueue_err_count;
+		stats->dequeue_err_count += qp->qp_stats.dequeue_err_count;
+	}
+}
+
+/** Reset device statistics */
+static void
+scheduler_pmd_stats_reset(struct rte_cryptodev *dev)
+{
+	int qp_id;
+
+	for (qp_id = 0; qp_id < dev->data->nb_queue_pairs; qp_id++) {
+		struct scheduler_qp *qp = dev->data->queue_pairs[qp_id];
+
+		memset(&qp->qp_stats, 0, sizeof(qp->qp_stats));
+	}
+}
+
+/** Get device info */
+static void
+scheduler_pmd_info_get(struct rte_cryptodev *dev,
+		struct rte_cryptodev_info *dev_info)
+{
+	struct scheduler_private *internals = dev->data->dev_private;
+
+	if (dev_info != NULL) {
+		dev_info->dev_type = dev->dev_type;
+		dev_info->max_nb_queue_pairs = internals->max_nb_qpairs;
+		dev_info->sym.max_nb_sessions = internals->max_nb_sessions;
+		dev_info->feature_flags = dev->feature_flags;
+		dev_info->capabilities = internals->capabilities;
+	}
+}
+
+/** Release queue pair */
+static int
+scheduler_pmd_qp_release(struct rte_cryptodev *dev, uint16_t qp_id)
+{
+	struct scheduler_qp *qp = dev->data->queue_pairs[qp_id];
+
+	if (qp != NULL) {
+		rte_free(qp->order);
+		rte_free(qp);
+		dev->data->queue_pairs[qp_id] = NULL;
+	}
+	return 0;
+}
+
+/** Setup a queue pair */
+static int
+scheduler_pmd_qp_setup(struct rte_cryptodev *dev, uint16_t qp_id,
+		const struct rte_cryptodev_qp_conf *qp_conf,
+		 int socket_id)
+{
+	struct scheduler_private *internals = dev->data->dev_private;
+	struct scheduler_qp *qp;
+	uint32_t order_size;
+
+	if (qp_id >= internals->max_nb_qpairs) {
+		SCHEDULER_LOG_ERR("Invalid qp_id %u, greater than maximum "
+				"number of queue pairs supported (%u).",
+				qp_id, internals->max_nb_qpairs);
+		return (-EINVAL);
+	}
+
+	/* Free memory prior to re-allocation if needed. */
+	if (dev->data->queue_pairs[qp_id] != NULL)
+		scheduler_pmd_qp_release(dev, qp_id);
+
+	/* Allocate the queue pair data structure. */
+	qp = rte_zmalloc_socket("Scheduler Crypto PMD Queue Pair", sizeof(*qp),
+					RTE_CACHE_LINE_SIZE, socket_id);
+	if (qp == NULL) {
+		SCHEDULER_LOG_ERR("Failed to allocate queue pair memory");
+		return (-ENOMEM);
+	}
+
+	order_size = rte_align32pow2(qp_conf->nb_descriptors);
+	qp->order = rte_zmalloc_socket("Scheduler Crypto PMD Order",
+			sizeof(*qp->order) * order_size,
+			RTE_CACHE_LINE_SIZE, socket_id);
+	if (qp->order == NULL) {
+		SCHEDULER_LOG_ERR("Failed to allocate queue pair order memory");
+		rte_free(qp);
+		return (-ENOMEM);
+	}
+
+	qp->id = qp_id;
+	qp->order_mask = order_size - 1;
+	dev->data->queue_pairs[qp_id] = qp;
+
+	return 0;
+}
+
+/** Start queue pair */
+static int
+scheduler_pmd_qp_start(__rte_unused struct rte_cryptodev *dev,
+		__rte_unused uint16_t queue_pair_id)
+{
+	return -ENOTSUP;
+}
+
+/** Stop queue pair */
+static int
+scheduler_pmd_qp_stop(__rte_unused struct rte_cryptodev *dev,
+		__rte_unused uint16_t queue_pair_id)
+{
+	return -ENOTSUP;
+}
+
+/** Return the number of allocated queue pairs */
+static uint32_t
+scheduler_pmd_qp_count(struct rte_cryptodev *dev)
+{
+	return dev->data->nb_queue_pairs;
+}
+
+/** Returns the size of the scheduler session structure */
+static unsigned
+scheduler_pmd_session_get_size(struct rte_cryptodev *dev __rte_unused)
+{
+	return sizeof(struct scheduler_session);
+}
+
+/** Return the largest per-op private area asked for by a slave */
+static unsigned
+scheduler_pmd_op_priv_get_size(struct rte_cryptodev *dev)
+{
+	struct scheduler_private *internals = dev->data->dev_private;
+	struct rte_cryptodev *slave;
+	unsigned i, size, max_size = 0;
+
+	for (i = 0; i < internals->nb_slaves; i++) {
+		slave = rte_cryptodev_pmd_get_dev(internals->slaves[i]);
+		if (slave->dev_ops->op_priv_get_size == NULL)
+			continue;
+
+		size = (*slave->dev_ops->op_priv_get_size)(slave);
+		if (size > max_size)
+			max_size = size;
+	}
+
+	return max_size;
+}
+
+/** Configure a scheduler session, creating a session on each slave */
+static void *
+scheduler_pmd_session_configure(struct rte_cryptodev *dev,
+		struct rte_crypto_sym_xform *xform, void *sess)
+{
+	struct scheduler_private *internals = dev->data->dev_private;
+	struct scheduler_session *s = sess;
+	struct rte_cryptodev *slave;
+	unsigned i;
+
+	if (unlikely(sess == NULL)) {
+		SCHEDULER_LOG_ERR("invalid session struct");
+		return NULL;
+	}
+
+	if (internals->nb_slaves == 0) {
+		SCHEDULER_LOG_ERR("no slave attached");
+		return NULL;
+	}
+
+	for (i = 0; i < internals->nb_slaves; i++) {
+		slave = rte_cryptodev_pmd_get_dev(internals->slaves[i]);
+		if (slave->data->session_pool == NULL) {
+			SCHEDULER_LOG_ERR("slave %u is not configured",
+					internals->slaves[i]);
+			goto configure_error;
+		}
+
+		s->sessions[i] = rte_cryptodev_sym_session_create(
+				internals->slaves[i], xform);
+		if (s->sessions[i] == NULL) {
+			SCHEDULER_LOG_ERR("failed to create session on "
+					"slave %u", internals->slaves[i]);
+			goto configure_error;
+		}
+	}
+
+	return sess;
+
+configure_error:
+	while (i-- > 0) {
+		rte_cryptodev_sym_session_free(s->sessions[i]->dev_id,
+				s->sessions[i]);
+		s->sessions[i] = NULL;
+	}
+
+	return NULL;
+}
+
+/** Free the slave sessions and clear the memory of the session */
+static void
+scheduler_pmd_session_clear(struct rte_cryptodev *dev __rte_unused,
+		void *sess)
+{
+	struct scheduler_session *s = sess;
+	unsigned i;
+
+	if (s == NULL)
+		return;
+
+	for (i = 0; i < RTE_CRYPTODEV_SCHEDULER_MAX_NB_SLAVES; i++)
+		if (s->sessions[i] != NULL)
+			rte_cryptodev_sym_session_free(s->sessions[i]->dev_id,
+					s->sessions[i]);
+
+	memset(s, 0, sizeof(struct scheduler_session));
+}
+
+struct rte_cryptodev_ops scheduler_ops = {
+		.dev_configure		= scheduler_pmd_config,
+		.dev_start		= scheduler_pmd_start,
+		.dev_stop		= scheduler_pmd_stop,
+		.dev_close		= scheduler_pmd_close,
+
+		.stats_get		= scheduler_pmd_stats_get,
+		.stats_reset		= scheduler_pmd_stats_reset,
+
+		.dev_infos_get		= scheduler_pmd_info_get,
+
+		.queue_pair_setup	= scheduler_pmd_qp_setup,
+		.queue_pair_release	= scheduler_pmd_qp_release,
+		.queue_pair_start	= scheduler_pmd_qp_start,
+		.queue_pair_stop	= scheduler_pmd_qp_stop,
+		.queue_pair_count	= scheduler_pmd_qp_count,
+
+		.session_get_size	= scheduler_pmd_session_get_size,
+		.session_configure	= scheduler_pmd_session_configure,
+		.session_clear		= scheduler_pmd_session_clear,
+		.op_priv_get_size	= scheduler_pmd_op_priv_get_size
+};
+
+struct rte_cryptodev_ops *scheduler_pmd_ops = &scheduler_ops;
@@ -0,0 +1,131 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 Freescale Semiconductor, Inc. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of  Freescale Semiconductor, Inc nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _SCHEDULER_PMD_PRIVATE_H_
+#define _SCHEDULER_PMD_PRIVATE_H_
+
+#include "rte_config.h"
+#include "rte_cryptodev_scheduler.h"
+
+#define SCHEDULER_LOG_ERR(fmt, args...) \
+	RTE_LOG(ERR, CRYPTODEV, "[%s] %s() line %u: " fmt "\n",  \
+			RTE_STR(CRYPTODEV_NAME_SCHEDULER_PMD), \
+			__func__, __LINE__, ## args)
+
+#ifdef RTE_LIBRTE_PMD_CRYPTO_SCHEDULER_DEBUG
+#define SCHEDULER_LOG_INFO(fmt, args...) \
+	RTE_LOG(INFO, CRYPTODEV, "[%s] %s() line %u: " fmt "\n", \
+			RTE_STR(CRYPTODEV_NAME_SCHEDULER_PMD), \
+			__func__, __LINE__, ## args)
+
+#define SCHEDULER_LOG_DBG(fmt, args...) \
+	RTE_LOG(DEBUG, CRYPTODEV, "[%s] %s() line %u: " fmt "\n", \
+			RTE_STR(CRYPTODEV_NAME_SCHEDULER_PMD), \
+			__func__, __LINE__, ## args)
+#else
+#define SCHEDULER_LOG_INFO(fmt, args...)
+#define SCHEDULER_LOG_DBG(fmt, args...)
+#endif
+
+
+/** private data structure for each scheduler device */
+struct scheduler_private {
+	unsigned init_nb_qpairs;	/**< Max number of queue pairs asked */
+	unsigned max_nb_qpairs;		/**< Max number of queue pairs */
+	unsigned max_nb_sessions;	/**< Max number of sessions */
+
+	uint8_t slaves[RTE_CRYPTODEV_SCHEDULER_MAX_NB_SLAVES];
+	/**< Slave device identifiers, in attachment order */
+	unsigned nb_slaves;		/**< Number of slaves attached */
+
+	enum rte_cryptodev_scheduler_mode mode;	/**< Scheduling mode */
+	uint32_t pkt_size_threshold;	/**< Packet size mode threshold */
+
+	struct rte_cryptodev_capabilities *capabilities;
+	/**< Capabilities common to all the slaves */
+};
+
+/** Operation tracked by a scheduler queue pair until it is dequeued */
+struct scheduler_order_entry {
+	struct rte_crypto_op *op;
+	/**< Crypto operation */
+	struct rte_cryptodev_sym_session *sess;
+	/**< Scheduler session of the operation, NULL if session-less */
+	unsigned slave;
+	/**< Index of the slave the operation was enqueued on */
+};
+
+/** Scheduler queue pair */
+struct scheduler_qp {
+	uint16_t id;
+	/**< Queue Pair Identifier */
+	enum rte_cryptodev_scheduler_mode mode;
+	/**< Scheduling mode, set on device start */
+	uint32_t pkt_size_threshold;
+	/**< Packet size mode threshold, set on device start */
+	uint8_t slaves[RTE_CRYPTODEV_SCHEDULER_MAX_NB_SLAVES];
+	/**< Slave device identifiers, set on device start */
+	unsigned nb_slaves;
+	/**< Number of slaves, set on device start */
+	unsigned next_slave;
+	/**< Next slave to use in round robin mode */
+	uint32_t inflight[RTE_CRYPTODEV_SCHEDULER_MAX_NB_SLAVES];
+	/**< Operations enqueued on each slave and not dequeued yet */
+	uint32_t completed[RTE_CRYPTODEV_SCHEDULER_MAX_NB_SLAVES];
+	/**< Operations dequeued from each slave and not returned yet */
+	struct scheduler_order_entry *order;
+	/**< Operations in flight, in enqueue order */
+	uint32_t order_mask;
+	/**< Size of the order array minus one, the size being a power of 2 */
+	uint32_t order_head;
+	/**< Index of the oldest operation in flight */
+	uint32_t order_tail;
+	/**< Index following the newest operation in flight */
+	struct rte_cryptodev_stats qp_stats;
+	/**< Queue pair statistics */
+} __rte_cache_aligned;
+
+/** Scheduler private session structure */
+struct scheduler_session {
+	struct rte_cryptodev_sym_session *sessions[
+			RTE_CRYPTODEV_SCHEDULER_MAX_NB_SLAVES];
+	/**< Session created on each slave, indexed like the slaves */
+};
+
+/** Update the scheduler capabilities after a slave is attached or detached */
+extern int
+scheduler_update_capabilities(struct rte_cryptodev *dev);
+
+/** device specific operations function pointer structure */
+extern struct rte_cryptodev_ops *scheduler_pmd_ops;
+
+#endif /* _SCHEDULER_PMD_PRIVATE_H_ */
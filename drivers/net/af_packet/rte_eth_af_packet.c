@@ -41,6 +41,7 @@
 #include <rte_malloc.h>
 #include <rte_kvargs.h>
 #include <rte_dev.h>
+#include <rte_interrupts.h>
 
 #include <linux/if_ether.h>
 #include <linux/if_packet.h>
@@ -104,6 +105,9 @@ struct pmd_internals {
 
 	struct pkt_rx_queue rx_queue[RTE_PMD_AF_PACKET_MAX_RINGS];
 	struct pkt_tx_queue tx_queue[RTE_PMD_AF_PACKET_MAX_RINGS];
+
+	struct rte_intr_handle intr_handle;
+	int intr_vec[RTE_PMD_AF_PACKET_MAX_RINGS];
 };
 
 static const char *valid_arguments[] = {
@@ -240,9 +244,33 @@ eth_af_packet_tx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 	return num_tx;
 }
 
+/*
+ * RX interrupts wait on the sockets, which must never be read. The handle
+ * is filled at each start, as stopping the port empties it.
+ */
+static void
+eth_dev_intr_setup(struct pmd_internals *internals)
+{
+	struct rte_intr_handle *intr = &internals->intr_handle;
+	unsigned q;
+
+	intr->type = RTE_INTR_HANDLE_VDEV;
+	intr->fd = -1;
+	intr->efd_counter_size = 0;
+	intr->nb_efd = RTE_MIN(internals->nb_queues,
+			(unsigned)RTE_MAX_RXTX_INTR_VEC_ID);
+	intr->max_intr = intr->nb_efd;
+	for (q = 0; q < intr->nb_efd; q++) {
+		intr->efds[q] = internals->rx_queue[q].sockfd;
+		internals->intr_vec[q] = RTE_INTR_VEC_RXTX_OFFSET + q;
+	}
+	intr->intr_vec = internals->intr_vec;
+}
+
 static int
 eth_dev_start(struct rte_eth_dev *dev)
 {
+	eth_dev_intr_setup(dev->data->dev_private);
 	dev->data->dev_link.link_status = ETH_LINK_UP;
 	return 0;
 }
@@ -253,17 +281,12 @@ eth_dev_start(struct rte_eth_dev *dev)
 static void
 eth_dev_stop(struct rte_eth_dev *dev)
 {
-	unsigned i;
-	int sockfd;
 	struct pmd_internals *internals = dev->data->dev_private;
 
-	for (i = 0; i < internals->nb_queues; i++) {
-		sockfd = internals->rx_queue[i].sockfd;
-		if (sockfd != -1)
-			close(sockfd);
-		sockfd = internals->tx_queue[i].sockfd;
-		if (sockfd != -1)
-			close(sockfd);
+	/* remove the sockets from the epoll instances, kept for a restart */
+	if (internals->intr_handle.intr_vec != NULL) {
+		rte_intr_efd_disable(&internals->intr_handle);
+		internals->intr_handle.intr_vec = NULL;
 	}
 
 	dev->data->dev_link.link_status = ETH_LINK_DOWN;
@@ -344,8 +367,20 @@ eth_stats_reset(struct rte_eth_dev *dev)
 }
 
 static void
-eth_dev_close(struct rte_eth_dev *dev __rte_unused)
+eth_dev_close(struct rte_eth_dev *dev)
 {
+	unsigned i;
+	int sockfd;
+	struct pmd_internals *internals = dev->data->dev_private;
+
+	/* the RX and TX queues of a pair share their socket */
+	for (i = 0; i < internals->nb_queues; i++) {
+		sockfd = internals->rx_queue[i].sockfd;
+		if (sockfd != -1)
+			close(sockfd);
+		internals->rx_queue[i].sockfd = -1;
+		internals->tx_queue[i].sockfd = -1;
+	}
 }
 
 static void
@@ -405,6 +440,25 @@ eth_tx_queue_setup(struct rte_eth_dev *dev,
 	return 0;
 }
 
+/*
+ * The RX sockets are used as RX interrupt fds: the kernel wakes up the
+ * epoll waiters whenever it queues a frame to the ring, so there is
+ * nothing to arm.
+ */
+static int
+eth_rx_queue_intr_enable(struct rte_eth_dev *dev __rte_unused,
+		uint16_t rx_queue_id __rte_unused)
+{
+	return 0;
+}
+
+static int
+eth_rx_queue_intr_disable(struct rte_eth_dev *dev __rte_unused,
+		uint16_t rx_queue_id __rte_unused)
+{
+	return 0;
+}
+
 static const struct eth_dev_ops ops = {
 	.dev_start = eth_dev_start,
 	.dev_stop = eth_dev_stop,
@@ -418,6 +472,8 @@ static const struct eth_dev_ops ops = {
 	.link_update = eth_link_update,
 	.stats_get = eth_stats_get,
 	.stats_reset = eth_stats_reset,
+	.rx_queue_intr_enable = eth_rx_queue_intr_enable,
+	.rx_queue_intr_disable = eth_rx_queue_intr_disable,
 };
 
 /*
@@ -697,6 +753,8 @@ rte_pmd_init_internals(const char *name,
 	(*eth_dev)->data->kdrv = RTE_KDRV_NONE;
 	(*eth_dev)->data->numa_node = numa_node;
 
+	(*eth_dev)->intr_handle = &(*internals)->intr_handle;
+
 	return 0;
 
 error:
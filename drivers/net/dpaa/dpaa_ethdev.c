@@ -72,9 +72,41 @@ static struct usdpaa_netcfg_info *dpaa_netcfg;
 RTE_DEFINE_PER_LCORE(bool, _dpaa_io);
 struct pool_info_entry dpaa_pool_table[DPAA_MAX_BPOOLS];
 
+struct dpaa_xstats_name_off {
+	char name[RTE_ETH_XSTATS_NAME_SIZE];
+	unsigned int offset;
+};
+
+/* Buffer stash of the pool of the port */
+static const struct dpaa_xstats_name_off dpaa_bm_stash_strings[] = {
+	{"bm_stash_get_hits", offsetof(struct bm_stash_stats, get_hits)},
+	{"bm_stash_get_misses", offsetof(struct bm_stash_stats, get_misses)},
+	{"bm_stash_get_fails", offsetof(struct bm_stash_stats, get_fails)},
+	{"bm_stash_put_hits", offsetof(struct bm_stash_stats, put_hits)},
+	{"bm_stash_put_misses", offsetof(struct bm_stash_stats, put_misses)},
+	{"bm_stash_acquires", offsetof(struct bm_stash_stats, acquires)},
+	{"bm_stash_releases", offsetof(struct bm_stash_stats, releases)},
+};
+
+#define DPAA_NB_BM_STASH_XSTATS RTE_DIM(dpaa_bm_stash_strings)
+
+/* Rx queue backlogs of the push mode, summed over the queues */
+static const struct dpaa_xstats_name_off dpaa_rx_demux_strings[] = {
+	{"rx_push_polls", offsetof(struct rx_demux_stats, polls)},
+	{"rx_push_backlogged", offsetof(struct rx_demux_stats, backlogged)},
+	{"rx_push_drops", offsetof(struct rx_demux_stats, drops)},
+};
+
+#define DPAA_NB_RX_DEMUX_XSTATS RTE_DIM(dpaa_rx_demux_strings)
+#define DPAA_NB_XSTATS (DPAA_NB_BM_STASH_XSTATS + DPAA_NB_RX_DEMUX_XSTATS)
+
 /* define a variable to hold the portal_key, once created.*/
 static pthread_key_t dpaa_portal_key;
 
+static int dpaa_mbuf_acquire(void *ctx, void **obj_table, unsigned int num);
+static void dpaa_mbuf_release(void *ctx, void * const *obj_table,
+			      unsigned int num);
+
 static int dpaa_mbuf_create_pool(struct rte_mempool *mp)
 {
 	struct bman_pool *bp;
@@ -118,6 +150,16 @@ static int dpaa_mbuf_create_pool(struct rte_mempool *mp)
 		sizeof(struct rte_mbuf) + rte_pktmbuf_priv_size(mp);
 	mp->pool_data = (void *)&dpaa_pool_table[bpid];
 
+	/* FMan RX takes its buffers from the pool, the stashes keep
+	 * no more than 3/4 of RTE_LIBRTE_DPAA_BM_STASH_SIZE each.
+	 */
+	ret = bm_stash_pool_init(&dpaa_pool_table[bpid].stash,
+				 &dpaa_pool_table[bpid], dpaa_mbuf_acquire,
+				 dpaa_mbuf_release, DPAA_MBUF_MAX_ACQ_REL,
+				 RTE_LIBRTE_DPAA_BM_STASH_SIZE);
+	if (ret)
+		PMD_DRV_LOG(WARNING, "No buffer stash for bpid =%d", bpid);
+
 	/* TODO: Replace with mp->pool_data->flags after creating appropriate
 	 * pool_data structure
 	 */
@@ -134,39 +176,101 @@ void dpaa_mbuf_free_pool(struct rte_mempool *mp)
 
 	PMD_INIT_FUNC_TRACE();
 
+	bm_stash_pool_fini(&bp_info->stash);
 	bman_free_pool(bp_info->bp);
 	PMD_DRV_LOG(INFO, "BMAN pool freed for bpid =%d", bp_info->bpid);
 	return;
 }
 
-static
-int dpaa_mbuf_free_bulk(struct rte_mempool *pool,
-		void *const *obj_table,
-		unsigned n)
+/* Release 'num' (up to 8) buffers in a single command */
+static void dpaa_mbuf_release(void *ctx, void * const *obj_table,
+			      unsigned int num)
 {
-	struct pool_info_entry *bp_info = DPAA_MEMPOOL_TO_POOL_INFO(pool);
+	struct pool_info_entry *bp_info = ctx;
+	struct bm_buffer bufs[DPAA_MBUF_MAX_ACQ_REL];
+	unsigned int i;
 	int ret;
-	unsigned i = 0;
-
-	PMD_TX_FREE_LOG(DEBUG, " Request to free %d buffers in bpid = %d",
-		    n, bp_info->bpid);
 
 	if (!RTE_PER_LCORE(_dpaa_io)) {
 		ret = dpaa_portal_init((void *)0);
 		if (ret) {
 			PMD_DRV_LOG(ERR, "dpaa_portal_init failed "
 				"with ret: %d", ret);
-			return 0;
+			return;
 		}
 	}
 
-	while (i < n) {
-		dpaa_buf_free(bp_info,
-			      (uint64_t)rte_mempool_virt2phy(pool, obj_table[i])
+	for (i = 0; i < num; i++)
+		bm_buffer_set64(&bufs[i],
+				(uint64_t)rte_mempool_virt2phy(bp_info->mp,
+							       obj_table[i])
 				+ bp_info->meta_data_size);
-		i = i + 1;
+	while (bman_release(bp_info->bp, bufs, num, 0)) {
+		PMD_TX_LOG(DEBUG, " BMAN busy. Retrying...");
+		cpu_spin(CPU_SPIN_BACKOFF_CYCLES);
+	}
+}
+
+/* Acquire exactly 'num' (up to 8) buffers in a single command */
+static int dpaa_mbuf_acquire(void *ctx, void **obj_table, unsigned int num)
+{
+	struct rte_mbuf **m = (struct rte_mbuf **)obj_table;
+	struct pool_info_entry *bp_info = ctx;
+	struct bm_buffer bufs[DPAA_MBUF_MAX_ACQ_REL];
+	void *bufaddr;
+	unsigned int i;
+	int ret;
+
+	if (!RTE_PER_LCORE(_dpaa_io)) {
+		ret = dpaa_portal_init((void *)0);
+		if (ret) {
+			PMD_DRV_LOG(ERR, "dpaa_portal_init failed with "
+				"ret: %d", ret);
+			return -1;
+		}
 	}
 
+	/* In case of less than requested number of buffers available
+	 * in pool, bman_acquire returns 0
+	 */
+	ret = bman_acquire(bp_info->bp, bufs, num, 0);
+	if (ret <= 0) {
+		PMD_RX_LOG(DEBUG, "Buffer acquire failed with "
+			   "err code: %d", ret);
+		return ret;
+	}
+	/* assigning mbuf from the acquired objects */
+	for (i = 0; i < num; i++) {
+		/* TODO-errata - objerved that bufs may be null
+		i.e. first buffer is valid, remaining 6 buffers may be null */
+		if (unlikely(!bufs[i].addr)) {
+			if (i)
+				dpaa_mbuf_release(bp_info, obj_table, i);
+			return 0;
+		}
+		bufaddr = (void *)dpaa_mem_ptov(bufs[i].addr);
+		m[i] = (struct rte_mbuf *)((char *)bufaddr
+					- bp_info->meta_data_size);
+		rte_mbuf_refcnt_set(m[i], 0);
+		PMD_DRV_LOG2(DEBUG, "Acquired %p address %p from BMAN",
+			    (void *)bufaddr, (void *)m[i]);
+	}
+	return num;
+}
+
+static
+int dpaa_mbuf_free_bulk(struct rte_mempool *pool,
+		void *const *obj_table,
+		unsigned n)
+{
+	struct pool_info_entry *bp_info = DPAA_MEMPOOL_TO_POOL_INFO(pool);
+
+	PMD_TX_FREE_LOG(DEBUG, " Request to free %d buffers in bpid = %d",
+		    n, bp_info->bpid);
+
+	/* Kept by the stash of the lcore, or released to BMAN in 8s */
+	bm_stash_put(&bp_info->stash, obj_table, n);
+
 	PMD_TX_FREE_LOG(DEBUG, " freed %d buffers in bpid =%d",
 		    n, bp_info->bpid);
 
@@ -178,12 +282,7 @@ int dpaa_mbuf_alloc_bulk(struct rte_mempool *pool,
 		void **obj_table,
 		unsigned count)
 {
-	struct rte_mbuf **m = (struct rte_mbuf **)obj_table;
-	struct bm_buffer bufs[DPAA_MBUF_MAX_ACQ_REL];
 	struct pool_info_entry *bp_info;
-	void *bufaddr;
-	int i, ret;
-	unsigned n = 0;
 
 	bp_info = DPAA_MEMPOOL_TO_POOL_INFO(pool);
 
@@ -196,52 +295,17 @@ int dpaa_mbuf_alloc_bulk(struct rte_mempool *pool,
 		return -1;
 	}
 
-	if (!RTE_PER_LCORE(_dpaa_io)) {
-		ret = dpaa_portal_init((void *)0);
-		if (ret) {
-			PMD_DRV_LOG(ERR, "dpaa_portal_init failed with "
-				"ret: %d", ret);
-			return 0;
-		}
-	}
-
-	while (n < count) {
-		/* Acquire is all-or-nothing, so we drain in 7s,
-		 * then the remainder.
-		 */
-		if ((count - n) > DPAA_MBUF_MAX_ACQ_REL) {
-			ret = bman_acquire(bp_info->bp, bufs,
-				DPAA_MBUF_MAX_ACQ_REL, 0);
-		} else {
-			ret = bman_acquire(bp_info->bp, bufs, count - n, 0);
-		}
-		/* In case of less than requested number of buffers available
-		 * in pool, qbman_swp_acquire returns 0
-		 */
-		if (ret <= 0) {
-			PMD_DRV_LOG(ERR, "Buffer acquire failed with"
-				    "err code: %d", ret);
-			/* The API expect the exact number of requested buffers */
-			/* Releasing all buffers allocated */
-			dpaa_mbuf_free_bulk(pool, obj_table, n);
-			return -1;
-		}
-		/* assigning mbuf from the acquired objects */
-		for (i = 0; (i < ret) && bufs[i].addr; i++) {
-			/* TODO-errata - objerved that bufs may be null
-			i.e. first buffer is valid, remaining 6 buffers may be null */
-			bufaddr = (void *)dpaa_mem_ptov(bufs[i].addr);
-			m[n] = (struct rte_mbuf *)((char *)bufaddr
-						- bp_info->meta_data_size);
-			rte_mbuf_refcnt_set(m[n], 0);
-			PMD_DRV_LOG2(DEBUG, "Acquired %p address %p from BMAN",
-				    (void *)bufaddr, (void *)m[n]);
-			n++;
-		}
+	/* The API expect the exact number of requested buffers, the stash
+	 * of the lcore is refilled from BMAN in 8s.
+	 */
+	if (bm_stash_get(&bp_info->stash, obj_table, count)) {
+		PMD_DRV_LOG(ERR, "Buffer acquire failed for %u buffers",
+			    count);
+		return -1;
 	}
 
 	PMD_RX_LOG(DEBUG, " allocated %d buffers from bpid =%d",
-		    n, bp_info->bpid);
+		    count, bp_info->bpid);
 	return 0;
 }
 
@@ -490,19 +554,34 @@ static const uint32_t *
 dpaa_supported_ptypes_get(struct rte_eth_dev *dev)
 {
 	static const uint32_t ptypes[] = {
-		/*todo -= add more types */
 		RTE_PTYPE_L2_ETHER,
 		RTE_PTYPE_L3_IPV4,
+		RTE_PTYPE_L3_IPV4_EXT,
 		RTE_PTYPE_L3_IPV6,
 		RTE_PTYPE_L3_IPV6_EXT,
 		RTE_PTYPE_L4_TCP,
 		RTE_PTYPE_L4_UDP,
-		RTE_PTYPE_L4_SCTP
+		RTE_PTYPE_L4_SCTP,
+		RTE_PTYPE_L4_FRAG,
+		RTE_PTYPE_L4_NONFRAG,
+		RTE_PTYPE_TUNNEL_IP,
+		RTE_PTYPE_TUNNEL_GRE,
+		RTE_PTYPE_TUNNEL_VXLAN,
+		RTE_PTYPE_INNER_L2_ETHER,
+		RTE_PTYPE_INNER_L3_IPV4,
+		RTE_PTYPE_INNER_L3_IPV6,
+		RTE_PTYPE_INNER_L4_TCP,
+		RTE_PTYPE_INNER_L4_UDP,
+		RTE_PTYPE_INNER_L4_SCTP,
+		RTE_PTYPE_INNER_L4_FRAG,
+		RTE_PTYPE_INNER_L4_NONFRAG,
+		RTE_PTYPE_UNKNOWN
 	};
 
 	PMD_INIT_FUNC_TRACE();
 
-	if (dev->rx_pkt_burst == dpaa_eth_queue_rx)
+	if (dev->rx_pkt_burst == dpaa_eth_queue_rx ||
+	    dev->rx_pkt_burst == dpaa_eth_queue_push_rx)
 		return ptypes;
 	return NULL;
 }
@@ -523,18 +602,34 @@ static int dpaa_eth_dev_start(struct rte_eth_dev *dev)
 static void dpaa_eth_dev_stop(struct rte_eth_dev *dev)
 {
 	struct dpaa_if *dpaa_intf = dev->data->dev_private;
+	unsigned int i;
 
 	PMD_INIT_FUNC_TRACE();
 
 	fman_if_disable_rx(dpaa_intf->fif);
 	dev->tx_pkt_burst = dpaa_eth_tx_drop_all;
+
+	/* Take the push mode Rx FQs back from the portals of the lcores */
+	for (i = 0; dpaa_intf->rx_demux && i < dpaa_intf->nb_rx_queues; i++) {
+		dpaa_rx_queue_push_release(&dpaa_intf->rx_queues[i],
+					   &dpaa_intf->rx_demux[i]);
+		rx_demux_queue_flush(&dpaa_intf->rx_demux[i]);
+	}
 }
 
 static void dpaa_eth_dev_close(struct rte_eth_dev *dev)
 {
+	struct dpaa_if *dpaa_intf = dev->data->dev_private;
+
 	PMD_INIT_FUNC_TRACE();
 
 	dpaa_eth_dev_stop(dev);
+
+	if (dpaa_intf->rx_demux) {
+		dev->rx_pkt_burst = dpaa_eth_queue_rx;
+		rte_free(dpaa_intf->rx_demux);
+		dpaa_intf->rx_demux = NULL;
+	}
 }
 
 static void dpaa_eth_dev_info(struct rte_eth_dev *dev,
@@ -604,6 +699,58 @@ static void dpaa_eth_stats_reset(struct rte_eth_dev *dev)
 	fman_if_stats_reset(dpaa_intf->fif);
 }
 
+static int dpaa_eth_xstats_get(struct rte_eth_dev *dev,
+			       struct rte_eth_xstat *xstats, unsigned int n)
+{
+	struct dpaa_if *dpaa_intf = dev->data->dev_private;
+	struct bm_stash_stats stats;
+	struct rx_demux_stats rx_stats;
+	unsigned int i;
+
+	if (n < DPAA_NB_XSTATS || !xstats)
+		return DPAA_NB_XSTATS;
+
+	memset(&stats, 0, sizeof(stats));
+	if (dpaa_intf->bp_info)
+		bm_stash_stats_get(&dpaa_intf->bp_info->stash, &stats);
+	for (i = 0; i < DPAA_NB_BM_STASH_XSTATS; i++)
+		xstats[i].value = *(uint64_t *)((char *)&stats +
+				dpaa_bm_stash_strings[i].offset);
+
+	memset(&rx_stats, 0, sizeof(rx_stats));
+	for (i = 0; dpaa_intf->rx_demux && i < dpaa_intf->nb_rx_queues; i++) {
+		rx_stats.polls += dpaa_intf->rx_demux[i].stats.polls;
+		rx_stats.backlogged += dpaa_intf->rx_demux[i].stats.backlogged;
+		rx_stats.drops += dpaa_intf->rx_demux[i].stats.drops;
+	}
+	for (i = 0; i < DPAA_NB_RX_DEMUX_XSTATS; i++)
+		xstats[DPAA_NB_BM_STASH_XSTATS + i].value =
+			*(uint64_t *)((char *)&rx_stats +
+				      dpaa_rx_demux_strings[i].offset);
+
+	return DPAA_NB_XSTATS;
+}
+
+static int dpaa_eth_xstats_get_names(struct rte_eth_dev *dev __rte_unused,
+				     struct rte_eth_xstat_name *xstats_names,
+				     unsigned int limit)
+{
+	unsigned int i;
+
+	if (limit < DPAA_NB_XSTATS || !xstats_names)
+		return DPAA_NB_XSTATS;
+
+	for (i = 0; i < DPAA_NB_BM_STASH_XSTATS; i++)
+		snprintf(xstats_names[i].name, sizeof(xstats_names[i].name),
+			 "%s", dpaa_bm_stash_strings[i].name);
+	for (i = 0; i < DPAA_NB_RX_DEMUX_XSTATS; i++)
+		snprintf(xstats_names[DPAA_NB_BM_STASH_XSTATS + i].name,
+			 sizeof(xstats_names[0].name),
+			 "%s", dpaa_rx_demux_strings[i].name);
+
+	return DPAA_NB_XSTATS;
+}
+
 static void dpaa_eth_promiscuous_enable(struct rte_eth_dev *dev)
 {
 	struct dpaa_if *dpaa_intf = dev->data->dev_private;
@@ -813,6 +960,8 @@ static struct eth_dev_ops dpaa_devops = {
 	.link_update		  = dpaa_eth_link_update,
 	.stats_get		  = dpaa_eth_stats_get,
 	.stats_reset		  = dpaa_eth_stats_reset,
+	.xstats_get		  = dpaa_eth_xstats_get,
+	.xstats_get_names	  = dpaa_eth_xstats_get_names,
 	.promiscuous_enable	  = dpaa_eth_promiscuous_enable,
 	.promiscuous_disable	  = dpaa_eth_promiscuous_disable,
 	.mtu_set		  = dpaa_mtu_set,
@@ -847,6 +996,23 @@ static int dpaa_fc_set_default(struct dpaa_if *dpaa_intf)
 	return 0;
  }
 
+/* Destination and stashing of the Rx FQs */
+static void dpaa_rx_queue_opts(struct qm_mcc_initfq *opts)
+{
+	memset(opts, 0, sizeof(*opts));
+	opts->we_mask = QM_INITFQ_WE_DESTWQ | QM_INITFQ_WE_FQCTRL |
+			QM_INITFQ_WE_CONTEXTA;
+
+	opts->fqd.dest.wq = DPAA_IF_RX_PRIORITY;
+	opts->fqd.fq_ctrl = QM_FQCTRL_AVOIDBLOCK | QM_FQCTRL_CTXASTASHING |
+			    QM_FQCTRL_PREFERINCACHE;
+	opts->fqd.context_a.stashing.exclusive = 0;
+	opts->fqd.context_a.stashing.annotation_cl =
+		DPAA_IF_RX_ANNOTATION_STASH;
+	opts->fqd.context_a.stashing.data_cl = DPAA_IF_RX_DATA_STASH;
+	opts->fqd.context_a.stashing.context_cl = DPAA_IF_RX_CONTEXT_STASH;
+}
+
 /* Initialise an Rx FQ */
 static int dpaa_rx_queue_init(struct qman_fq *fq,
 			      uint32_t fqid)
@@ -870,16 +1036,7 @@ static int dpaa_rx_queue_init(struct qman_fq *fq,
 		return ret;
 	}
 
-	opts.we_mask = QM_INITFQ_WE_DESTWQ | QM_INITFQ_WE_FQCTRL |
-		       QM_INITFQ_WE_CONTEXTA;
-
-	opts.fqd.dest.wq = DPAA_IF_RX_PRIORITY;
-	opts.fqd.fq_ctrl = QM_FQCTRL_AVOIDBLOCK | QM_FQCTRL_CTXASTASHING |
-			   QM_FQCTRL_PREFERINCACHE;
-	opts.fqd.context_a.stashing.exclusive = 0;
-	opts.fqd.context_a.stashing.annotation_cl = DPAA_IF_RX_ANNOTATION_STASH;
-	opts.fqd.context_a.stashing.data_cl = DPAA_IF_RX_DATA_STASH;
-	opts.fqd.context_a.stashing.context_cl = DPAA_IF_RX_CONTEXT_STASH;
+	dpaa_rx_queue_opts(&opts);
 	ret = qman_init_fq(fq, 0, &opts);
 	if (ret)
 		PMD_DRV_LOG(ERR, "init rx fqid %d failed with ret: %d",
@@ -887,6 +1044,68 @@ static int dpaa_rx_queue_init(struct qman_fq *fq,
 	return ret;
 }
 
+/* Schedule a parked Rx FQ to the dedicated channel of the portal of the
+ * calling lcore, which has it in its static dequeue command already.
+ */
+int dpaa_rx_queue_push_init(struct qman_fq *fq)
+{
+	struct qm_mcc_initfq opts;
+	int ret;
+
+	dpaa_rx_queue_opts(&opts);
+	ret = qman_init_fq(fq, QMAN_INITFQ_FLAG_SCHED | QMAN_INITFQ_FLAG_LOCAL,
+			   &opts);
+	if (ret)
+		PMD_DRV_LOG(ERR, "schedule rx fqid %d failed with ret: %d",
+			fq->fqid, ret);
+	return ret;
+}
+
+/* Take back a push mode Rx FQ from the portal it is scheduled to: retire
+ * it, drain it and park it again for the next lcore receiving from it.
+ * The lcores must no longer receive from it.
+ */
+void dpaa_rx_queue_push_release(struct qman_fq *fq,
+				struct rx_demux_queue *rxq)
+{
+	struct rte_mbuf *bufs[DPAA_RX_DRAIN_BURST];
+	struct qm_mcc_initfq opts;
+	uint16_t i, n;
+	u32 flags;
+	int ret;
+
+	if (rx_demux_queue_owner(rxq) == LCORE_ID_ANY)
+		return;
+
+	fq->cb.dqrr = dpaa_rx_drop_cb;
+	ret = qman_retire_fq(fq, &flags);
+	if (ret) {
+		/* Retired once the portal of the owner dequeued its frames */
+		PMD_DRV_LOG(WARNING, "rx fqid %d not retired (%d), left to "
+			    "lcore %u", fq->fqid, ret,
+			    rx_demux_queue_owner(rxq));
+		return;
+	}
+
+	do {
+		n = dpaa_eth_queue_rx(fq, bufs, DPAA_RX_DRAIN_BURST);
+		for (i = 0; i < n; i++)
+			rte_pktmbuf_free(bufs[i]);
+	} while (n);
+
+	ret = qman_oos_fq(fq);
+	if (!ret) {
+		dpaa_rx_queue_opts(&opts);
+		ret = qman_init_fq(fq, 0, &opts);
+	}
+	if (ret) {
+		PMD_DRV_LOG(ERR, "park rx fqid %d failed with ret: %d",
+			fq->fqid, ret);
+		return;
+	}
+	rx_demux_queue_unclaim(rxq);
+}
+
 /* Initialise a Tx FQ */
 static int dpaa_tx_queue_init(struct qman_fq *fq,
 			      struct fman_if *fman_intf)
@@ -964,6 +1183,9 @@ static int dpaa_eth_dev_init(struct rte_eth_dev *eth_dev)
 
 	PMD_INIT_FUNC_TRACE();
 
+	/* Same table for all the interfaces, building it again is harmless */
+	dpaa_ptype_tbl_init(&dpaa_ptype_tbl);
+
 	/* give the interface a name */
 	sprintf(dpaa_intf->name, "fm%d-gb%d",
 		(fman_intf->fman_idx + 1), fman_intf->mac_idx);
@@ -1001,6 +1223,19 @@ static int dpaa_eth_dev_init(struct rte_eth_dev *eth_dev)
 	}
 	dpaa_intf->nb_rx_queues = num_rx_fqs;
 
+	/* In push mode, the Rx FQs are scheduled to the portal of the lcore
+	 * receiving from them, and are dequeued together.
+	 */
+	if (getenv("DPAA_PUSH_RX") && atoi(getenv("DPAA_PUSH_RX"))) {
+		dpaa_intf->rx_demux = rte_zmalloc(NULL,
+			sizeof(struct rx_demux_queue) * num_rx_fqs,
+			RTE_CACHE_LINE_SIZE);
+		if (!dpaa_intf->rx_demux)
+			return -ENOMEM;
+		for (loop = 0; loop < num_rx_fqs; loop++)
+			rx_demux_queue_init(&dpaa_intf->rx_demux[loop]);
+	}
+
 	/* Initialise Tx FQs. Have as many Tx FQ's as number of cores */
 	num_cores = rte_lcore_count();
 	dpaa_intf->tx_queues = rte_zmalloc(NULL, sizeof(struct qman_fq) *
@@ -1040,7 +1275,10 @@ static int dpaa_eth_dev_init(struct rte_eth_dev *eth_dev)
 	eth_dev->dev_ops = &dpaa_devops;
 	eth_dev->data->nb_rx_queues = dpaa_intf->nb_rx_queues;
 	eth_dev->data->nb_tx_queues = dpaa_intf->nb_tx_queues;
-	eth_dev->rx_pkt_burst = dpaa_eth_queue_rx;
+	if (dpaa_intf->rx_demux)
+		eth_dev->rx_pkt_burst = dpaa_eth_queue_push_rx;
+	else
+		eth_dev->rx_pkt_burst = dpaa_eth_queue_rx;
 	eth_dev->tx_pkt_burst = dpaa_eth_tx_drop_all;
 	eth_dev->data->mac_addrs = (struct ether_addr *)dpaa_intf->mac_addr;
 
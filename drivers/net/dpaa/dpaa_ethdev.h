@@ -44,6 +44,9 @@
 #include <usdpaa/of.h>
 #include <usdpaa/usdpaa_netcfg.h>
 
+#include <bpool/bm_stash.h>
+#include <rx_demux.h>
+
 #define FSL_CLASS_ID		0
 #define FSL_VENDOR_ID		0x1957
 #define FSL_DEVICE_ID		0x410	 /* custom */
@@ -84,6 +87,11 @@
 /* Maximum release/acquire from BMAN */
 #define DPAA_MBUF_MAX_ACQ_REL  8
 
+/* Capacity of the per lcore stash of buffers of the pools */
+#ifndef RTE_LIBRTE_DPAA_BM_STASH_SIZE
+#define RTE_LIBRTE_DPAA_BM_STASH_SIZE	64
+#endif
+
 /*Maximum number of slots available in TX ring*/
 #define MAX_TX_RING_SLOTS	8
 
@@ -96,6 +104,9 @@
 #define DPAA_IF_RX_PRIORITY		4
 #define DPAA_IF_DEBUG_PRIORITY		7
 
+/* Frames per volatile dequeue when draining a retired Rx FQ */
+#define DPAA_RX_DRAIN_BURST		32
+
 #define DPAA_IF_RX_ANNOTATION_STASH	1
 #define DPAA_IF_RX_DATA_STASH		1
 #define DPAA_IF_RX_CONTEXT_STASH		0
@@ -125,6 +136,7 @@ struct pool_info_entry {
 	uint32_t bpid;
 	uint32_t size;
 	uint32_t meta_data_size;
+	struct bm_stash_pool stash;
 };
 
 /* Each network interface is represented by one of these */
@@ -134,6 +146,8 @@ struct dpaa_if {
 	char mac_addr[ETHER_ADDR_LEN];
 	const struct fm_eth_port_cfg *cfg;
 	struct qman_fq *rx_queues;
+	/** Backlogs of the Rx queues, in push mode only */
+	struct rx_demux_queue *rx_demux;
 	struct qman_fq *tx_queues;
 	struct qman_fq debug_queues[2];
 	uint16_t nb_rx_queues;
@@ -180,6 +194,11 @@ static inline void *dpaa_mem_ptov(phys_addr_t paddr)
 
 int dpaa_portal_init(void *arg);
 
+int dpaa_rx_queue_push_init(struct qman_fq *fq);
+
+void dpaa_rx_queue_push_release(struct qman_fq *fq,
+				struct rx_demux_queue *rxq);
+
 int dpaa_pre_rte_eal_init(void);
 
 #endif
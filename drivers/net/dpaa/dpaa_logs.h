@@ -73,6 +73,11 @@
 #define PMD_DRV_LOG(level, fmt, args...) \
 	PMD_DRV_LOG_RAW(level, fmt "\n", ## args)
 
+/* for errors which can be repeated from the data path: at most 10 per s */
+#define PMD_DRV_LOG_RATELIMIT(level, fmt, args...) \
+	RTE_LOG_RATELIMIT(level, PMD, 1000, 10, "%s(): " fmt "\n", \
+			  __func__, ## args)
+
 #ifdef RTE_LIBRTE_DPAA_DEBUG_DRIVER_DISPLAY
 #define PMD_DRV_LOG2(level, fmt, args...) \
 	RTE_LOG(level, PMD, "%s(): " fmt, __func__, ## args)
@@ -0,0 +1,316 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2017 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __DPAA_PTYPE_H__
+#define __DPAA_PTYPE_H__
+
+/**
+ * @file
+ *
+ * FMan parse results to mbuf packet type, offload flags and header lengths.
+ *
+ * The parse result bits that matter are folded into two indexes: one of the
+ * L2/L3 results, one of the L4 results and error bits. Each selects an entry
+ * of a table built once at init, so that a frame costs two table loads and
+ * no branch on its type.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <rte_byteorder.h>
+#include <rte_mbuf.h>
+
+/**
+ * FMan parse result array
+ */
+struct dpaa_eth_parse_results_t {
+	 uint8_t     lpid;		 /**< Logical port id */
+	 uint8_t     shimr;		 /**< Shim header result  */
+	 uint16_t    l2r;		 /**< Layer 2 result */
+	 uint16_t    l3r;		 /**< Layer 3 result */
+	 uint8_t     l4r;		 /**< Layer 4 result */
+	 uint8_t     cplan;		 /**< Classification plan id */
+	 uint16_t    nxthdr;		 /**< Next Header  */
+	 uint16_t    cksum;		 /**< Checksum */
+	 uint32_t    lcv;		 /**< LCV */
+	 uint8_t     shim_off[3];	 /**< Shim offset */
+	 uint8_t     eth_off;		 /**< ETH offset */
+	 uint8_t     llc_snap_off;	 /**< LLC_SNAP offset */
+	 uint8_t     vlan_off[2];	 /**< VLAN offset */
+	 uint8_t     etype_off;		 /**< ETYPE offset */
+	 uint8_t     pppoe_off;		 /**< PPP offset */
+	 uint8_t     mpls_off[2];	 /**< MPLS offset */
+	 uint8_t     ip_off[2];		 /**< IP offset */
+	 uint8_t     gre_off;		 /**< GRE offset */
+	 uint8_t     l4_off;		 /**< Layer 4 offset */
+	 uint8_t     nxthdr_off;	 /**< Parser end point */
+} __attribute__ ((__packed__));
+
+/*
+ * Parse result bits used, L2R and L3R in CPU order:
+ *	L2R 0x8000 - Ethernet	0x4000 - VLAN		0x0100 - QinQ
+ *	L3R 0x8000 - IPv4	0x4000 - IPv6		0x2000 - GRE
+ *	    0x0800 - last IPv4	0x0400 - last IPv6	0x0200 - IP error
+ *	    0x0100 - IP options	0x0040 - fragment	0x0004 - last fragment
+ *	L4R 0xe0 - type (1 TCP, 2 UDP, 3 IPsec, 4 SCTP)	0x10 - L4 error
+ * The last IP bits are set for a second IP header only, ie. a tunnel.
+ */
+#define DPAA_PRS_L2R_ETH	0x8000
+#define DPAA_PRS_L2R_VLAN	0x4000
+#define DPAA_PRS_L2R_QINQ	0x0100
+#define DPAA_PRS_L3R_IPV4	0x8000
+#define DPAA_PRS_L3R_IPV6	0x4000
+#define DPAA_PRS_L3R_GRE	0x2000
+#define DPAA_PRS_L3R_LAST_IPV4	0x0800
+#define DPAA_PRS_L3R_LAST_IPV6	0x0400
+#define DPAA_PRS_L3R_ERR	0x0200
+#define DPAA_PRS_L3R_OPT	0x0100
+#define DPAA_PRS_L3R_FRAG	0x0040
+#define DPAA_PRS_L3R_LAST_FRAG	0x0004
+#define DPAA_PRS_L4R_TYPE	0xe0
+#define DPAA_PRS_L4R_ERR	0x10
+#define DPAA_PRS_L4R_TCP	1
+#define DPAA_PRS_L4R_UDP	2
+#define DPAA_PRS_L4R_SCTP	4
+
+/* L2/L3 index: the high byte of L3R, Ethernet, VLAN and QinQ in its holes */
+#define DPAA_PTYPE_L3_IDX_ETH	0x002
+#define DPAA_PTYPE_L3_IDX_QINQ	0x010
+#define DPAA_PTYPE_L3_IDX_VLAN	0x100
+#define DPAA_PTYPE_L3_NB	0x200
+
+/* L4 index: L4R type and error, IP error, fragment */
+#define DPAA_PTYPE_L4_IDX_L4ERR	0x01
+#define DPAA_PTYPE_L4_IDX_L3ERR	0x10
+#define DPAA_PTYPE_L4_IDX_FRAG	0x20
+#define DPAA_PTYPE_L4_NB	0x40
+
+/* L4 rows: no IP, L4 of the only IP header, L4 of the tunneled one */
+enum {
+	DPAA_PTYPE_L4_NONE,
+	DPAA_PTYPE_L4_OUTER,
+	DPAA_PTYPE_L4_INNER,
+	DPAA_PTYPE_L4_ROWS
+};
+
+/* VXLAN isn't parsed by FMan, UDP frames to its port are */
+#define DPAA_VXLAN_UDP_PORT	4789
+
+struct dpaa_ptype_l3 {
+	uint32_t packet_type;
+	uint16_t ol_flags;
+	/** Parse result offset of the end of the L3 header, 0 for none */
+	uint8_t l3_end;
+	uint8_t l4_row;
+};
+
+struct dpaa_ptype_l4 {
+	uint32_t packet_type;
+	uint16_t ol_flags;
+	uint16_t reserved;
+};
+
+struct dpaa_ptype_tbl {
+	struct dpaa_ptype_l3 l3[DPAA_PTYPE_L3_NB];
+	struct dpaa_ptype_l4 l4[DPAA_PTYPE_L4_ROWS][DPAA_PTYPE_L4_NB];
+};
+
+extern struct dpaa_ptype_tbl dpaa_ptype_tbl;
+
+static inline unsigned int
+dpaa_ptype_l3_idx(uint16_t l2r, uint16_t l3r)
+{
+	return ((l3r >> 8) & ~(DPAA_PRS_L3R_ERR >> 8) &
+		~(DPAA_PTYPE_L3_IDX_ETH | DPAA_PTYPE_L3_IDX_QINQ)) |
+	       ((l2r >> 14) & DPAA_PTYPE_L3_IDX_ETH) |
+	       ((l2r >> 4) & DPAA_PTYPE_L3_IDX_QINQ) |
+	       ((l2r >> 6) & DPAA_PTYPE_L3_IDX_VLAN);
+}
+
+static inline unsigned int
+dpaa_ptype_l4_idx(uint16_t l3r, uint8_t l4r)
+{
+	return ((l4r >> 4) & 0xf) |
+	       ((l3r >> 5) & DPAA_PTYPE_L4_IDX_L3ERR) |
+	       (((l3r >> 1) | (l3r << 3)) & DPAA_PTYPE_L4_IDX_FRAG);
+}
+
+static inline void
+dpaa_ptype_l3_init(struct dpaa_ptype_l3 *e, unsigned int idx)
+{
+	uint16_t l3r = idx << 8;
+	uint32_t ptype;
+	int tunnel;
+
+	memset(e, 0, sizeof(*e));
+	if (!(idx & DPAA_PTYPE_L3_IDX_ETH))
+		return;
+
+	ptype = RTE_PTYPE_L2_ETHER;
+	/* The tags are not stripped, PKT_RX_QINQ_PKT would report so */
+	if (idx & (DPAA_PTYPE_L3_IDX_VLAN | DPAA_PTYPE_L3_IDX_QINQ))
+		e->ol_flags = PKT_RX_VLAN_PKT;
+
+	if (l3r & DPAA_PRS_L3R_IPV4)
+		ptype |= (l3r & DPAA_PRS_L3R_OPT) ?
+			 RTE_PTYPE_L3_IPV4_EXT : RTE_PTYPE_L3_IPV4;
+	else if (l3r & DPAA_PRS_L3R_IPV6)
+		ptype |= (l3r & DPAA_PRS_L3R_OPT) ?
+			 RTE_PTYPE_L3_IPV6_EXT : RTE_PTYPE_L3_IPV6;
+	else
+		goto done;
+
+	tunnel = l3r & (DPAA_PRS_L3R_LAST_IPV4 | DPAA_PRS_L3R_LAST_IPV6);
+	if (tunnel) {
+		ptype |= (l3r & DPAA_PRS_L3R_GRE) ?
+			 RTE_PTYPE_TUNNEL_GRE : RTE_PTYPE_TUNNEL_IP;
+		ptype |= (l3r & DPAA_PRS_L3R_LAST_IPV4) ?
+			 RTE_PTYPE_INNER_L3_IPV4 : RTE_PTYPE_INNER_L3_IPV6;
+		e->l3_end = (l3r & DPAA_PRS_L3R_GRE) ?
+			offsetof(struct dpaa_eth_parse_results_t, gre_off) :
+			offsetof(struct dpaa_eth_parse_results_t, ip_off[1]);
+		e->l4_row = DPAA_PTYPE_L4_INNER;
+	} else if (l3r & DPAA_PRS_L3R_GRE) {
+		ptype |= RTE_PTYPE_TUNNEL_GRE;
+		e->l3_end = offsetof(struct dpaa_eth_parse_results_t, gre_off);
+		e->l4_row = DPAA_PTYPE_L4_OUTER;
+	} else {
+		e->l3_end = offsetof(struct dpaa_eth_parse_results_t, l4_off);
+		e->l4_row = DPAA_PTYPE_L4_OUTER;
+	}
+done:
+	e->packet_type = ptype;
+}
+
+static inline void
+dpaa_ptype_l4_init(struct dpaa_ptype_l4 *e, unsigned int row,
+		   unsigned int idx)
+{
+	uint32_t ptype;
+	int l4 = 1;
+
+	memset(e, 0, sizeof(*e));
+	if (row == DPAA_PTYPE_L4_NONE)
+		return;
+
+	if (idx & DPAA_PTYPE_L4_IDX_L3ERR)
+		e->ol_flags |= PKT_RX_IP_CKSUM_BAD;
+	if (idx & DPAA_PTYPE_L4_IDX_FRAG) {
+		ptype = RTE_PTYPE_L4_FRAG;
+		l4 = 0;
+	} else {
+		switch ((idx >> 1) & 0x7) {
+		case DPAA_PRS_L4R_TCP:
+			ptype = RTE_PTYPE_L4_TCP;
+			break;
+		case DPAA_PRS_L4R_UDP:
+			ptype = RTE_PTYPE_L4_UDP;
+			break;
+		case DPAA_PRS_L4R_SCTP:
+			ptype = RTE_PTYPE_L4_SCTP;
+			break;
+		default:
+			ptype = RTE_PTYPE_L4_NONFRAG;
+			l4 = 0;
+			break;
+		}
+	}
+	if (l4 && (idx & DPAA_PTYPE_L4_IDX_L4ERR))
+		e->ol_flags |= PKT_RX_L4_CKSUM_BAD;
+
+	/* Inner L4 types are the outer ones shifted to their field */
+	if (row == DPAA_PTYPE_L4_INNER)
+		ptype <<= 16;
+	e->packet_type = ptype;
+}
+
+/** Build the tables */
+static inline void
+dpaa_ptype_tbl_init(struct dpaa_ptype_tbl *tbl)
+{
+	unsigned int i, row;
+
+	for (i = 0; i < DPAA_PTYPE_L3_NB; i++)
+		dpaa_ptype_l3_init(&tbl->l3[i], i);
+	for (row = 0; row < DPAA_PTYPE_L4_ROWS; row++)
+		for (i = 0; i < DPAA_PTYPE_L4_NB; i++)
+			dpaa_ptype_l4_init(&tbl->l4[row][i], row, i);
+}
+
+/**
+ * Set the packet type, offload flags and L2/L3 lengths of a received frame.
+ *
+ * @param prs
+ *   The parse results of the frame.
+ * @param data
+ *   The frame, whose UDP header is read to find VXLAN.
+ */
+static inline void
+dpaa_ptype_lookup(const struct dpaa_ptype_tbl *tbl,
+		  const struct dpaa_eth_parse_results_t *prs,
+		  const uint8_t *data, struct rte_mbuf *m)
+{
+	uint16_t l2r = rte_be_to_cpu_16(prs->l2r);
+	uint16_t l3r = rte_be_to_cpu_16(prs->l3r);
+	const struct dpaa_ptype_l3 *l3;
+	const struct dpaa_ptype_l4 *l4;
+	const uint8_t *udp;
+	uint32_t ptype;
+
+	l3 = &tbl->l3[dpaa_ptype_l3_idx(l2r, l3r)];
+	l4 = &tbl->l4[l3->l4_row][dpaa_ptype_l4_idx(l3r, prs->l4r)];
+
+	ptype = l3->packet_type | l4->packet_type;
+	m->ol_flags |= l3->ol_flags | l4->ol_flags;
+	if (l3->l3_end) {
+		m->l2_len = prs->ip_off[0];
+		m->l3_len = ((const uint8_t *)prs)[l3->l3_end] -
+			    prs->ip_off[0];
+	} else {
+		m->l2_len = 0;
+		m->l3_len = 0;
+	}
+
+	if ((ptype & (RTE_PTYPE_L4_MASK | RTE_PTYPE_TUNNEL_MASK)) ==
+	    RTE_PTYPE_L4_UDP) {
+		/* Destination port, big endian */
+		udp = data + prs->l4_off;
+		if (((udp[2] << 8) | udp[3]) == DPAA_VXLAN_UDP_PORT)
+			ptype |= RTE_PTYPE_TUNNEL_VXLAN |
+				 RTE_PTYPE_INNER_L2_ETHER;
+	}
+	m->packet_type = ptype;
+}
+
+#endif /* __DPAA_PTYPE_H__ */
@@ -122,84 +122,22 @@ void dpaa_display_frame(const struct qm_fd *fd)
 #define dpaa_display_frame(a)
 #endif
 
-static inline void dpaa_slow_parsing(struct rte_mbuf *m __rte_unused,
-				     uint64_t prs __rte_unused)
-{
-	PMD_RX_LOG(DEBUG, " Slow parsing");
-
-	/*TBD:XXX: to be implemented*/
-}
+/* Built at init from the parse result bits */
+struct dpaa_ptype_tbl dpaa_ptype_tbl;
 
 static inline void dpaa_eth_packet_info(struct rte_mbuf *m,
 					uint64_t fd_virt_addr)
 {
 	struct annotations_t *annot = GET_ANNOTATIONS(fd_virt_addr);
-	uint64_t prs = *((uint64_t *)(&annot->parse)) & DPAA_PARSE_MASK;
 
 	PMD_RX_LOG(DEBUG, " Parsing mbuf: %p with annotations: %p", m, annot);
 
-	switch (prs) {
-	case DPAA_PKT_TYPE_NONE:
-		m->packet_type = 0;
-		break;
-	case DPAA_PKT_TYPE_ETHER:
-		m->packet_type = RTE_PTYPE_L2_ETHER;
-		break;
-	case DPAA_PKT_TYPE_IPV4:
-		m->packet_type = RTE_PTYPE_L2_ETHER |
-			RTE_PTYPE_L3_IPV4;
-		break;
-	case DPAA_PKT_TYPE_IPV6:
-		m->packet_type = RTE_PTYPE_L2_ETHER |
-			RTE_PTYPE_L3_IPV6;
-		break;
-	case DPAA_PKT_TYPE_IPV4_EXT:
-		m->packet_type = RTE_PTYPE_L2_ETHER |
-			RTE_PTYPE_L3_IPV4_EXT;
-		break;
-	case DPAA_PKT_TYPE_IPV6_EXT:
-		m->packet_type = RTE_PTYPE_L2_ETHER |
-			RTE_PTYPE_L3_IPV6_EXT;
-		break;
-	case DPAA_PKT_TYPE_IPV4_TCP:
-		m->packet_type = RTE_PTYPE_L2_ETHER |
-			RTE_PTYPE_L3_IPV4 | RTE_PTYPE_L4_TCP;
-		break;
-	case DPAA_PKT_TYPE_IPV6_TCP:
-		m->packet_type = RTE_PTYPE_L2_ETHER |
-			RTE_PTYPE_L3_IPV6 | RTE_PTYPE_L4_TCP;
-		break;
-	case DPAA_PKT_TYPE_IPV4_UDP:
-		m->packet_type = RTE_PTYPE_L2_ETHER |
-			RTE_PTYPE_L3_IPV4 | RTE_PTYPE_L4_UDP;
-		break;
-	case DPAA_PKT_TYPE_IPV6_UDP:
-		m->packet_type = RTE_PTYPE_L2_ETHER |
-			RTE_PTYPE_L3_IPV6 | RTE_PTYPE_L4_UDP;
-		break;
-	case DPAA_PKT_TYPE_IPV4_SCTP:
-		m->packet_type = RTE_PTYPE_L2_ETHER |
-			RTE_PTYPE_L3_IPV4 | RTE_PTYPE_L4_SCTP;
-		break;
-	case DPAA_PKT_TYPE_IPV6_SCTP:
-		m->packet_type = RTE_PTYPE_L2_ETHER |
-			RTE_PTYPE_L3_IPV6 | RTE_PTYPE_L4_SCTP;
-		break;
-	/* More switch cases can be added */
-	default:
-		dpaa_slow_parsing(m, prs);
-	}
-
-	m->l2_len = annot->parse.ip_off[0];
-	m->l3_len = annot->parse.l4_off - annot->parse.ip_off[0];
-
 	/* Set the hash values */
 	m->hash.rss = (uint32_t)(rte_be_to_cpu_64(annot->hash));
 	m->ol_flags = PKT_RX_RSS_HASH;
 
-	/* Check if Vlan is present */
-	if (prs & DPAA_PARSE_VLAN_MASK)
-		m->ol_flags |= PKT_RX_VLAN_PKT;
+	dpaa_ptype_lookup(&dpaa_ptype_tbl, &annot->parse,
+			  rte_pktmbuf_mtod(m, uint8_t *), m);
 }
 
 static inline void dpaa_checksum_offload(struct rte_mbuf *mbuf,
@@ -368,27 +306,103 @@ uint16_t dpaa_eth_queue_rx(void *q,
 	return num_rx;
 }
 
-static void *dpaa_get_pktbuf(struct pool_info_entry *bp_info)
+/* Receive in progress on the lcore, for the push mode DQRR callback */
+static RTE_DEFINE_PER_LCORE(struct rx_demux_burst, dpaa_rx_burst);
+
+static enum qman_cb_dqrr_result
+dpaa_rx_push_cb(struct qman_portal *qm __rte_unused,
+		struct qman_fq *fq,
+		const struct qm_dqrr_entry *dq)
+{
+	struct dpaa_if *dpaa_intf = fq->dpaa_intf;
+	struct rte_mbuf *mbuf;
+
+	if (unlikely(!(dq->stat & QM_DQRR_STAT_FD_VALID)))
+		return qman_cb_dqrr_consume;
+
+	mbuf = dpaa_eth_fd_to_mbuf(fq, (struct qm_fd *)(uintptr_t)&dq->fd);
+	if (likely(mbuf != NULL))
+		rx_demux_frame(&RTE_PER_LCORE(dpaa_rx_burst),
+			       &dpaa_intf->rx_demux[fq - dpaa_intf->rx_queues],
+			       mbuf);
+	return qman_cb_dqrr_consume;
+}
+
+/* Frames of a push mode Rx FQ being released, dequeued by the portal it
+ * was scheduled to, are dropped.
+ */
+enum qman_cb_dqrr_result
+dpaa_rx_drop_cb(struct qman_portal *qm __rte_unused,
+		struct qman_fq *fq,
+		const struct qm_dqrr_entry *dq)
+{
+	if (likely(dq->stat & QM_DQRR_STAT_FD_VALID))
+		rte_pktmbuf_free(dpaa_eth_fd_to_mbuf(fq,
+				(struct qm_fd *)(uintptr_t)&dq->fd));
+	return qman_cb_dqrr_consume;
+}
+
+/* Push mode: the Rx FQs of all the ports polled by an lcore are scheduled
+ * to the dedicated channel of its portal. A single poll of the DQRR returns
+ * frames of any of them, those of other queues are kept in their backlog.
+ */
+uint16_t dpaa_eth_queue_push_rx(void *q,
+				struct rte_mbuf **bufs,
+				uint16_t nb_bufs)
 {
+	struct qman_fq *fq = q;
+	struct dpaa_if *dpaa_intf = fq->dpaa_intf;
+	struct rx_demux_queue *rxq =
+		&dpaa_intf->rx_demux[fq - dpaa_intf->rx_queues];
+	struct rx_demux_burst *burst = &RTE_PER_LCORE(dpaa_rx_burst);
 	int ret;
-	uint64_t buf = 0;
-	struct bm_buffer bufs;
 
-	ret = bman_acquire(bp_info->bp, &bufs, 1, 0);
-	if (ret <= 0) {
-		PMD_DRV_LOG(WARNING, "Failed to allocate buffers %d", ret);
-		return (void *)buf;
+	ret = rx_demux_queue_claim(rxq);
+	if (unlikely(ret)) {
+		if (ret < 0) {
+			PMD_DRV_LOG_RATELIMIT(ERR, "rx fqid %d is polled by "
+					      "lcore %u", fq->fqid,
+					      rx_demux_queue_owner(rxq));
+			return 0;
+		}
+		if (!RTE_PER_LCORE(_dpaa_io)) {
+			ret = dpaa_portal_init((void *)0);
+			if (ret) {
+				PMD_DRV_LOG(ERR, "Failure in affining portal");
+				rx_demux_queue_unclaim(rxq);
+				return 0;
+			}
+		}
+		fq->cb.dqrr = dpaa_rx_push_cb;
+		if (dpaa_rx_queue_push_init(fq)) {
+			rx_demux_queue_unclaim(rxq);
+			return 0;
+		}
 	}
 
-	PMD_RX_LOG(DEBUG, "got buffer 0x%llx from pool %d",
-		    bufs.addr, bufs.bpid);
+	if (rx_demux_burst_start(burst, rxq, bufs, nb_bufs))
+		return nb_bufs;
+	qman_poll_dqrr(rx_demux_burst_room(burst));
+
+	/* Other polls of the portal, as by dpaa_sec, fill the backlogs */
+	return rx_demux_burst_end(burst);
+}
+
+static void *dpaa_get_pktbuf(struct pool_info_entry *bp_info)
+{
+	void *buf;
+
+	/* Served by the stash of the lcore, refilled from BMAN in 8s */
+	if (bm_stash_get(&bp_info->stash, &buf, 1)) {
+		PMD_DRV_LOG_RATELIMIT(WARNING, "Failed to allocate buffers "
+				      "from bpid %d", bp_info->bpid);
+		return NULL;
+	}
 
-	buf = (uint64_t)dpaa_mem_ptov(bufs.addr) - bp_info->meta_data_size;
-	if (!buf)
-		goto out;
+	PMD_RX_LOG(DEBUG, "got buffer %p from pool %d",
+		    buf, bp_info->bpid);
 
-out:
-	return (void *)buf;
+	return buf;
 }
 
 static struct rte_mbuf *dpaa_get_dmable_mbuf(struct rte_mbuf *mbuf,
@@ -33,6 +33,8 @@
 #ifndef __DPDK_RXTX_H__
 #define __DPDK_RXTX_H__
 
+#include "dpaa_ptype.h"
+
 #define L2_ERROR_MASK	  0x001f  /* bits 11:15 */
 #define L3_ERROR_MASK	  0x0200 /* bit 6 */
 #define L4_ERROR_MASK	  0x10	 /* bit 3 */
@@ -93,64 +95,6 @@
 
 #define DPA_SGT_MAX_ENTRIES 16 /* maximum number of entries in SG Table */
 
-/* Parsing mask (Little Endian) - 0x00E044EC00800000
- *	Classification Plan ID 0x00
- *	L4R 0xE0 -
- *		0x80 - TCP
- *		0x40 - UCP
- *		0x20 - SCTP
- *	L3R 0xEC44 (in Big Endian) -
- *		0x8000 - IPv4
- *		0x4000 - IPv6
- *		0x8040 - IPv4 Ext
- *		0x4040 - IPv6 Ext
- *	L2R 0x8000 (in Big Endian) -
- *		0x8000 - Ethernet type
- *	ShimR & Logical Port ID 0x0000
- */
-#define DPAA_PARSE_MASK		0x00E044EC00800000
-#define DPAA_PARSE_VLAN_MASK		0x0000000000700000
-
-/* Parsed values (Little Endian) */
-#define DPAA_PKT_TYPE_NONE		0x0000000000000000
-#define DPAA_PKT_TYPE_ETHER		0x0000000000800000
-#define DPAA_PKT_TYPE_IPV4		0x0000008000800000
-#define DPAA_PKT_TYPE_IPV6		0x0000004000800000
-#define DPAA_PKT_TYPE_IPV4_EXT		0x0000408000800000
-#define DPAA_PKT_TYPE_IPV6_EXT		0x0000404000800000
-#define DPAA_PKT_TYPE_IPV4_TCP		0x0080008000800000
-#define DPAA_PKT_TYPE_IPV6_TCP		0x0080004000800000
-#define DPAA_PKT_TYPE_IPV4_UDP		0x0040008000800000
-#define DPAA_PKT_TYPE_IPV6_UDP		0x0040004000800000
-#define DPAA_PKT_TYPE_IPV4_SCTP	0x0020008000800000
-#define DPAA_PKT_TYPE_IPV6_SCTP	0x0020004000800000
-
-/**
- * FMan parse result array
- */
-struct dpaa_eth_parse_results_t {
-	 uint8_t     lpid;		 /**< Logical port id */
-	 uint8_t     shimr;		 /**< Shim header result  */
-	 uint16_t    l2r;		 /**< Layer 2 result */
-	 uint16_t    l3r;		 /**< Layer 3 result */
-	 uint8_t     l4r;		 /**< Layer 4 result */
-	 uint8_t     cplan;		 /**< Classification plan id */
-	 uint16_t    nxthdr;		 /**< Next Header  */
-	 uint16_t    cksum;		 /**< Checksum */
-	 uint32_t    lcv;		 /**< LCV */
-	 uint8_t     shim_off[3];	 /**< Shim offset */
-	 uint8_t     eth_off;		 /**< ETH offset */
-	 uint8_t     llc_snap_off;	 /**< LLC_SNAP offset */
-	 uint8_t     vlan_off[2];	 /**< VLAN offset */
-	 uint8_t     etype_off;		 /**< ETYPE offset */
-	 uint8_t     pppoe_off;		 /**< PPP offset */
-	 uint8_t     mpls_off[2];	 /**< MPLS offset */
-	 uint8_t     ip_off[2];		 /**< IP offset */
-	 uint8_t     gre_off;		 /**< GRE offset */
-	 uint8_t     l4_off;		 /**< Layer 4 offset */
-	 uint8_t     nxthdr_off;	 /**< Parser end point */
-} __attribute__ ((__packed__));
-
 /* The structure is the Prepended Data to the Frame which is used by FMAN */
 struct annotations_t {
 	uint8_t reserved[DEFAULT_RX_ICEOF];
@@ -193,6 +137,14 @@ uint16_t dpaa_eth_queue_rx(void *q,
 			   struct rte_mbuf **bufs,
 		uint16_t nb_bufs);
 
+uint16_t dpaa_eth_queue_push_rx(void *q,
+				struct rte_mbuf **bufs,
+				uint16_t nb_bufs);
+
+enum qman_cb_dqrr_result dpaa_rx_drop_cb(struct qman_portal *qm,
+					 struct qman_fq *fq,
+					 const struct qm_dqrr_entry *dq);
+
 uint16_t dpaa_eth_queue_tx(void *q,
 			   struct rte_mbuf **bufs,
 			uint16_t nb_bufs);
@@ -65,6 +65,10 @@ struct dpaa2_bp_info bpid_info[MAX_BPID];
 
 struct dpaa2_bp_list *h_bp_list;
 
+static int dpaa2_mbuf_acquire(void *ctx, void **obj_table, unsigned int num);
+static void dpaa2_mbuf_stash_release(void *ctx, void * const *obj_table,
+				     unsigned int num);
+
 int
 dpaa2_create_dpbp_device(
 		int dpbp_id)
@@ -168,6 +172,16 @@ hw_mbuf_create_pool(struct rte_mempool *mp)
 
 	mp->pool_data = (void *)&bpid_info[bpid];
 
+	/* Hardware RX takes its buffers from the pool, the stashes keep
+	 * no more than 3/4 of RTE_LIBRTE_DPAA2_BM_STASH_SIZE each.
+	 */
+	ret = bm_stash_pool_init(&bpid_info[bpid].stash, mp,
+				 dpaa2_mbuf_acquire, dpaa2_mbuf_stash_release,
+				 DPAA2_MBUF_MAX_ACQ_REL,
+				 RTE_LIBRTE_DPAA2_BM_STASH_SIZE);
+	if (ret)
+		PMD_INIT_LOG(WARNING, "No buffer stash for bpid =%d", bpid);
+
 	PMD_INIT_LOG(DEBUG, "BP List created for bpid =%d", dpbp_attr.bpid);
 
 	h_bp_list = bp_list;
@@ -178,7 +192,7 @@ hw_mbuf_create_pool(struct rte_mempool *mp)
 }
 
 static void
-hw_mbuf_free_pool(struct rte_mempool *mp __rte_unused)
+hw_mbuf_free_pool(struct rte_mempool *mp)
 {
 	/* TODO:
 	 * 1. Release bp_list memory allocation
@@ -187,6 +201,8 @@ hw_mbuf_free_pool(struct rte_mempool *mp __rte_unused)
 	 */
 	struct dpaa2_bp_list *bp;
 
+	bm_stash_pool_fini(&mempool_to_bpinfo(mp)->stash);
+
 	/* Iterate over h_bp_list linked list and release each element */
 	while (h_bp_list) {
 		bp = h_bp_list;
@@ -197,19 +213,25 @@ hw_mbuf_free_pool(struct rte_mempool *mp __rte_unused)
 	}
 }
 
+/* Release 'num' (up to 7) buffers in a single command, the stash splits
+ * larger bursts with bm_stash_release_bulk()
+ */
 static
 void dpaa2_mbuf_release(struct rte_mempool *pool __rte_unused,
 			void * const *obj_table,
 			uint32_t bpid,
 			uint32_t meta_data_size,
-			int count)
+			unsigned int num)
 {
 	struct qbman_release_desc releasedesc;
 	struct qbman_swp *swp;
 	int ret;
-	int i, n;
+	unsigned int i;
 	uint64_t bufs[DPAA2_MBUF_MAX_ACQ_REL];
 
+	if (unlikely(num == 0 || num > DPAA2_MBUF_MAX_ACQ_REL))
+		return;
+
 	if (unlikely(!DPAA2_PER_LCORE_DPIO)) {
 		ret = dpaa2_affine_qbman_swp();
 		if (ret != 0) {
@@ -225,10 +247,8 @@ void dpaa2_mbuf_release(struct rte_mempool *pool __rte_unused,
 	qbman_release_desc_clear(&releasedesc);
 	qbman_release_desc_set_bpid(&releasedesc, bpid);
 
-	n = count % DPAA2_MBUF_MAX_ACQ_REL;
-
-	/* convert mbuf to buffers  for the remainder*/
-	for (i = 0; i < n ; i++) {
+	/* convert mbuf to buffers */
+	for (i = 0; i < num; i++) {
 #ifdef RTE_LIBRTE_DPAA2_USE_PHYS_IOVA
 		bufs[i] = (uint64_t)rte_mempool_virt2phy(pool, obj_table[i])
 				+ meta_data_size;
@@ -236,30 +256,70 @@ void dpaa2_mbuf_release(struct rte_mempool *pool __rte_unused,
 		bufs[i] = (uint64_t)obj_table[i] + meta_data_size;
 #endif
 	}
-	/* feed them to bman*/
+	/* feed them to bman */
 	do {
-		ret = qbman_swp_release(swp, &releasedesc, bufs, n);
+		ret = qbman_swp_release(swp, &releasedesc, bufs, num);
 	} while (ret == -EBUSY);
+}
 
-	/* if there are more buffers to free */
-	while (n < count) {
-		/* convert mbuf to buffers */
-		for (i = 0; i < DPAA2_MBUF_MAX_ACQ_REL; i++) {
-#ifdef RTE_LIBRTE_DPAA2_USE_PHYS_IOVA
-			bufs[i] = (uint64_t)
-				rte_mempool_virt2phy(pool, obj_table[n + i])
-					+ meta_data_size;
-#else
-			bufs[i] = (uint64_t)obj_table[n + i] + meta_data_size;
-#endif
+/* Acquire exactly 'num' (up to 7) buffers in a single command */
+static int
+dpaa2_mbuf_acquire(void *ctx, void **obj_table, unsigned int num)
+{
+	struct rte_mempool *pool = ctx;
+	struct dpaa2_bp_info *bp_info = mempool_to_bpinfo(pool);
+	uint64_t bufs[DPAA2_MBUF_MAX_ACQ_REL];
+	unsigned int i;
+	int ret;
+
+	if (unlikely(!DPAA2_PER_LCORE_DPIO)) {
+		ret = dpaa2_affine_qbman_swp();
+		if (ret != 0) {
+			RTE_LOG(ERR, PMD, "Failed to allocate IO portal");
+			return -1;
 		}
+	}
 
-		do {
-			ret = qbman_swp_release(swp, &releasedesc, bufs,
-						DPAA2_MBUF_MAX_ACQ_REL);
-			} while (ret == -EBUSY);
-		n += DPAA2_MBUF_MAX_ACQ_REL;
+	/* In case of less than requested number of buffers available
+	 * in pool, qbman_swp_acquire returns 0
+	 */
+	ret = qbman_swp_acquire(DPAA2_PER_LCORE_PORTAL, bp_info->bpid,
+				bufs, num);
+	if (ret <= 0) {
+		PMD_TX_LOG(DEBUG, "Buffer acquire failed with"
+			   " err code: %d", ret);
+		return ret;
+	}
+	/* assigning mbuf from the acquired objects */
+	for (i = 0; i < num; i++) {
+		/* TODO-errata - observed that bufs may be null
+		 * i.e. first buffer is valid,
+		 * remaining 6 buffers may be null
+		 */
+		if (unlikely(!bufs[i])) {
+			dpaa2_mbuf_release(pool, obj_table, bp_info->bpid,
+					   bp_info->meta_data_size, i);
+			return 0;
+		}
+		DPAA2_MODIFY_IOVA_TO_VADDR(bufs[i], uint64_t);
+		obj_table[i] = (struct rte_mbuf *)(bufs[i] -
+						   bp_info->meta_data_size);
+		rte_mbuf_refcnt_set((struct rte_mbuf *)obj_table[i], 0);
+		PMD_TX_LOG(DEBUG, "Acquired %p address %p from BMAN",
+			   (void *)bufs[i], (void *)obj_table[i]);
 	}
+	return num;
+}
+
+static void
+dpaa2_mbuf_stash_release(void *ctx, void * const *obj_table,
+			 unsigned int num)
+{
+	struct rte_mempool *pool = ctx;
+	struct dpaa2_bp_info *bp_info = mempool_to_bpinfo(pool);
+
+	dpaa2_mbuf_release(pool, obj_table, bp_info->bpid,
+			   bp_info->meta_data_size, num);
 }
 
 int hw_mbuf_alloc_bulk(struct rte_mempool *pool,
@@ -268,12 +328,6 @@ int hw_mbuf_alloc_bulk(struct rte_mempool *pool,
 #ifdef RTE_LIBRTE_DPAA2_DEBUG_DRIVER
 	static int alloc;
 #endif
-	struct qbman_swp *swp;
-	uint32_t mbuf_size;
-	uint16_t bpid;
-	uint64_t bufs[DPAA2_MBUF_MAX_ACQ_REL];
-	int i, ret;
-	unsigned n = 0;
 	struct dpaa2_bp_info *bp_info;
 
 	bp_info = mempool_to_bpinfo(pool);
@@ -283,61 +337,19 @@ int hw_mbuf_alloc_bulk(struct rte_mempool *pool,
 		return -2;
 	}
 
-	bpid = bp_info->bpid;
-
-	if (unlikely(!DPAA2_PER_LCORE_DPIO)) {
-		ret = dpaa2_affine_qbman_swp();
-		if (ret != 0) {
-			RTE_LOG(ERR, PMD, "Failed to allocate IO portal");
-			return -1;
-		}
-	}
-	swp = DPAA2_PER_LCORE_PORTAL;
-
-	mbuf_size = sizeof(struct rte_mbuf) + rte_pktmbuf_priv_size(pool);
-
-	while (n < count) {
-		/* Acquire is all-or-nothing, so we drain in 7s,
-		 * then the remainder.
-		 */
-		if ((count - n) > DPAA2_MBUF_MAX_ACQ_REL) {
-			ret = qbman_swp_acquire(swp, bpid, bufs,
-						DPAA2_MBUF_MAX_ACQ_REL);
-		} else {
-			ret = qbman_swp_acquire(swp, bpid, bufs,
-						count - n);
-		}
-		/* In case of less than requested number of buffers available
-		 * in pool, qbman_swp_acquire returns 0
-		 */
-		if (ret <= 0) {
-			PMD_TX_LOG(ERR, "Buffer acquire failed with"
-				   " err code: %d", ret);
-			/* The API expect the exact number of requested bufs */
-			/* Releasing all buffers allocated */
-			dpaa2_mbuf_release(pool, obj_table, bpid,
-					   bp_info->meta_data_size, n);
-			return -1;
-		}
-		/* assigning mbuf from the acquired objects */
-		for (i = 0; (i < ret) && bufs[i]; i++) {
-			/* TODO-errata - observed that bufs may be null
-			 * i.e. first buffer is valid,
-			 * remaining 6 buffers may be null
-			 */
-			DPAA2_MODIFY_IOVA_TO_VADDR(bufs[i], uint64_t);
-			obj_table[n] = (struct rte_mbuf *)(bufs[i] - mbuf_size);
-			rte_mbuf_refcnt_set((struct rte_mbuf *)obj_table[n], 0);
-			PMD_TX_LOG(DEBUG, "Acquired %p address %p from BMAN",
-				   (void *)bufs[i], (void *)obj_table[n]);
-			n++;
-		}
+	/* The stash of the lcore is refilled in commands of 7 buffers.
+	 * The API expect the exact number of requested bufs.
+	 */
+	if (bm_stash_get(&bp_info->stash, obj_table, count)) {
+		PMD_TX_LOG(ERR, "Buffer acquire failed for %u buffers",
+			   count);
+		return -1;
 	}
 
 #ifdef RTE_LIBRTE_DPAA2_DEBUG_DRIVER
-	alloc += n;
+	alloc += count;
 	PMD_TX_LOG(DEBUG, "Total = %d , req = %d done = %d",
-		   alloc, count, n);
+		   alloc, count, count);
 #endif
 	return 0;
 }
@@ -353,8 +365,7 @@ hw_mbuf_free_bulk(struct rte_mempool *pool,
 		RTE_LOG(ERR, PMD, "DPAA2 buffer pool not configured");
 		return -1;
 	}
-	dpaa2_mbuf_release(pool, obj_table, bp_info->bpid,
-			   bp_info->meta_data_size, n);
+	bm_stash_put(&bp_info->stash, obj_table, n);
 
 	return 0;
 }
@@ -33,8 +33,15 @@
 #ifndef _DPAA2_HW_DPBP_H_
 #define _DPAA2_HW_DPBP_H_
 
+#include <bpool/bm_stash.h>
+
 #define DPAA2_MAX_BUF_POOLS	8
 
+/* Capacity of the per lcore stash of buffers of the pools */
+#ifndef RTE_LIBRTE_DPAA2_BM_STASH_SIZE
+#define RTE_LIBRTE_DPAA2_BM_STASH_SIZE	64
+#endif
+
 struct dpbp_node {
 	struct dpbp_node *next;
 	struct fsl_mc_io dpbp;
@@ -85,6 +92,7 @@ struct dpaa2_bp_info {
 	uint32_t meta_data_size;
 	uint32_t bpid;
 	struct dpaa2_bp_list *bp_list;
+	struct bm_stash_pool stash;
 };
 
 #define mempool_to_bpinfo(mp) ((struct dpaa2_bp_info *)mp->pool_data)
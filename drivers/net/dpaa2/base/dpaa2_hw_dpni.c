@@ -53,6 +53,9 @@
 #include <dpaa2_hw_dpni.h>
 #include <dpaa2_hw_dpio.h>
 
+/* Built at init from the frame annotation flags */
+struct dpaa2_ptype_tbl dpaa2_ptype_tbl;
+
 static void
 dpaa2_distset_to_dpkg_profile_cfg(
 		uint32_t req_dist_set,
@@ -35,6 +35,8 @@
 #define _DPAA2_HW_DPNI_H_
 
 #include <dpaa2_hw_dpni_annot.h>
+#include <dpaa2_hw_dpni_ptype.h>
+#include <rx_demux.h>
 
 #define DPAA2_MIN_RX_BUF_SIZE 512
 #define DPAA2_MAX_RX_PKT_LEN  10240 /*WRIOP support*/
@@ -83,6 +85,10 @@
 /*Disable RX tail drop */
 #define DPAA2_RX_TAILDROP_OFF	0x04
 
+/* RX queues of a portal pulled together
+ * default is a pull per receive */
+#define DPAA2_RX_MULTI_QUEUE	0x08
+
 struct dpaa2_dev_priv {
 	void *hw;
 	int32_t hw_id;
@@ -92,6 +98,7 @@ struct dpaa2_dev_priv {
 	uint8_t nb_rx_queues;
 	void *rx_vq[MAX_RX_QUEUES];
 	void *tx_vq[MAX_TX_QUEUES];
+	struct rx_demux_queue *rx_demux; /**< Backlogs of multi-queue RX */
 
 	struct dpaa2_bp_list *bp_list; /**<Attached buffer pool list */
 	uint32_t options;
@@ -113,87 +120,6 @@ int dpaa2_remove_flow_dist(struct rte_eth_dev *eth_dev,
 
 int dpaa2_attach_bp_list(struct dpaa2_dev_priv *priv, void *blist);
 
-static inline uint32_t __attribute__((hot))
-dpaa2_dev_rx_parse(uint64_t hw_annot_addr)
-{
-	uint32_t pkt_type = RTE_PTYPE_UNKNOWN;
-	struct dpaa2_annot_hdr *annotation =
-			(struct dpaa2_annot_hdr *)hw_annot_addr;
-
-	PMD_RX_LOG(DEBUG, "annotation = 0x%lx   ", annotation->word4);
-
-	if (BIT_ISSET_AT_POS(annotation->word3, L2_ARP_PRESENT)) {
-		pkt_type = RTE_PTYPE_L2_ETHER_ARP;
-		goto parse_done;
-	} else if (BIT_ISSET_AT_POS(annotation->word3, L2_ETH_MAC_PRESENT)) {
-		pkt_type = RTE_PTYPE_L2_ETHER;
-	} else {
-		goto parse_done;
-	}
-
-	if (BIT_ISSET_AT_POS(annotation->word4, L3_IPV4_1_PRESENT |
-			     L3_IPV4_N_PRESENT)) {
-		pkt_type |= RTE_PTYPE_L3_IPV4;
-		if (BIT_ISSET_AT_POS(annotation->word4, L3_IP_1_OPT_PRESENT |
-			L3_IP_N_OPT_PRESENT))
-			pkt_type |= RTE_PTYPE_L3_IPV4_EXT;
-
-	} else if (BIT_ISSET_AT_POS(annotation->word4, L3_IPV6_1_PRESENT |
-		  L3_IPV6_N_PRESENT)) {
-		pkt_type |= RTE_PTYPE_L3_IPV6;
-		if (BIT_ISSET_AT_POS(annotation->word4, L3_IP_1_OPT_PRESENT |
-		    L3_IP_N_OPT_PRESENT))
-			pkt_type |= RTE_PTYPE_L3_IPV6_EXT;
-	} else {
-		goto parse_done;
-	}
-
-	if (BIT_ISSET_AT_POS(annotation->word4, L3_IP_1_FIRST_FRAGMENT |
-	    L3_IP_1_MORE_FRAGMENT |
-	    L3_IP_N_FIRST_FRAGMENT |
-	    L3_IP_N_MORE_FRAGMENT)) {
-		pkt_type |= RTE_PTYPE_L4_FRAG;
-		goto parse_done;
-	} else {
-		pkt_type |= RTE_PTYPE_L4_NONFRAG;
-	}
-
-	if (BIT_ISSET_AT_POS(annotation->word4, L3_PROTO_UDP_PRESENT))
-		pkt_type |= RTE_PTYPE_L4_UDP;
-
-	else if (BIT_ISSET_AT_POS(annotation->word4, L3_PROTO_TCP_PRESENT))
-		pkt_type |= RTE_PTYPE_L4_TCP;
-
-	else if (BIT_ISSET_AT_POS(annotation->word4, L3_PROTO_SCTP_PRESENT))
-		pkt_type |= RTE_PTYPE_L4_SCTP;
-
-	else if (BIT_ISSET_AT_POS(annotation->word4, L3_PROTO_ICMP_PRESENT))
-		pkt_type |= RTE_PTYPE_L4_ICMP;
-
-	else if (BIT_ISSET_AT_POS(annotation->word4, L3_IP_UNKNOWN_PROTOCOL))
-		pkt_type |= RTE_PTYPE_UNKNOWN;
-
-parse_done:
-	return pkt_type;
-}
-
-static inline void __attribute__((hot))
-dpaa2_dev_rx_offload(uint64_t hw_annot_addr, struct rte_mbuf *mbuf)
-{
-	struct dpaa2_annot_hdr *annotation =
-		(struct dpaa2_annot_hdr *)hw_annot_addr;
-
-	if (BIT_ISSET_AT_POS(annotation->word3,
-			     L2_VLAN_1_PRESENT | L2_VLAN_N_PRESENT))
-		mbuf->ol_flags |= PKT_RX_VLAN_PKT;
-
-	if (BIT_ISSET_AT_POS(annotation->word8, DPAA2_ETH_FAS_L3CE))
-		mbuf->ol_flags |= PKT_RX_IP_CKSUM_BAD;
-
-	if (BIT_ISSET_AT_POS(annotation->word8, DPAA2_ETH_FAS_L4CE))
-		mbuf->ol_flags |= PKT_RX_L4_CKSUM_BAD;
-}
-
 static inline struct rte_mbuf *__attribute__((hot))
 eth_sg_fd_to_mbuf(const struct qbman_fd *fd)
 {
@@ -222,12 +148,10 @@ eth_sg_fd_to_mbuf(const struct qbman_fd *fd)
 	first_seg->pkt_len = DPAA2_GET_FD_LEN(fd);
 	first_seg->nb_segs = 1;
 
-	first_seg->packet_type = dpaa2_dev_rx_parse(
-			 (uint64_t)DPAA2_IOVA_TO_VADDR(DPAA2_GET_FD_ADDR(fd))
-			 + DPAA2_FD_PTA_SIZE);
-	dpaa2_dev_rx_offload((uint64_t)DPAA2_IOVA_TO_VADDR(
-			DPAA2_GET_FD_ADDR(fd)) +
-			DPAA2_FD_PTA_SIZE, first_seg);
+	dpaa2_ptype_lookup(&dpaa2_ptype_tbl,
+			   (struct dpaa2_annot_hdr *)(fd_addr +
+						      DPAA2_FD_PTA_SIZE),
+			   rte_pktmbuf_mtod(first_seg, uint8_t *), first_seg);
 	rte_mbuf_refcnt_set(first_seg, 1);
 	cur_seg = first_seg;
 	while (!DPAA2_SG_IS_FINAL(sge)) {
@@ -258,6 +182,7 @@ eth_sg_fd_to_mbuf(const struct qbman_fd *fd)
 static inline struct rte_mbuf *__attribute__((hot))
 eth_fd_to_mbuf(const struct qbman_fd *fd)
 {
+	uint8_t *buf;
 	struct rte_mbuf *mbuf = DPAA2_INLINE_MBUF_FROM_BUF(
 		DPAA2_IOVA_TO_VADDR(DPAA2_GET_FD_ADDR(fd)),
 			bpid_info[DPAA2_GET_FD_BPID(fd)].meta_data_size);
@@ -272,13 +197,10 @@ eth_fd_to_mbuf(const struct qbman_fd *fd)
 
 	/* Parse the packet */
 	/* parse results are after the private - sw annotation area */
-	mbuf->packet_type = dpaa2_dev_rx_parse(
-			(uint64_t)DPAA2_IOVA_TO_VADDR(DPAA2_GET_FD_ADDR(fd))
-			 + DPAA2_FD_PTA_SIZE);
-
-	dpaa2_dev_rx_offload((uint64_t)DPAA2_IOVA_TO_VADDR(
-			     DPAA2_GET_FD_ADDR(fd)) +
-			     DPAA2_FD_PTA_SIZE, mbuf);
+	buf = (uint8_t *)DPAA2_IOVA_TO_VADDR(DPAA2_GET_FD_ADDR(fd));
+	dpaa2_ptype_lookup(&dpaa2_ptype_tbl,
+			   (struct dpaa2_annot_hdr *)(buf + DPAA2_FD_PTA_SIZE),
+			   buf + mbuf->data_off, mbuf);
 
 	mbuf->next = NULL;
 	rte_mbuf_refcnt_set(mbuf, 1);
@@ -0,0 +1,304 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2017 NXP. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of NXP nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ *
+ * WRIOP parse results to mbuf packet type, offload flags and header lengths
+ * - implementation internal
+ *
+ * The frame annotation flags that matter are gathered into two indexes: one
+ * of the L2/L3 flags, one of the L4 flags and checksum errors. Each selects
+ * an entry of a table built once at init, so that a frame costs two table
+ * loads instead of a chain of flag tests.
+ */
+
+#ifndef _DPAA2_HW_DPNI_PTYPE_H_
+#define _DPAA2_HW_DPNI_PTYPE_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#include <rte_mbuf.h>
+
+#include <dpaa2_hw_dpni_annot.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* L2/L3 index bits */
+#define DPAA2_PTYPE_L3_IDX_ETH		0x001
+#define DPAA2_PTYPE_L3_IDX_ARP		0x002
+#define DPAA2_PTYPE_L3_IDX_VLAN_1	0x004
+#define DPAA2_PTYPE_L3_IDX_VLAN_N	0x008
+#define DPAA2_PTYPE_L3_IDX_IPV4_1	0x010
+#define DPAA2_PTYPE_L3_IDX_IPV4_N	0x020
+#define DPAA2_PTYPE_L3_IDX_IPV6_1	0x040
+#define DPAA2_PTYPE_L3_IDX_IPV6_N	0x080
+#define DPAA2_PTYPE_L3_IDX_OPT_1	0x100
+#define DPAA2_PTYPE_L3_IDX_GRE		0x200
+#define DPAA2_PTYPE_L3_NB		0x400
+
+/* L4 index bits */
+#define DPAA2_PTYPE_L4_IDX_UDP		0x01
+#define DPAA2_PTYPE_L4_IDX_TCP		0x02
+#define DPAA2_PTYPE_L4_IDX_SCTP		0x04
+#define DPAA2_PTYPE_L4_IDX_ICMP		0x08
+#define DPAA2_PTYPE_L4_IDX_FRAG		0x10
+#define DPAA2_PTYPE_L4_IDX_L3CE		0x20
+#define DPAA2_PTYPE_L4_IDX_L4CE		0x40
+#define DPAA2_PTYPE_L4_NB		0x80
+
+/* Position of the offsets in word6 */
+#define DPAA2_PTYPE_IP_1_SHIFT		32
+#define DPAA2_PTYPE_IP_N_SHIFT		24
+#define DPAA2_PTYPE_GRE_SHIFT		16
+#define DPAA2_PTYPE_L4_SHIFT		8
+
+/* L4 rows: no IP, L4 of the only IP header, L4 of the tunneled one */
+enum {
+	DPAA2_PTYPE_L4_NONE,
+	DPAA2_PTYPE_L4_OUTER,
+	DPAA2_PTYPE_L4_INNER,
+	DPAA2_PTYPE_L4_ROWS
+};
+
+/* VXLAN isn't parsed by WRIOP, UDP frames to its port are */
+#define DPAA2_VXLAN_UDP_PORT		4789
+
+struct dpaa2_ptype_l3 {
+	uint32_t packet_type;
+	uint16_t ol_flags;
+	/** Position in word6 of the end of the L3 header, 0 for none */
+	uint8_t l3_end;
+	uint8_t l4_row;
+};
+
+struct dpaa2_ptype_l4 {
+	uint32_t packet_type;
+	uint16_t ol_flags;
+	uint16_t reserved;
+};
+
+struct dpaa2_ptype_tbl {
+	struct dpaa2_ptype_l3 l3[DPAA2_PTYPE_L3_NB];
+	struct dpaa2_ptype_l4 l4[DPAA2_PTYPE_L4_ROWS][DPAA2_PTYPE_L4_NB];
+};
+
+extern struct dpaa2_ptype_tbl dpaa2_ptype_tbl;
+
+static inline unsigned int
+dpaa2_ptype_l3_idx(uint64_t word3, uint64_t word4)
+{
+	return ((word3 >> 21) & DPAA2_PTYPE_L3_IDX_ETH) |
+	       (word3 & DPAA2_PTYPE_L3_IDX_ARP) |
+	       ((word3 >> 8) & DPAA2_PTYPE_L3_IDX_VLAN_1) |
+	       ((word3 >> 6) & DPAA2_PTYPE_L3_IDX_VLAN_N) |
+	       ((word4 >> 57) & DPAA2_PTYPE_L3_IDX_IPV4_1) |
+	       ((word4 >> 52) & DPAA2_PTYPE_L3_IDX_IPV4_N) |
+	       ((word4 >> 47) & DPAA2_PTYPE_L3_IDX_IPV6_1) |
+	       ((word4 >> 43) & DPAA2_PTYPE_L3_IDX_IPV6_N) |
+	       ((word4 >> 39) & DPAA2_PTYPE_L3_IDX_OPT_1) |
+	       ((word4 >> 21) & DPAA2_PTYPE_L3_IDX_GRE);
+}
+
+static inline unsigned int
+dpaa2_ptype_l4_idx(uint64_t word4, uint64_t word8)
+{
+	return ((word4 >> 25) & DPAA2_PTYPE_L4_IDX_UDP) |
+	       ((word4 >> 22) & DPAA2_PTYPE_L4_IDX_TCP) |
+	       ((word4 >> 12) & DPAA2_PTYPE_L4_IDX_SCTP) |
+	       ((word4 >> 35) & DPAA2_PTYPE_L4_IDX_ICMP) |
+	       (((word4 >> 41) | (word4 >> 40) | (word4 >> 36) |
+		 (word4 >> 35)) & DPAA2_PTYPE_L4_IDX_FRAG) |
+	       ((word8 << 3) & DPAA2_PTYPE_L4_IDX_L3CE) |
+	       ((word8 << 6) & DPAA2_PTYPE_L4_IDX_L4CE);
+}
+
+static inline void
+dpaa2_ptype_l3_init(struct dpaa2_ptype_l3 *e, unsigned int idx)
+{
+	unsigned int ip_1, ip_n;
+	uint32_t ptype;
+
+	memset(e, 0, sizeof(*e));
+	if (idx & DPAA2_PTYPE_L3_IDX_ARP) {
+		e->packet_type = RTE_PTYPE_L2_ETHER_ARP;
+		return;
+	}
+	if (!(idx & DPAA2_PTYPE_L3_IDX_ETH))
+		return;
+
+	ptype = RTE_PTYPE_L2_ETHER;
+	/* The tags are not stripped, PKT_RX_QINQ_PKT would report so */
+	if (idx & (DPAA2_PTYPE_L3_IDX_VLAN_1 | DPAA2_PTYPE_L3_IDX_VLAN_N))
+		e->ol_flags = PKT_RX_VLAN_PKT;
+
+	ip_1 = idx & (DPAA2_PTYPE_L3_IDX_IPV4_1 | DPAA2_PTYPE_L3_IDX_IPV6_1);
+	ip_n = idx & (DPAA2_PTYPE_L3_IDX_IPV4_N | DPAA2_PTYPE_L3_IDX_IPV6_N);
+	if (!ip_1) {
+		/* A lone last IP header is the only one */
+		ip_1 = ip_n >> 1;
+		ip_n = 0;
+	}
+
+	if (ip_1 & DPAA2_PTYPE_L3_IDX_IPV4_1)
+		ptype |= (idx & DPAA2_PTYPE_L3_IDX_OPT_1) ?
+			 RTE_PTYPE_L3_IPV4_EXT : RTE_PTYPE_L3_IPV4;
+	else if (ip_1 & DPAA2_PTYPE_L3_IDX_IPV6_1)
+		ptype |= (idx & DPAA2_PTYPE_L3_IDX_OPT_1) ?
+			 RTE_PTYPE_L3_IPV6_EXT : RTE_PTYPE_L3_IPV6;
+	else
+		goto done;
+
+	if (ip_n) {
+		ptype |= (idx & DPAA2_PTYPE_L3_IDX_GRE) ?
+			 RTE_PTYPE_TUNNEL_GRE : RTE_PTYPE_TUNNEL_IP;
+		ptype |= (ip_n & DPAA2_PTYPE_L3_IDX_IPV4_N) ?
+			 RTE_PTYPE_INNER_L3_IPV4 : RTE_PTYPE_INNER_L3_IPV6;
+		e->l3_end = (idx & DPAA2_PTYPE_L3_IDX_GRE) ?
+			    DPAA2_PTYPE_GRE_SHIFT : DPAA2_PTYPE_IP_N_SHIFT;
+		e->l4_row = DPAA2_PTYPE_L4_INNER;
+	} else if (idx & DPAA2_PTYPE_L3_IDX_GRE) {
+		ptype |= RTE_PTYPE_TUNNEL_GRE;
+		e->l3_end = DPAA2_PTYPE_GRE_SHIFT;
+		e->l4_row = DPAA2_PTYPE_L4_OUTER;
+	} else {
+		e->l3_end = DPAA2_PTYPE_L4_SHIFT;
+		e->l4_row = DPAA2_PTYPE_L4_OUTER;
+	}
+done:
+	e->packet_type = ptype;
+}
+
+static inline void
+dpaa2_ptype_l4_init(struct dpaa2_ptype_l4 *e, unsigned int row,
+		    unsigned int idx)
+{
+	uint32_t ptype;
+
+	memset(e, 0, sizeof(*e));
+	if (row == DPAA2_PTYPE_L4_NONE)
+		return;
+
+	if (idx & DPAA2_PTYPE_L4_IDX_L3CE)
+		e->ol_flags |= PKT_RX_IP_CKSUM_BAD;
+
+	/* Flags tested in the order of the former parse code */
+	if (idx & DPAA2_PTYPE_L4_IDX_FRAG)
+		ptype = RTE_PTYPE_L4_FRAG;
+	else if (idx & DPAA2_PTYPE_L4_IDX_UDP)
+		ptype = RTE_PTYPE_L4_UDP;
+	else if (idx & DPAA2_PTYPE_L4_IDX_TCP)
+		ptype = RTE_PTYPE_L4_TCP;
+	else if (idx & DPAA2_PTYPE_L4_IDX_SCTP)
+		ptype = RTE_PTYPE_L4_SCTP;
+	else if (idx & DPAA2_PTYPE_L4_IDX_ICMP)
+		ptype = RTE_PTYPE_L4_ICMP;
+	else
+		ptype = RTE_PTYPE_L4_NONFRAG;
+
+	if ((idx & DPAA2_PTYPE_L4_IDX_L4CE) &&
+	    ptype != RTE_PTYPE_L4_FRAG && ptype != RTE_PTYPE_L4_NONFRAG)
+		e->ol_flags |= PKT_RX_L4_CKSUM_BAD;
+
+	/* Inner L4 types are the outer ones shifted to their field */
+	if (row == DPAA2_PTYPE_L4_INNER)
+		ptype <<= 16;
+	e->packet_type = ptype;
+}
+
+/** Build the tables */
+static inline void
+dpaa2_ptype_tbl_init(struct dpaa2_ptype_tbl *tbl)
+{
+	unsigned int i, row;
+
+	for (i = 0; i < DPAA2_PTYPE_L3_NB; i++)
+		dpaa2_ptype_l3_init(&tbl->l3[i], i);
+	for (row = 0; row < DPAA2_PTYPE_L4_ROWS; row++)
+		for (i = 0; i < DPAA2_PTYPE_L4_NB; i++)
+			dpaa2_ptype_l4_init(&tbl->l4[row][i], row, i);
+}
+
+/**
+ * Set the packet type, offload flags and L2/L3 lengths of a received frame.
+ *
+ * @param annot
+ *   The hardware annotation of the frame.
+ * @param data
+ *   The frame, whose UDP header is read to find VXLAN.
+ */
+static inline void __attribute__((hot))
+dpaa2_ptype_lookup(const struct dpaa2_ptype_tbl *tbl,
+		   const struct dpaa2_annot_hdr *annot,
+		   const uint8_t *data, struct rte_mbuf *m)
+{
+	const struct dpaa2_ptype_l3 *l3;
+	const struct dpaa2_ptype_l4 *l4;
+	uint64_t word6 = annot->word6;
+	const uint8_t *udp;
+	uint32_t ptype;
+	uint8_t l2_len;
+
+	l3 = &tbl->l3[dpaa2_ptype_l3_idx(annot->word3, annot->word4)];
+	l4 = &tbl->l4[l3->l4_row][dpaa2_ptype_l4_idx(annot->word4,
+						      annot->word8)];
+
+	ptype = l3->packet_type | l4->packet_type;
+	m->ol_flags |= l3->ol_flags | l4->ol_flags;
+	if (l3->l3_end) {
+		l2_len = (uint8_t)(word6 >> DPAA2_PTYPE_IP_1_SHIFT);
+		m->l2_len = l2_len;
+		m->l3_len = (uint8_t)(word6 >> l3->l3_end) - l2_len;
+	} else {
+		m->l2_len = 0;
+		m->l3_len = 0;
+	}
+
+	if ((ptype & (RTE_PTYPE_L4_MASK | RTE_PTYPE_TUNNEL_MASK)) ==
+	    RTE_PTYPE_L4_UDP) {
+		/* Destination port, big endian */
+		udp = data + (uint8_t)(word6 >> DPAA2_PTYPE_L4_SHIFT);
+		if (((udp[2] << 8) | udp[3]) == DPAA2_VXLAN_UDP_PORT)
+			ptype |= RTE_PTYPE_TUNNEL_VXLAN |
+				 RTE_PTYPE_INNER_L2_ETHER;
+	}
+	m->packet_type = ptype;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DPAA2_HW_DPNI_PTYPE_H_ */
@@ -135,6 +135,7 @@ struct dpaa2_queue {
 		struct queue_storage_info_t *q_storage;
 		struct qbman_result *cscn;
 	};
+	struct rx_demux_queue *rx_demux; /*!< Backlog in multi-queue RX */
 };
 
 struct dpaa2_io_portal_t {
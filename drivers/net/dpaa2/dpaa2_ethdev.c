@@ -53,6 +53,8 @@
 #include <dpaa2_hw_dpni.h>
 #include <dpaa2_hw_dpio.h>
 
+#include <portal/pull_ring.h>
+
 /* DPDK Interfaces */
 #include <dpaa2_ethdev.h>
 
@@ -65,6 +67,43 @@ static int dpaa2_dev_set_link_up(struct rte_eth_dev *dev);
 static int dpaa2_dev_set_link_down(struct rte_eth_dev *dev);
 static int dpaa2_dev_mtu_set(struct rte_eth_dev *dev, uint16_t mtu);
 
+struct dpaa2_xstats_name_off {
+	char name[RTE_ETH_XSTATS_NAME_SIZE];
+	unsigned int offset;
+};
+
+/* Buffer stash of the pool of the port */
+static const struct dpaa2_xstats_name_off dpaa2_bm_stash_strings[] = {
+	{"bm_stash_get_hits", offsetof(struct bm_stash_stats, get_hits)},
+	{"bm_stash_get_misses", offsetof(struct bm_stash_stats, get_misses)},
+	{"bm_stash_get_fails", offsetof(struct bm_stash_stats, get_fails)},
+	{"bm_stash_put_hits", offsetof(struct bm_stash_stats, put_hits)},
+	{"bm_stash_put_misses", offsetof(struct bm_stash_stats, put_misses)},
+	{"bm_stash_acquires", offsetof(struct bm_stash_stats, acquires)},
+	{"bm_stash_releases", offsetof(struct bm_stash_stats, releases)},
+};
+
+#define DPAA2_NB_BM_STASH_XSTATS RTE_DIM(dpaa2_bm_stash_strings)
+
+/* Backlogs of the multi-queue RX, summed over the queues of the port */
+static const struct dpaa2_xstats_name_off dpaa2_rx_demux_strings[] = {
+	{"rx_multi_polls", offsetof(struct rx_demux_stats, polls)},
+	{"rx_multi_backlogged", offsetof(struct rx_demux_stats, backlogged)},
+	{"rx_multi_drops", offsetof(struct rx_demux_stats, drops)},
+};
+
+/* Pull rings of the multi-queue RX, shared by the ports of the portals */
+static const struct dpaa2_xstats_name_off dpaa2_pull_ring_strings[] = {
+	{"rx_multi_pulls", offsetof(struct pull_ring_stats, pulls)},
+	{"rx_multi_empty_pulls", offsetof(struct pull_ring_stats, empty)},
+	{"rx_multi_busy_pulls", offsetof(struct pull_ring_stats, busy)},
+};
+
+#define DPAA2_NB_RX_DEMUX_XSTATS RTE_DIM(dpaa2_rx_demux_strings)
+#define DPAA2_NB_PULL_RING_XSTATS RTE_DIM(dpaa2_pull_ring_strings)
+#define DPAA2_NB_XSTATS (DPAA2_NB_BM_STASH_XSTATS + \
+			 DPAA2_NB_RX_DEMUX_XSTATS + DPAA2_NB_PULL_RING_XSTATS)
+
 /**
  * Atomically reads the link status information from global
  * structure rte_eth_dev.
@@ -214,13 +253,26 @@ dpaa2_alloc_rx_tx_queues(struct rte_eth_dev *dev)
 	PMD_INIT_FUNC_TRACE();
 
 	tot_queues = priv->nb_rx_queues + priv->nb_tx_queues;
-	mc_q = rte_malloc(NULL, sizeof(struct dpaa2_queue) * tot_queues,
-			  RTE_CACHE_LINE_SIZE);
+	mc_q = rte_zmalloc(NULL, sizeof(struct dpaa2_queue) * tot_queues,
+			   RTE_CACHE_LINE_SIZE);
 	if (!mc_q) {
 		PMD_INIT_LOG(ERR, "malloc failed for rx/tx queues\n");
 		return -1;
 	}
 
+	if (priv->flags & DPAA2_RX_MULTI_QUEUE) {
+		priv->rx_demux = rte_zmalloc(NULL,
+			sizeof(struct rx_demux_queue) * priv->nb_rx_queues,
+			RTE_CACHE_LINE_SIZE);
+		if (!priv->rx_demux) {
+			PMD_INIT_LOG(ERR, "malloc failed for rx backlogs\n");
+			rte_free(mc_q);
+			return -1;
+		}
+		for (i = 0; i < priv->nb_rx_queues; i++)
+			rx_demux_queue_init(&priv->rx_demux[i]);
+	}
+
 	for (i = 0; i < priv->nb_rx_queues; i++) {
 		mc_q->dev = dev;
 		priv->rx_vq[i] = mc_q++;
@@ -235,6 +287,8 @@ dpaa2_alloc_rx_tx_queues(struct rte_eth_dev *dev)
 		       sizeof(struct queue_storage_info_t));
 		if (dpaa2_alloc_dq_storage(dpaa2_q->q_storage))
 			goto fail;
+		if (priv->rx_demux)
+			dpaa2_q->rx_demux = &priv->rx_demux[i];
 	}
 
 	for (i = 0; i < priv->nb_tx_queues; i++) {
@@ -276,6 +330,8 @@ fail:
 		priv->rx_vq[i--] = NULL;
 	}
 	rte_free(mc_q);
+	rte_free(priv->rx_demux);
+	priv->rx_demux = NULL;
 	return -1;
 }
 
@@ -530,8 +586,8 @@ static const uint32_t *
 dpaa2_supported_ptypes_get(struct rte_eth_dev *dev)
 {
 	static const uint32_t ptypes[] = {
-		/*todo -= add more types */
 		RTE_PTYPE_L2_ETHER,
+		RTE_PTYPE_L2_ETHER_ARP,
 		RTE_PTYPE_L3_IPV4,
 		RTE_PTYPE_L3_IPV4_EXT,
 		RTE_PTYPE_L3_IPV6,
@@ -540,12 +596,27 @@ dpaa2_supported_ptypes_get(struct rte_eth_dev *dev)
 		RTE_PTYPE_L4_UDP,
 		RTE_PTYPE_L4_SCTP,
 		RTE_PTYPE_L4_ICMP,
+		RTE_PTYPE_L4_FRAG,
+		RTE_PTYPE_L4_NONFRAG,
+		RTE_PTYPE_TUNNEL_IP,
+		RTE_PTYPE_TUNNEL_GRE,
+		RTE_PTYPE_TUNNEL_VXLAN,
+		RTE_PTYPE_INNER_L2_ETHER,
+		RTE_PTYPE_INNER_L3_IPV4,
+		RTE_PTYPE_INNER_L3_IPV6,
+		RTE_PTYPE_INNER_L4_TCP,
+		RTE_PTYPE_INNER_L4_UDP,
+		RTE_PTYPE_INNER_L4_SCTP,
+		RTE_PTYPE_INNER_L4_ICMP,
+		RTE_PTYPE_INNER_L4_FRAG,
+		RTE_PTYPE_INNER_L4_NONFRAG,
 		RTE_PTYPE_UNKNOWN
 	};
 
 	if (dev->rx_pkt_burst == dpaa2_dev_rx ||
 		dev->rx_pkt_burst == dpaa2_dev_prefetch_rx ||
-		dev->rx_pkt_burst == dpaa2_dev_prefetch2_rx)
+		dev->rx_pkt_burst == dpaa2_dev_prefetch2_rx ||
+		dev->rx_pkt_burst == dpaa2_dev_multi_rx)
 		return ptypes;
 	return NULL;
 }
@@ -817,6 +888,9 @@ dpaa2_dev_stop(struct rte_eth_dev *dev)
 
 	dpaa2_dev_set_link_down(dev);
 
+	if (priv->rx_demux)
+		dpaa2_dev_multi_rx_release(dev);
+
 	ret = dpni_disable(dpni, CMD_PRI_LOW, priv->token);
 	if (ret) {
 		PMD_INIT_LOG(ERR, "Failure (ret %d) in disabling dpni %d dev\n",
@@ -1155,6 +1229,70 @@ error:
 	return;
 };
 
+static int
+dpaa2_dev_xstats_get(struct rte_eth_dev *dev, struct rte_eth_xstat *xstats,
+		     unsigned int n)
+{
+	struct dpaa2_dev_priv *priv = dev->data->dev_private;
+	struct bm_stash_stats stats;
+	struct rx_demux_stats rx_stats;
+	struct pull_ring_stats ring_stats;
+	unsigned int i, j;
+	uint16_t bpid;
+
+	if (n < DPAA2_NB_XSTATS || !xstats)
+		return DPAA2_NB_XSTATS;
+
+	memset(&stats, 0, sizeof(stats));
+	if (priv->bp_list) {
+		bpid = priv->bp_list->buf_pool.bpid;
+		bm_stash_stats_get(&bpid_info[bpid].stash, &stats);
+	}
+	for (i = 0; i < DPAA2_NB_BM_STASH_XSTATS; i++)
+		xstats[i].value = *(uint64_t *)((char *)&stats +
+				dpaa2_bm_stash_strings[i].offset);
+
+	memset(&rx_stats, 0, sizeof(rx_stats));
+	for (j = 0; priv->rx_demux && j < priv->nb_rx_queues; j++) {
+		rx_stats.polls += priv->rx_demux[j].stats.polls;
+		rx_stats.backlogged += priv->rx_demux[j].stats.backlogged;
+		rx_stats.drops += priv->rx_demux[j].stats.drops;
+	}
+	for (j = 0; j < DPAA2_NB_RX_DEMUX_XSTATS; j++, i++)
+		xstats[i].value = *(uint64_t *)((char *)&rx_stats +
+				dpaa2_rx_demux_strings[j].offset);
+
+	dpaa2_dev_multi_rx_stats(&ring_stats);
+	for (j = 0; j < DPAA2_NB_PULL_RING_XSTATS; j++, i++)
+		xstats[i].value = *(uint64_t *)((char *)&ring_stats +
+				dpaa2_pull_ring_strings[j].offset);
+
+	return DPAA2_NB_XSTATS;
+}
+
+static int
+dpaa2_dev_xstats_get_names(struct rte_eth_dev *dev __rte_unused,
+			   struct rte_eth_xstat_name *xstats_names,
+			   unsigned int limit)
+{
+	unsigned int i, j;
+
+	if (limit < DPAA2_NB_XSTATS || !xstats_names)
+		return DPAA2_NB_XSTATS;
+
+	for (i = 0; i < DPAA2_NB_BM_STASH_XSTATS; i++)
+		snprintf(xstats_names[i].name, sizeof(xstats_names[i].name),
+			 "%s", dpaa2_bm_stash_strings[i].name);
+	for (j = 0; j < DPAA2_NB_RX_DEMUX_XSTATS; j++, i++)
+		snprintf(xstats_names[i].name, sizeof(xstats_names[i].name),
+			 "%s", dpaa2_rx_demux_strings[j].name);
+	for (j = 0; j < DPAA2_NB_PULL_RING_XSTATS; j++, i++)
+		snprintf(xstats_names[i].name, sizeof(xstats_names[i].name),
+			 "%s", dpaa2_pull_ring_strings[j].name);
+
+	return DPAA2_NB_XSTATS;
+}
+
 /* return 0 means link status changed, -1 means not changed */
 static int
 dpaa2_dev_link_update(struct rte_eth_dev *dev,
@@ -1323,6 +1461,8 @@ static struct eth_dev_ops dpaa2_ethdev_ops = {
 	.link_update	      = dpaa2_dev_link_update,
 	.stats_get	      = dpaa2_dev_stats_get,
 	.stats_reset	      = dpaa2_dev_stats_reset,
+	.xstats_get	      = dpaa2_dev_xstats_get,
+	.xstats_get_names     = dpaa2_dev_xstats_get_names,
 	.dev_infos_get	      = dpaa2_dev_info_get,
 	.dev_supported_ptypes_get = dpaa2_supported_ptypes_get,
 	.mtu_set	      = dpaa2_dev_mtu_set,
@@ -1354,6 +1494,9 @@ dpaa2_dev_init(struct rte_eth_dev *eth_dev)
 
 	PMD_INIT_FUNC_TRACE();
 
+	/* Per process, same table for all the interfaces */
+	dpaa2_ptype_tbl_init(&dpaa2_ptype_tbl);
+
 	/* For secondary processes, the primary has done all the work */
 	if (rte_eal_process_type() != RTE_PROC_PRIMARY)
 		return 0;
@@ -1442,6 +1585,18 @@ dpaa2_dev_init(struct rte_eth_dev *eth_dev)
 		PMD_INIT_LOG(INFO, "Disabling per queue tail drop on RX");
 	}
 
+	/*RX queues of a portal to be pulled together */
+	if (getenv("DPAA2_RX_MULTI_QUEUE")) {
+		if (getenv("DPAA2_RX_NO_PREFETCH") ||
+		    getenv("DPAA2_RX_PREFETCH_2")) {
+			PMD_INIT_LOG(ERR, "DPAA2_RX_MULTI_QUEUE cannot be set "
+				     "with another RX mode");
+			return -1;
+		}
+		priv->flags |= DPAA2_RX_MULTI_QUEUE;
+		PMD_INIT_LOG(INFO, "Enabling multi-queue RX");
+	}
+
 	ret = dpaa2_alloc_rx_tx_queues(eth_dev);
 	if (ret) {
 		PMD_INIT_LOG(ERR, "dpaa2_alloc_rx_tx_queuesFailed\n");
@@ -1528,6 +1683,8 @@ dpaa2_dev_init(struct rte_eth_dev *eth_dev)
 		/*If double prefetch is configured. */
 		eth_dev->rx_pkt_burst = dpaa2_dev_prefetch2_rx;
 		PMD_INIT_LOG(INFO, "Double Prefetch Enabled");
+	} else if (priv->flags & DPAA2_RX_MULTI_QUEUE) {
+		eth_dev->rx_pkt_burst = dpaa2_dev_multi_rx;
 	}
 
 	return 0;
@@ -1553,6 +1710,10 @@ dpaa2_dev_uninit(struct rte_eth_dev *eth_dev)
 
 	dpaa2_dev_close(eth_dev);
 
+	/* Queues not released by a stop */
+	if (priv->rx_vq[0] && priv->rx_demux)
+		dpaa2_dev_multi_rx_release(eth_dev);
+
 	if (priv->rx_vq[0]) {
 		/* cleaning up queue storage */
 		for (i = 0; i < priv->nb_rx_queues; i++) {
@@ -1564,6 +1725,8 @@ dpaa2_dev_uninit(struct rte_eth_dev *eth_dev)
 		rte_free(priv->rx_vq[0]);
 		priv->rx_vq[0] = NULL;
 	}
+	rte_free(priv->rx_demux);
+	priv->rx_demux = NULL;
 
 	/* Allocate memory for storing MAC addresses */
 	if (eth_dev->data->mac_addrs) {
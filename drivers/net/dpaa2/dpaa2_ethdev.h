@@ -39,6 +39,10 @@ uint16_t dpaa2_dev_prefetch_rx(void *queue, struct rte_mbuf **bufs,
 			       uint16_t nb_pkts);
 uint16_t dpaa2_dev_prefetch2_rx(void *queue, struct rte_mbuf **bufs,
 			       uint16_t nb_pkts);
+uint16_t dpaa2_dev_multi_rx(void *queue, struct rte_mbuf **bufs,
+			    uint16_t nb_pkts);
+void dpaa2_dev_multi_rx_release(struct rte_eth_dev *dev);
+void dpaa2_dev_multi_rx_stats(struct pull_ring_stats *stats);
 uint16_t dpaa2_dev_tx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts);
 uint16_t dummy_dev_tx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts);
 #endif /* _DPAA2_ETHDEV_H */
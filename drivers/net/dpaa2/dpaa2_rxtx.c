@@ -40,6 +40,8 @@
 #include <rte_string_fns.h>
 #include <rte_dev.h>
 #include <rte_ethdev.h>
+#include <rte_cycles.h>
+#include <rte_spinlock.h>
 
 /* DPAA2 Global constants */
 #include <dpaa2_logs.h>
@@ -50,11 +52,21 @@
 #include <dpaa2_hw_dpni.h>
 #include <dpaa2_hw_dpio.h>
 
+#include <portal/pull_ring.h>
+
 /* DPDP Interfaces */
 #include <dpaa2_ethdev.h>
 
 struct swp_active_dqs global_active_dqs_list[NUM_MAX_SWP];
 
+/* Pull rings of the multi-queue RX, per DPIO */
+static struct pull_ring *dpaa2_pull_ring[NUM_MAX_SWP];
+/* Serialize the polls of a pull ring with the release of its queues */
+static rte_spinlock_t dpaa2_pull_ring_lock[NUM_MAX_SWP];
+
+/* Time for the lcores to read the pulls outstanding on released queues */
+#define DPAA2_MULTI_RX_RELEASE_TIMEOUT_MS	100
+
 uint16_t
 dpaa2_dev_rx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
 {
@@ -444,6 +456,192 @@ repeat:
 	return num_rx;
 }
 
+/* Pull ring of the portal of the calling thread, set up on first use */
+static struct pull_ring *
+dpaa2_pull_ring_get(void)
+{
+	struct dpaa2_dpio_dev *dpio_dev = DPAA2_PER_LCORE_DPIO;
+	struct pull_ring *ring = dpaa2_pull_ring[dpio_dev->index];
+
+	if (ring)
+		return ring;
+	ring = rte_malloc("pull_ring", sizeof(struct pull_ring),
+			  RTE_CACHE_LINE_SIZE);
+	if (!ring)
+		return NULL;
+	pull_ring_init(ring, dpio_dev->sw_portal,
+		       (dma_addr_t)(DPAA2_VADDR_TO_IOVA(ring->storage)));
+	dpaa2_pull_ring[dpio_dev->index] = ring;
+	return ring;
+}
+
+/* Multi-queue RX: the RX queues polled by an lcore are pulled in turn by
+ * the pull ring of its portal, with several pulls outstanding. A receive
+ * reads the results written so far, of any queue, and issues the next
+ * pulls, without waiting for QBMAN. The frames of the other queues are
+ * kept in their backlog.
+ */
+uint16_t
+dpaa2_dev_multi_rx(void *queue, struct rte_mbuf **bufs, uint16_t nb_pkts)
+{
+	struct dpaa2_queue *dpaa2_q = (struct dpaa2_queue *)queue;
+	struct rx_demux_queue *rxq = dpaa2_q->rx_demux;
+	const struct qbman_result *dq;
+	const struct qbman_fd *fd;
+	struct qbman_result *active;
+	struct rx_demux_burst burst;
+	struct dpaa2_queue *rx_q;
+	struct pull_ring *ring;
+	struct rte_eth_dev *dev;
+	struct rte_mbuf *mbuf;
+	uint16_t num_rx = 0;
+	uint16_t dpio_id;
+	void *ctx;
+	int ret;
+
+	if (unlikely(!DPAA2_PER_LCORE_DPIO)) {
+		ret = dpaa2_affine_qbman_swp();
+		if (ret) {
+			RTE_LOG(ERR, PMD, "Failure in affining portal\n");
+			return 0;
+		}
+	}
+	dpio_id = DPAA2_PER_LCORE_DPIO->index;
+	rte_spinlock_lock(&dpaa2_pull_ring_lock[dpio_id]);
+
+	ret = rx_demux_queue_claim(rxq);
+	if (unlikely(ret)) {
+		if (ret < 0) {
+			PMD_RX_LOG(ERR, "rx fqid %d is polled by lcore %u",
+				   dpaa2_q->fqid, rx_demux_queue_owner(rxq));
+			goto out;
+		}
+		ring = dpaa2_pull_ring_get();
+		if (!ring ||
+		    pull_ring_add_queue(ring, dpaa2_q->fqid, dpaa2_q)) {
+			RTE_LOG(ERR, PMD, "No pull ring for rx fqid %d\n",
+				dpaa2_q->fqid);
+			rx_demux_queue_unclaim(rxq);
+			goto out;
+		}
+	}
+	ring = dpaa2_pull_ring[dpio_id];
+
+	if (rx_demux_burst_start(&burst, rxq, bufs, nb_pkts)) {
+		num_rx = nb_pkts;
+		goto out;
+	}
+
+	/* Wait for a pull of the other RX modes on the portal */
+	active = get_swp_active_dqs(dpio_id);
+	if (unlikely(active && !pull_ring_owns(ring, active))) {
+		while (!qbman_check_command_complete(ring->swp, active))
+			;
+		clear_swp_active_dqs(dpio_id);
+	}
+
+	pull_ring_issue(ring);
+	while (rx_demux_burst_room(&burst)) {
+		dq = pull_ring_next(ring, &ctx);
+		if (!dq)
+			break;
+		fd = qbman_result_DQ_fd(dq);
+		/* Prefetch Annotation address for the parse results */
+		rte_prefetch0((void *)((uint64_t)DPAA2_GET_FD_ADDR(fd)
+				+ DPAA2_FD_PTA_SIZE + 16));
+		if (unlikely(DPAA2_FD_GET_FORMAT(fd) == qbman_fd_sg))
+			mbuf = eth_sg_fd_to_mbuf(fd);
+		else
+			mbuf = eth_fd_to_mbuf(fd);
+
+		rx_q = (struct dpaa2_queue *)ctx;
+		if (unlikely(!rx_q)) {
+			/* Queue released since the pull */
+			rte_pktmbuf_free(mbuf);
+			continue;
+		}
+		dev = rx_q->dev;
+		mbuf->port = dev->data->port_id;
+		rx_q->rx_pkts++;
+		rx_demux_frame(&burst, rx_q->rx_demux, mbuf);
+	}
+	/* Pull again the queues just read, while the frames are processed */
+	pull_ring_issue(ring);
+	set_swp_active_dqs(dpio_id, pull_ring_pending(ring));
+	num_rx = rx_demux_burst_end(&burst);
+out:
+	rte_spinlock_unlock(&dpaa2_pull_ring_lock[dpio_id]);
+	return num_rx;
+}
+
+/* Stop pulling a queue on a portal, once the lcore polling the portal has
+ * read the pulls outstanding on it.
+ */
+static void
+dpaa2_pull_ring_release(int idx, struct dpaa2_queue *dpaa2_q,
+			uint64_t timeout)
+{
+	struct pull_ring *ring = dpaa2_pull_ring[idx];
+	unsigned int pending;
+
+	rte_spinlock_lock(&dpaa2_pull_ring_lock[idx]);
+	pull_ring_stop_queue(ring, dpaa2_q);
+	while ((pending = pull_ring_queue_pending(ring, dpaa2_q)) &&
+	       rte_get_timer_cycles() < timeout) {
+		rte_spinlock_unlock(&dpaa2_pull_ring_lock[idx]);
+		rte_delay_us(10);
+		rte_spinlock_lock(&dpaa2_pull_ring_lock[idx]);
+	}
+	if (pending) {
+		/* The frames are freed by the next poll of the portal */
+		RTE_LOG(WARNING, PMD, "%u pulls left on rx fqid %d\n",
+			pending, dpaa2_q->fqid);
+		pull_ring_del_queue(ring, dpaa2_q);
+	}
+	rte_spinlock_unlock(&dpaa2_pull_ring_lock[idx]);
+}
+
+/* Stop pulling the RX queues of a port in the multi-queue RX, and drop
+ * their backlog. The lcores may still poll the queues of other ports on
+ * their portal.
+ */
+void
+dpaa2_dev_multi_rx_release(struct rte_eth_dev *dev)
+{
+	struct dpaa2_dev_priv *priv = dev->data->dev_private;
+	uint64_t timeout = rte_get_timer_cycles() + rte_get_timer_hz() *
+			   DPAA2_MULTI_RX_RELEASE_TIMEOUT_MS / 1000;
+	struct dpaa2_queue *dpaa2_q;
+	int i, q;
+
+	for (q = 0; q < priv->nb_rx_queues; q++) {
+		dpaa2_q = (struct dpaa2_queue *)priv->rx_vq[q];
+		if (rx_demux_queue_owner(dpaa2_q->rx_demux) == LCORE_ID_ANY)
+			continue;
+		for (i = 0; i < NUM_MAX_SWP; i++)
+			if (dpaa2_pull_ring[i])
+				dpaa2_pull_ring_release(i, dpaa2_q, timeout);
+		rx_demux_queue_flush(dpaa2_q->rx_demux);
+		rx_demux_queue_unclaim(dpaa2_q->rx_demux);
+	}
+}
+
+/* Statistics of the pull rings of all the portals */
+void
+dpaa2_dev_multi_rx_stats(struct pull_ring_stats *stats)
+{
+	int i;
+
+	memset(stats, 0, sizeof(*stats));
+	for (i = 0; i < NUM_MAX_SWP; i++) {
+		if (!dpaa2_pull_ring[i])
+			continue;
+		stats->pulls += dpaa2_pull_ring[i]->stats.pulls;
+		stats->empty += dpaa2_pull_ring[i]->stats.empty;
+		stats->busy += dpaa2_pull_ring[i]->stats.busy;
+	}
+}
+
 /*
  * Callback to handle sending packets through WRIOP based interface
  */
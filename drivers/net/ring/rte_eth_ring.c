@@ -31,6 +31,13 @@
  *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#ifdef RTE_EXEC_ENV_LINUXAPP
+#include <sys/eventfd.h>
+#endif
+
 #include "rte_eth_ring.h"
 #include <rte_mbuf.h>
 #include <rte_ethdev.h>
@@ -41,6 +48,7 @@
 #include <rte_dev.h>
 #include <rte_kvargs.h>
 #include <rte_errno.h>
+#include <rte_interrupts.h>
 
 #define ETH_RING_NUMA_NODE_ACTION_ARG	"nodeaction"
 #define ETH_RING_ACTION_CREATE		"CREATE"
@@ -61,6 +69,11 @@ struct ring_queue {
 	rte_atomic64_t rx_pkts;
 	rte_atomic64_t tx_pkts;
 	rte_atomic64_t err_pkts;
+
+	/* RX interrupt, raised by the TX queues enqueuing to the ring */
+	int intr_fd;
+	volatile uint32_t intr_armed;
+	struct ring_queue * volatile intr_peer; /* RX queue to wake up on TX */
 };
 
 struct pmd_internals {
@@ -72,6 +85,11 @@ struct pmd_internals {
 
 	struct ether_addr address;
 	enum dev_action action;
+
+#ifdef RTE_EXEC_ENV_LINUXAPP
+	struct rte_intr_handle intr_handle;
+	int intr_vec[RTE_PMD_RING_MAX_RX_RINGS];
+#endif
 };
 
 
@@ -97,11 +115,25 @@ eth_ring_rx(void *q, struct rte_mbuf **bufs, uint16_t nb_bufs)
 	return nb_rx;
 }
 
+#ifdef RTE_EXEC_ENV_LINUXAPP
+static inline void
+eth_ring_intr_notify(struct ring_queue *rxq)
+{
+	/* the enqueue must be visible before reading the armed flag */
+	rte_smp_mb();
+	if (rxq->intr_armed && rte_atomic32_cmpset(&rxq->intr_armed, 1, 0))
+		eventfd_write(rxq->intr_fd, 1);
+}
+#endif
+
 static uint16_t
 eth_ring_tx(void *q, struct rte_mbuf **bufs, uint16_t nb_bufs)
 {
 	void **ptrs = (void *)&bufs[0];
 	struct ring_queue *r = q;
+#ifdef RTE_EXEC_ENV_LINUXAPP
+	struct ring_queue *peer;
+#endif
 	const uint16_t nb_tx = (uint16_t)rte_ring_enqueue_burst(r->rng,
 			ptrs, nb_bufs);
 	if (r->rng->flags & RING_F_SP_ENQ) {
@@ -111,15 +143,187 @@ eth_ring_tx(void *q, struct rte_mbuf **bufs, uint16_t nb_bufs)
 		rte_atomic64_add(&(r->tx_pkts), nb_tx);
 		rte_atomic64_add(&(r->err_pkts), nb_bufs - nb_tx);
 	}
+#ifdef RTE_EXEC_ENV_LINUXAPP
+	/* read once, the peer is cleared when its port stops */
+	peer = r->intr_peer;
+	if (unlikely(peer != NULL) && nb_tx > 0)
+		eth_ring_intr_notify(peer);
+#endif
 	return nb_tx;
 }
 
+static const struct eth_dev_ops ops;
+
+#ifdef RTE_EXEC_ENV_LINUXAPP
+/*
+ * Find the RX queue, with interrupts set up, which reads from a ring.
+ */
+static struct ring_queue *
+eth_ring_intr_find_rxq(const struct rte_ring *rng)
+{
+	struct pmd_internals *internals;
+	unsigned p, i;
+
+	for (p = 0; p < RTE_MAX_ETHPORTS; p++) {
+		if (!rte_eth_devices[p].attached ||
+		    rte_eth_devices[p].dev_ops != &ops)
+			continue;
+		internals = rte_eth_devices[p].data->dev_private;
+		if (internals->intr_handle.intr_vec == NULL)
+			continue;
+		for (i = 0; i < internals->intr_handle.nb_efd; i++)
+			if (internals->rx_ring_queues[i].rng == rng)
+				return &internals->rx_ring_queues[i];
+	}
+	return NULL;
+}
+
+/*
+ * Link every TX queue of the ring ports to the RX queue it has to wake
+ * up, if any. Called whenever RX interrupts are set up or torn down.
+ */
+static void
+eth_ring_intr_link(void)
+{
+	struct pmd_internals *internals;
+	struct ring_queue *txq;
+	unsigned p, i;
+
+	for (p = 0; p < RTE_MAX_ETHPORTS; p++) {
+		if (!rte_eth_devices[p].attached ||
+		    rte_eth_devices[p].dev_ops != &ops)
+			continue;
+		internals = rte_eth_devices[p].data->dev_private;
+		for (i = 0; i < internals->max_tx_queues; i++) {
+			txq = &internals->tx_ring_queues[i];
+			txq->intr_peer = eth_ring_intr_find_rxq(txq->rng);
+		}
+	}
+}
+
+static int
+eth_ring_intr_setup(struct rte_eth_dev *dev)
+{
+	struct pmd_internals *internals = dev->data->dev_private;
+	struct rte_intr_handle *handle = &internals->intr_handle;
+	unsigned nb_efd = RTE_MIN(dev->data->nb_rx_queues,
+			RTE_MAX_RXTX_INTR_VEC_ID);
+	struct ring_queue *rxq;
+	eventfd_t count;
+	unsigned i;
+	int ret;
+
+	for (i = 0; i < nb_efd; i++) {
+		rxq = &internals->rx_ring_queues[i];
+		if (rxq->intr_fd < 0) {
+			rxq->intr_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+			if (rxq->intr_fd < 0) {
+				ret = -errno;
+				RTE_LOG(ERR, PMD, "Cannot create eventfd: %s\n",
+					strerror(-ret));
+				return ret;
+			}
+		} else {
+			/* clear a notification raised while stopped */
+			eventfd_read(rxq->intr_fd, &count);
+		}
+		rxq->intr_armed = 0;
+		handle->efds[i] = rxq->intr_fd;
+	}
+	for (i = 0; i < dev->data->nb_rx_queues; i++)
+		internals->intr_vec[i] = RTE_INTR_VEC_RXTX_OFFSET + i;
+
+	handle->type = RTE_INTR_HANDLE_VDEV;
+	handle->fd = -1;
+	handle->efd_counter_size = sizeof(uint64_t);
+	handle->nb_efd = nb_efd;
+	/* as many vectors as efds, so that rte_intr_efd_disable keeps them */
+	handle->max_intr = nb_efd;
+	handle->intr_vec = internals->intr_vec;
+	dev->intr_handle = handle;
+
+	/* the efds must be visible before the TX queues can notify them */
+	rte_smp_wmb();
+	eth_ring_intr_link();
+	return 0;
+}
+
+static void
+eth_ring_intr_teardown(struct rte_eth_dev *dev)
+{
+	struct pmd_internals *internals = dev->data->dev_private;
+	struct rte_intr_handle *handle = &internals->intr_handle;
+	unsigned i;
+
+	if (handle->intr_vec == NULL)
+		return;
+
+	/* stop the TX queues from notifying */
+	for (i = 0; i < handle->nb_efd; i++)
+		internals->rx_ring_queues[i].intr_armed = 0;
+	handle->intr_vec = NULL;
+	dev->intr_handle = NULL;
+	eth_ring_intr_link();
+	rte_smp_mb();
+	/*
+	 * A TX queue of another port may still notify until it sees the
+	 * unlink, the efds are only removed from the epoll instances here
+	 * and stay open until the port is closed.
+	 */
+	rte_intr_efd_disable(handle);
+}
+
+static void
+eth_ring_intr_close(struct rte_eth_dev *dev)
+{
+	struct pmd_internals *internals = dev->data->dev_private;
+	unsigned i;
+
+	for (i = 0; i < RTE_PMD_RING_MAX_RX_RINGS; i++) {
+		if (internals->rx_ring_queues[i].intr_fd < 0)
+			continue;
+		close(internals->rx_ring_queues[i].intr_fd);
+		internals->rx_ring_queues[i].intr_fd = -1;
+	}
+}
+
+static int
+eth_rx_queue_intr_enable(struct rte_eth_dev *dev, uint16_t rx_queue_id)
+{
+	struct ring_queue *r = dev->data->rx_queues[rx_queue_id];
+
+	r->intr_armed = 1;
+	/* the flag must be visible before the caller polls the ring again */
+	rte_smp_mb();
+	return 0;
+}
+
+static int
+eth_rx_queue_intr_disable(struct rte_eth_dev *dev, uint16_t rx_queue_id)
+{
+	struct ring_queue *r = dev->data->rx_queues[rx_queue_id];
+
+	r->intr_armed = 0;
+	return 0;
+}
+#endif
+
 static int
 eth_dev_configure(struct rte_eth_dev *dev __rte_unused) { return 0; }
 
 static int
 eth_dev_start(struct rte_eth_dev *dev)
 {
+	if (dev->data->dev_conf.intr_conf.rxq) {
+#ifdef RTE_EXEC_ENV_LINUXAPP
+		int ret = eth_ring_intr_setup(dev);
+
+		if (ret < 0)
+			return ret;
+#else
+		return -ENOTSUP;
+#endif
+	}
 	dev->data->dev_link.link_status = ETH_LINK_UP;
 	return 0;
 }
@@ -127,9 +331,21 @@ eth_dev_start(struct rte_eth_dev *dev)
 static void
 eth_dev_stop(struct rte_eth_dev *dev)
 {
+#ifdef RTE_EXEC_ENV_LINUXAPP
+	eth_ring_intr_teardown(dev);
+#endif
 	dev->data->dev_link.link_status = ETH_LINK_DOWN;
 }
 
+static void
+eth_dev_close(struct rte_eth_dev *dev)
+{
+	eth_dev_stop(dev);
+#ifdef RTE_EXEC_ENV_LINUXAPP
+	eth_ring_intr_close(dev);
+#endif
+}
+
 static int
 eth_dev_set_link_down(struct rte_eth_dev *dev)
 {
@@ -244,6 +460,7 @@ eth_link_update(struct rte_eth_dev *dev __rte_unused,
 static const struct eth_dev_ops ops = {
 	.dev_start = eth_dev_start,
 	.dev_stop = eth_dev_stop,
+	.dev_close = eth_dev_close,
 	.dev_set_link_up = eth_dev_set_link_up,
 	.dev_set_link_down = eth_dev_set_link_down,
 	.dev_configure = eth_dev_configure,
@@ -257,6 +474,10 @@ static const struct eth_dev_ops ops = {
 	.stats_reset = eth_stats_reset,
 	.mac_addr_remove = eth_mac_addr_remove,
 	.mac_addr_add = eth_mac_addr_add,
+#ifdef RTE_EXEC_ENV_LINUXAPP
+	.rx_queue_intr_enable = eth_rx_queue_intr_enable,
+	.rx_queue_intr_disable = eth_rx_queue_intr_disable,
+#endif
 };
 
 static int
@@ -325,6 +546,8 @@ do_eth_dev_ring_create(const char *name,
 		internals->rx_ring_queues[i].rng = rx_queues[i];
 		data->rx_queues[i] = &internals->rx_ring_queues[i];
 	}
+	for (i = 0; i < RTE_PMD_RING_MAX_RX_RINGS; i++)
+		internals->rx_ring_queues[i].intr_fd = -1;
 	for (i = 0; i < nb_tx_queues; i++) {
 		internals->tx_ring_queues[i].rng = tx_queues[i];
 		data->tx_queues[i] = &internals->tx_ring_queues[i];
@@ -597,7 +820,7 @@ rte_pmd_ring_devuninit(const char *name)
 	if (eth_dev == NULL)
 		return -ENODEV;
 
-	eth_dev_stop(eth_dev);
+	eth_dev_close(eth_dev);
 
 	if (eth_dev->data) {
 		internals = eth_dev->data->dev_private;
@@ -104,6 +104,32 @@ virtio_user_kick_queue(struct virtio_user_dev *dev, uint32_t queue_sel)
 	return 0;
 }
 
+/*
+ * The backend writes the callfd of a virtqueue when it adds buffers to the
+ * used ring, unless interrupts are disabled in the avail ring. The callfds
+ * of the RX virtqueues are thus the RX interrupt fds of the device.
+ */
+static void
+virtio_user_intr_setup(struct virtio_user_dev *dev)
+{
+	struct rte_intr_handle *intr = &dev->intr_handle;
+	uint32_t i, nb_efd;
+
+	nb_efd = RTE_MIN(dev->max_queue_pairs,
+			 (uint32_t)RTE_MAX_RXTX_INTR_VEC_ID);
+	for (i = 0; i < nb_efd; i++) {
+		intr->efds[i] = dev->callfds[2 * i + VTNET_SQ_RQ_QUEUE_IDX];
+		dev->intr_vec[i] = RTE_INTR_VEC_RXTX_OFFSET + i;
+	}
+	intr->type = RTE_INTR_HANDLE_VDEV;
+	intr->fd = -1;
+	intr->efd_counter_size = sizeof(uint64_t);
+	intr->nb_efd = nb_efd;
+	/* the callfds are closed by virtio_user_dev_uninit() */
+	intr->max_intr = nb_efd;
+	intr->intr_vec = dev->intr_vec;
+}
+
 int
 virtio_user_start_device(struct virtio_user_dev *dev)
 {
@@ -130,6 +156,7 @@ virtio_user_start_device(struct virtio_user_dev *dev)
 			goto error;
 		}
 	}
+	virtio_user_intr_setup(dev);
 
 	/* After setup all virtqueues, we need to set_features so that these
 	 * features can be set into each virtqueue in vhost side. And before
@@ -153,6 +180,12 @@ error:
 
 int virtio_user_stop_device(struct virtio_user_dev *dev)
 {
+	/* remove the callfds from the epoll instances, they are renewed */
+	if (dev->intr_handle.intr_vec != NULL) {
+		rte_intr_efd_disable(&dev->intr_handle);
+		dev->intr_handle.intr_vec = NULL;
+	}
+
 	return vhost_user_sock(dev->vhostfd, VHOST_USER_RESET_OWNER, NULL);
 }
 
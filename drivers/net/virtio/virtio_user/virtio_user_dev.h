@@ -35,6 +35,7 @@
 #define _VIRTIO_USER_DEV_H
 
 #include <limits.h>
+#include <rte_interrupts.h>
 #include "../virtio_pci.h"
 #include "../virtio_ring.h"
 
@@ -51,6 +52,9 @@ struct virtio_user_dev {
 	uint8_t		mac_addr[ETHER_ADDR_LEN];
 	char		path[PATH_MAX];
 	struct vring	vrings[VIRTIO_MAX_VIRTQUEUES * 2 + 1];
+	/* RX interrupts, on the callfds of the RX virtqueues */
+	struct rte_intr_handle intr_handle;
+	int		intr_vec[VIRTIO_MAX_VIRTQUEUES];
 };
 
 int virtio_user_start_device(struct virtio_user_dev *dev);
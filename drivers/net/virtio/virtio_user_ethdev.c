@@ -309,6 +309,7 @@ virtio_user_eth_dev_alloc(const char *name)
 	data->kdrv = RTE_KDRV_NONE;
 	data->dev_flags = RTE_ETH_DEV_DETACHABLE;
 	eth_dev->pci_dev = NULL;
+	eth_dev->intr_handle = &dev->intr_handle;
 	eth_dev->driver = NULL;
 	return eth_dev;
 }
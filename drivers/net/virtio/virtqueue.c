@@ -49,6 +49,18 @@ virtqueue_disable_intr(struct virtqueue *vq)
 	vq->vq_ring.avail->flags |= VRING_AVAIL_F_NO_INTERRUPT;
 }
 
+void
+virtqueue_enable_intr(struct virtqueue *vq)
+{
+	/*
+	 * Clear VRING_AVAIL_F_NO_INTERRUPT so that the host interrupts
+	 * us when it adds buffers to the used ring. The flag must be
+	 * visible before the caller checks the used ring again.
+	 */
+	vq->vq_ring.avail->flags &= ~VRING_AVAIL_F_NO_INTERRUPT;
+	rte_smp_mb();
+}
+
 /*
  * Two types of mbuf to be cleaned:
  * 1) mbuf that has been consumed by backend but not used by virtio.
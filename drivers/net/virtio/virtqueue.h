@@ -268,6 +268,10 @@ vring_desc_init(struct vring_desc *dp, uint16_t n)
  * Tell the backend not to interrupt us.
  */
 void virtqueue_disable_intr(struct virtqueue *vq);
+/**
+ * Tell the backend to interrupt us.
+ */
+void virtqueue_enable_intr(struct virtqueue *vq);
 /**
  *  Dump virtqueue internal structures, for debug purpose only.
  */
@@ -45,14 +45,36 @@
 #include "esp.h"
 
 static inline int
-create_session(struct ipsec_ctx *ipsec_ctx __rte_unused, struct ipsec_sa *sa)
+create_session(struct ipsec_ctx *ipsec_ctx, struct ipsec_sa *sa)
 {
+	struct ipsec_proto_sess *ps = &ipsec_ctx->proto_sess[SPI2IDX(sa->spi)];
 	unsigned long cdev_id_qp = 0;
 	int32_t ret;
 	struct cdev_key key = { 0 };
+	struct rte_cryptodev_info cdev_info;
+	uint8_t cdev_id;
+
+	if (ps->foreign)
+		return -1;
 
 	key.lcore_id = (uint8_t)rte_lcore_id();
 
+	/*
+	 * The sequence number and the anti-replay window of a SA which may
+	 * be offloaded cannot be split between lcores, the first lcore to
+	 * process it owns it.
+	 */
+	if (!ps->checked && sa->proto_xforms != NULL &&
+			!rte_atomic32_cmpset(&sa->lcore_owner, 0,
+				rte_lcore_id() + 1) &&
+			sa->lcore_owner != rte_lcore_id() + 1) {
+		RTE_LOG(ERR, IPSEC, "SA spi %u is processed by core %u, "
+				"dropping its packets on core %u\n", sa->spi,
+				sa->lcore_owner - 1, rte_lcore_id());
+		ps->foreign = 1;
+		return -1;
+	}
+
 	key.cipher_algo = (uint8_t)sa->cipher_algo;
 	key.auth_algo = (uint8_t)sa->auth_algo;
 
@@ -70,10 +92,30 @@ create_session(struct ipsec_ctx *ipsec_ctx __rte_unused, struct ipsec_sa *sa)
 			ipsec_ctx->tbl[cdev_id_qp].id,
 			ipsec_ctx->tbl[cdev_id_qp].qp);
 
-	sa->crypto_session = rte_cryptodev_sym_session_create(
-			ipsec_ctx->tbl[cdev_id_qp].id, sa->xforms);
-
-	sa->cdev_id_qp = cdev_id_qp;
+	cdev_id = ipsec_ctx->tbl[cdev_id_qp].id;
+	rte_cryptodev_info_get(cdev_id, &cdev_info);
+
+	/* Let the device do the whole ESP transform when it can */
+	if (!ps->checked && (cdev_info.feature_flags &
+			RTE_CRYPTODEV_FF_IPSEC_PROTO_OFFLOAD) &&
+			sa->proto_xforms != NULL) {
+		ps->session = rte_cryptodev_sym_session_create(cdev_id,
+				sa->proto_xforms);
+		ps->cdev_id_qp = cdev_id_qp;
+		if (ps->session != NULL)
+			RTE_LOG(DEBUG, IPSEC, "SA spi %u uses ESP protocol "
+					"offload on core %u\n", sa->spi,
+					key.lcore_id);
+	}
+	ps->checked = 1;
+	if (ps->session != NULL)
+		return 0;
+
+	if (sa->crypto_session == NULL) {
+		sa->crypto_session = rte_cryptodev_sym_session_create(
+				cdev_id, sa->xforms);
+		sa->cdev_id_qp = cdev_id_qp;
+	}
 
 	return 0;
 }
@@ -108,6 +150,7 @@ ipsec_enqueue(ipsec_xform_fn xform_func, struct ipsec_ctx *ipsec_ctx,
 {
 	int32_t ret = 0, i;
 	struct ipsec_mbuf_metadata *priv;
+	struct ipsec_proto_sess *ps;
 	struct ipsec_sa *sa;
 
 	for (i = 0; i < nb_pkts; i++) {
@@ -128,12 +171,26 @@ ipsec_enqueue(ipsec_xform_fn xform_func, struct ipsec_ctx *ipsec_ctx,
 		rte_prefetch0(&priv->sym_cop);
 		priv->cop.sym = &priv->sym_cop;
 
-		if ((unlikely(sa->crypto_session == NULL)) &&
+		ps = &ipsec_ctx->proto_sess[SPI2IDX(sa->spi)];
+		if ((unlikely(!ps->checked || ps->foreign ||
+				(ps->session == NULL &&
+				sa->crypto_session == NULL))) &&
 				create_session(ipsec_ctx, sa)) {
 			rte_pktmbuf_free(pkts[i]);
 			continue;
 		}
 
+		if (ps->session != NULL) {
+			rte_crypto_op_attach_sym_session(&priv->cop,
+					ps->session);
+			priv->sym_cop.m_src = pkts[i];
+			priv->sym_cop.m_dst = NULL;
+			RTE_ASSERT(ps->cdev_id_qp < ipsec_ctx->nb_qps);
+			enqueue_cop(&ipsec_ctx->tbl[ps->cdev_id_qp],
+					&priv->cop);
+			continue;
+		}
+
 		rte_crypto_op_attach_sym_session(&priv->cop,
 				sa->crypto_session);
 
@@ -182,7 +239,12 @@ ipsec_dequeue(ipsec_xform_fn xform_func, struct ipsec_ctx *ipsec_ctx,
 
 			RTE_ASSERT(sa != NULL);
 
-			ret = xform_func(pkt, sa, cops[j]);
+			if (ipsec_ctx->proto_sess[SPI2IDX(sa->spi)].session !=
+					NULL)
+				ret = (cops[j]->status ==
+					RTE_CRYPTO_OP_STATUS_SUCCESS) ? 0 : -1;
+			else
+				ret = xform_func(pkt, sa, cops[j]);
 			if (unlikely(ret))
 				rte_pktmbuf_free(pkt);
 			else
@@ -36,6 +36,7 @@
 
 #include <stdint.h>
 
+#include <rte_atomic.h>
 #include <rte_byteorder.h>
 #include <rte_crypto.h>
 
@@ -107,6 +108,9 @@ struct ipsec_sa {
 	struct ip_addr src;
 	struct ip_addr dst;
 	struct rte_crypto_sym_xform *xforms;
+	struct rte_crypto_sym_xform *proto_xforms;
+	/* lcore + 1 processing a SA with proto_xforms, 0 until claimed */
+	volatile uint32_t lcore_owner;
 } __rte_cache_aligned;
 
 struct ipsec_mbuf_metadata {
@@ -123,6 +127,18 @@ struct cdev_qp {
 	struct rte_crypto_op *buf[MAX_PKT_BURST] __rte_aligned(sizeof(void *));
 };
 
+/*
+ * ESP protocol session of a SA. It holds the sequence number and the
+ * anti-replay window of the SA, which is then processed by the single
+ * lcore owning it.
+ */
+struct ipsec_proto_sess {
+	struct rte_cryptodev_sym_session *session;
+	uint32_t cdev_id_qp;
+	uint8_t checked; /* protocol offload tried, session NULL if refused */
+	uint8_t foreign; /* SA owned by another lcore, packets dropped */
+};
+
 struct ipsec_ctx {
 	struct rte_hash *cdev_map;
 	struct sp_ctx *sp4_ctx;
@@ -131,6 +147,7 @@ struct ipsec_ctx {
 	uint16_t nb_qps;
 	uint16_t last_qp;
 	struct cdev_qp tbl[MAX_QP_PER_LCORE];
+	struct ipsec_proto_sess proto_sess[IPSEC_SA_MAX_ENTRIES];
 };
 
 struct cdev_key {
@@ -35,6 +35,7 @@
  * Security Associations
  */
 #include <sys/types.h>
+#include <string.h>
 #include <netinet/in.h>
 #include <netinet/ip.h>
 #include <netinet/ip6.h>
@@ -291,6 +292,7 @@ struct sa_ctx {
 	struct {
 		struct rte_crypto_sym_xform a;
 		struct rte_crypto_sym_xform b;
+		struct rte_crypto_sym_xform proto;
 	} xf[IPSEC_SA_MAX_ENTRIES];
 };
 
@@ -322,6 +324,54 @@ sa_create(const char *name, int32_t socket_id)
 	return sa_ctx;
 }
 
+/*
+ * Build the IPsec protocol xform heading the cipher/auth chain. It is only
+ * used when the cryptodev advertises RTE_CRYPTODEV_FF_IPSEC_PROTO_OFFLOAD,
+ * otherwise sessions are created from sa->xforms and ESP is done in esp.c.
+ */
+static void
+sa_set_proto_xform(struct rte_crypto_sym_xform *xf, struct ipsec_sa *sa,
+		uint32_t inbound)
+{
+	struct rte_crypto_ipsec_xform *ipsec = &xf->ipsec;
+
+	memset(xf, 0, sizeof(*xf));
+	xf->type = RTE_CRYPTO_SYM_XFORM_IPSEC;
+	xf->next = sa->xforms;
+
+	ipsec->proto = RTE_CRYPTO_IPSEC_PROTO_ESP;
+	ipsec->spi = sa->spi;
+	ipsec->seq = sa->seq;
+
+	if (inbound) {
+		ipsec->direction = RTE_CRYPTO_IPSEC_DIR_INGRESS;
+		ipsec->replay_win_sz = RTE_CRYPTO_IPSEC_MAX_REPLAY_WIN_SZ;
+	} else
+		ipsec->direction = RTE_CRYPTO_IPSEC_DIR_EGRESS;
+
+	switch (sa->flags) {
+	case IP4_TUNNEL:
+		ipsec->mode = RTE_CRYPTO_IPSEC_MODE_TUNNEL;
+		ipsec->tunnel.type = RTE_CRYPTO_IPSEC_TUNNEL_IPV4;
+		ipsec->tunnel.ipv4.src_addr = sa->src.ip.ip4;
+		ipsec->tunnel.ipv4.dst_addr = sa->dst.ip.ip4;
+		ipsec->tunnel.ipv4.ttl = IPDEFTTL;
+		break;
+	case IP6_TUNNEL:
+		ipsec->mode = RTE_CRYPTO_IPSEC_MODE_TUNNEL;
+		ipsec->tunnel.type = RTE_CRYPTO_IPSEC_TUNNEL_IPV6;
+		memcpy(ipsec->tunnel.ipv6.src_addr, sa->src.ip.ip6.ip6_b, 16);
+		memcpy(ipsec->tunnel.ipv6.dst_addr, sa->dst.ip.ip6.ip6_b, 16);
+		ipsec->tunnel.ipv6.hlimit = IPDEFTTL;
+		break;
+	case TRANSPORT:
+		ipsec->mode = RTE_CRYPTO_IPSEC_MODE_TRANSPORT;
+		break;
+	}
+
+	sa->proto_xforms = xf;
+}
+
 static int
 sa_add_rules(struct sa_ctx *sa_ctx, const struct ipsec_sa entries[],
 		uint32_t nb_entries, uint32_t inbound)
@@ -366,6 +416,8 @@ sa_add_rules(struct sa_ctx *sa_ctx, const struct ipsec_sa entries[],
 		sa_ctx->xf[idx].a.next = &sa_ctx->xf[idx].b;
 		sa_ctx->xf[idx].b.next = NULL;
 		sa->xforms = &sa_ctx->xf[idx].a;
+
+		sa_set_proto_xform(&sa_ctx->xf[idx].proto, sa, inbound);
 	}
 
 	return 0;
@@ -66,6 +66,9 @@
 
 #include <rte_errno.h>
 #include <rte_jobstats.h>
+#ifdef RTE_LIBRTE_PMU
+#include <rte_pmu.h>
+#endif
 #include <rte_timer.h>
 #include <rte_alarm.h>
 
@@ -163,6 +166,30 @@ cycles_to_ns(uint64_t cycles)
 	return t;
 }
 
+#ifdef RTE_LIBRTE_PMU
+static void
+show_job_pmu(const uint64_t *pmu, uint64_t exec_cnt)
+{
+	uint64_t cycles = pmu[RTE_PMU_CYCLES];
+
+	if (exec_cnt == 0)
+		exec_cnt = 1;
+
+	printf("\n%-18s %14.2f"
+			"\n%-18s %'14.1f"
+			"\n%-18s %'14.1f"
+			"\n%-18s %'14.1f",
+			"IPC:", cycles ?
+				(double)pmu[RTE_PMU_INSTRUCTIONS] / cycles : 0,
+			"L1D misses/exec:",
+				(double)pmu[RTE_PMU_L1D_MISSES] / exec_cnt,
+			"LLC misses/exec:",
+				(double)pmu[RTE_PMU_LLC_MISSES] / exec_cnt,
+			"Br misses/exec:",
+				(double)pmu[RTE_PMU_BRANCH_MISSES] / exec_cnt);
+}
+#endif
+
 static void
 show_lcore_stats(unsigned lcore_id)
 {
@@ -182,6 +209,7 @@ show_lcore_stats(unsigned lcore_id)
 	uint64_t jobs_exec_cnt[port_cnt], jobs_period[port_cnt];
 	uint64_t jobs_exec[port_cnt], jobs_exec_min[port_cnt],
 				jobs_exec_max[port_cnt];
+	uint64_t jobs_pmu[port_cnt][RTE_JOBSTATS_PMU_EVENTS];
 
 	uint64_t flush_exec_cnt, flush_period;
 	uint64_t flush_exec, flush_exec_min, flush_exec_max;
@@ -218,6 +246,7 @@ show_lcore_stats(unsigned lcore_id)
 		jobs_exec[i] = job->exec_time;
 		jobs_exec_min[i] = job->min_exec_time;
 		jobs_exec_max[i] = job->max_exec_time;
+		memcpy(jobs_pmu[i], job->pmu_exec, sizeof(jobs_pmu[i]));
 
 		rte_jobstats_reset(job);
 	}
@@ -296,6 +325,10 @@ show_lcore_stats(unsigned lcore_id)
 						: 0),
 				cycles_to_ns(jobs_exec_min[i]),
 				cycles_to_ns(jobs_exec_max[i]));
+#ifdef RTE_LIBRTE_PMU
+		if (ctx->pmu_enabled)
+			show_job_pmu(jobs_pmu[i], jobs_exec_cnt[i]);
+#endif
 	}
 
 	if (qconf->n_rx_port > 0) {
@@ -528,6 +561,14 @@ l2fwd_main_loop(void)
 
 	rte_jobstats_init(&qconf->idle_job, "idle", 0, 0, 0, 0);
 
+#ifdef RTE_LIBRTE_PMU
+	/* Sample the hardware counters of the forwarding jobs if possible. */
+	if (rte_jobstats_context_pmu_enable(&qconf->jobs_context,
+			RTE_PMU_ALL_EVENTS) != 0)
+		RTE_LOG(INFO, L2FWD, "lcore %u: hardware counters unavailable\n",
+			lcore_id);
+#endif
+
 	for (;;) {
 		rte_spinlock_lock(&qconf->lock);
 
@@ -75,6 +75,7 @@
 #include <rte_string_fns.h>
 #include <rte_timer.h>
 #include <rte_power.h>
+#include <rte_power_poll.h>
 #include <rte_eal.h>
 #include <rte_spinlock.h>
 
@@ -82,15 +83,13 @@
 
 #define MAX_PKT_BURST 32
 
-#define MIN_ZERO_POLL_COUNT 10
-
 /* around 100ms at 2 Ghz */
 #define TIMER_RESOLUTION_CYCLES           200000000ULL
 /* 100 ms interval */
 #define TIMER_NUMBER_PER_SECOND           10
-/* 100000 us */
-#define SCALING_PERIOD                    (1000000/TIMER_NUMBER_PER_SECOND)
 #define SCALING_DOWN_TIME_RATIO_THRESHOLD 0.25
+/* longest sleep, so that the timers keep running */
+#define MAX_SLEEP_MS                      (1000/TIMER_NUMBER_PER_SECOND)
 
 #define APP_LOOKUP_EXACT_MATCH          0
 #define APP_LOOKUP_LPM                  1
@@ -156,15 +155,16 @@ static uint16_t nb_txd = RTE_TEST_TX_DESC_DEFAULT;
 /* ethernet addresses of ports */
 static struct ether_addr ports_eth_addr[RTE_MAX_ETHPORTS];
 
-/* ethernet addresses of ports */
-static rte_spinlock_t locks[RTE_MAX_ETHPORTS];
-
 /* mask of enabled ports */
 static uint32_t enabled_port_mask = 0;
 /* Ports set in promiscuous mode off by default. */
 static int promiscuous_on = 0;
 /* NUMA is enabled by default. */
 static int numa_on = 1;
+/* empty polls in a row before sleeping */
+static uint32_t idle_polls = RTE_POWER_POLL_IDLE_POLLS;
+/* period of the per-lcore report in seconds, 0 to disable it */
+static uint32_t report_period = 10;
 
 enum freq_scale_hint_t
 {
@@ -178,8 +178,6 @@ struct lcore_rx_queue {
 	uint8_t port_id;
 	uint8_t queue_id;
 	enum freq_scale_hint_t freq_up_hint;
-	uint32_t zero_rx_packet_count;
-	uint32_t idle_hint;
 } __rte_cache_aligned;
 
 #define MAX_RX_QUEUE_PER_LCORE 16
@@ -352,8 +350,8 @@ struct lcore_conf {
 } __rte_cache_aligned;
 
 struct lcore_stats {
-	/* total sleep time in ms since last frequency scaling down */
-	uint32_t sleep_time;
+	/* sleep cycles at the last frequency scaling check */
+	uint64_t sleep_cycles;
 	/* number of long sleep recently */
 	uint32_t nb_long_sleep;
 	/* freq. scaling up trend */
@@ -362,14 +360,27 @@ struct lcore_stats {
 	uint64_t nb_rx_processed;
 	/* total iterations looped recently */
 	uint64_t nb_iteration_looped;
-	uint32_t padding[9];
+} __rte_cache_aligned;
+
+/* measurements printed by the periodic report */
+struct lcore_report {
+	/* TSC and adaptive polling statistics at the last report */
+	uint64_t tsc;
+	struct rte_power_poll_stats last;
+	/* number of bursts forwarded and their RX to TX latency in cycles */
+	uint64_t nb_bursts;
+	uint64_t latency;
+	uint64_t max_latency;
+	uint64_t nb_pkts;
 } __rte_cache_aligned;
 
 static struct lcore_conf lcore_conf[RTE_MAX_LCORE] __rte_cache_aligned;
 static struct lcore_stats stats[RTE_MAX_LCORE] __rte_cache_aligned;
+static struct rte_power_poll power_poll[RTE_MAX_LCORE];
+static struct lcore_report reports[RTE_MAX_LCORE];
 static struct rte_timer power_timers[RTE_MAX_LCORE];
+static struct rte_timer report_timers[RTE_MAX_LCORE];
 
-static inline uint32_t power_idle_heuristic(uint32_t zero_rx_packet_count);
 static inline enum freq_scale_hint_t power_freq_scaleup_heuristic( \
 			unsigned lcore_id, uint8_t port_id, uint16_t queue_id);
 
@@ -405,10 +416,11 @@ power_timer_cb(__attribute__((unused)) struct rte_timer *tim,
 	uint64_t hz;
 	float sleep_time_ratio;
 	unsigned lcore_id = rte_lcore_id();
+	uint64_t sleep_cycles = power_poll[lcore_id].stats.sleep_cycles;
 
-	/* accumulate total execution time in us when callback is invoked */
-	sleep_time_ratio = (float)(stats[lcore_id].sleep_time) /
-					(float)SCALING_PERIOD;
+	/* ratio of the last period spent sleeping */
+	sleep_time_ratio = (float)(sleep_cycles - stats[lcore_id].sleep_cycles)
+		/ (float)(rte_get_tsc_hz() / TIMER_NUMBER_PER_SECOND);
 	/**
 	 * check whether need to scale down frequency a step if it sleep a lot.
 	 */
@@ -437,7 +449,41 @@ power_timer_cb(__attribute__((unused)) struct rte_timer *tim,
 	stats[lcore_id].nb_rx_processed = 0;
 	stats[lcore_id].nb_iteration_looped = 0;
 
-	stats[lcore_id].sleep_time = 0;
+	stats[lcore_id].sleep_cycles = sleep_cycles;
+}
+
+/* Periodic report of the CPU use and latency of an lcore */
+static void
+report_timer_cb(__attribute__((unused)) struct rte_timer *tim,
+		__attribute__((unused)) void *arg)
+{
+	unsigned lcore_id = rte_lcore_id();
+	struct rte_power_poll_stats *cur = &power_poll[lcore_id].stats;
+	struct lcore_report *report = &reports[lcore_id];
+	struct rte_power_poll_stats *last = &report->last;
+	double us = 1E6 / rte_get_tsc_hz();
+	uint64_t now = rte_rdtsc();
+	uint64_t period = now - report->tsc;
+	uint64_t sleeps = cur->sleeps - last->sleeps;
+	uint64_t sleep_cycles = cur->sleep_cycles - last->sleep_cycles;
+
+	printf("lcore %u: busy %5.1f%%, %" PRIu64 " sleeps (%" PRIu64
+		" woken up by RX interrupts, %.1f us on average), %" PRIu64
+		" pkts, RX to TX latency %.2f us average, %.2f us max\n",
+		lcore_id, 100.0 - 100.0 * sleep_cycles / period, sleeps,
+		cur->intr_wakeups - last->intr_wakeups,
+		sleeps ? sleep_cycles * us / sleeps : 0.0,
+		report->nb_pkts,
+		report->nb_bursts ?
+			report->latency * us / report->nb_bursts : 0.0,
+		report->max_latency * us);
+
+	*last = *cur;
+	report->tsc = now;
+	report->nb_bursts = 0;
+	report->latency = 0;
+	report->max_latency = 0;
+	report->nb_pkts = 0;
 }
 
 /* Enqueue a single packet, and send burst if queue is filled */
@@ -687,24 +733,6 @@ l3fwd_simple_forward(struct rte_mbuf *m, uint8_t portid,
 
 }
 
-#define MINIMUM_SLEEP_TIME         1
-#define SUSPEND_THRESHOLD          300
-
-static inline uint32_t
-power_idle_heuristic(uint32_t zero_rx_packet_count)
-{
-	/* If zero count is less than 100,  sleep 1us */
-	if (zero_rx_packet_count < SUSPEND_THRESHOLD)
-		return MINIMUM_SLEEP_TIME;
-	/* If zero count is less than 1000, sleep 100 us which is the
-		minimum latency switching from C3/C6 to C0
-	*/
-	else
-		return SUSPEND_THRESHOLD;
-
-	return 0;
-}
-
 static inline enum freq_scale_hint_t
 power_freq_scaleup_heuristic(unsigned lcore_id,
 			     uint8_t port_id,
@@ -740,85 +768,6 @@ power_freq_scaleup_heuristic(unsigned lcore_id,
 	return FREQ_CURRENT;
 }
 
-/**
- * force polling thread sleep until one-shot rx interrupt triggers
- * @param port_id
- *  Port id.
- * @param queue_id
- *  Rx queue id.
- * @return
- *  0 on success
- */
-static int
-sleep_until_rx_interrupt(int num)
-{
-	struct rte_epoll_event event[num];
-	int n, i;
-	uint8_t port_id, queue_id;
-	void *data;
-
-	RTE_LOG(INFO, L3FWD_POWER,
-		"lcore %u sleeps until interrupt triggers\n",
-		rte_lcore_id());
-
-	n = rte_epoll_wait(RTE_EPOLL_PER_THREAD, event, num, -1);
-	for (i = 0; i < n; i++) {
-		data = event[i].epdata.data;
-		port_id = ((uintptr_t)data) >> CHAR_BIT;
-		queue_id = ((uintptr_t)data) &
-			RTE_LEN2MASK(CHAR_BIT, uint8_t);
-		rte_eth_dev_rx_intr_disable(port_id, queue_id);
-		RTE_LOG(INFO, L3FWD_POWER,
-			"lcore %u is waked up from rx interrupt on"
-			" port %d queue %d\n",
-			rte_lcore_id(), port_id, queue_id);
-	}
-
-	return 0;
-}
-
-static void turn_on_intr(struct lcore_conf *qconf)
-{
-	int i;
-	struct lcore_rx_queue *rx_queue;
-	uint8_t port_id, queue_id;
-
-	for (i = 0; i < qconf->n_rx_queue; ++i) {
-		rx_queue = &(qconf->rx_queue_list[i]);
-		port_id = rx_queue->port_id;
-		queue_id = rx_queue->queue_id;
-
-		rte_spinlock_lock(&(locks[port_id]));
-		rte_eth_dev_rx_intr_enable(port_id, queue_id);
-		rte_spinlock_unlock(&(locks[port_id]));
-	}
-}
-
-static int event_register(struct lcore_conf *qconf)
-{
-	struct lcore_rx_queue *rx_queue;
-	uint8_t portid, queueid;
-	uint32_t data;
-	int ret;
-	int i;
-
-	for (i = 0; i < qconf->n_rx_queue; ++i) {
-		rx_queue = &(qconf->rx_queue_list[i]);
-		portid = rx_queue->port_id;
-		queueid = rx_queue->queue_id;
-		data = portid << CHAR_BIT | queueid;
-
-		ret = rte_eth_dev_rx_intr_ctl_q(portid, queueid,
-						RTE_EPOLL_PER_THREAD,
-						RTE_INTR_EVENT_ADD,
-						(void *)((uintptr_t)data));
-		if (ret)
-			return ret;
-	}
-
-	return 0;
-}
-
 /* main processing loop */
 static int
 main_loop(__attribute__((unused)) void *dummy)
@@ -832,9 +781,15 @@ main_loop(__attribute__((unused)) void *dummy)
 	struct lcore_conf *qconf;
 	struct lcore_rx_queue *rx_queue;
 	enum freq_scale_hint_t lcore_scaleup_hint;
-	uint32_t lcore_rx_idle_count = 0;
-	uint32_t lcore_idle_hint = 0;
-	int intr_en = 0;
+	struct rte_power_poll *pp;
+	struct lcore_report *report;
+	uint32_t lcore_nb_rx;
+	uint64_t rx_tsc, latency;
+	const struct rte_power_poll_conf poll_conf = {
+		.idle_polls = idle_polls,
+		.max_sleep_ms = MAX_SLEEP_MS,
+		.fallback_sleep_us = RTE_POWER_POLL_FALLBACK_SLEEP_US,
+	};
 
 	const uint64_t drain_tsc = (rte_get_tsc_hz() + US_PER_S - 1) / US_PER_S * BURST_TX_DRAIN_US;
 
@@ -842,6 +797,9 @@ main_loop(__attribute__((unused)) void *dummy)
 
 	lcore_id = rte_lcore_id();
 	qconf = &lcore_conf[lcore_id];
+	pp = &power_poll[lcore_id];
+	report = &reports[lcore_id];
+	report->tsc = rte_rdtsc();
 
 	if (qconf->n_rx_queue == 0) {
 		RTE_LOG(INFO, L3FWD_POWER, "lcore %u has nothing to do\n", lcore_id);
@@ -857,11 +815,15 @@ main_loop(__attribute__((unused)) void *dummy)
 			"rxqueueid=%hhu\n", lcore_id, portid, queueid);
 	}
 
-	/* add into event wait list */
-	if (event_register(qconf) == 0)
-		intr_en = 1;
-	else
-		RTE_LOG(INFO, L3FWD_POWER, "RX interrupt won't enable.\n");
+	/* sleep on the RX interrupts of the queues when idle */
+	rte_power_poll_init(pp, &poll_conf);
+	for (i = 0; i < qconf->n_rx_queue; i++) {
+		portid = qconf->rx_queue_list[i].port_id;
+		queueid = qconf->rx_queue_list[i].queue_id;
+		if (rte_power_poll_queue_add(pp, portid, queueid) < 0)
+			rte_exit(EXIT_FAILURE, "Cannot poll port %hhu "
+				"queue %hhu\n", portid, queueid);
+	}
 
 	while (1) {
 		stats[lcore_id].nb_iteration_looped++;
@@ -889,15 +851,13 @@ main_loop(__attribute__((unused)) void *dummy)
 			prev_tsc_power = cur_tsc_power;
 		}
 
-start_rx:
 		/*
 		 * Read packet from RX queues
 		 */
 		lcore_scaleup_hint = FREQ_CURRENT;
-		lcore_rx_idle_count = 0;
+		lcore_nb_rx = 0;
 		for (i = 0; i < qconf->n_rx_queue; ++i) {
 			rx_queue = &(qconf->rx_queue_list[i]);
-			rx_queue->idle_hint = 0;
 			portid = rx_queue->port_id;
 			queueid = rx_queue->queue_id;
 
@@ -905,34 +865,21 @@ start_rx:
 								MAX_PKT_BURST);
 
 			stats[lcore_id].nb_rx_processed += nb_rx;
-			if (unlikely(nb_rx == 0)) {
-				/**
-				 * no packet received from rx queue, try to
-				 * sleep for a while forcing CPU enter deeper
-				 * C states.
-				 */
-				rx_queue->zero_rx_packet_count++;
-
-				if (rx_queue->zero_rx_packet_count <=
-							MIN_ZERO_POLL_COUNT)
-					continue;
+			if (nb_rx == 0)
+				continue;
 
-				rx_queue->idle_hint = power_idle_heuristic(\
-					rx_queue->zero_rx_packet_count);
-				lcore_rx_idle_count++;
-			} else {
-				rx_queue->zero_rx_packet_count = 0;
+			rx_tsc = rte_rdtsc();
+			lcore_nb_rx += nb_rx;
 
-				/**
-				 * do not scale up frequency immediately as
-				 * user to kernel space communication is costly
-				 * which might impact packet I/O for received
-				 * packets.
-				 */
-				rx_queue->freq_up_hint =
-					power_freq_scaleup_heuristic(lcore_id,
-							portid, queueid);
-			}
+			/**
+			 * do not scale up frequency immediately as
+			 * user to kernel space communication is costly
+			 * which might impact packet I/O for received
+			 * packets.
+			 */
+			rx_queue->freq_up_hint =
+				power_freq_scaleup_heuristic(lcore_id,
+						portid, queueid);
 
 			/* Prefetch first packets */
 			for (j = 0; j < PREFETCH_OFFSET && j < nb_rx; j++) {
@@ -953,9 +900,17 @@ start_rx:
 				l3fwd_simple_forward(pkts_burst[j], portid,
 								qconf);
 			}
+
+			/* time from RX to the hand over of the burst to TX */
+			latency = rte_rdtsc() - rx_tsc;
+			report->nb_bursts++;
+			report->nb_pkts += nb_rx;
+			report->latency += latency;
+			if (latency > report->max_latency)
+				report->max_latency = latency;
 		}
 
-		if (likely(lcore_rx_idle_count != qconf->n_rx_queue)) {
+		if (likely(lcore_nb_rx != 0)) {
 			for (i = 1, lcore_scaleup_hint =
 				qconf->rx_queue_list[0].freq_up_hint;
 					i < qconf->n_rx_queue; ++i) {
@@ -973,39 +928,13 @@ start_rx:
 				if (rte_power_freq_up)
 					rte_power_freq_up(lcore_id);
 			}
-		} else {
-			/**
-			 * All Rx queues empty in recent consecutive polls,
-			 * sleep in a conservative manner, meaning sleep as
-			 * less as possible.
-			 */
-			for (i = 1, lcore_idle_hint =
-				qconf->rx_queue_list[0].idle_hint;
-					i < qconf->n_rx_queue; ++i) {
-				rx_queue = &(qconf->rx_queue_list[i]);
-				if (rx_queue->idle_hint < lcore_idle_hint)
-					lcore_idle_hint = rx_queue->idle_hint;
-			}
-
-			if (lcore_idle_hint < SUSPEND_THRESHOLD)
-				/**
-				 * execute "pause" instruction to avoid context
-				 * switch which generally take hundred of
-				 * microseconds for short sleep.
-				 */
-				rte_delay_us(lcore_idle_hint);
-			else {
-				/* suspend until rx interrupt trigges */
-				if (intr_en) {
-					turn_on_intr(qconf);
-					sleep_until_rx_interrupt(
-						qconf->n_rx_queue);
-				}
-				/* start receiving packets immediately */
-				goto start_rx;
-			}
-			stats[lcore_id].sleep_time += lcore_idle_hint;
 		}
+
+		/**
+		 * After enough consecutive empty polls of all the RX queues,
+		 * sleep until an RX interrupt triggers or the timers expire.
+		 */
+		rte_power_poll_update(pp, lcore_nb_rx);
 	}
 }
 
@@ -1103,14 +1032,34 @@ print_usage(const char *prgname)
 {
 	printf ("%s [EAL options] -- -p PORTMASK -P"
 		"  [--config (port,queue,lcore)[,(port,queue,lcore]]"
-		"  [--enable-jumbo [--max-pkt-len PKTLEN]]\n"
+		"  [--enable-jumbo [--max-pkt-len PKTLEN]]"
+		"  [--idle-polls N] [--report SECONDS]\n"
 		"  -p PORTMASK: hexadecimal bitmask of ports to configure\n"
 		"  -P : enable promiscuous mode\n"
 		"  --config (port,queue,lcore): rx queues configuration\n"
 		"  --no-numa: optional, disable numa awareness\n"
 		"  --enable-jumbo: enable jumbo frame"
-		" which max packet len is PKTLEN in decimal (64-9600)\n",
-		prgname);
+		" which max packet len is PKTLEN in decimal (64-9600)\n"
+		"  --idle-polls N: empty polls before sleeping (default %u)\n"
+		"  --report SECONDS: period of the CPU use and latency report"
+		" (default 10, 0 to disable)\n",
+		prgname, RTE_POWER_POLL_IDLE_POLLS);
+}
+
+static int parse_uint(const char *arg)
+{
+	char *end = NULL;
+	unsigned long val;
+
+	/* parse decimal string */
+	val = strtoul(arg, &end, 10);
+	if ((arg[0] == '\0') || (end == NULL) || (*end != '\0'))
+		return -1;
+
+	if (val > INT32_MAX)
+		return -1;
+
+	return val;
 }
 
 static int parse_max_pkt_len(const char *pktlen)
@@ -1215,6 +1164,8 @@ parse_args(int argc, char **argv)
 		{"config", 1, 0, 0},
 		{"no-numa", 0, 0, 0},
 		{"enable-jumbo", 0, 0, 0},
+		{"idle-polls", 1, 0, 0},
+		{"report", 1, 0, 0},
 		{NULL, 0, 0, 0}
 	};
 
@@ -1255,6 +1206,27 @@ parse_args(int argc, char **argv)
 				numa_on = 0;
 			}
 
+			if (!strcmp(lgopts[option_index].name,
+					"idle-polls")) {
+				ret = parse_uint(optarg);
+				if (ret <= 0) {
+					printf("invalid idle polls\n");
+					print_usage(prgname);
+					return -1;
+				}
+				idle_polls = ret;
+			}
+
+			if (!strcmp(lgopts[option_index].name, "report")) {
+				ret = parse_uint(optarg);
+				if (ret < 0) {
+					printf("invalid report period\n");
+					print_usage(prgname);
+					return -1;
+				}
+				report_period = ret;
+			}
+
 			if (!strncmp(lgopts[option_index].name,
 					"enable-jumbo", 12)) {
 				struct option lenopts =
@@ -1606,6 +1578,9 @@ main(int argc, char **argv)
 			n_tx_queue = dev_txq_num;
 		printf("Creating queues: nb_rxq=%d nb_txq=%u... ",
 			nb_rx_queue, (unsigned)n_tx_queue );
+		/* virtual devices have RX interrupts but no LSC interrupt */
+		port_conf.intr_conf.lsc = !!(rte_eth_devices[portid].data->
+			dev_flags & RTE_ETH_DEV_INTR_LSC);
 		ret = rte_eth_dev_configure(portid, nb_rx_queue,
 					(uint16_t)n_tx_queue, &port_conf);
 		if (ret < 0)
@@ -1693,6 +1668,13 @@ main(int argc, char **argv)
 			hz/TIMER_NUMBER_PER_SECOND, SINGLE, lcore_id,
 						power_timer_cb, NULL);
 
+		if (report_period != 0) {
+			rte_timer_init(&report_timers[lcore_id]);
+			rte_timer_reset(&report_timers[lcore_id],
+				hz * report_period, PERIODICAL, lcore_id,
+				report_timer_cb, NULL);
+		}
+
 		qconf = &lcore_conf[lcore_id];
 		printf("\nInitializing rx queues on lcore %u ... ", lcore_id );
 		fflush(stdout);
@@ -1740,8 +1722,6 @@ main(int argc, char **argv)
 		 */
 		if (promiscuous_on)
 			rte_eth_promiscuous_enable(portid);
-		/* initialize spinlock for each port */
-		rte_spinlock_init(&(locks[portid]));
 	}
 
 	check_all_ports_link_status((uint8_t)nb_ports, enabled_port_mask);
@@ -47,6 +47,7 @@ extern "C" {
 
 #include <rte_mbuf.h>
 #include <rte_memory.h>
+#include <rte_memcpy.h>
 #include <rte_mempool.h>
 
 #include "rte_crypto_sym.h"
@@ -154,6 +155,11 @@ struct rte_crypto_op_pool_private {
 	/**< Crypto op pool type operation. */
 	uint16_t priv_size;
 	/**< Size of private area in each crypto operation. */
+	uint16_t drv_priv_offset;
+	/**< Offset of the driver private area from the start of each crypto
+	 * operation, 0 if the pool reserves no driver private area. */
+	uint16_t drv_priv_size;
+	/**< Size of driver private area in each crypto operation. */
 };
 
 
@@ -313,6 +319,124 @@ __rte_crypto_op_get_priv_data(struct rte_crypto_op *op, uint32_t size)
 	return NULL;
 }
 
+/**
+ * Returns a pointer to the driver private area of a crypto operation if the
+ * operation was allocated from a pool created with
+ * *rte_cryptodev_op_pool_create* and that area has enough capacity for the
+ * requested size. For use by crypto PMDs only; the area is owned by the PMD
+ * between enqueue and dequeue of the operation.
+ *
+ * @param	op	crypto operation.
+ * @param	size	size of space requested in driver private area.
+ *
+ * @returns
+ * - if sufficient space available returns pointer to the driver private area,
+ *   aligned on a cache line
+ * - if insufficient space returns NULL
+ */
+static inline void *
+__rte_crypto_op_get_drv_priv_data(struct rte_crypto_op *op, uint32_t size)
+{
+	struct rte_crypto_op_pool_private *priv;
+
+	if (likely(op->mempool != NULL)) {
+		priv = (struct rte_crypto_op_pool_private *)
+				rte_mempool_get_priv(op->mempool);
+
+		if (likely(priv->drv_priv_size >= size &&
+				priv->drv_priv_offset != 0))
+			return (void *)((uint8_t *)op + priv->drv_priv_offset);
+	}
+
+	return NULL;
+}
+
+/**
+ * Template of the fields of a symmetric crypto operation which do not change
+ * from one operation to the next on the same session.
+ */
+struct rte_crypto_op_sym_template {
+	struct rte_crypto_sym_op sym;
+	/**< Symmetric operation parameters copied into each operation */
+	uint16_t iv_offset;
+	/**< When non zero, offset from the start of the crypto operation of
+	 * the IV. The cipher IV data and physical address of each operation
+	 * are then pointed at that location, usually in the operation
+	 * private data. */
+};
+
+/**
+ * Initialise a symmetric operation template for a session.
+ *
+ * The caller may then set any other invariant field of tmpl->sym, such as
+ * the cipher and auth data offsets or the digest length.
+ *
+ * @param	tmpl		template to initialise.
+ * @param	sess		cryptodev session all operations are attached to.
+ * @param	iv_offset	offset of the IV from the start of the crypto
+ *				operation, or 0 to leave the IV pointers to
+ *				the caller.
+ * @param	iv_length	length of the IV in bytes.
+ */
+static inline void
+rte_crypto_op_sym_template_init(struct rte_crypto_op_sym_template *tmpl,
+		struct rte_cryptodev_sym_session *sess,
+		uint16_t iv_offset, uint16_t iv_length)
+{
+	__rte_crypto_sym_op_reset(&tmpl->sym);
+	__rte_crypto_sym_op_attach_sym_session(&tmpl->sym, sess);
+
+	tmpl->sym.cipher.iv.length = iv_length;
+	tmpl->iv_offset = iv_offset;
+}
+
+/**
+ * Bulk allocate symmetric crypto operations from a mempool and fill them in
+ * from a template, in place of the default reset done by
+ * *rte_crypto_op_bulk_alloc*. Only the per-packet fields (mbufs, data
+ * lengths, digest location) are then left to the caller.
+ *
+ * @param	mempool	crypto operation mempool
+ * @param	tmpl	template built by *rte_crypto_op_sym_template_init*
+ * @param	ops	Array to place allocated crypto operations
+ * @param	nb_ops	Number of crypto operations to allocate
+ *
+ * @returns
+ * - On success returns nb_ops
+ * - On failure returns 0
+ */
+static inline unsigned
+rte_crypto_op_bulk_alloc_from_template(struct rte_mempool *mempool,
+		const struct rte_crypto_op_sym_template *tmpl,
+		struct rte_crypto_op **ops, uint16_t nb_ops)
+{
+	struct rte_crypto_op *op;
+	int i;
+
+	if (unlikely(__rte_crypto_op_raw_bulk_alloc(mempool,
+			RTE_CRYPTO_OP_TYPE_SYMMETRIC, ops, nb_ops) != nb_ops))
+		return 0;
+
+	for (i = 0; i < nb_ops; i++) {
+		op = ops[i];
+		op->type = RTE_CRYPTO_OP_TYPE_SYMMETRIC;
+		op->status = RTE_CRYPTO_OP_STATUS_NOT_PROCESSED;
+		op->opaque_data = NULL;
+		op->sym = (struct rte_crypto_sym_op *)(op + 1);
+
+		rte_memcpy(op->sym, &tmpl->sym, sizeof(*op->sym));
+
+		if (tmpl->iv_offset != 0) {
+			op->sym->cipher.iv.data =
+				(uint8_t *)op + tmpl->iv_offset;
+			op->sym->cipher.iv.phys_addr =
+				op->phys_addr + tmpl->iv_offset;
+		}
+	}
+
+	return nb_ops;
+}
+
 /**
  * free crypto operation structure
  * If operation has been allocate from a rte_mempool, then the operation will
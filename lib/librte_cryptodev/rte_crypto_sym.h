@@ -312,11 +312,109 @@ struct rte_crypto_auth_xform {
 	 */
 };
 
+/** IPsec security protocol, only ESP is supported */
+enum rte_crypto_ipsec_proto {
+	RTE_CRYPTO_IPSEC_PROTO_ESP,
+	/**< Encapsulating Security Payload, RFC4303 */
+};
+
+/** IPsec SA mode */
+enum rte_crypto_ipsec_mode {
+	RTE_CRYPTO_IPSEC_MODE_TRANSPORT,
+	/**< ESP header inserted after the IP header of the packet */
+	RTE_CRYPTO_IPSEC_MODE_TUNNEL,
+	/**< Whole packet carried behind a new outer IP header */
+};
+
+/** IPsec SA direction */
+enum rte_crypto_ipsec_direction {
+	RTE_CRYPTO_IPSEC_DIR_EGRESS,
+	/**< Encapsulate plain IP packets */
+	RTE_CRYPTO_IPSEC_DIR_INGRESS,
+	/**< Decapsulate ESP packets */
+};
+
+/** Outer header type of an IPsec tunnel */
+enum rte_crypto_ipsec_tunnel_type {
+	RTE_CRYPTO_IPSEC_TUNNEL_IPV4,
+	/**< Outer IPv4 header */
+	RTE_CRYPTO_IPSEC_TUNNEL_IPV6,
+	/**< Outer IPv6 header */
+};
+
+/** Maximum anti-replay window size, in packets */
+#define RTE_CRYPTO_IPSEC_MAX_REPLAY_WIN_SZ	64
+
+/**
+ * IPsec protocol transform data.
+ *
+ * This xform heads a chain made of the cipher and authentication xforms of
+ * the SA, in the order the device would apply them to an ESP payload
+ * (cipher then auth on egress, auth then cipher on ingress). A session
+ * created from such a chain makes the device process whole packets:
+ *
+ * - on egress the operation m_src holds a plain IP packet, it is returned
+ *   holding the ESP packet, with sequence number, IV, padding and ICV
+ *   generated and, in tunnel mode, the outer IP header added.
+ * - on ingress the operation m_src holds an ESP packet, it is returned
+ *   holding the inner IP packet once the SPI, sequence number against the
+ *   anti-replay window, ICV and padding have been checked.
+ *
+ * The cipher and auth data fields of the operation are not used, processing
+ * happens in place on m_src which needs head and tail room for the headers
+ * and trailer. A replayed packet completes with
+ * RTE_CRYPTO_OP_STATUS_ERROR, a bad ICV with
+ * RTE_CRYPTO_OP_STATUS_AUTH_FAILED.
+ *
+ * The sequence number and anti-replay window live in the session, so an
+ * SA must only be used by one queue pair at a time.
+ */
+struct rte_crypto_ipsec_xform {
+	enum rte_crypto_ipsec_proto proto;
+	/**< IPsec protocol */
+	enum rte_crypto_ipsec_mode mode;
+	/**< Transport or tunnel mode */
+	enum rte_crypto_ipsec_direction direction;
+	/**< Egress or ingress SA */
+	uint32_t spi;
+	/**< Security Parameters Index, in host byte order */
+	uint32_t seq;
+	/**< Last sequence number used (egress) or seen (ingress) */
+	uint32_t replay_win_sz;
+	/**< Ingress anti-replay window in packets, 0 to disable it, at most
+	 * RTE_CRYPTO_IPSEC_MAX_REPLAY_WIN_SZ
+	 */
+	struct {
+		enum rte_crypto_ipsec_tunnel_type type;
+		/**< Outer header type */
+		union {
+			struct {
+				uint32_t src_addr;
+				/**< Source address, network byte order */
+				uint32_t dst_addr;
+				/**< Destination address, network byte order */
+				uint8_t ttl;
+				/**< Time to live */
+			} ipv4;
+			struct {
+				uint8_t src_addr[16];
+				/**< Source address */
+				uint8_t dst_addr[16];
+				/**< Destination address */
+				uint8_t hlimit;
+				/**< Hop limit */
+			} ipv6;
+		};
+	} tunnel;
+	/**< Outer header of an egress tunnel SA */
+};
+
 /** Crypto transformation types */
 enum rte_crypto_sym_xform_type {
 	RTE_CRYPTO_SYM_XFORM_NOT_SPECIFIED = 0,	/**< No xform specified */
 	RTE_CRYPTO_SYM_XFORM_AUTH,		/**< Authentication xform */
-	RTE_CRYPTO_SYM_XFORM_CIPHER		/**< Cipher xform  */
+	RTE_CRYPTO_SYM_XFORM_CIPHER,		/**< Cipher xform  */
+	RTE_CRYPTO_SYM_XFORM_IPSEC		/**< IPsec protocol xform */
 };
 
 /**
@@ -338,6 +436,8 @@ struct rte_crypto_sym_xform {
 		/**< Authentication / hash xform */
 		struct rte_crypto_cipher_xform cipher;
 		/**< Cipher xform */
+		struct rte_crypto_ipsec_xform ipsec;
+		/**< IPsec protocol xform */
 	};
 };
 
@@ -40,6 +40,7 @@
 #include <errno.h>
 #include <stdint.h>
 #include <inttypes.h>
+#include <limits.h>
 #include <netinet/in.h>
 
 #include <rte_byteorder.h>
@@ -57,6 +58,7 @@
 #include <rte_per_lcore.h>
 #include <rte_lcore.h>
 #include <rte_atomic.h>
+#include <rte_cycles.h>
 #include <rte_branch_prediction.h>
 #include <rte_common.h>
 #include <rte_ring.h>
@@ -75,6 +77,11 @@ struct rte_cryptodev rte_crypto_devices[RTE_CRYPTO_MAX_DEVS];
 
 struct rte_cryptodev *rte_cryptodevs = &rte_crypto_devices[0];
 
+RTE_TRACE_POINT_DEFINE(rte_cryptodev_trace_enqueue_burst,
+	"lib.cryptodev.enqueue_burst", "dev_id", "qp_id", "nb_ops", "nb_enq")
+RTE_TRACE_POINT_DEFINE(rte_cryptodev_trace_dequeue_burst,
+	"lib.cryptodev.dequeue_burst", "dev_id", "qp_id", "nb_ops", "nb_deq")
+
 static struct rte_cryptodev_global cryptodev_globals = {
 		.devs			= &rte_crypto_devices[0],
 		.data			= { NULL },
@@ -212,6 +219,10 @@ rte_cryptodev_get_feature_name(uint64_t flag)
 		return "CPU_AESNI";
 	case RTE_CRYPTODEV_FF_HW_ACCELERATED:
 		return "HW_ACCELERATED";
+	case RTE_CRYPTODEV_FF_IPSEC_PROTO_OFFLOAD:
+		return "IPSEC_PROTO_OFFLOAD";
+	case RTE_CRYPTODEV_FF_MBUF_SCATTER_GATHER:
+		return "MBUF_SCATTER_GATHER";
 
 	default:
 		return NULL;
@@ -233,10 +244,10 @@ rte_cryptodev_get_dev_id(const char *name) {
 		return -1;
 
 	for (i = 0; i < rte_cryptodev_globals->max_devs; i++)
-		if ((strcmp(rte_cryptodev_globals->devs[i].data->name, name)
-				== 0) &&
-				(rte_cryptodev_globals->devs[i].attached ==
-						RTE_CRYPTODEV_ATTACHED))
+		if ((rte_cryptodev_globals->devs[i].attached ==
+						RTE_CRYPTODEV_ATTACHED) &&
+				(strcmp(rte_cryptodev_globals->devs[i].data->name,
+						name) == 0))
 			return i;
 
 	return -1;
@@ -711,6 +722,10 @@ rte_cryptodev_configure(uint8_t dev_id, struct rte_cryptodev_config *config)
 		return -EBUSY;
 	}
 
+	/* instrumentation counters are sized for the old queue pairs */
+	rte_free(dev->qp_instr);
+	dev->qp_instr = NULL;
+
 	/* Setup new number of queue pairs and reconfigure device. */
 	diag = rte_cryptodev_queue_pairs_config(dev, config->nb_queue_pairs,
 			config->socket_id);
@@ -821,6 +836,9 @@ rte_cryptodev_close(uint8_t dev_id)
 	if (retval < 0)
 		return retval;
 
+	rte_free(dev->qp_instr);
+	dev->qp_instr = NULL;
+
 	return 0;
 }
 
@@ -893,6 +911,383 @@ rte_cryptodev_stats_reset(uint8_t dev_id)
 	(*dev->dev_ops->stats_reset)(dev);
 }
 
+/* store statistics names and its offset in stats structure */
+struct rte_cryptodev_xstats_name_off {
+	const char *name;
+	unsigned offset;
+};
+
+static const struct rte_cryptodev_xstats_name_off rte_cryptodev_stats_strings[] = {
+	{"enqueued_count", offsetof(struct rte_cryptodev_stats,
+		enqueued_count)},
+	{"dequeued_count", offsetof(struct rte_cryptodev_stats,
+		dequeued_count)},
+	{"enqueue_err_count", offsetof(struct rte_cryptodev_stats,
+		enqueue_err_count)},
+	{"dequeue_err_count", offsetof(struct rte_cryptodev_stats,
+		dequeue_err_count)},
+};
+
+#define RTE_NB_CRYPTODEV_STATS (sizeof(rte_cryptodev_stats_strings) / \
+		sizeof(rte_cryptodev_stats_strings[0]))
+
+static const struct rte_cryptodev_xstats_name_off rte_cryptodev_instr_strings[] = {
+	{"enq_ops", offsetof(struct rte_cryptodev_qp_instr, enq_ops)},
+	{"deq_ops", offsetof(struct rte_cryptodev_qp_instr, deq_ops)},
+	{"max_in_flight", offsetof(struct rte_cryptodev_qp_instr,
+		max_in_flight)},
+	{"enq_busy", offsetof(struct rte_cryptodev_qp_instr, enq_busy)},
+};
+
+#define RTE_NB_CRYPTODEV_INSTR_STATS (sizeof(rte_cryptodev_instr_strings) / \
+		sizeof(rte_cryptodev_instr_strings[0]))
+
+static const char * const rte_cryptodev_burst_strings[] = {
+	"0", "1", "2_3", "4_7", "8_15", "16_31", "32_63", "64_127", "128_up",
+};
+
+/* counters, in_flight, lat_min, lat_max and lat_avg, then the histograms */
+#define RTE_NB_CRYPTODEV_QP_INSTR_STATS (RTE_NB_CRYPTODEV_INSTR_STATS + 4 + \
+		RTE_CRYPTODEV_INSTR_LAT_BUCKETS + \
+		2 * RTE_CRYPTODEV_INSTR_BURST_BUCKETS)
+
+static void
+cryptodev_instr_reset(struct rte_cryptodev *dev)
+{
+	unsigned q;
+
+	if (dev->qp_instr == NULL)
+		return;
+
+	memset(dev->qp_instr, 0,
+		dev->data->nb_queue_pairs * sizeof(*dev->qp_instr));
+	for (q = 0; q < dev->data->nb_queue_pairs; q++)
+		dev->qp_instr[q].lat_min = UINT64_MAX;
+}
+
+static int
+cryptodev_xstats_count(struct rte_cryptodev *dev)
+{
+	int count;
+
+	count = RTE_NB_CRYPTODEV_STATS;
+	if (dev->qp_instr != NULL)
+		count += dev->data->nb_queue_pairs *
+				RTE_NB_CRYPTODEV_QP_INSTR_STATS;
+
+	if (dev->dev_ops->xstats_get_names != NULL) {
+		int drv_count = (*dev->dev_ops->xstats_get_names)(dev,
+				NULL, 0);
+
+		if (drv_count < 0)
+			return drv_count;
+		count += drv_count;
+	}
+
+	return count;
+}
+
+int
+rte_cryptodev_xstats_get_names(uint8_t dev_id,
+		struct rte_cryptodev_xstat_name *xstats_names, unsigned size)
+{
+	struct rte_cryptodev *dev;
+	int cnt_expected_entries, cnt_driver_entries;
+	unsigned cnt_used_entries = 0, idx, q;
+
+	if (!rte_cryptodev_pmd_is_valid_dev(dev_id)) {
+		CDEV_LOG_ERR("Invalid dev_id=%d", dev_id);
+		return -ENODEV;
+	}
+
+	dev = &rte_crypto_devices[dev_id];
+
+	cnt_expected_entries = cryptodev_xstats_count(dev);
+	if (xstats_names == NULL || cnt_expected_entries < 0 ||
+			(int)size < cnt_expected_entries)
+		return cnt_expected_entries;
+
+	for (idx = 0; idx < RTE_NB_CRYPTODEV_STATS; idx++)
+		snprintf(xstats_names[cnt_used_entries++].name,
+			sizeof(xstats_names[0].name),
+			"%s", rte_cryptodev_stats_strings[idx].name);
+
+	for (q = 0; dev->qp_instr != NULL && q < dev->data->nb_queue_pairs;
+			q++) {
+		for (idx = 0; idx < RTE_NB_CRYPTODEV_INSTR_STATS; idx++)
+			snprintf(xstats_names[cnt_used_entries++].name,
+				sizeof(xstats_names[0].name), "qp%u_%s", q,
+				rte_cryptodev_instr_strings[idx].name);
+		snprintf(xstats_names[cnt_used_entries++].name,
+			sizeof(xstats_names[0].name), "qp%u_in_flight", q);
+		snprintf(xstats_names[cnt_used_entries++].name,
+			sizeof(xstats_names[0].name), "qp%u_lat_min_cycles", q);
+		snprintf(xstats_names[cnt_used_entries++].name,
+			sizeof(xstats_names[0].name), "qp%u_lat_max_cycles", q);
+		snprintf(xstats_names[cnt_used_entries++].name,
+			sizeof(xstats_names[0].name), "qp%u_lat_avg_cycles", q);
+		for (idx = 0; idx < RTE_CRYPTODEV_INSTR_LAT_BUCKETS; idx++)
+			snprintf(xstats_names[cnt_used_entries++].name,
+				sizeof(xstats_names[0].name),
+				"qp%u_lat_hist_2^%u", q, idx);
+		for (idx = 0; idx < RTE_CRYPTODEV_INSTR_BURST_BUCKETS; idx++)
+			snprintf(xstats_names[cnt_used_entries++].name,
+				sizeof(xstats_names[0].name),
+				"qp%u_enq_burst_hist_%s", q,
+				rte_cryptodev_burst_strings[idx]);
+		for (idx = 0; idx < RTE_CRYPTODEV_INSTR_BURST_BUCKETS; idx++)
+			snprintf(xstats_names[cnt_used_entries++].name,
+				sizeof(xstats_names[0].name),
+				"qp%u_deq_burst_hist_%s", q,
+				rte_cryptodev_burst_strings[idx]);
+	}
+
+	if (dev->dev_ops->xstats_get_names != NULL) {
+		/* driver-specific xstats are appended to the end of list */
+		cnt_driver_entries = (*dev->dev_ops->xstats_get_names)(dev,
+				xstats_names + cnt_used_entries,
+				size - cnt_used_entries);
+		if (cnt_driver_entries < 0)
+			return cnt_driver_entries;
+		cnt_used_entries += cnt_driver_entries;
+	}
+
+	return cnt_used_entries;
+}
+
+int
+rte_cryptodev_xstats_get(uint8_t dev_id, struct rte_cryptodev_xstat *xstats,
+		unsigned n)
+{
+	struct rte_cryptodev_stats stats;
+	struct rte_cryptodev_qp_instr *instr;
+	struct rte_cryptodev *dev;
+	unsigned count, i, q;
+	int xcount = 0;
+
+	if (!rte_cryptodev_pmd_is_valid_dev(dev_id)) {
+		CDEV_LOG_ERR("Invalid dev_id=%d", dev_id);
+		return -ENODEV;
+	}
+
+	dev = &rte_crypto_devices[dev_id];
+
+	count = RTE_NB_CRYPTODEV_STATS;
+	if (dev->qp_instr != NULL)
+		count += dev->data->nb_queue_pairs *
+				RTE_NB_CRYPTODEV_QP_INSTR_STATS;
+
+	/* implemented by the driver */
+	if (dev->dev_ops->xstats_get != NULL) {
+		/* Retrieve the xstats from the driver at the end of the
+		 * xstats struct.
+		 */
+		xcount = (*dev->dev_ops->xstats_get)(dev,
+				xstats ? xstats + count : NULL,
+				(n > count) ? n - count : 0);
+		if (xcount < 0)
+			return xcount;
+	}
+
+	if (n < count + xcount || xstats == NULL)
+		return count + xcount;
+
+	/* now fill the generic part of the xstats structure */
+	memset(&stats, 0, sizeof(stats));
+	if (dev->dev_ops->stats_get != NULL)
+		(*dev->dev_ops->stats_get)(dev, &stats);
+
+	count = 0;
+	for (i = 0; i < RTE_NB_CRYPTODEV_STATS; i++)
+		xstats[count++].value = *(uint64_t *)RTE_PTR_ADD(&stats,
+				rte_cryptodev_stats_strings[i].offset);
+
+	for (q = 0; dev->qp_instr != NULL && q < dev->data->nb_queue_pairs;
+			q++) {
+		instr = &dev->qp_instr[q];
+
+		for (i = 0; i < RTE_NB_CRYPTODEV_INSTR_STATS; i++)
+			xstats[count++].value = *(uint64_t *)RTE_PTR_ADD(instr,
+					rte_cryptodev_instr_strings[i].offset);
+		xstats[count++].value = instr->enq_ops - instr->deq_ops;
+		xstats[count++].value = instr->lat_ops ? instr->lat_min : 0;
+		xstats[count++].value = instr->lat_max;
+		xstats[count++].value = instr->lat_ops ?
+				instr->lat_sum / instr->lat_ops : 0;
+		for (i = 0; i < RTE_CRYPTODEV_INSTR_LAT_BUCKETS; i++)
+			xstats[count++].value = instr->lat_hist[i];
+		for (i = 0; i < RTE_CRYPTODEV_INSTR_BURST_BUCKETS; i++)
+			xstats[count++].value = instr->enq_burst_hist[i];
+		for (i = 0; i < RTE_CRYPTODEV_INSTR_BURST_BUCKETS; i++)
+			xstats[count++].value = instr->deq_burst_hist[i];
+	}
+
+	for (i = 0; i < count + xcount; i++)
+		xstats[i].id = i;
+
+	return count + xcount;
+}
+
+void
+rte_cryptodev_xstats_reset(uint8_t dev_id)
+{
+	struct rte_cryptodev *dev;
+
+	if (!rte_cryptodev_pmd_is_valid_dev(dev_id)) {
+		CDEV_LOG_ERR("Invalid dev_id=%" PRIu8, dev_id);
+		return;
+	}
+
+	dev = &rte_crypto_devices[dev_id];
+
+	cryptodev_instr_reset(dev);
+
+	/* implemented by the driver */
+	if (dev->dev_ops->xstats_reset != NULL) {
+		(*dev->dev_ops->xstats_reset)(dev);
+		return;
+	}
+
+	/* fallback to default */
+	rte_cryptodev_stats_reset(dev_id);
+}
+
+int
+rte_cryptodev_instrument_enable(uint8_t dev_id, int enable)
+{
+#ifdef RTE_CRYPTODEV_INSTRUMENT
+	struct rte_cryptodev *dev;
+
+	if (!rte_cryptodev_pmd_is_valid_dev(dev_id)) {
+		CDEV_LOG_ERR("Invalid dev_id=%" PRIu8, dev_id);
+		return -ENODEV;
+	}
+
+	dev = &rte_crypto_devices[dev_id];
+
+	if (!enable) {
+		rte_free(dev->qp_instr);
+		dev->qp_instr = NULL;
+		return 0;
+	}
+
+	if (dev->qp_instr != NULL)
+		return 0;
+
+	if (dev->data->nb_queue_pairs == 0) {
+		CDEV_LOG_ERR("dev_id=%u is not configured", dev_id);
+		return -EINVAL;
+	}
+
+	dev->qp_instr = rte_zmalloc_socket("cryptodev_qp_instr",
+			dev->data->nb_queue_pairs * sizeof(*dev->qp_instr),
+			RTE_CACHE_LINE_SIZE, dev->data->socket_id);
+	if (dev->qp_instr == NULL) {
+		CDEV_LOG_ERR("failed to allocate instrumentation counters");
+		return -ENOMEM;
+	}
+	cryptodev_instr_reset(dev);
+
+	return 0;
+#else
+	RTE_SET_USED(dev_id);
+	RTE_SET_USED(enable);
+	return -ENOTSUP;
+#endif
+}
+
+/* bucket 0 for empty bursts, then one per power of two up to 128+ */
+static inline unsigned
+cryptodev_instr_burst_bucket(uint16_t nb)
+{
+	unsigned b;
+
+	if (nb == 0)
+		return 0;
+
+	b = sizeof(unsigned) * CHAR_BIT - __builtin_clz(nb);
+	return RTE_MIN(b, (unsigned)RTE_CRYPTODEV_INSTR_BURST_BUCKETS - 1);
+}
+
+void
+__rte_cryptodev_instr_enqueue_pre(struct rte_cryptodev_qp_instr *instr)
+{
+	instr->enq_start = rte_rdtsc();
+}
+
+void
+__rte_cryptodev_instr_enqueue(struct rte_cryptodev_qp_instr *instr,
+		uint16_t nb_ops, uint16_t nb_enq)
+{
+	const uint32_t mask = RTE_CRYPTODEV_INSTR_TSC_RING - 1;
+	uint64_t in_flight;
+	uint32_t last;
+
+	instr->enq_ops += nb_enq;
+	if (nb_enq != 0) {
+		if (instr->bursts_head - instr->bursts_tail <= mask) {
+			last = instr->bursts_head++ & mask;
+			instr->bursts[last].tsc = instr->enq_start;
+		} else {
+			/* ring full: merge into the newest burst, unmeasured */
+			last = (instr->bursts_head - 1) & mask;
+			instr->bursts[last].tsc = 0;
+		}
+		instr->bursts[last].enq_end = instr->enq_ops;
+	}
+	if (nb_enq < nb_ops)
+		instr->enq_busy++;
+	instr->enq_burst_hist[cryptodev_instr_burst_bucket(nb_enq)]++;
+
+	in_flight = instr->enq_ops - instr->deq_ops;
+	if (in_flight > instr->max_in_flight)
+		instr->max_in_flight = in_flight;
+}
+
+void
+__rte_cryptodev_instr_dequeue(struct rte_cryptodev_qp_instr *instr,
+		uint16_t nb_deq)
+{
+	const uint32_t mask = RTE_CRYPTODEV_INSTR_TSC_RING - 1;
+	struct rte_cryptodev_instr_burst *burst;
+	uint64_t tsc, lat, end, n;
+	unsigned b;
+
+	instr->deq_burst_hist[cryptodev_instr_burst_bucket(nb_deq)]++;
+	if (nb_deq == 0)
+		return;
+
+	tsc = rte_rdtsc();
+	end = instr->deq_ops + nb_deq;
+	/* the operations dequeued belong to the oldest bursts in flight */
+	while (instr->deq_ops != end &&
+			instr->bursts_tail != instr->bursts_head) {
+		burst = &instr->bursts[instr->bursts_tail & mask];
+		/* ops in flight when enabled were not counted at enqueue */
+		if (burst->enq_end <= instr->deq_ops) {
+			instr->bursts_tail++;
+			continue;
+		}
+		n = RTE_MIN(end, burst->enq_end) - instr->deq_ops;
+		instr->deq_ops += n;
+		if (instr->deq_ops == burst->enq_end)
+			instr->bursts_tail++;
+		if (burst->tsc == 0)
+			continue;
+
+		lat = tsc - burst->tsc;
+		b = lat ? 63 - __builtin_clzll(lat) : 0;
+		instr->lat_hist[RTE_MIN(b,
+			(unsigned)RTE_CRYPTODEV_INSTR_LAT_BUCKETS - 1)] += n;
+		instr->lat_sum += lat * n;
+		instr->lat_ops += n;
+		if (lat < instr->lat_min)
+			instr->lat_min = lat;
+		if (lat > instr->lat_max)
+			instr->lat_max = lat;
+	}
+	instr->deq_ops = end;
+}
 
 void
 rte_cryptodev_info_get(uint8_t dev_id, struct rte_cryptodev_info *dev_info)
@@ -1174,6 +1569,222 @@ rte_cryptodev_sym_session_free(uint8_t dev_id,
 	return NULL;
 }
 
+/* Ways of a session cache set at most, the least recently used one goes */
+#define CDEV_SESS_CACHE_WAYS		4
+/* Room for the serialised transform chain of a cache entry */
+#define CDEV_SESS_CACHE_KEY_MAX		256
+
+/** Fixed part of a serialised transform, followed by its key */
+struct cdev_sess_cache_xform_key {
+	uint8_t type;
+	uint8_t algo;
+	uint8_t op;
+	uint8_t reserved;
+	uint16_t key_len;
+	uint16_t digest_len;
+	uint32_t aad_len;
+};
+
+struct cdev_sess_cache_entry {
+	struct rte_cryptodev_sym_session *sess;
+	uint64_t last_use;		/**< Cache clock at last lookup */
+	uint32_t hash;
+	uint16_t key_len;
+	uint16_t refcnt;		/**< Operations using the session */
+	uint8_t key[CDEV_SESS_CACHE_KEY_MAX];
+};
+
+struct rte_cryptodev_sym_session_cache {
+	uint8_t dev_id;
+	uint32_t nb_sets;
+	uint32_t nb_ways;
+	uint64_t clock;
+	struct cdev_sess_cache_entry entries[];
+};
+
+/*
+ * Serialise the content of a transform chain, key material included, as
+ * two chains giving the same bytes configure the same session. Returns the
+ * length used, or -1 when the chain cannot be cached.
+ */
+static int
+cdev_sess_cache_key(const struct rte_crypto_sym_xform *xform, uint8_t *key)
+{
+	struct cdev_sess_cache_xform_key hdr;
+	const uint8_t *key_data;
+	int len = 0;
+
+	for (; xform != NULL; xform = xform->next) {
+		memset(&hdr, 0, sizeof(hdr));
+		hdr.type = xform->type;
+
+		switch (xform->type) {
+		case RTE_CRYPTO_SYM_XFORM_CIPHER:
+			hdr.algo = xform->cipher.algo;
+			hdr.op = xform->cipher.op;
+			hdr.key_len = xform->cipher.key.length;
+			key_data = xform->cipher.key.data;
+			break;
+		case RTE_CRYPTO_SYM_XFORM_AUTH:
+			hdr.algo = xform->auth.algo;
+			hdr.op = xform->auth.op;
+			hdr.key_len = xform->auth.key.length;
+			hdr.digest_len = xform->auth.digest_length;
+			hdr.aad_len = xform->auth.add_auth_data_length;
+			key_data = xform->auth.key.data;
+			break;
+		default:
+			return -1;
+		}
+
+		if (len + sizeof(hdr) + hdr.key_len > CDEV_SESS_CACHE_KEY_MAX)
+			return -1;
+		memcpy(&key[len], &hdr, sizeof(hdr));
+		len += sizeof(hdr);
+		if (hdr.key_len != 0) {
+			memcpy(&key[len], key_data, hdr.key_len);
+			len += hdr.key_len;
+		}
+	}
+
+	return len;
+}
+
+/* FNV-1a, the keys being short */
+static inline uint32_t
+cdev_sess_cache_hash(const uint8_t *key, int len)
+{
+	uint32_t hash = 2166136261u;
+	int i;
+
+	for (i = 0; i < len; i++)
+		hash = (hash ^ key[i]) * 16777619u;
+
+	return hash;
+}
+
+struct rte_cryptodev_sym_session_cache *
+rte_cryptodev_sym_session_cache_create(uint8_t dev_id,
+		unsigned int nb_sessions, int socket_id)
+{
+	struct rte_cryptodev_sym_session_cache *cache;
+	unsigned int nb_sets, nb_ways;
+
+	if (!rte_cryptodev_pmd_is_valid_dev(dev_id)) {
+		CDEV_LOG_ERR("Invalid dev_id=%d", dev_id);
+		return NULL;
+	}
+
+	if (nb_sessions == 0) {
+		CDEV_LOG_ERR("Invalid nb_sessions=%u", nb_sessions);
+		return NULL;
+	}
+
+	/* Never more sessions than asked, they are accounted for by the PMD */
+	nb_ways = RTE_MIN(nb_sessions, (unsigned int)CDEV_SESS_CACHE_WAYS);
+	nb_sets = nb_sessions / nb_ways;
+
+	cache = rte_zmalloc_socket("cryptodev_sess_cache", sizeof(*cache) +
+			nb_sets * nb_ways *
+			sizeof(struct cdev_sess_cache_entry),
+			RTE_CACHE_LINE_SIZE, socket_id);
+	if (cache == NULL) {
+		CDEV_LOG_ERR("Couldn't allocate session cache");
+		return NULL;
+	}
+
+	cache->dev_id = dev_id;
+	cache->nb_sets = nb_sets;
+	cache->nb_ways = nb_ways;
+
+	return cache;
+}
+
+void
+rte_cryptodev_sym_session_cache_free(
+		struct rte_cryptodev_sym_session_cache *cache)
+{
+	unsigned int i;
+
+	if (cache == NULL)
+		return;
+
+	for (i = 0; i < cache->nb_sets * cache->nb_ways; i++) {
+		if (cache->entries[i].sess != NULL)
+			rte_cryptodev_sym_session_free(cache->dev_id,
+					cache->entries[i].sess);
+	}
+
+	/* Don't leave key material behind */
+	memset(cache->entries, 0, cache->nb_sets * cache->nb_ways *
+			sizeof(cache->entries[0]));
+	rte_free(cache);
+}
+
+struct rte_cryptodev_sym_session *
+rte_cryptodev_sym_session_cache_get(
+		struct rte_cryptodev_sym_session_cache *cache,
+		struct rte_crypto_sym_xform *xform, uint32_t *slot)
+{
+	uint8_t key[CDEV_SESS_CACHE_KEY_MAX];
+	struct cdev_sess_cache_entry *e, *victim = NULL;
+	uint32_t hash, base, i;
+	int len;
+
+	len = cdev_sess_cache_key(xform, key);
+	if (len < 0)
+		return NULL;
+
+	hash = cdev_sess_cache_hash(key, len);
+	base = (hash % cache->nb_sets) * cache->nb_ways;
+
+	for (i = base; i < base + cache->nb_ways; i++) {
+		e = &cache->entries[i];
+
+		if (e->sess != NULL && e->hash == hash && e->key_len == len &&
+				memcmp(e->key, key, len) == 0)
+			goto hit;
+
+		/* Free entries have never been used, so go first */
+		if (e->refcnt == 0 &&
+				(victim == NULL || e->last_use < victim->last_use))
+			victim = e;
+	}
+
+	/* All sessions of the set are used by operations in flight */
+	if (victim == NULL)
+		return NULL;
+
+	e = victim;
+	if (e->sess != NULL) {
+		rte_cryptodev_sym_session_free(cache->dev_id, e->sess);
+		e->sess = NULL;
+		e->last_use = 0;
+	}
+
+	e->sess = rte_cryptodev_sym_session_create(cache->dev_id, xform);
+	if (e->sess == NULL)
+		return NULL;
+
+	e->hash = hash;
+	e->key_len = len;
+	memcpy(e->key, key, len);
+
+hit:
+	e->refcnt++;
+	e->last_use = ++cache->clock;
+	*slot = e - cache->entries;
+
+	return e->sess;
+}
+
+void
+rte_cryptodev_sym_session_cache_put(
+		struct rte_cryptodev_sym_session_cache *cache, uint32_t slot)
+{
+	cache->entries[slot].refcnt--;
+}
+
 /** Initialise rte_crypto_op mempool element */
 static void
 rte_crypto_op_init(struct rte_mempool *mempool,
@@ -1193,17 +1804,28 @@ rte_crypto_op_init(struct rte_mempool *mempool,
 }
 
 
-struct rte_mempool *
-rte_crypto_op_pool_create(const char *name, enum rte_crypto_op_type type,
+static struct rte_mempool *
+crypto_op_pool_create(const char *name, enum rte_crypto_op_type type,
 		unsigned nb_elts, unsigned cache_size, uint16_t priv_size,
-		int socket_id)
+		uint16_t drv_priv_size, int socket_id)
 {
 	struct rte_crypto_op_pool_private *priv;
+	unsigned drv_priv_offset = 0;
 
 	unsigned elt_size = sizeof(struct rte_crypto_op) +
 			sizeof(struct rte_crypto_sym_op) +
 			priv_size;
 
+	/* driver private area follows the user one on its own cache line */
+	if (drv_priv_size != 0) {
+		drv_priv_offset = RTE_ALIGN_CEIL(elt_size, RTE_CACHE_LINE_SIZE);
+		if (drv_priv_offset + drv_priv_size > UINT16_MAX) {
+			CDEV_LOG_ERR("Mempool %s element size too large", name);
+			return NULL;
+		}
+		elt_size = drv_priv_offset + drv_priv_size;
+	}
+
 	/* lookup mempool in case already allocated */
 	struct rte_mempool *mp = rte_mempool_lookup(name);
 
@@ -1214,7 +1836,8 @@ rte_crypto_op_pool_create(const char *name, enum rte_crypto_op_type type,
 		if (mp->elt_size != elt_size ||
 				mp->cache_size < cache_size ||
 				mp->size < nb_elts ||
-				priv->priv_size <  priv_size) {
+				priv->priv_size <  priv_size ||
+				priv->drv_priv_size < drv_priv_size) {
 			mp = NULL;
 			CDEV_LOG_ERR("Mempool %s already exists but with "
 					"incompatible parameters", name);
@@ -1245,7 +1868,46 @@ rte_crypto_op_pool_create(const char *name, enum rte_crypto_op_type type,
 			rte_mempool_get_priv(mp);
 
 	priv->priv_size = priv_size;
+	priv->drv_priv_offset = drv_priv_offset;
+	priv->drv_priv_size = drv_priv_size;
 	priv->type = type;
 
 	return mp;
 }
+
+struct rte_mempool *
+rte_crypto_op_pool_create(const char *name, enum rte_crypto_op_type type,
+		unsigned nb_elts, unsigned cache_size, uint16_t priv_size,
+		int socket_id)
+{
+	return crypto_op_pool_create(name, type, nb_elts, cache_size,
+			priv_size, 0, socket_id);
+}
+
+struct rte_mempool *
+rte_cryptodev_op_pool_create(const char *name, enum rte_crypto_op_type type,
+		unsigned nb_elts, unsigned cache_size, uint16_t priv_size,
+		uint8_t dev_id, int socket_id)
+{
+	struct rte_cryptodev *dev;
+	unsigned drv_priv_size = 0;
+
+	if (!rte_cryptodev_pmd_is_valid_dev(dev_id)) {
+		CDEV_LOG_ERR("Invalid dev_id=%d", dev_id);
+		return NULL;
+	}
+
+	dev = &rte_crypto_devices[dev_id];
+
+	if (dev->dev_ops->op_priv_get_size != NULL)
+		drv_priv_size = (*dev->dev_ops->op_priv_get_size)(dev);
+
+	if (drv_priv_size > UINT16_MAX) {
+		CDEV_LOG_ERR("%s returned an invalid op private size",
+				dev->data->name);
+		return NULL;
+	}
+
+	return crypto_op_pool_create(name, type, nb_elts, cache_size,
+			priv_size, drv_priv_size, socket_id);
+}
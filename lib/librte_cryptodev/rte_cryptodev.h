@@ -48,6 +48,7 @@ extern "C" {
 #include "rte_kvargs.h"
 #include "rte_crypto.h"
 #include "rte_dev.h"
+#include <rte_trace.h>
 
 #define CRYPTODEV_NAME_NULL_PMD		cryptodev_null_pmd
 /**< Null crypto PMD device name */
@@ -69,6 +70,8 @@ extern "C" {
 /**< NXP DPAA - SEC PMD device name */
 #define CRYPTODEV_NAME_ARMCE_PMD	cryptodev_armce_pmd
 /**< NXP ARM NEON Crypto Extension PMD device name */
+#define CRYPTODEV_NAME_SCHEDULER_PMD	crypto_scheduler
+/**< Scheduler Crypto PMD device name */
 
 /** Crypto device type */
 enum rte_cryptodev_type {
@@ -82,6 +85,7 @@ enum rte_cryptodev_type {
 	RTE_CRYPTODEV_DPAA_SEC_PMD,     /**< NXP DPAA - SEC PMD */
 	RTE_CRYPTODEV_ARMCE_PMD,        /**< NXP ARM NEON Crypto Extension PMD */
 	RTE_CRYPTODEV_OPENSSL_PMD,    /**<  OpenSSL PMD */
+	RTE_CRYPTODEV_SCHEDULER_PMD,	/**< Scheduler PMD */
 };
 
 extern const char **rte_cyptodev_names;
@@ -224,6 +228,10 @@ struct rte_cryptodev_capabilities {
 /**< Utilises CPU AES-NI instructions */
 #define	RTE_CRYPTODEV_FF_HW_ACCELERATED		(1ULL << 7)
 /**< Operations are off-loaded to an external hardware accelerator */
+#define	RTE_CRYPTODEV_FF_IPSEC_PROTO_OFFLOAD	(1ULL << 8)
+/**< Sessions headed by an IPsec xform are supported */
+#define	RTE_CRYPTODEV_FF_MBUF_SCATTER_GATHER	(1ULL << 9)
+/**< Chained mbufs are supported as source and destination of sym ops */
 
 
 /**
@@ -299,6 +307,80 @@ struct rte_cryptodev_stats {
 	/**< Total error count on operations dequeued */
 };
 
+#define RTE_CRYPTODEV_XSTATS_NAME_SIZE	64
+/**< Max length of an extended statistic name */
+
+/**
+ * A name-key lookup element for extended statistics.
+ *
+ * This structure is used by rte_cryptodev_xstats_get_names() to provide
+ * statistics name lookup to applications.
+ */
+struct rte_cryptodev_xstat_name {
+	char name[RTE_CRYPTODEV_XSTATS_NAME_SIZE];
+	/**< The statistic name */
+};
+
+/**
+ * A single extended statistic of a crypto device, as returned by
+ * rte_cryptodev_xstats_get(). The *id* is the index of the statistic name
+ * in the array filled by rte_cryptodev_xstats_get_names().
+ */
+struct rte_cryptodev_xstat {
+	uint64_t id;		/**< The index in xstats name array */
+	uint64_t value;		/**< The statistic counter value */
+};
+
+#define RTE_CRYPTODEV_INSTR_LAT_BUCKETS		32
+/**< Latency histogram buckets, bucket i counts [2^i, 2^(i+1)) TSC cycles */
+#define RTE_CRYPTODEV_INSTR_BURST_BUCKETS	9
+/**< Burst size histogram buckets: 0, 1, 2-3, 4-7, ..., 64-127, 128+ */
+#define RTE_CRYPTODEV_INSTR_TSC_RING		128
+/**< Enqueue bursts in flight whose TSC is kept, a power of two */
+
+/**
+ * @internal
+ * Enqueue burst in flight on an instrumented queue pair.
+ */
+struct rte_cryptodev_instr_burst {
+	uint64_t enq_end;	/**< enq_ops once the burst was enqueued */
+	uint64_t tsc;		/**< TSC at enqueue, 0 if not measured */
+};
+
+/**
+ * @internal
+ * Per queue pair counters of the cryptodev instrumentation layer, updated by
+ * rte_cryptodev_enqueue_burst() and rte_cryptodev_dequeue_burst() once
+ * enabled with rte_cryptodev_instrument_enable(). Read through the extended
+ * statistics.
+ *
+ * The latency is measured per enqueue burst, the operations of a queue pair
+ * being returned in the order they were enqueued. Beyond
+ * RTE_CRYPTODEV_INSTR_TSC_RING bursts in flight, the latency of the newest
+ * ones is not measured.
+ */
+struct rte_cryptodev_qp_instr {
+	uint64_t enq_ops;	/**< Operations accepted by the queue pair */
+	uint64_t deq_ops;	/**< Operations returned by the queue pair */
+	uint64_t max_in_flight;	/**< Highest enq_ops - deq_ops seen */
+	uint64_t enq_busy;	/**< Enqueues not taking the whole burst */
+	uint64_t lat_min;	/**< Lowest enqueue to dequeue latency */
+	uint64_t lat_max;	/**< Highest enqueue to dequeue latency */
+	uint64_t lat_sum;	/**< Sum of the latencies measured */
+	uint64_t lat_ops;	/**< Operations whose latency was measured */
+	uint64_t lat_hist[RTE_CRYPTODEV_INSTR_LAT_BUCKETS];
+	/**< Enqueue to dequeue latency histogram, in TSC cycles */
+	uint64_t enq_burst_hist[RTE_CRYPTODEV_INSTR_BURST_BUCKETS];
+	/**< Histogram of the number of operations enqueued per call */
+	uint64_t deq_burst_hist[RTE_CRYPTODEV_INSTR_BURST_BUCKETS];
+	/**< Histogram of the number of operations dequeued per call */
+	uint64_t enq_start;	/**< TSC at the start of the current enqueue */
+	struct rte_cryptodev_instr_burst bursts[RTE_CRYPTODEV_INSTR_TSC_RING];
+	/**< Enqueue bursts in flight, from bursts_tail to bursts_head */
+	uint32_t bursts_head;
+	uint32_t bursts_tail;
+} __rte_cache_aligned;
+
 #define RTE_CRYPTODEV_VDEV_DEFAULT_MAX_NB_QUEUE_PAIRS	8
 #define RTE_CRYPTODEV_VDEV_DEFAULT_MAX_NB_SESSIONS	2048
 
@@ -540,6 +622,78 @@ rte_cryptodev_stats_get(uint8_t dev_id, struct rte_cryptodev_stats *stats);
 extern void
 rte_cryptodev_stats_reset(uint8_t dev_id);
 
+/**
+ * Retrieve names of the extended statistics of a device: the general
+ * statistics, the per queue pair instrumentation counters when it is
+ * enabled, then the PMD specific statistics.
+ *
+ * @param	dev_id		The identifier of the device.
+ * @param	xstats_names	Array to be filled with the names, or NULL to
+ *				only query the number of statistics.
+ * @param	size		Capacity of xstats_names (number of names).
+ * @return
+ *   - positive value lower or equal to size: success. The return value
+ *     is the number of entries filled in the names array.
+ *   - positive value higher than size: error, the given array is too small.
+ *     The return value corresponds to the size that should be given to
+ *     succeed. The entries in the array are not valid and shall not be used
+ *     by the caller.
+ *   - negative value on error.
+ */
+extern int
+rte_cryptodev_xstats_get_names(uint8_t dev_id,
+		struct rte_cryptodev_xstat_name *xstats_names, unsigned size);
+
+/**
+ * Retrieve the extended statistics of a device.
+ *
+ * @param	dev_id		The identifier of the device.
+ * @param	xstats		Array of *rte_cryptodev_xstat* to be filled, in
+ *				the order of rte_cryptodev_xstats_get_names().
+ * @param	n		Capacity of the xstats array.
+ * @return
+ *   - positive value lower or equal to n: success. The return value
+ *     is the number of entries filled in the stats array.
+ *   - positive value higher than n: error, the given array is too small.
+ *     The return value corresponds to the size that should be given to
+ *     succeed. The entries in the array are not valid and shall not be used
+ *     by the caller.
+ *   - negative value on error.
+ */
+extern int
+rte_cryptodev_xstats_get(uint8_t dev_id, struct rte_cryptodev_xstat *xstats,
+		unsigned n);
+
+/**
+ * Reset the extended statistics of a device, including the
+ * instrumentation counters.
+ *
+ * @param	dev_id		The identifier of the device.
+ */
+extern void
+rte_cryptodev_xstats_reset(uint8_t dev_id);
+
+/**
+ * Enable or disable the instrumentation of the enqueue and dequeue burst
+ * functions of a configured device. When enabled, each enqueued operation is
+ * stamped with the TSC and the in-flight depth, enqueue to dequeue latency
+ * and burst size histograms of every queue pair are kept and reported
+ * through the extended statistics. Reconfiguring the device disables it.
+ *
+ * This function must not be called while another lcore is enqueuing to or
+ * dequeuing from the device. Only available when the library is built with
+ * CONFIG_RTE_CRYPTODEV_INSTRUMENT.
+ *
+ * @param	dev_id		The identifier of the device.
+ * @param	enable		Non-zero to enable, zero to disable.
+ * @return
+ *   - 0 on success.
+ *   - -ENOTSUP if the instrumentation is not built in.
+ *   - negative errno value on other errors.
+ */
+extern int
+rte_cryptodev_instrument_enable(uint8_t dev_id, int enable);
+
 /**
  * Retrieve the contextual information of a device.
  *
@@ -633,6 +787,9 @@ struct rte_cryptodev {
 
 	uint8_t attached : 1;
 	/**< Flag indicating the device is attached */
+
+	struct rte_cryptodev_qp_instr *qp_instr;
+	/**< Per queue pair instrumentation counters, NULL when disabled */
 } __rte_cache_aligned;
 
 
@@ -669,6 +826,23 @@ struct rte_cryptodev_data {
 } __rte_cache_aligned;
 
 extern struct rte_cryptodev *rte_cryptodevs;
+
+RTE_TRACE_POINT_DECLARE(rte_cryptodev_trace_enqueue_burst);
+RTE_TRACE_POINT_DECLARE(rte_cryptodev_trace_dequeue_burst);
+
+/**
+ * @internal
+ * Instrumentation hooks of the burst functions, called only when enabled.
+ */
+void
+__rte_cryptodev_instr_enqueue_pre(struct rte_cryptodev_qp_instr *instr);
+void
+__rte_cryptodev_instr_enqueue(struct rte_cryptodev_qp_instr *instr,
+		uint16_t nb_ops, uint16_t nb_enq);
+void
+__rte_cryptodev_instr_dequeue(struct rte_cryptodev_qp_instr *instr,
+		uint16_t nb_deq);
+
 /**
  *
  * Dequeue a burst of processed crypto operations from a queue on the crypto
@@ -710,11 +884,19 @@ rte_cryptodev_dequeue_burst(uint8_t dev_id, uint16_t qp_id,
 		struct rte_crypto_op **ops, uint16_t nb_ops)
 {
 	struct rte_cryptodev *dev = &rte_cryptodevs[dev_id];
+	uint16_t nb_deq;
 
-	nb_ops = (*dev->dequeue_burst)
+	nb_deq = (*dev->dequeue_burst)
 			(dev->data->queue_pairs[qp_id], ops, nb_ops);
 
-	return nb_ops;
+#ifdef RTE_CRYPTODEV_INSTRUMENT
+	if (unlikely(dev->qp_instr != NULL))
+		__rte_cryptodev_instr_dequeue(&dev->qp_instr[qp_id], nb_deq);
+#endif
+
+	rte_trace_point_emit(&rte_cryptodev_trace_dequeue_burst, dev_id,
+			qp_id, nb_ops, nb_deq);
+	return nb_deq;
 }
 
 /**
@@ -753,9 +935,25 @@ rte_cryptodev_enqueue_burst(uint8_t dev_id, uint16_t qp_id,
 		struct rte_crypto_op **ops, uint16_t nb_ops)
 {
 	struct rte_cryptodev *dev = &rte_cryptodevs[dev_id];
+	uint16_t nb_enq;
 
-	return (*dev->enqueue_burst)(
+#ifdef RTE_CRYPTODEV_INSTRUMENT
+	if (unlikely(dev->qp_instr != NULL))
+		__rte_cryptodev_instr_enqueue_pre(&dev->qp_instr[qp_id]);
+#endif
+
+	nb_enq = (*dev->enqueue_burst)(
 			dev->data->queue_pairs[qp_id], ops, nb_ops);
+
+#ifdef RTE_CRYPTODEV_INSTRUMENT
+	if (unlikely(dev->qp_instr != NULL))
+		__rte_cryptodev_instr_enqueue(&dev->qp_instr[qp_id], nb_ops,
+				nb_enq);
+#endif
+
+	rte_trace_point_emit(&rte_cryptodev_trace_enqueue_burst, dev_id,
+			qp_id, nb_ops, nb_enq);
+	return nb_enq;
 }
 
 
@@ -816,6 +1014,31 @@ extern struct rte_cryptodev_sym_session *
 rte_cryptodev_sym_session_free(uint8_t dev_id,
 		struct rte_cryptodev_sym_session *session);
 
+/**
+ * Creates a crypto operation pool for use with a given device. On top of the
+ * user private data of *rte_crypto_op_pool_create*, each operation carries
+ * the per-operation private area the device PMD asks for, which the PMD then
+ * uses instead of allocating its own context for each enqueued operation.
+ * The pool can still be used with any other device.
+ *
+ * @param	name		pool name
+ * @param	type		crypto operation type
+ * @param	nb_elts		number of elements in pool
+ * @param	cache_size	Number of elements to cache on lcore
+ * @param	priv_size	Size of user private data to allocate with each
+ *				operation
+ * @param	dev_id		The device identifier.
+ * @param	socket_id	Socket to allocate memory on
+ *
+ * @return
+ *  - On success pointer to mempool
+ *  - On failure NULL
+ */
+extern struct rte_mempool *
+rte_cryptodev_op_pool_create(const char *name, enum rte_crypto_op_type type,
+		unsigned nb_elts, unsigned cache_size, uint16_t priv_size,
+		uint8_t dev_id, int socket_id);
+
 
 #ifdef __cplusplus
 }
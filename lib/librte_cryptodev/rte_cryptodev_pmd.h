@@ -279,6 +279,41 @@ typedef void (*cryptodev_stats_get_t)(struct rte_cryptodev *dev,
  */
 typedef void (*cryptodev_stats_reset_t)(struct rte_cryptodev *dev);
 
+/**
+ * Get PMD specific extended statistics of a device.
+ *
+ * @param	dev	Crypto device pointer
+ * @param	xstats	Array to fill, NULL to only count the statistics
+ * @param	n	Capacity of xstats
+ *
+ * @return
+ *  - Number of PMD statistics, whatever n is
+ *  - Negative value on error
+ */
+typedef int (*cryptodev_xstats_get_t)(struct rte_cryptodev *dev,
+		struct rte_cryptodev_xstat *xstats, unsigned n);
+
+/**
+ * Get the names of the PMD specific extended statistics of a device.
+ *
+ * @param	dev		Crypto device pointer
+ * @param	xstats_names	Array to fill, NULL to only count the names
+ * @param	size		Capacity of xstats_names
+ *
+ * @return
+ *  - Number of PMD statistics, whatever size is
+ *  - Negative value on error
+ */
+typedef int (*cryptodev_xstats_get_names_t)(struct rte_cryptodev *dev,
+		struct rte_cryptodev_xstat_name *xstats_names, unsigned size);
+
+/**
+ * Reset PMD specific extended statistics of a device.
+ *
+ * @param	dev	Crypto device pointer
+ */
+typedef void (*cryptodev_xstats_reset_t)(struct rte_cryptodev *dev);
+
 
 /**
  * Function used to get specific information of a device.
@@ -410,6 +445,18 @@ typedef void * (*cryptodev_sym_configure_session_t)(struct rte_cryptodev *dev,
 typedef void (*cryptodev_sym_free_session_t)(struct rte_cryptodev *dev,
 		void *session_private);
 
+/**
+ * Get the size of the driver private area the device wants reserved in each
+ * crypto operation, in place of a per-operation allocation of its own.
+ *
+ * @param	dev	Crypto device pointer
+ *
+ * @return
+ *  - Size of the per-operation private area, 0 if none is needed
+ */
+typedef unsigned (*cryptodev_sym_get_op_private_size_t)(
+		struct rte_cryptodev *dev);
+
 
 /** Crypto device operations function pointer table */
 struct rte_cryptodev_ops {
@@ -424,6 +471,12 @@ struct rte_cryptodev_ops {
 	/**< Get device statistics. */
 	cryptodev_stats_reset_t stats_reset;
 	/**< Reset device statistics. */
+	cryptodev_xstats_get_t xstats_get;
+	/**< Get PMD specific extended statistics. */
+	cryptodev_xstats_get_names_t xstats_get_names;
+	/**< Get names of PMD specific extended statistics. */
+	cryptodev_xstats_reset_t xstats_reset;
+	/**< Reset PMD specific extended statistics. */
 
 	cryptodev_queue_pair_setup_t queue_pair_setup;
 	/**< Set up a device queue pair. */
@@ -444,6 +497,8 @@ struct rte_cryptodev_ops {
 	/**< Configure a Crypto session. */
 	cryptodev_sym_free_session_t session_clear;
 	/**< Clear a Crypto sessions private data. */
+	cryptodev_sym_get_op_private_size_t op_priv_get_size;
+	/**< Return size of the per-operation private area. */
 };
 
 
@@ -535,6 +590,72 @@ rte_cryptodev_pmd_driver_register(struct rte_cryptodev_driver *crypto_drv,
 void rte_cryptodev_pmd_callback_process(struct rte_cryptodev *dev,
 				enum rte_cryptodev_event_type event);
 
+/**
+ * Cache of the sessions a queue pair prepared for session-less operations,
+ * looked up by the content of their transform chain and evicting the least
+ * recently used one. Setting up a session then costs a lookup instead of a
+ * session allocation and configuration for every operation. A cache is not
+ * thread safe, it is meant to be owned by one queue pair.
+ */
+struct rte_cryptodev_sym_session_cache;
+
+/**
+ * Create a session cache for a device.
+ *
+ * @param	dev_id		The device identifier.
+ * @param	nb_sessions	Number of sessions to keep at most, rounded down
+ *				to a multiple of the ways of a set. They come
+ *				from the device session pool.
+ * @param	socket_id	Socket to allocate memory on
+ *
+ * @return
+ *  - Pointer to the cache on success
+ *  - NULL on failure
+ */
+struct rte_cryptodev_sym_session_cache *
+rte_cryptodev_sym_session_cache_create(uint8_t dev_id,
+		unsigned int nb_sessions, int socket_id);
+
+/**
+ * Free a session cache and the sessions it holds. No operation using them
+ * may be in flight.
+ *
+ * @param	cache	Session cache, or NULL
+ */
+void
+rte_cryptodev_sym_session_cache_free(
+		struct rte_cryptodev_sym_session_cache *cache);
+
+/**
+ * Get the session of a transform chain, creating it on a miss. The session
+ * stays valid until it is released with
+ * *rte_cryptodev_sym_session_cache_put*.
+ *
+ * @param	cache	Session cache
+ * @param	xform	Transform chain of a session-less operation
+ * @param	slot	Filled with the handle to release the session with
+ *
+ * @return
+ *  - The session on success
+ *  - NULL if the chain cannot be cached, all sessions it could replace
+ *    are in use, or the session cannot be created
+ */
+struct rte_cryptodev_sym_session *
+rte_cryptodev_sym_session_cache_get(
+		struct rte_cryptodev_sym_session_cache *cache,
+		struct rte_crypto_sym_xform *xform, uint32_t *slot);
+
+/**
+ * Release a session got from a session cache, once the operation using it
+ * completed.
+ *
+ * @param	cache	Session cache
+ * @param	slot	Handle filled by *rte_cryptodev_sym_session_cache_get*
+ */
+void
+rte_cryptodev_sym_session_cache_put(
+		struct rte_cryptodev_sym_session_cache *cache, uint32_t slot);
+
 
 #ifdef __cplusplus
 }
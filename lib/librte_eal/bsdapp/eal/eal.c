@@ -564,6 +564,9 @@ rte_eal_init(int argc, char **argv)
 	if (rte_eal_timer_init() < 0)
 		rte_panic("Cannot init HPET or TSC timers\n");
 
+	if (internal_config.log_async && rte_log_async_start() < 0)
+		rte_panic("Cannot start asynchronous logs\n");
+
 	if (rte_eal_pci_init() < 0)
 		rte_panic("Cannot init PCI\n");
 
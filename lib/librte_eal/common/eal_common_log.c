@@ -35,9 +35,19 @@
 #include <stdint.h>
 #include <stdarg.h>
 #include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
 
 #include <rte_log.h>
+#include <rte_memory.h>
 #include <rte_per_lcore.h>
+#include <rte_lcore.h>
+#include <rte_atomic.h>
+#include <rte_spinlock.h>
+#include <rte_cycles.h>
+#include <rte_branch_prediction.h>
 
 #include "eal_private.h"
 
@@ -62,6 +72,52 @@ struct log_cur_msg {
  /* per core log */
 static RTE_DEFINE_PER_LCORE(struct log_cur_msg, log_cur_msg);
 
+/* size of the text of an asynchronous log record */
+#define LOG_ASYNC_MSG_SIZE 244
+
+/* sleep time of the service thread when all the rings are empty */
+#define LOG_ASYNC_POLL_US 1000
+
+/**
+ * A log preformatted by an lcore, waiting to be written by the
+ * service thread.
+ */
+struct log_async_record {
+	uint32_t loglevel;
+	uint32_t logtype;
+	uint32_t len;                  /**< length of msg, without the '\0' */
+	char msg[LOG_ASYNC_MSG_SIZE];
+};
+
+/**
+ * Single producer (the lcore), single consumer (the service thread)
+ * ring of log records. The indexes are free running.
+ */
+struct log_async_ring {
+	/* written by the lcore only */
+	volatile uint32_t head __rte_cache_aligned;
+	uint64_t dropped;
+	/* written by the consumer only */
+	volatile uint32_t tail __rte_cache_aligned;
+	uint64_t written;
+	struct log_async_record recs[RTE_LOG_ASYNC_RING_SIZE]
+		__rte_cache_aligned;
+};
+
+static struct {
+	volatile int enabled;    /**< lcores push their logs in the rings */
+	volatile int running;    /**< the service thread is running */
+	pthread_t thread;
+	rte_spinlock_t lock;     /**< serializes the consumers */
+	int atexit_registered;
+	struct log_async_ring *rings[RTE_MAX_LCORE];
+} log_async = {
+	.lock = RTE_SPINLOCK_INITIALIZER,
+};
+
+/* number of logs suppressed by rate limiting */
+static rte_atomic64_t log_ratelimited = RTE_ATOMIC64_INIT(0);
+
 /* default logs */
 
 int
@@ -137,19 +193,259 @@ rte_log_dump_history(FILE *out __rte_unused)
 {
 }
 
+/*
+ * Format a log in the next record of the ring of the calling lcore. The
+ * log is dropped if the ring is full.
+ */
+static int
+log_async_push(struct log_async_ring *r, uint32_t level, uint32_t logtype,
+		const char *format, va_list ap)
+{
+	struct log_async_record *rec;
+	uint32_t head = r->head;
+	int ret;
+
+	if (unlikely(head - r->tail >= RTE_LOG_ASYNC_RING_SIZE)) {
+		r->dropped++;
+		return -ENOBUFS;
+	}
+
+	rec = &r->recs[head & (RTE_LOG_ASYNC_RING_SIZE - 1)];
+	ret = vsnprintf(rec->msg, sizeof(rec->msg), format, ap);
+	if (ret < 0)
+		return ret;
+	if ((unsigned)ret >= sizeof(rec->msg)) {
+		/* truncated, but keep the end of line */
+		rec->len = sizeof(rec->msg) - 1;
+		rec->msg[rec->len - 1] = '\n';
+	} else {
+		rec->len = ret;
+	}
+	rec->loglevel = level;
+	rec->logtype = logtype;
+
+	/* the record must be written before being published */
+	rte_smp_wmb();
+	r->head = head + 1;
+
+	return ret;
+}
+
+/*
+ * Write all the records of the lcore rings to the log stream. Must be
+ * called with the consumer lock held. Returns the number of records.
+ */
+static unsigned
+log_async_drain(void)
+{
+	struct log_async_ring *r;
+	struct log_async_record *rec;
+	uint32_t head, tail;
+	unsigned lcore_id, n = 0;
+	FILE *f = rte_logs.file;
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		r = log_async.rings[lcore_id];
+		if (r == NULL)
+			continue;
+
+		tail = r->tail;
+		head = r->head;
+		if (head == tail)
+			continue;
+		/* read the records after the head */
+		rte_smp_rmb();
+
+		for (; tail != head; tail++) {
+			rec = &r->recs[tail & (RTE_LOG_ASYNC_RING_SIZE - 1)];
+			/* the stream may query the level and type of the log */
+			RTE_PER_LCORE(log_cur_msg).loglevel = rec->loglevel;
+			RTE_PER_LCORE(log_cur_msg).logtype = rec->logtype;
+			fwrite(rec->msg, 1, rec->len, f);
+			/* one write per log, as done by rte_vlog() */
+			fflush(f);
+			r->written++;
+			n++;
+		}
+
+		/* the records must be read before they can be reused */
+		rte_smp_mb();
+		r->tail = tail;
+	}
+
+	return n;
+}
+
+static void *
+log_async_thread(__attribute__((unused)) void *arg)
+{
+	unsigned n;
+
+	while (log_async.running) {
+		rte_spinlock_lock(&log_async.lock);
+		n = log_async_drain();
+		rte_spinlock_unlock(&log_async.lock);
+		if (n == 0)
+			usleep(LOG_ASYNC_POLL_US);
+	}
+
+	return NULL;
+}
+
+/* don't lose the pending logs when the application exits */
+static void
+log_async_atexit(void)
+{
+	rte_log_async_flush();
+}
+
+int
+rte_log_async_start(void)
+{
+	char thread_name[RTE_MAX_THREAD_NAME_LEN];
+	struct log_async_ring *r;
+	unsigned lcore_id;
+	int ret;
+
+	RTE_BUILD_BUG_ON(RTE_LOG_ASYNC_RING_SIZE &
+			(RTE_LOG_ASYNC_RING_SIZE - 1));
+
+	if (log_async.running)
+		return 0;
+
+	RTE_LCORE_FOREACH(lcore_id) {
+		if (log_async.rings[lcore_id] != NULL)
+			continue;
+		if (posix_memalign((void **)&r, RTE_CACHE_LINE_SIZE,
+				sizeof(*r)) != 0) {
+			RTE_LOG(ERR, EAL, "Cannot allocate log ring of lcore %u\n",
+				lcore_id);
+			return -ENOMEM;
+		}
+		memset(r, 0, sizeof(*r));
+		log_async.rings[lcore_id] = r;
+	}
+
+	log_async.running = 1;
+	ret = pthread_create(&log_async.thread, NULL, log_async_thread, NULL);
+	if (ret != 0) {
+		log_async.running = 0;
+		RTE_LOG(ERR, EAL, "Cannot create log service thread\n");
+		return -ret;
+	}
+
+	snprintf(thread_name, RTE_MAX_THREAD_NAME_LEN, "log-async");
+	if (rte_thread_setname(log_async.thread, thread_name) != 0)
+		RTE_LOG(DEBUG, EAL, "Cannot set log service thread name\n");
+
+	if (!log_async.atexit_registered && atexit(log_async_atexit) == 0)
+		log_async.atexit_registered = 1;
+
+	/* the rings must be allocated before lcores can use them */
+	rte_smp_wmb();
+	log_async.enabled = 1;
+
+	return 0;
+}
+
+void
+rte_log_async_stop(void)
+{
+	if (!log_async.running)
+		return;
+
+	log_async.enabled = 0;
+	rte_smp_mb();
+
+	log_async.running = 0;
+	pthread_join(log_async.thread, NULL);
+
+	/* the rings are kept for a later restart */
+	rte_log_async_flush();
+}
+
+void
+rte_log_async_flush(void)
+{
+	rte_spinlock_lock(&log_async.lock);
+	log_async_drain();
+	rte_spinlock_unlock(&log_async.lock);
+}
+
+void
+rte_log_get_stats(struct rte_log_stats *stats)
+{
+	struct log_async_ring *r;
+	unsigned lcore_id;
+
+	memset(stats, 0, sizeof(*stats));
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		r = log_async.rings[lcore_id];
+		if (r == NULL)
+			continue;
+		stats->async_written += r->written;
+		stats->async_dropped += r->dropped;
+	}
+	stats->ratelimited = rte_atomic64_read(&log_ratelimited);
+}
+
+int
+rte_log_ratelimit(struct rte_log_ratelimit *rl, uint32_t level,
+		uint32_t logtype)
+{
+	uint64_t hz = rte_get_timer_hz();
+	uint64_t now, begin;
+	uint32_t suppressed;
+
+	/* no rate limiting before the timers are initialized */
+	if (hz == 0)
+		return 1;
+
+	now = rte_get_timer_cycles();
+	begin = rl->begin;
+	if (begin == 0 || now - begin >= hz * rl->interval_ms / 1000) {
+		/* only one thread opens the new window */
+		if (rte_atomic64_cmpset(&rl->begin, begin, now)) {
+			rl->printed = 0;
+			suppressed = __sync_lock_test_and_set(&rl->suppressed, 0);
+			if (suppressed != 0)
+				rte_log(level, logtype,
+					"%u similar messages suppressed\n",
+					suppressed);
+		}
+	}
+
+	if (__sync_add_and_fetch(&rl->printed, 1) <= rl->burst)
+		return 1;
+
+	__sync_add_and_fetch(&rl->suppressed, 1);
+	rte_atomic64_inc(&log_ratelimited);
+	return 0;
+}
+
 /*
  * Generates a log message The message will be sent in the stream
- * defined by the previous call to rte_openlog_stream().
+ * defined by the previous call to rte_openlog_stream(), or queued in
+ * the ring of the lcore when the logs are asynchronous.
  */
 int
 rte_vlog(uint32_t level, uint32_t logtype, const char *format, va_list ap)
 {
 	int ret;
 	FILE *f = rte_logs.file;
+	unsigned lcore_id;
 
 	if ((level > rte_logs.level) || !(logtype & rte_logs.type))
 		return 0;
 
+	if (log_async.enabled) {
+		lcore_id = rte_lcore_id();
+		if (lcore_id < RTE_MAX_LCORE &&
+				log_async.rings[lcore_id] != NULL)
+			return log_async_push(log_async.rings[lcore_id],
+				level, logtype, format, ap);
+	}
+
 	/* save loglevel and logtype in a global per-lcore variable */
 	RTE_PER_LCORE(log_cur_msg).loglevel = level;
 	RTE_PER_LCORE(log_cur_msg).logtype = logtype;
@@ -50,10 +50,12 @@
 #include <rte_version.h>
 #include <rte_devargs.h>
 #include <rte_memcpy.h>
+#include <rte_trace.h>
 
 #include "eal_internal_cfg.h"
 #include "eal_options.h"
 #include "eal_filesystem.h"
+#include "eal_private.h"
 
 #define BITS_PER_HEX 4
 
@@ -78,8 +80,10 @@ eal_long_options[] = {
 	{OPT_FILE_PREFIX,       1, NULL, OPT_FILE_PREFIX_NUM      },
 	{OPT_HELP,              0, NULL, OPT_HELP_NUM             },
 	{OPT_HUGE_DIR,          1, NULL, OPT_HUGE_DIR_NUM         },
+	{OPT_HUGE_FAST_INIT,    0, NULL, OPT_HUGE_FAST_INIT_NUM   },
 	{OPT_HUGE_UNLINK,       0, NULL, OPT_HUGE_UNLINK_NUM      },
 	{OPT_LCORES,            1, NULL, OPT_LCORES_NUM           },
+	{OPT_LOG_ASYNC,         0, NULL, OPT_LOG_ASYNC_NUM        },
 	{OPT_LOG_LEVEL,         1, NULL, OPT_LOG_LEVEL_NUM        },
 	{OPT_MASTER_LCORE,      1, NULL, OPT_MASTER_LCORE_NUM     },
 	{OPT_NO_HPET,           0, NULL, OPT_NO_HPET_NUM          },
@@ -91,6 +95,8 @@ eal_long_options[] = {
 	{OPT_PROC_TYPE,         1, NULL, OPT_PROC_TYPE_NUM        },
 	{OPT_SOCKET_MEM,        1, NULL, OPT_SOCKET_MEM_NUM       },
 	{OPT_SYSLOG,            1, NULL, OPT_SYSLOG_NUM           },
+	{OPT_TRACE,             1, NULL, OPT_TRACE_NUM            },
+	{OPT_TRACE_DIR,         1, NULL, OPT_TRACE_DIR_NUM        },
 	{OPT_VDEV,              1, NULL, OPT_VDEV_NUM             },
 	{OPT_VFIO_INTR,         1, NULL, OPT_VFIO_INTR_NUM        },
 	{OPT_VMWARE_TSC_MAP,    0, NULL, OPT_VMWARE_TSC_MAP_NUM   },
@@ -153,8 +159,10 @@ eal_reset_internal_config(struct internal_config *internal_cfg)
 #else
 	internal_cfg->log_level = RTE_LOG_LEVEL;
 #endif
+	internal_cfg->log_async = 0;
 
 	internal_cfg->xen_dom0_support = 0;
+	internal_cfg->hugepage_fast_init = 0;
 
 	/* if set to NONE, interrupt mode is determined automatically */
 	internal_cfg->vfio_intr_mode = RTE_INTR_MODE_NONE;
@@ -906,6 +914,24 @@ eal_parse_common_option(int opt, const char *optarg,
 		conf->log_level = log;
 		break;
 	}
+	case OPT_LOG_ASYNC_NUM:
+		conf->log_async = 1;
+		break;
+
+	case OPT_TRACE_NUM:
+		if (rte_trace_point_enable(optarg) == 0)
+			RTE_LOG(WARNING, EAL, "no trace point matches %s\n",
+				optarg);
+		break;
+
+	case OPT_TRACE_DIR_NUM:
+		if (eal_trace_set_exit_dir(optarg) < 0) {
+			RTE_LOG(ERR, EAL, "invalid parameter for --"
+				OPT_TRACE_DIR "\n");
+			return -1;
+		}
+		break;
+
 	case OPT_LCORES_NUM:
 		if (eal_parse_lcores(optarg) < 0) {
 			RTE_LOG(ERR, EAL, "invalid parameter for --"
@@ -1028,6 +1054,10 @@ eal_common_usage(void)
 	       "  --"OPT_PROC_TYPE"         Type of this process (primary|secondary|auto)\n"
 	       "  --"OPT_SYSLOG"            Set syslog facility\n"
 	       "  --"OPT_LOG_LEVEL"         Set default log level\n"
+	       "  --"OPT_LOG_ASYNC"         Write the logs of lcores from a service thread\n"
+	       "  --"OPT_TRACE"=<pattern>   Enable the trace points matching a pattern\n"
+	       "                      (ex: --trace='lib.ethdev.*', can be repeated)\n"
+	       "  --"OPT_TRACE_DIR"         Dump the trace buffers in a directory at exit\n"
 	       "  -v                  Display version information on startup\n"
 	       "  -h, --help          This help\n"
 	       "\nEAL options for DEBUG use only:\n"
@@ -0,0 +1,371 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 Freescale Semiconductor, Inc. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of  Freescale Semiconductor, Inc nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <fnmatch.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <rte_common.h>
+#include <rte_log.h>
+#include <rte_lcore.h>
+#include <rte_cycles.h>
+#include <rte_spinlock.h>
+#include <rte_byteorder.h>
+#include <rte_trace.h>
+
+#include "eal_private.h"
+
+/* magic number of the CTF packet header */
+#define TRACE_CTF_MAGIC 0xC1FC1FC1
+
+RTE_DEFINE_PER_LCORE(struct rte_trace_buffer *, _trace_buffer);
+
+/* registered trace points, in registration order */
+static struct rte_trace_point *trace_points;
+static struct rte_trace_point **trace_points_tail = &trace_points;
+static uint16_t trace_points_count;
+
+/* buffers of all the threads which have written records */
+static struct rte_trace_buffer *trace_buffers;
+static unsigned trace_buffers_count;
+static rte_spinlock_t trace_buffers_lock = RTE_SPINLOCK_INITIALIZER;
+
+/* directory where the buffers are dumped when the application exits */
+static const char *trace_exit_dir;
+
+void
+__rte_trace_point_register(struct rte_trace_point *tp)
+{
+	tp->id = trace_points_count++;
+	tp->next = NULL;
+	*trace_points_tail = tp;
+	trace_points_tail = &tp->next;
+}
+
+struct rte_trace_buffer *
+__rte_trace_buffer_alloc(void)
+{
+	struct rte_trace_buffer *buf;
+
+	RTE_BUILD_BUG_ON(RTE_TRACE_BUFFER_SIZE & (RTE_TRACE_BUFFER_SIZE - 1));
+
+	if (posix_memalign((void **)&buf, RTE_CACHE_LINE_SIZE,
+			sizeof(*buf)) != 0)
+		return NULL;
+	memset(buf, 0, sizeof(*buf));
+	buf->lcore_id = rte_lcore_id();
+
+	rte_spinlock_lock(&trace_buffers_lock);
+	buf->thread_idx = trace_buffers_count++;
+	buf->next = trace_buffers;
+	trace_buffers = buf;
+	rte_spinlock_unlock(&trace_buffers_lock);
+
+	RTE_PER_LCORE(_trace_buffer) = buf;
+	return buf;
+}
+
+static int
+trace_point_set(const char *pattern, int enable)
+{
+	struct rte_trace_point *tp;
+	int count = 0;
+
+	for (tp = trace_points; tp != NULL; tp = tp->next) {
+		if (fnmatch(pattern, tp->name, 0) != 0)
+			continue;
+		tp->enabled = enable;
+		count++;
+	}
+	return count;
+}
+
+int
+rte_trace_point_enable(const char *pattern)
+{
+	return trace_point_set(pattern, 1);
+}
+
+int
+rte_trace_point_disable(const char *pattern)
+{
+	return trace_point_set(pattern, 0);
+}
+
+struct rte_trace_point *
+rte_trace_point_lookup(const char *name)
+{
+	struct rte_trace_point *tp;
+
+	for (tp = trace_points; tp != NULL; tp = tp->next)
+		if (strcmp(name, tp->name) == 0)
+			return tp;
+	return NULL;
+}
+
+void
+rte_trace_list(FILE *f)
+{
+	struct rte_trace_point *tp;
+
+	for (tp = trace_points; tp != NULL; tp = tp->next)
+		fprintf(f, "%s: %s\n", tp->name,
+			tp->enabled ? "enabled" : "disabled");
+}
+
+void
+rte_trace_reset(void)
+{
+	struct rte_trace_buffer *buf;
+
+	rte_spinlock_lock(&trace_buffers_lock);
+	for (buf = trace_buffers; buf != NULL; buf = buf->next)
+		buf->head = 0;
+	rte_spinlock_unlock(&trace_buffers_lock);
+}
+
+static unsigned
+trace_point_nb_args(const struct rte_trace_point *tp)
+{
+	unsigned i;
+
+	for (i = 0; i < RTE_TRACE_POINT_MAX_ARGS; i++)
+		if (tp->args[i] == NULL)
+			break;
+	return i;
+}
+
+/*
+ * Write the TSDL description of the trace: all the fields are 64-bit
+ * aligned, so that the streams can be written without padding.
+ */
+static int
+trace_dump_metadata(const char *dir)
+{
+	char path[PATH_MAX];
+	struct rte_trace_point *tp;
+	unsigned i;
+	FILE *f;
+
+	snprintf(path, sizeof(path), "%s/metadata", dir);
+	f = fopen(path, "w");
+	if (f == NULL) {
+		RTE_LOG(ERR, EAL, "Cannot create %s: %s\n", path,
+			strerror(errno));
+		return -errno;
+	}
+
+	fprintf(f, "/* CTF 1.8 */\n\n"
+		"typealias integer { size = 32; align = 8; signed = false; }"
+		" := uint32_t;\n"
+		"typealias integer { size = 64; align = 8; signed = false; }"
+		" := uint64_t;\n\n"
+		"trace {\n"
+		"\tmajor = 1;\n"
+		"\tminor = 8;\n"
+		"\tbyte_order = %s;\n"
+		"\tpacket.header := struct {\n"
+		"\t\tuint32_t magic;\n"
+		"\t\tuint32_t stream_id;\n"
+		"\t};\n"
+		"};\n\n"
+		"env {\n"
+		"\ttracer_name = \"dpdk\";\n"
+		"};\n\n"
+		"clock {\n"
+		"\tname = tsc;\n"
+		"\tfreq = %" PRIu64 ";\n"
+		"};\n\n"
+		"typealias integer { size = 64; align = 8; signed = false;"
+		" map = clock.tsc.value; } := tsc_t;\n\n"
+		"stream {\n"
+		"\tid = 0;\n"
+		"\tpacket.context := struct {\n"
+		"\t\tuint64_t content_size;\n"
+		"\t\tuint64_t packet_size;\n"
+		"\t\tuint32_t lcore_id;\n"
+		"\t\tuint32_t thread_idx;\n"
+		"\t};\n"
+		"\tevent.header := struct {\n"
+		"\t\tuint64_t id;\n"
+		"\t\ttsc_t timestamp;\n"
+		"\t};\n"
+		"};\n",
+#if RTE_BYTE_ORDER == RTE_LITTLE_ENDIAN
+		"le",
+#else
+		"be",
+#endif
+		rte_get_tsc_hz());
+
+	for (tp = trace_points; tp != NULL; tp = tp->next) {
+		fprintf(f, "\nevent {\n"
+			"\tname = \"%s\";\n"
+			"\tid = %u;\n"
+			"\tstream_id = 0;\n"
+			"\tfields := struct {\n", tp->name, tp->id);
+		for (i = 0; i < trace_point_nb_args(tp); i++)
+			fprintf(f, "\t\tuint64_t %s;\n", tp->args[i]);
+		fprintf(f, "\t};\n};\n");
+	}
+
+	if (fclose(f) != 0)
+		return -errno;
+	return 0;
+}
+
+/* Write the records of a buffer as a single CTF packet. */
+static int
+trace_dump_buffer(const char *dir, const struct rte_trace_buffer *buf,
+		const struct rte_trace_point **tps)
+{
+	char path[PATH_MAX];
+	const struct rte_trace_record *rec;
+	uint64_t head = buf->head, first, i, size;
+	struct {
+		uint32_t magic;
+		uint32_t stream_id;
+		uint64_t content_size;
+		uint64_t packet_size;
+		uint32_t lcore_id;
+		uint32_t thread_idx;
+	} hdr;
+	uint64_t ev[2];
+	unsigned nb_args;
+	FILE *f;
+
+	first = head > RTE_TRACE_BUFFER_SIZE ? head - RTE_TRACE_BUFFER_SIZE : 0;
+
+	size = sizeof(hdr);
+	for (i = first; i < head; i++) {
+		rec = &buf->recs[i & (RTE_TRACE_BUFFER_SIZE - 1)];
+		size += sizeof(ev) + trace_point_nb_args(tps[rec->id]) *
+			sizeof(uint64_t);
+	}
+
+	snprintf(path, sizeof(path), "%s/channel0_%u", dir, buf->thread_idx);
+	f = fopen(path, "w");
+	if (f == NULL) {
+		RTE_LOG(ERR, EAL, "Cannot create %s: %s\n", path,
+			strerror(errno));
+		return -errno;
+	}
+
+	hdr.magic = TRACE_CTF_MAGIC;
+	hdr.stream_id = 0;
+	hdr.content_size = size * CHAR_BIT;
+	hdr.packet_size = size * CHAR_BIT;
+	hdr.lcore_id = buf->lcore_id;
+	hdr.thread_idx = buf->thread_idx;
+	fwrite(&hdr, sizeof(hdr), 1, f);
+
+	for (i = first; i < head; i++) {
+		rec = &buf->recs[i & (RTE_TRACE_BUFFER_SIZE - 1)];
+		nb_args = trace_point_nb_args(tps[rec->id]);
+		ev[0] = rec->id;
+		ev[1] = rec->tsc;
+		fwrite(ev, sizeof(ev), 1, f);
+		if (nb_args != 0)
+			fwrite(rec->args, sizeof(uint64_t), nb_args, f);
+	}
+
+	if (fclose(f) != 0)
+		return -errno;
+	return head - first;
+}
+
+int
+rte_trace_dump(const char *dir)
+{
+	const struct rte_trace_point **tps;
+	struct rte_trace_point *tp;
+	struct rte_trace_buffer *buf;
+	int ret, count = 0;
+
+	if (mkdir(dir, 0755) < 0 && errno != EEXIST) {
+		RTE_LOG(ERR, EAL, "Cannot create trace directory %s: %s\n",
+			dir, strerror(errno));
+		return -errno;
+	}
+
+	ret = trace_dump_metadata(dir);
+	if (ret < 0)
+		return ret;
+
+	/* index the trace points by identifier */
+	tps = calloc(trace_points_count + 1, sizeof(*tps));
+	if (tps == NULL)
+		return -ENOMEM;
+	for (tp = trace_points; tp != NULL; tp = tp->next)
+		tps[tp->id] = tp;
+
+	rte_spinlock_lock(&trace_buffers_lock);
+	for (buf = trace_buffers; buf != NULL; buf = buf->next) {
+		if (buf->head == 0)
+			continue;
+		ret = trace_dump_buffer(dir, buf, tps);
+		if (ret < 0)
+			break;
+		count += ret;
+	}
+	rte_spinlock_unlock(&trace_buffers_lock);
+
+	free(tps);
+	return ret < 0 ? ret : count;
+}
+
+static void
+trace_dump_at_exit(void)
+{
+	int ret;
+
+	ret = rte_trace_dump(trace_exit_dir);
+	if (ret >= 0)
+		RTE_LOG(INFO, EAL, "%d trace records dumped in %s\n", ret,
+			trace_exit_dir);
+}
+
+int
+eal_trace_set_exit_dir(const char *dir)
+{
+	if (trace_exit_dir == NULL && atexit(trace_dump_at_exit) != 0)
+		return -1;
+	trace_exit_dir = dir;
+	return 0;
+}
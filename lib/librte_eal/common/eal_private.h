@@ -330,4 +330,16 @@ int rte_eal_hugepage_attach(void);
   */
 int rte_eal_soc_pre_init(void);
 
+/**
+ * Dump the trace buffers in a directory when the application exits.
+ *
+ * This function is private to the EAL.
+ *
+ * @param dir
+ *   The directory, see rte_trace_dump().
+ * @return
+ *   0 on success, negative on error
+ */
+int eal_trace_set_exit_dir(const char *dir);
+
 #endif /* _EAL_PRIVATE_H_ */
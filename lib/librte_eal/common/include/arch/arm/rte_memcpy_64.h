@@ -42,6 +42,222 @@ extern "C" {
 
 #include "generic/rte_memcpy.h"
 
+#ifdef RTE_ARCH_ARM64_MEMCPY
+
+/* ARM NEON Intrinsics are used to copy data */
+#include <arm_neon.h>
+
+static inline void
+rte_mov16(uint8_t *dst, const uint8_t *src)
+{
+	vst1q_u8(dst, vld1q_u8(src));
+}
+
+static inline void
+rte_mov32(uint8_t *dst, const uint8_t *src)
+{
+	asm volatile (
+		"ldp q0, q1, [%0]\n\t"
+		"stp q0, q1, [%1]\n\t"
+		: : "r" (src), "r" (dst)
+		: "memory", "v0", "v1");
+}
+
+static inline void
+rte_mov48(uint8_t *dst, const uint8_t *src)
+{
+	asm volatile (
+		"ldp q0, q1, [%0]\n\t"
+		"ldr q2, [%0, #32]\n\t"
+		"stp q0, q1, [%1]\n\t"
+		"str q2, [%1, #32]\n\t"
+		: : "r" (src), "r" (dst)
+		: "memory", "v0", "v1", "v2");
+}
+
+static inline void
+rte_mov64(uint8_t *dst, const uint8_t *src)
+{
+	asm volatile (
+		"ldp q0, q1, [%0]\n\t"
+		"ldp q2, q3, [%0, #32]\n\t"
+		"stp q0, q1, [%1]\n\t"
+		"stp q2, q3, [%1, #32]\n\t"
+		: : "r" (src), "r" (dst)
+		: "memory", "v0", "v1", "v2", "v3");
+}
+
+static inline void
+rte_mov128(uint8_t *dst, const uint8_t *src)
+{
+	asm volatile (
+		"ldp q0, q1, [%0]\n\t"
+		"ldp q2, q3, [%0, #32]\n\t"
+		"ldp q4, q5, [%0, #64]\n\t"
+		"ldp q6, q7, [%0, #96]\n\t"
+		"stp q0, q1, [%1]\n\t"
+		"stp q2, q3, [%1, #32]\n\t"
+		"stp q4, q5, [%1, #64]\n\t"
+		"stp q6, q7, [%1, #96]\n\t"
+		: : "r" (src), "r" (dst)
+		: "memory", "v0", "v1", "v2", "v3", "v4", "v5", "v6", "v7");
+}
+
+static inline void
+rte_mov256(uint8_t *dst, const uint8_t *src)
+{
+	asm volatile ("prfm pldl1strm, [%0, #256]" : : "r" (src));
+	asm volatile ("prfm pldl1strm, [%0, #320]" : : "r" (src));
+	asm volatile ("prfm pldl1strm, [%0, #384]" : : "r" (src));
+	asm volatile ("prfm pldl1strm, [%0, #448]" : : "r" (src));
+	asm volatile (
+		"ldp q0, q1, [%0]\n\t"
+		"ldp q2, q3, [%0, #32]\n\t"
+		"ldp q4, q5, [%0, #64]\n\t"
+		"ldp q6, q7, [%0, #96]\n\t"
+		"ldp q16, q17, [%0, #128]\n\t"
+		"ldp q18, q19, [%0, #160]\n\t"
+		"ldp q20, q21, [%0, #192]\n\t"
+		"ldp q22, q23, [%0, #224]\n\t"
+		"stp q0, q1, [%1]\n\t"
+		"stp q2, q3, [%1, #32]\n\t"
+		"stp q4, q5, [%1, #64]\n\t"
+		"stp q6, q7, [%1, #96]\n\t"
+		"stp q16, q17, [%1, #128]\n\t"
+		"stp q18, q19, [%1, #160]\n\t"
+		"stp q20, q21, [%1, #192]\n\t"
+		"stp q22, q23, [%1, #224]\n\t"
+		: : "r" (src), "r" (dst)
+		: "memory", "v0", "v1", "v2", "v3", "v4", "v5", "v6", "v7",
+		"v16", "v17", "v18", "v19", "v20", "v21", "v22", "v23");
+}
+
+/*
+ * Copy less than 16 bytes. ARMv8 handles unaligned scalar accesses, so
+ * the copy is done with two (possibly overlapping) loads and stores of
+ * the largest power of 2 that fits.
+ */
+static inline void
+rte_memcpy_lt16(uint8_t *dst, const uint8_t *src, size_t n)
+{
+	if (n & 0x08) {
+		/* copy 8 ~ 15 bytes */
+		*(uint64_t *)dst = *(const uint64_t *)src;
+		*(uint64_t *)(dst - 8 + n) = *(const uint64_t *)(src - 8 + n);
+	} else if (n & 0x04) {
+		/* copy 4 ~ 7 bytes */
+		*(uint32_t *)dst = *(const uint32_t *)src;
+		*(uint32_t *)(dst - 4 + n) = *(const uint32_t *)(src - 4 + n);
+	} else if (n & 0x02) {
+		/* copy 2 ~ 3 bytes */
+		*(uint16_t *)dst = *(const uint16_t *)src;
+		*(uint16_t *)(dst - 2 + n) = *(const uint16_t *)(src - 2 + n);
+	} else if (n & 0x01) {
+		/* copy 1 byte */
+		*dst = *src;
+	}
+}
+
+/*
+ * Copy 16 ~ 256 bytes with at most two (possibly overlapping) LDP/STP
+ * blocks, without any loop.
+ */
+static inline void
+rte_memcpy_le256(uint8_t *dst, const uint8_t *src, size_t n)
+{
+	if (n <= 32) {
+		rte_mov16(dst, src);
+		rte_mov16(dst - 16 + n, src - 16 + n);
+	} else if (n <= 64) {
+		rte_mov32(dst, src);
+		rte_mov32(dst - 32 + n, src - 32 + n);
+	} else if (n <= 128) {
+		rte_mov64(dst, src);
+		rte_mov64(dst - 64 + n, src - 64 + n);
+	} else {
+		rte_mov128(dst, src);
+		rte_mov128(dst - 128 + n, src - 128 + n);
+	}
+}
+
+/*
+ * Copy more than 256 bytes. The first 16 bytes are copied unaligned and
+ * the destination is then aligned on 16 bytes, so that the 256 byte
+ * LDP/STP loop never splits a store across cache lines. The tail is
+ * copied with an overlapping block.
+ */
+static inline void
+rte_memcpy_gt256(uint8_t *dst, const uint8_t *src, size_t n)
+{
+	size_t off;
+
+	rte_mov16(dst, src);
+	off = 16 - ((uintptr_t)dst & 0x0F);
+	dst += off;
+	src += off;
+	n -= off;
+
+	for ( ; n >= 256; n -= 256) {
+		rte_mov256(dst, src);
+		dst += 256;
+		src += 256;
+	}
+
+	/* Copy any remaining bytes, without going beyond end of buffers */
+	if (n > 16)
+		rte_memcpy_le256(dst, src, n);
+	else if (n != 0)
+		rte_mov16(dst - 16 + n, src - 16 + n);
+}
+
+static inline void *
+rte_memcpy_func(void *dst, const void *src, size_t n)
+{
+	if (n < 16)
+		rte_memcpy_lt16((uint8_t *)dst, (const uint8_t *)src, n);
+	else if (n <= 256)
+		rte_memcpy_le256((uint8_t *)dst, (const uint8_t *)src, n);
+	else
+		rte_memcpy_gt256((uint8_t *)dst, (const uint8_t *)src, n);
+	return dst;
+}
+
+/*
+ * Specializations for the most common compile-time constant sizes. Any
+ * other constant size is left to the compiler, which expands small
+ * memcpy() calls inline.
+ */
+static inline void * __attribute__((always_inline))
+rte_memcpy_const(void *dst, const void *src, size_t n)
+{
+	switch (n) {
+	case 16:
+		rte_mov16((uint8_t *)dst, (const uint8_t *)src);
+		return dst;
+	case 32:
+		rte_mov32((uint8_t *)dst, (const uint8_t *)src);
+		return dst;
+	case 48:
+		rte_mov48((uint8_t *)dst, (const uint8_t *)src);
+		return dst;
+	case 64:
+		rte_mov64((uint8_t *)dst, (const uint8_t *)src);
+		return dst;
+	case 128:
+		rte_mov128((uint8_t *)dst, (const uint8_t *)src);
+		return dst;
+	default:
+		return memcpy(dst, src, n);
+	}
+}
+
+#define rte_memcpy(dst, src, n)              \
+	({ (__builtin_constant_p(n)) ?       \
+	rte_memcpy_const((dst), (src), (n)) : \
+	rte_memcpy_func((dst), (src), (n)); })
+
+#else
+
 static inline void
 rte_mov16(uint8_t *dst, const uint8_t *src)
 {
@@ -80,6 +296,8 @@ rte_mov256(uint8_t *dst, const uint8_t *src)
 
 #define rte_memcpy(d, s, n)	memcpy((d), (s), (n))
 
+#endif /* RTE_ARCH_ARM64_MEMCPY */
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,205 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 Freescale Semiconductor, Inc. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of  Freescale Semiconductor, Inc nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_BRWLOCK_H_
+#define _RTE_BRWLOCK_H_
+
+/**
+ * @file
+ *
+ * RTE Reader-Biased (Big Reader) Read-Write Locks
+ *
+ * This file defines an API for read-write locks optimized for read-mostly
+ * data. Each lcore has its own reader indicator on a dedicated cache line,
+ * so taking a read lock only writes to a line owned by the calling lcore
+ * and readers never bounce a shared lock word between them, unlike
+ * rte_rwlock_t. The price is paid by the writer, which has to scan the
+ * indicators of all lcores.
+ *
+ * Non-EAL threads (without an lcore id) share a single reader indicator.
+ * A read lock must not be taken recursively.
+ *
+ * All locks must be initialised before use, and only initialised once.
+ *
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <rte_common.h>
+#include <rte_memory.h>
+#include <rte_lcore.h>
+#include <rte_atomic.h>
+
+/**
+ * Reader indicator, one per lcore.
+ */
+struct rte_brwlock_reader {
+	uint32_t cnt; /**< number of read locks held */
+} __rte_cache_aligned;
+
+/**
+ * The rte_brwlock_t type.
+ */
+typedef struct {
+	uint32_t writer; /**< 1 when a writer holds or waits for the lock */
+	/** Reader indicator shared by the non-EAL threads. */
+	struct rte_brwlock_reader shared __rte_cache_aligned;
+	/** Reader indicators of the EAL lcores. */
+	struct rte_brwlock_reader reader[RTE_MAX_LCORE];
+} rte_brwlock_t;
+
+/**
+ * A static brwlock initializer.
+ */
+#define RTE_BRWLOCK_INITIALIZER { 0 }
+
+/**
+ * Initialize the brwlock to an unlocked state.
+ *
+ * @param brwl
+ *   A pointer to the brwlock structure.
+ */
+static inline void
+rte_brwlock_init(rte_brwlock_t *brwl)
+{
+	unsigned int i;
+
+	brwl->writer = 0;
+	brwl->shared.cnt = 0;
+	for (i = 0; i < RTE_MAX_LCORE; i++)
+		brwl->reader[i].cnt = 0;
+}
+
+/* Return the reader indicator of the calling thread. */
+static inline uint32_t *
+__rte_brwlock_reader_cnt(rte_brwlock_t *brwl)
+{
+	unsigned int lcore_id = rte_lcore_id();
+
+	if (likely(lcore_id < RTE_MAX_LCORE))
+		return &brwl->reader[lcore_id].cnt;
+	return &brwl->shared.cnt;
+}
+
+/**
+ * Take a read lock. Loop until the lock is held.
+ *
+ * @param brwl
+ *   A pointer to a brwlock structure.
+ */
+static inline void
+rte_brwlock_read_lock(rte_brwlock_t *brwl)
+{
+	uint32_t *cnt = __rte_brwlock_reader_cnt(brwl);
+
+	for (;;) {
+		/*
+		 * Announce the reader, then check for a writer. Both
+		 * accesses are sequentially consistent, so either the
+		 * writer sees us or we see the writer.
+		 */
+		__atomic_fetch_add(cnt, 1, __ATOMIC_SEQ_CST);
+		if (likely(__atomic_load_n(&brwl->writer,
+					   __ATOMIC_SEQ_CST) == 0))
+			return;
+
+		/* back off and let the writer go first */
+		__atomic_fetch_sub(cnt, 1, __ATOMIC_RELEASE);
+		while (__atomic_load_n(&brwl->writer, __ATOMIC_RELAXED))
+			rte_pause();
+	}
+}
+
+/**
+ * Release a read lock.
+ *
+ * @param brwl
+ *   A pointer to the brwlock structure.
+ */
+static inline void
+rte_brwlock_read_unlock(rte_brwlock_t *brwl)
+{
+	__atomic_fetch_sub(__rte_brwlock_reader_cnt(brwl), 1,
+			   __ATOMIC_RELEASE);
+}
+
+/**
+ * Take a write lock. Loop until the lock is held.
+ *
+ * New readers are held back as soon as the writer is waiting, then the
+ * writer waits for the readers in progress to drain.
+ *
+ * @param brwl
+ *   A pointer to a brwlock structure.
+ */
+static inline void
+rte_brwlock_write_lock(rte_brwlock_t *brwl)
+{
+	uint32_t expected;
+	unsigned int i;
+
+	for (;;) {
+		expected = 0;
+		if (__atomic_compare_exchange_n(&brwl->writer, &expected, 1,
+				0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+			break;
+		while (__atomic_load_n(&brwl->writer, __ATOMIC_RELAXED))
+			rte_pause();
+	}
+
+	for (i = 0; i < RTE_MAX_LCORE; i++)
+		while (__atomic_load_n(&brwl->reader[i].cnt,
+				       __ATOMIC_SEQ_CST) != 0)
+			rte_pause();
+	while (__atomic_load_n(&brwl->shared.cnt, __ATOMIC_SEQ_CST) != 0)
+		rte_pause();
+}
+
+/**
+ * Release a write lock.
+ *
+ * @param brwl
+ *   A pointer to a brwlock structure.
+ */
+static inline void
+rte_brwlock_write_unlock(rte_brwlock_t *brwl)
+{
+	__atomic_store_n(&brwl->writer, 0, __ATOMIC_RELEASE);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_BRWLOCK_H_ */
@@ -81,6 +81,8 @@ extern struct rte_logs rte_logs;
 #define RTE_LOGTYPE_PIPELINE 0x00008000 /**< Log related to pipeline. */
 #define RTE_LOGTYPE_MBUF    0x00010000 /**< Log related to mbuf. */
 #define RTE_LOGTYPE_CRYPTODEV 0x00020000 /**< Log related to cryptodev. */
+#define RTE_LOGTYPE_RCU     0x00040000 /**< Log related to RCU. */
+#define RTE_LOGTYPE_PMU     0x00080000 /**< Log related to PMU. */
 
 /* these log types can be used in an application */
 #define RTE_LOGTYPE_USER1   0x01000000 /**< User-defined log type 1. */
@@ -312,6 +314,130 @@ int rte_vlog(uint32_t level, uint32_t logtype, const char *format, va_list ap)
 		 RTE_LOGTYPE_ ## t, # t ": " __VA_ARGS__) :	\
 	 0)
 
+/**
+ * State of a rate-limited log site, see RTE_LOG_RATELIMIT().
+ *
+ * It is shared by all the threads logging from the same site.
+ */
+struct rte_log_ratelimit {
+	uint32_t interval_ms; /**< Length of a window, in milliseconds. */
+	uint32_t burst;       /**< Number of logs allowed per window. */
+	volatile uint64_t begin;     /**< Start of the window, in timer cycles. */
+	volatile uint32_t printed;   /**< Logs attempted in the window. */
+	volatile uint32_t suppressed; /**< Logs suppressed in the window. */
+};
+
+/**
+ * Static initializer of a rte_log_ratelimit structure.
+ *
+ * @param interval
+ *   Length of a window, in milliseconds.
+ * @param nb
+ *   Number of logs allowed per window.
+ */
+#define RTE_LOG_RATELIMIT_INITIALIZER(interval, nb) \
+	{ .interval_ms = (interval), .burst = (nb) }
+
+/** Log statistics, see rte_log_get_stats(). */
+struct rte_log_stats {
+	uint64_t async_written; /**< Records written by the log service thread. */
+	uint64_t async_dropped; /**< Records dropped because a ring was full. */
+	uint64_t ratelimited;   /**< Logs suppressed by rate limiting. */
+};
+
+/**
+ * Check whether a log site may log now.
+ *
+ * At most rl->burst logs are allowed per window of rl->interval_ms
+ * milliseconds. When a new window starts, the number of logs suppressed
+ * in the previous one is reported with the given level and type.
+ * This function is lock-free and can be called from any thread.
+ *
+ * @param rl
+ *   The state of the log site.
+ * @param level
+ *   Log level of the site.
+ * @param logtype
+ *   Log type of the site.
+ * @return
+ *   1 if the log can be generated, 0 if it must be suppressed.
+ */
+int rte_log_ratelimit(struct rte_log_ratelimit *rl, uint32_t level,
+		uint32_t logtype);
+
+/**
+ * Generates a rate-limited log message.
+ *
+ * Same as RTE_LOG(), but at most burst messages are generated from this
+ * call site per interval_ms milliseconds. It is meant for logs which can
+ * be triggered from the data path, like allocation failures.
+ *
+ * @param l
+ *   Log level, as in RTE_LOG().
+ * @param t
+ *   Log type, as in RTE_LOG().
+ * @param interval_ms
+ *   Length of a rate-limiting window, in milliseconds.
+ * @param burst
+ *   Number of messages allowed per window.
+ * @param ...
+ *   The fmt string, as in printf(3), followed by the variable arguments
+ *   required by the format.
+ */
+#define RTE_LOG_RATELIMIT(l, t, interval_ms, burst, ...) do {		\
+	static struct rte_log_ratelimit __rte_log_rl =			\
+		RTE_LOG_RATELIMIT_INITIALIZER(interval_ms, burst);	\
+	if (RTE_LOG_ ## l <= RTE_LOG_LEVEL &&				\
+			RTE_LOG_ ## l <= rte_logs.level &&		\
+			(RTE_LOGTYPE_ ## t & rte_logs.type) &&		\
+			rte_log_ratelimit(&__rte_log_rl, RTE_LOG_ ## l,	\
+				RTE_LOGTYPE_ ## t))			\
+		rte_log(RTE_LOG_ ## l,					\
+			RTE_LOGTYPE_ ## t, # t ": " __VA_ARGS__);	\
+} while (0)
+
+/**
+ * Start writing the logs of EAL lcores asynchronously.
+ *
+ * Once started, a log generated from an EAL lcore is formatted into a
+ * record of a lock-free ring private to this lcore, and written to the
+ * log stream by a service thread. This avoids blocking the lcore on the
+ * I/O of the log stream, syslog included. If the ring of an lcore is
+ * full, the record is dropped and counted in the log statistics.
+ * Logs from other threads are still written synchronously.
+ *
+ * This is done by the EAL when the --log-async option is given.
+ *
+ * @return
+ *   - 0 on success.
+ *   - Negative on error.
+ */
+int rte_log_async_start(void);
+
+/**
+ * Stop writing the logs asynchronously.
+ *
+ * The pending records are written, and the service thread is stopped.
+ * It must not be called from an EAL lcore which is logging concurrently.
+ */
+void rte_log_async_stop(void);
+
+/**
+ * Write all the records pending in the lcore rings.
+ *
+ * Only the records queued before this call are guaranteed to be written
+ * when it returns.
+ */
+void rte_log_async_flush(void);
+
+/**
+ * Retrieve the log statistics.
+ *
+ * @param stats
+ *   A pointer to a structure filled with the statistics.
+ */
+void rte_log_get_stats(struct rte_log_stats *stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -42,6 +42,7 @@
 
 #include <stdio.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <rte_memory.h>
 
 #ifdef __cplusplus
@@ -60,6 +61,28 @@ struct rte_malloc_socket_stats {
 	size_t heap_allocsz_bytes; /**< Total allocated bytes on heap */
 };
 
+/** Largest allocation served by the per-lcore caches. */
+#define RTE_MALLOC_CACHE_MAX_OBJ_SIZE 4096
+
+/**
+ * Number of size classes of the per-lcore caches: powers of two from the
+ * cache line size up to RTE_MALLOC_CACHE_MAX_OBJ_SIZE.
+ */
+#define RTE_MALLOC_CACHE_NUM_CLASSES (12 - RTE_CACHE_LINE_SIZE_LOG2 + 1)
+
+/**
+ * Structure to hold the statistics of a size class of the per-lcore caches,
+ * obtained from rte_malloc_get_class_stats function.
+ */
+struct rte_malloc_class_stats {
+	size_t size;            /**< Largest allocation served by the class */
+	unsigned cached_count;  /**< Objects currently held in lcore caches */
+	uint64_t alloc_hits;    /**< Allocations served from a lcore cache */
+	uint64_t alloc_refills; /**< Allocations refilling a lcore cache */
+	uint64_t free_hits;     /**< Frees kept in a lcore cache */
+	uint64_t free_flushes;  /**< Frees flushing a lcore cache to the heap */
+};
+
 /**
  * This function allocates memory from the huge-page area of memory. The memory
  * is not cleared. In NUMA systems, the memory allocated resides on the same
@@ -279,6 +302,9 @@ rte_malloc_validate(const void *ptr, size_t *size);
 /**
  * Get heap statistics for the specified heap.
  *
+ * The memory held in the per-lcore caches of the calling process is
+ * accounted as free, although it is not part of the free elements.
+ *
  * @param socket
  *   An unsigned integer specifying the socket to get heap statistics for
  * @param socket_stats
@@ -291,6 +317,34 @@ int
 rte_malloc_get_socket_stats(int socket,
 		struct rte_malloc_socket_stats *socket_stats);
 
+/**
+ * Get the statistics of a size class of the per-lcore caches.
+ *
+ * Small allocations from EAL threads are served from per-lcore caches of
+ * free objects, one per size class, which are refilled from and flushed to
+ * the heap in bulk. The statistics are the sum of all the lcores of the
+ * calling process.
+ *
+ * @param class_id
+ *   The size class, lower than RTE_MALLOC_CACHE_NUM_CLASSES.
+ * @param stats
+ *   A structure which provides memory to store statistics
+ * @return
+ *   - 0: Success.
+ *   - (-1): Invalid class or caches disabled at build time.
+ */
+int
+rte_malloc_get_class_stats(unsigned class_id,
+		struct rte_malloc_class_stats *stats);
+
+/**
+ * Return all the objects held in the cache of the calling lcore to the heap.
+ *
+ * It does nothing when called from a non-EAL thread.
+ */
+void
+rte_malloc_cache_flush(void);
+
 /**
  * Dump statistics.
  *
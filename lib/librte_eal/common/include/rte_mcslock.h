@@ -0,0 +1,165 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 Freescale Semiconductor, Inc. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of  Freescale Semiconductor, Inc nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_MCSLOCK_H_
+#define _RTE_MCSLOCK_H_
+
+/**
+ * @file
+ *
+ * RTE MCS Locks
+ *
+ * This file defines an API for MCS queued locks. Each contending thread
+ * provides its own queue node and spins on a flag in that node, so a
+ * waiter only reads its own cache line instead of the shared lock word.
+ * The lock is granted in FIFO order and stays scalable under heavy
+ * contention.
+ *
+ * The lock itself is a pointer to the tail of the queue, NULL when the
+ * lock is free. The queue node must stay valid (e.g. on the stack of the
+ * caller) from the lock to the unlock call.
+ *
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <rte_common.h>
+#include <rte_lcore.h>
+#include <rte_atomic.h>
+
+/**
+ * The rte_mcslock_t type, used both as queue node and, through a pointer
+ * to it, as the lock itself.
+ */
+typedef struct rte_mcslock {
+	struct rte_mcslock *next; /**< next waiter in the queue */
+	int locked;               /**< 1 while the owner of this node waits */
+} rte_mcslock_t;
+
+/**
+ * Take the MCS lock.
+ *
+ * @param msl
+ *   A pointer to the pointer of the MCS lock. It must be set to NULL
+ *   before the first use.
+ * @param me
+ *   A pointer to a new queue node for the caller.
+ */
+static inline void
+rte_mcslock_lock(rte_mcslock_t **msl, rte_mcslock_t *me)
+{
+	rte_mcslock_t *prev;
+
+	__atomic_store_n(&me->locked, 1, __ATOMIC_RELAXED);
+	__atomic_store_n(&me->next, NULL, __ATOMIC_RELAXED);
+
+	/* Queue our node; the previous tail, if any, is the node to wait on */
+	prev = __atomic_exchange_n(msl, me, __ATOMIC_ACQ_REL);
+	if (likely(prev == NULL))
+		return;
+
+	/* Link behind the previous waiter, then spin on our own node only */
+	__atomic_store_n(&prev->next, me, __ATOMIC_RELEASE);
+	while (__atomic_load_n(&me->locked, __ATOMIC_ACQUIRE))
+		rte_pause();
+}
+
+/**
+ * Release the MCS lock.
+ *
+ * @param msl
+ *   A pointer to the pointer of the MCS lock.
+ * @param me
+ *   A pointer to the queue node used to take the lock.
+ */
+static inline void
+rte_mcslock_unlock(rte_mcslock_t **msl, rte_mcslock_t *me)
+{
+	if (likely(__atomic_load_n(&me->next, __ATOMIC_RELAXED) == NULL)) {
+		rte_mcslock_t *save_me = me;
+
+		/* No known successor: try to mark the lock free */
+		if (likely(__atomic_compare_exchange_n(msl, &save_me, NULL, 0,
+				__ATOMIC_RELEASE, __ATOMIC_RELAXED)))
+			return;
+
+		/* A new waiter is queuing: wait until it links to us */
+		while (__atomic_load_n(&me->next, __ATOMIC_ACQUIRE) == NULL)
+			rte_pause();
+	}
+
+	/* Hand the lock over to the next waiter */
+	__atomic_store_n(&me->next->locked, 0, __ATOMIC_RELEASE);
+}
+
+/**
+ * Try to take the MCS lock.
+ *
+ * @param msl
+ *   A pointer to the pointer of the MCS lock.
+ * @param me
+ *   A pointer to a new queue node for the caller.
+ * @return
+ *   1 if the lock is successfully taken; 0 otherwise.
+ */
+static inline int
+rte_mcslock_trylock(rte_mcslock_t **msl, rte_mcslock_t *me)
+{
+	rte_mcslock_t *expected = NULL;
+
+	__atomic_store_n(&me->next, NULL, __ATOMIC_RELAXED);
+
+	return __atomic_compare_exchange_n(msl, &expected, me, 0,
+			__ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+}
+
+/**
+ * Test if the MCS lock is taken.
+ *
+ * @param msl
+ *   A pointer to the pointer of the MCS lock.
+ * @return
+ *   1 if the lock is currently taken; 0 otherwise.
+ */
+static inline int
+rte_mcslock_is_locked(rte_mcslock_t **msl)
+{
+	return __atomic_load_n(msl, __ATOMIC_RELAXED) != NULL;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_MCSLOCK_H_ */
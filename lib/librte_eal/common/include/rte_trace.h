@@ -0,0 +1,284 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 Freescale Semiconductor, Inc. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of  Freescale Semiconductor, Inc nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_TRACE_H_
+#define _RTE_TRACE_H_
+
+/**
+ * @file
+ *
+ * RTE Trace Points
+ *
+ * Trace points are statically defined in the code of libraries and
+ * drivers. When a trace point is disabled, it costs a test and a branch.
+ * When it is enabled, it writes a fixed-size binary record, timestamped
+ * with the TSC, in a ring buffer private to the calling thread. The ring
+ * buffers keep the most recent records, and can be dumped in the Common
+ * Trace Format (CTF) for offline analysis, for example with babeltrace.
+ *
+ * A trace point is defined once in a C file of its library:
+ *
+ *     RTE_TRACE_POINT_DEFINE(rte_foo_trace_bar, "lib.foo.bar",
+ *             "arg0", "arg1", NULL, NULL);
+ *
+ * declared in the header where it is used:
+ *
+ *     RTE_TRACE_POINT_DECLARE(rte_foo_trace_bar);
+ *
+ * and emitted with up to RTE_TRACE_POINT_MAX_ARGS integer arguments:
+ *
+ *     rte_trace_point_emit(&rte_foo_trace_bar, arg0, arg1, 0, 0);
+ *
+ * Trace points are compiled out of the fast path when CONFIG_RTE_TRACE
+ * is disabled.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <rte_common.h>
+#include <rte_per_lcore.h>
+#include <rte_cycles.h>
+#include <rte_branch_prediction.h>
+
+/** Maximum number of arguments of a trace point. */
+#define RTE_TRACE_POINT_MAX_ARGS 4
+
+/** A statically defined trace point. */
+struct rte_trace_point {
+	volatile int enabled;   /**< True if records are written. */
+	uint16_t id;            /**< Identifier, in the records. */
+	const char *name;       /**< Name, like "lib.ethdev.rx_burst". */
+	/** Names of the arguments, NULL for unused ones. */
+	const char *args[RTE_TRACE_POINT_MAX_ARGS];
+	struct rte_trace_point *next; /**< Next registered trace point. */
+};
+
+/** A trace record, as written by an enabled trace point. */
+struct rte_trace_record {
+	uint64_t tsc;           /**< Timestamp, in TSC cycles. */
+	uint16_t id;            /**< Identifier of the trace point. */
+	uint16_t reserved[3];
+	uint64_t args[RTE_TRACE_POINT_MAX_ARGS]; /**< Arguments. */
+};
+
+/** Ring buffer of the trace records of a thread. */
+struct rte_trace_buffer {
+	uint64_t head;          /**< Number of records written. */
+	unsigned lcore_id;      /**< lcore of the thread, or LCORE_ID_ANY. */
+	unsigned thread_idx;    /**< Index of the buffer, in creation order. */
+	struct rte_trace_buffer *next; /**< Next buffer of the list. */
+	/** Most recent records. */
+	struct rte_trace_record recs[RTE_TRACE_BUFFER_SIZE];
+};
+
+RTE_DECLARE_PER_LCORE(struct rte_trace_buffer *, _trace_buffer);
+
+/**
+ * @internal Register a trace point, called from a constructor.
+ *
+ * @param tp
+ *   The trace point.
+ */
+void __rte_trace_point_register(struct rte_trace_point *tp);
+
+/**
+ * @internal Allocate the trace buffer of the calling thread.
+ *
+ * @return
+ *   The buffer, or NULL on error.
+ */
+struct rte_trace_buffer *__rte_trace_buffer_alloc(void);
+
+/**
+ * Declare a trace point defined in another file.
+ *
+ * @param tp
+ *   Name of the trace point variable.
+ */
+#define RTE_TRACE_POINT_DECLARE(tp) \
+	extern struct rte_trace_point tp
+
+/**
+ * Define and register a trace point.
+ *
+ * @param tp
+ *   Name of the trace point variable.
+ * @param tp_name
+ *   Name of the trace point, as a string.
+ * @param a0
+ *   Name of the first argument, or NULL.
+ * @param a1
+ *   Name of the second argument, or NULL.
+ * @param a2
+ *   Name of the third argument, or NULL.
+ * @param a3
+ *   Name of the fourth argument, or NULL.
+ */
+#define RTE_TRACE_POINT_DEFINE(tp, tp_name, a0, a1, a2, a3)		\
+struct rte_trace_point tp = {						\
+	.name = tp_name,						\
+	.args = { a0, a1, a2, a3 },					\
+};									\
+static void __attribute__((constructor, used))				\
+tp ## _register(void)							\
+{									\
+	__rte_trace_point_register(&tp);				\
+}
+
+/**
+ * @internal Write a record in the trace buffer of the calling thread.
+ */
+static inline void
+__rte_trace_point_write(const struct rte_trace_point *tp, uint64_t a0,
+		uint64_t a1, uint64_t a2, uint64_t a3)
+{
+	struct rte_trace_buffer *buf = RTE_PER_LCORE(_trace_buffer);
+	struct rte_trace_record *rec;
+
+	if (unlikely(buf == NULL)) {
+		buf = __rte_trace_buffer_alloc();
+		if (buf == NULL)
+			return;
+	}
+
+	rec = &buf->recs[buf->head & (RTE_TRACE_BUFFER_SIZE - 1)];
+	rec->tsc = rte_rdtsc();
+	rec->id = tp->id;
+	rec->args[0] = a0;
+	rec->args[1] = a1;
+	rec->args[2] = a2;
+	rec->args[3] = a3;
+	buf->head++;
+}
+
+/**
+ * Emit a trace point.
+ *
+ * A record is written if the trace point is enabled.
+ *
+ * @param tp
+ *   A pointer to the trace point.
+ * @param a0
+ *   First argument.
+ * @param a1
+ *   Second argument.
+ * @param a2
+ *   Third argument.
+ * @param a3
+ *   Fourth argument.
+ */
+static inline void __attribute__((always_inline))
+rte_trace_point_emit(const struct rte_trace_point *tp, uint64_t a0,
+		uint64_t a1, uint64_t a2, uint64_t a3)
+{
+#ifdef RTE_TRACE
+	if (unlikely(tp->enabled))
+		__rte_trace_point_write(tp, a0, a1, a2, a3);
+#else
+	RTE_SET_USED(tp);
+	RTE_SET_USED(a0);
+	RTE_SET_USED(a1);
+	RTE_SET_USED(a2);
+	RTE_SET_USED(a3);
+#endif
+}
+
+/**
+ * Enable the trace points matching a pattern.
+ *
+ * @param pattern
+ *   A shell wildcard pattern, as in fnmatch(3), like "lib.ethdev.*".
+ * @return
+ *   The number of trace points enabled.
+ */
+int rte_trace_point_enable(const char *pattern);
+
+/**
+ * Disable the trace points matching a pattern.
+ *
+ * @param pattern
+ *   A shell wildcard pattern, as in fnmatch(3).
+ * @return
+ *   The number of trace points disabled.
+ */
+int rte_trace_point_disable(const char *pattern);
+
+/**
+ * Look up a trace point by its name.
+ *
+ * @param name
+ *   The name of the trace point.
+ * @return
+ *   The trace point, or NULL if not found.
+ */
+struct rte_trace_point *rte_trace_point_lookup(const char *name);
+
+/**
+ * Dump the list of the trace points and their state.
+ *
+ * @param f
+ *   A pointer to a file for output.
+ */
+void rte_trace_list(FILE *f);
+
+/**
+ * Discard the records of all the trace buffers.
+ *
+ * It must not be called while records are being written.
+ */
+void rte_trace_reset(void);
+
+/**
+ * Dump the trace buffers in the Common Trace Format.
+ *
+ * A metadata file and one stream file per thread which has written
+ * records are created in a directory. The trace points should be
+ * disabled, or the threads should not write records, while dumping.
+ *
+ * @param dir
+ *   The directory, which is created if it does not exist.
+ * @return
+ *   - The number of records dumped on success.
+ *   - Negative on error.
+ */
+int rte_trace_dump(const char *dir);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_TRACE_H_ */
@@ -264,17 +264,12 @@ join_elem(struct malloc_elem *elem1, struct malloc_elem *elem2)
 }
 
 /*
- * free a malloc_elem block by adding it to the free list. If the
- * blocks either immediately before or immediately after newly freed block
- * are also free, the blocks are merged together.
+ * free a malloc_elem block by adding it to the free list, merging it with
+ * its neighbours when they are free. The heap lock must be held.
  */
-int
-malloc_elem_free(struct malloc_elem *elem)
+static void
+elem_free_locked(struct malloc_elem *elem)
 {
-	if (!malloc_elem_cookies_ok(elem) || elem->state != ELEM_BUSY)
-		return -1;
-
-	rte_spinlock_lock(&(elem->heap->lock));
 	size_t sz = elem->size - sizeof(*elem);
 	uint8_t *ptr = (uint8_t *)&elem[1];
 	struct malloc_elem *next = RTE_PTR_ADD(elem, elem->size);
@@ -301,12 +296,47 @@ malloc_elem_free(struct malloc_elem *elem)
 	elem->heap->alloc_count--;
 
 	memset(ptr, 0, sz);
+}
+
+/*
+ * free a malloc_elem block by adding it to the free list. If the
+ * blocks either immediately before or immediately after newly freed block
+ * are also free, the blocks are merged together.
+ */
+int
+malloc_elem_free(struct malloc_elem *elem)
+{
+	struct malloc_heap *heap;
+
+	if (!malloc_elem_cookies_ok(elem) || elem->state != ELEM_BUSY)
+		return -1;
+
+	/* the header is cleared when merged with the previous element */
+	heap = elem->heap;
 
-	rte_spinlock_unlock(&(elem->heap->lock));
+	rte_spinlock_lock(&heap->lock);
+	elem_free_locked(elem);
+	rte_spinlock_unlock(&heap->lock);
 
 	return 0;
 }
 
+/*
+ * free several malloc_elem blocks of the same heap, taking the heap lock
+ * only once. The elements must have been checked by the caller.
+ */
+void
+malloc_elem_free_bulk(struct malloc_heap *heap, struct malloc_elem **elems,
+		unsigned n)
+{
+	unsigned i;
+
+	rte_spinlock_lock(&heap->lock);
+	for (i = 0; i < n; i++)
+		elem_free_locked(elems[i]);
+	rte_spinlock_unlock(&heap->lock);
+}
+
 /*
  * attempt to resize a malloc_elem by expanding into any free space
  * immediately after it in memory.
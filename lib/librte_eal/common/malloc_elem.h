@@ -42,7 +42,8 @@ struct malloc_heap;
 enum elem_state {
 	ELEM_FREE = 0,
 	ELEM_BUSY,
-	ELEM_PAD  /* element is a padding-only header */
+	ELEM_PAD,  /* element is a padding-only header */
+	ELEM_CACHED  /* busy element held by a per-lcore malloc cache */
 };
 
 struct malloc_elem {
@@ -170,6 +171,14 @@ malloc_elem_alloc(struct malloc_elem *elem, size_t size,
 int
 malloc_elem_free(struct malloc_elem *elem);
 
+/*
+ * free several malloc_elem blocks belonging to the same heap, taking the
+ * heap lock only once.
+ */
+void
+malloc_elem_free_bulk(struct malloc_heap *heap, struct malloc_elem **elems,
+		unsigned n);
+
 /*
  * attempt to resize a malloc_elem by expanding into any free space
  * immediately after it in memory.
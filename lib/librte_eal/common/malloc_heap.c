@@ -174,6 +174,36 @@ malloc_heap_alloc(struct malloc_heap *heap,
 	return elem == NULL ? NULL : (void *)(&elem[1]);
 }
 
+/*
+ * Allocate up to n blocks of the same size from the heap, taking the lock
+ * only once. Used to refill the per-lcore caches. Returns the number of
+ * blocks allocated, the data pointers being stored in objs.
+ */
+unsigned
+malloc_heap_alloc_bulk(struct malloc_heap *heap, size_t size, size_t align,
+		void **objs, unsigned n)
+{
+	struct malloc_elem *elem;
+	unsigned i;
+
+	size = RTE_CACHE_LINE_ROUNDUP(size);
+	align = RTE_CACHE_LINE_ROUNDUP(align);
+
+	rte_spinlock_lock(&heap->lock);
+
+	for (i = 0; i < n; i++) {
+		elem = find_suitable_element(heap, size, 0, align, 0);
+		if (elem == NULL)
+			break;
+		elem = malloc_elem_alloc(elem, size, align, 0);
+		heap->alloc_count++;
+		objs[i] = &elem[1];
+	}
+	rte_spinlock_unlock(&heap->lock);
+
+	return i;
+}
+
 /*
  * Function to retrieve data for heap on given socket
  */
@@ -33,6 +33,7 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <inttypes.h>
 #include <stdio.h>
 #include <string.h>
 #include <sys/queue.h>
@@ -53,12 +54,293 @@
 #include "malloc_elem.h"
 #include "malloc_heap.h"
 
+#if RTE_MALLOC_CACHE_SIZE > 0
+
+/*
+ * Per-lcore caches of free objects, in front of the heap.
+ *
+ * Small allocations from an EAL thread on its local heap are served from a
+ * cache of the calling lcore, without taking the heap lock. There is one
+ * cache per size class, each class serving the sizes up to a power of two.
+ * An empty cache is refilled with a bulk of objects allocated from the heap
+ * under a single lock, and a full cache flushes its oldest objects to the
+ * heap in the same way.
+ *
+ * The cached objects remain allocated elements of the heap, in the CACHED
+ * state so that freeing them again is caught, and their data is cleared when
+ * they enter the cache, as the heap does for the free elements.
+ */
+
+#define MALLOC_CACHE_BULK ((RTE_MALLOC_CACHE_SIZE + 1) / 2)
+
+struct malloc_cache_obj {
+	void *addr;        /* data pointer returned to the application */
+	size_t elem_size;  /* size of the heap element holding it */
+};
+
+struct malloc_cache_class {
+	unsigned len;
+	size_t bytes;      /* sum of the heap element sizes */
+	uint64_t alloc_hits;
+	uint64_t alloc_refills;
+	uint64_t free_hits;
+	uint64_t free_flushes;
+	struct malloc_cache_obj objs[RTE_MALLOC_CACHE_SIZE];
+};
+
+struct malloc_lcore_cache {
+	struct malloc_heap *heap; /* heap of the lcore socket */
+	struct malloc_cache_class classes[RTE_MALLOC_CACHE_NUM_CLASSES];
+} __rte_cache_aligned;
+
+static struct malloc_lcore_cache malloc_caches[RTE_MAX_LCORE];
+
+/* Get the cache of the calling lcore, NULL for non-EAL threads */
+static inline struct malloc_lcore_cache *
+malloc_cache_get(void)
+{
+	struct rte_mem_config *mcfg = rte_eal_get_configuration()->mem_config;
+	unsigned lcore_id = rte_lcore_id();
+	struct malloc_lcore_cache *cache;
+
+	if (lcore_id >= RTE_MAX_LCORE)
+		return NULL;
+
+	cache = &malloc_caches[lcore_id];
+	if (unlikely(cache->heap == NULL))
+		cache->heap = &mcfg->malloc_heaps[malloc_get_numa_socket()];
+
+	return cache;
+}
+
+/* Smallest size class serving an allocation of the given size */
+static inline unsigned
+malloc_cache_alloc_class(size_t size)
+{
+	if (size <= RTE_CACHE_LINE_SIZE)
+		return 0;
+	return sizeof(size) * 8 - __builtin_clzl(size - 1) -
+		RTE_CACHE_LINE_SIZE_LOG2;
+}
+
+/* Largest size class a block of the given usable size can serve */
+static inline unsigned
+malloc_cache_free_class(size_t size)
+{
+	unsigned idx = sizeof(size) * 8 - 1 - __builtin_clzl(size) -
+		RTE_CACHE_LINE_SIZE_LOG2;
+
+	return RTE_MIN(idx, RTE_MALLOC_CACHE_NUM_CLASSES - 1U);
+}
+
+static void
+malloc_cache_flush_class(struct malloc_lcore_cache *cache,
+		struct malloc_cache_class *cls, unsigned n)
+{
+	struct malloc_elem *elems[RTE_MALLOC_CACHE_SIZE];
+	unsigned i;
+
+	for (i = 0; i < n; i++) {
+		elems[i] = malloc_elem_from_data(cls->objs[i].addr);
+		elems[i]->state = ELEM_BUSY;
+		cls->bytes -= cls->objs[i].elem_size;
+	}
+	malloc_elem_free_bulk(cache->heap, elems, n);
+
+	cls->len -= n;
+	memmove(&cls->objs[0], &cls->objs[n], cls->len * sizeof(cls->objs[0]));
+}
+
+/* Allocate a small block from the cache of the calling lcore */
+static void *
+malloc_cache_alloc(struct malloc_heap *heap, size_t size)
+{
+	struct malloc_lcore_cache *cache = malloc_cache_get();
+	struct malloc_cache_class *cls;
+	struct malloc_cache_obj *obj;
+	struct malloc_elem *elem;
+	void *objs[MALLOC_CACHE_BULK];
+	unsigned idx, i, n;
+
+	if (cache == NULL || cache->heap != heap)
+		return NULL;
+
+	idx = malloc_cache_alloc_class(size);
+	cls = &cache->classes[idx];
+	if (likely(cls->len != 0)) {
+		cls->alloc_hits++;
+	} else {
+		n = malloc_heap_alloc_bulk(cache->heap,
+				(size_t)RTE_CACHE_LINE_SIZE << idx,
+				RTE_CACHE_LINE_SIZE, objs, MALLOC_CACHE_BULK);
+		if (n == 0)
+			return NULL;
+		for (i = 0; i < n; i++) {
+			elem = malloc_elem_from_data(objs[i]);
+			elem->state = ELEM_CACHED;
+			cls->objs[i].addr = objs[i];
+			cls->objs[i].elem_size = elem->size;
+			cls->bytes += cls->objs[i].elem_size;
+		}
+		cls->len = n;
+		cls->alloc_refills++;
+	}
+
+	obj = &cls->objs[--cls->len];
+	cls->bytes -= obj->elem_size;
+	malloc_elem_from_data(obj->addr)->state = ELEM_BUSY;
+
+	return obj->addr;
+}
+
+/* Keep a freed block in the lcore cache, return -1 if it does not fit */
+static int
+malloc_cache_free(struct malloc_elem *elem, void *addr)
+{
+	struct malloc_lcore_cache *cache = malloc_cache_get();
+	struct malloc_cache_class *cls;
+	size_t size;
+
+	if (cache == NULL || elem->heap != cache->heap)
+		return -1;
+
+	/* usable size, from the data pointer to the trailer */
+	size = RTE_PTR_DIFF(RTE_PTR_ADD(elem, elem->size -
+				MALLOC_ELEM_TRAILER_LEN), addr);
+	if (size < RTE_CACHE_LINE_SIZE ||
+			size >= 2 * RTE_MALLOC_CACHE_MAX_OBJ_SIZE)
+		return -1;
+
+	cls = &cache->classes[malloc_cache_free_class(size)];
+	if (unlikely(cls->len == RTE_MALLOC_CACHE_SIZE)) {
+		malloc_cache_flush_class(cache, cls, MALLOC_CACHE_BULK);
+		cls->free_flushes++;
+	} else {
+		cls->free_hits++;
+	}
+
+	/* the heap hands out cleared memory */
+	memset(addr, 0, size);
+
+	elem->state = ELEM_CACHED;
+	cls->objs[cls->len].addr = addr;
+	cls->objs[cls->len].elem_size = elem->size;
+	cls->bytes += elem->size;
+	cls->len++;
+
+	return 0;
+}
+
+/* Sum the sizes and the number of the objects cached from a heap */
+static void
+malloc_cache_count(const struct malloc_heap *heap, size_t *bytes,
+		unsigned *count)
+{
+	const struct malloc_cache_class *cls;
+	unsigned lcore_id, idx;
+
+	*bytes = 0;
+	*count = 0;
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		if (malloc_caches[lcore_id].heap != heap)
+			continue;
+		for (idx = 0; idx < RTE_MALLOC_CACHE_NUM_CLASSES; idx++) {
+			cls = &malloc_caches[lcore_id].classes[idx];
+			*bytes += cls->bytes;
+			*count += cls->len;
+		}
+	}
+}
+
+/* Account the cached objects of a heap as free */
+static void
+malloc_cache_get_stats(const struct malloc_heap *heap,
+		struct rte_malloc_socket_stats *socket_stats)
+{
+	size_t bytes;
+	unsigned count;
+
+	malloc_cache_count(heap, &bytes, &count);
+	socket_stats->heap_freesz_bytes += bytes;
+	socket_stats->heap_allocsz_bytes -= bytes;
+	socket_stats->alloc_count -= count;
+}
+
+/* Return the objects cached by the calling lcore to the heap, if any */
+static int
+malloc_cache_flush_local(void)
+{
+	struct malloc_lcore_cache *cache = malloc_cache_get();
+	unsigned idx, n = 0;
+
+	if (cache == NULL)
+		return 0;
+
+	for (idx = 0; idx < RTE_MALLOC_CACHE_NUM_CLASSES; idx++) {
+		n += cache->classes[idx].len;
+		malloc_cache_flush_class(cache, &cache->classes[idx],
+				cache->classes[idx].len);
+	}
+
+	return n;
+}
+
+/*
+ * Return to the heap the block following elem, or following the free space
+ * after elem, if the calling lcore caches it, so that elem can grow into it.
+ */
+static int
+malloc_cache_release_next(const struct malloc_elem *elem)
+{
+	struct malloc_lcore_cache *cache = malloc_cache_get();
+	const struct malloc_elem *next = RTE_PTR_ADD(elem, elem->size);
+	struct malloc_cache_class *cls;
+	struct malloc_cache_obj obj;
+	unsigned idx, i;
+
+	if (cache == NULL || elem->heap != cache->heap)
+		return -1;
+
+	/* free neighbours are merged, a single one may sit in between */
+	rte_spinlock_lock(&cache->heap->lock);
+	if (next->state == ELEM_FREE)
+		next = RTE_PTR_ADD(next, next->size);
+	rte_spinlock_unlock(&cache->heap->lock);
+
+	for (idx = 0; idx < RTE_MALLOC_CACHE_NUM_CLASSES; idx++) {
+		cls = &cache->classes[idx];
+		for (i = 0; i < cls->len; i++) {
+			if (malloc_elem_from_data(cls->objs[i].addr) != next)
+				continue;
+			/* move it first, where the class is flushed from */
+			obj = cls->objs[i];
+			memmove(&cls->objs[1], &cls->objs[0],
+					i * sizeof(cls->objs[0]));
+			cls->objs[0] = obj;
+			malloc_cache_flush_class(cache, cls, 1);
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+#endif /* RTE_MALLOC_CACHE_SIZE > 0 */
 
 /* Free the memory space back to heap */
 void rte_free(void *addr)
 {
+	struct malloc_elem *elem;
+
 	if (addr == NULL) return;
-	if (malloc_elem_free(malloc_elem_from_data(addr)) < 0)
+	elem = malloc_elem_from_data(addr);
+#if RTE_MALLOC_CACHE_SIZE > 0
+	if (elem != NULL && elem->state == ELEM_BUSY &&
+			malloc_cache_free(elem, addr) == 0)
+		return;
+#endif
+	/* a cached block freed again is not BUSY and is caught here */
+	if (malloc_elem_free(elem) < 0)
 		rte_panic("Fatal error: Invalid memory\n");
 }
 
@@ -71,6 +353,9 @@ rte_malloc_socket(const char *type, size_t size, unsigned align, int socket_arg)
 	struct rte_mem_config *mcfg = rte_eal_get_configuration()->mem_config;
 	int socket, i;
 	void *ret;
+#if RTE_MALLOC_CACHE_SIZE > 0
+	int retry = 1;
+#endif
 
 	/* return NULL if size is 0 or alignment is not power-of-2 */
 	if (size == 0 || (align && !rte_is_power_of_2(align)))
@@ -88,13 +373,24 @@ rte_malloc_socket(const char *type, size_t size, unsigned align, int socket_arg)
 	if (socket >= RTE_MAX_NUMA_NODES)
 		return NULL;
 
+#if RTE_MALLOC_CACHE_SIZE > 0
+	if (size <= RTE_MALLOC_CACHE_MAX_OBJ_SIZE &&
+			align <= RTE_CACHE_LINE_SIZE) {
+		ret = malloc_cache_alloc(&mcfg->malloc_heaps[socket], size);
+		if (ret != NULL)
+			return ret;
+	}
+again:
+#endif
+
 	ret = malloc_heap_alloc(&mcfg->malloc_heaps[socket], type,
 				size, 0, align == 0 ? 1 : align, 0);
-	if (ret != NULL || socket_arg != SOCKET_ID_ANY)
+	if (ret != NULL)
 		return ret;
 
 	/* try other heaps */
-	for (i = 0; i < RTE_MAX_NUMA_NODES; i++) {
+	for (i = 0; socket_arg == SOCKET_ID_ANY && i < RTE_MAX_NUMA_NODES;
+			i++) {
 		/* we already tried this one */
 		if (i == socket)
 			continue;
@@ -105,6 +401,15 @@ rte_malloc_socket(const char *type, size_t size, unsigned align, int socket_arg)
 			return ret;
 	}
 
+#if RTE_MALLOC_CACHE_SIZE > 0
+	/*
+	 * the blocks cached by the calling lcore may be what the heap is
+	 * missing; those of the other lcores are theirs to flush
+	 */
+	if (retry-- && malloc_cache_flush_local() > 0)
+		goto again;
+#endif
+
 	return NULL;
 }
 
@@ -171,6 +476,13 @@ rte_realloc(void *ptr, size_t size, unsigned align)
 	if (RTE_PTR_ALIGN(ptr,align) == ptr &&
 			malloc_elem_resize(elem, size) == 0)
 		return ptr;
+#if RTE_MALLOC_CACHE_SIZE > 0
+	/* the blocks following it may be held by the lcore cache */
+	while (RTE_PTR_ALIGN(ptr, align) == ptr &&
+			malloc_cache_release_next(elem) == 0)
+		if (malloc_elem_resize(elem, size) == 0)
+			return ptr;
+#endif
 
 	/* either alignment is off, or we have no room to expand,
 	 * so move data. */
@@ -204,10 +516,64 @@ rte_malloc_get_socket_stats(int socket,
 {
 	struct rte_mem_config *mcfg = rte_eal_get_configuration()->mem_config;
 
+	struct malloc_heap *heap;
+
 	if (socket >= RTE_MAX_NUMA_NODES || socket < 0)
 		return -1;
 
-	return malloc_heap_get_stats(&mcfg->malloc_heaps[socket], socket_stats);
+	heap = &mcfg->malloc_heaps[socket];
+	if (malloc_heap_get_stats(heap, socket_stats) < 0)
+		return -1;
+
+#if RTE_MALLOC_CACHE_SIZE > 0
+	malloc_cache_get_stats(heap, socket_stats);
+#endif
+
+	return 0;
+}
+
+/*
+ * Function to retrieve data for a size class of the lcore caches
+ */
+int
+rte_malloc_get_class_stats(unsigned class_id,
+		struct rte_malloc_class_stats *stats)
+{
+#if RTE_MALLOC_CACHE_SIZE > 0
+	const struct malloc_cache_class *cls;
+	unsigned lcore_id;
+
+	if (class_id >= RTE_MALLOC_CACHE_NUM_CLASSES || stats == NULL)
+		return -1;
+
+	memset(stats, 0, sizeof(*stats));
+	stats->size = (size_t)RTE_CACHE_LINE_SIZE << class_id;
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		cls = &malloc_caches[lcore_id].classes[class_id];
+		stats->cached_count += cls->len;
+		stats->alloc_hits += cls->alloc_hits;
+		stats->alloc_refills += cls->alloc_refills;
+		stats->free_hits += cls->free_hits;
+		stats->free_flushes += cls->free_flushes;
+	}
+
+	return 0;
+#else
+	RTE_SET_USED(class_id);
+	RTE_SET_USED(stats);
+	return -1;
+#endif
+}
+
+/*
+ * Return the objects cached by the calling lcore to the heap
+ */
+void
+rte_malloc_cache_flush(void)
+{
+#if RTE_MALLOC_CACHE_SIZE > 0
+	malloc_cache_flush_local();
+#endif
 }
 
 /*
@@ -216,8 +582,14 @@ rte_malloc_get_socket_stats(int socket,
 void
 rte_malloc_dump_stats(FILE *f, __rte_unused const char *type)
 {
-	unsigned int socket;
+	unsigned int socket, class_id;
 	struct rte_malloc_socket_stats sock_stats;
+	struct rte_malloc_class_stats class_stats;
+#if RTE_MALLOC_CACHE_SIZE > 0
+	size_t cached_bytes;
+	unsigned cached_count;
+#endif
+
 	/* Iterate through all initialised heaps */
 	for (socket=0; socket< RTE_MAX_NUMA_NODES; socket++) {
 		if ((rte_malloc_get_socket_stats(socket, &sock_stats) < 0))
@@ -231,6 +603,30 @@ rte_malloc_dump_stats(FILE *f, __rte_unused const char *type)
 				sock_stats.greatest_free_size);
 		fprintf(f, "\tAlloc_count:%u,\n",sock_stats.alloc_count);
 		fprintf(f, "\tFree_count:%u,\n", sock_stats.free_count);
+#if RTE_MALLOC_CACHE_SIZE > 0
+		/* part of the free size above, but not in the free list */
+		malloc_cache_count(&rte_eal_get_configuration()->mem_config->
+				malloc_heaps[socket], &cached_bytes,
+				&cached_count);
+		fprintf(f, "\tCached_size:%zu,\n", cached_bytes);
+		fprintf(f, "\tCached_count:%u,\n", cached_count);
+#endif
+	}
+
+	for (class_id = 0; class_id < RTE_MALLOC_CACHE_NUM_CLASSES;
+			class_id++) {
+		if (rte_malloc_get_class_stats(class_id, &class_stats) < 0)
+			continue;
+
+		fprintf(f, "Cache class:%zu\n", class_stats.size);
+		fprintf(f, "\tCached_count:%u,\n", class_stats.cached_count);
+		fprintf(f, "\tAlloc_hits:%"PRIu64",\n",
+				class_stats.alloc_hits);
+		fprintf(f, "\tAlloc_refills:%"PRIu64",\n",
+				class_stats.alloc_refills);
+		fprintf(f, "\tFree_hits:%"PRIu64",\n", class_stats.free_hits);
+		fprintf(f, "\tFree_flushes:%"PRIu64",\n",
+				class_stats.free_flushes);
 	}
 	return;
 }
@@ -339,6 +339,7 @@ eal_usage(const char *prgname)
 	printf("EAL Linux options:\n"
 	       "  --"OPT_SOCKET_MEM"        Memory to allocate on sockets (comma separated values)\n"
 	       "  --"OPT_HUGE_DIR"          Directory where hugetlbfs is mounted\n"
+	       "  --"OPT_HUGE_FAST_INIT"    Map and clear hugepages from parallel threads\n"
 	       "  --"OPT_FILE_PREFIX"       Prefix for hugepage filenames\n"
 	       "  --"OPT_BASE_VIRTADDR"     Base virtual address\n"
 	       "  --"OPT_CREATE_UIO_DEV"    Create /dev/uioX (usually done by hotplug)\n"
@@ -563,6 +564,10 @@ eal_parse_args(int argc, char **argv)
 			internal_config.hugepage_dir = optarg;
 			break;
 
+		case OPT_HUGE_FAST_INIT_NUM:
+			internal_config.hugepage_fast_init = 1;
+			break;
+
 		case OPT_FILE_PREFIX_NUM:
 			internal_config.hugefile_prefix = optarg;
 			break;
@@ -831,6 +836,9 @@ rte_eal_init(int argc, char **argv)
 	if (rte_eal_timer_init() < 0)
 		rte_panic("Cannot init HPET or TSC timers\n");
 
+	if (internal_config.log_async && rte_log_async_start() < 0)
+		rte_panic("Cannot start asynchronous logs\n");
+
 	eal_check_mem_on_local_socket();
 
 	if (eal_plugins_init() < 0)
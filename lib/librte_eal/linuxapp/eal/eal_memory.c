@@ -82,6 +82,8 @@
 #include <sys/time.h>
 #include <signal.h>
 #include <setjmp.h>
+#include <time.h>
+#include <pthread.h>
 
 #include <rte_log.h>
 #include <rte_memory.h>
@@ -101,6 +103,9 @@
 
 #define PFN_MASK_SIZE	8
 
+/* maximum number of threads mapping hugepages with --huge-fast-init */
+#define HUGEPAGE_INIT_MAX_THREADS 16
+
 #ifdef RTE_LIBRTE_XEN_DOM0
 int rte_xen_dom0_supported(void)
 {
@@ -237,20 +242,47 @@ rte_mem_virt2phy(const void *virtaddr)
 
 /*
  * For each hugepage in hugepg_tbl, fill the physaddr value. We find
- * it by browsing the /proc/self/pagemap special file.
+ * it by browsing the /proc/self/pagemap special file, which is opened
+ * only once for the whole table.
  */
 static int
 find_physaddrs(struct hugepage_file *hugepg_tbl, struct hugepage_info *hpi)
 {
 	unsigned i;
-	phys_addr_t addr;
+	int fd, page_size;
+	uint64_t page;
+	unsigned long virt_pfn;
+	ssize_t retval;
+
+	if (!proc_pagemap_readable)
+		return -1;
+
+	page_size = getpagesize();
+
+	fd = open("/proc/self/pagemap", O_RDONLY);
+	if (fd < 0) {
+		RTE_LOG(ERR, EAL, "%s(): cannot open /proc/self/pagemap: %s\n",
+			__func__, strerror(errno));
+		return -1;
+	}
 
 	for (i = 0; i < hpi->num_pages[0]; i++) {
-		addr = rte_mem_virt2phy(hugepg_tbl[i].orig_va);
-		if (addr == RTE_BAD_PHYS_ADDR)
+		virt_pfn = (unsigned long)hugepg_tbl[i].orig_va / page_size;
+		retval = pread(fd, &page, PFN_MASK_SIZE,
+				sizeof(uint64_t) * virt_pfn);
+		if (retval != PFN_MASK_SIZE) {
+			RTE_LOG(ERR, EAL, "%s(): cannot read /proc/self/pagemap"
+				" at %p\n", __func__, hugepg_tbl[i].orig_va);
+			close(fd);
 			return -1;
-		hugepg_tbl[i].physaddr = addr;
+		}
+
+		/* hugepages are aligned: no offset within the page */
+		hugepg_tbl[i].physaddr =
+			(page & 0x7fffffffffffffULL) * page_size;
 	}
+
+	close(fd);
 	return 0;
 }
 
@@ -343,11 +375,12 @@ get_virtual_area(size_t *size, size_t hugepage_sz)
 	return addr;
 }
 
-static sigjmp_buf huge_jmpenv;
+/* per thread, as hugepages may be faulted from several threads at once */
+static RTE_DEFINE_PER_LCORE(sigjmp_buf, huge_jmpenv);
 
 static void huge_sigbus_handler(int signo __rte_unused)
 {
-	siglongjmp(huge_jmpenv, 1);
+	siglongjmp(RTE_PER_LCORE(huge_jmpenv), 1);
 }
 
 /* Put setjmp into a wrap method to avoid compiling error. Any non-volatile,
@@ -356,7 +389,7 @@ static void huge_sigbus_handler(int signo __rte_unused)
  */
 static int huge_wrap_sigsetjmp(void)
 {
-	return sigsetjmp(huge_jmpenv, 1);
+	return sigsetjmp(RTE_PER_LCORE(huge_jmpenv), 1);
 }
 
 /*
@@ -365,10 +398,12 @@ static int huge_wrap_sigsetjmp(void)
  * virtual address is stored in hugepg_tbl[i].orig_va, else it is stored
  * in hugepg_tbl[i].final_va. The second mapping (when orig is 0) tries to
  * map continguous physical blocks in contiguous virtual blocks.
+ * On the first mapping, the file of hugepg_tbl[i] is numbered
+ * file_id_base + i.
  */
 static unsigned
 map_all_hugepages(struct hugepage_file *hugepg_tbl,
-		struct hugepage_info *hpi, int orig)
+		struct hugepage_info *hpi, unsigned file_id_base, int orig)
 {
 	int fd;
 	unsigned i;
@@ -384,7 +419,7 @@ map_all_hugepages(struct hugepage_file *hugepg_tbl,
 		uint64_t hugepage_sz = hpi->hugepage_sz;
 
 		if (orig) {
-			hugepg_tbl[i].file_id = i;
+			hugepg_tbl[i].file_id = file_id_base + i;
 			hugepg_tbl[i].size = hugepage_sz;
 #ifdef RTE_EAL_SINGLE_FILE_SEGMENTS
 			eal_get_hugefile_temp_path(hugepg_tbl[i].filepath,
@@ -505,6 +540,86 @@ map_all_hugepages(struct hugepage_file *hugepg_tbl,
 	return i;
 }
 
+struct hugepage_map_job {
+	struct hugepage_file *hugepg_tbl; /* first page of the job */
+	struct hugepage_info hpi;         /* number of pages of the job */
+	unsigned file_id_base;
+	unsigned mapped;                  /* number of pages mapped */
+};
+
+static void *
+map_hugepages_thread(void *arg)
+{
+	struct hugepage_map_job *job = arg;
+
+	job->mapped = map_all_hugepages(job->hugepg_tbl, &job->hpi,
+			job->file_id_base, 1);
+	return NULL;
+}
+
+/*
+ * First mapping of all hugepages, split between several threads: the
+ * kernel clears each page when it is first faulted, which is the most
+ * expensive part of the initialization with many hugepages.
+ * Returns the number of pages mapped, which are moved at the start of the
+ * table if some threads could not map all of their pages.
+ */
+static unsigned
+map_all_hugepages_parallel(struct hugepage_file *hugepg_tbl,
+		struct hugepage_info *hpi)
+{
+	struct hugepage_map_job jobs[HUGEPAGE_INIT_MAX_THREADS];
+	pthread_t threads[HUGEPAGE_INIT_MAX_THREADS];
+	int started[HUGEPAGE_INIT_MAX_THREADS];
+	const unsigned num_pages = hpi->num_pages[0];
+	unsigned nb_threads, t, first, count, mapped = 0;
+	long nb_cpus;
+
+	nb_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	nb_threads = RTE_MIN((unsigned)RTE_MAX(nb_cpus, 1L),
+			RTE_MIN(num_pages, (unsigned)HUGEPAGE_INIT_MAX_THREADS));
+	if (nb_threads <= 1)
+		return map_all_hugepages(hugepg_tbl, hpi, 0, 1);
+
+	first = 0;
+	for (t = 0; t < nb_threads; t++) {
+		count = num_pages / nb_threads + (t < num_pages % nb_threads);
+		jobs[t].hugepg_tbl = &hugepg_tbl[first];
+		jobs[t].hpi = *hpi;
+		jobs[t].hpi.num_pages[0] = count;
+		jobs[t].file_id_base = first;
+		jobs[t].mapped = 0;
+		first += count;
+	}
+
+	/* the calling thread takes the first job */
+	for (t = 1; t < nb_threads; t++)
+		started[t] = pthread_create(&threads[t], NULL,
+				map_hugepages_thread, &jobs[t]) == 0;
+	map_hugepages_thread(&jobs[0]);
+	for (t = 1; t < nb_threads; t++) {
+		if (started[t])
+			pthread_join(threads[t], NULL);
+		else
+			map_hugepages_thread(&jobs[t]);
+	}
+
+	/* keep the mapped pages contiguous in the table */
+	for (t = 0; t < nb_threads; t++) {
+		if (jobs[t].hugepg_tbl != &hugepg_tbl[mapped])
+			memmove(&hugepg_tbl[mapped], jobs[t].hugepg_tbl,
+				jobs[t].mapped * sizeof(*hugepg_tbl));
+		mapped += jobs[t].mapped;
+	}
+	memset(&hugepg_tbl[mapped], 0,
+			(num_pages - mapped) * sizeof(*hugepg_tbl));
+
+	RTE_LOG(DEBUG, EAL, "Mapped %u hugepages of %u MB from %u threads\n",
+		mapped, (unsigned)(hpi->hugepage_sz / 0x100000), nb_threads);
+
+	return mapped;
+}
+
 #ifdef RTE_EAL_SINGLE_FILE_SEGMENTS
 
 /*
@@ -683,6 +798,20 @@ unmap_all_hugepages_orig(struct hugepage_file *hugepg_tbl, struct hugepage_info
 }
 #endif /* RTE_EAL_SINGLE_FILE_SEGMENTS */
 
+static int
+cmp_orig_va(const void *a, const void *b)
+{
+	const struct hugepage_file *p1 = *(const struct hugepage_file * const *)a;
+	const struct hugepage_file *p2 = *(const struct hugepage_file * const *)b;
+
+	if (p1->orig_va < p2->orig_va)
+		return -1;
+	else if (p1->orig_va > p2->orig_va)
+		return 1;
+	else
+		return 0;
+}
+
 /*
  * Parse /proc/self/numa_maps to get the NUMA socket ID for each huge
  * page.
@@ -696,6 +825,7 @@ find_numasocket(struct hugepage_file *hugepg_tbl, struct hugepage_info *hpi)
 	uint64_t virt_addr;
 	char buf[BUFSIZ];
 	char hugedir_str[PATH_MAX];
+	struct hugepage_file **by_va, key, *pkey = &key, **found;
 	FILE *f;
 
 	f = fopen("/proc/self/numa_maps", "r");
@@ -705,6 +835,16 @@ find_numasocket(struct hugepage_file *hugepg_tbl, struct hugepage_info *hpi)
 		return 0;
 	}
 
+	/* index the pages by virtual address, to look them up quickly */
+	by_va = malloc(hpi->num_pages[0] * sizeof(*by_va));
+	if (by_va == NULL) {
+		fclose(f);
+		return -1;
+	}
+	for (i = 0; i < hpi->num_pages[0]; i++)
+		by_va[i] = &hugepg_tbl[i];
+	qsort(by_va, hpi->num_pages[0], sizeof(*by_va), cmp_orig_va);
+
 	snprintf(hugedir_str, sizeof(hugedir_str),
 			"%s/%s", hpi->hugedir, internal_config.hugefile_prefix);
 
@@ -745,26 +885,38 @@ find_numasocket(struct hugepage_file *hugepg_tbl, struct hugepage_info *hpi)
 		}
 
 		/* if we find this page in our mappings, set socket_id */
-		for (i = 0; i < hpi->num_pages[0]; i++) {
-			void *va = (void *)(unsigned long)virt_addr;
-			if (hugepg_tbl[i].orig_va == va) {
-				hugepg_tbl[i].socket_id = socket_id;
-				hp_count++;
-			}
+		key.orig_va = (void *)(unsigned long)virt_addr;
+		found = bsearch(&pkey, by_va, hpi->num_pages[0],
+				sizeof(*by_va), cmp_orig_va);
+		if (found != NULL) {
+			(*found)->socket_id = socket_id;
+			hp_count++;
 		}
 	}
 
 	if (hp_count < hpi->num_pages[0])
 		goto error;
 
+	free(by_va);
 	fclose(f);
 	return 0;
 
 error:
+	free(by_va);
 	fclose(f);
 	return -1;
 }
 
+/* Monotonic time in microseconds, to report the duration of init phases */
+static uint64_t
+hugepage_init_time_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
 static int
 cmp_physaddr(const void *a, const void *b)
 {
@@ -1157,6 +1309,7 @@ huge_recover_sigbus(void)
  * Prepare physical memory mapping: fill configuration structure with
  * these infos, return 0 on success.
  *  1. map N huge pages in separate files in hugetlbfs
+ *     (from parallel threads with --huge-fast-init)
  *  2. find associated physical addr
  *  3. find associated NUMA socket ID
  *  4. sort all huge pages by physical address
@@ -1245,6 +1398,7 @@ rte_eal_hugepage_init(void)
 	for (i = 0; i < (int)internal_config.num_hugepage_sizes; i ++){
 		unsigned pages_old, pages_new;
 		struct hugepage_info *hpi;
+		uint64_t t_start, t_map, t_phys, t_numa, t_sort, t_remap;
 
 		/*
 		 * we don't yet mark hugepages as used at this stage, so
@@ -1257,8 +1411,15 @@ rte_eal_hugepage_init(void)
 			continue;
 
 		/* map all hugepages available */
+		t_start = hugepage_init_time_us();
 		pages_old = hpi->num_pages[0];
-		pages_new = map_all_hugepages(&tmp_hp[hp_offset], hpi, 1);
+		if (internal_config.hugepage_fast_init)
+			pages_new = map_all_hugepages_parallel(&tmp_hp[hp_offset],
+					hpi);
+		else
+			pages_new = map_all_hugepages(&tmp_hp[hp_offset], hpi,
+					0, 1);
+		t_map = hugepage_init_time_us();
 		if (pages_new < pages_old) {
 #ifdef RTE_EAL_SINGLE_FILE_SEGMENTS
 			RTE_LOG(ERR, EAL,
@@ -1287,15 +1448,18 @@ rte_eal_hugepage_init(void)
 					(unsigned)(hpi->hugepage_sz / 0x100000));
 			goto fail;
 		}
+		t_phys = hugepage_init_time_us();
 
 		if (find_numasocket(&tmp_hp[hp_offset], hpi) < 0){
 			RTE_LOG(DEBUG, EAL, "Failed to find NUMA socket for %u MB pages\n",
 					(unsigned)(hpi->hugepage_sz / 0x100000));
 			goto fail;
 		}
+		t_numa = hugepage_init_time_us();
 
 		qsort(&tmp_hp[hp_offset], hpi->num_pages[0],
 		      sizeof(struct hugepage_file), cmp_physaddr);
+		t_sort = hugepage_init_time_us();
 
 #ifdef RTE_EAL_SINGLE_FILE_SEGMENTS
 		/* remap all hugepages into single file segments */
@@ -1310,7 +1474,7 @@ rte_eal_hugepage_init(void)
 		hp_offset += new_pages_count[i];
 #else
 		/* remap all hugepages */
-		if (map_all_hugepages(&tmp_hp[hp_offset], hpi, 0) !=
+		if (map_all_hugepages(&tmp_hp[hp_offset], hpi, 0, 0) !=
 		    hpi->num_pages[0]) {
 			RTE_LOG(ERR, EAL, "Failed to remap %u MB pages\n",
 					(unsigned)(hpi->hugepage_sz / 0x100000));
@@ -1324,6 +1488,17 @@ rte_eal_hugepage_init(void)
 		/* we have processed a num of hugepages of this size, so inc offset */
 		hp_offset += hpi->num_pages[0];
 #endif
+		t_remap = hugepage_init_time_us();
+
+		rte_log(internal_config.hugepage_fast_init ?
+				RTE_LOG_INFO : RTE_LOG_DEBUG, RTE_LOGTYPE_EAL,
+			"EAL: %u hugepages of %u MB initialized in %"PRIu64" ms"
+			" (map %"PRIu64", physaddr %"PRIu64", numa %"PRIu64
+			", sort %"PRIu64", remap %"PRIu64")\n",
+			pages_new, (unsigned)(hpi->hugepage_sz / 0x100000),
+			(t_remap - t_start) / 1000, (t_map - t_start) / 1000,
+			(t_phys - t_map) / 1000, (t_numa - t_phys) / 1000,
+			(t_sort - t_numa) / 1000, (t_remap - t_sort) / 1000);
 	}
 
 	huge_recover_sigbus();
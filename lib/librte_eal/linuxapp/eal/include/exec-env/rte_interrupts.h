@@ -51,6 +51,7 @@ enum rte_intr_handle_type {
 	RTE_INTR_HANDLE_VFIO_MSIX,    /**< vfio device handle (MSIX) */
 	RTE_INTR_HANDLE_ALARM,    /**< alarm handle */
 	RTE_INTR_HANDLE_EXT, /**< external handler */
+	RTE_INTR_HANDLE_VDEV,         /**< virtual device */
 	RTE_INTR_HANDLE_MAX
 };
 
@@ -95,6 +96,7 @@ struct rte_intr_handle {
 	struct rte_epoll_event elist[RTE_MAX_RXTX_INTR_VEC_ID];
 				       /**< intr vector epoll event */
 	int *intr_vec;                 /**< intr vector number array */
+	uint8_t efd_counter_size;      /**< size of efd counter, used for vdev */
 };
 
 #define RTE_EPOLL_PER_THREAD        -1  /**< to hint using per thread epfd */
@@ -173,6 +175,9 @@ rte_intr_rx_ctl(struct rte_intr_handle *intr_handle,
  * It enables the packet I/O interrupt event if it's necessary.
  * It creates event fd for each interrupt vector when MSIX is used,
  * otherwise it multiplexes a single event fd.
+ * For a virtual device, the driver sets up the event fds itself, along
+ * with efd_counter_size, the number of bytes to read from an event fd to
+ * clear it (0 when the fd must not be read, like a socket).
  *
  * @param intr_handle
  *   Pointer to the interrupt handle.
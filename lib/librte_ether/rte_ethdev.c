@@ -71,6 +71,10 @@
 
 static const char *MZ_RTE_ETH_DEV_DATA = "rte_eth_dev_data";
 struct rte_eth_dev rte_eth_devices[RTE_MAX_ETHPORTS];
+RTE_TRACE_POINT_DEFINE(rte_eth_trace_rx_burst, "lib.ethdev.rx_burst",
+	"port_id", "queue_id", "nb_pkts", "nb_rx")
+RTE_TRACE_POINT_DEFINE(rte_eth_trace_tx_burst, "lib.ethdev.tx_burst",
+	"port_id", "queue_id", "nb_pkts", "nb_tx")
 static struct rte_eth_dev_data *rte_eth_dev_data;
 static uint8_t nb_ports;
 
@@ -216,6 +220,7 @@ rte_eth_dev_allocate(const char *name, enum rte_eth_dev_type type)
 	eth_dev->data->port_id = port_id;
 	eth_dev->attached = DEV_ATTACHED;
 	eth_dev->dev_type = type;
+	eth_dev->intr_handle = NULL;
 	nb_ports++;
 	return eth_dev;
 }
@@ -273,6 +278,7 @@ rte_eth_dev_init(struct rte_pci_driver *pci_drv,
 			rte_panic("Cannot allocate memzone for private port data\n");
 	}
 	eth_dev->pci_dev = pci_dev;
+	eth_dev->intr_handle = &pci_dev->intr_handle;
 	eth_dev->driver = eth_drv;
 	eth_dev->data->rx_mbuf_alloc_failed = 0;
 
@@ -2720,8 +2726,8 @@ rte_eth_dev_rx_intr_ctl(uint8_t port_id, int epfd, int op, void *data)
 	RTE_ETH_VALID_PORTID_OR_ERR_RET(port_id, -ENODEV);
 
 	dev = &rte_eth_devices[port_id];
-	intr_handle = &dev->pci_dev->intr_handle;
-	if (!intr_handle->intr_vec) {
+	intr_handle = dev->intr_handle;
+	if (intr_handle == NULL || !intr_handle->intr_vec) {
 		RTE_PMD_DEBUG_TRACE("RX Intr vector unset\n");
 		return -EPERM;
 	}
@@ -2780,8 +2786,8 @@ rte_eth_dev_rx_intr_ctl_q(uint8_t port_id, uint16_t queue_id,
 		return -EINVAL;
 	}
 
-	intr_handle = &dev->pci_dev->intr_handle;
-	if (!intr_handle->intr_vec) {
+	intr_handle = dev->intr_handle;
+	if (intr_handle == NULL || !intr_handle->intr_vec) {
 		RTE_PMD_DEBUG_TRACE("RX Intr vector unset\n");
 		return -EPERM;
 	}
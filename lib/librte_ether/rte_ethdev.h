@@ -182,6 +182,7 @@ extern "C" {
 #include <rte_pci.h>
 #include <rte_dev.h>
 #include <rte_devargs.h>
+#include <rte_trace.h>
 #include "rte_ether.h"
 #include "rte_eth_ctrl.h"
 #include "rte_dev_info.h"
@@ -1644,6 +1645,8 @@ struct rte_eth_dev {
 	struct rte_eth_rxtx_callback *pre_tx_burst_cbs[RTE_MAX_QUEUES_PER_PORT];
 	uint8_t attached; /**< Flag indicating the port is attached */
 	enum rte_eth_dev_type dev_type; /**< Flag indicating the device type */
+	/** Interrupt handle of the RX queues, set by the PMD for vdevs */
+	struct rte_intr_handle *intr_handle;
 } __rte_cache_aligned;
 
 struct rte_eth_dev_sriov {
@@ -2582,6 +2585,9 @@ int rte_eth_dev_get_vlan_offload(uint8_t port_id);
  */
 int rte_eth_dev_set_vlan_pvid(uint8_t port_id, uint16_t pvid, int on);
 
+RTE_TRACE_POINT_DECLARE(rte_eth_trace_rx_burst);
+RTE_TRACE_POINT_DECLARE(rte_eth_trace_tx_burst);
+
 /**
  *
  * Retrieve a burst of input packets from a receive queue of an Ethernet
@@ -2694,6 +2700,8 @@ rte_eth_rx_burst(uint8_t port_id, uint16_t queue_id,
 	}
 #endif
 
+	rte_trace_point_emit(&rte_eth_trace_rx_burst, port_id, queue_id,
+			nb_pkts, nb_rx);
 	return nb_rx;
 }
 
@@ -2830,7 +2838,12 @@ rte_eth_tx_burst(uint8_t port_id, uint16_t queue_id,
 	}
 #endif
 
-	return (*dev->tx_pkt_burst)(dev->data->tx_queues[queue_id], tx_pkts, nb_pkts);
+	uint16_t nb_tx = (*dev->tx_pkt_burst)(dev->data->tx_queues[queue_id],
+			tx_pkts, nb_pkts);
+
+	rte_trace_point_emit(&rte_eth_trace_tx_burst, port_id, queue_id,
+			nb_pkts, nb_tx);
+	return nb_tx;
 }
 
 typedef void (*buffer_tx_error_fn)(struct rte_mbuf **unsent, uint16_t count,
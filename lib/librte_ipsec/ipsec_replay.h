@@ -0,0 +1,106 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 Freescale Semiconductor, Inc. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of  Freescale Semiconductor, Inc nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef _IPSEC_REPLAY_H_
+#define _IPSEC_REPLAY_H_
+
+/**
+ * @file
+ * Anti-replay window of ingress SAs (RFC 4303 section 3.4.3), kept as a
+ * ring of 64 bit buckets (RFC 6479).
+ */
+
+#include <errno.h>
+
+#include <rte_common.h>
+
+#include "rte_ipsec.h"
+
+#define REPLAY_BUCKET_SHIFT	6
+#define REPLAY_BUCKET_BITS	(1 << REPLAY_BUCKET_SHIFT)
+
+static inline void
+ipsec_replay_init(struct rte_ipsec_replay *rp, uint32_t win_sz, uint32_t last)
+{
+	rp->win_sz = win_sz;
+	rp->last = last;
+	/*
+	 * a window not aligned on the buckets spans one more bucket than it
+	 * fills, plus one spare bucket so that it never wraps on itself
+	 */
+	rp->bucket_mask = rte_align32pow2((win_sz + REPLAY_BUCKET_BITS - 1) /
+			REPLAY_BUCKET_BITS + 1) - 1;
+}
+
+/* check that seq is inside the window and was not seen yet */
+static inline int
+ipsec_replay_check(const struct rte_ipsec_replay *rp, uint32_t seq)
+{
+	uint32_t b;
+
+	if (seq == 0)
+		return -EINVAL;
+	if (rp->win_sz == 0 || seq > rp->last)
+		return 0;
+	if (rp->last - seq >= rp->win_sz)
+		return -EALREADY;
+
+	b = (seq >> REPLAY_BUCKET_SHIFT) & rp->bucket_mask;
+	if (rp->bucket[b] & (1ULL << (seq & (REPLAY_BUCKET_BITS - 1))))
+		return -EALREADY;
+
+	return 0;
+}
+
+/* record seq, the packet passed ipsec_replay_check() and authentication */
+static inline void
+ipsec_replay_update(struct rte_ipsec_replay *rp, uint32_t seq)
+{
+	uint32_t b, cur, diff, i;
+
+	if (rp->win_sz == 0)
+		return;
+
+	b = seq >> REPLAY_BUCKET_SHIFT;
+	if (seq > rp->last) {
+		/* slide the window: reset the buckets it moves over */
+		cur = rp->last >> REPLAY_BUCKET_SHIFT;
+		diff = RTE_MIN(b - cur, rp->bucket_mask + 1);
+		for (i = 1; i <= diff; i++)
+			rp->bucket[(cur + i) & rp->bucket_mask] = 0;
+		rp->last = seq;
+	}
+
+	rp->bucket[b & rp->bucket_mask] |=
+		1ULL << (seq & (REPLAY_BUCKET_BITS - 1));
+}
+
+#endif /* _IPSEC_REPLAY_H_ */
@@ -0,0 +1,271 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 Freescale Semiconductor, Inc. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of  Freescale Semiconductor, Inc nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef _RTE_IPSEC_H_
+#define _RTE_IPSEC_H_
+
+/**
+ * @file
+ *
+ * RTE IPsec
+ *
+ * Burst oriented ESP data path on top of cryptodev.
+ *
+ * An SA is created from the same xform chain as an IPsec protocol session:
+ * an RTE_CRYPTO_SYM_XFORM_IPSEC xform followed by the cipher and auth
+ * xforms in ESP order. It is bound to one queue pair of one crypto device.
+ * When the device advertises RTE_CRYPTODEV_FF_IPSEC_PROTO_OFFLOAD and
+ * accepts the SA, the whole transform is left to the device. Otherwise the
+ * library builds and strips the ESP encapsulation itself and only the
+ * cipher and auth work goes to the device (lookaside).
+ *
+ * Packets are single segment mbufs whose data starts at the IP header.
+ * For a burst of packets:
+ *
+ * - group consecutive packets by SA with rte_ipsec_sa_group(),
+ * - for each group, rte_ipsec_crypto_prepare() the crypto operations and
+ *   submit them with rte_ipsec_crypto_enqueue(),
+ * - group the operations dequeued from the device with
+ *   rte_ipsec_crypto_group(),
+ * - for each group, rte_ipsec_process() finalizes the packets.
+ *
+ * An SA keeps its sequence number and anti-replay state without any
+ * locking, so it must only be used by one lcore at a time.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include <rte_common.h>
+#include <rte_mbuf.h>
+#include <rte_crypto.h>
+#include <rte_cryptodev.h>
+
+/** Largest anti-replay window of a lookaside SA, in packets */
+#define RTE_IPSEC_MAX_REPLAY_WIN_SZ	1024
+
+/** Number of 64 bit buckets of the anti-replay window */
+#define RTE_IPSEC_REPLAY_NB_BUCKETS	32
+
+/** Largest outer header of a tunnel SA (IPv6 header) */
+#define RTE_IPSEC_MAX_HDR_LEN		40
+
+/** Never use IPsec protocol offload for the SA */
+#define RTE_IPSEC_SA_F_LOOKASIDE	(1 << 0)
+
+/** Per SA statistics */
+struct rte_ipsec_sa_stats {
+	uint64_t pkts;		/**< Packets successfully processed */
+	uint64_t bytes;		/**< Bytes of the processed packets */
+	uint64_t auth_failed;	/**< Ingress packets with a bad ICV */
+	uint64_t replayed;	/**< Ingress packets dropped by anti-replay */
+	uint64_t errors;	/**< Malformed packets and crypto errors */
+};
+
+/**
+ * Anti-replay window.
+ *
+ * The window is kept as a ring of 64 bit buckets, as described in
+ * RFC 6479: sliding it forward clears whole buckets instead of shifting a
+ * bitmap, so the cost of a check or an update does not depend on the
+ * window size.
+ */
+struct rte_ipsec_replay {
+	uint32_t last;		/**< Highest sequence number accepted */
+	uint32_t win_sz;	/**< Window size in packets, 0 if disabled */
+	uint32_t bucket_mask;	/**< Number of buckets in use minus one */
+	uint64_t bucket[RTE_IPSEC_REPLAY_NB_BUCKETS];
+};
+
+/** IPsec Security Association */
+struct rte_ipsec_sa {
+	uint32_t spi;			/**< SPI, network byte order */
+	uint32_t seq;			/**< Last egress sequence number */
+	uint8_t direction;		/**< rte_crypto_ipsec_direction */
+	uint8_t mode;			/**< rte_crypto_ipsec_mode */
+	uint8_t proto_offload;		/**< Device does the ESP transform */
+	uint8_t dev_id;			/**< Crypto device */
+	uint16_t qp_id;			/**< Queue pair of the crypto device */
+	uint16_t iv_len;		/**< IV length in bytes */
+	uint16_t block_size;		/**< Cipher text alignment */
+	uint16_t digest_len;		/**< ICV length in bytes */
+	uint16_t hdr_len;		/**< Outer header length (tunnel) */
+	uint16_t pad;
+	struct rte_cryptodev_sym_session *session;
+	struct rte_ipsec_sa_stats stats;
+	uint8_t hdr[RTE_IPSEC_MAX_HDR_LEN];	/**< Outer header template */
+	struct rte_ipsec_replay replay __rte_cache_aligned;
+} __rte_cache_aligned;
+
+/** Consecutive packets, or crypto operations, of one SA */
+struct rte_ipsec_group {
+	struct rte_ipsec_sa *sa;	/**< SA of the group */
+	struct rte_mbuf **mb;		/**< First packet of the group */
+	struct rte_crypto_op **cop;	/**< First operation of the group */
+	uint16_t cnt;			/**< Number of packets in the group */
+};
+
+/**
+ * Create an SA and its crypto session.
+ *
+ * @param xform
+ *   IPsec xform, followed by the cipher and auth xforms in ESP order:
+ *   cipher then auth (generate) for egress, auth (verify) then cipher for
+ *   ingress. AES-CBC, 3DES-CBC and NULL ciphers are supported.
+ * @param dev_id
+ *   Crypto device processing the SA.
+ * @param qp_id
+ *   Queue pair of the device the operations of the SA are enqueued to.
+ * @param flags
+ *   RTE_IPSEC_SA_F_* flags.
+ * @param socket_id
+ *   Socket to allocate the SA on.
+ * @return
+ *   The SA, or NULL with rte_errno set on error.
+ */
+struct rte_ipsec_sa *
+rte_ipsec_sa_create(struct rte_crypto_sym_xform *xform, uint8_t dev_id,
+		uint16_t qp_id, uint32_t flags, int socket_id);
+
+/**
+ * Free an SA and its crypto session.
+ *
+ * @param sa
+ *   SA to free, no operation of the SA may be in flight.
+ */
+void
+rte_ipsec_sa_free(struct rte_ipsec_sa *sa);
+
+/**
+ * Split a burst of packets into groups of consecutive packets of the same
+ * SA. The order of the packets is kept.
+ *
+ * @param sa
+ *   SA of each packet.
+ * @param mb
+ *   Packets.
+ * @param grp
+ *   Groups filled by the function, at least @p num entries.
+ * @param num
+ *   Number of packets.
+ * @return
+ *   Number of groups.
+ */
+uint16_t
+rte_ipsec_sa_group(struct rte_ipsec_sa *sa[], struct rte_mbuf *mb[],
+		struct rte_ipsec_group grp[], uint16_t num);
+
+/**
+ * Prepare the crypto operations of packets of one SA.
+ *
+ * Egress packets get consecutive sequence numbers, reserved for the whole
+ * burst at once. Ingress packets are checked against the SPI and the
+ * anti-replay window of the SA.
+ *
+ * @param sa
+ *   SA of the packets.
+ * @param mb
+ *   Packets, reordered so that the packets that could not be prepared are
+ *   moved after the prepared ones.
+ * @param cop
+ *   Crypto operations to fill, one per packet.
+ * @param num
+ *   Number of packets.
+ * @return
+ *   Number of prepared packets. The first ones of @p cop are ready for
+ *   rte_ipsec_crypto_enqueue().
+ */
+uint16_t
+rte_ipsec_crypto_prepare(struct rte_ipsec_sa *sa, struct rte_mbuf *mb[],
+		struct rte_crypto_op *cop[], uint16_t num);
+
+/**
+ * Enqueue crypto operations of an SA to its queue pair.
+ *
+ * @return
+ *   Number of operations enqueued.
+ */
+static inline uint16_t
+rte_ipsec_crypto_enqueue(struct rte_ipsec_sa *sa, struct rte_crypto_op *cop[],
+		uint16_t num)
+{
+	return rte_cryptodev_enqueue_burst(sa->dev_id, sa->qp_id, cop, num);
+}
+
+/**
+ * Split crypto operations dequeued from a device into groups of
+ * consecutive operations of the same SA, and retrieve their packets.
+ *
+ * @param cop
+ *   Operations prepared by rte_ipsec_crypto_prepare().
+ * @param mb
+ *   Filled with the packet of each operation.
+ * @param grp
+ *   Groups filled by the function, at least @p num entries.
+ * @param num
+ *   Number of operations.
+ * @return
+ *   Number of groups.
+ */
+uint16_t
+rte_ipsec_crypto_group(struct rte_crypto_op *cop[], struct rte_mbuf *mb[],
+		struct rte_ipsec_group grp[], uint16_t num);
+
+/**
+ * Finalize packets of one SA once their crypto operations completed.
+ *
+ * Ingress packets are decapsulated, and the anti-replay window is updated.
+ * The operations are not freed.
+ *
+ * @param sa
+ *   SA of the packets.
+ * @param cop
+ *   Completed operations, reordered like @p mb.
+ * @param mb
+ *   Packets, reordered so that the failed packets are moved after the
+ *   successful ones.
+ * @param num
+ *   Number of packets.
+ * @return
+ *   Number of successful packets.
+ */
+uint16_t
+rte_ipsec_process(struct rte_ipsec_sa *sa, struct rte_crypto_op *cop[],
+		struct rte_mbuf *mb[], uint16_t num);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_IPSEC_H_ */
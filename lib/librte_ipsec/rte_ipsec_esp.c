@@ -0,0 +1,379 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 Freescale Semiconductor, Inc. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of  Freescale Semiconductor, Inc nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <errno.h>
+#include <netinet/in.h>
+
+#include <rte_common.h>
+#include <rte_branch_prediction.h>
+#include <rte_byteorder.h>
+#include <rte_random.h>
+#include <rte_memcpy.h>
+#include <rte_mbuf.h>
+#include <rte_ip.h>
+
+#include "rte_ipsec.h"
+#include "ipsec_replay.h"
+
+struct esp_hdr {
+	uint32_t spi;
+	uint32_t seq;
+} __attribute__((__packed__));
+
+/* pad length and next header */
+#define ESP_TRAILER_LEN	2
+
+/* length and upper protocol of the IP header at the start of a packet */
+static inline uint32_t
+ip_hdr_len(const uint8_t *ip, uint32_t len, uint8_t *proto)
+{
+	const struct ipv4_hdr *ip4;
+	const struct ipv6_hdr *ip6;
+	uint32_t hlen;
+
+	if (len >= sizeof(*ip4) && (ip[0] >> 4) == 4) {
+		ip4 = (const struct ipv4_hdr *)ip;
+		hlen = (ip4->version_ihl & IPV4_HDR_IHL_MASK) *
+				IPV4_IHL_MULTIPLIER;
+		if (hlen < sizeof(*ip4) || hlen > len)
+			return 0;
+		*proto = ip4->next_proto_id;
+		return hlen;
+	}
+
+	if (len >= sizeof(*ip6) && (ip[0] >> 4) == 6) {
+		ip6 = (const struct ipv6_hdr *)ip;
+		*proto = ip6->proto;
+		return sizeof(*ip6);
+	}
+
+	return 0;
+}
+
+static inline void
+ip_hdr_update(uint8_t *ip, uint32_t len, uint8_t proto)
+{
+	struct ipv4_hdr *ip4;
+	struct ipv6_hdr *ip6;
+
+	if ((ip[0] >> 4) == 4) {
+		ip4 = (struct ipv4_hdr *)ip;
+		ip4->next_proto_id = proto;
+		ip4->total_length = rte_cpu_to_be_16(len);
+		ip4->hdr_checksum = 0;
+		ip4->hdr_checksum = rte_ipv4_cksum(ip4);
+	} else {
+		ip6 = (struct ipv6_hdr *)ip;
+		ip6->proto = proto;
+		ip6->payload_len = rte_cpu_to_be_16(len - sizeof(*ip6));
+	}
+}
+
+static inline void
+esp_fill_sym_op(struct rte_crypto_sym_op *sym, struct rte_ipsec_sa *sa,
+		struct rte_mbuf *m, uint32_t esp_off, uint32_t clen)
+{
+	uint32_t iv_off = esp_off + sizeof(struct esp_hdr);
+	uint32_t icv_off = iv_off + sa->iv_len + clen;
+
+	sym->m_src = m;
+	sym->m_dst = NULL;
+
+	sym->cipher.data.offset = iv_off + sa->iv_len;
+	sym->cipher.data.length = clen;
+	sym->cipher.iv.data = rte_pktmbuf_mtod_offset(m, uint8_t *, iv_off);
+	sym->cipher.iv.phys_addr = rte_pktmbuf_mtophys_offset(m, iv_off);
+	sym->cipher.iv.length = sa->iv_len;
+
+	sym->auth.data.offset = esp_off;
+	sym->auth.data.length = icv_off - esp_off;
+	sym->auth.digest.data = rte_pktmbuf_mtod_offset(m, uint8_t *, icv_off);
+	sym->auth.digest.phys_addr = rte_pktmbuf_mtophys_offset(m, icv_off);
+	sym->auth.digest.length = sa->digest_len;
+}
+
+static inline int
+esp_outbound_prepare(struct rte_ipsec_sa *sa, struct rte_mbuf *m,
+		struct rte_crypto_op *cop, uint32_t seq)
+{
+	struct esp_hdr *esp;
+	uint8_t *ip, *iv, *pad;
+	uint32_t l3_len, plen, clen, pad_len, hlen, esp_off, i;
+	uint64_t rnd;
+	uint8_t next_proto;
+
+	if (unlikely(m->nb_segs != 1))
+		return -EINVAL;
+
+	ip = rte_pktmbuf_mtod(m, uint8_t *);
+	if (sa->mode == RTE_CRYPTO_IPSEC_MODE_TUNNEL) {
+		if ((ip[0] >> 4) == 4)
+			next_proto = IPPROTO_IPIP;
+		else if ((ip[0] >> 4) == 6)
+			next_proto = IPPROTO_IPV6;
+		else
+			return -EINVAL;
+		l3_len = 0;
+		hlen = sa->hdr_len;
+	} else {
+		l3_len = ip_hdr_len(ip, m->data_len, &next_proto);
+		if (unlikely(l3_len == 0))
+			return -EINVAL;
+		hlen = 0;
+	}
+
+	plen = m->data_len - l3_len;
+	clen = RTE_ALIGN_CEIL(plen + ESP_TRAILER_LEN, sa->block_size);
+	pad_len = clen - plen - ESP_TRAILER_LEN;
+	hlen += sizeof(*esp) + sa->iv_len;
+
+	pad = (uint8_t *)rte_pktmbuf_append(m, clen - plen + sa->digest_len);
+	if (unlikely(pad == NULL))
+		return -ENOSPC;
+	ip = (uint8_t *)rte_pktmbuf_prepend(m, hlen);
+	if (unlikely(ip == NULL)) {
+		rte_pktmbuf_trim(m, clen - plen + sa->digest_len);
+		return -ENOSPC;
+	}
+
+	if (sa->mode == RTE_CRYPTO_IPSEC_MODE_TUNNEL) {
+		rte_memcpy(ip, sa->hdr, sa->hdr_len);
+		esp_off = sa->hdr_len;
+	} else {
+		memmove(ip, ip + hlen, l3_len);
+		esp_off = l3_len;
+	}
+	ip_hdr_update(ip, m->data_len, IPPROTO_ESP);
+
+	esp = (struct esp_hdr *)(ip + esp_off);
+	esp->spi = sa->spi;
+	esp->seq = rte_cpu_to_be_32(seq);
+
+	iv = (uint8_t *)(esp + 1);
+	for (i = 0; i < sa->iv_len; i += sizeof(rnd)) {
+		rnd = rte_rand();
+		memcpy(iv + i, &rnd, sizeof(rnd));
+	}
+
+	for (i = 0; i != pad_len; i++)
+		pad[i] = i + 1;
+	pad[pad_len] = pad_len;
+	pad[pad_len + 1] = next_proto;
+
+	esp_fill_sym_op(cop->sym, sa, m, esp_off, clen);
+
+	return 0;
+}
+
+static inline int
+esp_inbound_prepare(struct rte_ipsec_sa *sa, struct rte_mbuf *m,
+		struct rte_crypto_op *cop)
+{
+	const struct esp_hdr *esp;
+	uint8_t *ip;
+	uint32_t l3_len, hlen, clen;
+	uint8_t proto;
+	int ret;
+
+	if (unlikely(m->nb_segs != 1))
+		return -EINVAL;
+
+	ip = rte_pktmbuf_mtod(m, uint8_t *);
+	l3_len = ip_hdr_len(ip, m->data_len, &proto);
+	if (unlikely(l3_len == 0 || proto != IPPROTO_ESP))
+		return -EINVAL;
+
+	hlen = l3_len + sizeof(*esp) + sa->iv_len;
+	if (unlikely(m->data_len < hlen + sa->block_size + sa->digest_len))
+		return -EINVAL;
+	clen = m->data_len - hlen - sa->digest_len;
+	if (unlikely(clen % sa->block_size != 0))
+		return -EINVAL;
+
+	esp = (const struct esp_hdr *)(ip + l3_len);
+	if (unlikely(esp->spi != sa->spi))
+		return -EINVAL;
+
+	/* early check, the window is only updated once authenticated */
+	ret = ipsec_replay_check(&sa->replay, rte_be_to_cpu_32(esp->seq));
+	if (unlikely(ret != 0))
+		return ret;
+
+	esp_fill_sym_op(cop->sym, sa, m, l3_len, clen);
+
+	return 0;
+}
+
+static inline int
+esp_inbound_process(struct rte_ipsec_sa *sa, struct rte_mbuf *m)
+{
+	const struct esp_hdr *esp;
+	const uint8_t *tail, *pad;
+	uint8_t *ip;
+	uint32_t l3_len, hlen, tlen, seq, i;
+	uint8_t proto, pad_len, next_proto;
+	int ret;
+
+	ip = rte_pktmbuf_mtod(m, uint8_t *);
+	l3_len = ip_hdr_len(ip, m->data_len, &proto);
+	esp = (const struct esp_hdr *)(ip + l3_len);
+	hlen = sizeof(*esp) + sa->iv_len;
+
+	/* packets of a burst may share a sequence number */
+	seq = rte_be_to_cpu_32(esp->seq);
+	ret = ipsec_replay_check(&sa->replay, seq);
+	if (unlikely(ret != 0))
+		return ret;
+
+	tail = ip + m->data_len - sa->digest_len - ESP_TRAILER_LEN;
+	pad_len = tail[0];
+	next_proto = tail[1];
+	tlen = pad_len + ESP_TRAILER_LEN + sa->digest_len;
+	if (unlikely(tlen > m->data_len - l3_len - hlen))
+		return -EINVAL;
+	pad = tail - pad_len;
+	for (i = 0; i != pad_len; i++)
+		if (unlikely(pad[i] != i + 1))
+			return -EINVAL;
+
+	ipsec_replay_update(&sa->replay, seq);
+
+	rte_pktmbuf_trim(m, tlen);
+	if (sa->mode == RTE_CRYPTO_IPSEC_MODE_TUNNEL)
+		rte_pktmbuf_adj(m, l3_len + hlen);
+	else {
+		memmove(ip + hlen, ip, l3_len);
+		ip = (uint8_t *)rte_pktmbuf_adj(m, hlen);
+		ip_hdr_update(ip, m->data_len, next_proto);
+	}
+
+	return 0;
+}
+
+uint16_t
+rte_ipsec_crypto_prepare(struct rte_ipsec_sa *sa, struct rte_mbuf *mb[],
+		struct rte_crypto_op *cop[], uint16_t num)
+{
+	struct rte_mbuf *dr[num];
+	uint32_t i, k, n, seq;
+	int ret;
+
+	n = num;
+	seq = 0;
+	if (sa->direction == RTE_CRYPTO_IPSEC_DIR_EGRESS &&
+			!sa->proto_offload) {
+		/* reserve the sequence numbers of the whole burst */
+		n = RTE_MIN(n, UINT32_MAX - sa->seq);
+		seq = sa->seq;
+		sa->seq += n;
+	}
+
+	for (i = 0, k = 0; i != n; i++) {
+		if (sa->proto_offload) {
+			cop[k]->sym->m_src = mb[i];
+			cop[k]->sym->m_dst = NULL;
+			ret = 0;
+		} else if (sa->direction == RTE_CRYPTO_IPSEC_DIR_EGRESS)
+			ret = esp_outbound_prepare(sa, mb[i], cop[k], ++seq);
+		else
+			ret = esp_inbound_prepare(sa, mb[i], cop[k]);
+
+		if (likely(ret == 0)) {
+			rte_crypto_op_attach_sym_session(cop[k], sa->session);
+			cop[k]->opaque_data = sa;
+			mb[k++] = mb[i];
+		} else {
+			if (ret == -EALREADY)
+				sa->stats.replayed++;
+			else
+				sa->stats.errors++;
+			dr[i - k] = mb[i];
+		}
+	}
+
+	/* sequence number space exhausted */
+	for (; i != num; i++) {
+		sa->stats.errors++;
+		dr[i - k] = mb[i];
+	}
+
+	if (k != num)
+		memcpy(mb + k, dr, (num - k) * sizeof(dr[0]));
+
+	return k;
+}
+
+uint16_t
+rte_ipsec_process(struct rte_ipsec_sa *sa, struct rte_crypto_op *cop[],
+		struct rte_mbuf *mb[], uint16_t num)
+{
+	struct rte_mbuf *dr[num];
+	struct rte_crypto_op *dc[num];
+	uint32_t i, k;
+	int ret;
+
+	for (i = 0, k = 0; i != num; i++) {
+		if (unlikely(cop[i]->status != RTE_CRYPTO_OP_STATUS_SUCCESS))
+			ret = (cop[i]->status ==
+				RTE_CRYPTO_OP_STATUS_AUTH_FAILED) ?
+				-EBADMSG : -EIO;
+		else if (sa->proto_offload ||
+				sa->direction == RTE_CRYPTO_IPSEC_DIR_EGRESS)
+			ret = 0;
+		else
+			ret = esp_inbound_process(sa, mb[i]);
+
+		if (likely(ret == 0)) {
+			sa->stats.pkts++;
+			sa->stats.bytes += mb[i]->pkt_len;
+			cop[k] = cop[i];
+			mb[k++] = mb[i];
+		} else {
+			if (ret == -EBADMSG)
+				sa->stats.auth_failed++;
+			else if (ret == -EALREADY)
+				sa->stats.replayed++;
+			else
+				sa->stats.errors++;
+			dc[i - k] = cop[i];
+			dr[i - k] = mb[i];
+		}
+	}
+
+	if (k != num) {
+		memcpy(mb + k, dr, (num - k) * sizeof(dr[0]));
+		memcpy(cop + k, dc, (num - k) * sizeof(dc[0]));
+	}
+
+	return k;
+}
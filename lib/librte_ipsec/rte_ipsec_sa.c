@@ -0,0 +1,276 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 Freescale Semiconductor, Inc. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of  Freescale Semiconductor, Inc nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <errno.h>
+#include <netinet/in.h>
+
+#include <rte_common.h>
+#include <rte_errno.h>
+#include <rte_malloc.h>
+#include <rte_byteorder.h>
+#include <rte_ip.h>
+
+#include "rte_ipsec.h"
+#include "ipsec_replay.h"
+
+#define IPSEC_DEF_TTL	64
+
+static int
+sa_set_crypto_params(struct rte_ipsec_sa *sa,
+		const struct rte_crypto_sym_xform *cipher,
+		const struct rte_crypto_sym_xform *auth)
+{
+	switch (cipher->cipher.algo) {
+	case RTE_CRYPTO_CIPHER_AES_CBC:
+		sa->iv_len = 16;
+		sa->block_size = 16;
+		break;
+	case RTE_CRYPTO_CIPHER_3DES_CBC:
+		sa->iv_len = 8;
+		sa->block_size = 8;
+		break;
+	case RTE_CRYPTO_CIPHER_NULL:
+		sa->iv_len = 0;
+		/* the ESP trailer is always 4 bytes aligned */
+		sa->block_size = 4;
+		break;
+	default:
+		return -ENOTSUP;
+	}
+
+	switch (auth->auth.algo) {
+	case RTE_CRYPTO_AUTH_MD5_HMAC:
+	case RTE_CRYPTO_AUTH_SHA1_HMAC:
+	case RTE_CRYPTO_AUTH_SHA256_HMAC:
+	case RTE_CRYPTO_AUTH_SHA384_HMAC:
+	case RTE_CRYPTO_AUTH_SHA512_HMAC:
+		sa->digest_len = auth->auth.digest_length;
+		break;
+	case RTE_CRYPTO_AUTH_NULL:
+		sa->digest_len = 0;
+		break;
+	default:
+		return -ENOTSUP;
+	}
+
+	return 0;
+}
+
+static void
+sa_set_tunnel_hdr(struct rte_ipsec_sa *sa,
+		const struct rte_crypto_ipsec_xform *ipsec)
+{
+	struct ipv4_hdr *ip4;
+	struct ipv6_hdr *ip6;
+
+	if (ipsec->tunnel.type == RTE_CRYPTO_IPSEC_TUNNEL_IPV4) {
+		ip4 = (struct ipv4_hdr *)sa->hdr;
+		ip4->version_ihl = 0x45;
+		ip4->time_to_live = ipsec->tunnel.ipv4.ttl ?
+				ipsec->tunnel.ipv4.ttl : IPSEC_DEF_TTL;
+		ip4->next_proto_id = IPPROTO_ESP;
+		ip4->src_addr = ipsec->tunnel.ipv4.src_addr;
+		ip4->dst_addr = ipsec->tunnel.ipv4.dst_addr;
+		sa->hdr_len = sizeof(*ip4);
+	} else {
+		ip6 = (struct ipv6_hdr *)sa->hdr;
+		ip6->vtc_flow = rte_cpu_to_be_32(6 << 28);
+		ip6->proto = IPPROTO_ESP;
+		ip6->hop_limits = ipsec->tunnel.ipv6.hlimit ?
+				ipsec->tunnel.ipv6.hlimit : IPSEC_DEF_TTL;
+		memcpy(ip6->src_addr, ipsec->tunnel.ipv6.src_addr,
+				sizeof(ip6->src_addr));
+		memcpy(ip6->dst_addr, ipsec->tunnel.ipv6.dst_addr,
+				sizeof(ip6->dst_addr));
+		sa->hdr_len = sizeof(*ip6);
+	}
+}
+
+static int
+sa_create_session(struct rte_ipsec_sa *sa, struct rte_crypto_sym_xform *xform,
+		uint32_t flags)
+{
+	struct rte_cryptodev_info info;
+
+	rte_cryptodev_info_get(sa->dev_id, &info);
+	if (sa->qp_id >= info.max_nb_queue_pairs)
+		return -EINVAL;
+
+	if (!(flags & RTE_IPSEC_SA_F_LOOKASIDE) &&
+			(info.feature_flags &
+				RTE_CRYPTODEV_FF_IPSEC_PROTO_OFFLOAD) &&
+			xform->ipsec.replay_win_sz <=
+				RTE_CRYPTO_IPSEC_MAX_REPLAY_WIN_SZ) {
+		sa->session = rte_cryptodev_sym_session_create(sa->dev_id,
+				xform);
+		if (sa->session != NULL) {
+			sa->proto_offload = 1;
+			return 0;
+		}
+	}
+
+	/* lookaside: the device only sees the cipher/auth chain */
+	sa->session = rte_cryptodev_sym_session_create(sa->dev_id,
+			xform->next);
+
+	return (sa->session == NULL) ? -ENOTSUP : 0;
+}
+
+struct rte_ipsec_sa *
+rte_ipsec_sa_create(struct rte_crypto_sym_xform *xform, uint8_t dev_id,
+		uint16_t qp_id, uint32_t flags, int socket_id)
+{
+	const struct rte_crypto_ipsec_xform *ipsec;
+	const struct rte_crypto_sym_xform *cipher, *auth;
+	struct rte_ipsec_sa *sa;
+	int ret;
+
+	if (xform == NULL || xform->type != RTE_CRYPTO_SYM_XFORM_IPSEC ||
+			xform->next == NULL || xform->next->next == NULL ||
+			xform->next->next->next != NULL ||
+			dev_id >= rte_cryptodev_count()) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	ipsec = &xform->ipsec;
+	if (ipsec->direction == RTE_CRYPTO_IPSEC_DIR_EGRESS) {
+		cipher = xform->next;
+		auth = cipher->next;
+		ret = cipher->type == RTE_CRYPTO_SYM_XFORM_CIPHER &&
+			cipher->cipher.op == RTE_CRYPTO_CIPHER_OP_ENCRYPT &&
+			auth->type == RTE_CRYPTO_SYM_XFORM_AUTH &&
+			auth->auth.op == RTE_CRYPTO_AUTH_OP_GENERATE;
+	} else {
+		auth = xform->next;
+		cipher = auth->next;
+		ret = auth->type == RTE_CRYPTO_SYM_XFORM_AUTH &&
+			auth->auth.op == RTE_CRYPTO_AUTH_OP_VERIFY &&
+			cipher->type == RTE_CRYPTO_SYM_XFORM_CIPHER &&
+			cipher->cipher.op == RTE_CRYPTO_CIPHER_OP_DECRYPT;
+	}
+	if (!ret || ipsec->proto != RTE_CRYPTO_IPSEC_PROTO_ESP ||
+			ipsec->replay_win_sz > RTE_IPSEC_MAX_REPLAY_WIN_SZ) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	sa = rte_zmalloc_socket("IPSEC_SA", sizeof(*sa), RTE_CACHE_LINE_SIZE,
+			socket_id);
+	if (sa == NULL) {
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
+	ret = sa_set_crypto_params(sa, cipher, auth);
+	if (ret != 0)
+		goto error;
+
+	sa->spi = rte_cpu_to_be_32(ipsec->spi);
+	sa->direction = ipsec->direction;
+	sa->mode = ipsec->mode;
+	sa->dev_id = dev_id;
+	sa->qp_id = qp_id;
+
+	if (sa->direction == RTE_CRYPTO_IPSEC_DIR_EGRESS) {
+		sa->seq = ipsec->seq;
+		if (sa->mode == RTE_CRYPTO_IPSEC_MODE_TUNNEL)
+			sa_set_tunnel_hdr(sa, ipsec);
+	} else
+		ipsec_replay_init(&sa->replay, ipsec->replay_win_sz,
+				ipsec->seq);
+
+	ret = sa_create_session(sa, xform, flags);
+	if (ret != 0)
+		goto error;
+
+	return sa;
+
+error:
+	rte_free(sa);
+	rte_errno = -ret;
+	return NULL;
+}
+
+void
+rte_ipsec_sa_free(struct rte_ipsec_sa *sa)
+{
+	if (sa == NULL)
+		return;
+
+	rte_cryptodev_sym_session_free(sa->dev_id, sa->session);
+	rte_free(sa);
+}
+
+uint16_t
+rte_ipsec_sa_group(struct rte_ipsec_sa *sa[], struct rte_mbuf *mb[],
+		struct rte_ipsec_group grp[], uint16_t num)
+{
+	uint32_t i, n;
+
+	for (i = 0, n = 0; i != num; i++) {
+		if (n == 0 || grp[n - 1].sa != sa[i]) {
+			grp[n].sa = sa[i];
+			grp[n].mb = mb + i;
+			grp[n].cop = NULL;
+			grp[n].cnt = 0;
+			n++;
+		}
+		grp[n - 1].cnt++;
+	}
+
+	return n;
+}
+
+uint16_t
+rte_ipsec_crypto_group(struct rte_crypto_op *cop[], struct rte_mbuf *mb[],
+		struct rte_ipsec_group grp[], uint16_t num)
+{
+	struct rte_ipsec_sa *sa;
+	uint32_t i, n;
+
+	for (i = 0, n = 0; i != num; i++) {
+		sa = cop[i]->opaque_data;
+		mb[i] = cop[i]->sym->m_src;
+		if (n == 0 || grp[n - 1].sa != sa) {
+			grp[n].sa = sa;
+			grp[n].mb = mb + i;
+			grp[n].cop = cop + i;
+			grp[n].cnt = 0;
+			n++;
+		}
+		grp[n - 1].cnt++;
+	}
+
+	return n;
+}
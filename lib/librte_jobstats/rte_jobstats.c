@@ -42,6 +42,10 @@
 #include <rte_cycles.h>
 #include <rte_branch_prediction.h>
 
+#ifdef RTE_LIBRTE_PMU
+#include <rte_pmu.h>
+#endif
+
 #include "rte_jobstats.h"
 
 #define ADD_TIME_MIN_MAX(obj, type, value) do {      \
@@ -53,6 +57,41 @@
 		(obj)->max_ ## type ## _time = tmp;          \
 } while (0)
 
+#ifdef RTE_LIBRTE_PMU
+static inline void
+pmu_job_start(struct rte_jobstats_context *ctx)
+{
+	struct rte_pmu_values v;
+
+	if (likely(!ctx->pmu_enabled))
+		return;
+
+	rte_pmu_read(&v);
+	memcpy(ctx->pmu_state, v.val, sizeof(ctx->pmu_state));
+}
+
+static inline void
+pmu_job_finish(struct rte_jobstats_context *ctx, struct rte_jobstats *job)
+{
+	struct rte_pmu_values v;
+	uint64_t delta;
+	unsigned i;
+
+	if (likely(!ctx->pmu_enabled))
+		return;
+
+	rte_pmu_read(&v);
+	for (i = 0; i < RTE_JOBSTATS_PMU_EVENTS; i++) {
+		delta = v.val[i] - ctx->pmu_state[i];
+		job->pmu_exec[i] += delta;
+		ctx->pmu_exec[i] += delta;
+	}
+}
+#else
+#define pmu_job_start(ctx) do { } while (0)
+#define pmu_job_finish(ctx, job) do { } while (0)
+#endif
+
 #define RESET_TIME_MIN_MAX(obj, type) do {           \
 	(obj)->type ## _time = 0;                        \
 	(obj)->min_ ## type ## _time = UINT64_MAX;       \
@@ -142,6 +181,36 @@ rte_jobstats_context_reset(struct rte_jobstats_context *ctx)
 	ctx->state_time = ctx->start_time;
 	ctx->job_exec_cnt = 0;
 	ctx->loop_cnt = 0;
+	memset(ctx->pmu_exec, 0, sizeof(ctx->pmu_exec));
+}
+
+int
+rte_jobstats_context_pmu_enable(struct rte_jobstats_context *ctx,
+		uint64_t events)
+{
+#ifdef RTE_LIBRTE_PMU
+	int ret;
+
+	RTE_BUILD_BUG_ON(RTE_JOBSTATS_PMU_EVENTS != RTE_PMU_EVENT_MAX);
+
+	if (ctx == NULL)
+		return -EINVAL;
+
+	/* Counters may already be open by the application on this lcore. */
+	ret = rte_pmu_open(events);
+	if (ret < 0 && ret != -EBUSY)
+		return ret;
+
+	ctx->pmu_enabled = 1;
+	return 0;
+#else
+	RTE_SET_USED(events);
+
+	if (ctx == NULL)
+		return -EINVAL;
+
+	return -ENOTSUP;
+#endif
 }
 
 void
@@ -166,6 +235,8 @@ rte_jobstats_start(struct rte_jobstats_context *ctx, struct rte_jobstats *job)
 	ADD_TIME_MIN_MAX(ctx, management, now - ctx->state_time);
 	ctx->state_time = now;
 
+	pmu_job_start(ctx);
+
 	return 0;
 }
 
@@ -207,6 +278,8 @@ rte_jobstats_finish(struct rte_jobstats *job, int64_t job_value)
 
 	ctx = job->context;
 
+	pmu_job_finish(ctx, job);
+
 	/* Update execution time is considered as runtime so get time after it is
 	 * executed. */
 	now = get_time();
@@ -290,4 +363,5 @@ rte_jobstats_reset(struct rte_jobstats *job)
 {
 	RESET_TIME_MIN_MAX(job, exec);
 	job->exec_cnt = 0;
+	memset(job->pmu_exec, 0, sizeof(job->pmu_exec));
 }
@@ -45,6 +45,12 @@ extern "C" {
 
 #define RTE_JOBSTATS_NAMESIZE 32
 
+/**
+ * Number of hardware counters sampled per job when PMU sampling is enabled,
+ * indexed by enum rte_pmu_event.
+ */
+#define RTE_JOBSTATS_PMU_EVENTS 5
+
 /* Forward declarations. */
 struct rte_jobstats_context;
 struct rte_jobstats;
@@ -95,6 +101,9 @@ struct rte_jobstats {
 
 	struct rte_jobstats_context *context;
 	/**< Job stats context object that is executing this job. */
+
+	uint64_t pmu_exec[RTE_JOBSTATS_PMU_EVENTS];
+	/**< Hardware events counted while this job was executing. */
 } __rte_cache_aligned;
 
 struct rte_jobstats_context {
@@ -141,6 +150,15 @@ struct rte_jobstats_context {
 
 	uint64_t loop_cnt;
 	/**< Total count of executed loops with at least one executed job. */
+
+	uint64_t pmu_exec[RTE_JOBSTATS_PMU_EVENTS];
+	/**< Hardware events counted while executing jobs. */
+
+	uint64_t pmu_state[RTE_JOBSTATS_PMU_EVENTS];
+	/**< Counters sampled when the current job started. */
+
+	int pmu_enabled;
+	/**< Whether hardware counters are sampled. */
 } __rte_cache_aligned;
 
 /**
@@ -184,6 +202,30 @@ rte_jobstats_context_finish(struct rte_jobstats_context *ctx);
 void
 rte_jobstats_context_reset(struct rte_jobstats_context *ctx);
 
+/**
+ * Enable sampling of the hardware performance counters for the jobs
+ * executed in this context. The counters of the calling thread are opened
+ * with rte_pmu_open() if they are not already, so this function must be
+ * called from the lcore executing the jobs.
+ *
+ * The events counted are accumulated in the pmu_exec field of the context
+ * and of each job.
+ *
+ * @param ctx
+ *  Job stats context.
+ * @param events
+ *  Mask of the events to count, built with RTE_PMU_EVENT_MASK().
+ *
+ * @return
+ *  0 on success
+ *  -EINVAL if *ctx* is NULL
+ *  -ENOTSUP if the library is built without librte_pmu
+ *  Other negative values if the counters cannot be opened
+ */
+int
+rte_jobstats_context_pmu_enable(struct rte_jobstats_context *ctx,
+		uint64_t events);
+
 /**
  * Initialize given job stats object.
  *
@@ -76,6 +76,7 @@
 #include <rte_ring.h>
 #include <rte_memcpy.h>
 #include <rte_common.h>
+#include <rte_trace.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -427,6 +428,11 @@ struct rte_mempool_ops_table {
 /** Array of registered ops structs. */
 extern struct rte_mempool_ops_table rte_mempool_ops_table;
 
+/** Trace point of the get operations. */
+RTE_TRACE_POINT_DECLARE(rte_mempool_trace_get);
+/** Trace point of the put operations. */
+RTE_TRACE_POINT_DECLARE(rte_mempool_trace_put);
+
 /**
  * @internal Get the mempool ops struct from its index.
  *
@@ -1128,6 +1134,7 @@ rte_mempool_generic_put(struct rte_mempool *mp, void * const *obj_table,
 {
 	__mempool_check_cookies(mp, obj_table, n, 0);
 	__mempool_generic_put(mp, obj_table, n, cache, flags);
+	rte_trace_point_emit(&rte_mempool_trace_put, (uintptr_t)mp, n, 0, 0);
 }
 
 /**
@@ -1352,6 +1359,7 @@ rte_mempool_generic_get(struct rte_mempool *mp, void **obj_table, unsigned n,
 	ret = __mempool_generic_get(mp, obj_table, n, cache, flags);
 	if (ret == 0)
 		__mempool_check_cookies(mp, obj_table, n, 1);
+	rte_trace_point_emit(&rte_mempool_trace_get, (uintptr_t)mp, n, ret, 0);
 	return ret;
 }
 
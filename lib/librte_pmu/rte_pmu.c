@@ -0,0 +1,166 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 Freescale Semiconductor, Inc. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of  Freescale Semiconductor, Inc nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include <rte_common.h>
+#include <rte_log.h>
+#include <rte_per_lcore.h>
+
+#include "rte_pmu.h"
+
+RTE_DEFINE_PER_LCORE(struct rte_pmu_thread, _pmu_thread);
+
+static const struct {
+	const char *name;
+	uint32_t type;
+	uint64_t config;
+} pmu_events[RTE_PMU_EVENT_MAX] = {
+	[RTE_PMU_CYCLES] = {
+		"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+	[RTE_PMU_INSTRUCTIONS] = {
+		"instructions", PERF_TYPE_HARDWARE,
+		PERF_COUNT_HW_INSTRUCTIONS },
+	[RTE_PMU_L1D_MISSES] = {
+		"L1D-misses", PERF_TYPE_HW_CACHE,
+		PERF_COUNT_HW_CACHE_L1D |
+		(PERF_COUNT_HW_CACHE_OP_READ << 8) |
+		(PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+	[RTE_PMU_LLC_MISSES] = {
+		"LLC-misses", PERF_TYPE_HARDWARE,
+		PERF_COUNT_HW_CACHE_MISSES },
+	[RTE_PMU_BRANCH_MISSES] = {
+		"branch-misses", PERF_TYPE_HARDWARE,
+		PERF_COUNT_HW_BRANCH_MISSES },
+};
+
+static int
+pmu_event_open(enum rte_pmu_event ev)
+{
+	struct perf_event_attr attr;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = pmu_events[ev].type;
+	attr.config = pmu_events[ev].config;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+
+	/* count the calling thread, on any CPU */
+	return syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+int
+rte_pmu_open(uint64_t events)
+{
+	struct rte_pmu_thread *t = &RTE_PER_LCORE(_pmu_thread);
+	struct perf_event_mmap_page *pc;
+	int fd, err = -ENOENT;
+	unsigned i, count = 0;
+
+	if (t->events != 0)
+		return -EBUSY;
+
+	for (i = 0; i < RTE_PMU_EVENT_MAX; i++) {
+		if (!(events & RTE_PMU_EVENT_MASK(i)))
+			continue;
+
+		fd = pmu_event_open(i);
+		if (fd < 0) {
+			err = -errno;
+			RTE_LOG(DEBUG, PMU, "Cannot count %s: %s\n",
+				pmu_events[i].name, strerror(errno));
+			continue;
+		}
+
+		/* the first page of the mapping allows user space reads */
+		pc = mmap(NULL, getpagesize(), PROT_READ, MAP_SHARED, fd, 0);
+		if (pc == MAP_FAILED)
+			pc = NULL;
+
+		t->fds[i] = fd;
+		t->pcs[i] = pc;
+		t->events |= RTE_PMU_EVENT_MASK(i);
+		count++;
+	}
+
+	if (count == 0)
+		return err;
+	return count;
+}
+
+void
+rte_pmu_close(void)
+{
+	struct rte_pmu_thread *t = &RTE_PER_LCORE(_pmu_thread);
+	unsigned i;
+
+	for (i = 0; i < RTE_PMU_EVENT_MAX; i++) {
+		if (!(t->events & RTE_PMU_EVENT_MASK(i)))
+			continue;
+		if (t->pcs[i] != NULL)
+			munmap(t->pcs[i], getpagesize());
+		close(t->fds[i]);
+		t->pcs[i] = NULL;
+		t->fds[i] = -1;
+	}
+	t->events = 0;
+}
+
+uint64_t
+rte_pmu_events(void)
+{
+	return RTE_PER_LCORE(_pmu_thread).events;
+}
+
+const char *
+rte_pmu_event_name(enum rte_pmu_event ev)
+{
+	if ((unsigned)ev >= RTE_PMU_EVENT_MAX)
+		return NULL;
+	return pmu_events[ev].name;
+}
+
+uint64_t
+__rte_pmu_read_syscall(int fd)
+{
+	uint64_t value;
+
+	if (read(fd, &value, sizeof(value)) != sizeof(value))
+		return 0;
+	return value;
+}
@@ -0,0 +1,230 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 Freescale Semiconductor, Inc. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of  Freescale Semiconductor, Inc nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_PMU_H_
+#define _RTE_PMU_H_
+
+/**
+ * @file
+ *
+ * RTE PMU
+ *
+ * Sample the hardware performance counters of the calling thread, like
+ * cycles, instructions or cache misses, to measure the efficiency of a
+ * processing loop.
+ *
+ * The counters are opened with perf_event_open(2), so it works on any
+ * Linux system with perf events. They count the user space events of the
+ * thread which opened them. When the kernel allows it, and the
+ * architecture supports it, the counters are read in-process without a
+ * system call: with rdpmc on x86, and with the counters of
+ * arch/arm/perf/counters.h on arm64 when CONFIG_RTE_LIBRTE_ARM_PERFCOUNTER
+ * is enabled. Otherwise they are read with read(2).
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <linux/perf_event.h>
+
+#include <rte_common.h>
+#include <rte_per_lcore.h>
+#include <rte_atomic.h>
+#if defined(RTE_ARCH_ARM64) && defined(RTE_LIBRTE_ARM_PERFCOUNTER)
+#include <arch/arm/perf/counters.h>
+#endif
+
+/** Hardware events which can be counted. */
+enum rte_pmu_event {
+	RTE_PMU_CYCLES = 0,     /**< CPU cycles. */
+	RTE_PMU_INSTRUCTIONS,   /**< Retired instructions. */
+	RTE_PMU_L1D_MISSES,     /**< Level 1 data cache read misses. */
+	RTE_PMU_LLC_MISSES,     /**< Last level cache misses. */
+	RTE_PMU_BRANCH_MISSES,  /**< Mispredicted branches. */
+	RTE_PMU_EVENT_MAX       /**< Number of events. */
+};
+
+/** Bit of an event in a mask of events. */
+#define RTE_PMU_EVENT_MASK(ev) (1ULL << (ev))
+
+/** Mask of all the events. */
+#define RTE_PMU_ALL_EVENTS (RTE_PMU_EVENT_MASK(RTE_PMU_EVENT_MAX) - 1)
+
+/** Values of the counters, indexed by enum rte_pmu_event. */
+struct rte_pmu_values {
+	uint64_t val[RTE_PMU_EVENT_MAX]; /**< 0 for the events not opened. */
+};
+
+/** @internal Counters opened by a thread. */
+struct rte_pmu_thread {
+	uint64_t events;        /**< Mask of the opened events. */
+	int fds[RTE_PMU_EVENT_MAX];
+	struct perf_event_mmap_page *pcs[RTE_PMU_EVENT_MAX];
+};
+
+RTE_DECLARE_PER_LCORE(struct rte_pmu_thread, _pmu_thread);
+
+/**
+ * Open the counters of some events for the calling thread.
+ *
+ * The events which are not supported by the CPU or the kernel are
+ * skipped: their value is always 0.
+ *
+ * @param events
+ *   Mask of the events to count, built with RTE_PMU_EVENT_MASK().
+ * @return
+ *   - The number of events counted on success.
+ *   - (-EBUSY) if the counters of the thread are already open.
+ *   - Negative errno of perf_event_open(2) if no event can be counted.
+ */
+int rte_pmu_open(uint64_t events);
+
+/**
+ * Close the counters of the calling thread.
+ */
+void rte_pmu_close(void);
+
+/**
+ * Get the events counted for the calling thread.
+ *
+ * @return
+ *   Mask of the events counted, 0 if the counters are not open.
+ */
+uint64_t rte_pmu_events(void);
+
+/**
+ * Get the name of an event.
+ *
+ * @param ev
+ *   The event.
+ * @return
+ *   The name, like "cycles", or NULL for an invalid event.
+ */
+const char *rte_pmu_event_name(enum rte_pmu_event ev);
+
+/**
+ * @internal Read a counter with a system call.
+ */
+uint64_t __rte_pmu_read_syscall(int fd);
+
+#if defined(RTE_ARCH_X86) || \
+	(defined(RTE_ARCH_ARM64) && defined(RTE_LIBRTE_ARM_PERFCOUNTER))
+/**
+ * @internal Read a hardware counter in user space.
+ *
+ * @param idx
+ *   Index of the counter, as given by the perf mmap page, minus 1.
+ */
+static inline uint64_t
+__rte_pmu_read_counter(uint32_t idx)
+{
+#if defined(RTE_ARCH_X86)
+	uint32_t lo, hi;
+
+	asm volatile("rdpmc" : "=a" (lo), "=d" (hi) : "c" (idx));
+	return ((uint64_t)hi << 32) | lo;
+#else
+	/* perf exposes the cycle counter as the last index */
+	if (idx == 31)
+		return arm_read_cycle_counter();
+	return arm_read_counter(idx);
+#endif
+}
+#define RTE_PMU_USER_READ
+#endif
+
+/**
+ * @internal Read the counter of an event, in user space if possible.
+ */
+static inline uint64_t
+__rte_pmu_read_event(struct perf_event_mmap_page *pc, int fd)
+{
+#ifdef RTE_PMU_USER_READ
+	uint64_t offset;
+	int64_t count;
+	uint32_t seq, idx, width;
+
+	if (pc == NULL)
+		return __rte_pmu_read_syscall(fd);
+
+	/* retry if the kernel updates the page while reading it */
+	do {
+		seq = pc->lock;
+		rte_compiler_barrier();
+		idx = pc->index;
+		offset = pc->offset;
+		if (!pc->cap_user_rdpmc || idx == 0)
+			return __rte_pmu_read_syscall(fd);
+		width = pc->pmc_width;
+		count = __rte_pmu_read_counter(idx - 1);
+		/* the counter is width bits wide and sign extended */
+		count <<= 64 - width;
+		count >>= 64 - width;
+		offset += count;
+		rte_compiler_barrier();
+	} while (pc->lock != seq);
+
+	return offset;
+#else
+	RTE_SET_USED(pc);
+	return __rte_pmu_read_syscall(fd);
+#endif
+}
+
+/**
+ * Read the counters of the calling thread.
+ *
+ * @param values
+ *   A pointer to the structure filled with the values of the counters.
+ */
+static inline void
+rte_pmu_read(struct rte_pmu_values *values)
+{
+	struct rte_pmu_thread *t = &RTE_PER_LCORE(_pmu_thread);
+	unsigned i;
+
+	for (i = 0; i < RTE_PMU_EVENT_MAX; i++) {
+		if (t->events & RTE_PMU_EVENT_MASK(i))
+			values->val[i] = __rte_pmu_read_event(t->pcs[i],
+				t->fds[i]);
+		else
+			values->val[i] = 0;
+	}
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_PMU_H_ */
@@ -0,0 +1,201 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 Freescale Semiconductor, Inc. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of  Freescale Semiconductor, Inc nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include <rte_common.h>
+#include <rte_log.h>
+#include <rte_cycles.h>
+#include <rte_spinlock.h>
+#include <rte_interrupts.h>
+#include <rte_ethdev.h>
+
+#include "rte_power_poll.h"
+
+/*
+ * Arming the RX interrupt of a queue may touch registers shared by all
+ * the queues of a port.
+ */
+static rte_spinlock_t port_locks[RTE_MAX_ETHPORTS] = {
+	[0 ... RTE_MAX_ETHPORTS - 1] = RTE_SPINLOCK_INITIALIZER
+};
+
+static void
+power_poll_intr_set(struct rte_power_poll *pp, int on)
+{
+	struct rte_power_poll_queue *q;
+	unsigned i;
+
+	for (i = 0; i < pp->nb_queues; i++) {
+		q = &pp->queues[i];
+		if (!q->intr)
+			continue;
+		rte_spinlock_lock(&port_locks[q->port_id]);
+		if (on)
+			rte_eth_dev_rx_intr_enable(q->port_id, q->queue_id);
+		else
+			rte_eth_dev_rx_intr_disable(q->port_id, q->queue_id);
+		rte_spinlock_unlock(&port_locks[q->port_id]);
+	}
+	pp->armed = on;
+}
+
+int
+rte_power_poll_init(struct rte_power_poll *pp,
+		const struct rte_power_poll_conf *conf)
+{
+	if (pp == NULL)
+		return -EINVAL;
+	if (conf != NULL && conf->idle_polls == 0)
+		return -EINVAL;
+
+	memset(pp, 0, sizeof(*pp));
+	if (conf != NULL) {
+		pp->conf = *conf;
+	} else {
+		pp->conf.idle_polls = RTE_POWER_POLL_IDLE_POLLS;
+		pp->conf.max_sleep_ms = RTE_POWER_POLL_MAX_SLEEP_MS;
+		pp->conf.fallback_sleep_us = RTE_POWER_POLL_FALLBACK_SLEEP_US;
+	}
+
+	return 0;
+}
+
+int
+rte_power_poll_queue_add(struct rte_power_poll *pp, uint8_t port_id,
+		uint16_t queue_id)
+{
+	struct rte_power_poll_queue *q;
+	uintptr_t data;
+	int ret;
+
+	if (!rte_eth_dev_is_valid_port(port_id))
+		return -EINVAL;
+	if (pp->nb_queues == RTE_POWER_POLL_MAX_QUEUES)
+		return -ENOSPC;
+
+	q = &pp->queues[pp->nb_queues++];
+	q->port_id = port_id;
+	q->queue_id = queue_id;
+	q->intr = 0;
+
+	/* the event data identifies the queue, for debugging purposes */
+	data = (uintptr_t)port_id << 16 | queue_id;
+	ret = rte_eth_dev_rx_intr_ctl_q(port_id, queue_id,
+			RTE_EPOLL_PER_THREAD, RTE_INTR_EVENT_ADD,
+			(void *)data);
+	if (ret == 0) {
+		/* check the PMD can arm it */
+		ret = rte_eth_dev_rx_intr_disable(port_id, queue_id);
+		if (ret != 0)
+			rte_eth_dev_rx_intr_ctl_q(port_id, queue_id,
+				RTE_EPOLL_PER_THREAD, RTE_INTR_EVENT_DEL,
+				NULL);
+	}
+	if (ret != 0) {
+		RTE_LOG(INFO, POWER, "No RX interrupt on port %u queue %u, "
+			"sleeping %u us when idle\n", port_id, queue_id,
+			pp->conf.fallback_sleep_us);
+		return 1;
+	}
+
+	q->intr = 1;
+	pp->nb_intr++;
+	return 0;
+}
+
+void
+rte_power_poll_release(struct rte_power_poll *pp)
+{
+	struct rte_power_poll_queue *q;
+	unsigned i;
+
+	if (pp->armed)
+		power_poll_intr_set(pp, 0);
+
+	for (i = 0; i < pp->nb_queues; i++) {
+		q = &pp->queues[i];
+		if (q->intr)
+			rte_eth_dev_rx_intr_ctl_q(q->port_id, q->queue_id,
+				RTE_EPOLL_PER_THREAD, RTE_INTR_EVENT_DEL,
+				NULL);
+		q->intr = 0;
+	}
+	pp->nb_queues = 0;
+	pp->nb_intr = 0;
+}
+
+void
+__rte_power_poll_disarm(struct rte_power_poll *pp)
+{
+	power_poll_intr_set(pp, 0);
+}
+
+int
+__rte_power_poll_idle(struct rte_power_poll *pp)
+{
+	struct rte_epoll_event events[RTE_POWER_POLL_MAX_QUEUES];
+	uint64_t start;
+	int timeout, n;
+
+	/*
+	 * Arm the interrupts first and let the caller poll the queues once
+	 * more: the packets received before arming raise no interrupt.
+	 */
+	if (!pp->armed && pp->nb_intr != 0) {
+		power_poll_intr_set(pp, 1);
+		return 0;
+	}
+
+	start = rte_rdtsc();
+	if (pp->nb_intr == 0) {
+		usleep(pp->conf.fallback_sleep_us);
+	} else {
+		if (pp->nb_intr == pp->nb_queues)
+			timeout = pp->conf.max_sleep_ms;
+		else
+			timeout = RTE_MAX(1U,
+				pp->conf.fallback_sleep_us / 1000);
+		n = rte_epoll_wait(RTE_EPOLL_PER_THREAD, events,
+				pp->nb_intr, timeout);
+		if (n > 0)
+			pp->stats.intr_wakeups++;
+		power_poll_intr_set(pp, 0);
+	}
+	pp->stats.sleep_cycles += rte_rdtsc() - start;
+	pp->stats.sleeps++;
+	pp->idle = 0;
+
+	return 1;
+}
@@ -0,0 +1,210 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 Freescale Semiconductor, Inc. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of  Freescale Semiconductor, Inc nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_POWER_POLL_H
+#define _RTE_POWER_POLL_H
+
+/**
+ * @file
+ * RTE Power Management: adaptive polling of RX queues
+ *
+ * A polling lcore keeps busy polling its RX queues while they bring
+ * packets. After a configured number of empty polls in a row, it arms the
+ * RX interrupts of its queues, polls them once more to catch the packets
+ * which arrived meanwhile, and sleeps in rte_epoll_wait() until one of
+ * the queues raises an interrupt. It then disarms the interrupts and goes
+ * back to busy polling.
+ *
+ * The RX interrupts are registered on the epoll instance of the polling
+ * thread, so the lcores never depend on the EAL interrupt thread. The
+ * queues of the PMDs without RX interrupt support, or not configured with
+ * intr_conf.rxq, are handled with a short timed sleep instead.
+ */
+
+#include <stdint.h>
+
+#include <rte_common.h>
+#include <rte_branch_prediction.h>
+#include <rte_memory.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum number of RX queues polled by an lcore. */
+#define RTE_POWER_POLL_MAX_QUEUES 32
+
+/** Default number of empty polls in a row before sleeping. */
+#define RTE_POWER_POLL_IDLE_POLLS 512
+
+/** Default longest sleep waiting for an RX interrupt, in milliseconds. */
+#define RTE_POWER_POLL_MAX_SLEEP_MS 10
+
+/** Default sleep when some queues have no RX interrupt, in microseconds. */
+#define RTE_POWER_POLL_FALLBACK_SLEEP_US 100
+
+/** Adaptive polling configuration. */
+struct rte_power_poll_conf {
+	uint32_t idle_polls;
+	/**< Number of empty polls in a row before sleeping. */
+	int max_sleep_ms;
+	/**< Longest sleep waiting for an RX interrupt, -1 for no limit. */
+	uint32_t fallback_sleep_us;
+	/**< Sleep duration when some queues have no RX interrupt. */
+};
+
+/** Adaptive polling statistics. */
+struct rte_power_poll_stats {
+	uint64_t polls;         /**< Number of polls. */
+	uint64_t empty_polls;   /**< Number of polls without any packet. */
+	uint64_t sleeps;        /**< Number of times the lcore slept. */
+	uint64_t intr_wakeups;  /**< Sleeps ended by an RX interrupt. */
+	uint64_t sleep_cycles;  /**< TSC cycles spent sleeping. */
+};
+
+/** @internal RX queue polled by an lcore. */
+struct rte_power_poll_queue {
+	uint8_t port_id;
+	uint16_t queue_id;
+	uint8_t intr;           /**< RX interrupt registered. */
+};
+
+/** Adaptive polling state of an lcore. */
+struct rte_power_poll {
+	struct rte_power_poll_conf conf;  /**< Configuration. */
+	uint32_t idle;          /**< Current number of empty polls in a row. */
+	uint8_t armed;          /**< RX interrupts are armed. */
+	uint16_t nb_queues;     /**< Number of RX queues. */
+	uint16_t nb_intr;       /**< Number of RX queues with interrupts. */
+	struct rte_power_poll_stats stats;  /**< Statistics. */
+	struct rte_power_poll_queue queues[RTE_POWER_POLL_MAX_QUEUES];
+} __rte_cache_aligned;
+
+/**
+ * Initialize the adaptive polling state of an lcore.
+ *
+ * @param pp
+ *  Adaptive polling state to initialize.
+ * @param conf
+ *  Configuration, NULL for the default values.
+ *
+ * @return
+ *  - 0 on success.
+ *  - (-EINVAL) if *pp* is NULL or *conf* is invalid.
+ */
+int rte_power_poll_init(struct rte_power_poll *pp,
+		const struct rte_power_poll_conf *conf);
+
+/**
+ * Add an RX queue polled by the lcore. This function must be called from
+ * the lcore polling the queue, since the RX interrupt is registered on
+ * the epoll instance of the calling thread.
+ *
+ * If the RX interrupt of the queue cannot be used, the queue is still
+ * added, and the lcore sleeps for conf.fallback_sleep_us at most.
+ *
+ * @param pp
+ *  Adaptive polling state.
+ * @param port_id
+ *  Port of the RX queue.
+ * @param queue_id
+ *  RX queue.
+ *
+ * @return
+ *  - 0 if the RX interrupt of the queue is used.
+ *  - 1 if the queue is polled with a timed sleep.
+ *  - (-EINVAL) if the port is invalid.
+ *  - (-ENOSPC) if there are too many queues.
+ */
+int rte_power_poll_queue_add(struct rte_power_poll *pp, uint8_t port_id,
+		uint16_t queue_id);
+
+/**
+ * Unregister the RX interrupts of all the queues of the lcore. This
+ * function must be called from the lcore which added the queues.
+ *
+ * @param pp
+ *  Adaptive polling state.
+ */
+void rte_power_poll_release(struct rte_power_poll *pp);
+
+/**
+ * @internal Handle an empty poll past the idle threshold.
+ */
+int __rte_power_poll_idle(struct rte_power_poll *pp);
+
+/**
+ * @internal Disarm the RX interrupts after receiving packets.
+ */
+void __rte_power_poll_disarm(struct rte_power_poll *pp);
+
+/**
+ * Account a poll of all the RX queues of the lcore, and sleep if they
+ * have been idle for long enough.
+ *
+ * It must be called once per iteration of the polling loop, after
+ * polling every queue added with rte_power_poll_queue_add(). The first
+ * call past the idle threshold arms the RX interrupts and returns, so
+ * that the queues are polled once more before actually sleeping.
+ *
+ * @param pp
+ *  Adaptive polling state.
+ * @param nb_rx
+ *  Number of packets received from all the queues in this iteration.
+ *
+ * @return
+ *  - 1 if the lcore slept.
+ *  - 0 otherwise.
+ */
+static inline int
+rte_power_poll_update(struct rte_power_poll *pp, uint32_t nb_rx)
+{
+	pp->stats.polls++;
+	if (likely(nb_rx != 0)) {
+		if (unlikely(pp->armed))
+			__rte_power_poll_disarm(pp);
+		pp->idle = 0;
+		return 0;
+	}
+
+	pp->stats.empty_polls++;
+	if (likely(++pp->idle < pp->conf.idle_polls))
+		return 0;
+
+	return __rte_power_poll_idle(pp);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_POWER_POLL_H */
@@ -0,0 +1,431 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 Freescale Semiconductor, Inc. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of  Freescale Semiconductor, Inc nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_log.h>
+#include <rte_memory.h>
+#include <rte_malloc.h>
+#include <rte_eal.h>
+#include <rte_atomic.h>
+#include <rte_spinlock.h>
+#include <rte_per_lcore.h>
+#include <rte_lcore.h>
+#include <rte_errno.h>
+
+#include "rte_rcu_qsbr.h"
+
+/* Get the memory size of QSBR variable */
+size_t
+rte_rcu_qsbr_get_memsize(uint32_t max_threads)
+{
+	size_t sz;
+
+	if (max_threads == 0) {
+		RTE_LOG(ERR, RCU, "%s(): Invalid max_threads %u\n",
+			__func__, max_threads);
+		rte_errno = EINVAL;
+
+		return 1;
+	}
+
+	sz = sizeof(struct rte_rcu_qsbr);
+
+	/* Add the size of quiescent state counter array */
+	sz += sizeof(struct rte_rcu_qsbr_cnt) * max_threads;
+
+	/* Add the size of the registered thread ID bitmap array */
+	sz += __RTE_QSBR_THRID_ARRAY_SIZE(max_threads);
+
+	return sz;
+}
+
+/* Initialize a quiescent state variable */
+int
+rte_rcu_qsbr_init(struct rte_rcu_qsbr *v, uint32_t max_threads)
+{
+	size_t sz;
+
+	if (v == NULL) {
+		RTE_LOG(ERR, RCU, "%s(): Invalid input parameter\n", __func__);
+		rte_errno = EINVAL;
+
+		return 1;
+	}
+
+	sz = rte_rcu_qsbr_get_memsize(max_threads);
+	if (sz == 1)
+		return 1;
+
+	/* Set all the threads to offline */
+	memset(v, 0, sz);
+	v->max_threads = max_threads;
+	v->num_elems = RTE_ALIGN_CEIL(max_threads,
+			__RTE_QSBR_THRID_ARRAY_ELM_SIZE) /
+			__RTE_QSBR_THRID_ARRAY_ELM_SIZE;
+	v->token = RTE_QSBR_CNT_INIT;
+
+	return 0;
+}
+
+/* Register a reader thread to report its quiescent state
+ * on a QS variable.
+ */
+int
+rte_rcu_qsbr_thread_register(struct rte_rcu_qsbr *v, unsigned int thread_id)
+{
+	unsigned int i, id, success;
+	uint64_t old_bmap, new_bmap;
+
+	if (v == NULL || thread_id >= v->max_threads) {
+		RTE_LOG(ERR, RCU, "%s(): Invalid input parameter\n", __func__);
+		rte_errno = EINVAL;
+
+		return 1;
+	}
+
+	id = thread_id & __RTE_QSBR_THRID_MASK;
+	i = thread_id >> __RTE_QSBR_THRID_INDEX_SHIFT;
+
+	/* Make sure that the counter for registered threads does not
+	 * go out of sync. Hence, additional checks are required.
+	 */
+	/* Check if the thread is already registered */
+	old_bmap = __atomic_load_n(__RTE_QSBR_THRID_ARRAY_ELM(v, i),
+				   __ATOMIC_RELAXED);
+	if (old_bmap & 1ULL << id)
+		return 0;
+
+	do {
+		new_bmap = old_bmap | (1ULL << id);
+		success = __atomic_compare_exchange(
+					__RTE_QSBR_THRID_ARRAY_ELM(v, i),
+					&old_bmap, &new_bmap, 0,
+					__ATOMIC_RELEASE, __ATOMIC_RELAXED);
+
+		if (success)
+			__atomic_fetch_add(&v->num_threads,
+					   1, __ATOMIC_RELAXED);
+		else if (old_bmap & (1ULL << id))
+			/* Someone else registered this thread.
+			 * Counter should not be incremented.
+			 */
+			return 0;
+	} while (success == 0);
+
+	return 0;
+}
+
+/* Remove a reader thread, from the list of threads reporting their
+ * quiescent state on a QS variable.
+ */
+int
+rte_rcu_qsbr_thread_unregister(struct rte_rcu_qsbr *v, unsigned int thread_id)
+{
+	unsigned int i, id, success;
+	uint64_t old_bmap, new_bmap;
+
+	if (v == NULL || thread_id >= v->max_threads) {
+		RTE_LOG(ERR, RCU, "%s(): Invalid input parameter\n", __func__);
+		rte_errno = EINVAL;
+
+		return 1;
+	}
+
+	id = thread_id & __RTE_QSBR_THRID_MASK;
+	i = thread_id >> __RTE_QSBR_THRID_INDEX_SHIFT;
+
+	/* Make sure that the counter for registered threads does not
+	 * go out of sync. Hence, additional checks are required.
+	 */
+	/* Check if the thread is already unregistered */
+	old_bmap = __atomic_load_n(__RTE_QSBR_THRID_ARRAY_ELM(v, i),
+				   __ATOMIC_RELAXED);
+	if (!(old_bmap & (1ULL << id)))
+		return 0;
+
+	do {
+		new_bmap = old_bmap & ~(1ULL << id);
+		/* Make sure any loads of the shared data structure are
+		 * completed before removal of the thread from the list of
+		 * reporting threads.
+		 */
+		success = __atomic_compare_exchange(
+					__RTE_QSBR_THRID_ARRAY_ELM(v, i),
+					&old_bmap, &new_bmap, 0,
+					__ATOMIC_RELEASE, __ATOMIC_RELAXED);
+
+		if (success)
+			__atomic_fetch_sub(&v->num_threads,
+					   1, __ATOMIC_RELAXED);
+		else if (!(old_bmap & (1ULL << id)))
+			/* Someone else unregistered this thread.
+			 * Counter should not be decremented.
+			 */
+			return 0;
+	} while (success == 0);
+
+	return 0;
+}
+
+/* Wait till the reader threads have entered quiescent state. */
+void
+rte_rcu_qsbr_synchronize(struct rte_rcu_qsbr *v, unsigned int thread_id)
+{
+	uint64_t t;
+
+	RTE_ASSERT(v != NULL);
+
+	t = rte_rcu_qsbr_start(v);
+
+	/* If the current thread has readside critical section,
+	 * update its quiescent state status.
+	 */
+	if (thread_id != RTE_QSBR_THRID_INVALID)
+		rte_rcu_qsbr_quiescent(v, thread_id);
+
+	/* Wait for other readers to enter quiescent state */
+	rte_rcu_qsbr_check(v, t, 1);
+}
+
+/* Dump the details of a single quiescent state variable to a file. */
+int
+rte_rcu_qsbr_dump(FILE *f, struct rte_rcu_qsbr *v)
+{
+	uint64_t bmap;
+	uint32_t i, t, id;
+
+	if (v == NULL || f == NULL) {
+		RTE_LOG(ERR, RCU, "%s(): Invalid input parameter\n", __func__);
+		rte_errno = EINVAL;
+
+		return 1;
+	}
+
+	fprintf(f, "\nQuiescent State Variable @%p\n", v);
+
+	fprintf(f, "  QS variable memory size = %zu\n",
+				rte_rcu_qsbr_get_memsize(v->max_threads));
+	fprintf(f, "  Given # max threads = %u\n", v->max_threads);
+	fprintf(f, "  Current # threads = %u\n", v->num_threads);
+
+	fprintf(f, "  Registered thread IDs = ");
+	for (i = 0; i < v->num_elems; i++) {
+		bmap = __atomic_load_n(__RTE_QSBR_THRID_ARRAY_ELM(v, i),
+					__ATOMIC_ACQUIRE);
+		id = i << __RTE_QSBR_THRID_INDEX_SHIFT;
+		while (bmap) {
+			t = __builtin_ctzll(bmap);
+			fprintf(f, "%u ", id + t);
+
+			bmap &= ~(1ULL << t);
+		}
+	}
+
+	fprintf(f, "\n");
+
+	fprintf(f, "  Token = %"PRIu64"\n",
+			__atomic_load_n(&v->token, __ATOMIC_ACQUIRE));
+
+	fprintf(f, "Quiescent State Counts for readers:\n");
+	for (i = 0; i < v->num_elems; i++) {
+		bmap = __atomic_load_n(__RTE_QSBR_THRID_ARRAY_ELM(v, i),
+					__ATOMIC_ACQUIRE);
+		id = i << __RTE_QSBR_THRID_INDEX_SHIFT;
+		while (bmap) {
+			t = __builtin_ctzll(bmap);
+			fprintf(f, "thread ID = %u, count = %"PRIu64"\n",
+				id + t,
+				__atomic_load_n(
+					&v->qsbr_cnt[id + t].cnt,
+					__ATOMIC_RELAXED));
+			bmap &= ~(1ULL << t);
+		}
+	}
+
+	return 0;
+}
+
+/* Element of the defer queue */
+struct rcu_qsbr_dq_entry {
+	uint64_t token; /**< Token taken when the element was removed */
+	void *e;        /**< Element to free */
+};
+
+/* Defer queue: circular buffer of elements ordered by token */
+struct rte_rcu_qsbr_dq {
+	rte_spinlock_t lock;         /**< Serializes the writers */
+	struct rte_rcu_qsbr *v;      /**< QS variable protecting the elements */
+	rte_rcu_qsbr_free_t free_fn; /**< Function freeing an element */
+	void *p;                     /**< Argument of the free function */
+	uint32_t size;               /**< Number of entries */
+	uint32_t mask;               /**< size - 1 */
+	uint32_t head;               /**< Oldest entry */
+	uint32_t tail;               /**< Next free entry */
+	struct rcu_qsbr_dq_entry q[0] __rte_cache_aligned;
+};
+
+/* Create a queue used to store the data structure elements that can
+ * be freed later.
+ */
+struct rte_rcu_qsbr_dq *
+rte_rcu_qsbr_dq_create(const struct rte_rcu_qsbr_dq_parameters *params)
+{
+	struct rte_rcu_qsbr_dq *dq;
+	uint32_t size;
+
+	if (params == NULL || params->name == NULL || params->v == NULL ||
+	    params->free_fn == NULL || params->size == 0) {
+		RTE_LOG(ERR, RCU, "%s(): Invalid input parameter\n", __func__);
+		rte_errno = EINVAL;
+
+		return NULL;
+	}
+
+	size = rte_align32pow2(params->size);
+	dq = rte_zmalloc_socket(params->name, sizeof(*dq) +
+				size * sizeof(struct rcu_qsbr_dq_entry),
+				RTE_CACHE_LINE_SIZE, params->socket_id);
+	if (dq == NULL) {
+		RTE_LOG(ERR, RCU, "%s(): Cannot allocate defer queue %s\n",
+			__func__, params->name);
+		rte_errno = ENOMEM;
+
+		return NULL;
+	}
+
+	rte_spinlock_init(&dq->lock);
+	dq->v = params->v;
+	dq->free_fn = params->free_fn;
+	dq->p = params->p;
+	dq->size = size;
+	dq->mask = size - 1;
+
+	return dq;
+}
+
+/* Free the expired elements, the lock must be held */
+static unsigned int
+__rcu_qsbr_dq_reclaim(struct rte_rcu_qsbr_dq *dq, unsigned int n, int wait)
+{
+	struct rcu_qsbr_dq_entry *ent;
+	unsigned int cnt = 0;
+
+	while (cnt < n && dq->head != dq->tail) {
+		ent = &dq->q[dq->head & dq->mask];
+		/* Entries are in token order: stop at the first one
+		 * which may still be referenced.
+		 */
+		if (rte_rcu_qsbr_check(dq->v, ent->token, wait) == 0)
+			break;
+		dq->free_fn(dq->p, ent->e);
+		dq->head++;
+		cnt++;
+	}
+
+	return cnt;
+}
+
+/* Enqueue one resource to the defer queue to free after the grace
+ * period is over.
+ */
+int
+rte_rcu_qsbr_dq_enqueue(struct rte_rcu_qsbr_dq *dq, void *e)
+{
+	struct rcu_qsbr_dq_entry *ent;
+
+	if (dq == NULL)
+		return -EINVAL;
+
+	rte_spinlock_lock(&dq->lock);
+
+	/* Make some room, without waiting for the readers */
+	if (dq->tail - dq->head == dq->size &&
+	    __rcu_qsbr_dq_reclaim(dq, dq->size, 0) == 0) {
+		rte_spinlock_unlock(&dq->lock);
+		return -ENOSPC;
+	}
+
+	/* The element is no longer reachable by new readers: start a grace
+	 * period, which ends once all the current readers have reported a
+	 * quiescent state.
+	 */
+	ent = &dq->q[dq->tail & dq->mask];
+	ent->token = rte_rcu_qsbr_start(dq->v);
+	ent->e = e;
+	dq->tail++;
+
+	rte_spinlock_unlock(&dq->lock);
+
+	return 0;
+}
+
+/* Reclaim resources from the defer queue. */
+unsigned int
+rte_rcu_qsbr_dq_reclaim(struct rte_rcu_qsbr_dq *dq, unsigned int n, int wait,
+			unsigned int *pending)
+{
+	unsigned int cnt;
+
+	if (dq == NULL)
+		return 0;
+
+	rte_spinlock_lock(&dq->lock);
+	cnt = __rcu_qsbr_dq_reclaim(dq, n, wait);
+	if (pending != NULL)
+		*pending = dq->tail - dq->head;
+	rte_spinlock_unlock(&dq->lock);
+
+	return cnt;
+}
+
+/* Delete a defer queue. */
+int
+rte_rcu_qsbr_dq_delete(struct rte_rcu_qsbr_dq *dq)
+{
+	if (dq == NULL)
+		return -EINVAL;
+
+	/* Reclaim all the resources, waiting for the readers */
+	rte_spinlock_lock(&dq->lock);
+	__rcu_qsbr_dq_reclaim(dq, UINT32_MAX, 1);
+	rte_spinlock_unlock(&dq->lock);
+
+	rte_free(dq);
+
+	return 0;
+}
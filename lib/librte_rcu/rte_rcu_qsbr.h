@@ -0,0 +1,542 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) 2016 Freescale Semiconductor, Inc. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of  Freescale Semiconductor, Inc nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_RCU_QSBR_H_
+#define _RTE_RCU_QSBR_H_
+
+/**
+ * @file
+ *
+ * RTE Quiescent State Based Reclamation (QSBR)
+ *
+ * Quiescent State (QS) is any point in the thread execution where the
+ * thread does not hold a reference to a data structure in shared memory.
+ * While using lock-less data structures, the writer can safely free memory
+ * once all the reader threads have entered quiescent state.
+ *
+ * The reader threads register on a QS variable and report their quiescent
+ * state from their polling loop with rte_rcu_qsbr_quiescent(), which is a
+ * couple of plain stores. The writer removes an element from the data
+ * structure, then either:
+ *
+ * - waits until all the readers went through a quiescent state with
+ *   rte_rcu_qsbr_synchronize() (blocking), or
+ * - gets a token with rte_rcu_qsbr_start() and polls it later with
+ *   rte_rcu_qsbr_check() (non-blocking), or
+ * - pushes the element with a free callback on a defer queue, which calls
+ *   the callback once the element cannot be referenced anymore.
+ *
+ * A reader thread which does not access the shared data structures for a
+ * long time (e.g. while blocked in an interrupt wait) should go offline,
+ * so that it does not block the writers.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <errno.h>
+#include <rte_common.h>
+#include <rte_memory.h>
+#include <rte_lcore.h>
+#include <rte_debug.h>
+#include <rte_atomic.h>
+
+/* Number of thread IDs tracked per bitmap element */
+#define __RTE_QSBR_THRID_ARRAY_ELM_SIZE (sizeof(uint64_t) * 8)
+/* Size of the registered thread ID bitmap, in bytes */
+#define __RTE_QSBR_THRID_ARRAY_SIZE(max_threads) \
+	RTE_ALIGN(RTE_ALIGN_CEIL(max_threads, \
+		__RTE_QSBR_THRID_ARRAY_ELM_SIZE) >> 3, RTE_CACHE_LINE_SIZE)
+/* Pointer to the i-th element of the registered thread ID bitmap */
+#define __RTE_QSBR_THRID_ARRAY_ELM(v, i) ((uint64_t *) \
+	((struct rte_rcu_qsbr_cnt *)(v + 1) + v->max_threads) + i)
+#define __RTE_QSBR_THRID_INDEX_SHIFT 6
+#define __RTE_QSBR_THRID_MASK 0x3f
+
+/** Quiescent state counter value of a thread which is offline */
+#define RTE_QSBR_CNT_THR_OFFLINE 0
+/** Initial value of the token */
+#define RTE_QSBR_CNT_INIT 1
+/** Thread ID to pass to rte_rcu_qsbr_synchronize() by non-reader threads */
+#define RTE_QSBR_THRID_INVALID 0xffffffff
+
+/**
+ * Quiescent state counter of a reader thread, on its own cache line.
+ */
+struct rte_rcu_qsbr_cnt {
+	uint64_t cnt;
+	/**< Quiescent state counter. Value 0 indicates the thread is offline */
+} __rte_cache_aligned;
+
+/**
+ * RTE QS variable structure.
+ *
+ * It is followed by the quiescent state counters of max_threads threads
+ * and by the bitmap of the registered thread IDs.
+ */
+struct rte_rcu_qsbr {
+	uint64_t token __rte_cache_aligned;
+	/**< Counter to allow for multiple concurrent quiescent state queries */
+
+	uint32_t num_elems __rte_cache_aligned;
+	/**< Number of elements in the thread ID bitmap */
+	uint32_t num_threads;
+	/**< Number of threads currently registered */
+	uint32_t max_threads;
+	/**< Maximum number of threads using this QS variable */
+
+	struct rte_rcu_qsbr_cnt qsbr_cnt[0] __rte_cache_aligned;
+	/**< Quiescent state counter array of 'max_threads' elements */
+} __rte_cache_aligned;
+
+/**
+ * Return the size of the memory occupied by a QS variable.
+ *
+ * @param max_threads
+ *   Maximum number of threads reporting quiescent state on this variable.
+ * @return
+ *   On success - size of memory in bytes required for this QS variable.
+ *   On error - 1 with error code set in rte_errno.
+ *   Possible rte_errno codes are:
+ *   - EINVAL - max_threads is 0
+ */
+size_t
+rte_rcu_qsbr_get_memsize(uint32_t max_threads);
+
+/**
+ * Initialize a QS variable.
+ *
+ * @param v
+ *   QS variable, allocated with at least rte_rcu_qsbr_get_memsize() bytes
+ *   and aligned on a cache line.
+ * @param max_threads
+ *   Maximum number of threads reporting quiescent state on this variable.
+ *   It must be the same value passed to rte_rcu_qsbr_get_memsize().
+ * @return
+ *   On success - 0
+ *   On error - 1 with error code set in rte_errno.
+ *   Possible rte_errno codes are:
+ *   - EINVAL - max_threads is 0 or 'v' is NULL.
+ */
+int
+rte_rcu_qsbr_init(struct rte_rcu_qsbr *v, uint32_t max_threads);
+
+/**
+ * Register a reader thread to report its quiescent state on a QS variable.
+ *
+ * This is implemented as a lock-free function and is multi-thread safe.
+ * Any reader thread that wants to report its quiescent state must call
+ * this API, then rte_rcu_qsbr_thread_online().
+ *
+ * @param v
+ *   QS variable
+ * @param thread_id
+ *   Reader thread with this thread ID will report its quiescent state on
+ *   the QS variable. thread_id is a value between 0 and (max_threads - 1),
+ *   the lcore id can be used for instance.
+ * @return
+ *   On success - 0
+ *   On error - 1 with error code set in rte_errno.
+ */
+int
+rte_rcu_qsbr_thread_register(struct rte_rcu_qsbr *v, unsigned int thread_id);
+
+/**
+ * Remove a reader thread from the list of threads reporting their
+ * quiescent state on a QS variable.
+ *
+ * This is implemented as a lock-free function and is multi-thread safe.
+ *
+ * @param v
+ *   QS variable
+ * @param thread_id
+ *   Reader thread with this thread ID will stop reporting its quiescent
+ *   state on the QS variable.
+ * @return
+ *   On success - 0
+ *   On error - 1 with error code set in rte_errno.
+ */
+int
+rte_rcu_qsbr_thread_unregister(struct rte_rcu_qsbr *v, unsigned int thread_id);
+
+/**
+ * Add a registered reader thread to the list of threads reporting their
+ * quiescent state on a QS variable.
+ *
+ * Any registered reader thread that wants to report its quiescent state
+ * must call this API before calling rte_rcu_qsbr_quiescent(). This can be
+ * called during initialization or as part of the packet processing loop.
+ *
+ * The reader thread must not access the shared data structures before
+ * this call returns.
+ *
+ * @param v
+ *   QS variable
+ * @param thread_id
+ *   Reader thread with this thread ID will report its quiescent state on
+ *   the QS variable.
+ */
+static inline void
+rte_rcu_qsbr_thread_online(struct rte_rcu_qsbr *v, unsigned int thread_id)
+{
+	uint64_t t;
+
+	RTE_ASSERT(v != NULL && thread_id < v->max_threads);
+
+	/* Copy the current value of token. The fence at the end of the
+	 * function will ensure that the following will not move down
+	 * after the load of any shared data structure.
+	 */
+	t = __atomic_load_n(&v->token, __ATOMIC_RELAXED);
+
+	/* __atomic_store_n(cnt, __ATOMIC_RELAXED) is used to ensure
+	 * 'cnt' (64b) is accessed atomically.
+	 */
+	__atomic_store_n(&v->qsbr_cnt[thread_id].cnt, t, __ATOMIC_RELAXED);
+
+	/* The subsequent load of the data structure should not move above
+	 * the store. Hence a store-load barrier is required.
+	 */
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+/**
+ * Remove a registered reader thread from the list of threads reporting
+ * their quiescent state on a QS variable.
+ *
+ * This can be called during initialization or as part of the packet
+ * processing loop, e.g. before blocking on an interrupt. The reader
+ * thread must not access the shared data structures after this call.
+ *
+ * @param v
+ *   QS variable
+ * @param thread_id
+ *   rte_rcu_qsbr_check() will not wait for the reader thread with this
+ *   thread ID to report its quiescent state on the QS variable.
+ */
+static inline void
+rte_rcu_qsbr_thread_offline(struct rte_rcu_qsbr *v, unsigned int thread_id)
+{
+	RTE_ASSERT(v != NULL && thread_id < v->max_threads);
+
+	/* The reader can go offline only after the load of the
+	 * data structure is completed. i.e. any load of the
+	 * data structure can not move after this store.
+	 */
+	__atomic_store_n(&v->qsbr_cnt[thread_id].cnt,
+			 RTE_QSBR_CNT_THR_OFFLINE, __ATOMIC_RELEASE);
+}
+
+/**
+ * Ask the reader threads to report the quiescent state status.
+ *
+ * This is implemented as a lock-free function. It is multi-thread safe
+ * and can be called from worker threads.
+ *
+ * @param v
+ *   QS variable
+ * @return
+ *   - This is the token for this call of the API. This should be passed
+ *     to rte_rcu_qsbr_check() API.
+ */
+static inline uint64_t
+rte_rcu_qsbr_start(struct rte_rcu_qsbr *v)
+{
+	RTE_ASSERT(v != NULL);
+
+	/* Release the changes to the shared data structure.
+	 * This store release will ensure that changes to any data
+	 * structure are visible to the workers before the token
+	 * update is visible.
+	 */
+	return __atomic_add_fetch(&v->token, 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Update quiescent state for a reader thread.
+ *
+ * This is implemented as a lock-free function. It is multi-thread safe.
+ * All the reader threads registered to report their quiescent state on
+ * the QS variable must call this API.
+ *
+ * @param v
+ *   QS variable
+ * @param thread_id
+ *   Update the quiescent state for the reader with this thread ID.
+ */
+static inline void
+rte_rcu_qsbr_quiescent(struct rte_rcu_qsbr *v, unsigned int thread_id)
+{
+	uint64_t t;
+
+	RTE_ASSERT(v != NULL && thread_id < v->max_threads);
+
+	/* Acquire the changes to the shared data structure released
+	 * by rte_rcu_qsbr_start.
+	 * Later loads of the shared data structure should not move
+	 * above this load. Hence, use load-acquire.
+	 */
+	t = __atomic_load_n(&v->token, __ATOMIC_ACQUIRE);
+
+	/* Inform the writer that updates are visible to this reader.
+	 * Prior loads of the shared data structure should not move
+	 * beyond this store. Hence use store-release.
+	 */
+	if (t != __atomic_load_n(&v->qsbr_cnt[thread_id].cnt,
+				 __ATOMIC_RELAXED))
+		__atomic_store_n(&v->qsbr_cnt[thread_id].cnt,
+				 t, __ATOMIC_RELEASE);
+}
+
+/**
+ * Check if all the reader threads have entered the quiescent state
+ * referenced by token.
+ *
+ * This is implemented as a lock-free function. It is multi-thread
+ * safe and can be called from the worker threads as well.
+ *
+ * If this API is called with 'wait' set to true, the following
+ * factors must be considered:
+ *
+ * 1) If the calling thread is also reporting the status on the
+ * same QS variable, it must update the quiescent state status, before
+ * calling this API.
+ *
+ * 2) In addition, while calling from multiple threads, only
+ * one of those threads can be reporting the quiescent state status
+ * on a given QS variable.
+ *
+ * @param v
+ *   QS variable
+ * @param t
+ *   Token returned by rte_rcu_qsbr_start API
+ * @param wait
+ *   If true, block till all the reader threads have completed entering
+ *   the quiescent state referenced by token 't'.
+ * @return
+ *   - 0 if all reader threads have NOT passed through specified number
+ *     of quiescent states.
+ *   - 1 if all reader threads have passed through specified number
+ *     of quiescent states.
+ */
+static inline int
+rte_rcu_qsbr_check(struct rte_rcu_qsbr *v, uint64_t t, int wait)
+{
+	uint32_t i, j, id;
+	uint64_t bmap;
+	uint64_t c;
+	uint64_t *reg_thread_id;
+
+	RTE_ASSERT(v != NULL);
+
+	for (i = 0, reg_thread_id = __RTE_QSBR_THRID_ARRAY_ELM(v, 0);
+		i < v->num_elems;
+		i++, reg_thread_id++) {
+		/* Load the current registered thread bit map before
+		 * loading the reader thread quiescent state counters.
+		 */
+		bmap = __atomic_load_n(reg_thread_id, __ATOMIC_ACQUIRE);
+		id = i << __RTE_QSBR_THRID_INDEX_SHIFT;
+
+		while (bmap) {
+			j = __builtin_ctzll(bmap);
+			c = __atomic_load_n(&v->qsbr_cnt[id + j].cnt,
+					    __ATOMIC_ACQUIRE);
+
+			/* Counter is not checked for wrap-around condition
+			 * as it is a 64b counter.
+			 */
+			if (unlikely(c != RTE_QSBR_CNT_THR_OFFLINE && c < t)) {
+				/* This thread is not in quiescent state */
+				if (!wait)
+					return 0;
+
+				rte_pause();
+				/* This thread might have unregistered.
+				 * Re-read the bitmap.
+				 */
+				bmap = __atomic_load_n(reg_thread_id,
+						       __ATOMIC_ACQUIRE);
+
+				continue;
+			}
+
+			bmap &= ~(1ULL << j);
+		}
+	}
+
+	return 1;
+}
+
+/**
+ * Wait till the reader threads have entered quiescent state.
+ *
+ * This is implemented as a lock-free function. It is multi-thread safe.
+ * This API can be thought of as a wrapper around rte_rcu_qsbr_start and
+ * rte_rcu_qsbr_check APIs.
+ *
+ * If this API is called from multiple threads, only one of
+ * those threads can be reporting the quiescent state status on a
+ * given QS variable.
+ *
+ * @param v
+ *   QS variable
+ * @param thread_id
+ *   Thread ID of the caller if it is registered to report quiescent state
+ *   on this QS variable (i.e. the calling thread is also acting as
+ *   a reader). For other cases, use RTE_QSBR_THRID_INVALID.
+ */
+void
+rte_rcu_qsbr_synchronize(struct rte_rcu_qsbr *v, unsigned int thread_id);
+
+/**
+ * Dump the details of a single QS variable to a file.
+ *
+ * It is NOT multi-thread safe.
+ *
+ * @param f
+ *   A pointer to a file for output
+ * @param v
+ *   QS variable
+ * @return
+ *   On success - 0
+ *   On error - 1 with error code set in rte_errno.
+ */
+int
+rte_rcu_qsbr_dump(FILE *f, struct rte_rcu_qsbr *v);
+
+/**
+ * Callback freeing an element pushed on a defer queue.
+ *
+ * @param p
+ *   Pointer provided while creating the defer queue
+ * @param e
+ *   Element pushed with rte_rcu_qsbr_dq_enqueue()
+ */
+typedef void (*rte_rcu_qsbr_free_t)(void *p, void *e);
+
+/**
+ * Parameters used when creating the defer queue.
+ */
+struct rte_rcu_qsbr_dq_parameters {
+	const char *name;
+	/**< Name of the defer queue, used for the memory allocation */
+	uint32_t size;
+	/**< Number of entries in the defer queue, rounded up to a power of 2 */
+	struct rte_rcu_qsbr *v;
+	/**< RCU QSBR variable the elements are protected with */
+	rte_rcu_qsbr_free_t free_fn;
+	/**< Function called to free an element once it is safe to do so */
+	void *p;
+	/**< Pointer passed to the free function, e.g. the parent object */
+	int socket_id;
+	/**< Socket on which the defer queue is allocated */
+};
+
+/** Opaque defer queue structure */
+struct rte_rcu_qsbr_dq;
+
+/**
+ * Create a queue used to store the elements to be freed once all the
+ * reader threads went through a quiescent state.
+ *
+ * @param params
+ *   Parameters to create the defer queue.
+ * @return
+ *   On success - Valid pointer to the defer queue
+ *   On error - NULL, with rte_errno set to EINVAL or ENOMEM.
+ */
+struct rte_rcu_qsbr_dq *
+rte_rcu_qsbr_dq_create(const struct rte_rcu_qsbr_dq_parameters *params);
+
+/**
+ * Push an element removed from the shared data structure on the defer
+ * queue. The free callback is called on it once no reader can reference
+ * it anymore.
+ *
+ * This function never blocks: if the queue is full, the expired entries
+ * are reclaimed first, and -ENOSPC is returned if none could be. It is
+ * multi-thread safe.
+ *
+ * @param dq
+ *   Defer queue
+ * @param e
+ *   Element to free later
+ * @return
+ *   On success - 0
+ *   On error - -EINVAL or -ENOSPC
+ */
+int
+rte_rcu_qsbr_dq_enqueue(struct rte_rcu_qsbr_dq *dq, void *e);
+
+/**
+ * Free the elements of the defer queue that cannot be referenced by any
+ * reader anymore, oldest first. It is multi-thread safe.
+ *
+ * @param dq
+ *   Defer queue
+ * @param n
+ *   Maximum number of elements to free
+ * @param wait
+ *   If true, block until the n oldest elements (or all the elements if
+ *   there are less) can be freed. If false, stop at the first element
+ *   that may still be referenced.
+ * @param pending
+ *   If not NULL, filled with the number of elements left in the queue.
+ * @return
+ *   Number of elements freed.
+ */
+unsigned int
+rte_rcu_qsbr_dq_reclaim(struct rte_rcu_qsbr_dq *dq, unsigned int n, int wait,
+			unsigned int *pending);
+
+/**
+ * Wait until all the elements of the defer queue can be freed, free them
+ * and delete the defer queue.
+ *
+ * @param dq
+ *   Defer queue
+ * @return
+ *   On success - 0
+ *   On error - -EINVAL
+ */
+int
+rte_rcu_qsbr_dq_delete(struct rte_rcu_qsbr_dq *dq);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_RCU_QSBR_H_ */
@@ -101,6 +101,7 @@ extern "C" {
 #include <rte_atomic.h>
 #include <rte_branch_prediction.h>
 #include <rte_memzone.h>
+#include <rte_trace.h>
 
 #define RTE_TAILQ_RING_NAME "RTE_RING"
 
@@ -218,6 +219,11 @@ struct rte_ring {
 #define __RING_STAT_ADD(r, name, n) do {} while(0)
 #endif
 
+/** Trace point of the successful enqueue operations. */
+RTE_TRACE_POINT_DECLARE(rte_ring_trace_enqueue);
+/** Trace point of the successful dequeue operations. */
+RTE_TRACE_POINT_DECLARE(rte_ring_trace_dequeue);
+
 /**
  * Calculate the memory size needed for a ring
  *
@@ -350,6 +356,62 @@ int rte_ring_set_water_mark(struct rte_ring *r, unsigned count);
  */
 void rte_ring_dump(FILE *f, const struct rte_ring *r);
 
+/*
+ * Memory ordering of the head/tail indexes.
+ *
+ * With the default model, the indexes are plain volatile accesses, the
+ * head is moved with rte_atomic32_cmpset() (full barrier) and the ring
+ * slots are ordered against the tail update with rte_smp_wmb() or
+ * rte_smp_rmb().
+ *
+ * With RTE_RING_USE_C11_MEM_MODEL, the opposite tail is read with a
+ * load-acquire and the own tail is published with a store-release, so the
+ * slot accesses are ordered by the index accesses themselves and no
+ * standalone barrier is needed. The head is moved with a relaxed CAS, as
+ * it only arbitrates between producers (or consumers) and does not
+ * publish any data. This avoids the full dmb instructions on weakly
+ * ordered CPUs such as ARMv8.
+ */
+#ifdef RTE_RING_USE_C11_MEM_MODEL
+
+/* Read the tail of the opposite side before accessing the ring slots. */
+#define __RING_TAIL_LOAD(t) __atomic_load_n(&(t), __ATOMIC_ACQUIRE)
+/* Publish the own tail after the ring slots have been accessed. */
+#define __RING_TAIL_STORE(t, v) __atomic_store_n(&(t), (v), __ATOMIC_RELEASE)
+/* Read the shared head, ordered before the read of the opposite tail. */
+#define __RING_HEAD_LOAD(t) __atomic_load_n(&(t), __ATOMIC_ACQUIRE)
+/* Wait on a tail of the same side. */
+#define __RING_IDX_LOAD(t) __atomic_load_n(&(t), __ATOMIC_RELAXED)
+/* Ordering is provided by the tail store-release. */
+#define __RING_ENQ_BARRIER() do {} while (0)
+#define __RING_DEQ_BARRIER() do {} while (0)
+
+static inline int __attribute__((always_inline))
+__rte_ring_head_cas(volatile uint32_t *head, uint32_t old_val,
+		    uint32_t new_val)
+{
+	return __atomic_compare_exchange_n(head, &old_val, new_val, 0,
+			__ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+
+#else
+
+#define __RING_TAIL_LOAD(t) (t)
+#define __RING_TAIL_STORE(t, v) ((t) = (v))
+#define __RING_HEAD_LOAD(t) (t)
+#define __RING_IDX_LOAD(t) (t)
+#define __RING_ENQ_BARRIER() rte_smp_wmb()
+#define __RING_DEQ_BARRIER() rte_smp_rmb()
+
+static inline int __attribute__((always_inline))
+__rte_ring_head_cas(volatile uint32_t *head, uint32_t old_val,
+		    uint32_t new_val)
+{
+	return rte_atomic32_cmpset(head, old_val, new_val);
+}
+
+#endif
+
 /* the actual enqueue of pointers on the ring.
  * Placed here since identical code needed in both
  * single and multi producer enqueue functions */
@@ -449,8 +511,8 @@ __rte_ring_mp_do_enqueue(struct rte_ring *r, void * const *obj_table,
 		/* Reset n to the initial burst count */
 		n = max;
 
-		prod_head = r->prod.head;
-		cons_tail = r->cons.tail;
+		prod_head = __RING_HEAD_LOAD(r->prod.head);
+		cons_tail = __RING_TAIL_LOAD(r->cons.tail);
 		/* The subtraction is done between two unsigned 32bits value
 		 * (the result is always modulo 32 bits even if we have
 		 * prod_head > cons_tail). So 'free_entries' is always between 0
@@ -475,13 +537,13 @@ __rte_ring_mp_do_enqueue(struct rte_ring *r, void * const *obj_table,
 		}
 
 		prod_next = prod_head + n;
-		success = rte_atomic32_cmpset(&r->prod.head, prod_head,
+		success = __rte_ring_head_cas(&r->prod.head, prod_head,
 					      prod_next);
 	} while (unlikely(success == 0));
 
 	/* write entries in ring */
 	ENQUEUE_PTRS();
-	rte_smp_wmb();
+	__RING_ENQ_BARRIER();
 
 	/* if we exceed the watermark */
 	if (unlikely(((mask + 1) - free_entries + n) > r->prod.watermark)) {
@@ -498,7 +560,7 @@ __rte_ring_mp_do_enqueue(struct rte_ring *r, void * const *obj_table,
 	 * If there are other enqueues in progress that preceded us,
 	 * we need to wait for them to complete
 	 */
-	while (unlikely(r->prod.tail != prod_head)) {
+	while (unlikely(__RING_IDX_LOAD(r->prod.tail) != prod_head)) {
 		rte_pause();
 
 		/* Set RTE_RING_PAUSE_REP_COUNT to avoid spin too long waiting
@@ -510,7 +572,8 @@ __rte_ring_mp_do_enqueue(struct rte_ring *r, void * const *obj_table,
 			sched_yield();
 		}
 	}
-	r->prod.tail = prod_next;
+	__RING_TAIL_STORE(r->prod.tail, prod_next);
+	rte_trace_point_emit(&rte_ring_trace_enqueue, (uintptr_t)r, n, 0, 0);
 	return ret;
 }
 
@@ -547,7 +610,7 @@ __rte_ring_sp_do_enqueue(struct rte_ring *r, void * const *obj_table,
 	int ret;
 
 	prod_head = r->prod.head;
-	cons_tail = r->cons.tail;
+	cons_tail = __RING_TAIL_LOAD(r->cons.tail);
 	/* The subtraction is done between two unsigned 32bits value
 	 * (the result is always modulo 32 bits even if we have
 	 * prod_head > cons_tail). So 'free_entries' is always between 0
@@ -576,7 +639,7 @@ __rte_ring_sp_do_enqueue(struct rte_ring *r, void * const *obj_table,
 
 	/* write entries in ring */
 	ENQUEUE_PTRS();
-	rte_smp_wmb();
+	__RING_ENQ_BARRIER();
 
 	/* if we exceed the watermark */
 	if (unlikely(((mask + 1) - free_entries + n) > r->prod.watermark)) {
@@ -589,7 +652,8 @@ __rte_ring_sp_do_enqueue(struct rte_ring *r, void * const *obj_table,
 		__RING_STAT_ADD(r, enq_success, n);
 	}
 
-	r->prod.tail = prod_next;
+	__RING_TAIL_STORE(r->prod.tail, prod_next);
+	rte_trace_point_emit(&rte_ring_trace_enqueue, (uintptr_t)r, n, 0, 0);
 	return ret;
 }
 
@@ -641,8 +705,8 @@ __rte_ring_mc_do_dequeue(struct rte_ring *r, void **obj_table,
 		/* Restore n as it may change every loop */
 		n = max;
 
-		cons_head = r->cons.head;
-		prod_tail = r->prod.tail;
+		cons_head = __RING_HEAD_LOAD(r->cons.head);
+		prod_tail = __RING_TAIL_LOAD(r->prod.tail);
 		/* The subtraction is done between two unsigned 32bits value
 		 * (the result is always modulo 32 bits even if we have
 		 * cons_head > prod_tail). So 'entries' is always between 0
@@ -666,19 +730,19 @@ __rte_ring_mc_do_dequeue(struct rte_ring *r, void **obj_table,
 		}
 
 		cons_next = cons_head + n;
-		success = rte_atomic32_cmpset(&r->cons.head, cons_head,
+		success = __rte_ring_head_cas(&r->cons.head, cons_head,
 					      cons_next);
 	} while (unlikely(success == 0));
 
 	/* copy in table */
 	DEQUEUE_PTRS();
-	rte_smp_rmb();
+	__RING_DEQ_BARRIER();
 
 	/*
 	 * If there are other dequeues in progress that preceded us,
 	 * we need to wait for them to complete
 	 */
-	while (unlikely(r->cons.tail != cons_head)) {
+	while (unlikely(__RING_IDX_LOAD(r->cons.tail) != cons_head)) {
 		rte_pause();
 
 		/* Set RTE_RING_PAUSE_REP_COUNT to avoid spin too long waiting
@@ -691,7 +755,8 @@ __rte_ring_mc_do_dequeue(struct rte_ring *r, void **obj_table,
 		}
 	}
 	__RING_STAT_ADD(r, deq_success, n);
-	r->cons.tail = cons_next;
+	__RING_TAIL_STORE(r->cons.tail, cons_next);
+	rte_trace_point_emit(&rte_ring_trace_dequeue, (uintptr_t)r, n, 0, 0);
 
 	return behavior == RTE_RING_QUEUE_FIXED ? 0 : n;
 }
@@ -729,7 +794,7 @@ __rte_ring_sc_do_dequeue(struct rte_ring *r, void **obj_table,
 	uint32_t mask = r->prod.mask;
 
 	cons_head = r->cons.head;
-	prod_tail = r->prod.tail;
+	prod_tail = __RING_TAIL_LOAD(r->prod.tail);
 	/* The subtraction is done between two unsigned 32bits value
 	 * (the result is always modulo 32 bits even if we have
 	 * cons_head > prod_tail). So 'entries' is always between 0
@@ -756,10 +821,11 @@ __rte_ring_sc_do_dequeue(struct rte_ring *r, void **obj_table,
 
 	/* copy in table */
 	DEQUEUE_PTRS();
-	rte_smp_rmb();
+	__RING_DEQ_BARRIER();
 
 	__RING_STAT_ADD(r, deq_success, n);
-	r->cons.tail = cons_next;
+	__RING_TAIL_STORE(r->cons.tail, cons_next);
+	rte_trace_point_emit(&rte_ring_trace_dequeue, (uintptr_t)r, n, 0, 0);
 	return behavior == RTE_RING_QUEUE_FIXED ? 0 : n;
 }
 